@@ -86,6 +86,9 @@ OPTION(ENABLE_LIBMSPACK "Enable libmspack-xenia for Xbox 360 executables." ON)
 # Enable the PowerVR Native SDK subset for PVRTC decompression.
 OPTION(ENABLE_PVRTC "Enable the PowerVR Native SDK subset for PVRTC decompression." ON)
 
+# Enable per-phase profiling of RomData subclasses.
+OPTION(ENABLE_PROFILING "Enable per-phase profiling of RomData subclasses. (rpcli --profile, RP_PROFILE)" OFF)
+
 # Enable precompiled headers.
 # FIXME: Not working properly on older gcc. Use cmake-3.16.0's built-in PCH?
 IF(MSVC)
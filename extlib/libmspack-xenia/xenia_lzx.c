@@ -109,6 +109,21 @@ struct mspack_system* mspack_memory_sys_create() {
 }
 void mspack_memory_sys_destroy(struct mspack_system* sys) { free(sys); }
 
+// rom-properties: Callback-based mspack_file.
+typedef struct mspack_callback_file_t {
+  lzx_read_func read_func;
+  lzx_write_func write_func;
+  void* opaque;
+} mspack_callback_file;
+int mspack_callback_read(struct mspack_file* file, void* buffer, int chars) {
+  mspack_callback_file* cbfile = (mspack_callback_file*)file;
+  return cbfile->read_func(cbfile->opaque, buffer, chars);
+}
+int mspack_callback_write(struct mspack_file* file, void* buffer, int chars) {
+  mspack_callback_file* cbfile = (mspack_callback_file*)file;
+  return cbfile->write_func(cbfile->opaque, buffer, chars);
+}
+
 int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
                    size_t dest_len, uint32_t window_size, void* window_data,
                    size_t window_data_len) {
@@ -161,3 +176,43 @@ int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
 
   return result_code;
 }
+
+// rom-properties: Decompress the beginning of an LZX stream using callbacks.
+int lzx_decompress_stream(lzx_read_func read_func, lzx_write_func write_func,
+                          void* opaque, size_t out_len, size_t total_len,
+                          uint32_t window_size) {
+  int result_code = 1;
+  uint32_t window_bits;
+
+  struct mspack_system* sys;
+  mspack_callback_file cbfile;
+  struct lzxd_stream* lzxd;
+
+  if (!bit_scan_forward(window_size, &window_bits)) {
+    return result_code;
+  }
+  if (out_len > total_len || total_len >= INT_MAX) {
+    return result_code;
+  }
+
+  sys = mspack_memory_sys_create();
+  if (!sys) {
+    return result_code;
+  }
+  sys->read = mspack_callback_read;
+  sys->write = mspack_callback_write;
+
+  cbfile.read_func = read_func;
+  cbfile.write_func = write_func;
+  cbfile.opaque = opaque;
+
+  lzxd = lzxd_init(sys, (struct mspack_file*)&cbfile, (struct mspack_file*)&cbfile,
+                   window_bits, 0, 0x8000, (off_t)total_len, 0);
+  if (lzxd) {
+    result_code = lzxd_decompress(lzxd, (off_t)out_len);
+    lzxd_free(lzxd);
+  }
+
+  mspack_memory_sys_destroy(sys);
+  return result_code;
+}
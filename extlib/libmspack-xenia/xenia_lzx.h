@@ -21,6 +21,31 @@ int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
                    size_t dest_len, uint32_t window_size, void* window_data,
                    size_t window_data_len);
 
+/**
+ * LZX stream callbacks.
+ * @param opaque Opaque pointer passed to lzx_decompress_stream().
+ * @param buffer Data buffer.
+ * @param size Data size.
+ * @return Number of bytes read or written, or -1 on error.
+ */
+typedef int (*lzx_read_func)(void* opaque, void* buffer, int size);
+typedef int (*lzx_write_func)(void* opaque, const void* buffer, int size);
+
+/**
+ * Decompress the beginning of an LZX stream using callbacks.
+ * Only as much input is read as is needed to produce out_len bytes.
+ * @param read_func Read callback.
+ * @param write_func Write callback.
+ * @param opaque Opaque pointer for the callbacks.
+ * @param out_len Number of bytes to decompress.
+ * @param total_len Total decompressed length of the stream.
+ * @param window_size LZX window size.
+ * @return MSPACK_ERR_OK on success; non-zero on error.
+ */
+int lzx_decompress_stream(lzx_read_func read_func, lzx_write_func write_func,
+                          void* opaque, size_t out_len, size_t total_len,
+                          uint32_t window_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -133,6 +133,27 @@ UNICE68_API
  */
 int unice68_depacker(void * dst, size_t dstsz, const void * src, size_t srcsz);
 
+UNICE68_API
+/**
+ *  Depack the beginning of an ICE buffer.
+ *
+ *   The unice68_depacker_prefix() function depacks the first dstsz
+ *   bytes of src input ICE compressed buffer into dst output buffer.
+ *   Since ICE data is depacked backwards, the entire input buffer is
+ *   still processed, but the depacked data is kept in a sliding
+ *   window, so memory usage does not depend on the depacked size.
+ *
+ * @param  dst   output (destination) buffer (uncompressed data).
+ * @param  dstsz number of bytes to depack.
+ * @param  src   input  (source)      buffer (compressed data).
+ * @param  srcsz input  (source)      buffer size.
+ *
+ * @return number of bytes depacked
+ * @retval >0    number of bytes depacked (may be less than dstsz)
+ * @retval -1    failure
+ */
+int unice68_depacker_prefix(void * dst, size_t dstsz, const void * src, size_t srcsz);
+
 UNICE68_API
 /**
  *  Pack a buffer with ice packer.
@@ -33,6 +33,10 @@
 # include <stdint.h>
 #endif
 
+// rom-properties: malloc(), memmove()
+#include <stdlib.h>
+#include <string.h>
+
 typedef uint8_t u8;
 typedef  int8_t s8;
 typedef int16_t s16;
@@ -48,8 +52,21 @@ typedef struct {
 
   // rom-properties: explicit srcbuf/dstbuf end pointers
   areg_t srcendexp,dstendexp;
+
+  // rom-properties: sliding window for unice68_depacker_prefix()
+  // winlog:  Offset of dstbuf within the depacked data.
+  //          If non-zero, dstbuf only contains part of the data.
+  // winkeep: Depacked bytes to keep above a6 when sliding.
+  // winroom: Minimum free space below a6.
+  int winlog,winkeep,winroom;
 } all_regs_t;
 
+// rom-properties: Sliding window sizes for unice68_depacker_prefix().
+// Literal runs are at most 0x7fff+270 bytes and strings are at most
+// 521 bytes; string offsets are at most 0x11f+4095 bytes.
+#define WINDOW_KEEP (32*1024)
+#define WINDOW_ROOM (64*1024)
+
 #define ICE_MAGIC 0x49434521 /* 'ICE!' */
 
 #define B_CC(CC, LABEL) if (CC) {goto LABEL;} else
@@ -114,6 +131,35 @@ static inline int chk_src_range(all_regs_t *R, const areg_t a, const areg_t b)
   return R->overflow;
 }
 
+/* rom-properties: Slide the depack window down if a6 is close to
+ * the bottom of the buffer. Only the most recently depacked data
+ * is kept, since string offsets are limited. When the window reaches
+ * the beginning of the depacked data, everything above a6 is kept
+ * so the requested prefix is complete. */
+static void dst_slide(all_regs_t *R)
+{
+  int keep, shift;
+
+  if (R->winlog == 0 || (R->a6 - R->dstbuf) >= R->winroom) {
+    return;
+  }
+
+  keep = (int)(R->dstend - R->a6);
+  if (keep > R->winkeep) {
+    keep = R->winkeep;
+  }
+  shift = (int)(R->dstend - keep - R->a6);
+  if (shift >= R->winlog) {
+    /* Final slide. */
+    shift = R->winlog;
+    keep = (int)(R->dstend - R->a6) - shift;
+  }
+
+  memmove(R->a6 + shift, R->a6, keep);
+  R->a6 += shift;
+  R->winlog -= shift;
+}
+
 /* getinfo:     moveq   #3,d1 */
 /* getbytes: lsl.l      #8,d0 */
 /*      move.b  (a0)+,d0 */
@@ -198,7 +244,12 @@ static int ice_decrunch(all_regs_t *R)
   }
   R->d0 = dsize = getinfo(R);
   R->a6 = R->a4 = R->a1;
-  R->a6 += R->d0;
+  // rom-properties: If depacking through a sliding window,
+  // the buffer initially contains the end of the depacked data.
+  if (R->winlog < 0 || R->winlog >= dsize) {
+    return -1;
+  }
+  R->a6 += R->d0 - R->winlog;
   R->dstend = R->a3 = R->a6;
   if (R->dstend > R->dstendexp) {
     // Calculated destination end is out of bounds.
@@ -207,6 +258,9 @@ static int ice_decrunch(all_regs_t *R)
 
   R->d7 = *(--R->a5);
   normal_bytes(R);
+  if (R->overflow) {
+    goto not_packed;
+  }
 
 /*      move.l  a3,a6 */
 /*      bsr     get_1_bit */
@@ -224,6 +278,18 @@ static int ice_decrunch(all_regs_t *R)
   GET_1_BIT_BCC(ice_00);
   R->d7 = R->d1 = get_d0_bits(R, 15);
 
+  // rom-properties: If depacking through a sliding window, skip
+  // bitplane groups that are no longer in the buffer. Each group
+  // is independent of the others.
+  if (R->a3 - R->dstbuf < dsize) {
+    const int skip = (dsize - (int)(R->a3 - R->dstbuf) + 7) / 8;
+    if ((R->d7 & 0xFFFF) < skip) {
+      goto not_packed;
+    }
+    R->d7 -= skip;
+    R->a3 = R->dstbuf + dsize - (skip * 8);
+  }
+
 /* ice_00:      moveq   #3,d6 */
 /* ice_01:      move.w  -(a3),d4 */
 /*      moveq   #3,d5 */
@@ -266,7 +332,8 @@ ice_02:
   DBF(R->d5,ice_02);
   DBF(R->d6,ice_01);
 
-  if (chk_src_range(R, R->a3, R->a3+7)) {
+  // rom-properties: a3 points into the destination buffer.
+  if (chk_dst_range(R, R->a3, R->a3+7)) {
     goto not_packed;
   }
 
@@ -343,6 +410,11 @@ static void normal_bytes(all_regs_t *R)
     DBF(R->d1,lp_copy);
 
  test_if_end:
+    // rom-properties: Stop on errors, and slide the window if necessary.
+    if (R->overflow) {
+      break;
+    }
+    dst_slide(R);
     if (R->a6 <= R->a4) {
       if (R->a6 < R->a4) {
         chk_dst_range(R, R->a6, R->a6);
@@ -488,6 +560,11 @@ less_40:
 
 depack_bytes:
   R->a1 = R->a6 + 2 + (s16)R->d4 + (s16)R->d1;
+  // rom-properties: Don't read past the depacked data.
+  if (R->a1 > R->dstend) {
+    R->overflow |= (1 << 5);
+    return;
+  }
   chk_dst_range(R, R->a6 - DBF_COUNT(R->d4) - 1, R->a6-1);
   if (R->a6>R->a4) *(--R->a6) = *(--R->a1);
 dep_b:
@@ -553,5 +630,70 @@ int unice68_depacker(void * dst, size_t dstsz, const void * src, size_t srcsz)
   allregs.srcendexp = (areg_t)src + srcsz;
   allregs.dstendexp = (areg_t)dst + dstsz;
 
+  // rom-properties: no sliding window
+  allregs.winlog = allregs.winkeep = allregs.winroom = 0;
+
   return ice_decrunch(&allregs);
 }
+
+// rom-properties: Depack the beginning of an ICE buffer.
+int unice68_depacker_prefix(void * dst, size_t dstsz, const void * src, size_t srcsz)
+{
+  all_regs_t allregs;
+  areg_t winbuf;
+  size_t winsz;
+  int dsize, ret;
+
+  if (srcsz < 12) {
+    return -1;
+  }
+  dsize = unice68_depacked_size(src, 0);
+  if (dsize <= 0) {
+    return -1;
+  }
+  if (dstsz > (size_t)dsize) {
+    dstsz = (size_t)dsize;
+  }
+
+  winsz = dstsz + WINDOW_KEEP + WINDOW_ROOM;
+  if (winsz >= (size_t)dsize) {
+    if (dstsz == (size_t)dsize) {
+      // Depack directly into the destination buffer.
+      ret = unice68_depacker(dst, dstsz, src, srcsz);
+      return (ret == 0 ? dsize : -1);
+    }
+    // The depacked data is small enough to depack all at once.
+    winsz = (size_t)dsize;
+  }
+
+  winbuf = malloc(winsz);
+  if (!winbuf) {
+    return -1;
+  }
+
+  allregs.d0 = allregs.d1 = allregs.d2 = allregs.d3 = 0;
+  allregs.d4 = allregs.d5 = allregs.d6 = allregs.d7 = 0;
+  allregs.a2 = allregs.a3 = allregs.a4 = 0;
+  allregs.a5 = allregs.a6 = allregs.a7 = 0;
+
+  allregs.a0 = (areg_t)src;
+  allregs.a1 = winbuf;
+  allregs.overflow = 0;
+  allregs.srcendexp = (areg_t)src + srcsz;
+  allregs.dstendexp = winbuf + winsz;
+
+  allregs.winlog = dsize - (int)winsz;
+  allregs.winkeep = WINDOW_KEEP;
+  allregs.winroom = WINDOW_ROOM;
+
+  ret = ice_decrunch(&allregs);
+  if (ret == 0 && allregs.winlog != 0) {
+    // Depacking ended before reaching the beginning.
+    ret = -1;
+  }
+  if (ret == 0) {
+    memcpy(dst, winbuf, dstsz);
+  }
+  free(winbuf);
+  return (ret == 0 ? (int)dstsz : -1);
+}
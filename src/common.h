@@ -158,6 +158,21 @@
 # error No aligned variable macro for this compiler.
 #endif
 
+/**
+ * Thread-local variable storage class.
+ * NOTE: Only use this for POD types.
+ * MSVC 2013 and earlier don't support C++11 thread_local.
+ */
+#if defined(_MSC_VER) && _MSC_VER < 1900
+# define RP_THREAD_LOCAL __declspec(thread)
+#elif defined(__cplusplus)
+# define RP_THREAD_LOCAL thread_local
+#elif defined(__GNUC__)
+# define RP_THREAD_LOCAL __thread
+#else
+# error No thread-local storage macro for this compiler.
+#endif
+
 // C API declaration for MSVC.
 // Required when using stdcall as the default calling convention.
 #ifdef _MSC_VER
@@ -0,0 +1,253 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * CairoImageBackend.cpp: rp_image_backend using cairo_surface_t.          *
+ *                                                                         *
+ * Copyright (c) 2017-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CairoImageBackend.hpp"
+
+// librpbase, librptexture
+#include "librpbase/aligned_malloc.h"
+using LibRpTexture::rp_image;
+using LibRpTexture::rp_image_backend;
+
+// User data key for the image buffer.
+// The buffer is freed when the cairo_surface_t is destroyed.
+static const cairo_user_data_key_t data_key = { 0 };
+
+CairoImageBackend::CairoImageBackend(int width, int height, rp_image::Format format)
+	: super(width, height, format)
+	, m_surface(nullptr)
+	, m_data(nullptr)
+	, m_data_len(0)
+	, m_palette(nullptr)
+	, m_palette_len(0)
+{
+	if (this->width <= 0 || this->height <= 0 || this->stride <= 0) {
+		// Error initializing the backend.
+		// (Width, height, or format is probably broken.)
+		return;
+	}
+
+	switch (format) {
+		case rp_image::Format::ARGB32:
+			// Allocate a Cairo surface.
+			if (allocSurface() != 0) {
+				clear_properties();
+			}
+			break;
+
+		case rp_image::Format::CI8: {
+			// Cairo doesn't support 8bpp, so use a plain memory buffer.
+			// We're using the full stride for the last row
+			// to make it easier to manage.
+			m_data_len = this->height * this->stride;
+			m_data = static_cast<uint8_t*>(aligned_malloc(16, m_data_len));
+			if (!m_data) {
+				// Failed to allocate memory.
+				m_data_len = 0;
+				clear_properties();
+				return;
+			}
+
+			// Palette is initialized to 0 to ensure
+			// there's no weird artifacts if the caller
+			// is converting a lower-color image.
+			const size_t palette_sz = 256*sizeof(*m_palette);
+			m_palette = static_cast<uint32_t*>(aligned_malloc(16, palette_sz));
+			if (!m_palette) {
+				// Failed to allocate memory.
+				aligned_free(m_data);
+				m_data = nullptr;
+				m_data_len = 0;
+				clear_properties();
+				return;
+			}
+			memset(m_palette, 0, palette_sz);
+			m_palette_len = 256;
+			break;
+		}
+
+		default:
+			assert(!"Unsupported rp_image::Format.");
+			clear_properties();
+			break;
+	}
+}
+
+CairoImageBackend::~CairoImageBackend()
+{
+	if (m_surface) {
+		// m_data is owned by m_surface.
+		cairo_surface_destroy(m_surface);
+	} else {
+		aligned_free(m_data);
+	}
+	aligned_free(m_palette);
+}
+
+/**
+ * Allocate the image buffer and Cairo surface.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CairoImageBackend::allocSurface(void)
+{
+	assert(m_surface == nullptr);
+	assert(m_data == nullptr);
+
+	// Allocate our own memory buffer.
+	// This is needed in order to use 16-byte row alignment.
+	// NOTE: Cairo requires the stride to be a multiple of 4,
+	// so a 16-byte aligned stride is always acceptable.
+	const size_t data_len = this->height * this->stride;
+	uint8_t *const data = static_cast<uint8_t*>(aligned_malloc(16, data_len));
+	if (!data) {
+		// Failed to allocate memory.
+		return -ENOMEM;
+	}
+
+	cairo_surface_t *const surface = cairo_image_surface_create_for_data(
+		data, CAIRO_FORMAT_ARGB32, this->width, this->height, this->stride);
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+		// Error creating the Cairo surface.
+		cairo_surface_destroy(surface);
+		aligned_free(data);
+		return -ENOMEM;
+	}
+
+	// Free the memory buffer when the surface is destroyed.
+	// The surface may outlive this backend if getCairoSurface() was used.
+	if (cairo_surface_set_user_data(surface, &data_key, data, aligned_free) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(surface);
+		aligned_free(data);
+		return -ENOMEM;
+	}
+
+	m_surface = surface;
+	m_data = data;
+	m_data_len = data_len;
+	return 0;
+}
+
+/**
+ * Creator function for rp_image::setBackendCreatorFn().
+ */
+rp_image_backend *CairoImageBackend::creator_fn(int width, int height, rp_image::Format format)
+{
+	return new CairoImageBackend(width, height, format);
+}
+
+void *CairoImageBackend::data(void)
+{
+	// Make sure Cairo isn't holding any pending drawing operations.
+	if (m_surface) {
+		cairo_surface_flush(m_surface);
+	}
+	return m_data;
+}
+
+const void *CairoImageBackend::data(void) const
+{
+	return m_data;
+}
+
+size_t CairoImageBackend::data_len(void) const
+{
+	return m_data_len;
+}
+
+uint32_t *CairoImageBackend::palette(void)
+{
+	return m_palette;
+}
+
+const uint32_t *CairoImageBackend::palette(void) const
+{
+	return m_palette;
+}
+
+int CairoImageBackend::palette_len(void) const
+{
+	return m_palette_len;
+}
+
+/**
+ * Shrink image dimensions.
+ * @param width New width.
+ * @param height New height.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CairoImageBackend::shrink(int width, int height)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(this->width > 0);
+	assert(this->height > 0);
+	assert(width <= this->width);
+	assert(height <= this->height);
+	if (width <= 0 || height <= 0 ||
+	    this->width <= 0 || this->height <= 0 ||
+	    width > this->width || height > this->height)
+	{
+		return -EINVAL;
+	}
+
+	if (!m_surface) {
+		// CI8: We can simply reduce width/height without
+		// actually adjusting the image data.
+		this->width = width;
+		this->height = height;
+		m_data_len = height * this->stride;
+		return 0;
+	}
+
+	// cairo_surface_t doesn't support changing width/height in-place,
+	// so create a new surface using the existing image buffer.
+	// The new surface holds a reference to the old surface in order
+	// to keep the image buffer alive.
+	cairo_surface_t *const surface = cairo_image_surface_create_for_data(
+		m_data, CAIRO_FORMAT_ARGB32, width, height, this->stride);
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+		// Error creating the Cairo surface.
+		cairo_surface_destroy(surface);
+		return -ENOMEM;
+	}
+	if (cairo_surface_set_user_data(surface, &data_key, m_surface,
+		reinterpret_cast<cairo_destroy_func_t>(cairo_surface_destroy)) != CAIRO_STATUS_SUCCESS)
+	{
+		cairo_surface_destroy(surface);
+		return -ENOMEM;
+	}
+
+	// NOTE: The old surface reference is now owned by the new surface.
+	m_surface = surface;
+	this->width = width;
+	this->height = height;
+	m_data_len = height * this->stride;
+	return 0;
+}
+
+/**
+ * Get the underlying cairo_surface_t.
+ *
+ * The surface shares its image data with the rp_image,
+ * so the rp_image should not be modified afterwards.
+ * The image data is NOT premultiplied unless
+ * rp_image::premultiply() was called.
+ *
+ * Caller must call cairo_surface_destroy() when done.
+ *
+ * @return cairo_surface_t (new reference), or nullptr if not ARGB32.
+ */
+cairo_surface_t *CairoImageBackend::getCairoSurface(void) const
+{
+	if (!m_surface)
+		return nullptr;
+
+	// The image data may have been modified directly.
+	cairo_surface_mark_dirty(m_surface);
+	return cairo_surface_reference(m_surface);
+}
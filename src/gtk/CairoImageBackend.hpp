@@ -0,0 +1,93 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * CairoImageBackend.hpp: rp_image_backend using cairo_surface_t.          *
+ *                                                                         *
+ * Copyright (c) 2017-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_GTK_CAIROIMAGEBACKEND_HPP__
+#define __ROMPROPERTIES_GTK_CAIROIMAGEBACKEND_HPP__
+
+// librptexture
+#include "librptexture/img/rp_image_backend.hpp"
+
+// Cairo
+#include <cairo.h>
+
+/**
+ * rp_image data storage class.
+ *
+ * ARGB32 images are stored in a cairo_surface_t, so image
+ * decoders write directly into the Cairo surface.
+ *
+ * NOTE: Cairo doesn't natively support 8bpp, so CI8 images
+ * use a plain memory buffer and must be converted.
+ */
+class CairoImageBackend : public LibRpTexture::rp_image_backend
+{
+	public:
+		CairoImageBackend(int width, int height, LibRpTexture::rp_image::Format format);
+		virtual ~CairoImageBackend();
+
+	private:
+		typedef LibRpTexture::rp_image_backend super;
+		RP_DISABLE_COPY(CairoImageBackend)
+
+	public:
+		/**
+		 * Creator function for rp_image::setBackendCreatorFn().
+		 */
+		static LibRpTexture::rp_image_backend *creator_fn(int width, int height, LibRpTexture::rp_image::Format format);
+
+		// Image data.
+		void *data(void) final;
+		const void *data(void) const final;
+		size_t data_len(void) const final;
+
+		// Image palette.
+		uint32_t *palette(void) final;
+		const uint32_t *palette(void) const final;
+		int palette_len(void) const final;
+
+	public:
+		/**
+		 * Shrink image dimensions.
+		 * @param width New width.
+		 * @param height New height.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int shrink(int width, int height) final;
+
+	public:
+		/**
+		 * Get the underlying cairo_surface_t.
+		 *
+		 * The surface shares its image data with the rp_image,
+		 * so the rp_image should not be modified afterwards.
+		 * The image data is NOT premultiplied unless
+		 * rp_image::premultiply() was called.
+		 *
+		 * Caller must call cairo_surface_destroy() when done.
+		 *
+		 * @return cairo_surface_t (new reference), or nullptr if not ARGB32.
+		 */
+		cairo_surface_t *getCairoSurface(void) const;
+
+	private:
+		/**
+		 * Allocate the image buffer and Cairo surface.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int allocSurface(void);
+
+	protected:
+		cairo_surface_t *m_surface;	// ARGB32 only
+		uint8_t *m_data;		// Owned by m_surface if ARGB32.
+		size_t m_data_len;
+
+		uint32_t *m_palette;		// CI8 only
+		int m_palette_len;
+};
+
+#endif /* __ROMPROPERTIES_GTK_CAIROIMAGEBACKEND_HPP__ */
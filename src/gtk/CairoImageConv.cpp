@@ -8,6 +8,7 @@
 
 #include "stdafx.h"
 #include "CairoImageConv.hpp"
+#include "CairoImageBackend.hpp"
 
 // C++ STL classes.
 using std::array;
@@ -19,7 +20,7 @@ using LibRpTexture::rp_image;
  * Convert an rp_image to cairo_surface_t.
  * @param img		[in] rp_image.
  * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
- * @return GdkPixbuf, or nullptr on error.
+ * @return cairo_surface_t, or nullptr on error.
  */
 cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img, bool premultiply)
 {
@@ -27,50 +28,66 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 	if (unlikely(!img || !img->isValid()))
 		return nullptr;
 
-	// NOTE: cairo_image_surface_create_for_data() doesn't do a
-	// deep copy, so we can't use it.
-	// NOTE 2: cairo_image_surface_create() always returns a valid
-	// pointer, but the status may be CAIRO_STATUS_NULL_POINTER if
-	// it failed to create a surface. We'll still check for nullptr.
 	const int width = img->width();
 	const int height = img->height();
-	cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-	// cairo_image_surface_create() always returns a valid pointer.
-	assert(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
-	if (unlikely(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)) {
-		cairo_surface_destroy(surface);
-		return nullptr;
-	}
-
-	uint32_t *px_dest = reinterpret_cast<uint32_t*>(cairo_image_surface_get_data(surface));
-	assert(px_dest != nullptr);
 
 	switch (img->format()) {
 		case rp_image::Format::ARGB32: {
-			const rp_image *img_prex;
+			rp_image *img_prex = nullptr;
+			const rp_image *img_src = img;
 			if (premultiply) {
 				// Premultiply the image first.
 				// TODO: Combined dup()/premultiply() function?
 				img_prex = img->dup();
-				const_cast<rp_image*>(img_prex)->premultiply();
-			} else {
-				// No premultiplication.
-				img_prex = img;
+				img_prex->premultiply();
+				img_src = img_prex;
 			}
 
+			// If the image uses CairoImageBackend, the image data
+			// is already stored in a cairo_surface_t.
+			const CairoImageBackend *const backend =
+				dynamic_cast<const CairoImageBackend*>(img_src->backend());
+			cairo_surface_t *surface = (backend ? backend->getCairoSurface() : nullptr);
+			if (surface) {
+				// No copy is needed.
+				if (img_prex) {
+					img_prex->unref();
+				}
+				return surface;
+			}
+
+			// NOTE: cairo_image_surface_create_for_data() doesn't do a
+			// deep copy, so we can't use it.
+			// NOTE 2: cairo_image_surface_create() always returns a valid
+			// pointer, but the status may be CAIRO_STATUS_NULL_POINTER if
+			// it failed to create a surface. We'll still check for nullptr.
+			surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+			// cairo_image_surface_create() always returns a valid pointer.
+			assert(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
+			if (unlikely(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)) {
+				cairo_surface_destroy(surface);
+				if (img_prex) {
+					img_prex->unref();
+				}
+				return nullptr;
+			}
+
+			uint32_t *px_dest = reinterpret_cast<uint32_t*>(cairo_image_surface_get_data(surface));
+			assert(px_dest != nullptr);
+
 			// Copy the image data.
 			int dest_stride = cairo_image_surface_get_stride(surface);
-			int src_stride = img_prex->stride();
+			int src_stride = img_src->stride();
 
 			if (dest_stride == src_stride) {
 				// Stride is identical. Copy the whole image all at once.
 				// NOTE: Partial copy for the last line.
 				size_t sz = dest_stride * (height - 1);
 				sz += width * sizeof(uint32_t);
-				memcpy(px_dest, img_prex->bits(), sz);
+				memcpy(px_dest, img_src->bits(), sz);
 			} else {
 				// Stride is not identical. Copy each scanline.
-				const uint32_t *img_buf = static_cast<const uint32_t*>(img_prex->bits());
+				const uint32_t *img_buf = static_cast<const uint32_t*>(img_src->bits());
 				const int row_bytes = img->row_bytes();
 				// We're adding strides to pointers, so the strides
 				// must be in uint32_t units here.
@@ -85,10 +102,10 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 
 			// Mark the surface as dirty.
 			cairo_surface_mark_dirty(surface);
-			if (premultiply) {
+			if (img_prex) {
 				img_prex->unref();
 			}
-			break;
+			return surface;
 		}
 
 		case rp_image::Format::CI8: {
@@ -100,6 +117,19 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 			if (!palette || palette_len <= 0 || palette_len > 256)
 				break;
 
+			// NOTE: Cairo doesn't support 8bpp, so the image
+			// has to be converted to ARGB32.
+			cairo_surface_t *const surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+			// cairo_image_surface_create() always returns a valid pointer.
+			assert(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
+			if (unlikely(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)) {
+				cairo_surface_destroy(surface);
+				return nullptr;
+			}
+
+			uint32_t *px_dest = reinterpret_cast<uint32_t*>(cairo_image_surface_get_data(surface));
+			assert(px_dest != nullptr);
+
 			// Premultiply the palette.
 			std::array<uint32_t, 256> pal_prex;
 			const uint32_t *pal_toUse;
@@ -134,8 +164,6 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 				for (; x > 0; x--, px_dest++, img_buf++) {
 					// Last pixels.
 					*px_dest = pal_toUse[*img_buf];
-					px_dest++;
-					img_buf++;
 				}
 
 				// Next line.
@@ -145,16 +173,14 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 
 			// Mark the surface as dirty.
 			cairo_surface_mark_dirty(surface);
-			break;
+			return surface;
 		}
 
 		default:
 			// Unsupported image format.
 			assert(!"Unsupported rp_image::Format.");
-			cairo_surface_destroy(surface);
-			surface = nullptr;
 			break;
 	}
 
-	return surface;
+	return nullptr;
 }
@@ -9,8 +9,8 @@
 #ifndef __ROMPROPERTIES_GTK_CAIROIMAGECONV_HPP__
 #define __ROMPROPERTIES_GTK_CAIROIMAGECONV_HPP__
 
-// NOTE: Cairo doesn't natively support 8bpp. Because of this,
-// we can't simply make a cairo_surface_t rp_image backend.
+// NOTE: Cairo doesn't natively support 8bpp, so CairoImageBackend
+// only uses a cairo_surface_t for ARGB32 images.
 
 #include "common.h"
 #include "librpcpu/cpu_dispatch.h"
@@ -31,6 +31,10 @@ class CairoImageConv
 	public:
 		/**
 		 * Convert an rp_image to cairo_surface_t.
+		 *
+		 * If the image uses CairoImageBackend, the backend's surface
+		 * is returned without copying the image data.
+		 *
 		 * @param img		[in] rp_image.
 		 * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
 		 * @return cairo_surface_t, or nullptr on error.
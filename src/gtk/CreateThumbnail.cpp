@@ -7,8 +7,12 @@
  ***************************************************************************/
 
 #include "stdafx.h"
+#ifdef RP_GTK_USE_CAIRO
+#  include "CairoImageBackend.hpp"
+#endif /* RP_GTK_USE_CAIRO */
 
 // librpbase, librptexture
+#include "librpbase/Profiler.hpp"
 using namespace LibRpBase;
 using LibRpTexture::rp_image;
 
@@ -283,6 +287,12 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	g_type_init();
 #endif
 
+#ifdef RP_GTK_USE_CAIRO
+	// Register CairoImageBackend.
+	// This allows image decoders to write directly to a cairo_surface_t.
+	rp_image::setBackendCreatorFn(CairoImageBackend::creator_fn);
+#endif /* RP_GTK_USE_CAIRO */
+
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
@@ -311,6 +321,7 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	unique_ptr<CreateThumbnailPrivate> d(new CreateThumbnailPrivate());
 	CreateThumbnailPrivate::GetThumbnailOutParams_t outParams;
 	ret = d->getThumbnail(romData, maximum_size, &outParams);
+	Profiler::dumpFromEnv(source_file);
 	if (ret != 0 || !d->isImgClassValid(outParams.retImg)) {
 		// No image.
 		if (outParams.retImg) {
@@ -344,6 +355,7 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 		ret = RPCT_OUTPUT_FILE_FAILED;
 		goto cleanup;
 	}
+	pngWriter->setProfile(Config::instance()->thumbnailPngProfile());
 
 	/** tEXt chunks. **/
 	// NOTE: These are written before IHDR in order to put the
@@ -21,6 +21,9 @@
 // Custom widgets
 #include "DragImage.hpp"
 #include "MessageWidget.hpp"
+#ifdef RP_GTK_USE_CAIRO
+#  include "CairoImageBackend.hpp"
+#endif /* RP_GTK_USE_CAIRO */
 #include "LanguageComboBox.hpp"
 #include "OptionsMenuButton.hpp"
 
@@ -204,6 +207,11 @@ rom_data_view_class_init(RomDataViewClass *klass)
 	gobject_class->get_property = rom_data_view_get_property;
 	gobject_class->set_property = rom_data_view_set_property;
 
+#ifdef RP_GTK_USE_CAIRO
+	// Register CairoImageBackend.
+	rp_image::setBackendCreatorFn(CairoImageBackend::creator_fn);
+#endif /* RP_GTK_USE_CAIRO */
+
 	/** Properties **/
 
 	klass->properties[PROP_URI] = g_param_spec_string(
@@ -75,6 +75,14 @@ int rpt_do_security_options(void)
 		SCMP_SYS(statx),
 #endif /* __SNR_statx || __NR_statx */
 
+		// LibRomData::CacheIndex
+		SCMP_SYS(flock),	// CacheIndexLock
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// CacheIndexPrivate::compact()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// CacheIndexPrivate::evict()
+
 		// glibc ncsd
 		// TODO: Restrict connect() to AF_UNIX.
 		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
@@ -87,6 +95,9 @@ int rpt_do_security_options(void)
 		SCMP_SYS(fcntl), SCMP_SYS(fcntl64),
 		SCMP_SYS(getdents), SCMP_SYS(getdents64)	// g_file_new_for_uri() [rp_create_thumbnail()]
 		SCMP_SYS(getegid), SCMP_SYS(geteuid), SCMP_SYS(poll),
+#if defined(__SNR_ppoll) || defined(__NR_ppoll)
+		SCMP_SYS(ppoll),	// poll() on some architectures
+#endif /* __SNR_ppoll || __NR_ppoll */
 		SCMP_SYS(recvfrom), SCMP_SYS(sendmsg), SCMP_SYS(socket),
 		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
 
@@ -14,6 +14,7 @@
 #include "AchQtDBus.hpp"
 
 // librpbase, librptexture
+#include "librpbase/Profiler.hpp"
 using namespace LibRpBase;
 using LibRpTexture::rp_image;
 
@@ -240,6 +241,7 @@ bool RomThumbCreator::create(const QString &path, int width, int height, QImage
 	Q_D(RomThumbCreator);
 	RomThumbCreatorPrivate::GetThumbnailOutParams_t outParams;
 	int ret = d->getThumbnail(file, width, &outParams);
+	Profiler::dumpFromEnv(path.toUtf8().constData());
 	if (ret == 0) {
 		img = outParams.retImg;
 	}
@@ -306,6 +308,7 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	RomThumbCreatorPrivate::GetThumbnailOutParams_t outParams;
 	int ret = d->getThumbnail(romData, maximum_size, &outParams);
 	delete d;
+	Profiler::dumpFromEnv(source_file);
 
 	if (ret != 0 || outParams.retImg.isNull()) {
 		// No image.
@@ -351,6 +354,7 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 		romData->unref();
 		return RPCT_OUTPUT_FILE_FAILED;
 	}
+	pngWriter->setProfile(Config::instance()->thumbnailPngProfile());
 
 	// Software.
 	static const char sw[] = "ROM Properties Page shell extension (" RP_KDE_UPPER QT_MAJOR_STR ")";
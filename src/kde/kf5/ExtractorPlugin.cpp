@@ -83,7 +83,9 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 
 	// Get the appropriate RomData class for this ROM.
 	// file is dup()'d by RomData.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA);
+	// NOTE: Only metadata is needed, so fields and images won't be loaded.
+	RomData *const romData = RomDataFactory::create(file,
+		RomDataFactory::RDA_HAS_METADATA | RomDataFactory::RDA_METADATA_ONLY);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
@@ -61,7 +61,7 @@ OverlayIconPlugin::OverlayIconPlugin(QObject *parent)
 
 QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 {
-	// TODO: Check for slow devices and/or cache this?
+	// TODO: Check for slow devices?
 	QStringList sl;
 
 	const Config *const config = Config::instance();
@@ -77,20 +77,15 @@ QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 		return sl;
 	}
 
-	// Get the appropriate RomData class for this ROM.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
-	file->unref();	// file is ref()'d by RomData.
-	if (!romData) {
-		// No RomData.
-		return sl;
-	}
-
 	// If the ROM image has "dangerous" permissions,
 	// return the "security-medium" overlay icon.
-	if (romData->hasDangerousPermissions()) {
+	// NOTE: This uses a light-weight probe and a per-file cache
+	// instead of constructing a full RomData object, since
+	// this is called for every file in a directory listing.
+	if (RomDataFactory::hasDangerousPermissions(file)) {
 		sl += QLatin1String("security-medium");
 	}
-	romData->unref();
+	file->unref();
 
 	return sl;
 }
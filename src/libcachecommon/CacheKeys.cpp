@@ -302,8 +302,81 @@ int filterCacheKey(wchar_t *pCacheKey)
 }
 #endif /* _WIN32 */
 
+/**
+ * Calculate the shard subdirectory number for a cache filename.
+ *
+ * This is the low 8 bits of the 32-bit FNV-1a hash of the filename
+ * component of the cache key, which distributes each cache directory's
+ * files across 256 subdirectories.
+ *
+ * @param filename Filename component of the cache key. (UTF-8)
+ * @param len Length of filename, in bytes.
+ * @return Shard subdirectory number. (0-255)
+ */
+static inline unsigned int getCacheShard(const char *filename, size_t len)
+{
+	uint32_t hash = 2166136261U;
+	for (; len > 0; len--, filename++) {
+		hash ^= static_cast<uint8_t>(*filename);
+		hash *= 16777619U;
+	}
+	return (hash & 0xFF);
+}
+
+/**
+ * Insert the shard subdirectory into a filtered cache key.
+ * "wii/disc/US/RSPE01.png" -> "wii/disc/US/1f/RSPE01.png"
+ * @param filteredCacheKey Filtered cache key. (UTF-8)
+ * @return Sharded cache key.
+ */
+static string shardCacheKey(const string &filteredCacheKey)
+{
+	const size_t slash_pos = filteredCacheKey.rfind(DIR_SEP_CHR);
+	const size_t fn_pos = (slash_pos != string::npos ? slash_pos + 1 : 0);
+
+	char shard[4];
+	snprintf(shard, sizeof(shard), "%02x%c",
+		getCacheShard(&filteredCacheKey[fn_pos], filteredCacheKey.size() - fn_pos),
+		DIR_SEP_CHR);
+
+	string shardedCacheKey(filteredCacheKey, 0, fn_pos);
+	shardedCacheKey.reserve(filteredCacheKey.size() + 3);
+	shardedCacheKey += shard;
+	shardedCacheKey.append(filteredCacheKey, fn_pos, string::npos);
+	return shardedCacheKey;
+}
+
+/**
+ * Combine a filtered cache key with the user's cache directory.
+ * @param filteredCacheKey Filtered cache key.
+ * @return Cache filename, or empty string if the cache directory isn't available.
+ */
+static string getUserCacheFilename(const string &filteredCacheKey)
+{
+	// Make sure the cache directory is initialized.
+	// NOTE: May be empty if the cache directory isn't
+	// accessible, e.g. when running under bubblewrap.
+	const string &cache_dir = getCacheDirectory();
+	if (cache_dir.empty()) {
+		return string();
+	}
+
+	// This is the cache directory plus the cache key.
+	string cacheFilename = cache_dir;
+	if (cacheFilename.at(cacheFilename.size()-1) != DIR_SEP_CHR) {
+		cacheFilename += DIR_SEP_CHR;
+	}
+	cacheFilename += filteredCacheKey;
+	return cacheFilename;
+}
+
 /**
  * Combine a cache key with the cache directory to get a cache filename.
+ *
+ * Files in the user's cache directory are sharded into 256
+ * subdirectories based on a hash of the filename in order to
+ * keep directory lookups fast with large caches.
+ *
  * @param cacheKey Cache key. (Must be UTF-8, NULL-terminated.) (Will be filtered using filterCacheKey().)
  * @return Cache filename, or empty string on error.
  */
@@ -325,27 +398,14 @@ string getCacheFilename(const char *pCacheKey)
 	}
 
 	// Cache filename in the user's directory.
-	string cacheFilename_user;
-
-	// Make sure the cache directory is initialized.
-	// NOTE: May be empty if the cache directory isn't
-	// accessible, e.g. when running under bubblewrap.
-	const string &cache_dir = getCacheDirectory();
-	if (!cache_dir.empty()) {
-		// Get the cache filename.
-		// This is the cache directory plus the cache key.
-		cacheFilename_user = cache_dir;
-		if (cacheFilename_user.at(cacheFilename_user.size()-1) != DIR_SEP_CHR) {
-			cacheFilename_user += DIR_SEP_CHR;
-		}
-		cacheFilename_user += filteredCacheKey;
-	}
+	const string cacheFilename_user = getUserCacheFilename(shardCacheKey(filteredCacheKey));
 
 #ifdef DIR_INSTALL_CACHE
 	// If the requested file is in the system-wide cache directory,
 	// but is not in the user's cache directory, use the system-wide
 	// version. This is useful in cases where the thumbnailer cannot
 	// download files, e.g. bubblewrap.
+	// NOTE: The system-wide cache directory is not sharded.
 	string cacheFilename_sys = DIR_INSTALL_CACHE;
 	if (cacheFilename_sys.at(cacheFilename_sys.size()-1) != DIR_SEP_CHR) {
 		cacheFilename_sys += DIR_SEP_CHR;
@@ -367,6 +427,32 @@ string getCacheFilename(const char *pCacheKey)
 	return cacheFilename_user;
 }
 
+/**
+ * Get a cache filename using the original, non-sharded layout.
+ * This is used to migrate files from older versions.
+ * @param cacheKey Cache key. (Must be UTF-8, NULL-terminated.) (Will be filtered using filterCacheKey().)
+ * @return Cache filename in the user's cache directory, or empty string on error.
+ */
+string getLegacyCacheFilename(const char *pCacheKey)
+{
+	assert(pCacheKey != nullptr);
+	assert(pCacheKey[0] != '\0');
+	if (!pCacheKey || pCacheKey[0] == '\0') {
+		// No cache key...
+		return string();
+	}
+
+	// Filter the cache key.
+	string filteredCacheKey = pCacheKey;
+	int ret = filterCacheKey(filteredCacheKey);
+	if (ret != 0) {
+		// Invalid cache key.
+		return string();
+	}
+
+	return getUserCacheFilename(filteredCacheKey);
+}
+
 #ifdef _WIN32
 /**
  * Internal U82W() function.
@@ -389,6 +475,27 @@ static inline wstring U82W(const string &mbs)
 	return ws_ret;
 }
 
+/**
+ * Internal W2U8() function.
+ * @param wcs UTF-16 string.
+ * @return UTF-8 C++ string.
+ */
+static inline string W2U8(const wstring &wcs)
+{
+	string s_ret;
+
+	int cbMbs = WideCharToMultiByte(CP_UTF8, 0, wcs.c_str(), static_cast<int>(wcs.size()), nullptr, 0, nullptr, nullptr);
+	if (cbMbs <= 0) {
+		return s_ret;
+	}
+
+	char *mbs = new char[cbMbs];
+	WideCharToMultiByte(CP_UTF8, 0, wcs.c_str(), static_cast<int>(wcs.size()), mbs, cbMbs, nullptr, nullptr);
+	s_ret.assign(mbs, cbMbs);
+	delete[] mbs;
+	return s_ret;
+}
+
 /**
  * Combine a cache key with the cache directory to get a cache filename.
  * @param cacheKey Cache key. (Must be UTF-16.) (Will be filtered using filterCacheKey().)
@@ -419,6 +526,17 @@ wstring getCacheFilename(const wchar_t *pCacheKey)
 		return cacheFilename_user;
 	}
 
+	// Get the shard subdirectory.
+	// NOTE: The shard is calculated using the UTF-8 filename
+	// in order to match the UTF-8 version of this function.
+	const size_t slash_pos = filteredCacheKey.rfind(DIR_SEP_WCHR);
+	const size_t fn_pos = (slash_pos != wstring::npos ? slash_pos + 1 : 0);
+	const string u8filename = W2U8(filteredCacheKey.substr(fn_pos));
+	wchar_t shard[4];
+	_snwprintf(shard, _countof(shard), L"%02x%c",
+		getCacheShard(u8filename.data(), u8filename.size()), DIR_SEP_WCHR);
+	filteredCacheKey.insert(fn_pos, shard);
+
 	// Get the cache filename.
 	// This is the cache directory plus the cache key.
 	cacheFilename_user = U82W(cache_dir);
@@ -60,6 +60,11 @@ static inline int filterCacheKey(std::wstring &cacheKey)
 
 /**
  * Get a cache filename.
+ *
+ * Files in the user's cache directory are sharded into 256
+ * subdirectories based on a hash of the filename in order to
+ * keep directory lookups fast with large caches.
+ *
  * @param cacheKey Cache key. (Must be UTF-8, NULL-terminated.) (Will be filtered using filterCacheKey().)
  * @return Cache filename, or empty string on error.
  */
@@ -75,6 +80,25 @@ static inline std::string getCacheFilename(const std::string &cacheKey)
 	return getCacheFilename(cacheKey.c_str());
 }
 
+/**
+ * Get a cache filename using the original, non-sharded layout.
+ * This is used to migrate files from older versions.
+ * @param cacheKey Cache key. (Must be UTF-8, NULL-terminated.) (Will be filtered using filterCacheKey().)
+ * @return Cache filename in the user's cache directory, or empty string on error.
+ */
+std::string getLegacyCacheFilename(const char *pCacheKey);
+
+/**
+ * Get a cache filename using the original, non-sharded layout.
+ * This is used to migrate files from older versions.
+ * @param cacheKey Cache key. (Must be UTF-8.) (Will be filtered using filterCacheKey().)
+ * @return Cache filename in the user's cache directory, or empty string on error.
+ */
+static inline std::string getLegacyCacheFilename(const std::string &cacheKey)
+{
+	return getLegacyCacheFilename(cacheKey.c_str());
+}
+
 #ifdef _WIN32
 /**
  * Get a cache filename.
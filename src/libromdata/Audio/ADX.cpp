@@ -64,6 +64,19 @@ ADXPrivate::ADXPrivate(ADX *q, IRpFile *file)
  * @param file Open ROM image.
  */
 ADX::ADX(IRpFile *file)
+	: ADX(file, nullptr)
+{ }
+
+/**
+ * Read a CRI ADX audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+ADX::ADX(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new ADXPrivate(this, file))
 {
 	RP_D(ADX);
@@ -79,8 +92,7 @@ ADX::ADX(IRpFile *file)
 	// Read 4,096 bytes to ensure we have enough
 	// data to detect the copyright string.
 	uint8_t header[4096];
-	d->file->rewind();
-	size_t size = d->file->read(header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header, sizeof(header));
 	if (size != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
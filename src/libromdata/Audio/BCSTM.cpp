@@ -121,6 +121,19 @@ BCSTMPrivate::BCSTMPrivate(BCSTM *q, IRpFile *file)
  * @param file Open ROM image.
  */
 BCSTM::BCSTM(IRpFile *file)
+	: BCSTM(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo 3DS BCSTM audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+BCSTM::BCSTM(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new BCSTMPrivate(this, file))
 {
 	RP_D(BCSTM);
@@ -133,8 +146,7 @@ BCSTM::BCSTM(IRpFile *file)
 	}
 
 	// Read the BCSTM header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->bcstmHeader, sizeof(d->bcstmHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->bcstmHeader, sizeof(d->bcstmHeader));
 	if (size != sizeof(d->bcstmHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(BCSTM)
+ROMDATA_DECL_CTOR_DETECTINFO(BCSTM)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_END()
 
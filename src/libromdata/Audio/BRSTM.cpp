@@ -88,6 +88,19 @@ BRSTMPrivate::BRSTMPrivate(BRSTM *q, IRpFile *file)
  * @param file Open ROM image.
  */
 BRSTM::BRSTM(IRpFile *file)
+	: BRSTM(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo Wii BRSTM audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+BRSTM::BRSTM(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new BRSTMPrivate(this, file))
 {
 	RP_D(BRSTM);
@@ -101,8 +114,7 @@ BRSTM::BRSTM(IRpFile *file)
 	}
 
 	// Read the BRSTM header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->brstmHeader, sizeof(d->brstmHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->brstmHeader, sizeof(d->brstmHeader));
 	if (size != sizeof(d->brstmHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -62,6 +62,19 @@ GBSPrivate::GBSPrivate(GBS *q, IRpFile *file)
  * @param file Open ROM image.
  */
 GBS::GBS(IRpFile *file)
+	: GBS(file, nullptr)
+{ }
+
+/**
+ * Read a GBS audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+GBS::GBS(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new GBSPrivate(this, file))
 {
 	RP_D(GBS);
@@ -75,8 +88,7 @@ GBS::GBS(IRpFile *file)
 	}
 
 	// Read the GBS header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->gbsHeader, sizeof(d->gbsHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->gbsHeader, sizeof(d->gbsHeader));
 	if (size != sizeof(d->gbsHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -62,6 +62,19 @@ NSFPrivate::NSFPrivate(NSF *q, IRpFile *file)
  * @param file Open ROM image.
  */
 NSF::NSF(IRpFile *file)
+	: NSF(file, nullptr)
+{ }
+
+/**
+ * Read an NSF audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+NSF::NSF(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new NSFPrivate(this, file))
 {
 	RP_D(NSF);
@@ -75,8 +88,7 @@ NSF::NSF(IRpFile *file)
 	}
 
 	// Read the NSF header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->nsfHeader, sizeof(d->nsfHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->nsfHeader, sizeof(d->nsfHeader));
 	if (size != sizeof(d->nsfHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
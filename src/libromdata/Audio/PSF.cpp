@@ -352,6 +352,19 @@ unsigned int PSFPrivate::lengthToMs(const char *str)
  * @param file Open ROM image.
  */
 PSF::PSF(IRpFile *file)
+	: PSF(file, nullptr)
+{ }
+
+/**
+ * Read an PSF audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+PSF::PSF(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new PSFPrivate(this, file))
 {
 	RP_D(PSF);
@@ -365,8 +378,7 @@ PSF::PSF(IRpFile *file)
 	}
 
 	// Read the PSF header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->psfHeader, sizeof(d->psfHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->psfHeader, sizeof(d->psfHeader));
 	if (size != sizeof(d->psfHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -431,6 +431,19 @@ SAPPrivate::TagData SAPPrivate::parseTags(void)
  * @param file Open ROM image.
  */
 SAP::SAP(IRpFile *file)
+	: SAP(file, nullptr)
+{ }
+
+/**
+ * Read an SAP audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+SAP::SAP(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new SAPPrivate(this, file))
 {
 	RP_D(SAP);
@@ -445,8 +458,7 @@ SAP::SAP(IRpFile *file)
 
 	// Read the SAP header.
 	uint8_t buf[16];
-	d->file->rewind();
-	size_t size = d->file->read(buf, sizeof(buf));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, buf, sizeof(buf));
 	if (size != sizeof(buf)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
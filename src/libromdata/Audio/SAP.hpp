@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(SAP)
+ROMDATA_DECL_CTOR_DETECTINFO(SAP)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_END()
 
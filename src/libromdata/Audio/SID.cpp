@@ -62,6 +62,19 @@ SIDPrivate::SIDPrivate(SID *q, IRpFile *file)
  * @param file Open ROM image.
  */
 SID::SID(IRpFile *file)
+	: SID(file, nullptr)
+{ }
+
+/**
+ * Read an SID audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+SID::SID(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new SIDPrivate(this, file))
 {
 	RP_D(SID);
@@ -75,8 +88,7 @@ SID::SID(IRpFile *file)
 	}
 
 	// Read the SID header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->sidHeader, sizeof(d->sidHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->sidHeader, sizeof(d->sidHeader));
 	if (size != sizeof(d->sidHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(SID)
+ROMDATA_DECL_CTOR_DETECTINFO(SID)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_END()
 
@@ -201,9 +201,9 @@ SNDHPrivate::TagData SNDHPrivate::parseTags(void)
 		// Packed with ICE.
 		// FIXME: Return an error if unpacking fails.
 #ifdef ENABLE_UNICE68
-		// Decompress the data.
-		// FIXME: unice68_depacker() only supports decompressing the entire file.
-		// Add a variant that supports buffer sizes.
+		// Decompress the beginning of the data.
+		// NOTE: ICE depacks backwards, so the entire file must be read,
+		// but only the first 4 KB of depacked data is kept in memory.
 		const off64_t fileSize = file->size();
 		if (fileSize < 16) {
 			return tags;
@@ -218,12 +218,12 @@ SNDHPrivate::TagData SNDHPrivate::parseTags(void)
 		if (reqSize <= 0) {
 			return tags;
 		}
-		header.reset(new uint8_t[reqSize+1]);
-		int ret = unice68_depacker(header.get(), reqSize, inbuf.get(), fileSize);
-		if (ret != 0) {
+		headerSize = std::min(4096, reqSize);
+		int ret = unice68_depacker_prefix(header.get(), headerSize, inbuf.get(), fileSize);
+		if (ret < 16) {
 			return tags;
 		}
-		headerSize = std::min(4096, reqSize);
+		headerSize = static_cast<size_t>(ret);
 		header[headerSize] = 0;	// ensure NULL-termination
 #else /* !ENABLE_UNICE68 */
 		// unice68 is disabled.
@@ -608,6 +608,19 @@ SNDHPrivate::TagData SNDHPrivate::parseTags(void)
  * @param file Open ROM image.
  */
 SNDH::SNDH(IRpFile *file)
+	: SNDH(file, nullptr)
+{ }
+
+/**
+ * Read an SNDH audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+SNDH::SNDH(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new SNDHPrivate(this, file))
 {
 	RP_D(SNDH);
@@ -625,8 +638,7 @@ SNDH::SNDH(IRpFile *file)
 	// ICE-packed files:
 	// - Connolly_Sean/Viking_Child.sndh: Has 'HDNS' at 0x1F4.
 	uint8_t buf[512];
-	d->file->rewind();
-	size_t size = d->file->read(buf, sizeof(buf));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, buf, sizeof(buf));
 	// NOTE: Allowing less than 512 bytes, since some
 	// ICE-compressed SNDH files are really small.
 	// - Lowe_Al/Kings_Quest_II.sndh: 453 bytes.
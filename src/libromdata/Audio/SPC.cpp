@@ -495,6 +495,19 @@ SPCPrivate::TagData SPCPrivate::parseTags(void)
  * @param file Open ROM image.
  */
 SPC::SPC(IRpFile *file)
+	: SPC(file, nullptr)
+{ }
+
+/**
+ * Read an SPC audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+SPC::SPC(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new SPCPrivate(this, file))
 {
 	RP_D(SPC);
@@ -508,8 +521,7 @@ SPC::SPC(IRpFile *file)
 	}
 
 	// Read the SPC header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->spcHeader, sizeof(d->spcHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->spcHeader, sizeof(d->spcHeader));
 	if (size != sizeof(d->spcHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
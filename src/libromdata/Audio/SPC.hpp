@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(SPC)
+ROMDATA_DECL_CTOR_DETECTINFO(SPC)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_END()
 
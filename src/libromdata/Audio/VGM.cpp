@@ -233,6 +233,19 @@ void VGMPrivate::addCommonSoundChip(unsigned int clk_full, const char *display)
  * @param file Open ROM image.
  */
 VGM::VGM(IRpFile *file)
+	: VGM(file, nullptr)
+{ }
+
+/**
+ * Read an VGM audio file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+VGM::VGM(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new VGMPrivate(this, file))
 {
 	RP_D(VGM);
@@ -246,8 +259,7 @@ VGM::VGM(IRpFile *file)
 	}
 
 	// Read the VGM header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->vgmHeader, sizeof(d->vgmHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->vgmHeader, sizeof(d->vgmHeader));
 	if (size != sizeof(d->vgmHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
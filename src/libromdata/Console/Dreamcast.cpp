@@ -291,6 +291,19 @@ void DreamcastPrivate::parseDiscNumber(uint8_t &disc_num, uint8_t &disc_total) c
  * @param file Open ROM image.
  */
 Dreamcast::Dreamcast(IRpFile *file)
+	: Dreamcast(file, nullptr)
+{ }
+
+/**
+ * Read a Sega Dreamcast disc image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Dreamcast::Dreamcast(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new DreamcastPrivate(this, file))
 {
 	// This class handles disc images.
@@ -307,8 +320,7 @@ Dreamcast::Dreamcast(IRpFile *file)
 	// NOTE: Reading 2352 bytes due to CD-ROM sector formats.
 	// NOTE 2: May be smaller if this is a cuesheet.
 	CDROM_2352_Sector_t sector;
-	d->file->rewind();
-	size_t size = d->file->read(&sector, sizeof(sector));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &sector, sizeof(sector));
 	if (size == 0 || size > sizeof(sector)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
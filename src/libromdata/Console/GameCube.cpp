@@ -657,6 +657,19 @@ const char *GameCubePrivate::wii_getCryptoStatus(WiiPartition *partition)
  * @param file Open disc image.
  */
 GameCube::GameCube(IRpFile *file)
+	: GameCube(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo GameCube or Wii disc image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+GameCube::GameCube(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new GameCubePrivate(this, file))
 {
 	// This class handles disc images.
@@ -671,8 +684,7 @@ GameCube::GameCube(IRpFile *file)
 
 	// Read the disc header.
 	uint8_t header[4096+256];
-	d->file->rewind();
-	size_t size = d->file->read(&header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &header, sizeof(header));
 	if (size != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -220,6 +220,19 @@ string GameCubeBNRPrivate::getGameInfoString(const gcn_banner_comment_t *comment
  * @param file Open disc image.
  */
 GameCubeBNR::GameCubeBNR(IRpFile *file)
+	: GameCubeBNR(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo GameCube banner file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+GameCubeBNR::GameCubeBNR(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new GameCubeBNRPrivate(this, file))
 {
 	// This class handles save files.
@@ -237,8 +250,7 @@ GameCubeBNR::GameCubeBNR(IRpFile *file)
 
 	// Read the magic number.
 	uint32_t bnr_magic;
-	d->file->rewind();
-	size_t size = d->file->read(&bnr_magic, sizeof(bnr_magic));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &bnr_magic, sizeof(bnr_magic));
 	if (size != sizeof(bnr_magic)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(GameCubeBNR)
+ROMDATA_DECL_CTOR_DETECTINFO(GameCubeBNR)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
@@ -522,6 +522,19 @@ const rp_image *GameCubeSavePrivate::loadBanner(void)
  * @param file Open disc image.
  */
 GameCubeSave::GameCubeSave(IRpFile *file)
+	: GameCubeSave(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo GameCube save file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+GameCubeSave::GameCubeSave(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new GameCubeSavePrivate(this, file))
 {
 	// This class handles save files.
@@ -537,8 +550,7 @@ GameCubeSave::GameCubeSave(IRpFile *file)
 
 	// Read the save file header.
 	uint8_t header[1024];
-	d->file->rewind();
-	size_t size = d->file->read(&header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &header, sizeof(header));
 	if (size != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
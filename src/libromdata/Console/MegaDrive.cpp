@@ -695,6 +695,19 @@ string MegaDrivePrivate::getPublisher(const MD_RomHeader *pRomHeader)
  * @param file Open ROM file.
  */
 MegaDrive::MegaDrive(IRpFile *file)
+	: MegaDrive(file, nullptr)
+{ }
+
+/**
+ * Read a Sega Mega Drive ROM.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+MegaDrive::MegaDrive(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new MegaDrivePrivate(this, file))
 {
 	RP_D(MegaDrive);
@@ -705,12 +718,9 @@ MegaDrive::MegaDrive(IRpFile *file)
 		return;
 	}
 
-	// Seek to the beginning of the file.
-	d->file->rewind();
-
 	// Read the ROM header. [0x800 bytes; minimum 0x200]
 	uint8_t header[0x800];
-	size_t size = d->file->read(header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header, sizeof(header));
 	if (size < 0x200) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -77,6 +77,19 @@ N64Private::N64Private(N64 *q, IRpFile *file)
  * @param file Open ROM image.
  */
 N64::N64(IRpFile *file)
+	: N64(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo 64 ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+N64::N64(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new N64Private(this, file))
 {
 	RP_D(N64);
@@ -89,8 +102,7 @@ N64::N64(IRpFile *file)
 	}
 
 	// Read the ROM image header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->romHeader, sizeof(d->romHeader));
 	if (size != sizeof(d->romHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(N64)
+ROMDATA_DECL_CTOR_DETECTINFO(N64)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_END()
 
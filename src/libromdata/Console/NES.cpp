@@ -362,6 +362,19 @@ skip_board_info_check:
  * @param file Open ROM file.
  */
 NES::NES(IRpFile *file)
+	: NES(file, nullptr)
+{ }
+
+/**
+ * Read an NES ROM.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+NES::NES(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new NESPrivate(this, file))
 {
 	RP_D(NES);
@@ -371,14 +384,11 @@ NES::NES(IRpFile *file)
 		// Could not ref() the file handle.
 		return;
 	}
-	
-	// Seek to the beginning of the header.
-	d->file->rewind();
 
 	// Read the ROM header. [128 bytes]
 	// NOTE: Allowing smaller headers for certain types.
 	uint8_t header[128];
-	size_t size = d->file->read(header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header, sizeof(header));
 	if (size < 16) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(NES)
+ROMDATA_DECL_CTOR_DETECTINFO(NES)
 ROMDATA_DECL_END()
 
 }
@@ -301,6 +301,19 @@ RomData *PlayStationDiscPrivate::openBootExe(void)
  * @param file Open ROM image.
  */
 PlayStationDisc::PlayStationDisc(IRpFile *file)
+	: PlayStationDisc(file, nullptr)
+{ }
+
+/**
+ * Read a Sony PlayStation 1 or 2 disc image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+PlayStationDisc::PlayStationDisc(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new PlayStationDiscPrivate(this, file))
 {
 	// This class handles disc images.
@@ -317,7 +330,7 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 	IDiscReader *discReader = nullptr;
 
 	// Check for a PVD with 2048-byte sectors.
-	size_t size = d->file->seekAndRead(ISO_PVD_ADDRESS_2048, &d->pvd, sizeof(d->pvd));
+	size_t size = d->seekAndReadHeader(detectInfo, ISO_PVD_ADDRESS_2048, &d->pvd, sizeof(d->pvd));
 	if (size != sizeof(d->pvd)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -331,7 +344,7 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 		CDROM_2352_Sector_t sector;
 
 		for (const unsigned int *p = sector_sizes; *p != 0; p++) {
-			size_t size = d->file->seekAndRead(*p * ISO_PVD_LBA, &sector, sizeof(sector));
+			size_t size = d->seekAndReadHeader(detectInfo, *p * ISO_PVD_LBA, &sector, sizeof(sector));
 			if (size != sizeof(d->pvd)) {
 				UNREF_AND_NULL_NOCHK(d->file);
 				return;
@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(PlayStationDisc)
+ROMDATA_DECL_CTOR_DETECTINFO(PlayStationDisc)
 ROMDATA_DECL_CLOSE()
 
 	public:
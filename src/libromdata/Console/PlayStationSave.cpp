@@ -185,6 +185,19 @@ const rp_image *PlayStationSavePrivate::loadIcon(void)
  * @param file Open ROM image.
  */
 PlayStationSave::PlayStationSave(IRpFile *file)
+	: PlayStationSave(file, nullptr)
+{ }
+
+/**
+ * Read a PlayStation save file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+PlayStationSave::PlayStationSave(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new PlayStationSavePrivate(this, file))
 {
 	// This class handles save files.
@@ -200,8 +213,7 @@ PlayStationSave::PlayStationSave(IRpFile *file)
 
 	// Read the save file header.
 	uint8_t header[1024];
-	d->file->rewind();
-	size_t size = d->file->read(&header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &header, sizeof(header));
 	if (size != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -196,6 +196,19 @@ time_t Sega8BitPrivate::sdsc_date_to_unix_time(const Sega8_SDSC_Date *date)
  * @param file Open ROM image.
  */
 Sega8Bit::Sega8Bit(IRpFile *file)
+	: Sega8Bit(file, nullptr)
+{ }
+
+/**
+ * Read a Sega 8-bit (SMS/GG) ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Sega8Bit::Sega8Bit(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new Sega8BitPrivate(this, file))
 {
 	RP_D(Sega8Bit);
@@ -208,7 +221,7 @@ Sega8Bit::Sega8Bit(IRpFile *file)
 	}
 
 	// Read the ROM header.
-	size_t size = d->file->seekAndRead(0x7FE0, &d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0x7FE0, &d->romHeader, sizeof(d->romHeader));
 	if (size != sizeof(d->romHeader)) {
 		// Seek and/or read error.
 		UNREF_AND_NULL_NOCHK(d->file);
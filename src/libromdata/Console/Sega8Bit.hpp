@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(Sega8Bit)
+ROMDATA_DECL_CTOR_DETECTINFO(Sega8Bit)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_END()
 
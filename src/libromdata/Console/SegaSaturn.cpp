@@ -300,6 +300,19 @@ void SegaSaturnPrivate::parseDiscNumber(uint8_t &disc_num, uint8_t &disc_total)
  * @param file Open ROM image.
  */
 SegaSaturn::SegaSaturn(IRpFile *file)
+	: SegaSaturn(file, nullptr)
+{ }
+
+/**
+ * Read a Sega Saturn disc image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+SegaSaturn::SegaSaturn(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new SegaSaturnPrivate(this, file))
 {
 	// This class handles disc images.
@@ -316,8 +329,7 @@ SegaSaturn::SegaSaturn(IRpFile *file)
 	// Read the disc header.
 	// NOTE: Reading 2352 bytes due to CD-ROM sector formats.
 	CDROM_2352_Sector_t sector;
-	d->file->rewind();
-	size_t size = d->file->read(&sector, sizeof(sector));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &sector, sizeof(sector));
 	if (size != sizeof(sector)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -122,6 +122,19 @@ string SufamiTurboPrivate::getRomTitle(void) const
  * @param file Open ROM image.
  */
 SufamiTurbo::SufamiTurbo(IRpFile *file)
+	: SufamiTurbo(file, nullptr)
+{ }
+
+/**
+ * Read a Sufami Turbo ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+SufamiTurbo::SufamiTurbo(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new SufamiTurboPrivate(this, file))
 {
 	RP_D(SufamiTurbo);
@@ -134,12 +147,8 @@ SufamiTurbo::SufamiTurbo(IRpFile *file)
 		return;
 	}
 
-	// Seek to the beginning of the header.
-	d->file->rewind();
-
 	// Read the ROM header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->romHeader, sizeof(d->romHeader));
 	if (size != sizeof(d->romHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
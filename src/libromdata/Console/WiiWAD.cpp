@@ -221,6 +221,19 @@ int WiiWADPrivate::openSRL(void)
  * @param file Open disc image.
  */
 WiiWAD::WiiWAD(IRpFile *file)
+	: WiiWAD(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo Wii WAD file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+WiiWAD::WiiWAD(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new WiiWADPrivate(this, file))
 {
 	// This class handles application packages.
@@ -235,8 +248,7 @@ WiiWAD::WiiWAD(IRpFile *file)
 	}
 
 	// Read the WAD header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->wadHeader, sizeof(d->wadHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->wadHeader, sizeof(d->wadHeader));
 	if (size != sizeof(d->wadHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -226,6 +226,19 @@ const rp_image *WiiWIBNPrivate::loadBanner(void)
  * @param file Open disc image.
  */
 WiiWIBN::WiiWIBN(IRpFile *file)
+	: WiiWIBN(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo Wii save banner file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+WiiWIBN::WiiWIBN(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new WiiWIBNPrivate(this, file))
 {
 	// This class handles save files.
@@ -242,8 +255,7 @@ WiiWIBN::WiiWIBN(IRpFile *file)
 	}
 
 	// Read the save file header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->wibnHeader, sizeof(d->wibnHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->wibnHeader, sizeof(d->wibnHeader));
 	if (size != sizeof(d->wibnHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -532,6 +532,19 @@ Xbox360_XEX *Xbox360_STFS_Private::openDefaultXex(void)
  * @param file Open STFS file.
  */
 Xbox360_STFS::Xbox360_STFS(IRpFile *file)
+	: Xbox360_STFS(file, nullptr)
+{ }
+
+/**
+ * Read an Xbox 360 STFS file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Xbox360_STFS::Xbox360_STFS(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new Xbox360_STFS_Private(this, file))
 {
 	// This class handles application packages.
@@ -547,8 +560,7 @@ Xbox360_STFS::Xbox360_STFS(IRpFile *file)
 	}
 
 	// Read the STFS header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->stfsHeader, sizeof(d->stfsHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->stfsHeader, sizeof(d->stfsHeader));
 	if (size != sizeof(d->stfsHeader)) {
 		// Read error.
 		UNREF_AND_NULL_NOCHK(d->file);
@@ -15,6 +15,7 @@ namespace LibRomData {
 
 class Xbox360_STFS_Private;
 ROMDATA_DECL_BEGIN(Xbox360_STFS)
+ROMDATA_DECL_CTOR_DETECTINFO(Xbox360_STFS)
 ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
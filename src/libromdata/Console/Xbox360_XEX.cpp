@@ -34,6 +34,14 @@ using LibRpTexture::rp_image;
 #ifdef ENABLE_LIBMSPACK
 # include "mspack.h"
 # include "xenia_lzx.h"
+
+// Cache for extracted LZX data.
+# include "img/CacheIndex.hpp"
+# include "librpbase/config/Config.hpp"
+# include "librpfile/FileSystem.hpp"
+# include "librpfile/RpFile.hpp"
+# include "libcachecommon/CacheKeys.hpp"
+using LibRpFile::RpFile;
 #endif /* ENABLE_LIBMSPACK */
 
 // C++ STL classes.
@@ -130,6 +138,82 @@ class Xbox360_XEX_Private final : public RomDataPrivate
 		ao::uvector<uint8_t> lzx_peHeader;
 		// Decompressed XDBF section.
 		ao::uvector<uint8_t> lzx_xdbfSection;
+
+		// Maximum XDBF section size for LZX decompression.
+		static const uint32_t LZX_XDBF_MAX_SIZE = 64*1024*1024;
+
+		// LZX stream state for lzx_decompress_stream().
+		struct LzxStreamState {
+			// Input: De-blocked compressed data.
+			CBCReader *reader;
+			XEX2_Compression_Normal_Info lzx_blocks[2];
+			unsigned int lzx_idx;		// Current block
+			uint32_t block_remaining;	// Bytes remaining in the current block
+			uint16_t chunk_remaining;	// Bytes remaining in the current chunk
+			bool in_block;			// True if the current block was started
+
+			// Output: Only the requested ranges are kept.
+			uint32_t out_pos;
+			struct {
+				uint8_t *data;
+				uint32_t addr;
+				uint32_t size;
+			} out[2];
+		};
+
+		/**
+		 * LZX read callback. Reads de-blocked compressed data.
+		 * @param opaque LzxStreamState
+		 * @param buffer Output buffer.
+		 * @param size Size to read.
+		 * @return Number of bytes read, or -1 on error.
+		 */
+		static int lzx_read_cb(void *opaque, void *buffer, int size);
+
+		/**
+		 * LZX write callback. Saves the requested ranges.
+		 * @param opaque LzxStreamState
+		 * @param buffer Decompressed data.
+		 * @param size Size of decompressed data.
+		 * @return Number of bytes written.
+		 */
+		static int lzx_write_cb(void *opaque, const void *buffer, int size);
+
+		/**
+		 * Decompress the PE header and XDBF section from an LZX-compressed executable.
+		 * Decompression stops after the end of the XDBF section.
+		 * lzx_peHeader and lzx_xdbfSection are only modified on success.
+		 * @param reader	[in] CBCReader
+		 * @param first_block	[in] First block header (byteswapped)
+		 * @param window_size	[in] LZX window size
+		 * @param image_size	[in] Image size
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressLzx(CBCReader *reader, const XEX2_Compression_Normal_Info &first_block,
+			uint32_t window_size, uint32_t image_size);
+
+		/**
+		 * Get the cache filename for extracted LZX data.
+		 * The cache key is based on a hash of the XEX headers.
+		 * @param image_size Image size
+		 * @return Cache filename, or empty string on error.
+		 */
+		string getLzxCacheFilename(uint32_t image_size) const;
+
+		/**
+		 * Load extracted LZX data from the cache.
+		 * @param image_size Image size
+		 * @return Key index on success; negative POSIX error code on error.
+		 */
+		int loadLzxCache(uint32_t image_size);
+
+		/**
+		 * Save extracted LZX data to the cache.
+		 * @param image_size Image size
+		 * @param keyIdx Key index
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int saveLzxCache(uint32_t image_size, int keyIdx) const;
 #endif /* ENABLE_LIBMSPACK */
 
 		/**
@@ -236,8 +320,15 @@ class Xbox360_XEX_Private final : public RomDataPrivate
 		// Verification key data.
 		static const uint8_t EncryptionKeyVerifyData[Xbox360_XEX::Key_Max][16];
 #endif
+
+	public:
+		// Decompressed executable cache. (See Xbox360_XEX::setLzxCacheEnabled().)
+		static bool lzxCacheEnabled;
 };
 
+// Decompressed executable cache. (disabled by default)
+bool Xbox360_XEX_Private::lzxCacheEnabled = false;
+
 #ifdef ENABLE_DECRYPTION
 // Verification key names.
 const char *const Xbox360_XEX_Private::EncryptionKeyNames[Xbox360_XEX::Key_Max] = {
@@ -525,6 +616,392 @@ const XEX2_Resource_Info *Xbox360_XEX_Private::getXdbfResInfo(const char *resour
 	return &(ins_iter.first->second);
 }
 
+#ifdef ENABLE_LIBMSPACK
+/**
+ * LZX read callback. Reads de-blocked compressed data.
+ * @param opaque LzxStreamState
+ * @param buffer Output buffer.
+ * @param size Size to read.
+ * @return Number of bytes read, or -1 on error.
+ */
+int Xbox360_XEX_Private::lzx_read_cb(void *opaque, void *buffer, int size)
+{
+	LzxStreamState *const st = static_cast<LzxStreamState*>(opaque);
+	CBCReader *const reader = st->reader;
+	uint8_t *p = static_cast<uint8_t*>(buffer);
+	int total = 0;
+
+	// Based on: https://github.com/xenia-project/xenia/blob/5f764fc752c82674981a9f402f1bbd96b399112a/src/xenia/cpu/xex_module.cc
+	while (size > 0) {
+		if (st->chunk_remaining > 0) {
+			// Read data from the current chunk.
+			const int to_read = std::min(size, static_cast<int>(st->chunk_remaining));
+			if (reader->read(p, to_read) != static_cast<size_t>(to_read)) {
+				// Seek and/or read error.
+				return -1;
+			}
+			p += to_read;
+			total += to_read;
+			size -= to_read;
+			st->chunk_remaining -= to_read;
+			continue;
+		}
+
+		if (!st->in_block) {
+			// Start the next block.
+			const uint32_t block_size = st->lzx_blocks[st->lzx_idx].block_size;
+			if (block_size == 0) {
+				// End of the compressed data.
+				break;
+			}
+
+			// Read the next block header.
+			XEX2_Compression_Normal_Info *const next = &st->lzx_blocks[!st->lzx_idx];
+			if (reader->read(next, sizeof(*next)) != sizeof(*next)) {
+				// Seek and/or read error.
+				return -1;
+			}
+			next->block_size = be32_to_cpu(next->block_size);
+
+			// Do the block sizes make sense?
+			// If not, the decryption key is probably wrong.
+			if (next->block_size > 65536 || block_size <= sizeof(*next)) {
+				return -1;
+			}
+			st->block_remaining = block_size - sizeof(*next);
+			st->in_block = true;
+		}
+
+		// Get the next chunk size.
+		uint16_t chunk_size = 0;
+		if (st->block_remaining > 2) {
+			if (reader->read(&chunk_size, sizeof(chunk_size)) != sizeof(chunk_size)) {
+				// Seek and/or read error.
+				return -1;
+			}
+			chunk_size = be16_to_cpu(chunk_size);
+			st->block_remaining -= 2;
+		}
+
+		if (chunk_size == 0 || chunk_size > st->block_remaining) {
+			// End of block, or not enough data is available.
+			// Skip any empty data at the end of the block.
+			if (st->block_remaining > 0) {
+				reader->seek(reader->tell() + st->block_remaining);
+			}
+			st->in_block = false;
+			st->lzx_idx = !st->lzx_idx;
+			continue;
+		}
+
+		st->chunk_remaining = chunk_size;
+		st->block_remaining -= chunk_size;
+	}
+
+	return total;
+}
+
+/**
+ * LZX write callback. Saves the requested ranges.
+ * @param opaque LzxStreamState
+ * @param buffer Decompressed data.
+ * @param size Size of decompressed data.
+ * @return Number of bytes written.
+ */
+int Xbox360_XEX_Private::lzx_write_cb(void *opaque, const void *buffer, int size)
+{
+	LzxStreamState *const st = static_cast<LzxStreamState*>(opaque);
+	const uint8_t *const p = static_cast<const uint8_t*>(buffer);
+	const uint32_t pos = st->out_pos;
+	const uint32_t pos_end = pos + static_cast<uint32_t>(size);
+
+	for (const auto &out : st->out) {
+		if (!out.data)
+			continue;
+
+		// Copy the overlapping region, if any.
+		const uint32_t start = std::max(pos, out.addr);
+		const uint32_t end = std::min(pos_end, out.addr + out.size);
+		if (start < end) {
+			memcpy(out.data + (start - out.addr), p + (start - pos), end - start);
+		}
+	}
+
+	st->out_pos = pos_end;
+	return size;
+}
+
+/**
+ * Decompress the PE header and XDBF section from an LZX-compressed executable.
+ * Decompression stops after the end of the XDBF section.
+ * lzx_peHeader and lzx_xdbfSection are only modified on success.
+ * @param reader	[in] CBCReader
+ * @param first_block	[in] First block header (byteswapped)
+ * @param window_size	[in] LZX window size
+ * @param image_size	[in] Image size
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Xbox360_XEX_Private::decompressLzx(CBCReader *reader, const XEX2_Compression_Normal_Info &first_block,
+	uint32_t window_size, uint32_t image_size)
+{
+	assert(image_size >= PE_HEADER_SIZE);
+
+	// Find the XDBF section.
+	uint32_t xdbf_physaddr = 0, xdbf_size = 0;
+	const XEX2_Resource_Info *const pResInfo = getXdbfResInfo();
+	if (pResInfo) {
+		const uint32_t load_address = be32_to_cpu(
+			(xexType != XexType::XEX1
+				? secInfo.xex2.load_address
+				: secInfo.xex1.load_address));
+
+		xdbf_physaddr = pResInfo->vaddr - load_address;
+		if (pResInfo->size <= LZX_XDBF_MAX_SIZE &&
+		    static_cast<uint64_t>(xdbf_physaddr) + pResInfo->size <= image_size)
+		{
+			xdbf_size = pResInfo->size;
+		}
+	}
+
+	// Only decompress as much data as we need.
+	// NOTE: The XDBF section is usually near the end of the image.
+	uint32_t out_len = PE_HEADER_SIZE;
+	if (xdbf_size > 0 && xdbf_physaddr + xdbf_size > out_len) {
+		out_len = xdbf_physaddr + xdbf_size;
+	}
+
+	ao::uvector<uint8_t> peHeader(PE_HEADER_SIZE);
+	ao::uvector<uint8_t> xdbfSection(xdbf_size);
+
+	LzxStreamState st;
+	st.reader = reader;
+	st.lzx_blocks[0] = first_block;
+	memset(&st.lzx_blocks[1], 0, sizeof(st.lzx_blocks[1]));
+	st.lzx_idx = 0;
+	st.block_remaining = 0;
+	st.chunk_remaining = 0;
+	st.in_block = false;
+	st.out_pos = 0;
+	st.out[0].data = peHeader.data();
+	st.out[0].addr = 0;
+	st.out[0].size = PE_HEADER_SIZE;
+	st.out[1].data = (xdbf_size > 0 ? xdbfSection.data() : nullptr);
+	st.out[1].addr = xdbf_physaddr;
+	st.out[1].size = xdbf_size;
+
+	// Start at the beginning.
+	reader->rewind();
+	int res = lzx_decompress_stream(lzx_read_cb, lzx_write_cb, &st,
+		out_len, image_size, window_size);
+	if (res != MSPACK_ERR_OK || st.out_pos < out_len) {
+		// Error decompressing the data.
+		return -EIO;
+	}
+
+	// Verify the MZ header.
+	uint16_t mz;
+	memcpy(&mz, peHeader.data(), sizeof(mz));
+	if (mz != cpu_to_be16('MZ')) {
+		// MZ header is not valid.
+		// TODO: Other checks?
+		return -EIO;
+	}
+
+	lzx_peHeader.swap(peHeader);
+	lzx_xdbfSection.swap(xdbfSection);
+	return 0;
+}
+
+// Cache file header for extracted LZX data.
+// All fields are in little-endian, except for the magic number.
+#define XEX_LZX_CACHE_MAGIC 'XLZC'
+#define XEX_LZX_CACHE_VERSION 1
+struct XEX_LZX_Cache_Header {
+	uint32_t magic;			// 'XLZC'
+	uint32_t version;		// XEX_LZX_CACHE_VERSION
+	uint32_t image_size;		// Image size
+	uint32_t key_idx;		// Key index
+	uint32_t pe_header_size;	// PE header size
+	uint32_t xdbf_size;		// XDBF section size
+};
+ASSERT_STRUCT(XEX_LZX_Cache_Header, 6*sizeof(uint32_t));
+
+/**
+ * Get the cache filename for extracted LZX data.
+ * The cache key is based on a hash of the XEX headers.
+ * @param image_size Image size
+ * @return Cache filename, or empty string on error.
+ */
+string Xbox360_XEX_Private::getLzxCacheFilename(uint32_t image_size) const
+{
+	if (!lzxCacheEnabled || !Config::instance()->cacheDecompressedExeData()) {
+		// Cache is disabled.
+		return string();
+	}
+
+	// Hash all of the XEX headers using 64-bit FNV-1a.
+	// The header SHA-1 is also included in the key, but
+	// it might not be set correctly on homebrew.
+	// NOTE: The headers are usually only a few KB.
+	const uint32_t hdr_size = xex2Header.pe_offset;
+	if (hdr_size < sizeof(xex2Header) || hdr_size > 1024*1024) {
+		return string();
+	}
+	unique_ptr<uint8_t[]> hdr(new uint8_t[hdr_size]);
+	size_t size = file->seekAndRead(0, hdr.get(), hdr_size);
+	if (size != hdr_size) {
+		return string();
+	}
+	uint64_t hash = 14695981039346656037ULL;
+	for (uint32_t i = 0; i < hdr_size; i++) {
+		hash ^= hdr[i];
+		hash *= 1099511628211ULL;
+	}
+
+	const uint8_t *const pSha1 = (xexType != XexType::XEX1
+		? secInfo.xex2.header_sha1
+		: secInfo.xex1.image_sha1);
+	char cache_key[128];
+	int pos = snprintf(cache_key, sizeof(cache_key), "sys/xex/");
+	for (unsigned int i = 0; i < 20; i++) {
+		pos += snprintf(&cache_key[pos], sizeof(cache_key) - pos, "%02x", pSha1[i]);
+	}
+	snprintf(&cache_key[pos], sizeof(cache_key) - pos, "-%08x%08x-%08x.bin",
+		static_cast<uint32_t>(hash >> 32), static_cast<uint32_t>(hash), image_size);
+	return LibCacheCommon::getCacheFilename(cache_key);
+}
+
+/**
+ * Load extracted LZX data from the cache.
+ * @param image_size Image size
+ * @return Key index on success; negative POSIX error code on error.
+ */
+int Xbox360_XEX_Private::loadLzxCache(uint32_t image_size)
+{
+	const string cache_filename = getLzxCacheFilename(image_size);
+	if (cache_filename.empty()) {
+		return -ENOENT;
+	}
+
+	RpFile *const cacheFile = new RpFile(cache_filename, RpFile::FM_OPEN_READ);
+	if (!cacheFile->isOpen()) {
+		const int err = -cacheFile->lastError();
+		cacheFile->unref();
+		return (err != 0 ? err : -EIO);
+	}
+
+	int ret = -EIO;
+	XEX_LZX_Cache_Header hdr;
+	size_t size = cacheFile->read(&hdr, sizeof(hdr));
+	do {
+		if (size != sizeof(hdr) ||
+		    hdr.magic != cpu_to_be32(XEX_LZX_CACHE_MAGIC) ||
+		    hdr.version != cpu_to_le32(XEX_LZX_CACHE_VERSION) ||
+		    le32_to_cpu(hdr.image_size) != image_size ||
+		    le32_to_cpu(hdr.pe_header_size) != PE_HEADER_SIZE)
+		{
+			// Invalid cache file.
+			break;
+		}
+
+		const uint32_t key_idx = le32_to_cpu(hdr.key_idx);
+		const uint32_t xdbf_size = le32_to_cpu(hdr.xdbf_size);
+		if (key_idx > 1 || xdbf_size > LZX_XDBF_MAX_SIZE ||
+		    cacheFile->size() != static_cast<off64_t>(sizeof(hdr) + PE_HEADER_SIZE + xdbf_size))
+		{
+			// Invalid cache file.
+			break;
+		}
+
+		ao::uvector<uint8_t> peHeader(PE_HEADER_SIZE);
+		ao::uvector<uint8_t> xdbfSection(xdbf_size);
+		size = cacheFile->read(peHeader.data(), PE_HEADER_SIZE);
+		if (size != PE_HEADER_SIZE) {
+			break;
+		}
+		if (xdbf_size > 0) {
+			size = cacheFile->read(xdbfSection.data(), xdbf_size);
+			if (size != xdbf_size) {
+				break;
+			}
+		}
+
+		lzx_peHeader.swap(peHeader);
+		lzx_xdbfSection.swap(xdbfSection);
+		ret = static_cast<int>(key_idx);
+	} while (0);
+
+	const off64_t cache_size = cacheFile->size();
+	cacheFile->unref();
+	if (ret >= 0) {
+		CacheIndex::instance()->recordHit(cache_filename, cache_size);
+	}
+	return ret;
+}
+
+/**
+ * Save extracted LZX data to the cache.
+ * @param image_size Image size
+ * @param keyIdx Key index
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Xbox360_XEX_Private::saveLzxCache(uint32_t image_size, int keyIdx) const
+{
+	assert(lzx_peHeader.size() == PE_HEADER_SIZE);
+	if (lzx_peHeader.size() != PE_HEADER_SIZE) {
+		return -EINVAL;
+	}
+
+	const string cache_filename = getLzxCacheFilename(image_size);
+	if (cache_filename.empty()) {
+		return -ENOENT;
+	}
+	int ret = LibRpFile::FileSystem::rmkdir(cache_filename);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Write to a temporary file first so other processes
+	// never see a partially-written cache file.
+	const string tmp_filename = cache_filename + ".tmp";
+	RpFile *const cacheFile = new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE);
+	if (!cacheFile->isOpen()) {
+		ret = -cacheFile->lastError();
+		cacheFile->unref();
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	XEX_LZX_Cache_Header hdr;
+	hdr.magic = cpu_to_be32(XEX_LZX_CACHE_MAGIC);
+	hdr.version = cpu_to_le32(XEX_LZX_CACHE_VERSION);
+	hdr.image_size = cpu_to_le32(image_size);
+	hdr.key_idx = cpu_to_le32(static_cast<uint32_t>(keyIdx));
+	hdr.pe_header_size = cpu_to_le32(static_cast<uint32_t>(lzx_peHeader.size()));
+	hdr.xdbf_size = cpu_to_le32(static_cast<uint32_t>(lzx_xdbfSection.size()));
+
+	bool ok = (cacheFile->write(&hdr, sizeof(hdr)) == sizeof(hdr));
+	ok = ok && (cacheFile->write(lzx_peHeader.data(), lzx_peHeader.size()) == lzx_peHeader.size());
+	if (!lzx_xdbfSection.empty()) {
+		ok = ok && (cacheFile->write(lzx_xdbfSection.data(), lzx_xdbfSection.size()) == lzx_xdbfSection.size());
+	}
+	const off64_t cache_size = cacheFile->size();
+	cacheFile->unref();
+
+	if (!ok) {
+		LibRpFile::FileSystem::delete_file(tmp_filename);
+		return -EIO;
+	}
+	ret = LibRpFile::FileSystem::rename(tmp_filename, cache_filename);
+	if (ret != 0) {
+		LibRpFile::FileSystem::delete_file(tmp_filename);
+		return ret;
+	}
+
+	CacheIndex::instance()->recordMiss(cache_filename, cache_size);
+	return 0;
+}
+#endif /* ENABLE_LIBMSPACK */
+
 /**
  * Initialize the PE executable reader.
  * @return peReader on success; nullptr on error.
@@ -753,205 +1230,51 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 			const uint32_t window_size = be32_to_cpu(*pWindowSize);
 
 			// First block.
-			XEX2_Compression_Normal_Info first_block, lzx_blocks[2];
-			unsigned int lzx_idx = 0;
+			// First block header is stored in the XEX header.
+			// Second block header is stored at the beginning of the compressed data.
+			XEX2_Compression_Normal_Info first_block;
 			memcpy(&first_block, p+sizeof(window_size), sizeof(first_block));
 #if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			first_block.block_size = be32_to_cpu(first_block.block_size);
 #endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
-			memcpy(&lzx_blocks[0], &first_block, sizeof(first_block));
-			// First block header is stored in the XEX header.
-			// Second block header is stored at the beginning of the compressed data.
 
 			// NOTE: We can't easily randomly seek within the compressed data,
 			// since the uncompressed block size isn't stored anywhere.
-			// We'll have to load the entire executable into memory,
-			// save the relevant portions, then free it.
-			// FIXME: It *might* be possible to randomly seek...
-			// Need to analyze the format more.
-			const off64_t fileSize = file->size();
-			if (fileSize > 64*1024*1024 || image_size > 64*1024*1024) {
-				// 64 MB is our compressed and uncompressed limit.
-				UNREF(reader[0]);
-				UNREF(reader[1]);
-				return nullptr;
-			}
-
-			// Compressed EXE buffer.
-			// We have to de-block the compressed data first.
-			const size_t compressed_size = static_cast<size_t>(fileSize) - xex2Header.pe_offset;
-			unique_ptr<uint8_t[]> compressed_deblock(new uint8_t[compressed_size]);
-
-			// Pointer within the deblocked compressed data.
-			uint8_t *p_dblk = compressed_deblock.get();
-			uint8_t *const p_dblk_end = p_dblk + compressed_size;
-
-			// CBCReader index.
-			// If a block size is invalid, we'll switch to the other one.
-			// If both are invalid, we have a problem.
-			unsigned int rd_idx = (reader[0] ? 0 : 1);
-			if (!reader[rd_idx]) {
-				// No readers available...
-				// FIXME: Not sure if this is needed...
-				UNREF(reader[!rd_idx]);
-				return nullptr;
+			// decompressLzx() decompresses the executable up to the end of
+			// the XDBF section, keeping only the PE header and XDBF section.
+			// The extracted data is cached, since this is slow for large files.
+			int keyIdx = loadLzxCache(image_size);
+			if (keyIdx >= 0 && !reader[keyIdx]) {
+				// Cached data used a key that is no longer available.
+				lzx_peHeader.clear();
+				lzx_xdbfSection.clear();
+				keyIdx = -1;
 			}
 
-			// Start at the beginning.
-			reader[rd_idx]->rewind();
-
-			// Based on: https://github.com/xenia-project/xenia/blob/5f764fc752c82674981a9f402f1bbd96b399112a/src/xenia/cpu/xex_module.cc
-			while (lzx_blocks[lzx_idx].block_size != 0) {
-				// Read the next block header.
-				size = reader[rd_idx]->read(&lzx_blocks[!lzx_idx], sizeof(lzx_blocks[!lzx_idx]));
-				if (size != sizeof(lzx_blocks[!lzx_idx])) {
-					// Seek and/or read error.
-					UNREF(reader[0]);
-					UNREF(reader[1]);
-					return nullptr;
-				}
-
-				// Does the block size make sense?
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-				lzx_blocks[!lzx_idx].block_size = be32_to_cpu(lzx_blocks[!lzx_idx].block_size);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
-				if (lzx_blocks[!lzx_idx].block_size > 65536) {
-					// Block size is invalid.
-					// Switch to the other reader.
-					if (rd_idx == 1) {
-						// No more readers...
-						UNREF(reader[1]);
-						return nullptr;
-					}
-					UNREF_AND_NULL(reader[0]);
-
-					// reader[1] might be nullptr here...
-					if (!reader[1]) {
-						// Cannot continue.
-						return nullptr;
+			if (keyIdx < 0) {
+				// Try each CBCReader until one works.
+				// If a block size is invalid, the key is probably wrong.
+				for (unsigned int i = 0; i < static_cast<unsigned int>(reader.size()); i++) {
+					if (!reader[i])
+						continue;
+					if (decompressLzx(reader[i], first_block, window_size, image_size) == 0) {
+						keyIdx = static_cast<int>(i);
+						break;
 					}
-					rd_idx = 1;
-
-					// Restart decompression in case the first few blocks
-					// were decompressed without any "errors".
-					// TODO: Also do this for errors after reading the block size?
-					reader[1]->rewind();
-					lzx_idx = 0;
-					memcpy(&lzx_blocks[0], &first_block, sizeof(first_block));
-					p_dblk = compressed_deblock.get();
-					continue;
 				}
-
-				// Read the current block.
-				uint32_t block_size = lzx_blocks[lzx_idx].block_size;
-				assert(block_size > sizeof(lzx_blocks[!lzx_idx]));
-				if (block_size <= sizeof(lzx_blocks[!lzx_idx])) {
-					// Block is missing the "next block" header...
+				if (keyIdx < 0) {
+					// Unable to decompress the executable.
 					UNREF(reader[0]);
 					UNREF(reader[1]);
 					return nullptr;
 				}
-				block_size -= sizeof(lzx_blocks[!lzx_idx]);
-
-				while (block_size > 2) {
-					// Get the chunk size.
-					uint16_t chunk_size;
-					size = reader[rd_idx]->read(&chunk_size, sizeof(chunk_size));
-					if (size != sizeof(chunk_size)) {
-						// Seek and/or read error.
-						UNREF(reader[0]);
-						UNREF(reader[1]);
-						return nullptr;
-					}
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-					chunk_size = be16_to_cpu(chunk_size);
-#endif /* SYS_BYTEORDER = SYS_LIL_ENDIAN */
-					block_size -= 2;
-					if (chunk_size == 0 || chunk_size > block_size) {
-						// End of block, or not enough data is available.
-						break;
-					}
-
-					// Do we have enough space?
-					if (p_dblk + chunk_size >= p_dblk_end) {
-						// Out of memory.
-						// TODO: Error reporting.
-						UNREF(reader[0]);
-						UNREF(reader[1]);
-						return nullptr;
-					}
-
-					size = reader[rd_idx]->read(p_dblk, chunk_size);
-					if (size != chunk_size) {
-						// Seek and/or read error.
-						UNREF(reader[0]);
-						UNREF(reader[1]);
-						return nullptr;
-					}
-
-					p_dblk += chunk_size;
-					block_size -= chunk_size;
-				}
-				if (block_size > 0) {
-					// Empty data at the end of the block.
-					// TODO: Error handling.
-					// TODO: SEEK_CUR?
-					reader[rd_idx]->seek(reader[rd_idx]->tell() + block_size);
-				}
-
-				// Next block.
-				lzx_idx = !lzx_idx;
-			}
-
-			// Decompress the data.
-			unique_ptr<uint8_t[]> decompressed_exe(new uint8_t[image_size]);
-			int res = lzx_decompress(compressed_deblock.get(),
-				static_cast<size_t>(p_dblk - compressed_deblock.get()),
-				decompressed_exe.get(), image_size,
-				window_size, nullptr, 0);
-			if (res != MSPACK_ERR_OK) {
-				// Error decompressing the data.
-				UNREF(reader[0]);
-				UNREF(reader[1]);
-				return nullptr;
-			}
-
-			// Verify the MZ header.
-			uint16_t mz;
-			memcpy(&mz, decompressed_exe.get(), sizeof(mz));
-			if (mz != cpu_to_be16('MZ')) {
-				// MZ header is not valid.
-				// TODO: Other checks?
-				UNREF(reader[0]);
-				UNREF(reader[1]);
-				return nullptr;
-			}
-
-			// Copy the PE header.
-			lzx_peHeader.resize(PE_HEADER_SIZE);
-			memcpy(lzx_peHeader.data(), decompressed_exe.get(), PE_HEADER_SIZE);
-
-			// Copy the XDBF section.
-			const XEX2_Resource_Info *const pResInfo = getXdbfResInfo();
-			if (pResInfo) {
-				const uint32_t load_address = be32_to_cpu(
-					(xexType != XexType::XEX1
-						? secInfo.xex2.load_address
-						: secInfo.xex1.load_address));
-
-				const uint32_t xdbf_physaddr = pResInfo->vaddr - load_address;
-				if (xdbf_physaddr + pResInfo->size <= image_size) {
-					lzx_xdbfSection.resize(pResInfo->size);
-					memcpy(lzx_xdbfSection.data(),
-						decompressed_exe.get() + xdbf_physaddr,
-						pResInfo->size);
-				}
+				saveLzxCache(image_size, keyIdx);
 			}
 
 			// Save the correct reader.
-			this->peReader = reader[rd_idx];
-			reader[rd_idx] = nullptr;
-			keyInUse = rd_idx;
+			this->peReader = reader[keyIdx];
+			reader[keyIdx] = nullptr;
+			keyInUse = keyIdx;
 			break;
 		}
 #endif /* ENABLE_LIBMSPACK */
@@ -1338,6 +1661,19 @@ string Xbox360_XEX_Private::getPublisher(void) const
  * @param file Open XEX file.
  */
 Xbox360_XEX::Xbox360_XEX(IRpFile *file)
+	: Xbox360_XEX(file, nullptr)
+{ }
+
+/**
+ * Read an Xbox 360 XEX file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Xbox360_XEX::Xbox360_XEX(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new Xbox360_XEX_Private(this, file))
 {
 	// This class handles executables.
@@ -1355,8 +1691,7 @@ Xbox360_XEX::Xbox360_XEX(IRpFile *file)
 	// NOTE: Reading all at once to reduce seeking.
 	// NOTE: Limiting to one DVD sector.
 	uint8_t header[2048];
-	d->file->rewind();
-	size_t size = d->file->read(header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header, sizeof(header));
 	if (size != sizeof(header)) {
 		d->xex2Header.magic = 0;
 		UNREF_AND_NULL_NOCHK(d->file);
@@ -2119,6 +2454,24 @@ int Xbox360_XEX::checkViewedAchievements(void) const
 	return ret;
 }
 
+/**
+ * Enable or disable the decompressed executable cache.
+ *
+ * The PE header and XDBF section extracted from LZX-compressed
+ * executables can be cached in the user's cache directory.
+ * This is disabled by default, since RomData parsers shouldn't
+ * write to the cache directory on their own. It's enabled by
+ * TCreateThumbnail, which already manages the cache directory.
+ *
+ * NOTE: [Options] CacheDecompressedExeData=false overrides this.
+ *
+ * @param enable True to enable; false to disable.
+ */
+void Xbox360_XEX::setLzxCacheEnabled(bool enable)
+{
+	Xbox360_XEX_Private::lzxCacheEnabled = enable;
+}
+
 #ifdef ENABLE_DECRYPTION
 /** Encryption keys. **/
 
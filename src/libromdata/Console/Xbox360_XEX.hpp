@@ -16,6 +16,7 @@ namespace LibRomData {
 
 class Xbox360_XEX_Private;
 ROMDATA_DECL_BEGIN(Xbox360_XEX)
+ROMDATA_DECL_CTOR_DETECTINFO(Xbox360_XEX)
 ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
@@ -57,6 +58,22 @@ ROMDATA_DECL_VIEWED_ACHIEVEMENTS()
 		static const uint8_t *encryptionVerifyData_static(int keyIdx);
 #endif /* ENABLE_DECRYPTION */
 
+	public:
+		/**
+		 * Enable or disable the decompressed executable cache.
+		 *
+		 * The PE header and XDBF section extracted from LZX-compressed
+		 * executables can be cached in the user's cache directory.
+		 * This is disabled by default, since RomData parsers shouldn't
+		 * write to the cache directory on their own. It's enabled by
+		 * TCreateThumbnail, which already manages the cache directory.
+		 *
+		 * NOTE: [Options] CacheDecompressedExeData=false overrides this.
+		 *
+		 * @param enable True to enable; false to disable.
+		 */
+		static void setLzxCacheEnabled(bool enable);
+
 ROMDATA_DECL_END()
 
 }
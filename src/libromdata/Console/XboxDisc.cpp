@@ -284,6 +284,19 @@ inline void XboxDiscPrivate::lockKreonDrive(void)
  * @param file Open ROM image.
  */
 XboxDisc::XboxDisc(IRpFile *file)
+	: XboxDisc(file, nullptr)
+{ }
+
+/**
+ * Read a Microsoft Xbox disc image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+XboxDisc::XboxDisc(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new XboxDiscPrivate(this, file))
 {
 	// This class handles disc images.
@@ -302,7 +315,7 @@ XboxDisc::XboxDisc(IRpFile *file)
 	// Read the ISO-9660 PVD.
 	// NOTE: Only 2048-byte sectors, since this is DVD.
 	ISO_Primary_Volume_Descriptor pvd;
-	size_t size = d->file->seekAndRead(ISO_PVD_ADDRESS_2048, &pvd, sizeof(pvd));
+	size_t size = d->seekAndReadHeader(detectInfo, ISO_PVD_ADDRESS_2048, &pvd, sizeof(pvd));
 	if (size != sizeof(pvd)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(XboxDisc)
+ROMDATA_DECL_CTOR_DETECTINFO(XboxDisc)
 ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
@@ -393,6 +393,19 @@ string Xbox_XBE_Private::getPublisher(void) const
  * @param file Open XBE file.
  */
 Xbox_XBE::Xbox_XBE(IRpFile *file)
+	: Xbox_XBE(file, nullptr)
+{ }
+
+/**
+ * Read an Xbox XBE file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Xbox_XBE::Xbox_XBE(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new Xbox_XBE_Private(this, file))
 {
 	// This class handles executables.
@@ -407,8 +420,7 @@ Xbox_XBE::Xbox_XBE(IRpFile *file)
 	}
 
 	// Read the XBE header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->xbeHeader, sizeof(d->xbeHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->xbeHeader, sizeof(d->xbeHeader));
 	if (size != sizeof(d->xbeHeader)) {
 		d->xbeHeader.magic = 0;
 		UNREF_AND_NULL_NOCHK(d->file);
@@ -15,6 +15,7 @@ namespace LibRomData {
 
 class Xbox_XBE_Private;
 ROMDATA_DECL_BEGIN(Xbox_XBE)
+ROMDATA_DECL_CTOR_DETECTINFO(Xbox_XBE)
 ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
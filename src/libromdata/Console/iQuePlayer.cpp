@@ -379,6 +379,19 @@ const rp_image *iQuePlayerPrivate::loadTitleImage(void)
  * @param file Open ROM image.
  */
 iQuePlayer::iQuePlayer(IRpFile *file)
+	: iQuePlayer(file, nullptr)
+{ }
+
+/**
+ * Read an iQue Player .cmd file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+iQuePlayer::iQuePlayer(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new iQuePlayerPrivate(this, file))
 {
 	RP_D(iQuePlayer);
@@ -402,8 +415,7 @@ iQuePlayer::iQuePlayer(IRpFile *file)
 	}
 
 	// Read the content description.
-	d->file->rewind();
-	size_t size = d->file->read(&d->contentDesc, sizeof(d->contentDesc));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->contentDesc, sizeof(d->contentDesc));
 	if (size != sizeof(d->contentDesc)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
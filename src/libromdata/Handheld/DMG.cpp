@@ -540,6 +540,19 @@ string DMGPrivate::getPublisher(void) const
  * @param file Open ROM file.
  */
 DMG::DMG(IRpFile *file)
+	: DMG(file, nullptr)
+{ }
+
+/**
+ * Read a Game Boy ROM.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+DMG::DMG(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new DMGPrivate(this, file))
 {
 	RP_D(DMG);
@@ -550,9 +563,6 @@ DMG::DMG(IRpFile *file)
 		return;
 	}
 
-	// Seek to the beginning of the header.
-	d->file->rewind();
-
 	// Read the ROM header.
 	// We're reading extra data in case the ROM has an extra
 	// 512-byte copier header present.
@@ -560,7 +570,7 @@ DMG::DMG(IRpFile *file)
 		uint8_t   u8[ 0x300 + sizeof(d->romHeader)];
 		uint32_t u32[(0x300 + sizeof(d->romHeader))/4];
 	} header;
-	size_t size = d->file->read(header.u8, sizeof(header.u8));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header.u8, sizeof(header.u8));
 	if (size < (0x100 + sizeof(d->romHeader))) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(DMG)
+ROMDATA_DECL_CTOR_DETECTINFO(DMG)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
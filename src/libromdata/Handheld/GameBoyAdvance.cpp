@@ -108,6 +108,19 @@ string GameBoyAdvancePrivate::getPublisher(void) const
  * @param file Open ROM image.
  */
 GameBoyAdvance::GameBoyAdvance(IRpFile *file)
+	: GameBoyAdvance(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo Game Boy Advance ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+GameBoyAdvance::GameBoyAdvance(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new GameBoyAdvancePrivate(this, file))
 {
 	RP_D(GameBoyAdvance);
@@ -120,8 +133,7 @@ GameBoyAdvance::GameBoyAdvance(IRpFile *file)
 	}
 
 	// Read the ROM header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->romHeader, sizeof(d->romHeader));
 	if (size != sizeof(d->romHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
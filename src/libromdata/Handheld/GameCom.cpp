@@ -479,6 +479,19 @@ const rp_image *GameComPrivate::loadIconRLE(void)
  * @param file Open ROM image.
  */
 GameCom::GameCom(IRpFile *file)
+	: GameCom(file, nullptr)
+{ }
+
+/**
+ * Read a Tiger game.com ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+GameCom::GameCom(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new GameComPrivate(this, file))
 {
 	RP_D(GameCom);
@@ -491,7 +504,7 @@ GameCom::GameCom(IRpFile *file)
 	}
 
 	// Read the ROM header at the standard address.
-	size_t size = d->file->seekAndRead(GCOM_HEADER_ADDRESS, &d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, GCOM_HEADER_ADDRESS, &d->romHeader, sizeof(d->romHeader));
 	if (size == sizeof(d->romHeader)) {
 		// Check if this ROM image is supported.
 		DetectInfo info;
@@ -505,7 +518,7 @@ GameCom::GameCom(IRpFile *file)
 
 	if (!d->isValid) {
 		// Try again at the alternate address.
-		size = d->file->seekAndRead(GCOM_HEADER_ADDRESS_ALT, &d->romHeader, sizeof(d->romHeader));
+		size = d->seekAndReadHeader(detectInfo, GCOM_HEADER_ADDRESS_ALT, &d->romHeader, sizeof(d->romHeader));
 		if (size == sizeof(d->romHeader)) {
 			// Check if this ROM image is supported.
 			DetectInfo info;
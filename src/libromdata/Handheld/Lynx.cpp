@@ -58,6 +58,19 @@ LynxPrivate::LynxPrivate(Lynx *q, IRpFile *file)
  * @param file Open ROM file.
  */
 Lynx::Lynx(IRpFile *file)
+	: Lynx(file, nullptr)
+{ }
+
+/**
+ * Read an Atari Lynx ROM.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Lynx::Lynx(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new LynxPrivate(this, file))
 {
 	RP_D(Lynx);
@@ -69,12 +82,9 @@ Lynx::Lynx(IRpFile *file)
 		return;
 	}
 
-	// Seek to the beginning of the header.
-	d->file->rewind();
-
 	// Read the ROM header. [0x40 bytes]
 	uint8_t header[0x40];
-	size_t size = d->file->read(header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header, sizeof(header));
 	if (size != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
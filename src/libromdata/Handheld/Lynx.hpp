@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(Lynx)
+ROMDATA_DECL_CTOR_DETECTINFO(Lynx)
 ROMDATA_DECL_END()
 
 }
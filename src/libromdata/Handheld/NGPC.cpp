@@ -91,6 +91,19 @@ NGPCPrivate::NGPCPrivate(NGPC *q, IRpFile *file)
  * @param file Open ROM file.
  */
 NGPC::NGPC(IRpFile *file)
+	: NGPC(file, nullptr)
+{ }
+
+/**
+ * Read a Neo Geo Pocket (Color) ROM.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+NGPC::NGPC(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new NGPCPrivate(this, file))
 {
 	RP_D(NGPC);
@@ -101,12 +114,8 @@ NGPC::NGPC(IRpFile *file)
 		return;
 	}
 
-	// Seek to the beginning of the header.
-	d->file->rewind();
-
 	// Read the ROM header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->romHeader, sizeof(d->romHeader));
 	if (size != sizeof(d->romHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -30,6 +30,13 @@ using namespace LibRpTexture;
 #include "disc/NCCHReader.hpp"
 #include "disc/CIAReader.hpp"
 
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::Thread;
+
 // C++ STL classes.
 using std::string;
 using std::unique_ptr;
@@ -73,12 +80,14 @@ Nintendo3DSPrivate::Nintendo3DSPrivate(Nintendo3DS *q, IRpFile *file)
 	, romType(RomType::Unknown)
 	, headers_loaded(0)
 	, media_unit_shift(9)	// default is 9 (512 bytes)
+	, title_key_status(0)
 	, ncch_reader(nullptr)
 	, mainContent(nullptr)
 {
 	// Clear the various structs.
 	memset(&mxh, 0, sizeof(mxh));
 	memset(&perm, 0, sizeof(perm));
+	memset(title_key, 0, sizeof(title_key));
 }
 
 Nintendo3DSPrivate::~Nintendo3DSPrivate()
@@ -212,11 +221,18 @@ int Nintendo3DSPrivate::loadSMDH(void)
 
 /**
  * Load the specified NCCH header.
+ *
+ * If a mutex is specified, loadNCCH() can be called by
+ * multiple threads at once, as long as the ticket, TMD,
+ * and title key were already loaded.
+ *
+ * @param idx			[in] Content/partition index.
  * @param pOutNcchReader	[out] Output variable for the NCCHReader.
+ * @param mutex			[in,opt] Mutex for file and KeyManager access.
  * @return 0 on success; negative POSIX error code on error.
  * NOTE: Caller must check NCCHReader::isOpen().
  */
-int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
+int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader, Mutex *mutex)
 {
 	assert(pOutNcchReader != nullptr);
 	if (!pOutNcchReader)
@@ -224,6 +240,7 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 
 	off64_t offset = 0;
 	uint32_t length = 0;
+	bool isCIAcrypto = false;
 	switch (romType) {
 		case RomType::CIA: {
 			if (!(headers_loaded & HEADER_CIA)) {
@@ -243,28 +260,25 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 				return -ENOENT;
 			}
 
-			// Determine the content start position.
-			// Need to add all content chunk sizes, algined to 64 bytes.
-			const auto content_chunks_cend = content_chunks.cend();
-			for (auto iter = content_chunks.cbegin();
-			     iter != content_chunks_cend; ++iter)
-			{
-				const uint32_t cur_size = static_cast<uint32_t>(be64_to_cpu(iter->size));
-				if (be16_to_cpu(iter->index) == idx) {
-					// Found the content chunk.
-					length = cur_size;
-					break;
-				}
-				// Next chunk.
-				offset += toNext64(cur_size);
+			// Find the content chunk.
+			const int chunk_idx = findContentChunk(idx);
+			if (chunk_idx < 0) {
+				// Content chunk not found.
+				return -ENOENT;
 			}
+			const N3DS_Content_Chunk_Record_t *const chunk = &content_chunks[chunk_idx];
+			length = static_cast<uint32_t>(be64_to_cpu(chunk->size));
 			if (length == 0) {
-				// Content chunk not found.
+				// Content chunk is empty.
 				return -ENOENT;
 			}
 
-			// Add the content start address.
-			offset += mxh.content_start_addr;
+			// Content start position was calculated by loadTicketAndTMD().
+			offset = content_offsets[chunk_idx];
+
+			// Check if this content is encrypted.
+			// If it is, we'll need to create a CIAReader.
+			isCIAcrypto = !!(chunk->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED));
 			break;
 		}
 
@@ -312,28 +326,15 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 
 	// Is this encrypted using CIA title key encryption?
 	CIAReader *ciaReader = nullptr;
-	if (romType == RomType::CIA && idx < (int)content_chunks.size()) {
-		// Check if this content is encrypted.
-		// If it is, we'll need to create a CIAReader.
-		N3DS_Ticket_t *ticket = nullptr;
-		const auto content_chunks_cend = content_chunks.cend();
-		for (auto iter = content_chunks.cbegin();
-		     iter != content_chunks_cend; ++iter)
-		{
-			const uint16_t content_index = be16_to_cpu(iter->index);
-			if (content_index == idx) {
-				// Found the content index.
-				if (iter->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
-					// Content is encrypted.
-					ticket = &mxh.ticket;
-				}
-				break;
-			}
-		}
-
-		if (ticket) {
+	if (isCIAcrypto) {
+		// NOTE: If a mutex is specified, the title key must
+		// have been loaded already, so this doesn't modify
+		// anything in Nintendo3DSPrivate.
+		assert(!mutex || title_key_status != 0);
+		const uint8_t *const pTitleKey = loadTitleKey();
+		if (pTitleKey) {
 			// Create a CIAReader.
-			ciaReader = new CIAReader(file, offset, length, ticket, idx);
+			ciaReader = new CIAReader(file, offset, length, pTitleKey, idx);
 			if (!ciaReader->isOpen()) {
 				// Unable to open the CIAReader.
 				UNREF_AND_NULL_NOCHK(ciaReader);
@@ -348,10 +349,10 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 		// This is an encrypted CIA.
 		// NOTE 2: CIAReader handles the offset, so we need to
 		// tell NCCHReader that the offset is 0.
-		*pOutNcchReader = new NCCHReader(ciaReader, media_unit_shift, 0, length);
+		*pOutNcchReader = new NCCHReader(ciaReader, media_unit_shift, 0, length, mutex);
 	} else {
 		// Anything else is read directly.
-		*pOutNcchReader = new NCCHReader(file, media_unit_shift, offset, length);
+		*pOutNcchReader = new NCCHReader(file, media_unit_shift, offset, length, mutex);
 	}
 
 	// We don't need to keep a reference to the CIAReader.
@@ -388,6 +389,105 @@ NCCHReader *Nintendo3DSPrivate::loadNCCH(void)
 	return this->ncch_reader;
 }
 
+/**
+ * Load the NCCH headers for contents [0, count). (CIA only)
+ *
+ * This is equivalent to calling loadNCCH() for each content,
+ * but encrypted contents are loaded by multiple threads.
+ * File reads and key loading are serialized, since all
+ * contents share the same IRpFile.
+ *
+ * The first content is loaded on the current thread.
+ * If it isn't encrypted, or if it can't be decrypted,
+ * the rest are loaded serially.
+ *
+ * @param count		[in] Number of contents.
+ * @param pRet		[out] loadNCCH() return values. (must have count elements)
+ * @param pNcchReaders	[out] NCCHReaders. (must have count elements)
+ */
+void Nintendo3DSPrivate::loadNCCHs(unsigned int count, int *pRet, NCCHReader **pNcchReaders)
+{
+	// Maximum number of threads.
+	static const unsigned int MT_THREADS_MAX = 8;
+
+	assert(pRet != nullptr);
+	assert(pNcchReaders != nullptr);
+	if (count == 0 || !pRet || !pNcchReaders) {
+		// Nothing to do.
+		return;
+	}
+
+	// Load the first content on the current thread.
+	// This also loads the ticket and TMD header.
+	pNcchReaders[0] = nullptr;
+	pRet[0] = loadNCCH(0, &pNcchReaders[0]);
+
+	unsigned int threadCount = 1;
+	const NCCHReader *const first = pNcchReaders[0];
+	if (count > 2 && first && first->isOpen() && (headers_loaded & HEADER_TMD)) {
+		const N3DS_NCCH_Header_NoSig_t *const first_ncch_header = first->ncchHeader();
+		bool isEncrypted = (first_ncch_header &&
+			!(first_ncch_header->flags[N3DS_NCCH_FLAG_BIT_MASKS] & N3DS_NCCH_BIT_MASK_NoCrypto));
+
+		// If any content uses CIA encryption, the title key
+		// must be loaded before starting the threads.
+		for (const auto &chunk : content_chunks) {
+			if (chunk.type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
+				isEncrypted = (loadTitleKey() != nullptr);
+				break;
+			}
+		}
+
+		if (isEncrypted) {
+			threadCount = Thread::hardwareConcurrency();
+			if (threadCount > MT_THREADS_MAX) {
+				threadCount = MT_THREADS_MAX;
+			}
+			if (threadCount > count - 1) {
+				threadCount = count - 1;
+			}
+		}
+	}
+
+	if (threadCount <= 1) {
+		// Load the contents on the current thread.
+		for (unsigned int i = 1; i < count; i++) {
+			pNcchReaders[i] = nullptr;
+			pRet[i] = loadNCCH(static_cast<int>(i), &pNcchReaders[i]);
+		}
+		return;
+	}
+
+	// Each thread loads the next content that hasn't been started yet.
+	Mutex mutex;
+	volatile int next_idx = 0;
+	auto loadThread = [this, count, pRet, pNcchReaders, &mutex, &next_idx]() {
+		unsigned int idx;
+		while ((idx = static_cast<unsigned int>(ATOMIC_INC_FETCH(&next_idx))) < count) {
+			pNcchReaders[idx] = nullptr;
+			pRet[idx] = loadNCCH(static_cast<int>(idx), &pNcchReaders[idx], &mutex);
+		}
+	};
+
+	Thread threads[MT_THREADS_MAX];
+	unsigned int workerCount = 0;
+	for (; workerCount < threadCount - 1; workerCount++) {
+		if (threads[workerCount].create(loadThread) != 0) {
+			// Unable to create a thread.
+			// The remaining contents will be loaded
+			// by the threads that were created.
+			break;
+		}
+	}
+
+	// Load contents on the current thread, too.
+	loadThread();
+
+	for (unsigned int i = 0; i < workerCount; i++) {
+		threads[i].join();
+	}
+}
+
 /**
  * Get the NCCH header from the primary content.
  * This uses loadNCCH() to get the NCCH reader.
@@ -534,6 +634,15 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 	// Store the content start address.
 	mxh.content_start_addr = tmd_start + toNext64(tmd_size);
 
+	// Determine the start address of each content.
+	// Content chunk sizes are aligned to 64 bytes.
+	content_offsets.resize(content_count);
+	off64_t content_offset = mxh.content_start_addr;
+	for (unsigned int i = 0; i < content_count; i++) {
+		content_offsets[i] = content_offset;
+		content_offset += toNext64(static_cast<uint32_t>(be64_to_cpu(content_chunks[i].size)));
+	}
+
 	// Loaded the TMD header.
 	headers_loaded |= HEADER_TMD;
 
@@ -547,6 +656,59 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 	return 0;
 }
 
+/**
+ * Find a content chunk by TMD content index. (CIA only)
+ * @param idx TMD content index.
+ * @return Index in content_chunks, or -1 if not found.
+ */
+int Nintendo3DSPrivate::findContentChunk(int idx) const
+{
+	if (idx < 0 || idx > 0xFFFF) {
+		// Invalid content index.
+		return -1;
+	}
+
+	// Content indexes are usually sequential.
+	const size_t count = content_chunks.size();
+	if (static_cast<size_t>(idx) < count &&
+	    be16_to_cpu(content_chunks[idx].index) == idx)
+	{
+		return idx;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (be16_to_cpu(content_chunks[i].index) == idx) {
+			// Found the content chunk.
+			return static_cast<int>(i);
+		}
+	}
+
+	// Content chunk not found.
+	return -1;
+}
+
+/**
+ * Get the decrypted title key. (CIA only)
+ * The title key is decrypted once and cached.
+ * loadTicketAndTMD() must be called first.
+ * @return Decrypted title key, or nullptr if it could not be decrypted.
+ */
+const uint8_t *Nintendo3DSPrivate::loadTitleKey(void)
+{
+	if (title_key_status == 0) {
+		assert(headers_loaded & HEADER_TMD);
+		if (!(headers_loaded & HEADER_TMD)) {
+			// Ticket isn't loaded.
+			return nullptr;
+		}
+
+		title_key_status = (CIAReader::decryptTitleKey(title_key, &mxh.ticket) == KeyManager::VerifyResult::OK)
+			? 1 : -1;
+	}
+
+	return (title_key_status > 0 ? title_key : nullptr);
+}
+
 /**
  * Open the SRL if it isn't already opened.
  * This operation only works for CIAs that contain an SRL.
@@ -589,8 +751,13 @@ int Nintendo3DSPrivate::openSRL(void)
 	IDiscReader *srlReader = nullptr;
 	if (chunk0->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
 		// Content is encrypted.
+		const uint8_t *const pTitleKey = loadTitleKey();
+		if (!pTitleKey) {
+			// Unable to decrypt the title key.
+			return -EIO;
+		}
 		srlReader = new CIAReader(this->file, offset, length,
-			&mxh.ticket, be16_to_cpu(chunk0->index));
+			pTitleKey, be16_to_cpu(chunk0->index));
 	} else {
 		// Content is NOT encrypted.
 		// Use a plain old DiscReader.
@@ -610,6 +777,9 @@ int Nintendo3DSPrivate::openSRL(void)
 	if (srlFile->isOpen()) {
 		// Create the NintendoDS object.
 		srlData = new NintendoDS(srlFile, true);
+		if (this->metaDataOnly) {
+			srlData->setMetaDataOnly();
+		}
 	}
 	srlFile->unref();
 
@@ -2155,6 +2325,12 @@ int Nintendo3DS::loadFieldData(void)
 		auto vv_contents = new RomFields::ListData_t();
 		vv_contents->reserve(d->content_chunks.size());
 
+		// Load the content NCCH headers.
+		const unsigned int content_count = static_cast<unsigned int>(d->content_chunks.size());
+		vector<int> content_ret(content_count);
+		vector<NCCHReader*> content_ncch(content_count);
+		d->loadNCCHs(content_count, content_ret.data(), content_ncch.data());
+
 		// Process the contents.
 		// TODO: Content types?
 		int i = 0;
@@ -2163,10 +2339,12 @@ int Nintendo3DS::loadFieldData(void)
 		     iter != content_chunks_cend; ++iter, ++i)
 		{
 			// Make sure the content exists first.
-			NCCHReader *pNcch = nullptr;
-			int ret = d->loadNCCH(i, &pNcch);
-			if (ret == -ENOENT)
+			NCCHReader *pNcch = content_ncch[i];
+			int ret = content_ret[i];
+			if (ret == -ENOENT) {
+				UNREF(pNcch);
 				continue;
+			}
 
 			const size_t vidx = vv_contents->size();
 			vv_contents->resize(vidx+1);
@@ -2788,6 +2966,47 @@ bool Nintendo3DS::hasDangerousPermissions(void) const
 	return d->perm.isDangerous;
 }
 
+/**
+ * Does a ROM image have "dangerous" permissions?
+ * This only reads the data needed to make the decision.
+ *
+ * @param file Open ROM image.
+ * @param info DetectInfo that was accepted by isRomSupported_static().
+ * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+ */
+int Nintendo3DS::hasDangerousPermissions_static(IRpFile *file, const DetectInfo *info)
+{
+	assert(file != nullptr);
+	assert(info != nullptr);
+	if (!file || !info) {
+		return -EINVAL;
+	}
+
+	// 3DSX homebrew doesn't have an NCCH extended header,
+	// so it can't have any permissions.
+	const Nintendo3DSPrivate::RomType romType =
+		static_cast<Nintendo3DSPrivate::RomType>(isRomSupported_static(info));
+	switch (romType) {
+		case Nintendo3DSPrivate::RomType::Unknown:
+		case Nintendo3DSPrivate::RomType::_3DSX:
+			return 0;
+		default:
+			break;
+	}
+
+	// CCI, eMMC, CIA, and NCCH need the ticket, TMD, and
+	// NCCH extended header, which may be encrypted.
+	Nintendo3DS *const n3ds = new Nintendo3DS(file);
+	int ret;
+	if (n3ds->isValid()) {
+		ret = (n3ds->hasDangerousPermissions() ? 1 : 0);
+	} else {
+		ret = -EIO;
+	}
+	n3ds->unref();
+	return ret;
+}
+
 /**
  * Check for "viewed" achievements.
  *
@@ -17,6 +17,7 @@ namespace LibRomData {
 ROMDATA_DECL_BEGIN(Nintendo3DS)
 ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_DANGEROUS()
+ROMDATA_DECL_DANGEROUS_STATIC()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
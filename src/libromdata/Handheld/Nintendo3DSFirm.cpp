@@ -79,6 +79,19 @@ Nintendo3DSFirmPrivate::Nintendo3DSFirmPrivate(Nintendo3DSFirm *q, IRpFile *file
  * @param file Open ROM image.
  */
 Nintendo3DSFirm::Nintendo3DSFirm(IRpFile *file)
+	: Nintendo3DSFirm(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo 3DS firmware binary.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Nintendo3DSFirm::Nintendo3DSFirm(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new Nintendo3DSFirmPrivate(this, file))
 {
 	RP_D(Nintendo3DSFirm);
@@ -92,8 +105,7 @@ Nintendo3DSFirm::Nintendo3DSFirm(IRpFile *file)
 	}
 
 	// Read the firmware header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->firmHeader, sizeof(d->firmHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->firmHeader, sizeof(d->firmHeader));
 	if (size != sizeof(d->firmHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
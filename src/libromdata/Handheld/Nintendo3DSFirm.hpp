@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(Nintendo3DSFirm)
+ROMDATA_DECL_CTOR_DETECTINFO(Nintendo3DSFirm)
 ROMDATA_DECL_END()
 
 }
@@ -222,6 +222,19 @@ inline uint32_t Nintendo3DS_SMDH_Private::getDefaultLC(void) const
  * @param file Open SMDH file and/or section..
  */
 Nintendo3DS_SMDH::Nintendo3DS_SMDH(IRpFile *file)
+	: Nintendo3DS_SMDH(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo 3DS SMDH file and/or section.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Nintendo3DS_SMDH::Nintendo3DS_SMDH(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new Nintendo3DS_SMDH_Private(this, file))
 {
 	// This class handles SMDH files and/or sections only.
@@ -236,8 +249,7 @@ Nintendo3DS_SMDH::Nintendo3DS_SMDH(IRpFile *file)
 	}
 
 	// Read the SMDH section.
-	d->file->rewind();
-	size_t size = d->file->read(&d->smdh, sizeof(d->smdh));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->smdh, sizeof(d->smdh));
 	if (size != sizeof(d->smdh)) {
 		d->smdh.header.magic = 0;
 		d->file->unref();
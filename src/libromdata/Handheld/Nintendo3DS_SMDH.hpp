@@ -16,6 +16,7 @@ namespace LibRomData {
 
 class Nintendo3DS_SMDH_Private;
 ROMDATA_DECL_BEGIN(Nintendo3DS_SMDH)
+ROMDATA_DECL_CTOR_DETECTINFO(Nintendo3DS_SMDH)
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
@@ -24,6 +24,9 @@ namespace LibRpBase {
 namespace LibRpFile {
 	class IRpFile;
 }
+namespace LibRpThreads {
+	class Mutex;
+}
 
 // Uninitialized vector class.
 // Reference: http://andreoffringa.org/?q=uvector
@@ -130,6 +133,17 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 		// Loaded by loadTicketAndTMD().
 		ao::uvector<N3DS_Content_Chunk_Record_t> content_chunks;
 
+		// Content start addresses, in bytes. (CIA only)
+		// Each entry corresponds to the same entry in content_chunks.
+		// Loaded by loadTicketAndTMD().
+		ao::uvector<off64_t> content_offsets;
+
+		// Decrypted title key. (CIA only)
+		// Loaded by loadTitleKey().
+		uint8_t title_key[16];
+		// Title key status: 0 == not loaded; 1 == OK; -1 == error
+		int8_t title_key_status;
+
 		// TODO: Move the pointers to the union?
 		// That requires careful memory management...
 
@@ -164,12 +178,30 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 
 		/**
 		 * Load the specified NCCH header.
+		 *
+		 * If a mutex is specified, loadNCCH() can be called by
+		 * multiple threads at once, as long as the ticket, TMD,
+		 * and title key were already loaded.
+		 *
 		 * @param idx			[in] Content/partition index.
 		 * @param pOutNcchReader	[out] Output variable for the NCCHReader.
+		 * @param mutex			[in,opt] Mutex for file and KeyManager access.
 		 * @return 0 on success; negative POSIX error code on error.
 		 * NOTE: Caller must check NCCHReader::isOpen().
 		 */
-		int loadNCCH(int idx, NCCHReader **pOutNcchReader);
+		int loadNCCH(int idx, NCCHReader **pOutNcchReader, LibRpThreads::Mutex *mutex = nullptr);
+
+		/**
+		 * Load the NCCH headers for contents [0, count). (CIA only)
+		 *
+		 * This is equivalent to calling loadNCCH() for each content,
+		 * but encrypted contents are loaded by multiple threads.
+		 *
+		 * @param count		[in] Number of contents.
+		 * @param pRet		[out] loadNCCH() return values. (must have count elements)
+		 * @param pNcchReaders	[out] NCCHReaders. (must have count elements)
+		 */
+		void loadNCCHs(unsigned int count, int *pRet, NCCHReader **pNcchReaders);
 
 		/**
 		 * Create an NCCHReader for the primary content.
@@ -194,6 +226,21 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 		 */
 		int loadTicketAndTMD(void);
 
+		/**
+		 * Find a content chunk by TMD content index. (CIA only)
+		 * @param idx TMD content index.
+		 * @return Index in content_chunks, or -1 if not found.
+		 */
+		int findContentChunk(int idx) const;
+
+		/**
+		 * Get the decrypted title key. (CIA only)
+		 * The title key is decrypted once and cached.
+		 * loadTicketAndTMD() must be called first.
+		 * @return Decrypted title key, or nullptr if it could not be decrypted.
+		 */
+		const uint8_t *loadTitleKey(void);
+
 		/**
 		 * Open the SRL if it isn't already opened.
 		 * This operation only works for CIAs that contain an SRL.
@@ -25,6 +25,7 @@ using namespace LibRpTexture;
 // C++ STL classes.
 using std::array;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace LibRomData {
@@ -43,6 +44,7 @@ NintendoDSPrivate::NintendoDSPrivate(NintendoDS *q, IRpFile *file, bool cia)
 	, secData(0)
 	, secArea(NDS_SECAREA_UNKNOWN)
 	, nds_icon_title_loaded(false)
+	, nds_icon_title_partial(false)
 	, cia(cia)
 	, fieldIdx_secData(-1)
 	, fieldIdx_secArea(-1)
@@ -59,13 +61,18 @@ NintendoDSPrivate::~NintendoDSPrivate()
 
 /**
  * Load the icon/title data.
+ *
+ * In metadata-only mode, the DSi animated icon data
+ * is skipped unless needIcon is true.
+ *
+ * @param needIcon If true, the DSi animated icon data is required.
  * @return 0 on success; negative POSIX error code on error.
  */
-int NintendoDSPrivate::loadIconTitleData(void)
+int NintendoDSPrivate::loadIconTitleData(bool needIcon)
 {
 	assert(this->file != nullptr);
 
-	if (nds_icon_title_loaded) {
+	if (nds_icon_title_loaded && (!nds_icon_title_partial || !needIcon)) {
 		// Icon/title data is already loaded.
 		return 0;
 	}
@@ -78,8 +85,31 @@ int NintendoDSPrivate::loadIconTitleData(void)
 		return -ENOENT;
 	}
 
+	if (nds_icon_title_loaded) {
+		// The titles were loaded in metadata-only mode, so the
+		// DSi animated icon data past NDS_ICON_SIZE_HANS_KO was
+		// never read. Read it now; otherwise, the icon would be
+		// decoded from uninitialized data.
+		const size_t dsi_size = sizeof(nds_icon_title) - NDS_ICON_SIZE_HANS_KO;
+		uint8_t *const pDSi = reinterpret_cast<uint8_t*>(&nds_icon_title) + NDS_ICON_SIZE_HANS_KO;
+		const size_t size = this->file->seekAndRead(icon_offset + NDS_ICON_SIZE_HANS_KO, pDSi, dsi_size);
+		if (size != dsi_size) {
+			// Error reading the DSi animated icon data.
+			return -EIO;
+		}
+		nds_icon_title_partial = false;
+		return 0;
+	}
+
 	// Read the icon/title data.
-	size_t size = this->file->seekAndRead(icon_offset, &nds_icon_title, sizeof(nds_icon_title));
+	// In metadata-only mode, only the titles are needed, so the
+	// DSi animated icon data is skipped unless it's requested.
+	// NOTE: NDS_ICON_SIZE_HANS_KO is cast to size_t so both
+	// operands of ?: have the same type. (-Wextra)
+	const size_t read_size = ((metaDataOnly && !needIcon)
+		? static_cast<size_t>(NDS_ICON_SIZE_HANS_KO)
+		: sizeof(nds_icon_title));
+	size_t size = this->file->seekAndRead(icon_offset, &nds_icon_title, read_size);
 
 	// Make sure we have the correct size based on the version.
 	if (size < sizeof(nds_icon_title.version)) {
@@ -106,6 +136,14 @@ int NintendoDSPrivate::loadIconTitleData(void)
 			return -EIO;
 	}
 
+	bool partial = false;
+	if (req_size > read_size) {
+		// Metadata-only mode. The DSi animated icon data
+		// wasn't read, so loadIcon() will have to read it.
+		req_size = static_cast<unsigned int>(read_size);
+		partial = true;
+	}
+
 	if (size < req_size) {
 		// Error reading the icon data.
 		return -EIO;
@@ -113,6 +151,7 @@ int NintendoDSPrivate::loadIconTitleData(void)
 
 	// Icon data loaded.
 	nds_icon_title_loaded = true;
+	nds_icon_title_partial = partial;
 	return 0;
 }
 
@@ -131,7 +170,9 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 	}
 
 	// Attempt to load the icon/title data.
-	int ret = loadIconTitleData();
+	// NOTE: The DSi animated icon data is required here,
+	// even in metadata-only mode.
+	int ret = loadIconTitleData(true);
 	if (ret != 0) {
 		// Error loading the icon/title data.
 		return nullptr;
@@ -242,6 +283,32 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 	return icon_first_frame;
 }
 
+/**
+ * Does a ROM header have "dangerous" permissions?
+ * @param romHeader ROM header.
+ * @return True if the ROM header has "dangerous" permissions; false if not.
+ */
+bool NintendoDSPrivate::checkDangerousPermissions(const NDS_RomHeader *romHeader)
+{
+	// If Game Card Power On is set, eMMC Access and SD Card must be off.
+	// This combination is normally not found in licensed games,
+	// and is only found in the system menu. Some homebrew titles
+	// might have this set, though.
+	const uint32_t dsi_access_control = le32_to_cpu(romHeader->dsi.access_control);
+	if (dsi_access_control & DSi_ACCESS_GAME_CARD_POWER_ON) {
+		// Game Card Power On is set.
+		if (dsi_access_control & (DSi_ACCESS_SD_CARD | DSi_ACCESS_eMMC_ACCESS)) {
+			// SD and/or eMMC is set.
+			// This combination is not allowed by Nintendo, and
+			// usually indicates some sort of homebrew.
+			return true;
+		}
+	}
+
+	// Not dangerous.
+	return false;
+}
+
 /**
  * Get the maximum supported language for an icon/title version.
  * @param version Icon/title version.
@@ -1620,24 +1687,42 @@ bool NintendoDS::hasDangerousPermissions(void) const
 	// Load permissions.
 	// TODO: If this is DSiWare, check DSiWare permissions?
 	RP_D(const NintendoDS);
+	return NintendoDSPrivate::checkDangerousPermissions(&d->romHeader);
+}
 
-	// If Game Card Power On is set, eMMC Access and SD Card must be off.
-	// This combination is normally not found in licensed games,
-	// and is only found in the system menu. Some homebrew titles
-	// might have this set, though.
-	const uint32_t dsi_access_control = le32_to_cpu(d->romHeader.dsi.access_control);
-	if (dsi_access_control & DSi_ACCESS_GAME_CARD_POWER_ON) {
-		// Game Card Power On is set.
-		if (dsi_access_control & (DSi_ACCESS_SD_CARD | DSi_ACCESS_eMMC_ACCESS)) {
-			// SD and/or eMMC is set.
-			// This combination is not allowed by Nintendo, and
-			// usually indicates some sort of homebrew.
-			return true;
+/**
+ * Does a ROM image have "dangerous" permissions?
+ * This only reads the data needed to make the decision.
+ *
+ * @param file Open ROM image.
+ * @param info DetectInfo that was accepted by isRomSupported_static().
+ * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+ */
+int NintendoDS::hasDangerousPermissions_static(IRpFile *file, const DetectInfo *info)
+{
+	assert(file != nullptr);
+	assert(info != nullptr);
+	if (!file || !info) {
+		return -EINVAL;
+	}
+
+	// The permissions are in the ROM header, which is
+	// usually within the RomDataFactory detection buffer.
+	const NDS_RomHeader *romHeader;
+	unique_ptr<NDS_RomHeader> romHeaderBuf;
+	if (info->header.addr == 0 && info->header.size >= sizeof(NDS_RomHeader)) {
+		romHeader = reinterpret_cast<const NDS_RomHeader*>(info->header.pData);
+	} else {
+		romHeaderBuf.reset(new NDS_RomHeader);
+		size_t size = file->seekAndRead(0, romHeaderBuf.get(), sizeof(NDS_RomHeader));
+		if (size != sizeof(NDS_RomHeader)) {
+			// Seek and/or read error.
+			return -EIO;
 		}
+		romHeader = romHeaderBuf.get();
 	}
 
-	// Not dangerous.
-	return false;
+	return (NintendoDSPrivate::checkDangerousPermissions(romHeader) ? 1 : 0);
 }
 
 }
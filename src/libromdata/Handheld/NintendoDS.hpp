@@ -39,6 +39,7 @@ ROMDATA_DECL_BEGIN(NintendoDS)
 		void init(void);
 
 ROMDATA_DECL_DANGEROUS()
+ROMDATA_DECL_DANGEROUS_STATIC()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
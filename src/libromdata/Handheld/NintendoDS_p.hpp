@@ -115,6 +115,7 @@ class NintendoDSPrivate final : public LibRpBase::RomDataPrivate
 		// NOTE: Must be byteswapped on access.
 		NDS_IconTitleData nds_icon_title;
 		bool nds_icon_title_loaded;
+		bool nds_icon_title_partial;	// DSi animated icon data wasn't loaded. (metadata-only mode)
 
 		// If true, this is an SRL in a 3DS CIA.
 		// Some fields shouldn't be displayed.
@@ -126,9 +127,14 @@ class NintendoDSPrivate final : public LibRpBase::RomDataPrivate
 
 		/**
 		 * Load the icon/title data.
+		 *
+		 * In metadata-only mode, the DSi animated icon data
+		 * is skipped unless needIcon is true.
+		 *
+		 * @param needIcon If true, the DSi animated icon data is required.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int loadIconTitleData(void);
+		int loadIconTitleData(bool needIcon = false);
 
 		/**
 		 * Load the ROM image's icon.
@@ -214,6 +220,13 @@ class NintendoDSPrivate final : public LibRpBase::RomDataPrivate
 		 */
 		static LibRpBase::RomFields::ListData_t *getDSiFlagsStringVector(void);
 
+		/**
+		 * Does a ROM header have "dangerous" permissions?
+		 * @param romHeader ROM header.
+		 * @return True if the ROM header has "dangerous" permissions; false if not.
+		 */
+		static bool checkDangerousPermissions(const NDS_RomHeader *romHeader);
+
 		/**
 		 * Get the maximum supported language for an icon/title version.
 		 * @param version Icon/title version.
@@ -61,6 +61,19 @@ PokemonMiniPrivate::PokemonMiniPrivate(PokemonMini *q, IRpFile *file)
  * @param file Open ROM image.
  */
 PokemonMini::PokemonMini(IRpFile *file)
+	: PokemonMini(file, nullptr)
+{ }
+
+/**
+ * Read a Pokémon Mini ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+PokemonMini::PokemonMini(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new PokemonMiniPrivate(this, file))
 {
 	RP_D(PokemonMini);
@@ -73,7 +86,7 @@ PokemonMini::PokemonMini(IRpFile *file)
 	}
 
 	// Read the ROM header.
-	size_t size = d->file->seekAndRead(POKEMONMINI_HEADER_ADDRESS, &d->romHeader, sizeof(d->romHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, POKEMONMINI_HEADER_ADDRESS, &d->romHeader, sizeof(d->romHeader));
 	if (size != sizeof(d->romHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
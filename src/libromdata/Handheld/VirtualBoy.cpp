@@ -120,6 +120,19 @@ bool inline VirtualBoyPrivate::isGameID(char c){
  * @param file Open ROM file.
  */
 VirtualBoy::VirtualBoy(IRpFile *file)
+	: VirtualBoy(file, nullptr)
+{ }
+
+/**
+ * Read a Virtual Boy ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+VirtualBoy::VirtualBoy(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new VirtualBoyPrivate(this, file))
 {
 	RP_D(VirtualBoy);
@@ -143,8 +156,7 @@ VirtualBoy::VirtualBoy(IRpFile *file)
 
 	// Read the ROM footer.
 	const unsigned int footer_addr = static_cast<unsigned int>(filesize - 0x220);
-	d->file->seek(footer_addr);
-	size_t size = d->file->read(&d->romFooter, sizeof(d->romFooter));
+	size_t size = d->seekAndReadHeader(detectInfo, footer_addr, &d->romFooter, sizeof(d->romFooter));
 	if (size != sizeof(d->romFooter)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
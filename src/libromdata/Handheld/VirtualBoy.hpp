@@ -15,6 +15,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(VirtualBoy)
+ROMDATA_DECL_CTOR_DETECTINFO(VirtualBoy)
 ROMDATA_DECL_END()
 
 }
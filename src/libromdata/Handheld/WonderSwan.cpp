@@ -110,6 +110,19 @@ string WonderSwanPrivate::getGameID(void) const
  * @param file Open ROM file.
  */
 WonderSwan::WonderSwan(IRpFile *file)
+	: WonderSwan(file, nullptr)
+{ }
+
+/**
+ * Read a WonderSwan (Color) ROM image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+WonderSwan::WonderSwan(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new WonderSwanPrivate(this, file))
 {
 	RP_D(WonderSwan);
@@ -133,8 +146,7 @@ WonderSwan::WonderSwan(IRpFile *file)
 
 	// Read the ROM footer.
 	const unsigned int footer_addr = static_cast<unsigned int>(filesize - sizeof(WS_RomFooter));
-	d->file->seek(footer_addr);
-	size_t size = d->file->read(&d->romFooter, sizeof(d->romFooter));
+	size_t size = d->seekAndReadHeader(detectInfo, footer_addr, &d->romFooter, sizeof(d->romFooter));
 	if (size != sizeof(d->romFooter)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -92,6 +92,19 @@ bool AmiiboPrivate::calcCheckBytes(const uint8_t *serial, uint8_t *pCb0, uint8_t
  * @param file Open NFC dump.
  */
 Amiibo::Amiibo(IRpFile *file)
+	: Amiibo(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo amiibo NFC dump.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+Amiibo::Amiibo(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new AmiiboPrivate(this, file))
 {
 	// This class handles NFC dumps.
@@ -106,8 +119,7 @@ Amiibo::Amiibo(IRpFile *file)
 	}
 
 	// Read the NFC data.
-	d->file->rewind();
-	size_t size = d->file->read(&d->nfpData, sizeof(d->nfpData));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->nfpData, sizeof(d->nfpData));
 	switch (size) {
 		case NFP_FILE_NO_PW:	// Missing password bytes.
 			// Zero out the password bytes.
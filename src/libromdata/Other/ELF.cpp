@@ -747,6 +747,19 @@ int ELFPrivate::addPtDynamicFields(void)
  * @param file Open ROM image.
  */
 ELF::ELF(IRpFile *file)
+	: ELF(file, nullptr)
+{ }
+
+/**
+ * Read an ELF executable.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+ELF::ELF(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new ELFPrivate(this, file))
 {
 	// This class handles different types of files.
@@ -763,8 +776,7 @@ ELF::ELF(IRpFile *file)
 	// Assume this is a 64-bit ELF executable and read a 64-bit header.
 	// 32-bit executables have a smaller header, but they should have
 	// more data than just the header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->Elf_Header, sizeof(d->Elf_Header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->Elf_Header, sizeof(d->Elf_Header));
 	if (size != sizeof(d->Elf_Header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
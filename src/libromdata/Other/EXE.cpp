@@ -393,6 +393,19 @@ void EXEPrivate::addFields_LE(void)
  * @param file Open ROM image.
  */
 EXE::EXE(IRpFile *file)
+	: EXE(file, nullptr)
+{ }
+
+/**
+ * Read a DOS/Windows executable.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+EXE::EXE(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new EXEPrivate(this, file))
 {
 	// This class handles different types of files.
@@ -408,8 +421,7 @@ EXE::EXE(IRpFile *file)
 	}
 
 	// Read the DOS MZ header.
-	d->file->rewind();
-	size_t size = d->file->read(&d->mz, sizeof(d->mz));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->mz, sizeof(d->mz));
 	if (size != sizeof(d->mz)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -917,6 +929,99 @@ bool EXE::hasDangerousPermissions(void) const
 #endif /* ENABLE_XML */
 }
 
+/**
+ * Does a ROM image have "dangerous" permissions?
+ * This only reads the data needed to make the decision.
+ *
+ * @param file Open ROM image.
+ * @param info DetectInfo that was accepted by isRomSupported_static().
+ * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+ */
+int EXE::hasDangerousPermissions_static(IRpFile *file, const DetectInfo *info)
+{
+#ifdef ENABLE_XML
+	assert(file != nullptr);
+	assert(info != nullptr);
+	if (!file || !info || info->header.addr != 0 ||
+	    info->header.size < sizeof(IMAGE_DOS_HEADER))
+	{
+		return -EINVAL;
+	}
+
+	// Only PE executables with a resource section can have a
+	// Win32 manifest, so check the headers before constructing
+	// an EXE object. This is the same check as the constructor.
+	const IMAGE_DOS_HEADER *const mz = reinterpret_cast<const IMAGE_DOS_HEADER*>(info->header.pData);
+	if (le16_to_cpu(mz->e_lfarlc) < 0x40 ||
+	    mz->e_magic == cpu_to_be16('ZM')) {
+		// MS-DOS executable.
+		return 0;
+	}
+
+	decltype(EXEPrivate::hdr) hdr;
+	const uint32_t hdr_addr = le32_to_cpu(mz->e_lfanew);
+	if (hdr_addr < sizeof(*mz)) {
+		// PE header address is out of range.
+		return 0;
+	}
+	if (static_cast<size_t>(hdr_addr) + sizeof(hdr) <= info->header.size) {
+		// Secondary header is within the detection buffer.
+		memcpy(&hdr, &info->header.pData[hdr_addr], sizeof(hdr));
+	} else {
+		size_t size = file->seekAndRead(hdr_addr, &hdr, sizeof(hdr));
+		if (size != sizeof(hdr)) {
+			// Seek and/or read error.
+			return 0;
+		}
+	}
+
+	// NOTE: MSVC handles 'PE\0\0' as 0x00504500,
+	// probably due to the embedded NULL bytes.
+	if (hdr.pe.Signature != cpu_to_be32(0x50450000) /*'PE\0\0'*/) {
+		// Not a PE executable.
+		return 0;
+	}
+
+	const IMAGE_DATA_DIRECTORY *dataDir;
+	uint32_t numDirs;
+	switch (le16_to_cpu(hdr.pe.OptionalHeader.Magic)) {
+		case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+			dataDir = hdr.pe.OptionalHeader.opt32.DataDirectory;
+			numDirs = le32_to_cpu(hdr.pe.OptionalHeader.opt32.NumberOfRvaAndSizes);
+			break;
+		case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+			dataDir = hdr.pe.OptionalHeader.opt64.DataDirectory;
+			numDirs = le32_to_cpu(hdr.pe.OptionalHeader.opt64.NumberOfRvaAndSizes);
+			break;
+		default:
+			// Unsupported PE executable.
+			return 0;
+	}
+	if (numDirs <= IMAGE_DATA_DIRECTORY_RESOURCE_TABLE ||
+	    dataDir[IMAGE_DATA_DIRECTORY_RESOURCE_TABLE].Size == 0)
+	{
+		// No resource section.
+		return 0;
+	}
+
+	// Check the Win32 manifest.
+	EXE *const exe = new EXE(file, info);
+	int ret;
+	if (exe->isValid()) {
+		ret = (exe->hasDangerousPermissions() ? 1 : 0);
+	} else {
+		ret = -EIO;
+	}
+	exe->unref();
+	return ret;
+#else /* !ENABLE_XML */
+	// Nothing to check here, since TinyXML2 is disabled...
+	RP_UNUSED(file);
+	RP_UNUSED(info);
+	return 0;
+#endif /* ENABLE_XML */
+}
+
 /**
  * Check for "viewed" achievements.
  *
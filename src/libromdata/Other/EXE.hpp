@@ -14,7 +14,9 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(EXE)
+ROMDATA_DECL_CTOR_DETECTINFO(EXE)
 ROMDATA_DECL_DANGEROUS()
+ROMDATA_DECL_DANGEROUS_STATIC()
 ROMDATA_DECL_VIEWED_ACHIEVEMENTS()
 ROMDATA_DECL_END()
 
@@ -550,6 +550,19 @@ void ISOPrivate::addPVDTimestamps_metaData(RomMetaData *metaData, const T *pvd)
  * @param file Open ROM image.
  */
 ISO::ISO(IRpFile *file)
+	: ISO(file, nullptr)
+{ }
+
+/**
+ * Read an ISO-9660 disc image.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+ISO::ISO(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new ISOPrivate(this, file))
 {
 	// This class handles disc images.
@@ -564,7 +577,7 @@ ISO::ISO(IRpFile *file)
 	}
 
 	// Read the PVD. (2048-byte sector address)
-	size_t size = d->file->seekAndRead(ISO_PVD_ADDRESS_2048 + ISO_DATA_OFFSET_MODE1_COOKED,
+	size_t size = d->seekAndReadHeader(detectInfo, ISO_PVD_ADDRESS_2048 + ISO_DATA_OFFSET_MODE1_COOKED,
 		&d->pvd, sizeof(d->pvd));
 	if (size != sizeof(d->pvd)) {
 		// Seek and/or read error.
@@ -586,7 +599,7 @@ ISO::ISO(IRpFile *file)
 		CDROM_2352_Sector_t sector;
 
 		for (const unsigned int *p = sector_sizes; *p != 0; p++) {
-			size_t size = d->file->seekAndRead(*p * ISO_PVD_LBA, &sector, sizeof(sector));
+			size_t size = d->seekAndReadHeader(detectInfo, *p * ISO_PVD_LBA, &sector, sizeof(sector));
 			if (size != sizeof(sector)) {
 				// Unable to read the PVD.
 				UNREF_AND_NULL_NOCHK(d->file);
@@ -20,6 +20,7 @@ namespace LibRpBase {
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(ISO)
+ROMDATA_DECL_CTOR_DETECTINFO(ISO)
 
 	public:
 		/**
@@ -137,6 +137,19 @@ MachOPrivate::Mach_Format MachOPrivate::checkMachMagicNumber(uint32_t magic)
  * @param file Open ROM image.
  */
 MachO::MachO(IRpFile *file)
+	: MachO(file, nullptr)
+{ }
+
+/**
+ * Read a Mach-O executable.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+MachO::MachO(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new MachOPrivate(this, file))
 {
 	// This class handles different types of files.
@@ -155,8 +168,7 @@ MachO::MachO(IRpFile *file)
 	// - Universal header: 2 DWORDs, plus 5 DWORDs per architecture.
 	// Assuming up to 16 architectures, read 2+(5*16) = 82 DWORDs, or 328 bytes.
 	uint8_t header[(2+(5*MAX_MACH_HEADERS))*sizeof(uint32_t)];
-	d->file->rewind();
-	size_t size = d->file->read(header, sizeof(header));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, header, sizeof(header));
 	if (size != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(MachO)
+ROMDATA_DECL_CTOR_DETECTINFO(MachO)
 ROMDATA_DECL_END()
 
 }
@@ -393,6 +393,19 @@ inline uint32_t NintendoBadgePrivate::getDefaultLC(void) const
  * @param file Open ROM image.
  */
 NintendoBadge::NintendoBadge(IRpFile *file)
+	: NintendoBadge(file, nullptr)
+{ }
+
+/**
+ * Read a Nintendo Badge image file.
+ *
+ * The header is copied from the RomDataFactory detection
+ * buffer if it's available.
+ *
+ * @param file Open ROM image.
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ */
+NintendoBadge::NintendoBadge(IRpFile *file, const DetectInfo *detectInfo)
 	: super(new NintendoBadgePrivate(this, file))
 {
 	// This class handles texture files.
@@ -408,8 +421,7 @@ NintendoBadge::NintendoBadge(IRpFile *file)
 	// Read the badge header.
 	// NOTE: Reading the full size, which should be valid
 	// for both PRBS and CABS.
-	d->file->rewind();
-	size_t size = d->file->read(&d->badgeHeader, sizeof(d->badgeHeader));
+	size_t size = d->seekAndReadHeader(detectInfo, 0, &d->badgeHeader, sizeof(d->badgeHeader));
 	if (size != sizeof(d->badgeHeader)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -13,12 +13,16 @@
 #include "RomDataFactory.hpp"
 
 // librpbase, librpfile
+#include "librpbase/Profiler.hpp"
 #include "librpfile/RelatedFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 
 // librpthreads
+#include "librpthreads/Mutex.hpp"
 #include "librpthreads/pthread_once.h"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
 
 // librptexture
 #include "librptexture/FileFormatFactory.hpp"
@@ -117,11 +121,13 @@ class RomDataFactoryPrivate
 		typedef int (*pfnIsRomSupported_t)(const RomData::DetectInfo *info);
 		typedef const char *const * (*pfnSupportedFileExtensions_t)(void);
 		typedef const char *const * (*pfnSupportedMimeTypes_t)(void);
-		typedef RomData* (*pfnNewRomData_t)(IRpFile *file);
+		typedef RomData* (*pfnNewRomData_t)(IRpFile *file, const RomData::DetectInfo *info);
+		typedef int (*pfnHasDangerousPermissions_t)(IRpFile *file, const RomData::DetectInfo *info);
 
 		struct RomDataFns {
 			pfnIsRomSupported_t isRomSupported;
 			pfnNewRomData_t newRomData;
+			pfnHasDangerousPermissions_t hasDangerousPermissions;
 			pfnSupportedFileExtensions_t supportedFileExtensions;
 			pfnSupportedMimeTypes_t supportedMimeTypes;
 			unsigned int attrs;
@@ -133,18 +139,108 @@ class RomDataFactoryPrivate
 		};
 
 		/**
-		 * Templated function to construct a new RomData subclass.
+		 * Construct a new RomData subclass using the DetectInfo constructor.
+		 * Used if the subclass has ROMDATA_DECL_CTOR_DETECTINFO().
 		 * @param klass Class name.
+		 * @param file ROM file.
+		 * @param info DetectInfo with the header data that was already read.
 		 */
 		template<typename klass>
-		static LibRpBase::RomData *RomData_ctor(LibRpFile::IRpFile *file)
+		static auto RomData_ctor_int(LibRpFile::IRpFile *file, const RomData::DetectInfo *info, int)
+			-> decltype(new klass(file, info))
 		{
+			return new klass(file, info);
+		}
+
+		/**
+		 * Construct a new RomData subclass using the standard constructor.
+		 * Used if the subclass doesn't have ROMDATA_DECL_CTOR_DETECTINFO().
+		 * @param klass Class name.
+		 * @param file ROM file.
+		 * @param info DetectInfo. (ignored)
+		 */
+		template<typename klass>
+		static LibRpBase::RomData *RomData_ctor_int(LibRpFile::IRpFile *file, const RomData::DetectInfo *info, long)
+		{
+			RP_UNUSED(info);
 			return new klass(file);
 		}
 
+		/**
+		 * Templated function to construct a new RomData subclass.
+		 *
+		 * If the subclass has a DetectInfo constructor, the header data
+		 * that was already read by RomDataFactory is passed to it, so
+		 * the subclass doesn't have to read it from the file again.
+		 *
+		 * @param klass Class name.
+		 * @param file ROM file.
+		 * @param info DetectInfo with the header data that was already read. (may be nullptr)
+		 */
+		template<typename klass>
+		static LibRpBase::RomData *RomData_ctor(LibRpFile::IRpFile *file, const RomData::DetectInfo *info)
+		{
+			// NOTE: The int/long parameter prefers the DetectInfo
+			// constructor if it's available.
+			return RomData_ctor_int<klass>(file, info, 0);
+		}
+
+		/**
+		 * Check a RomData subclass for "dangerous" permissions using its light-weight probe.
+		 * Used if the subclass has ROMDATA_DECL_DANGEROUS_STATIC().
+		 * @param klass Class name.
+		 * @param file ROM file.
+		 * @param info DetectInfo that was accepted by klass::isRomSupported_static().
+		 * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+		 */
+		template<typename klass>
+		static auto hasDangerousPermissions_int(LibRpFile::IRpFile *file, const RomData::DetectInfo *info, int)
+			-> decltype(klass::hasDangerousPermissions_static(file, info))
+		{
+			return klass::hasDangerousPermissions_static(file, info);
+		}
+
+		/**
+		 * Check a RomData subclass for "dangerous" permissions by constructing it.
+		 * Used if the subclass doesn't have ROMDATA_DECL_DANGEROUS_STATIC().
+		 * @param klass Class name.
+		 * @param file ROM file.
+		 * @param info DetectInfo that was accepted by klass::isRomSupported_static().
+		 * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+		 */
+		template<typename klass>
+		static int hasDangerousPermissions_int(LibRpFile::IRpFile *file, const RomData::DetectInfo *info, long)
+		{
+			RomData *const romData = RomData_ctor<klass>(file, info);
+			int ret;
+			if (romData->isValid()) {
+				ret = (romData->hasDangerousPermissions() ? 1 : 0);
+			} else {
+				ret = -EIO;
+			}
+			romData->unref();
+			return ret;
+		}
+
+		/**
+		 * Templated function to check a RomData subclass for "dangerous" permissions.
+		 * @param klass Class name.
+		 * @param file ROM file.
+		 * @param info DetectInfo that was accepted by klass::isRomSupported_static().
+		 * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+		 */
+		template<typename klass>
+		static int hasDangerousPermissions(LibRpFile::IRpFile *file, const RomData::DetectInfo *info)
+		{
+			// NOTE: The int/long parameter prefers the
+			// light-weight probe if it's available.
+			return hasDangerousPermissions_int<klass>(file, info, 0);
+		}
+
 #define GetRomDataFns(sys, attrs) \
 	{sys::isRomSupported_static, \
 	 RomDataFactoryPrivate::RomData_ctor<sys>, \
+	 RomDataFactoryPrivate::hasDangerousPermissions<sys>, \
 	 sys::supportedFileExtensions_static, \
 	 sys::supportedMimeTypes_static, \
 	 attrs, 0, 0}
@@ -152,6 +248,7 @@ class RomDataFactoryPrivate
 #define GetRomDataFns_addr(sys, attrs, address, size) \
 	{sys::isRomSupported_static, \
 	 RomDataFactoryPrivate::RomData_ctor<sys>, \
+	 RomDataFactoryPrivate::hasDangerousPermissions<sys>, \
 	 sys::supportedFileExtensions_static, \
 	 sys::supportedMimeTypes_static, \
 	 attrs, address, size}
@@ -182,6 +279,34 @@ class RomDataFactoryPrivate
 		 */
 		static RomData *openDreamcastVMSandVMI(IRpFile *file);
 
+		/**
+		 * Create a RomData subclass for the specified ROM file.
+		 * Internal implementation of RomDataFactory::create().
+		 * @param file ROM file.
+		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+		 * @return RomData subclass, or nullptr if the ROM isn't supported.
+		 */
+		static RomData *create(IRpFile *file, unsigned int attrs);
+
+		/**
+		 * Check if a ROM file has "dangerous" permissions.
+		 * Internal implementation of RomDataFactory::hasDangerousPermissions().
+		 * @param file ROM file.
+		 * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+		 */
+		static int hasDangerousPermissions(IRpFile *file);
+
+		// hasDangerousPermissions() cache.
+		// Key: Filename; value: file size, mtime, and result.
+		// If the file size or mtime changes, the entry is discarded.
+		struct DPCacheEntry {
+			off64_t szFile;
+			time_t mtime;
+			bool dangerous;
+		};
+		static unordered_map<string, DPCacheEntry> dp_cache;
+		static Mutex dp_mutex;
+
 		// Vectors for file extensions and MIME types.
 		// We want to collect them once per session instead of
 		// repeatedly collecting them, since the caller might
@@ -230,6 +355,12 @@ vector<const char*> RomDataFactoryPrivate::vec_mimeTypes;
 pthread_once_t RomDataFactoryPrivate::once_exts = PTHREAD_ONCE_INIT;
 pthread_once_t RomDataFactoryPrivate::once_mimeTypes = PTHREAD_ONCE_INIT;
 
+// Maximum number of hasDangerousPermissions() cache entries.
+// If this is exceeded, the cache is cleared.
+#define DP_CACHE_MAX 16384
+unordered_map<string, RomDataFactoryPrivate::DPCacheEntry> RomDataFactoryPrivate::dp_cache;
+Mutex RomDataFactoryPrivate::dp_mutex;
+
 #define ATTR_NONE		RomDataFactory::RDA_NONE
 #define ATTR_HAS_THUMBNAIL	RomDataFactory::RDA_HAS_THUMBNAIL
 #define ATTR_HAS_DPOVERLAY	RomDataFactory::RDA_HAS_DPOVERLAY
@@ -288,7 +419,7 @@ const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_magic[
 	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'PIRS'),
 	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'LIVE'),
 
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
 };
 
 // RomData subclasses that use a header.
@@ -351,14 +482,14 @@ const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_header
 	// NOTE: ATTR_HAS_THUMBNAIL is needed for Xbox 360.
 	GetRomDataFns_addr(ISO, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES | ATTR_CHECK_ISO, 0x40000, 0x20),
 
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
 };
 
 // RomData subclasses that use a footer.
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_footer[] = {
 	GetRomDataFns(VirtualBoy, ATTR_NONE),
 	GetRomDataFns(WonderSwan, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
 };
 
 // Table of pointers to tables.
@@ -456,6 +587,15 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 		return nullptr;
 	}
 
+	// DetectInfo for the PVD sector.
+	// This is passed to the RomData subclass constructors.
+	RomData::DetectInfo info;
+	info.header.addr = ISO_PVD_ADDRESS_2048;
+	info.header.size = static_cast<uint32_t>(sizeof(sector.m1.data));
+	info.header.pData = sector.m1.data;
+	info.ext = nullptr;
+	info.szFile = 0;
+
 	bool is2048;
 	const ISO_Primary_Volume_Descriptor *pvd = nullptr;
 	int discType = ISO::checkPVD(sector.m1.data);
@@ -479,6 +619,9 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 			if (ISO::checkPVD(pData) >= 0) {
 				// Found the correct sector size.
 				pvd = reinterpret_cast<const ISO_Primary_Volume_Descriptor*>(pData);
+				info.header.addr = *p * ISO_PVD_LBA;
+				info.header.size = static_cast<uint32_t>(sizeof(sector));
+				info.header.pData = reinterpret_cast<const uint8_t*>(&sector);
 				break;
 			}
 		}
@@ -510,7 +653,7 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 	for (; fns->isRomSupported != nullptr; fns++) {
 		if (fns->isRomSupported(pvd) >= 0) {
 			// This might be the correct RomData subclass.
-			RomData *const romData = fns->newRomData(file);
+			RomData *const romData = fns->newRomData(file, &info);
 			if (romData->isValid()) {
 				// Found the correct RomData subclass.
 				return romData;
@@ -543,27 +686,17 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 
 	// Not a game-specific file system.
 	// Use the generic ISO-9660 parser.
-	return new ISO(file);
+	return RomDataFactoryPrivate::RomData_ctor<ISO>(file, &info);
 }
 
-/** RomDataFactory **/
-
 /**
  * Create a RomData subclass for the specified ROM file.
- *
- * NOTE: RomData::isValid() is checked before returning a
- * created RomData instance, so returned objects can be
- * assumed to be valid as long as they aren't nullptr.
- *
- * If imgbf is non-zero, at least one of the specified image
- * types must be supported by the RomData subclass in order to
- * be returned.
- *
+ * Internal implementation of RomDataFactory::create().
  * @param file ROM file.
  * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
  * @return RomData subclass, or nullptr if the ROM isn't supported.
  */
-RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+RomData *RomDataFactoryPrivate::create(IRpFile *file, unsigned int attrs)
 {
 	RomData::DetectInfo info;
 
@@ -644,7 +777,7 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		if (be32_to_cpu(magic) == fns->size) {
 			// Found a matching magic number.
 			if (fns->isRomSupported(&info) >= 0) {
-				RomData *const romData = fns->newRomData(file);
+				RomData *const romData = fns->newRomData(file, &info);
 				if (romData->isValid()) {
 					// RomData subclass obtained.
 					return romData;
@@ -657,7 +790,8 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	}
 
 	// Check for supported textures.
-	{
+	// NOTE: RpTextureWrapper doesn't have "dangerous" permissions.
+	if (!(attrs & ATTR_HAS_DPOVERLAY)) {
 		// TODO: RpTextureWrapper::isRomSupported()?
 		RomData *const romData = new RpTextureWrapper(file);
 		if (romData->isValid()) {
@@ -750,12 +884,12 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 
 		if (fns->isRomSupported(&info) >= 0) {
 			RomData *romData;
-			if (fns->attrs & RDA_CHECK_ISO) {
+			if (fns->attrs & RomDataFactory::RDA_CHECK_ISO) {
 				// Check for a game-specific ISO subclass.
 				romData = RomDataFactoryPrivate::checkISO(file);
 			} else {
 				// Standard RomData subclass.
-				romData = fns->newRomData(file);
+				romData = fns->newRomData(file, &info);
 			}
 
 			if (romData) {
@@ -827,7 +961,7 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		}
 
 		if (fns->isRomSupported(&info) >= 0) {
-			RomData *const romData = fns->newRomData(file);
+			RomData *const romData = fns->newRomData(file, &info);
 			if (romData->isValid()) {
 				// RomData subclass obtained.
 				return romData;
@@ -842,6 +976,187 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	return nullptr;
 }
 
+/** RomDataFactory **/
+
+/**
+ * Create a RomData subclass for the specified ROM file.
+ *
+ * NOTE: RomData::isValid() is checked before returning a
+ * created RomData instance, so returned objects can be
+ * assumed to be valid as long as they aren't nullptr.
+ *
+ * If imgbf is non-zero, at least one of the specified image
+ * types must be supported by the RomData subclass in order to
+ * be returned.
+ *
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+{
+	// The class name isn't known until detection is complete.
+	Profiler::Scope profScope(nullptr, Profiler::Phase::Detection);
+	RomData *const romData = RomDataFactoryPrivate::create(file, attrs & ~RDA_METADATA_ONLY);
+	if (romData) {
+		profScope.setClassName(romData->className());
+		if (attrs & RDA_METADATA_ONLY) {
+			romData->setMetaDataOnly();
+		}
+	}
+	return romData;
+}
+
+/**
+ * Check if a ROM file has "dangerous" permissions.
+ * Internal implementation of RomDataFactory::hasDangerousPermissions().
+ * @param file ROM file.
+ * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error.
+ */
+int RomDataFactoryPrivate::hasDangerousPermissions(IRpFile *file)
+{
+	RomData::DetectInfo info;
+
+	// Get the file size.
+	info.szFile = file->size();
+
+	// Read 4,096+256 bytes from the ROM header.
+	// This is the same header that create() reads.
+	union {
+		uint8_t u8[4096+256];
+		uint32_t u32[(4096+256)/4];
+	} header;
+	file->rewind();
+	info.header.addr = 0;
+	info.header.pData = header.u8;
+	info.header.size = static_cast<uint32_t>(file->read(header.u8, sizeof(header.u8)));
+	if (info.header.size == 0) {
+		// Read error.
+		return -EIO;
+	}
+
+	// File extension.
+	string file_ext;	// temporary storage
+	info.ext = nullptr;
+	const string filename = file->filename();
+	if (!filename.empty()) {
+		const char *pExt = FileSystem::file_ext(filename);
+		if (pExt) {
+			file_ext = pExt;
+			info.ext = file_ext.c_str();
+		}
+	}
+
+	// Check the RomData subclasses that may have "dangerous" permissions,
+	// in the same order as create().
+	// NOTE: Only headers at 0 are checked. None of the subclasses that
+	// may have "dangerous" permissions use a footer or a header at a
+	// different address.
+	const RomDataFns *fns = &romDataFns_magic[0];
+	for (; fns->supportedFileExtensions != nullptr; fns++) {
+		if (!(fns->attrs & ATTR_HAS_DPOVERLAY))
+			continue;
+
+		// Check the magic number.
+		assert(fns->address % 4 == 0);
+		assert(fns->address + sizeof(uint32_t) <= sizeof(header.u32));
+		if (be32_to_cpu(header.u32[fns->address/4]) != fns->size)
+			continue;
+
+		if (fns->isRomSupported(&info) >= 0) {
+			const int ret = fns->hasDangerousPermissions(file, &info);
+			if (ret >= 0) {
+				return ret;
+			}
+			// Not actually supported.
+		}
+	}
+
+	fns = &romDataFns_header[0];
+	for (; fns->supportedFileExtensions != nullptr; fns++) {
+		if (!(fns->attrs & ATTR_HAS_DPOVERLAY))
+			continue;
+
+		assert(fns->address == 0);
+		assert(!(fns->attrs & RomDataFactory::RDA_CHECK_ISO));
+		if (fns->address != 0 || fns->size > info.header.size ||
+		    (fns->attrs & RomDataFactory::RDA_CHECK_ISO))
+		{
+			continue;
+		}
+
+		if (fns->isRomSupported(&info) >= 0) {
+			const int ret = fns->hasDangerousPermissions(file, &info);
+			if (ret >= 0) {
+				return ret;
+			}
+			// Not actually supported.
+		}
+	}
+
+	// Not supported.
+	return -ENOTSUP;
+}
+
+/**
+ * Does a ROM file have "dangerous" permissions?
+ *
+ * This is a light-weight alternative to create(file, RDA_HAS_DPOVERLAY)
+ * followed by RomData::hasDangerousPermissions(), intended for overlay
+ * icon handlers. RomData subclasses that have a light-weight probe
+ * only read the data needed to make the decision.
+ *
+ * Results are cached per file. The cache is keyed by filename,
+ * and an entry is discarded if the file size or mtime changes.
+ *
+ * @param file ROM file.
+ * @return True if the ROM file has "dangerous" permissions; false if not.
+ */
+bool RomDataFactory::hasDangerousPermissions(IRpFile *file)
+{
+	assert(file != nullptr);
+	if (!file || file->isDevice()) {
+		// None of the RomData subclasses that may have
+		// "dangerous" permissions support devices.
+		return false;
+	}
+
+	// The cache can only be used if the file has a filename and mtime.
+	const string filename = file->filename();
+	const off64_t szFile = file->size();
+	time_t mtime = 0;
+	const bool useCache = (!filename.empty() &&
+		FileSystem::get_mtime(filename, &mtime) == 0);
+
+	if (useCache) {
+		MutexLocker locker(RomDataFactoryPrivate::dp_mutex);
+		auto iter = RomDataFactoryPrivate::dp_cache.find(filename);
+		if (iter != RomDataFactoryPrivate::dp_cache.end()) {
+			const RomDataFactoryPrivate::DPCacheEntry &entry = iter->second;
+			if (entry.szFile == szFile && entry.mtime == mtime) {
+				// Cache hit.
+				return entry.dangerous;
+			}
+		}
+	}
+
+	const bool dangerous = (RomDataFactoryPrivate::hasDangerousPermissions(file) > 0);
+
+	if (useCache) {
+		MutexLocker locker(RomDataFactoryPrivate::dp_mutex);
+		if (RomDataFactoryPrivate::dp_cache.size() >= DP_CACHE_MAX) {
+			// Too many entries. Clear the cache.
+			RomDataFactoryPrivate::dp_cache.clear();
+		}
+
+		RomDataFactoryPrivate::DPCacheEntry &entry = RomDataFactoryPrivate::dp_cache[filename];
+		entry.szFile = szFile;
+		entry.mtime = mtime;
+		entry.dangerous = dangerous;
+	}
+	return dangerous;
+}
+
 /**
  * Initialize the vector of supported file extensions.
  * Used for Win32 COM registration.
@@ -56,6 +56,11 @@ class RomDataFactory
 			// Check for game-specific disc file systems.
 			// (For internal RomDataFactory use only.)
 			RDA_CHECK_ISO		= (1U << 8),
+
+			// Create the RomData object in metadata-only mode.
+			// This isn't a subclass attribute; it's only used by create().
+			// See RomData::setMetaDataOnly().
+			RDA_METADATA_ONLY	= (1U << 16),
 		};
 
 		/**
@@ -75,6 +80,22 @@ class RomDataFactory
 		 */
 		static LibRpBase::RomData *create(LibRpFile::IRpFile *file, unsigned int attrs = 0);
 
+		/**
+		 * Does a ROM file have "dangerous" permissions?
+		 *
+		 * This is a light-weight alternative to create(file, RDA_HAS_DPOVERLAY)
+		 * followed by RomData::hasDangerousPermissions(), intended for overlay
+		 * icon handlers. RomData subclasses that have a light-weight probe
+		 * only read the data needed to make the decision.
+		 *
+		 * Results are cached per file. The cache is keyed by filename,
+		 * and an entry is discarded if the file size or mtime changes.
+		 *
+		 * @param file ROM file.
+		 * @return True if the ROM file has "dangerous" permissions; false if not.
+		 */
+		static bool hasDangerousPermissions(LibRpFile::IRpFile *file);
+
 		struct ExtInfo {
 			const char *ext;
 			unsigned int attrs;
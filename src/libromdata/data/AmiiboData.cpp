@@ -19,6 +19,16 @@
 #  include "librpbase/TextFuncs_wchar.hpp"
 #endif /* _WIN32 */
 
+#ifdef HAVE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  ifndef O_CLOEXEC
+#    define O_CLOEXEC 0
+#  endif
+#endif /* HAVE_MMAP */
+
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
 using namespace LibRpFile;
@@ -61,6 +71,7 @@ namespace LibRomData {
 class AmiiboDataPrivate {
 	public:
 		AmiiboDataPrivate();
+		~AmiiboDataPrivate();
 
 	private:
 		RP_DISABLE_COPY(AmiiboDataPrivate)
@@ -74,7 +85,14 @@ class AmiiboDataPrivate {
 
 	public:
 		// amiibo.bin data
-		ao::uvector<uint8_t> amiibo_bin_data;
+		// If mmap() is available, this points to a read-only
+		// mapping of the file. Otherwise, it points to amiibo_bin_buf.
+		const uint8_t *amiibo_bin_data;
+		size_t amiibo_bin_size;
+#ifdef HAVE_MMAP
+		bool amiibo_bin_mmapped;
+#endif /* HAVE_MMAP */
+		ao::uvector<uint8_t> amiibo_bin_buf;	// Fallback buffer
 		time_t amiibo_bin_check_ts;	// Last check timestamp
 		time_t amiibo_bin_file_ts;	// File mtime
 
@@ -123,6 +141,20 @@ class AmiiboDataPrivate {
 		int loadIfNeeded(void);
 
 	private:
+		/**
+		 * Load the contents of amiibo-data.bin.
+		 * The file is mapped into memory if mmap() is available;
+		 * otherwise, it's read into amiibo_bin_buf.
+		 * @param filename amiibo-data.bin filename
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadFile(const string &filename);
+
+		/**
+		 * Unload the contents of amiibo-data.bin.
+		 */
+		void unloadFile(void);
+
 		/**
 		 * Clear the loaded data.
 		 */
@@ -135,29 +167,18 @@ class AmiiboDataPrivate {
 		 * @return String, or nullptr on error.
 		 */
 		inline const char *strTbl_lookup(uint32_t idx) const;
-
-		/**
-		 * CharTableEntry bsearch() comparison function.
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API CharTableEntry_compar(const void *a, const void *b);
-
-		/**
-		 * CharVariantTableEntry bsearch() comparison function.
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API CharVariantTableEntry_compar(const void *a, const void *b);
 };
 
 // amiibo-data.bin filename
 #define AMIIBO_BIN_FILENAME "amiibo-data.bin"
 
 AmiiboDataPrivate::AmiiboDataPrivate()
-	: amiibo_bin_check_ts(-1)
+	: amiibo_bin_data(nullptr)
+	, amiibo_bin_size(0)
+#ifdef HAVE_MMAP
+	, amiibo_bin_mmapped(false)
+#endif /* HAVE_MMAP */
+	, amiibo_bin_check_ts(-1)
 	, amiibo_bin_file_ts(-1)
 	, amiiboBinFileType(AmiiboBinFileType::None)
 	, pHeader(nullptr)
@@ -190,6 +211,11 @@ AmiiboDataPrivate::AmiiboDataPrivate()
 #endif /* _WIN32 */
 }
 
+AmiiboDataPrivate::~AmiiboDataPrivate()
+{
+	unloadFile();
+}
+
 /**
  * Get an amiibo-data.bin filename.
  * @param amiiboBinFileType AmiiboBinFileType
@@ -264,7 +290,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	string filename;
 
 	time_t now = time(nullptr);
-	if (!amiibo_bin_data.empty()) {
+	if (amiibo_bin_data) {
 		// amiibo data is already loaded.
 		if (now == amiibo_bin_check_ts) {
 			// Same time as last time. (seconds resolution)
@@ -329,50 +355,22 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	if (!ok) {
 		// Unable to find any valid amiibo-data.bin file.
 		// If data was already loaded before, keep using it.
-		return (amiibo_bin_data.empty() ? -ENOENT : 0);
+		return (amiibo_bin_data ? 0 : -ENOENT);
 	}
 
 	// Load amiibo.bin.
-	RpFile *const pFile = new RpFile(filename, RpFile::FM_OPEN_READ);
-	if (!pFile->isOpen()) {
-		// Unable to open the file.
-		int err = -pFile->lastError();
-		pFile->unref();
-		return err;
-	}
-
-	// Make sure the file is larger than sizeof(AmiiboBinHeader)
-	// and it's under 1 MB.
-	const int64_t filesize = pFile->size();
-	if (filesize < (int64_t)sizeof(AmiiboBinHeader) || filesize >= 1024*1024) {
-		// Over 1 MB.
-		pFile->unref();
-		return -ENOMEM;
-	}
-
-	// Clear all offsets before loading the data.
-	clear();
-
-	// Load the data.
-	amiibo_bin_data.resize(filesize);
-	size_t size = pFile->read(amiibo_bin_data.data(), filesize);
-	pFile->unref();
-	if (size != static_cast<size_t>(filesize)) {
-		// Read error.
-		int err = -pFile->lastError();
-		if (err == 0) {
-			err = -EIO;
-		}
-		amiibo_bin_data.clear();
-		return err;
+	int ret = loadFile(filename);
+	if (ret != 0) {
+		return ret;
 	}
+	const int64_t filesize = static_cast<int64_t>(amiibo_bin_size);
 
 	// Verify the header.
 	const AmiiboBinHeader *const pHeader_tmp =
 		reinterpret_cast<const AmiiboBinHeader*>(&amiibo_bin_data[0]);
 	if (memcmp(pHeader_tmp->magic, AMIIBO_BIN_MAGIC, sizeof(pHeader_tmp->magic)) != 0) {
 		// Invalid magic.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -383,7 +381,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)strtbl_offset + (uint64_t)strtbl_len) > static_cast<uint64_t>(filesize))
 	{
 		// String table offsets are invalid.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -392,7 +390,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    amiibo_bin_data[strtbl_offset + strtbl_len - 1] != 0)
 	{
 		// Missing NULLs.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -404,7 +402,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)cseries_offset + (uint64_t)cseries_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.21 character series table offsets are invalid.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -415,7 +413,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)char_offset + (uint64_t)char_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.21 character table offsets are invalid.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -426,7 +424,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)cvar_offset + (uint64_t)cvar_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.21 character variant table offsets are invalid.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -437,7 +435,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)aseries_offset + (uint64_t)aseries_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.22 amiibo series table offsets are invalid.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -448,7 +446,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)amiibo_offset + (uint64_t)amiibo_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.22 amiibo ID table offsets are invalid.
-		amiibo_bin_data.clear();
+		unloadFile();
 		return -EIO;
 	}
 
@@ -473,6 +471,121 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	return 0;
 }
 
+/**
+ * Load the contents of amiibo-data.bin.
+ * The file is mapped into memory if mmap() is available;
+ * otherwise, it's read into amiibo_bin_buf.
+ * @param filename amiibo-data.bin filename
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AmiiboDataPrivate::loadFile(const string &filename)
+{
+#ifdef HAVE_MMAP
+	int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		// Unable to open the file.
+		return -errno;
+	}
+
+	// Make sure the file is larger than sizeof(AmiiboBinHeader)
+	// and it's under 1 MB.
+	struct stat sbuf;
+	if (fstat(fd, &sbuf) != 0) {
+		int err = -errno;
+		close(fd);
+		return err;
+	}
+	const off_t filesize = sbuf.st_size;
+	if (!S_ISREG(sbuf.st_mode) ||
+	    filesize < (off_t)sizeof(AmiiboBinHeader) || filesize >= 1024*1024)
+	{
+		// Not a regular file, or over 1 MB.
+		close(fd);
+		return -ENOMEM;
+	}
+
+	// Clear all offsets before loading the data.
+	clear();
+	unloadFile();
+
+	// Map the file. The mapping remains valid after the fd is closed.
+	// NOTE: amiiboc and package managers replace amiibo-data.bin
+	// instead of rewriting it in place, so the mapped inode won't
+	// be truncated underneath us.
+	void *const pMap = mmap(nullptr, static_cast<size_t>(filesize),
+		PROT_READ, MAP_PRIVATE, fd, 0);
+	const int err = (pMap == MAP_FAILED ? -errno : 0);
+	close(fd);
+	if (pMap != MAP_FAILED) {
+		amiibo_bin_data = static_cast<const uint8_t*>(pMap);
+		amiibo_bin_size = static_cast<size_t>(filesize);
+		amiibo_bin_mmapped = true;
+		return 0;
+	} else if (err != -ENODEV) {
+		return err;
+	}
+
+	// mmap() isn't supported on this file system.
+	// Fall back to reading the file.
+#endif /* HAVE_MMAP */
+
+	RpFile *const pFile = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!pFile->isOpen()) {
+		// Unable to open the file.
+		int err = -pFile->lastError();
+		pFile->unref();
+		return err;
+	}
+
+	// Make sure the file is larger than sizeof(AmiiboBinHeader)
+	// and it's under 1 MB.
+	const int64_t rp_filesize = pFile->size();
+	if (rp_filesize < (int64_t)sizeof(AmiiboBinHeader) || rp_filesize >= 1024*1024) {
+		// Over 1 MB.
+		pFile->unref();
+		return -ENOMEM;
+	}
+
+	// Clear all offsets before loading the data.
+	clear();
+	unloadFile();
+
+	// Load the data.
+	amiibo_bin_buf.resize(rp_filesize);
+	size_t size = pFile->read(amiibo_bin_buf.data(), rp_filesize);
+	if (size != static_cast<size_t>(rp_filesize)) {
+		// Read error.
+		int err = -pFile->lastError();
+		pFile->unref();
+		if (err == 0) {
+			err = -EIO;
+		}
+		amiibo_bin_buf.clear();
+		return err;
+	}
+	pFile->unref();
+
+	amiibo_bin_data = amiibo_bin_buf.data();
+	amiibo_bin_size = amiibo_bin_buf.size();
+	return 0;
+}
+
+/**
+ * Unload the contents of amiibo-data.bin.
+ */
+void AmiiboDataPrivate::unloadFile(void)
+{
+#ifdef HAVE_MMAP
+	if (amiibo_bin_mmapped) {
+		munmap(const_cast<uint8_t*>(amiibo_bin_data), amiibo_bin_size);
+		amiibo_bin_mmapped = false;
+	}
+#endif /* HAVE_MMAP */
+	amiibo_bin_buf.clear();
+	amiibo_bin_data = nullptr;
+	amiibo_bin_size = 0;
+}
+
 /**
  * Clear the loaded data.
  */
@@ -511,55 +624,6 @@ inline const char *AmiiboDataPrivate::strTbl_lookup(uint32_t idx) const
 	return &pStrTbl[idx];
 }
 
-/**
- * CharTableEntry bsearch() comparison function.
- * @param a
- * @param b
- * @return
- */
-int RP_C_API AmiiboDataPrivate::CharTableEntry_compar(const void *a, const void *b)
-{
-	uint32_t id1 = le32_to_cpu(static_cast<const CharTableEntry*>(a)->char_id);
-	uint32_t id2 = le32_to_cpu(static_cast<const CharTableEntry*>(b)->char_id);
-
-	// NOTE: Masking off the character variant flag.
-	id1 &= ~CHARTABLE_VARIANT_FLAG;
-	id2 &= ~CHARTABLE_VARIANT_FLAG;
-
-	if (id1 < id2) return -1;
-	else if (id1 > id2) return 1;
-	else return 0;
-}
-
-/**
- * CharVariantTableEntry bsearch() comparison function.
- * @param a
- * @param b
- * @return
- */
-int RP_C_API AmiiboDataPrivate::CharVariantTableEntry_compar(const void *a, const void *b)
-{
-	const CharVariantTableEntry *pA = static_cast<const CharVariantTableEntry*>(a);
-	const CharVariantTableEntry *pB = static_cast<const CharVariantTableEntry*>(b);
-
-	if (pA->char_id == pB->char_id) {
-		// Same character ID. Compare the variant ID.
-		const uint8_t varA = pA->var_id;
-		const uint8_t varB = pB->var_id;
-		if (varA < varB) return -1;
-		else if (varA > varB) return 1;
-		else return 0;
-	}
-
-	// Character ID doesn't match.
-	const uint16_t idA = le16_to_cpu(pA->char_id);
-	const uint16_t idB = le16_to_cpu(pB->char_id);
-
-	if (idA < idB) return -1;
-	else if (idA > idB) return 1;
-	else return 0;
-}
-
 /** AmiiboData **/
 
 // Singleton instance.
@@ -630,14 +694,15 @@ const char *AmiiboData::lookup_char_name(uint32_t char_id) const
 	const uint16_t id = (char_id >> 16) & 0xFFFF;
 
 	// Do a binary search.
-	const CharTableEntry key = {id, 0};
-	const CharTableEntry *const cres =
-		static_cast<const CharTableEntry*>(bsearch(&key,
-			d->pCharTbl,
-			d->charTbl_count,
-			sizeof(CharTableEntry),
-			AmiiboDataPrivate::CharTableEntry_compar));
-	if (!cres) {
+	// NOTE: Masking off the character variant flag.
+	const CharTableEntry *const pCharTbl_end = d->pCharTbl + d->charTbl_count;
+	const CharTableEntry *const cres = std::lower_bound(d->pCharTbl, pCharTbl_end, id,
+		[](const CharTableEntry &entry, uint16_t id) {
+			return ((le32_to_cpu(entry.char_id) & ~CHARTABLE_VARIANT_FLAG) < id);
+		});
+	if (cres == pCharTbl_end ||
+	    (le32_to_cpu(cres->char_id) & ~CHARTABLE_VARIANT_FLAG) != id)
+	{
 		// Character ID not found.
 		return nullptr;
 	}
@@ -647,13 +712,18 @@ const char *AmiiboData::lookup_char_name(uint32_t char_id) const
 	if (le32_to_cpu(cres->char_id) & CHARTABLE_VARIANT_FLAG) {
 		// Do a binary search in the character variant table.
 		const uint8_t variant_id = (char_id >> 8) & 0xFF;
-		const CharVariantTableEntry key = {id, variant_id, 0, 0};
-		const CharVariantTableEntry *const vres =
-			static_cast<const CharVariantTableEntry*>(bsearch(&key,
-				d->pCharVarTbl,
-				d->charVarTbl_count,
-				sizeof(CharVariantTableEntry),
-				AmiiboDataPrivate::CharVariantTableEntry_compar));
+		const uint32_t var_key = (static_cast<uint32_t>(id) << 8) | variant_id;
+		const CharVariantTableEntry *const pCharVarTbl_end = d->pCharVarTbl + d->charVarTbl_count;
+		const CharVariantTableEntry *vres = std::lower_bound(d->pCharVarTbl, pCharVarTbl_end, var_key,
+			[](const CharVariantTableEntry &entry, uint32_t var_key) {
+				return (((static_cast<uint32_t>(le16_to_cpu(entry.char_id)) << 8) | entry.var_id) < var_key);
+			});
+		if (vres == pCharVarTbl_end ||
+		    le16_to_cpu(vres->char_id) != id || vres->var_id != variant_id)
+		{
+			// Character variant ID not found.
+			vres = nullptr;
+		}
 
 		if (vres) {
 			// Character variant ID found.
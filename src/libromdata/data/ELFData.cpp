@@ -30,14 +30,6 @@ class ELFDataPrivate {
 
 		// OS ABIs
 		static const char *const osabi_names[];
-
-		/**
-		 * bsearch() comparison function for MachineType.
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API MachineType_compar(const void *a, const void *b);
 };
 
 // ELF machine types. (contiguous low IDs)
@@ -363,21 +355,6 @@ const char *const ELFDataPrivate::osabi_names[] = {
 	nullptr
 };
 
-/**
- * bsearch() comparison function for MachineType.
- * @param a
- * @param b
- * @return
- */
-int RP_C_API ELFDataPrivate::MachineType_compar(const void *a, const void *b)
-{
-	const uint16_t cpu1 = static_cast<const MachineType*>(a)->cpu;
-	const uint16_t cpu2 = static_cast<const MachineType*>(b)->cpu;
-	if (cpu1 < cpu2) return -1;
-	if (cpu1 > cpu2) return 1;
-	return 0;
-}
-
 /**
  * Look up an ELF machine type. (CPU)
  * @param cpu ELF machine type.
@@ -394,14 +371,16 @@ const char *ELFData::lookup_cpu(uint16_t cpu)
 
 	// CPU ID is in the "other" IDs array.
 	// Do a binary search.
-	const ELFDataPrivate::MachineType key = {cpu, nullptr};
-	const ELFDataPrivate::MachineType *res =
-		static_cast<const ELFDataPrivate::MachineType*>(bsearch(&key,
-			ELFDataPrivate::machineTypes_other,
-			ARRAY_SIZE(ELFDataPrivate::machineTypes_other)-1,
-			sizeof(ELFDataPrivate::MachineType),
-			ELFDataPrivate::MachineType_compar));
-	return (res ? res->name : nullptr);
+	static const ELFDataPrivate::MachineType *const pMachineTypes_other_end =
+		&ELFDataPrivate::machineTypes_other[ARRAY_SIZE(ELFDataPrivate::machineTypes_other)-1];
+	auto pMachineType = std::lower_bound(ELFDataPrivate::machineTypes_other, pMachineTypes_other_end, cpu,
+		[](const ELFDataPrivate::MachineType &machineType, uint16_t cpu) {
+			return (machineType.cpu < cpu);
+		});
+	if (pMachineType == pMachineTypes_other_end || pMachineType->cpu != cpu) {
+		return nullptr;
+	}
+	return pMachineType->name;
 }
 
 /**
@@ -28,12 +28,13 @@ class EXEDataPrivate {
 		static const MachineType machineTypes_LE[];
 
 		/**
-		 * bsearch() comparison function for MachineType.
-		 * @param a
-		 * @param b
-		 * @return
+		 * Look up a machine type in a sorted MachineType array.
+		 * @param pTbl	[in] MachineType array
+		 * @param count	[in] Number of entries in pTbl, not including the NULL terminator.
+		 * @param cpu	[in] CPU ID
+		 * @return Machine type name, or nullptr if not found.
 		 */
-		static int RP_C_API MachineType_compar(const void *a, const void *b);
+		static const char *lookup_cpu(const MachineType *pTbl, size_t count, uint16_t cpu);
 };
 
 // PE machine types.
@@ -96,20 +97,28 @@ const EXEDataPrivate::MachineType EXEDataPrivate::machineTypes_LE[] = {
 };
 
 /**
- * bsearch() comparison function for MachineType.
- * @param a
- * @param b
- * @return
+ * Look up a machine type in a sorted MachineType array.
+ * @param pTbl	[in] MachineType array
+ * @param count	[in] Number of entries in pTbl, not including the NULL terminator.
+ * @param cpu	[in] CPU ID
+ * @return Machine type name, or nullptr if not found.
  */
-int RP_C_API EXEDataPrivate::MachineType_compar(const void *a, const void *b)
+const char *EXEDataPrivate::lookup_cpu(const MachineType *pTbl, size_t count, uint16_t cpu)
 {
-	const uint16_t cpu1 = static_cast<const MachineType*>(a)->cpu;
-	const uint16_t cpu2 = static_cast<const MachineType*>(b)->cpu;
-	if (cpu1 < cpu2) return -1;
-	if (cpu1 > cpu2) return 1;
-	return 0;
+	// Do a binary search.
+	const MachineType *const pTbl_end = pTbl + count;
+	auto pMachineType = std::lower_bound(pTbl, pTbl_end, cpu,
+		[](const MachineType &machineType, uint16_t cpu) {
+			return (machineType.cpu < cpu);
+		});
+	if (pMachineType == pTbl_end || pMachineType->cpu != cpu) {
+		return nullptr;
+	}
+	return pMachineType->name;
 }
 
+/** EXEData **/
+
 /**
  * Look up a PE machine type. (CPU)
  * @param cpu PE machine type.
@@ -117,15 +126,8 @@ int RP_C_API EXEDataPrivate::MachineType_compar(const void *a, const void *b)
  */
 const char *EXEData::lookup_pe_cpu(uint16_t cpu)
 {
-	// Do a binary search.
-	const EXEDataPrivate::MachineType key = {cpu, nullptr};
-	const EXEDataPrivate::MachineType *res =
-		static_cast<const EXEDataPrivate::MachineType*>(bsearch(&key,
-			EXEDataPrivate::machineTypes_PE,
-			ARRAY_SIZE(EXEDataPrivate::machineTypes_PE)-1,
-			sizeof(EXEDataPrivate::MachineType),
-			EXEDataPrivate::MachineType_compar));
-	return (res ? res->name : nullptr);
+	return EXEDataPrivate::lookup_cpu(EXEDataPrivate::machineTypes_PE,
+		ARRAY_SIZE(EXEDataPrivate::machineTypes_PE)-1, cpu);
 }
 
 /**
@@ -135,15 +137,8 @@ const char *EXEData::lookup_pe_cpu(uint16_t cpu)
  */
 const char *EXEData::lookup_le_cpu(uint16_t cpu)
 {
-	// Do a binary search.
-	const EXEDataPrivate::MachineType key = {cpu, nullptr};
-	const EXEDataPrivate::MachineType *res =
-		static_cast<const EXEDataPrivate::MachineType*>(bsearch(&key,
-			EXEDataPrivate::machineTypes_LE,
-			ARRAY_SIZE(EXEDataPrivate::machineTypes_LE)-1,
-			sizeof(EXEDataPrivate::MachineType),
-			EXEDataPrivate::MachineType_compar));
-	return (res ? res->name : nullptr);
+	return EXEDataPrivate::lookup_cpu(EXEDataPrivate::machineTypes_LE,
+		ARRAY_SIZE(EXEDataPrivate::machineTypes_LE)-1, cpu);
 }
 
 }
@@ -92,22 +92,6 @@ class NESMappersPrivate
 			const SubmapperInfo *info;	// Submapper information.
 		};
 		static const SubmapperEntry submappers[];
-
-		/**
-		 * bsearch() comparison function for SubmapperInfo.
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API SubmapperInfo_compar(const void *a, const void *b);
-
-		/**
-		 * bsearch() comparison function for SubmapperEntry.
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API SubmapperEntry_compar(const void *a, const void *b);
 };
 
 /**
@@ -858,36 +842,6 @@ const NESMappersPrivate::SubmapperEntry NESMappersPrivate::submappers[] = {
 	{0, 0, nullptr}
 };
 
-/**
- * bsearch() comparison function for SubmapperInfo.
- * @param a
- * @param b
- * @return
- */
-int RP_C_API NESMappersPrivate::SubmapperInfo_compar(const void *a, const void *b)
-{
-	uint8_t submapper1 = static_cast<const SubmapperInfo*>(a)->submapper;
-	uint8_t submapper2 = static_cast<const SubmapperInfo*>(b)->submapper;
-	if (submapper1 < submapper2) return -1;
-	if (submapper1 > submapper2) return 1;
-	return 0;
-}
-
-/**
- * bsearch() comparison function for SubmapperEntry.
- * @param a
- * @param b
- * @return
- */
-int RP_C_API NESMappersPrivate::SubmapperEntry_compar(const void *a, const void *b)
-{
-	uint16_t mapper1 = static_cast<const SubmapperEntry*>(a)->mapper;
-	uint16_t mapper2 = static_cast<const SubmapperEntry*>(b)->mapper;
-	if (mapper1 < mapper2) return -1;
-	if (mapper1 > mapper2) return 1;
-	return 0;
-}
-
 /** NESMappers **/
 
 /**
@@ -1033,25 +987,29 @@ const char *NESMappers::lookup_nes2_submapper(int mapper, int submapper)
 	}
 
 	// Do a binary search in submappers[].
-	const NESMappersPrivate::SubmapperEntry key = { static_cast<uint16_t>(mapper), 0, nullptr };
-	const NESMappersPrivate::SubmapperEntry *res =
-		static_cast<const NESMappersPrivate::SubmapperEntry*>(bsearch(&key,
-			NESMappersPrivate::submappers,
-			ARRAY_SIZE(NESMappersPrivate::submappers)-1,
-			sizeof(NESMappersPrivate::SubmapperEntry),
-			NESMappersPrivate::SubmapperEntry_compar));
-	if (!res || !res->info || res->info_size == 0)
+	static const NESMappersPrivate::SubmapperEntry *const pSubmappers_end =
+		&NESMappersPrivate::submappers[ARRAY_SIZE(NESMappersPrivate::submappers)-1];
+	auto pSme = std::lower_bound(NESMappersPrivate::submappers, pSubmappers_end, mapper,
+		[](const NESMappersPrivate::SubmapperEntry &sme, int mapper) {
+			return (sme.mapper < mapper);
+		});
+	if (pSme == pSubmappers_end || pSme->mapper != mapper ||
+	    !pSme->info || pSme->info_size == 0)
+	{
 		return nullptr;
+	}
 
-	// Do a binary search in res->info.
-	const NESMappersPrivate::SubmapperInfo key2 = { static_cast<uint8_t>(submapper), 0, 0, nullptr };
-	const NESMappersPrivate::SubmapperInfo *res2 =
-		static_cast<const NESMappersPrivate::SubmapperInfo*>(bsearch(&key2,
-			res->info, res->info_size,
-			sizeof(NESMappersPrivate::SubmapperInfo),
-			NESMappersPrivate::SubmapperInfo_compar));
+	// Do a binary search in pSme->info.
+	const NESMappersPrivate::SubmapperInfo *const pInfo_end = pSme->info + pSme->info_size;
+	auto pSubmapper = std::lower_bound(pSme->info, pInfo_end, submapper,
+		[](const NESMappersPrivate::SubmapperInfo &sm, int submapper) {
+			return (sm.submapper < submapper);
+		});
+	if (pSubmapper == pInfo_end || pSubmapper->submapper != submapper) {
+		return nullptr;
+	}
 	// TODO: Return the "deprecated" value?
-	return (res2 ? res2->desc : nullptr);
+	return pSubmapper->desc;
 }
 
 }
@@ -21,24 +21,16 @@ class Nintendo3DSFirmDataPrivate {
 	public:
 		/**
 		 * Firmware binary version information.
-		 * NOTE: Sorted by CRC32 for bsearch().
+		 * NOTE: Sorted by CRC32 for binary search.
 		 */
 		static const Nintendo3DSFirmData::FirmBin_t firmBins[];
-
-		/**
-		 * Comparison function for bsearch().
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar(const void *a, const void *b);
 };
 
 /** Nintendo3DSFirmDataPrivate **/
 
 /**
  * Firmware binary version information.
- * NOTE: Sorted by CRC32 for bsearch().
+ * NOTE: Sorted by CRC32 for binary search.
  */
 const Nintendo3DSFirmData::FirmBin_t Nintendo3DSFirmDataPrivate::firmBins[] = {
 	{0x0FD41774, {2,27, 0}, { 1,0}, false},
@@ -89,21 +81,6 @@ const Nintendo3DSFirmData::FirmBin_t Nintendo3DSFirmDataPrivate::firmBins[] = {
 	{0, {0,0,0}, {0,0}, false}
 };
 
-/**
- * Comparison function for bsearch().
- * @param a
- * @param b
- * @return
- */
-int RP_C_API Nintendo3DSFirmDataPrivate::compar(const void *a, const void *b)
-{
-	uint32_t crc_1 = static_cast<const Nintendo3DSFirmData::FirmBin_t*>(a)->crc;
-	uint32_t crc_2 = static_cast<const Nintendo3DSFirmData::FirmBin_t*>(b)->crc;
-	if (crc_1 < crc_2) return -1;
-	if (crc_1 > crc_2) return 1;
-	return 0;
-}
-
 /** Nintendo3DSFirmData **/
 
 /**
@@ -114,12 +91,16 @@ int RP_C_API Nintendo3DSFirmDataPrivate::compar(const void *a, const void *b)
 const Nintendo3DSFirmData::FirmBin_t *Nintendo3DSFirmData::lookup_firmBin(const uint32_t crc)
 {
 	// Do a binary search.
-	const FirmBin_t key = {crc, {0,0,0}, {0,0}, false};
-	return static_cast<const FirmBin_t*>(bsearch(&key,
-			Nintendo3DSFirmDataPrivate::firmBins,
-			ARRAY_SIZE(Nintendo3DSFirmDataPrivate::firmBins)-1,
-			sizeof(FirmBin_t),
-			Nintendo3DSFirmDataPrivate::compar));
+	static const FirmBin_t *const pFirmBins_end =
+		&Nintendo3DSFirmDataPrivate::firmBins[ARRAY_SIZE(Nintendo3DSFirmDataPrivate::firmBins)-1];
+	auto pFirmBin = std::lower_bound(Nintendo3DSFirmDataPrivate::firmBins, pFirmBins_end, crc,
+		[](const FirmBin_t &firmBin, uint32_t crc) {
+			return (firmBin.crc < crc);
+		});
+	if (pFirmBin == pFirmBins_end || pFirmBin->crc != crc) {
+		return nullptr;
+	}
+	return pFirmBin;
 }
 
 }
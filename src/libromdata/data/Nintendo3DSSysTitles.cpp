@@ -9,6 +9,12 @@
 #include "stdafx.h"
 #include "Nintendo3DSSysTitles.hpp"
 
+// One-time initialization.
+#include "librpthreads/pthread_once.h"
+
+// C++ STL classes.
+using std::vector;
+
 namespace LibRomData {
 
 class Nintendo3DSSysTitlesPrivate
@@ -41,6 +47,43 @@ class Nintendo3DSSysTitlesPrivate
 		static const SysTitle sys_title_00040030[];	// System applets.
 
 		//static const SysTitleGroup sys_title_group[];	// All SysTitle[] arrays.
+
+	public:
+		/**
+		 * Title ID index entry.
+		 * Each SysTitle has up to 6 tid_lo values, so the SysTitle
+		 * arrays can't be binary-searched directly.
+		 */
+		struct SysTitleIndexEntry {
+			uint32_t tid_lo;	// Title ID Low
+			uint8_t title;		// Index into the SysTitle array
+			uint8_t region;		// Region index
+		};
+
+		// Title ID indexes, sorted by tid_lo.
+		// Must be initialized using initSysTitleIndexes().
+		static vector<SysTitleIndexEntry> idx_00040010;
+		static vector<SysTitleIndexEntry> idx_00040030;
+
+		// pthread_once() control variable.
+		static pthread_once_t once_control;
+
+	private:
+		/**
+		 * Build a title ID index for a SysTitle array.
+		 * @param idx		[out] Title ID index
+		 * @param titles	[in] SysTitle array
+		 * @param title_count	[in] Number of entries in titles
+		 */
+		static void buildSysTitleIndex(vector<SysTitleIndexEntry> &idx,
+			const SysTitle *titles, unsigned int title_count);
+
+	public:
+		/**
+		 * Initialize the title ID indexes.
+		 * This function MUST be called using pthread_once().
+		 */
+		static void initSysTitleIndexes(void);
 };
 
 /** Nintendo3DSSysTitlesPrivate **/
@@ -106,6 +149,56 @@ const Nintendo3DSSysTitlesPrivate::SysTitle Nintendo3DSSysTitlesPrivate::sys_tit
 	{{0x2000C003, 0x2000C803, 0x2000D003,          0, 0x2000DE03,          0}, NOP_C_("Nintendo3DSSysTitles", "Software Keyboard (SAFE_MODE)")},
 };
 
+// Title ID indexes.
+vector<Nintendo3DSSysTitlesPrivate::SysTitleIndexEntry> Nintendo3DSSysTitlesPrivate::idx_00040010;
+vector<Nintendo3DSSysTitlesPrivate::SysTitleIndexEntry> Nintendo3DSSysTitlesPrivate::idx_00040030;
+
+// pthread_once() control variable.
+pthread_once_t Nintendo3DSSysTitlesPrivate::once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Build a title ID index for a SysTitle array.
+ * @param idx		[out] Title ID index
+ * @param titles	[in] SysTitle array
+ * @param title_count	[in] Number of entries in titles
+ */
+void Nintendo3DSSysTitlesPrivate::buildSysTitleIndex(vector<SysTitleIndexEntry> &idx,
+	const SysTitle *titles, unsigned int title_count)
+{
+	assert(title_count <= 256);
+	idx.clear();
+	idx.reserve(title_count * ARRAY_SIZE(regions));
+	for (unsigned int title = 0; title < title_count; title++) {
+		for (unsigned int region = 0; region < ARRAY_SIZE(regions); region++) {
+			const uint32_t tid_lo = titles[title].tid_lo[region];
+			if (tid_lo != 0) {
+				const SysTitleIndexEntry entry = {tid_lo,
+					static_cast<uint8_t>(title), static_cast<uint8_t>(region)};
+				idx.push_back(entry);
+			}
+		}
+	}
+
+	// Sort by tid_lo. If the same tid_lo is listed more than once,
+	// the first entry in table order takes precedence.
+	std::sort(idx.begin(), idx.end(),
+		[](const SysTitleIndexEntry &a, const SysTitleIndexEntry &b) {
+			if (a.tid_lo != b.tid_lo) return (a.tid_lo < b.tid_lo);
+			if (a.title != b.title) return (a.title < b.title);
+			return (a.region < b.region);
+		});
+}
+
+/**
+ * Initialize the title ID indexes.
+ * This function MUST be called using pthread_once().
+ */
+void Nintendo3DSSysTitlesPrivate::initSysTitleIndexes(void)
+{
+	buildSysTitleIndex(idx_00040010, sys_title_00040010, ARRAY_SIZE(sys_title_00040010));
+	buildSysTitleIndex(idx_00040030, sys_title_00040030, ARRAY_SIZE(sys_title_00040030));
+}
+
 /** Nintendo3DSSysTitles **/
 
 /**
@@ -118,7 +211,7 @@ const Nintendo3DSSysTitlesPrivate::SysTitle Nintendo3DSSysTitlesPrivate::sys_tit
 const char *Nintendo3DSSysTitles::lookup_sys_title(uint32_t tid_hi, uint32_t tid_lo, const char **pRegion)
 {
 	const Nintendo3DSSysTitlesPrivate::SysTitle *titles;
-	int title_count;
+	const vector<Nintendo3DSSysTitlesPrivate::SysTitleIndexEntry> *pIdx;
 
 	if (tid_hi == 0 || tid_lo == 0 ||
 	    tid_hi == 0xFFFFFFFF || tid_lo == 0xFFFFFFFF)
@@ -132,10 +225,10 @@ const char *Nintendo3DSSysTitles::lookup_sys_title(uint32_t tid_hi, uint32_t tid
 
 	if (tid_hi == 0x00040010) {
 		titles = Nintendo3DSSysTitlesPrivate::sys_title_00040010;
-		title_count = ARRAY_SIZE(Nintendo3DSSysTitlesPrivate::sys_title_00040010);
+		pIdx = &Nintendo3DSSysTitlesPrivate::idx_00040010;
 	} else if (tid_hi == 0x00040030) {
 		titles = Nintendo3DSSysTitlesPrivate::sys_title_00040030;
-		title_count = ARRAY_SIZE(Nintendo3DSSysTitlesPrivate::sys_title_00040030);
+		pIdx = &Nintendo3DSSysTitlesPrivate::idx_00040030;
 	} else {
 		// tid_hi not supported.
 		if (pRegion) {
@@ -144,17 +237,21 @@ const char *Nintendo3DSSysTitles::lookup_sys_title(uint32_t tid_hi, uint32_t tid
 		return nullptr;
 	}
 
-	// TODO: bsearch()?
-	for (; title_count > 0; title_count--, titles++) {
-		for (unsigned int region = 0; region < 6; region++) {
-			if (titles->tid_lo[region] != 0 && titles->tid_lo[region] == tid_lo) {
-				// Found a match!
-				if (pRegion) {
-					*pRegion = Nintendo3DSSysTitlesPrivate::regions[region];
-				}
-				return dpgettext_expr(RP_I18N_DOMAIN, "Nintendo3DSSysTitles", titles->desc);
-			}
+	// Make sure the title ID indexes are initialized.
+	pthread_once(&Nintendo3DSSysTitlesPrivate::once_control,
+		Nintendo3DSSysTitlesPrivate::initSysTitleIndexes);
+
+	// Do a binary search.
+	auto pEntry = std::lower_bound(pIdx->cbegin(), pIdx->cend(), tid_lo,
+		[](const Nintendo3DSSysTitlesPrivate::SysTitleIndexEntry &entry, uint32_t tid_lo) {
+			return (entry.tid_lo < tid_lo);
+		});
+	if (pEntry != pIdx->cend() && pEntry->tid_lo == tid_lo) {
+		// Found a match!
+		if (pRegion) {
+			*pRegion = Nintendo3DSSysTitlesPrivate::regions[pEntry->region];
 		}
+		return dpgettext_expr(RP_I18N_DOMAIN, "Nintendo3DSSysTitles", titles[pEntry->title].desc);
 	}
 
 	// Not found.
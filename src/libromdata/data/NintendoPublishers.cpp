@@ -34,16 +34,6 @@ class NintendoPublishersPrivate {
 		 */
 		static const ThirdPartyEntry thirdPartyList[];
 
-		/**
-		 * Comparison function for bsearch().
-		 * For use with ThirdPartyEntry.
-		 *
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar(const void *a, const void *b);
-
 	public:
 		struct ThirdPartyEntry_fds {
 			uint8_t code;			// Old publisher code
@@ -59,16 +49,6 @@ class NintendoPublishersPrivate {
 		 * - https://wiki.nesdev.com/w/index.php/Family_Computer_Disk_System#Manufacturer_codes
 		 */
 		static const ThirdPartyEntry_fds thirdPartyList_fds[];
-
-		/**
-		 * Comparison function for bsearch().
-		 * For use with ThirdPartyEntry_fds.
-		 *
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar_fds(const void *a, const void *b);
 };
 
 /**
@@ -493,23 +473,6 @@ const NintendoPublishersPrivate::ThirdPartyEntry NintendoPublishersPrivate::thir
 	{0, nullptr}
 };
 
-/**
- * Comparison function for bsearch().
- * For use with ThirdPartyEntry.
- *
- * @param a
- * @param b
- * @return
- */
-int RP_C_API NintendoPublishersPrivate::compar(const void *a, const void *b)
-{
-	uint16_t code1 = static_cast<const ThirdPartyEntry*>(a)->code;
-	uint16_t code2 = static_cast<const ThirdPartyEntry*>(b)->code;
-	if (code1 < code2) return -1;
-	if (code1 > code2) return 1;
-	return 0;
-}
-
 /**
  * Nintendo third-party publisher list.
  * This list is valid for Famicom Disk System only.
@@ -563,23 +526,6 @@ const NintendoPublishersPrivate::ThirdPartyEntry_fds NintendoPublishersPrivate::
 	{0, nullptr, nullptr}
 };
 
-/**
- * Comparison function for bsearch().
- * For use with ThirdPartyEntry.
- *
- * @param a
- * @param b
- * @return
- */
-int RP_C_API NintendoPublishersPrivate::compar_fds(const void *a, const void *b)
-{
-	uint8_t code1 = static_cast<const ThirdPartyEntry_fds*>(a)->code;
-	uint8_t code2 = static_cast<const ThirdPartyEntry_fds*>(b)->code;
-	if (code1 < code2) return -1;
-	if (code1 > code2) return 1;
-	return 0;
-}
-
 /** Public functions **/
 
 /**
@@ -590,14 +536,16 @@ int RP_C_API NintendoPublishersPrivate::compar_fds(const void *a, const void *b)
 const char *NintendoPublishers::lookup(uint16_t code)
 {
 	// Do a binary search.
-	const NintendoPublishersPrivate::ThirdPartyEntry key = {code, nullptr};
-	const NintendoPublishersPrivate::ThirdPartyEntry *res =
-		static_cast<const NintendoPublishersPrivate::ThirdPartyEntry*>(bsearch(&key,
-			NintendoPublishersPrivate::thirdPartyList,
-			ARRAY_SIZE(NintendoPublishersPrivate::thirdPartyList)-1,
-			sizeof(NintendoPublishersPrivate::ThirdPartyEntry),
-			NintendoPublishersPrivate::compar));
-	return (res ? res->publisher : nullptr);
+	static const NintendoPublishersPrivate::ThirdPartyEntry *const pThirdPartyList_end =
+		&NintendoPublishersPrivate::thirdPartyList[ARRAY_SIZE(NintendoPublishersPrivate::thirdPartyList)-1];
+	auto pPublisher = std::lower_bound(NintendoPublishersPrivate::thirdPartyList, pThirdPartyList_end, code,
+		[](const NintendoPublishersPrivate::ThirdPartyEntry &publisher, uint16_t code) {
+			return (publisher.code < code);
+		});
+	if (pPublisher == pThirdPartyList_end || pPublisher->code != code) {
+		return nullptr;
+	}
+	return pPublisher->publisher;
 }
 
 /**
@@ -640,14 +588,16 @@ const char *NintendoPublishers::lookup_fds(uint8_t code)
 {
 	// Do a binary search.
 	// TODO: Option to return the Japanese publisher.
-	const NintendoPublishersPrivate::ThirdPartyEntry_fds key = {code, nullptr, nullptr};
-	const NintendoPublishersPrivate::ThirdPartyEntry_fds *res =
-		static_cast<const NintendoPublishersPrivate::ThirdPartyEntry_fds*>(bsearch(&key,
-			NintendoPublishersPrivate::thirdPartyList_fds,
-			ARRAY_SIZE(NintendoPublishersPrivate::thirdPartyList_fds)-1,
-			sizeof(NintendoPublishersPrivate::ThirdPartyEntry_fds),
-			NintendoPublishersPrivate::compar_fds));
-	return (res ? res->publisher_en : nullptr);
+	static const NintendoPublishersPrivate::ThirdPartyEntry_fds *const pThirdPartyList_fds_end =
+		&NintendoPublishersPrivate::thirdPartyList_fds[ARRAY_SIZE(NintendoPublishersPrivate::thirdPartyList_fds)-1];
+	auto pPublisher = std::lower_bound(NintendoPublishersPrivate::thirdPartyList_fds, pThirdPartyList_fds_end, code,
+		[](const NintendoPublishersPrivate::ThirdPartyEntry_fds &publisher, uint8_t code) {
+			return (publisher.code < code);
+		});
+	if (pPublisher == pThirdPartyList_fds_end || pPublisher->code != code) {
+		return nullptr;
+	}
+	return pPublisher->publisher_en;
 }
 
 }
@@ -29,14 +29,6 @@ class SegaPublishersPrivate {
 		};
 		static const TCodeEntry tcodeList[];
 
-		/**
-		 * Comparison function for bsearch().
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar(const void *a, const void *b);
-
 };
 
 /**
@@ -395,21 +387,6 @@ const SegaPublishersPrivate::TCodeEntry SegaPublishersPrivate::tcodeList[] = {
 	{0, nullptr}
 };
 
-/**
- * Comparison function for bsearch().
- * @param a
- * @param b
- * @return
- */
-int RP_C_API SegaPublishersPrivate::compar(const void *a, const void *b)
-{
-	unsigned int code1 = static_cast<const TCodeEntry*>(a)->t_code;
-	unsigned int code2 = static_cast<const TCodeEntry*>(b)->t_code;
-	if (code1 < code2) return -1;
-	if (code1 > code2) return 1;
-	return 0;
-}
-
 /**
  * Look up a company code.
  * @param code Company code.
@@ -418,14 +395,16 @@ int RP_C_API SegaPublishersPrivate::compar(const void *a, const void *b)
 const char *SegaPublishers::lookup(unsigned int code)
 {
 	// Do a binary search.
-	const SegaPublishersPrivate::TCodeEntry key = {code, nullptr};
-	const SegaPublishersPrivate::TCodeEntry *res =
-		static_cast<const SegaPublishersPrivate::TCodeEntry*>(bsearch(&key,
-			SegaPublishersPrivate::tcodeList,
-			ARRAY_SIZE(SegaPublishersPrivate::tcodeList)-1,
-			sizeof(SegaPublishersPrivate::TCodeEntry),
-			SegaPublishersPrivate::compar));
-	return (res ? res->publisher : nullptr);
+	static const SegaPublishersPrivate::TCodeEntry *const pTcodeList_end =
+		&SegaPublishersPrivate::tcodeList[ARRAY_SIZE(SegaPublishersPrivate::tcodeList)-1];
+	auto pPublisher = std::lower_bound(SegaPublishersPrivate::tcodeList, pTcodeList_end, code,
+		[](const SegaPublishersPrivate::TCodeEntry &publisher, unsigned int code) {
+			return (publisher.t_code < code);
+		});
+	if (pPublisher == pTcodeList_end || pPublisher->t_code != code) {
+		return nullptr;
+	}
+	return pPublisher->publisher;
 }
 
 }
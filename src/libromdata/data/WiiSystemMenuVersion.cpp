@@ -31,15 +31,6 @@ class WiiSystemMenuVersionPrivate {
 			char str[6];
 		};
 		static const SysVersionEntry_t sysVersionList[];
-
-	public:
-		/**
-		 * Comparison function for bsearch().
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar(const void *a, const void *b);
 };
 
 /** WiiSystemMenuVersionPrivate **/
@@ -82,21 +73,6 @@ const WiiSystemMenuVersionPrivate::SysVersionEntry_t WiiSystemMenuVersionPrivate
 	{0, ""}
 };
 
-/**
- * Comparison function for bsearch().
- * @param a
- * @param b
- * @return
- */
-int RP_C_API WiiSystemMenuVersionPrivate::compar(const void *a, const void *b)
-{
-	unsigned int v1 = static_cast<const SysVersionEntry_t*>(a)->version;
-	unsigned int v2 = static_cast<const SysVersionEntry_t*>(b)->version;
-	if (v1 < v2) return -1;
-	if (v1 > v2) return 1;
-	return 0;
-}
-
 /** WiiSystemMenuVersion **/
 
 /**
@@ -107,14 +83,16 @@ int RP_C_API WiiSystemMenuVersionPrivate::compar(const void *a, const void *b)
 const char *WiiSystemMenuVersion::lookup(unsigned int version)
 {
 	// Do a binary search.
-	const WiiSystemMenuVersionPrivate::SysVersionEntry_t key = {static_cast<uint16_t>(version), ""};
-	const WiiSystemMenuVersionPrivate::SysVersionEntry_t *res =
-		static_cast<const WiiSystemMenuVersionPrivate::SysVersionEntry_t*>(bsearch(&key,
-			WiiSystemMenuVersionPrivate::sysVersionList,
-			ARRAY_SIZE(WiiSystemMenuVersionPrivate::sysVersionList)-1,
-			sizeof(WiiSystemMenuVersionPrivate::SysVersionEntry_t),
-			WiiSystemMenuVersionPrivate::compar));
-	return (res ? res->str : nullptr);
+	static const WiiSystemMenuVersionPrivate::SysVersionEntry_t *const pSysVersionList_end =
+		&WiiSystemMenuVersionPrivate::sysVersionList[ARRAY_SIZE(WiiSystemMenuVersionPrivate::sysVersionList)-1];
+	auto pSysVersion = std::lower_bound(WiiSystemMenuVersionPrivate::sysVersionList, pSysVersionList_end, version,
+		[](const WiiSystemMenuVersionPrivate::SysVersionEntry_t &sysVersion, unsigned int version) {
+			return (sysVersion.version < version);
+		});
+	if (pSysVersion == pSysVersionList_end || pSysVersion->version != version) {
+		return nullptr;
+	}
+	return pSysVersion->str;
 }
 
 }
@@ -43,12 +43,13 @@ class WiiUDataPrivate {
 		static const WiiUDiscPublisher disc_publishers_region[];
 
 		/**
-		 * Comparison function for bsearch().
-		 * @param a
-		 * @param b
-		 * @return
+		 * Look up an ID4 in a sorted WiiUDiscPublisher array.
+		 * @param pTbl	[in] WiiUDiscPublisher array
+		 * @param count	[in] Number of entries in pTbl, not including the NULL terminator.
+		 * @param id4	[in] Packed ID4
+		 * @return Packed publisher ID, or 0 if not found.
 		 */
-		static int RP_C_API compar(const void *a, const void *b);
+		static uint32_t lookup_id4(const WiiUDiscPublisher *pTbl, size_t count, uint32_t id4);
 };
 
 /** WiiUDataPrivate **/
@@ -314,18 +315,24 @@ const WiiUDataPrivate::WiiUDiscPublisher WiiUDataPrivate::disc_publishers_region
 };
 
 /**
- * Comparison function for bsearch().
- * @param a
- * @param b
- * @return
+ * Look up an ID4 in a sorted WiiUDiscPublisher array.
+ * @param pTbl	[in] WiiUDiscPublisher array
+ * @param count	[in] Number of entries in pTbl, not including the NULL terminator.
+ * @param id4	[in] Packed ID4
+ * @return Packed publisher ID, or 0 if not found.
  */
-int RP_C_API WiiUDataPrivate::compar(const void *a, const void *b)
+uint32_t WiiUDataPrivate::lookup_id4(const WiiUDiscPublisher *pTbl, size_t count, uint32_t id4)
 {
-	unsigned int id4_1 = static_cast<const WiiUDiscPublisher*>(a)->id4;
-	unsigned int id4_2 = static_cast<const WiiUDiscPublisher*>(b)->id4;
-	if (id4_1 < id4_2) return -1;
-	if (id4_1 > id4_2) return 1;
-	return 0;
+	// Do a binary search.
+	const WiiUDiscPublisher *const pTbl_end = pTbl + count;
+	auto pPublisher = std::lower_bound(pTbl, pTbl_end, id4,
+		[](const WiiUDiscPublisher &publisher, uint32_t id4) {
+			return (publisher.id4 < id4);
+		});
+	if (pPublisher == pTbl_end || pPublisher->id4 != id4) {
+		return 0;
+	}
+	return pPublisher->publisher;
 }
 
 /** WiiUData **/
@@ -343,36 +350,25 @@ int RP_C_API WiiUDataPrivate::compar(const void *a, const void *b)
 uint32_t WiiUData::lookup_disc_publisher(const char *id4)
 {
 	// Check the region-independent list first.
-	WiiUDataPrivate::WiiUDiscPublisher key;
-	key.id4 = (static_cast<uint8_t>(id4[0]) << 24) |
-		  (static_cast<uint8_t>(id4[1]) << 16) |
-		  (static_cast<uint8_t>(id4[2]) << 8) | 'x';
-	key.publisher = 0;
-
-	// Do a binary search.
-	const WiiUDataPrivate::WiiUDiscPublisher *res =
-		static_cast<const WiiUDataPrivate::WiiUDiscPublisher*>(bsearch(&key,
-			WiiUDataPrivate::disc_publishers_noregion,
-			ARRAY_SIZE(WiiUDataPrivate::disc_publishers_noregion)-1,
-			sizeof(WiiUDataPrivate::WiiUDiscPublisher),
-			WiiUDataPrivate::compar));
-	if (res) {
+	uint32_t id4_packed = (static_cast<uint8_t>(id4[0]) << 24) |
+			      (static_cast<uint8_t>(id4[1]) << 16) |
+			      (static_cast<uint8_t>(id4[2]) << 8) | 'x';
+	const uint32_t publisher = WiiUDataPrivate::lookup_id4(
+		WiiUDataPrivate::disc_publishers_noregion,
+		ARRAY_SIZE(WiiUDataPrivate::disc_publishers_noregion)-1,
+		id4_packed);
+	if (publisher != 0) {
 		// Found a publisher in the region-independent list.
-		return res->publisher;
+		return publisher;
 	}
 
 	// Check the region-specific list.
-	key.id4 &= ~0xFF;
-	key.id4 |= static_cast<uint8_t>(id4[3]);
-
-	// Do a binary search.
-	res = static_cast<const WiiUDataPrivate::WiiUDiscPublisher*>(bsearch(&key,
-			WiiUDataPrivate::disc_publishers_region,
-			ARRAY_SIZE(WiiUDataPrivate::disc_publishers_region)-1,
-			sizeof(WiiUDataPrivate::WiiUDiscPublisher),
-			WiiUDataPrivate::compar));
-
-	return (res ? res->publisher : 0);
+	id4_packed &= ~0xFF;
+	id4_packed |= static_cast<uint8_t>(id4[3]);
+	return WiiUDataPrivate::lookup_id4(
+		WiiUDataPrivate::disc_publishers_region,
+		ARRAY_SIZE(WiiUDataPrivate::disc_publishers_region)-1,
+		id4_packed);
 }
 
 }
@@ -30,14 +30,6 @@ class Xbox360_STFS_ContentTypePrivate {
 		};
 		static const ContentTypeEntry contentTypeList[];
 
-		/**
-		 * Comparison function for bsearch().
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar(const void *a, const void *b);
-
 };
 
 /**
@@ -81,21 +73,6 @@ const Xbox360_STFS_ContentTypePrivate::ContentTypeEntry Xbox360_STFS_ContentType
 	{0, nullptr}
 };
 
-/**
- * Comparison function for bsearch().
- * @param a
- * @param b
- * @return
- */
-int RP_C_API Xbox360_STFS_ContentTypePrivate::compar(const void *a, const void *b)
-{
-	uint32_t id1 = static_cast<const ContentTypeEntry*>(a)->id;
-	uint32_t id2 = static_cast<const ContentTypeEntry*>(b)->id;
-	if (id1 < id2) return -1;
-	if (id1 > id2) return 1;
-	return 0;
-}
-
 /**
  * Look up an STFS content type.
  * @param contentType Content type.
@@ -104,16 +81,16 @@ int RP_C_API Xbox360_STFS_ContentTypePrivate::compar(const void *a, const void *
 const char *Xbox360_STFS_ContentType::lookup(uint32_t contentType)
 {
 	// Do a binary search.
-	const Xbox360_STFS_ContentTypePrivate::ContentTypeEntry key = {contentType, nullptr};
-	const Xbox360_STFS_ContentTypePrivate::ContentTypeEntry *res =
-		static_cast<const Xbox360_STFS_ContentTypePrivate::ContentTypeEntry*>(bsearch(&key,
-			Xbox360_STFS_ContentTypePrivate::contentTypeList,
-			ARRAY_SIZE(Xbox360_STFS_ContentTypePrivate::contentTypeList)-1,
-			sizeof(Xbox360_STFS_ContentTypePrivate::ContentTypeEntry),
-			Xbox360_STFS_ContentTypePrivate::compar));
-	return (res
-		? dpgettext_expr(RP_I18N_DOMAIN, "Xbox360_STFS|ContentType", res->contentType)
-		: nullptr);
+	static const Xbox360_STFS_ContentTypePrivate::ContentTypeEntry *const pContentTypeList_end =
+		&Xbox360_STFS_ContentTypePrivate::contentTypeList[ARRAY_SIZE(Xbox360_STFS_ContentTypePrivate::contentTypeList)-1];
+	auto pContentTypeEntry = std::lower_bound(Xbox360_STFS_ContentTypePrivate::contentTypeList, pContentTypeList_end, contentType,
+		[](const Xbox360_STFS_ContentTypePrivate::ContentTypeEntry &contentTypeEntry, uint32_t contentType) {
+			return (contentTypeEntry.id < contentType);
+		});
+	if (pContentTypeEntry == pContentTypeList_end || pContentTypeEntry->id != contentType) {
+		return nullptr;
+	}
+	return dpgettext_expr(RP_I18N_DOMAIN, "Xbox360_STFS|ContentType", pContentTypeEntry->contentType);
 }
 
 }
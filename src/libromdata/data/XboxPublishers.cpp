@@ -33,16 +33,6 @@ class XboxPublishersPrivate {
 		 */
 		static const ThirdPartyEntry thirdPartyList[];
 
-		/**
-		 * Comparison function for bsearch().
-		 * For use with ThirdPartyEntry.
-		 *
-		 * @param a
-		 * @param b
-		 * @return
-		 */
-		static int RP_C_API compar(const void *a, const void *b);
-
 };
 
 /**
@@ -157,23 +147,6 @@ const XboxPublishersPrivate::ThirdPartyEntry XboxPublishersPrivate::thirdPartyLi
 	{0, nullptr}
 };
 
-/**
- * Comparison function for bsearch().
- * For use with ThirdPartyEntry.
- *
- * @param a
- * @param b
- * @return
- */
-int RP_C_API XboxPublishersPrivate::compar(const void *a, const void *b)
-{
-	uint16_t code1 = static_cast<const ThirdPartyEntry*>(a)->code;
-	uint16_t code2 = static_cast<const ThirdPartyEntry*>(b)->code;
-	if (code1 < code2) return -1;
-	if (code1 > code2) return 1;
-	return 0;
-}
-
 /** Public functions **/
 
 /**
@@ -184,14 +157,16 @@ int RP_C_API XboxPublishersPrivate::compar(const void *a, const void *b)
 const char *XboxPublishers::lookup(uint16_t code)
 {
 	// Do a binary search.
-	const XboxPublishersPrivate::ThirdPartyEntry key = {code, nullptr};
-	const XboxPublishersPrivate::ThirdPartyEntry *res =
-		static_cast<const XboxPublishersPrivate::ThirdPartyEntry*>(bsearch(&key,
-			XboxPublishersPrivate::thirdPartyList,
-			ARRAY_SIZE(XboxPublishersPrivate::thirdPartyList)-1,
-			sizeof(XboxPublishersPrivate::ThirdPartyEntry),
-			XboxPublishersPrivate::compar));
-	return (res ? res->publisher : nullptr);
+	static const XboxPublishersPrivate::ThirdPartyEntry *const pThirdPartyList_end =
+		&XboxPublishersPrivate::thirdPartyList[ARRAY_SIZE(XboxPublishersPrivate::thirdPartyList)-1];
+	auto pPublisher = std::lower_bound(XboxPublishersPrivate::thirdPartyList, pThirdPartyList_end, code,
+		[](const XboxPublishersPrivate::ThirdPartyEntry &publisher, uint16_t code) {
+			return (publisher.code < code);
+		});
+	if (pPublisher == pThirdPartyList_end || pPublisher->code != code) {
+		return nullptr;
+	}
+	return pPublisher->publisher;
 }
 
 /**
@@ -12,10 +12,10 @@
 
 // librpbase, librpfile
 #include "librpbase/disc/CBCReader.hpp"
+#include "librpbase/crypto/KeyManager.hpp"
 #ifdef ENABLE_DECRYPTION
 # include "librpbase/crypto/AesCipherFactory.hpp"
 # include "librpbase/crypto/IAesCipher.hpp"
-# include "librpbase/crypto/KeyManager.hpp"
 # include "../crypto/N3DSVerifyKeys.hpp"
 #endif /* ENABLE_DECRYPTION */
 using namespace LibRpBase;
@@ -28,7 +28,7 @@ class CIAReaderPrivate
 	public:
 		CIAReaderPrivate(CIAReader *q,
 			off64_t content_offset, uint32_t content_length,
-			const N3DS_Ticket_t *ticket,
+			const N3DS_Ticket_t *ticket, const uint8_t *title_key,
 			uint16_t tmd_content_index);
 		~CIAReaderPrivate();
 
@@ -39,45 +39,129 @@ class CIAReaderPrivate
 
 	public:
 		CBCReader *cbcReader;		// CBC reader.
-
-#ifdef ENABLE_DECRYPTION
-		// KeyY index for title key encryption.
-		uint8_t titleKeyEncIdx;
-		// TMD content index.
-		uint16_t tmd_content_index;
-#endif /* ENABLE_DECRYPTION */
 };
 
 /** CIAReaderPrivate **/
 
 CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
 	off64_t content_offset, uint32_t content_length,
-	const N3DS_Ticket_t *ticket, uint16_t tmd_content_index)
+	const N3DS_Ticket_t *ticket, const uint8_t *title_key,
+	uint16_t tmd_content_index)
 	: q_ptr(q)
 	, cbcReader(nullptr)
-#ifdef ENABLE_DECRYPTION
-	, titleKeyEncIdx(0)
-	, tmd_content_index(tmd_content_index)
-#endif /* ENABLE_DECRYPTION */
 {
-#ifndef ENABLE_DECRYPTION
-	RP_UNUSED(tmd_content_index);
-#endif /* ENABLE_DECRYPTION */
-
 	assert(q->m_file != nullptr);
 	if (!q->m_file) {
 		// No file...
 		return;
 	}
 
-	assert(ticket != nullptr);
-	if (!ticket) {
-		// No ticket. Assuming no encryption.
+	uint8_t ticket_title_key[16];
+	if (ticket) {
+		// Decrypt the title key from the ticket.
+		if (CIAReader::decryptTitleKey(ticket_title_key, ticket) != KeyManager::VerifyResult::OK) {
+			// Unable to get the CIA encryption keys.
+			// TODO: Set an error.
+			UNREF_AND_NULL_NOCHK(q->m_file);
+			return;
+		}
+		title_key = ticket_title_key;
+	}
+
+	if (!title_key) {
+		// No title key. Assuming no encryption.
 		// Create a passthru CBCReader anyway.
 		cbcReader = new CBCReader(q->m_file, content_offset, content_length, nullptr, nullptr);
 		return;
 	}
 
+#ifdef ENABLE_DECRYPTION
+	// Data area: IV is the TMD content index.
+	uint8_t cia_iv[16];
+	cia_iv[0] = tmd_content_index >> 8;
+	cia_iv[1] = tmd_content_index & 0xFF;
+	memset(&cia_iv[2], 0, sizeof(cia_iv)-2);
+
+	// Create a CBC reader to decrypt the CIA.
+	cbcReader = new CBCReader(q->m_file, content_offset, content_length, title_key, cia_iv);
+#else /* !ENABLE_DECRYPTION */
+	// Cannot decrypt the CIA.
+	// TODO: Set an error.
+	RP_UNUSED(tmd_content_index);
+	UNREF_AND_NULL_NOCHK(q->m_file);
+#endif /* ENABLE_DECRYPTION */
+}
+
+CIAReaderPrivate::~CIAReaderPrivate()
+{
+	UNREF(cbcReader);
+}
+
+/** CIAReader **/
+
+/**
+ * Construct a CIAReader with the specified IRpFile.
+ *
+ * NOTE: The IRpFile *must* remain valid while this
+ * CIAReader is open.
+ *
+ * @param file 			[in] IRpFile.
+ * @param content_offset	[in] Content start offset, in bytes.
+ * @param content_length	[in] Content length, in bytes.
+ * @param ticket		[in,opt] Ticket for decryption. (nullptr if NoCrypto)
+ * @param tmd_content_index	[in,opt] TMD content index for decryption.
+ */
+CIAReader::CIAReader(IRpFile *file,
+		off64_t content_offset, uint32_t content_length,
+		const N3DS_Ticket_t *ticket,
+		uint16_t tmd_content_index)
+	: super(file)
+	, d_ptr(new CIAReaderPrivate(this, content_offset, content_length, ticket, nullptr, tmd_content_index))
+{ }
+
+/**
+ * Construct a CIAReader with the specified IRpFile
+ * and an already-decrypted title key.
+ *
+ * This avoids decrypting the title key again if
+ * multiple contents are being read from the same CIA.
+ *
+ * NOTE: The IRpFile *must* remain valid while this
+ * CIAReader is open.
+ *
+ * @param file 			[in] IRpFile.
+ * @param content_offset	[in] Content start offset, in bytes.
+ * @param content_length	[in] Content length, in bytes.
+ * @param title_key		[in,opt] Decrypted title key. (16 bytes; nullptr if NoCrypto)
+ * @param tmd_content_index	[in,opt] TMD content index for decryption.
+ */
+CIAReader::CIAReader(IRpFile *file,
+		off64_t content_offset, uint32_t content_length,
+		const uint8_t *title_key,
+		uint16_t tmd_content_index)
+	: super(file)
+	, d_ptr(new CIAReaderPrivate(this, content_offset, content_length, nullptr, title_key, tmd_content_index))
+{ }
+
+CIAReader::~CIAReader()
+{
+	delete d_ptr;
+}
+
+/**
+ * Decrypt a CIA title key.
+ * @param pTitleKey	[out] Decrypted title key. (16 bytes)
+ * @param ticket	[in] Ticket.
+ * @return VerifyResult.
+ */
+KeyManager::VerifyResult CIAReader::decryptTitleKey(uint8_t *pTitleKey, const N3DS_Ticket_t *ticket)
+{
+	assert(pTitleKey != nullptr);
+	assert(ticket != nullptr);
+	if (!pTitleKey || !ticket) {
+		return KeyManager::VerifyResult::InvalidParams;
+	}
+
 #ifdef ENABLE_DECRYPTION
 	// Check the ticket issuer.
 	const char *keyPrefix;
@@ -87,7 +171,6 @@ CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
 	if (!strncmp(ticket->issuer, N3DS_TICKET_ISSUER_RETAIL, sizeof(ticket->issuer))) {
 		// Retail issuer.
 		keyPrefix = "ctr";
-		titleKeyEncIdx = N3DS_TICKET_TITLEKEY_ISSUER_RETAIL;
 		if (ticket->keyY_index < 6) {
 			// Verification data is available.
 			keyX_verify = N3DSVerifyKeys::EncryptionKeyVerifyData[N3DSVerifyKeys::Key_Retail_Slot0x3DKeyX];
@@ -97,7 +180,6 @@ CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
 	} else if (!strncmp(ticket->issuer, N3DS_TICKET_ISSUER_DEBUG, sizeof(ticket->issuer))) {
 		// Debug issuer.
 		keyPrefix = "ctr-dev";
-		titleKeyEncIdx = N3DS_TICKET_TITLEKEY_ISSUER_DEBUG;
 		if (ticket->keyY_index < 6) {
 			// Verification data is available.
 			keyX_verify = N3DSVerifyKeys::EncryptionKeyVerifyData[N3DSVerifyKeys::Key_Debug_Slot0x3DKeyX];
@@ -107,13 +189,8 @@ CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
 	} else {
 		// Unknown issuer.
 		keyPrefix = "ctr";
-		titleKeyEncIdx = N3DS_TICKET_TITLEKEY_ISSUER_UNKNOWN;
 	}
 
-	// Check the KeyY index.
-	// TODO: Handle invalid KeyY indexes?
-	titleKeyEncIdx |= (ticket->keyY_index << 2);
-
 	// Keyslot names.
 	char keyX_name[40];
 	char keyY_name[40];
@@ -130,84 +207,41 @@ CIAReaderPrivate::CIAReaderPrivate(CIAReader *q,
 	KeyManager::VerifyResult res = N3DSVerifyKeys::loadKeyNormal(&keyNormal,
 		keyNormal_name, keyX_name, keyY_name,
 		keyNormal_verify, keyX_verify, keyY_verify);
-	if (res == KeyManager::VerifyResult::OK) {
-		// Create a cipher to decrypt the title key.
-		IAesCipher *cipher = AesCipherFactory::create();
-
-		// Initialize parameters for title key decryption.
-		// TODO: Error checking.
-		// Parameters:
-		// - Keyslot: 0x3D
-		// - Chaining mode: CBC
-		// - IV: Title ID (little-endian)
-		cipher->setChainingMode(IAesCipher::ChainingMode::CBC);
-		cipher->setKey(keyNormal.u8, sizeof(keyNormal.u8));
-		// CIA IV is the title ID in big-endian.
-		// The ticket title ID is already in big-endian,
-		// so copy it over directly.
-		u128_t cia_iv;
-		memcpy(cia_iv.u8, &ticket->title_id.id, sizeof(ticket->title_id.id));
-		memset(&cia_iv.u8[8], 0, 8);
-		cipher->setIV(cia_iv.u8, sizeof(cia_iv.u8));
-
-		// Decrypt the title key.
-		uint8_t title_key[16];
-		memcpy(title_key, ticket->title_key, sizeof(title_key));
-		cipher->decrypt(title_key, sizeof(title_key));
-		delete cipher;
-
-		// Data area: IV is the TMD content index.
-		cia_iv.u8[0] = tmd_content_index >> 8;
-		cia_iv.u8[1] = tmd_content_index & 0xFF;
-		memset(&cia_iv.u8[2], 0, sizeof(cia_iv.u8)-2);
-
-		// Create a CBC reader to decrypt the CIA.
-		cbcReader = new CBCReader(q->m_file, content_offset, content_length, title_key, cia_iv.u8);
-	} else {
+	if (res != KeyManager::VerifyResult::OK) {
 		// Unable to get the CIA encryption keys.
-		// TODO: Set an error.
-		//verifyResult = res;
-		UNREF_AND_NULL_NOCHK(q->m_file);
+		return res;
 	}
+
+	// Create a cipher to decrypt the title key.
+	IAesCipher *cipher = AesCipherFactory::create();
+
+	// Initialize parameters for title key decryption.
+	// TODO: Error checking.
+	// Parameters:
+	// - Keyslot: 0x3D
+	// - Chaining mode: CBC
+	// - IV: Title ID (little-endian)
+	cipher->setChainingMode(IAesCipher::ChainingMode::CBC);
+	cipher->setKey(keyNormal.u8, sizeof(keyNormal.u8));
+	// CIA IV is the title ID in big-endian.
+	// The ticket title ID is already in big-endian,
+	// so copy it over directly.
+	u128_t cia_iv;
+	memcpy(cia_iv.u8, &ticket->title_id.id, sizeof(ticket->title_id.id));
+	memset(&cia_iv.u8[8], 0, 8);
+	cipher->setIV(cia_iv.u8, sizeof(cia_iv.u8));
+
+	// Decrypt the title key.
+	memcpy(pTitleKey, ticket->title_key, sizeof(ticket->title_key));
+	cipher->decrypt(pTitleKey, sizeof(ticket->title_key));
+	delete cipher;
+	return KeyManager::VerifyResult::OK;
 #else /* !ENABLE_DECRYPTION */
-	// Cannot decrypt the CIA.
-	// TODO: Set an error.
-	UNREF_AND_NULL_NOCHK(q->m_file);
+	// Cannot decrypt the title key.
+	return KeyManager::VerifyResult::NoSupport;
 #endif /* ENABLE_DECRYPTION */
 }
 
-CIAReaderPrivate::~CIAReaderPrivate()
-{
-	UNREF(cbcReader);
-}
-
-/** CIAReader **/
-
-/**
- * Construct a CIAReader with the specified IRpFile.
- *
- * NOTE: The IRpFile *must* remain valid while this
- * CIAReader is open.
- *
- * @param file 			[in] IRpFile.
- * @param content_offset	[in] Content start offset, in bytes.
- * @param content_length	[in] Content length, in bytes.
- * @param ticket		[in,opt] Ticket for decryption. (nullptr if NoCrypto)
- * @param tmd_content_index	[in,opt] TMD content index for decryption.
- */
-CIAReader::CIAReader(IRpFile *file,
-		off64_t content_offset, uint32_t content_length,
-		const N3DS_Ticket_t *ticket,
-		uint16_t tmd_content_index)
-	: super(file)
-	, d_ptr(new CIAReaderPrivate(this, content_offset, content_length, ticket, tmd_content_index))
-{ }
-
-CIAReader::~CIAReader()
-{
-	delete d_ptr;
-}
-
 /** IDiscReader **/
 
 /**
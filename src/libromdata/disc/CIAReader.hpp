@@ -13,6 +13,7 @@
 
 // librpbase
 #include "librpbase/disc/IPartition.hpp"
+#include "librpbase/crypto/KeyManager.hpp"
 
 namespace LibRomData {
 
@@ -36,6 +37,27 @@ class CIAReader : public LibRpBase::IPartition
 			off64_t content_offset, uint32_t content_length,
 			const N3DS_Ticket_t *ticket,
 			uint16_t tmd_content_index);
+
+		/**
+		 * Construct a CIAReader with the specified IRpFile
+		 * and an already-decrypted title key.
+		 *
+		 * This avoids decrypting the title key again if
+		 * multiple contents are being read from the same CIA.
+		 *
+		 * NOTE: The IRpFile *must* remain valid while this
+		 * CIAReader is open.
+		 *
+		 * @param file 			[in] IRpFile.
+		 * @param content_offset	[in] Content start offset, in bytes.
+		 * @param content_length	[in] Content length, in bytes.
+		 * @param title_key		[in,opt] Decrypted title key. (16 bytes; nullptr if NoCrypto)
+		 * @param tmd_content_index	[in,opt] TMD content index for decryption.
+		 */
+		CIAReader(LibRpFile::IRpFile *file,
+			off64_t content_offset, uint32_t content_length,
+			const uint8_t *title_key,
+			uint16_t tmd_content_index);
 	protected:
 		virtual ~CIAReader();	// call unref() instead
 
@@ -47,6 +69,15 @@ class CIAReader : public LibRpBase::IPartition
 		friend class CIAReaderPrivate;
 		CIAReaderPrivate *const d_ptr;
 
+	public:
+		/**
+		 * Decrypt a CIA title key.
+		 * @param pTitleKey	[out] Decrypted title key. (16 bytes)
+		 * @param ticket	[in] Ticket.
+		 * @return VerifyResult.
+		 */
+		static LibRpBase::KeyManager::VerifyResult decryptTitleKey(uint8_t *pTitleKey, const N3DS_Ticket_t *ticket);
+
 	public:
 		/** IDiscReader **/
 
@@ -13,11 +13,14 @@
 #include "../Console/gcn_structs.h"
 
 // librpbase
+#include "librpbase/disc/FstPathIndex.hpp"
 using namespace LibRpBase;
 
 // C++ STL classes.
+using std::pair;
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
@@ -46,6 +49,19 @@ class GcnFstPrivate
 		// - Value: string.
 		mutable unordered_map<uint32_t, string> u8_string_table;
 
+		// Path index for ASCII paths. (Built by find_path().)
+		// - Key: Normalized path. (See FstPathIndex.)
+		//   Case-folded if caseInsensitive is true.
+		// - Value: FST entry index, or -1 if more than one entry
+		//   has the same normalized path.
+		// NOTE: Paths with non-ASCII characters aren't indexed.
+		mutable FstPathIndex<int> pathIndex;
+		mutable bool pathIndexLoaded;	// True if the path index has been built.
+		mutable bool pathIndexValid;	// False if the FST couldn't be indexed.
+
+		// If true, path lookups ignore ASCII case.
+		bool caseInsensitive;
+
 		// Offset shift.
 		uint8_t offsetShift;
 
@@ -77,6 +93,30 @@ class GcnFstPrivate
 		 */
 		const GCN_FST_Entry *entry(int idx, const char **ppszName = nullptr) const;
 
+		/**
+		 * Build the path index.
+		 * Called by find_path() if the path index hasn't been built yet.
+		 */
+		void loadPathIndex(void) const;
+
+		/**
+		 * Compare two filenames.
+		 * @param s1 Filename 1.
+		 * @param s2 Filename 2.
+		 * @param ignoreCase If true, ignore ASCII case.
+		 * @return True if the filenames match; false if not.
+		 */
+		static bool name_equals(const char *s1, const char *s2, bool ignoreCase);
+
+		/**
+		 * Find a path by walking the FST.
+		 * Used if the path can't be found using the path index.
+		 * @param path Path. (Absolute paths only!)
+		 * @param ignoreCase If true, ignore ASCII case.
+		 * @return fst_entry if found, or nullptr if not.
+		 */
+		const GCN_FST_Entry *find_path_linear(const char *path, bool ignoreCase) const;
+
 		/**
 		 * Find a path.
 		 * @param path Path. (Absolute paths only!)
@@ -93,6 +133,9 @@ GcnFstPrivate::GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offse
 	, fstData_sz(len)
 	, string_table_ptr(nullptr)
 	, string_table_sz(0)
+	, pathIndexLoaded(false)
+	, pathIndexValid(false)
+	, caseInsensitive(false)
 	, offsetShift(offsetShift)
 	, fstDirCount(0)
 {
@@ -222,6 +265,94 @@ const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
 	return &fstData[idx];
 }
 
+/**
+ * Build the path index.
+ * Called by find_path() if the path index hasn't been built yet.
+ */
+void GcnFstPrivate::loadPathIndex(void) const
+{
+	pathIndexLoaded = true;
+	if (!fstData) {
+		// No FST.
+		return;
+	}
+
+	// NOTE: Names are read directly from the string table.
+	// Only ASCII paths are indexed, so the name encoding
+	// doesn't matter, and names don't need to be converted.
+	// Entries are stored in depth-first order, so a directory's
+	// contents are the entries from its index + 1 to next_offset.
+	const uint32_t file_count = be32_to_cpu(fstData[0].root_dir.file_count);
+	pathIndex.reserve(file_count - 1);
+
+	// Directory stack.
+	// - first: Index *after* the last entry in the directory.
+	// - second: Length of the parent directory's key.
+	vector<pair<uint32_t, size_t> > dir_stack;
+	string key;
+	uint32_t dir_end = file_count;
+
+	for (uint32_t idx = 1; idx < file_count; idx++) {
+		while (idx >= dir_end) {
+			// End of the current directory.
+			key.resize(dir_stack.back().second);
+			dir_stack.pop_back();
+			dir_end = (dir_stack.empty() ? file_count : dir_stack.back().first);
+		}
+
+		const GCN_FST_Entry *const fst_entry = &fstData[idx];
+		const bool isDir = is_dir(fst_entry);
+		uint32_t next_idx = 0;
+		if (isDir) {
+			next_idx = be32_to_cpu(fst_entry->dir.next_offset);
+			if (next_idx <= idx || next_idx > dir_end) {
+				// Directory is out of range.
+				// Use find_path_linear() for everything.
+				pathIndex.clear();
+				return;
+			}
+		}
+
+		// Check if the name is ASCII.
+		const uint32_t name_offset = be32_to_cpu(fst_entry->file_type_name_offset) & 0xFFFFFF;
+		const char *const name = (name_offset < string_table_sz ? &string_table_ptr[name_offset] : "");
+		const size_t name_len = strlen(name);
+		bool isAscii = (name_len > 0);
+		for (size_t i = 0; i < name_len; i++) {
+			if ((name[i] & 0x80) || name[i] == '/' || name[i] == '\\') {
+				isAscii = false;
+				break;
+			}
+		}
+		if (!isAscii) {
+			// Can't be found using an ASCII path.
+			if (isDir) {
+				// Skip the directory's contents.
+				idx = next_idx - 1;
+			}
+			continue;
+		}
+
+		const size_t parent_len = key.size();
+		FstPathIndex<int>::appendName(key, name, name_len, caseInsensitive);
+		if (!pathIndex.insert(key, static_cast<int>(idx))) {
+			// Multiple entries have the same normalized path.
+			// Use find_path_linear() for this path.
+			*pathIndex.find(key) = -1;
+		}
+
+		if (isDir) {
+			// Enter the directory.
+			dir_stack.emplace_back(next_idx, parent_len);
+			dir_end = next_idx;
+		} else {
+			key.resize(parent_len);
+		}
+	}
+
+	pathIndexValid = true;
+}
+
 /**
  * Find a path.
  * @param path Path. (Absolute paths only!)
@@ -234,6 +365,73 @@ const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
 		return nullptr;
 	}
 
+	if (!pathIndexLoaded) {
+		loadPathIndex();
+	}
+	if (!pathIndexValid) {
+		// Path index isn't available.
+		return find_path_linear(path, caseInsensitive);
+	}
+
+	const string key = FstPathIndex<int>::normalize(path, caseInsensitive);
+	if (key.empty()) {
+		// Root directory.
+		return this->entry(0, nullptr);
+	}
+
+	const int *const pIdx = pathIndex.find(key);
+	if (pIdx && *pIdx >= 0) {
+		// Found the path.
+		return this->entry(*pIdx, nullptr);
+	}
+
+	for (const char *p = key.c_str(); *p != '\0'; p++) {
+		if (*p & 0x80) {
+			// Non-ASCII path. Not indexed.
+			return find_path_linear(path, caseInsensitive);
+		}
+	}
+
+	// Not found, or more than one entry has the same normalized path.
+	// For the latter, use the first entry whose case matches exactly.
+	return (pIdx ? find_path_linear(path, false) : nullptr);
+}
+
+/**
+ * Compare two filenames.
+ * @param s1 Filename 1.
+ * @param s2 Filename 2.
+ * @param ignoreCase If true, ignore ASCII case.
+ * @return True if the filenames match; false if not.
+ */
+bool GcnFstPrivate::name_equals(const char *s1, const char *s2, bool ignoreCase)
+{
+	if (!ignoreCase) {
+		return !strcmp(s1, s2);
+	}
+
+	// NOTE: Not using strcasecmp() because it's locale-dependent.
+	for (; *s1 != '\0' && *s2 != '\0'; s1++, s2++) {
+		if (FstPathIndex<int>::foldChar(*s1) != FstPathIndex<int>::foldChar(*s2))
+			return false;
+	}
+	return (*s1 == *s2);
+}
+
+/**
+ * Find a path by walking the FST.
+ * Used if the path can't be found using the path index.
+ * @param path Path. (Absolute paths only!)
+ * @param ignoreCase If true, ignore ASCII case.
+ * @return fst_entry if found, or nullptr if not.
+ */
+const GCN_FST_Entry *GcnFstPrivate::find_path_linear(const char *path, bool ignoreCase) const
+{
+	if (!path) {
+		// Invalid path.
+		return nullptr;
+	}
+
 	// Get the root directory.
 	const GCN_FST_Entry *fst_entry = this->entry(0, nullptr);
 	if (!fst_entry) {
@@ -305,8 +503,7 @@ const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
 				return nullptr;
 			}
 
-			// TODO: Is GCN/Wii case-sensitive?
-			if (pName && !strcmp(path_component.c_str(), pName)) {
+			if (pName && name_equals(path_component.c_str(), pName, ignoreCase)) {
 				// Found a match.
 				found = true;
 				break;
@@ -577,6 +774,35 @@ int GcnFst::find_file(const char *filename, DirEnt *dirent)
 	return 0;
 }
 
+/**
+ * Are path lookups case-insensitive?
+ * @return True if path lookups ignore ASCII case; false if not.
+ */
+bool GcnFst::isCaseInsensitive(void) const
+{
+	return d->caseInsensitive;
+}
+
+/**
+ * Set whether path lookups are case-insensitive.
+ *
+ * By default, paths must match exactly. If enabled, ASCII
+ * letters are matched case-insensitively, same as Dolphin.
+ *
+ * @param caseInsensitive If true, ignore ASCII case in path lookups.
+ */
+void GcnFst::setCaseInsensitive(bool caseInsensitive)
+{
+	if (d->caseInsensitive == caseInsensitive)
+		return;
+
+	// The path index has to be rebuilt with the new setting.
+	d->caseInsensitive = caseInsensitive;
+	d->pathIndex.clear();
+	d->pathIndexLoaded = false;
+	d->pathIndexValid = false;
+}
+
 /**
  * Get the total size of all files.
  *
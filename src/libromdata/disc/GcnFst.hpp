@@ -81,6 +81,23 @@ class GcnFst : public LibRpBase::IFst
 		 */
 		int find_file(const char *filename, DirEnt *dirent) final;
 
+	public:
+		/**
+		 * Are path lookups case-insensitive?
+		 * @return True if path lookups ignore ASCII case; false if not.
+		 */
+		bool isCaseInsensitive(void) const;
+
+		/**
+		 * Set whether path lookups are case-insensitive.
+		 *
+		 * By default, paths must match exactly. If enabled, ASCII
+		 * letters are matched case-insensitively, same as Dolphin.
+		 *
+		 * @param caseInsensitive If true, ignore ASCII case in path lookups.
+		 */
+		void setCaseInsensitive(bool caseInsensitive);
+
 	public:
 		/**
 		 * Get the total size of all files.
@@ -11,6 +11,7 @@
 #include "iso_structs.h"
 
 // librpbase, librpfile
+#include "librpbase/disc/FstPathIndex.hpp"
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
@@ -45,46 +46,35 @@ class IsoPartitionPrivate
 		ISO_Primary_Volume_Descriptor pvd;
 
 		// Directories.
-		// - Key: Directory name, WITHOUT leading slash. (Root == empty string)
+		// - Key: Directory path. (cp1252; normalized by FstPathIndex) (Root == empty string)
 		// - Value: Directory entries.
 		// NOTE: Directory entries are variable-length, so this
 		// is a byte array, not an ISO_DirEntry array.
 		typedef ao::uvector<uint8_t> DirData_t;
 		unordered_map<string, DirData_t> dir_data;
 
-		/**
-		 * Find the last slash or backslash in a path.
-		 * @param path Path.
-		 * @return Last slash or backslash, or nullptr if not found.
-		 */
-		inline const char *findLastSlash(const char *path)
-		{
-			const char *sl = strrchr(path, '/');
-			const char *const bs = strrchr(path, '\\');
-			if (sl && bs) {
-				if (bs > sl) {
-					sl = bs;
-				}
-			}
-			return (sl ? sl : bs);
-		}
+		// Path index for all loaded directories.
+		// - Key: File or directory path. (cp1252; normalized by FstPathIndex)
+		// - Value: ISO directory entry. (Pointer into dir_data.)
+		// Files with a ";1" version suffix are indexed both
+		// with and without the suffix.
+		typedef FstPathIndex<const ISO_DirEntry*> PathIndex_t;
+		PathIndex_t pathIndex;
 
 		/**
-		 * Look up a directory entry from a base filename and directory.
-		 * @param pDir		[in] Directory.
-		 * @param filename	[in] Base filename. (cp1252)
-		 * @param bFindDir	[in] True to find a subdirectory; false to find a file.
-		 * @return ISO directory entry.
+		 * Add a directory's entries to the path index.
+		 * @param key	[in] Directory path. (cp1252; normalized by FstPathIndex)
+		 * @param dir	[in] Directory entries. (must be stored in dir_data)
 		 */
-		const ISO_DirEntry *lookup_int(const DirData_t *pDir, const char *filename, bool bFindDir);
+		void indexDirectory(const string &key, const DirData_t &dir);
 
 		/**
 		 * Get a directory.
-		 * @param path		[in] Pathname. (cp1252) (For root, specify "" or "/".)
+		 * @param key		[in] Directory path. (cp1252; normalized by FstPathIndex) (Root == empty string)
 		 * @param pError	[out] POSIX error code on error.
 		 * @return Directory on success; nullptr on error.
 		 */
-		const DirData_t *getDirectory(const char *path, int *pError = nullptr);
+		const DirData_t *getDirectory(const string &key, int *pError = nullptr);
 
 		/**
 		 * Look up a directory entry from a filename.
@@ -148,29 +138,25 @@ IsoPartitionPrivate::IsoPartitionPrivate(IsoPartition *q,
 	}
 
 	// Load the root directory.
-	getDirectory("/");
+	getDirectory(string());
 }
 
 IsoPartitionPrivate::~IsoPartitionPrivate()
 { }
 
 /**
- * Look up a directory entry from a base filename and directory.
- * @param pDir		[in] Directory.
- * @param filename	[in] Base filename. (cp1252)
- * @param bFindDir	[in] True to find a subdirectory; false to find a file.
- * @return ISO directory entry.
+ * Add a directory's entries to the path index.
+ * @param key	[in] Directory path. (cp1252; normalized by FstPathIndex)
+ * @param dir	[in] Directory entries. (must be stored in dir_data)
  */
-const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const char *filename, bool bFindDir)
+void IsoPartitionPrivate::indexDirectory(const string &key, const DirData_t &dir)
 {
-	// Find the file in the directory.
 	// NOTE: Filenames are case-insensitive.
 	// NOTE: File might have a ";1" suffix.
-	int err = ENOENT;
-	const unsigned int filename_len = static_cast<unsigned int>(strlen(filename));
-	const ISO_DirEntry *dirEntry_found = nullptr;
-	const uint8_t *p = pDir->data();
-	const uint8_t *const p_end = p + pDir->size();
+	string entry_key;
+	entry_key.reserve(key.size() + 32);
+	const uint8_t *p = dir.data();
+	const uint8_t *const p_end = p + dir.size();
 	while (p < p_end) {
 		const ISO_DirEntry *dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
 		if (dirEntry->entry_length < sizeof(*dirEntry)) {
@@ -179,72 +165,47 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const
 		}
 
 		const char *const entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
-		if (entry_filename + dirEntry->filename_length > reinterpret_cast<const char*>(p_end)) {
+		const unsigned int filename_length = dirEntry->filename_length;
+		if (entry_filename + filename_length > reinterpret_cast<const char*>(p_end)) {
 			// Filename is out of bounds.
 			break;
 		}
 
-		// Check the filename.
-		// 1990s and early 2000s CD-ROM games usually have
-		// ";1" filenames, so check for that first.
-		if (dirEntry->filename_length == filename_len + 2) {
-			// +2 length match.
-			// This might have ";1".
-			if (!strncasecmp(entry_filename, filename, filename_len)) {
-				// Check for ";1".
-				// TODO: Also allow other version numbers?
-				if (entry_filename[filename_len]   == ';' &&
-				    entry_filename[filename_len+1] == '1')
-				{
-					// Found it!
-					// Verify directory vs. file.
-					bool isDir = !!(dirEntry->flags & ISO_FLAG_DIRECTORY);
-					if (isDir == bFindDir) {
-						// Directory attribute matches.
-						dirEntry_found = dirEntry;
-					} else {
-						// Not a match.
-						err = (isDir ? EISDIR : ENOTDIR);
-					}
-					break;
-				}
-			}
-		} else if (dirEntry->filename_length == filename_len) {
-			// Exact length match.
-			if (!strncasecmp(entry_filename, filename, filename_len)) {
-				// Found it!
-				dirEntry_found = dirEntry;
-				break;
+		// Skip the "." and ".." entries.
+		if (filename_length > 1 || (filename_length == 1 && static_cast<uint8_t>(entry_filename[0]) > 1)) {
+			entry_key.assign(key);
+			PathIndex_t::appendName(entry_key, entry_filename, filename_length);
+			pathIndex.insert(entry_key, dirEntry);
+
+			// 1990s and early 2000s CD-ROM games usually have
+			// ";1" filenames, so index the filename without it.
+			// TODO: Also allow other version numbers?
+			if (filename_length > 2 &&
+			    entry_filename[filename_length-2] == ';' &&
+			    entry_filename[filename_length-1] == '1')
+			{
+				entry_key.resize(entry_key.size() - 2);
+				pathIndex.insert(entry_key, dirEntry);
 			}
 		}
 
 		// Next entry.
 		p += dirEntry->entry_length;
 	}
-
-	if (!dirEntry_found) {
-		RP_Q(IsoPartition);
-		q->m_lastError = err;
-	}
-	return dirEntry_found;
 }
 
 /**
  * Get a directory.
- * @param path		[in] Pathname. (cp1252) (For root, specify "" or "/".)
+ * @param key		[in] Directory path. (cp1252; normalized by FstPathIndex) (Root == empty string)
  * @param pError	[out] POSIX error code on error.
  * @return Directory on success; nullptr on error.
  */
-const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const char *path, int *pError)
+const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const string &key, int *pError)
 {
 	RP_Q(IsoPartition);
-	if (!path || !strcmp(path, "/")) {
-		// Root directory. Use "".
-		path = "";
-	}
 
 	// Check if this directory was already loaded.
-	auto iter = dir_data.find(path);
+	auto iter = dir_data.find(key);
 	if (iter != dir_data.end()) {
 		// Directory is already loaded.
 		return &iter->second;
@@ -270,7 +231,8 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 	// Should be 2048, but other values are possible.
 	const unsigned int block_size = pvd.logical_block_size.he;
 
-	if (path[0] == '\0') {
+	const ISO_DirEntry *dirEntry;
+	if (key.empty()) {
 		// Loading the root directory.
 
 		// Check the root directory entry.
@@ -310,69 +272,39 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 			}
 			iso_start_offset = static_cast<int>(rootdir->block.he - 20);
 		}
+		dirEntry = rootdir;
+	} else {
+		// Make sure the parent directory is loaded.
+		const size_t sl = key.rfind('/');
+		const DirData_t *const pDir = getDirectory(
+			(sl != string::npos ? key.substr(0, sl) : string()), pError);
+		if (!pDir) {
+			// Can't find the parent directory.
+			// getDirectory() already set q->lastError().
+			return nullptr;
+		}
 
-		// Load the root directory.
-		// NOTE: Due to variable-length entries, we need to load
-		// the entire root directory all at once.
-		DirData_t dir;
-		dir.resize(rootdir->size.he);
-		const off64_t rootDir_addr = partition_offset +
-			static_cast<off64_t>(rootdir->block.he - iso_start_offset) * block_size;
-		size_t size = q->m_discReader->seekAndRead(rootDir_addr, dir.data(), dir.size());
-		if (size != dir.size()) {
-			// Seek and/or read error.
-			dir.clear();
-			q->m_lastError = q->m_discReader->lastError();
-			if (q->m_lastError == 0) {
-				q->m_lastError = EIO;
-			}
+		// Find this directory.
+		const ISO_DirEntry *const *const pEntry = pathIndex.find(key);
+		if (!pEntry || !((*pEntry)->flags & ISO_FLAG_DIRECTORY)) {
+			// Not found, or not a directory.
+			q->m_lastError = (pEntry ? ENOTDIR : ENOENT);
 			if (pError) {
 				*pError = q->m_lastError;
 			}
 			return nullptr;
 		}
-
-		// Root directory loaded.
-		auto ins = dir_data.emplace("", std::move(dir));
-		return &(ins.first->second);
-	}
-
-	// Get the parent directory.
-	const DirData_t *pDir;
-	const char *const sl = findLastSlash(path);
-	if (!sl) {
-		// No slash. Parent is root.
-		pDir = getDirectory("");
-	} else {
-		// Found a slash.
-		string s_parentDir(path, (sl - path));
-		path = sl + 1;
-		pDir = getDirectory(s_parentDir.c_str());
-	}
-
-	if (!pDir) {
-		// Can't find the parent directory.
-		// getDirectory() already set q->lastError().
-		return nullptr;
+		dirEntry = *pEntry;
 	}
 
-	// Find this directory.
-	string s_subdir(utf8_to_cp1252(path, -1));
-	const ISO_DirEntry *const entry = lookup_int(pDir, s_subdir.c_str(), true);
-	if (!entry) {
-		// Not found.
-		// lookup_int() already set q->lastError().
-		return nullptr;
-	}
-
-	// Load the subdirectory.
+	// Load the directory.
 	// NOTE: Due to variable-length entries, we need to load
-	// the entire root directory all at once.
+	// the entire directory all at once.
 	DirData_t dir;
-	dir.resize(entry->size.he);
-	const off64_t rootDir_addr = partition_offset +
-		static_cast<off64_t>(entry->block.he - iso_start_offset) * block_size;
-	size_t size = q->m_discReader->seekAndRead(rootDir_addr, dir.data(), dir.size());
+	dir.resize(dirEntry->size.he);
+	const off64_t dir_addr = partition_offset +
+		static_cast<off64_t>(dirEntry->block.he - iso_start_offset) * block_size;
+	size_t size = q->m_discReader->seekAndRead(dir_addr, dir.data(), dir.size());
 	if (size != dir.size()) {
 		// Seek and/or read error.
 		dir.clear();
@@ -386,8 +318,9 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 		return nullptr;
 	}
 
-	// Subdirectory loaded.
-	auto ins = dir_data.emplace(std::move(s_subdir), std::move(dir));
+	// Directory loaded.
+	auto ins = dir_data.emplace(key, std::move(dir));
+	indexDirectory(key, ins.first->second);
 	return &(ins.first->second);
 }
 
@@ -402,42 +335,33 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup(const char *filename)
 	assert(filename[0] != '\0');
 	RP_Q(IsoPartition);
 
-	// Remove leading slashes.
-	while (*filename == '/') {
-		filename++;
-	}
-	if (filename[0] == 0) {
+	// TODO: Which encoding?
+	// Assuming cp1252...
+	const string key = PathIndex_t::normalize(utf8_to_cp1252(filename, -1).c_str());
+	if (key.empty()) {
 		// Nothing but slashes...
 		q->m_lastError = EINVAL;
 		return nullptr;
 	}
 
-	// TODO: Which encoding?
-	// Assuming cp1252...
-	const DirData_t *pDir;
-
-	// Is this file in a subdirectory?
-	const char *const sl = findLastSlash(filename);
-	if (sl) {
-		// This file is in a subdirectory.
-		string s_parentDir = utf8_to_cp1252(filename, static_cast<int>(sl - filename));
-		filename = sl + 1;
-		pDir = getDirectory(s_parentDir.c_str());
-	} else {
-		// Not in a subdirectory.
-		// Parent directory is root.
-		pDir = getDirectory("");
-	}
-
+	// Make sure the parent directory is loaded.
+	const size_t sl = key.rfind('/');
+	const DirData_t *const pDir = getDirectory(
+		(sl != string::npos ? key.substr(0, sl) : string()));
 	if (!pDir) {
 		// Error getting the directory.
 		// getDirectory() has already set q->lastError.
 		return nullptr;
 	}
 
-	// Find the file in the directory.
-	string s_filename = utf8_to_cp1252(filename, -1);
-	return lookup_int(pDir, s_filename.c_str(), false);
+	// Find the file.
+	const ISO_DirEntry *const *const pEntry = pathIndex.find(key);
+	if (!pEntry) {
+		// Not found.
+		q->m_lastError = ENOENT;
+		return nullptr;
+	}
+	return *pEntry;
 }
 
 /**
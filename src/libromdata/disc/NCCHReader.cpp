@@ -19,6 +19,13 @@
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
+// librpthreads
+using LibRpThreads::Mutex;
+#ifdef ENABLE_DECRYPTION
+#include "librpthreads/Thread.hpp"
+using LibRpThreads::Thread;
+#endif /* ENABLE_DECRYPTION */
+
 // CIA Reader.
 #include "disc/CIAReader.hpp"
 
@@ -29,18 +36,19 @@ namespace LibRomData {
 
 NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 	uint8_t media_unit_shift,
-	off64_t ncch_offset, uint32_t ncch_length)
+	off64_t ncch_offset, uint32_t ncch_length,
+	Mutex *initMutex)
 	: q_ptr(q)
 	, ncch_offset(ncch_offset)
 	, ncch_length(ncch_length)
 	, media_unit_shift(media_unit_shift)
+	, initMutex(initMutex)
 	, pos(0)
 	, headers_loaded(0)
 	, verifyResult(KeyManager::VerifyResult::Unknown)
 	, nonNcchContentType(NonNCCHContentType::Unknown)
 #ifdef ENABLE_DECRYPTION
 	, tid_be(0)
-	, cipher(nullptr)
 	, tmd_content_index(0)
 	, isDebug(false)
 #endif /* ENABLE_DECRYPTION */
@@ -49,6 +57,11 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 	memset(&ncch_header, 0, sizeof(ncch_header));
 	memset(&ncch_exheader, 0, sizeof(ncch_exheader));
 	memset(&exefs_header, 0, sizeof(exefs_header));
+#ifdef ENABLE_DECRYPTION
+	ncch_ciphers[0] = nullptr;
+	ncch_ciphers[1] = nullptr;
+	memset(mt_ciphers, 0, sizeof(mt_ciphers));
+#endif /* ENABLE_DECRYPTION */
 
 	// Read the NCCH header.
 	// We're including the signature, since the first 16 bytes
@@ -103,12 +116,11 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 	// Determine the keyset to use.
 	// NOTE: Assuming Retail by default. Will fall back to
 	// Debug if ExeFS header decryption fails.
-	verifyResult = N3DSVerifyKeys::loadNCCHKeys(ncch_keys, &ncch_header, N3DS_TICKET_TITLEKEY_ISSUER_RETAIL);
+	verifyResult = loadNCCHKeys(N3DS_TICKET_TITLEKEY_ISSUER_RETAIL);
 	if (verifyResult != KeyManager::VerifyResult::OK) {
 		// Failed to load the keyset.
 		// Try debug keys instead.
-		verifyResult = N3DSVerifyKeys::loadNCCHKeys(ncch_keys, &ncch_header,
-			N3DS_TICKET_TITLEKEY_ISSUER_DEBUG);
+		verifyResult = loadNCCHKeys(N3DS_TICKET_TITLEKEY_ISSUER_DEBUG);
 		if (verifyResult != KeyManager::VerifyResult::OK) {
 			// Debug keys didn't work.
 			// Zero out the keys.
@@ -153,19 +165,22 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 
 #ifdef ENABLE_DECRYPTION
 	if (!(ncch_header.hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] & N3DS_NCCH_BIT_MASK_NoCrypto)) {
-		// Initialize the AES cipher.
-		// TODO: Check for errors.
-		cipher = AesCipherFactory::create();
-		cipher->setChainingMode(IAesCipher::ChainingMode::CTR);
+		// Initialize the AES ciphers.
+		if (initCiphers() != 0) {
+			// Unable to initialize the ciphers.
+			freeCiphers();
+			q->m_lastError = EIO;
+			closeFileOrDiscReader();
+			return;
+		}
 		u128_t ctr;
 
 		if (headers_loaded & HEADER_EXEFS) {
 			// Decrypt the ExeFS header.
 			// ExeFS header uses ncchKey0.
-			cipher->setKey(ncch_keys[0].u8, sizeof(ncch_keys[0].u8));
 			ctr.init_ctr(tid_be, N3DS_NCCH_SECTION_EXEFS, 0);
-			cipher->setIV(ctr.u8, sizeof(ctr.u8));
-			cipher->decrypt(reinterpret_cast<uint8_t*>(&exefs_header), sizeof(exefs_header));
+			ncch_ciphers[0]->setIV(ctr.u8, sizeof(ctr.u8));
+			ncch_ciphers[0]->decrypt(reinterpret_cast<uint8_t*>(&exefs_header), sizeof(exefs_header));
 
 			// For CXI: First file should be ".code".
 			// For CFA: First file should be "icon".
@@ -180,8 +195,7 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 					// Zero out the keys.
 					memset(ncch_keys, 0, sizeof(ncch_keys));
 					q->m_lastError = EIO;
-					delete cipher;
-					cipher = nullptr;
+					freeCiphers();
 					closeFileOrDiscReader();
 					return;
 				}
@@ -189,15 +203,13 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 				// Retail keys failed.
 				// Try again with debug keys.
 				// TODO: Consolidate this code.
-				verifyResult = N3DSVerifyKeys::loadNCCHKeys(ncch_keys, &ncch_header,
-					N3DS_TICKET_TITLEKEY_ISSUER_DEBUG);
+				verifyResult = loadNCCHKeys(N3DS_TICKET_TITLEKEY_ISSUER_DEBUG);
 				if (verifyResult != KeyManager::VerifyResult::OK) {
 					// Failed to load the keyset.
 					// Zero out the keys.
 					memset(ncch_keys, 0, sizeof(ncch_keys));
 					q->m_lastError = EIO;
-					delete cipher;
-					cipher = nullptr;
+					freeCiphers();
 					closeFileOrDiscReader();
 					return;
 				}
@@ -207,27 +219,31 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 				if (size != sizeof(exefs_header)) {
 					// Read error.
 					// NOTE: readFromROM() sets q->m_lastError.
-					delete cipher;
-					cipher = nullptr;
+					freeCiphers();
 					closeFileOrDiscReader();
 					return;
 				}
 
 				// Decrypt the ExeFS header.
 				// ExeFS header uses ncchKey0.
-				cipher->setKey(ncch_keys[0].u8, sizeof(ncch_keys[0].u8));
+				if (initCiphers() != 0) {
+					// Unable to initialize the ciphers.
+					freeCiphers();
+					q->m_lastError = EIO;
+					closeFileOrDiscReader();
+					return;
+				}
 				ctr.init_ctr(tid_be, N3DS_NCCH_SECTION_EXEFS, 0);
-				cipher->setIV(ctr.u8, sizeof(ctr.u8));
-				cipher->decrypt(reinterpret_cast<uint8_t*>(&exefs_header), sizeof(exefs_header));
+				ncch_ciphers[0]->setIV(ctr.u8, sizeof(ctr.u8));
+				ncch_ciphers[0]->decrypt(reinterpret_cast<uint8_t*>(&exefs_header), sizeof(exefs_header));
 
 				// Check the first filename, again.
 				if (strcmp(exefs_header.files[0].name, ".code") != 0 &&
 				    strcmp(exefs_header.files[0].name, "icon") != 0)
 				{
 					// Still not usable.
-					delete cipher;
+					freeCiphers();
 					q->m_lastError = EIO;
-					cipher = nullptr;
 					closeFileOrDiscReader();
 					return;
 				}
@@ -322,11 +338,114 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 NCCHReaderPrivate::~NCCHReaderPrivate()
 {
 #ifdef ENABLE_DECRYPTION
-	delete cipher;
+	freeCiphers();
 #endif /* ENABLE_DECRYPTION */
 }
 
 #ifdef ENABLE_DECRYPTION
+/**
+ * Load the NCCH encryption keys into ncch_keys[].
+ * initMutex is locked while accessing KeyManager.
+ * @param issuer	[in] Issuer type. (N3DS_Ticket_TitleKey_KeyY)
+ * @return VerifyResult.
+ */
+KeyManager::VerifyResult NCCHReaderPrivate::loadNCCHKeys(uint8_t issuer)
+{
+	if (initMutex) {
+		initMutex->lock();
+	}
+	const KeyManager::VerifyResult res = N3DSVerifyKeys::loadNCCHKeys(ncch_keys, &ncch_header, issuer);
+	if (initMutex) {
+		initMutex->unlock();
+	}
+	return res;
+}
+
+/**
+ * Initialize the NCCH ciphers using the keys in ncch_keys[].
+ * The ciphers are created if they haven't been created yet.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int NCCHReaderPrivate::initCiphers(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(ncch_ciphers); i++) {
+		if (!ncch_ciphers[i]) {
+			ncch_ciphers[i] = AesCipherFactory::create();
+			if (!ncch_ciphers[i]) {
+				// Unable to create the cipher.
+				return -ENOMEM;
+			}
+			ncch_ciphers[i]->setChainingMode(IAesCipher::ChainingMode::CTR);
+		}
+
+		int ret = ncch_ciphers[i]->setKey(ncch_keys[i].u8, sizeof(ncch_keys[i].u8));
+		if (ret != 0) {
+			// Unable to set the key.
+			return ret;
+		}
+
+		// Rekey the worker thread ciphers, if any.
+		for (int j = 0; j < ARRAY_SIZE(mt_ciphers); j++) {
+			if (!mt_ciphers[j][i])
+				continue;
+			ret = mt_ciphers[j][i]->setKey(ncch_keys[i].u8, sizeof(ncch_keys[i].u8));
+			if (ret != 0) {
+				// Unable to set the key.
+				return ret;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Get a worker thread cipher for multi-threaded decryption.
+ * The cipher is created if it hasn't been created yet.
+ * @param worker Worker thread index. (1 to MT_THREADS_MAX-1)
+ * @param keyIdx ncch_keys[] index.
+ * @return Cipher, or nullptr on error.
+ */
+IAesCipher *NCCHReaderPrivate::getWorkerCipher(unsigned int worker, uint8_t keyIdx)
+{
+	assert(worker >= 1 && worker < MT_THREADS_MAX);
+	assert(keyIdx < ARRAY_SIZE(ncch_keys));
+	IAesCipher *&cipher = mt_ciphers[worker - 1][keyIdx];
+	if (cipher) {
+		return cipher;
+	}
+
+	cipher = AesCipherFactory::create();
+	if (!cipher) {
+		// Unable to create the cipher.
+		return nullptr;
+	}
+	cipher->setChainingMode(IAesCipher::ChainingMode::CTR);
+	if (cipher->setKey(ncch_keys[keyIdx].u8, sizeof(ncch_keys[keyIdx].u8)) != 0) {
+		// Unable to set the key.
+		delete cipher;
+		cipher = nullptr;
+	}
+	return cipher;
+}
+
+/**
+ * Delete the NCCH ciphers, including the worker thread ciphers.
+ */
+void NCCHReaderPrivate::freeCiphers(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(ncch_ciphers); i++) {
+		delete ncch_ciphers[i];
+		ncch_ciphers[i] = nullptr;
+	}
+	for (int j = 0; j < ARRAY_SIZE(mt_ciphers); j++) {
+		for (int i = 0; i < ARRAY_SIZE(mt_ciphers[j]); i++) {
+			delete mt_ciphers[j][i];
+			mt_ciphers[j][i] = nullptr;
+		}
+	}
+}
+
 /**
  * Find the encrypted section containing a given address.
  * @param address Address.
@@ -347,6 +466,114 @@ int NCCHReaderPrivate::findEncSection(uint32_t address) const
 	// Not an encrypted section.
 	return -1;
 }
+
+/**
+ * Decrypt data from an encrypted section.
+ *
+ * AES-CTR blocks are independent, so large buffers are
+ * split into chunks and decrypted by multiple threads.
+ * The counter for each chunk is calculated from its address.
+ *
+ * @param section	[in] Encrypted section.
+ * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+ * @param ptr		[in,out] Data buffer.
+ * @param size		[in] Amount of data to decrypt. (must be a multiple of 16)
+ * @return Number of bytes decrypted, or 0 on error.
+ */
+size_t NCCHReaderPrivate::decryptSection(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size)
+{
+	assert(section->keyIdx < ARRAY_SIZE(ncch_ciphers));
+	assert(size % 16 == 0);
+	IAesCipher *const cipher = ncch_ciphers[section->keyIdx];
+	if (!cipher || size % 16 != 0)
+		return 0;
+
+	// Minimum amount of data per thread.
+	// Smaller reads are decrypted on the current thread,
+	// since the thread overhead isn't worth it.
+	static const size_t MT_CHUNK_SIZE_MIN = 1024*1024;
+
+	unsigned int threadCount = 1;
+	if (size >= MT_CHUNK_SIZE_MIN * 2) {
+		threadCount = Thread::hardwareConcurrency();
+		if (threadCount > MT_THREADS_MAX) {
+			threadCount = MT_THREADS_MAX;
+		}
+		const size_t maxThreadsForSize = size / MT_CHUNK_SIZE_MIN;
+		if (threadCount > maxThreadsForSize) {
+			threadCount = static_cast<unsigned int>(maxThreadsForSize);
+		}
+	}
+
+	if (threadCount <= 1) {
+		// Decrypt the data on the current thread.
+		u128_t ctr;
+		ctr.init_ctr(tid_be, section->section, offset - section->ctr_base);
+		cipher->setIV(ctr.u8, sizeof(ctr.u8));
+		return cipher->decrypt(ptr, size);
+	}
+
+	// Split the data into chunks. The first chunk is decrypted
+	// on the current thread using the cached cipher; the other
+	// chunks use the worker thread ciphers, since each cipher
+	// has its own counter.
+	// NOTE: The worker thread ciphers are retrieved here, since
+	// getWorkerCipher() isn't thread-safe.
+	IAesCipher *chunk_ciphers[MT_THREADS_MAX];
+	chunk_ciphers[0] = cipher;
+	for (unsigned int i = 1; i < threadCount; i++) {
+		chunk_ciphers[i] = getWorkerCipher(i, section->keyIdx);
+		if (!chunk_ciphers[i]) {
+			// Unable to create the cipher.
+			return 0;
+		}
+	}
+
+	const size_t chunk_size = ALIGN_BYTES(16, size / threadCount);
+	const uint8_t section_id = section->section;
+	const uint64_t tid = tid_be;
+	const uint32_t ctr_offset = offset - section->ctr_base;
+	size_t chunk_ret[MT_THREADS_MAX];
+
+	auto decryptChunk = [=, &chunk_ciphers, &chunk_ret](unsigned int i) {
+		const size_t chunk_pos = chunk_size * i;
+		const size_t chunk_len = (i == threadCount - 1 ? size - chunk_pos : chunk_size);
+
+		u128_t chunk_ctr;
+		chunk_ctr.init_ctr(tid, section_id, ctr_offset + static_cast<uint32_t>(chunk_pos));
+		IAesCipher *const chunk_cipher = chunk_ciphers[i];
+		chunk_cipher->setIV(chunk_ctr.u8, sizeof(chunk_ctr.u8));
+		chunk_ret[i] = chunk_cipher->decrypt(ptr + chunk_pos, chunk_len);
+	};
+
+	Thread threads[MT_THREADS_MAX];
+	for (unsigned int i = 1; i < threadCount; i++) {
+		int ret = threads[i].create([&decryptChunk, i]() { decryptChunk(i); });
+		if (ret != 0) {
+			// Unable to create a thread.
+			// Decrypt this chunk on the current thread.
+			decryptChunk(i);
+		}
+	}
+
+	// Decrypt the first chunk.
+	decryptChunk(0);
+
+	for (unsigned int i = 1; i < threadCount; i++) {
+		threads[i].join();
+	}
+
+	size_t sz_total = 0;
+	for (unsigned int i = 0; i < threadCount; i++) {
+		const size_t chunk_len = (i == threadCount - 1 ? size - (chunk_size * i) : chunk_size);
+		if (chunk_ret[i] != chunk_len) {
+			// Decryption error.
+			return 0;
+		}
+		sz_total += chunk_len;
+	}
+	return sz_total;
+}
 #endif /* ENABLE_DECRYPTION */
 
 /**
@@ -378,6 +605,9 @@ size_t NCCHReaderPrivate::readFromROM(uint32_t offset, void *ptr, size_t size)
 	// Seek to the start of the data and read it.
 	const off64_t phys_addr = ncch_offset + offset;
 	size_t sz_read;
+	if (initMutex) {
+		initMutex->lock();
+	}
 	if (q->m_hasDiscReader) {
 		sz_read = q->m_discReader->seekAndRead(phys_addr, ptr, size);
 	} else {
@@ -390,6 +620,9 @@ size_t NCCHReaderPrivate::readFromROM(uint32_t offset, void *ptr, size_t size)
 			q->m_lastError = EIO;
 		}
 	}
+	if (initMutex) {
+		initMutex->unlock();
+	}
 
 	// Data read successfully.
 	return sz_read;
@@ -494,16 +727,26 @@ int NCCHReaderPrivate::loadExHeader(void)
  * NOTE: The IRpFile *must* remain valid while this
  * NCCHReader is open.
  *
+ * If a mutex is specified, it's locked while reading from
+ * the IRpFile and while loading keys, so multiple NCCHReaders
+ * sharing the same IRpFile can be constructed concurrently.
+ * The mutex is not used after the constructor returns.
+ *
  * @param file 			[in] IRpFile. (for CCIs only)
  * @param media_unit_shift	[in] Media unit shift.
  * @param ncch_offset		[in] NCCH start offset, in bytes.
  * @param ncch_length		[in] NCCH length, in bytes.
+ * @param mutex			[in,opt] Mutex for file and KeyManager access during construction.
  */
 NCCHReader::NCCHReader(IRpFile *file, uint8_t media_unit_shift,
-		off64_t ncch_offset, uint32_t ncch_length)
+		off64_t ncch_offset, uint32_t ncch_length,
+		Mutex *mutex)
 	: super(file)
-	, d_ptr(new NCCHReaderPrivate(this, media_unit_shift, ncch_offset, ncch_length))
-{ }
+	, d_ptr(new NCCHReaderPrivate(this, media_unit_shift, ncch_offset, ncch_length, mutex))
+{
+	// The mutex is only needed during construction.
+	d_ptr->initMutex = nullptr;
+}
 
 /**
  * Construct an NCCHReader with the specified CIAReader.
@@ -518,12 +761,17 @@ NCCHReader::NCCHReader(IRpFile *file, uint8_t media_unit_shift,
  * @param ncch_length		[in] NCCH length, in bytes.
  * @param ticket		[in,opt] Ticket for CIA decryption. (nullptr if NoCrypto)
  * @param tmd_content_index	[in,opt] TMD content index for CIA decryption.
+ * @param mutex			[in,opt] Mutex for file and KeyManager access during construction.
  */
 NCCHReader::NCCHReader(CIAReader *ciaReader, uint8_t media_unit_shift,
-		off64_t ncch_offset, uint32_t ncch_length)
+		off64_t ncch_offset, uint32_t ncch_length,
+		Mutex *mutex)
 	: super(ciaReader)
-	, d_ptr(new NCCHReaderPrivate(this, media_unit_shift, ncch_offset, ncch_length))
-{ }
+	, d_ptr(new NCCHReaderPrivate(this, media_unit_shift, ncch_offset, ncch_length, mutex))
+{
+	// The mutex is only needed during construction.
+	d_ptr->initMutex = nullptr;
+}
 
 NCCHReader::~NCCHReader()
 {
@@ -612,18 +860,9 @@ size_t NCCHReader::read(void *ptr, size_t size)
 		size_t ret_sz = d->readFromROM(d->pos, ptr8, sz_to_read);
 
 		if (section && section->section > N3DS_NCCH_SECTION_PLAIN) {
-			// Set the required key.
-			// TODO: Don't set the key if it hasn't changed.
-			d->cipher->setKey(d->ncch_keys[section->keyIdx].u8, sizeof(d->ncch_keys[section->keyIdx].u8));
-
-			// Initialize the counter based on section and offset.
-			u128_t ctr;
-			ctr.init_ctr(d->tid_be, section->section, d->pos - section->ctr_base);
-			d->cipher->setIV(ctr.u8, sizeof(ctr.u8));
-
 			// Decrypt the data.
 			// FIXME: Round up to 16 if a short read occurred?
-			ret_sz = d->cipher->decrypt(static_cast<uint8_t*>(ptr), ret_sz);
+			ret_sz = d->decryptSection(section, d->pos, ptr8, ret_sz);
 		}
 
 		d->pos += static_cast<uint32_t>(ret_sz);
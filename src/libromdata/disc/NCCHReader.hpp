@@ -15,6 +15,10 @@
 #include "librpbase/disc/IPartition.hpp"
 #include "librpbase/crypto/KeyManager.hpp"
 
+namespace LibRpThreads {
+	class Mutex;
+}
+
 namespace LibRomData {
 
 class CIAReader;
@@ -29,14 +33,21 @@ class NCCHReader : public LibRpBase::IPartition
 		 * NOTE: The IRpFile *must* remain valid while this
 		 * NCCHReader is open.
 		 *
+		 * If a mutex is specified, it's locked while reading from
+		 * the IRpFile and while loading keys, so multiple NCCHReaders
+		 * sharing the same IRpFile can be constructed concurrently.
+		 * The mutex is not used after the constructor returns.
+		 *
 		 * @param file 			[in] IRpFile. (for CCIs only)
 		 * @param media_unit_shift	[in] Media unit shift.
 		 * @param ncch_offset		[in] NCCH start offset, in bytes.
 		 * @param ncch_length		[in] NCCH length, in bytes.
+		 * @param mutex			[in,opt] Mutex for file and KeyManager access during construction.
 		 */
 		NCCHReader(LibRpFile::IRpFile *file,
 			uint8_t media_unit_shift,
-			off64_t ncch_offset, uint32_t ncch_length);
+			off64_t ncch_offset, uint32_t ncch_length,
+			LibRpThreads::Mutex *mutex = nullptr);
 
 		/**
 		 * Construct an NCCHReader with the specified CIAReader.
@@ -49,10 +60,12 @@ class NCCHReader : public LibRpBase::IPartition
 		 * @param media_unit_shift	[in] Media unit shift.
 		 * @param ncch_offset		[in] NCCH start offset, in bytes.
 		 * @param ncch_length		[in] NCCH length, in bytes.
+		 * @param mutex			[in,opt] Mutex for file and KeyManager access during construction.
 		 */
 		NCCHReader(CIAReader *ciaReader,
 			uint8_t media_unit_shift,
-			off64_t ncch_offset, uint32_t ncch_length);
+			off64_t ncch_offset, uint32_t ncch_length,
+			LibRpThreads::Mutex *mutex = nullptr);
 	protected:
 		virtual ~NCCHReader();	// call unref() instead
 
@@ -16,6 +16,9 @@
 // librpbase
 #include "librpbase/crypto/KeyManager.hpp"
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
 #ifdef ENABLE_DECRYPTION
 #include "../crypto/CtrKeyScrambler.hpp"
 #include "../crypto/N3DSVerifyKeys.hpp"
@@ -39,7 +42,8 @@ class NCCHReaderPrivate
 {
 	public:
 		NCCHReaderPrivate(NCCHReader *q, uint8_t media_unit_shift,
-			off64_t ncch_offset, uint32_t ncch_length);
+			off64_t ncch_offset, uint32_t ncch_length,
+			LibRpThreads::Mutex *initMutex);
 		~NCCHReaderPrivate();
 
 	private:
@@ -53,6 +57,10 @@ class NCCHReaderPrivate
 		const uint32_t ncch_length;	// NCCH length, in bytes.
 		const uint8_t media_unit_shift;
 
+		// Mutex for file and KeyManager access.
+		// Only set while the NCCHReader is being constructed.
+		LibRpThreads::Mutex *initMutex;
+
 		// Current read position within the NCCH.
 		// pos = 0 indicates the beginning of the NCCH header.
 		// NOTE: This cannot be more than 4 GB,
@@ -119,8 +127,51 @@ class NCCHReaderPrivate
 		// Encryption keys.
 		u128_t ncch_keys[2];
 
-		// NCCH cipher.
-		LibRpBase::IAesCipher *cipher;
+		/**
+		 * Load the NCCH encryption keys into ncch_keys[].
+		 * initMutex is locked while accessing KeyManager.
+		 * @param issuer	[in] Issuer type. (N3DS_Ticket_TitleKey_KeyY)
+		 * @return VerifyResult.
+		 */
+		LibRpBase::KeyManager::VerifyResult loadNCCHKeys(uint8_t issuer);
+
+		// NCCH ciphers, one per ncch_keys[] entry.
+		// Keys are only set once, so the AES key schedule
+		// doesn't need to be recalculated for every read.
+		LibRpBase::IAesCipher *ncch_ciphers[2];
+
+		// Maximum number of threads for multi-threaded decryption.
+		static const unsigned int MT_THREADS_MAX = 8;
+
+		// Worker thread ciphers for multi-threaded decryption.
+		// Index: [worker thread - 1][ncch_keys[] index]
+		// (The first chunk is decrypted on the current thread
+		// using ncch_ciphers[].) Created on demand, and kept
+		// until the ciphers are freed so the keys are only
+		// set once per worker.
+		LibRpBase::IAesCipher *mt_ciphers[MT_THREADS_MAX - 1][2];
+
+		/**
+		 * Initialize the NCCH ciphers using the keys in ncch_keys[].
+		 * The ciphers are created if they haven't been created yet.
+		 * Worker thread ciphers that were already created are rekeyed.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int initCiphers(void);
+
+		/**
+		 * Get a worker thread cipher for multi-threaded decryption.
+		 * The cipher is created if it hasn't been created yet.
+		 * @param worker Worker thread index. (1 to MT_THREADS_MAX-1)
+		 * @param keyIdx ncch_keys[] index.
+		 * @return Cipher, or nullptr on error.
+		 */
+		LibRpBase::IAesCipher *getWorkerCipher(unsigned int worker, uint8_t keyIdx);
+
+		/**
+		 * Delete the NCCH ciphers, including the worker thread ciphers.
+		 */
+		void freeCiphers(void);
 
 		// Encrypted section addresses.
 		struct EncSection {
@@ -156,6 +207,21 @@ class NCCHReaderPrivate
 		 */
 		int findEncSection(uint32_t address) const;
 
+		/**
+		 * Decrypt data from an encrypted section.
+		 *
+		 * AES-CTR blocks are independent, so large buffers are
+		 * split into chunks and decrypted by multiple threads.
+		 * The counter for each chunk is calculated from its address.
+		 *
+		 * @param section	[in] Encrypted section.
+		 * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param ptr		[in,out] Data buffer.
+		 * @param size		[in] Amount of data to decrypt. (must be a multiple of 16)
+		 * @return Number of bytes decrypted, or 0 on error.
+		 */
+		size_t decryptSection(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size);
+
 		// TMD content index.
 		uint16_t tmd_content_index;
 
@@ -67,11 +67,12 @@ class XDVDFSPartitionPrivate
 		/**
 		 * XDVDFS strcasecmp() implementation.
 		 * Uses generic ASCII handling instead of locale-specific case folding.
-		 * @param s1 String 1
-		 * @param s2 String 2
+		 * @param s1 String 1 (NULL-terminated)
+		 * @param s2 String 2 (not necessarily NULL-terminated)
+		 * @param len2 Maximum length of s2
 		 * @return 0 (==), negative (<), or positive (>).
 		 */
-		static int xdvdfs_strcasecmp(const char *s1, const char *s2);
+		static int xdvdfs_strcasecmp(const char *s1, const char *s2, size_t len2);
 };
 
 /** XDVDFSPartitionPrivate **/
@@ -135,17 +136,22 @@ XDVDFSPartitionPrivate::~XDVDFSPartitionPrivate()
 /**
  * XDVDFS strcasecmp() implementation.
  * Uses generic ASCII handling instead of locale-specific case folding.
- * @param s1 String 1
- * @param s2 String 2
+ * @param s1 String 1 (NULL-terminated)
+ * @param s2 String 2 (not necessarily NULL-terminated)
+ * @param len2 Maximum length of s2
  * @return 0 (==), negative (<), or positive (>).
  */
-int XDVDFSPartitionPrivate::xdvdfs_strcasecmp(const char *s1, const char *s2)
+int XDVDFSPartitionPrivate::xdvdfs_strcasecmp(const char *s1, const char *s2, size_t len2)
 {
 	// Reference: https://github.com/XboxDev/extract-xiso/blob/master/extract-xiso.c
 	// av1_compare_key()
 	while (true) {
 		char a = *s1++;
-		char b = *s2++;
+		char b = '\0';
+		if (len2 > 0) {
+			b = *s2++;
+			len2--;
+		}
 
 		// Convert to uppercase.
 		if (a >= 'a' && a <= 'z') a &= ~0x20;
@@ -185,7 +191,6 @@ const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(const ao::uvector<uin
 	const uint8_t *const p_start = dirTable->data();
 	const uint8_t *const p_end = p_start + dirTable->size();
 	const uint8_t *p = p_start;
-	string s_entry_filename;	// Temporary for NULL termination.
 	while (p < p_end) {
 		const XDVDFS_DirEntry *dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(p);
 		const char *entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
@@ -194,14 +199,10 @@ const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(const ao::uvector<uin
 			break;
 		}
 
-		// NOTE: Filename might not be NULL-terminated.
-		// Temporarily cache the filename.
-		s_entry_filename.assign(entry_filename, dirEntry->name_length);
-
 		// Check the filename.
-		// TODO: Use non-locale-specific case-insensitive check? (only letters)
+		// NOTE: Filename might not be NULL-terminated.
 		uint16_t subtree_offset = 0;
-		int cmp = xdvdfs_strcasecmp(s_filename.c_str(), s_entry_filename.c_str());
+		int cmp = xdvdfs_strcasecmp(s_filename.c_str(), entry_filename, dirEntry->name_length);
 		if (cmp == 0) {
 			// Found it!
 			dirEntry_found = dirEntry;
@@ -0,0 +1,1380 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CacheIndex.cpp: Download cache index.                                   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CacheIndex.hpp"
+
+// librpbase, librpfile, librpthreads
+#include "librpbase/config/Config.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
+#include "librpthreads/pthread_once.h"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Thread;
+
+// libcachecommon
+#include "libcachecommon/CacheDir.hpp"
+
+// OS-specific includes.
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "librpbase/TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+# include <dirent.h>
+# include <fcntl.h>
+# include <sys/file.h>
+# include <unistd.h>
+# ifndef O_CLOEXEC
+#  define O_CLOEXEC 0
+# endif
+#endif /* _WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+using std::pair;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+namespace LibRomData {
+
+/**
+ * Advisory lock for the on-disk index.
+ *
+ * A separate lock file is used, since the index file
+ * is replaced when it's compacted.
+ *
+ * NOTE: On POSIX systems, flock() is used instead of fcntl(),
+ * since fcntl() locks don't conflict within the same process.
+ */
+class CacheIndexLock
+{
+	public:
+		explicit CacheIndexLock(const string &filename);
+		~CacheIndexLock();
+
+	private:
+		RP_DISABLE_COPY(CacheIndexLock)
+
+	public:
+		/**
+		 * Obtain the lock.
+		 * @param wait If true, wait for the lock; otherwise, fail if it's held by someone else.
+		 * @return 0 on success; negative POSIX error code on error. (-EBUSY if !wait and the lock is held)
+		 */
+		int lock(bool wait);
+
+	private:
+#ifdef _WIN32
+		HANDLE m_hFile;
+#else /* !_WIN32 */
+		int m_fd;
+#endif /* _WIN32 */
+		bool m_isLocked;
+};
+
+CacheIndexLock::CacheIndexLock(const string &filename)
+	: m_isLocked(false)
+{
+#ifdef _WIN32
+	m_hFile = CreateFile(U82T_s(filename).c_str(),
+		GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else /* !_WIN32 */
+	m_fd = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+#endif /* _WIN32 */
+}
+
+CacheIndexLock::~CacheIndexLock()
+{
+#ifdef _WIN32
+	if (m_hFile != INVALID_HANDLE_VALUE) {
+		if (m_isLocked) {
+			OVERLAPPED ov;
+			memset(&ov, 0, sizeof(ov));
+			UnlockFileEx(m_hFile, 0, 1, 0, &ov);
+		}
+		CloseHandle(m_hFile);
+	}
+#else /* !_WIN32 */
+	if (m_fd >= 0) {
+		// NOTE: close() releases the lock.
+		close(m_fd);
+	}
+#endif /* _WIN32 */
+}
+
+/**
+ * Obtain the lock.
+ * @param wait If true, wait for the lock; otherwise, fail if it's held by someone else.
+ * @return 0 on success; negative POSIX error code on error. (-EBUSY if !wait and the lock is held)
+ */
+int CacheIndexLock::lock(bool wait)
+{
+	assert(!m_isLocked);
+#ifdef _WIN32
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return -EBADF;
+
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	const DWORD dwFlags = LOCKFILE_EXCLUSIVE_LOCK | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+	if (!LockFileEx(m_hFile, dwFlags, 0, 1, 0, &ov)) {
+		return (GetLastError() == ERROR_LOCK_VIOLATION ? -EBUSY : -EIO);
+	}
+#else /* !_WIN32 */
+	if (m_fd < 0)
+		return -EBADF;
+
+	int ret;
+	do {
+		ret = flock(m_fd, LOCK_EX | (wait ? 0 : LOCK_NB));
+	} while (ret != 0 && errno == EINTR);
+	if (ret != 0) {
+		return (errno == EWOULDBLOCK ? -EBUSY : -errno);
+	}
+#endif /* _WIN32 */
+
+	m_isLocked = true;
+	return 0;
+}
+
+class CacheIndexPrivate
+{
+	public:
+		CacheIndexPrivate();
+		~CacheIndexPrivate();
+
+	private:
+		RP_DISABLE_COPY(CacheIndexPrivate)
+
+	public:
+		// Singleton instance.
+		// NOTE: Never deleted. Deleting it from a static destructor
+		// would join the worker thread and write to the disk while
+		// the library is being unloaded, which can deadlock on
+		// Windows. Use CacheIndex::shutdown() at program exit.
+		static CacheIndex *instance;
+		static pthread_once_t once_control;
+
+		/**
+		 * Initialize the singleton instance.
+		 * Internal function; must be called using pthread_once().
+		 */
+		static void initInstance(void);
+
+	public:
+		// Index filename, relative to the cache directory.
+		static const char index_filename[];
+		// Lock filename, relative to the cache directory.
+		static const char lock_filename[];
+		// Index file header.
+		static const char index_header[];
+		// Index file header. (v1; no generation number)
+		static const char index_header_v1[];
+
+		// Write pending updates after this many updates...
+		static const unsigned int SAVE_UPDATE_COUNT = 32;
+		// ...or if this many seconds have elapsed since the last write.
+		static const time_t SAVE_INTERVAL = 60;
+
+		// Compact the on-disk index if it has this many
+		// more records than there are index entries.
+		static const unsigned int COMPACT_RECORD_SLACK = 1024;
+
+		// Index entry.
+		struct Entry {
+			time_t atime;	// Last access time
+			off64_t size;	// File size
+		};
+		typedef unordered_map<string, Entry> EntryMap;
+
+		Mutex mutex;		// Protects all fields below.
+		string cache_dir;	// Cache directory, with trailing separator
+		EntryMap entries;	// Key: filename relative to cache_dir
+		uint64_t total_size;	// Total size of all entries
+
+		// Statistics.
+		// Totals include the pending values, which haven't
+		// been written to the on-disk index yet.
+		uint64_t hits, misses, bytes_saved;
+		uint64_t pending_hits, pending_misses, pending_bytes_saved;
+
+		// Pending index records that haven't been written yet.
+		// These have already been applied to entries and the statistics.
+		string pending;
+		unsigned int pending_count;	// Number of records in pending
+		time_t last_save;		// Time of the last write
+
+		// On-disk index state.
+		uint64_t file_gen;		// Generation number
+		off64_t file_offset;		// Number of bytes that have been read
+		unsigned int file_records;	// Number of records in the file
+		bool needs_compact;		// Should the on-disk index be rewritten?
+
+		// Worker thread. Used for eviction and compaction.
+		// Started on demand, and exits once there's no more work.
+		Thread worker;
+		bool worker_running;		// Worker thread is running
+		bool worker_stop;		// Worker thread should not be started
+		bool evict_requested;
+		bool compact_requested;
+		bool evicting;			// Eviction is requested or in progress
+		uint64_t evict_max_size;	// Maximum cache size for eviction
+		uint32_t evict_max_entries;	// Maximum number of entries for eviction
+
+	public:
+		/**
+		 * Get the index key for a cache filename.
+		 * @param filename	[in] Cache filename.
+		 * @param key		[out] Index key.
+		 * @return True on success; false if the file isn't in the cache directory.
+		 */
+		bool filenameToKey(const string &filename, string &key) const;
+
+		/**
+		 * Set an index entry.
+		 * Caller must hold the mutex.
+		 * @param key Index key.
+		 * @param atime Access time.
+		 * @param size File size.
+		 */
+		void setEntry_locked(const string &key, time_t atime, off64_t size);
+
+		/**
+		 * Remove an index entry.
+		 * Caller must hold the mutex.
+		 * @param iter Entry iterator.
+		 */
+		void eraseEntry_locked(EntryMap::iterator iter);
+
+		/**
+		 * Apply an index record.
+		 * Caller must hold the mutex.
+		 * @param line Record, without the trailing newline.
+		 * @return True if this was a valid record; false if not.
+		 */
+		bool applyRecord_locked(const char *line);
+
+		/**
+		 * Apply index records.
+		 * Caller must hold the mutex.
+		 * @param buf	[in] Buffer containing the records.
+		 * @param len	[in] Length of buf.
+		 * @param pRecords [out,opt] Number of records.
+		 * @return Number of bytes consumed. (Incomplete lines aren't consumed.)
+		 */
+		size_t applyRecords_locked(const char *buf, size_t len, unsigned int *pRecords = nullptr);
+
+		/**
+		 * Append a record to the pending records.
+		 * Caller must hold the mutex.
+		 * @param type Record type.
+		 * @param atime Access time.
+		 * @param size File size.
+		 * @param key Index key.
+		 */
+		void addPending_locked(char type, time_t atime, off64_t size, const string &key);
+
+		/**
+		 * Read new records from the on-disk index.
+		 * If the index was replaced, it's reloaded, and the
+		 * pending records are applied again.
+		 * This does not write anything.
+		 * Caller must hold the mutex.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int refresh_locked(void);
+
+		/**
+		 * Rebuild the index by scanning the cache directory.
+		 * Access times are initialized using the files' modification times.
+		 * @param rel_path Path relative to cache_dir, with trailing separator. (empty for the cache directory itself)
+		 */
+		void scanDirectory(const string &rel_path);
+
+		/**
+		 * Update an entry and record a hit or a miss.
+		 * Caller must hold the mutex.
+		 * @param key Index key.
+		 * @param size File size.
+		 * @param hit True for a hit; false for a miss.
+		 */
+		void updateEntry_locked(const string &key, off64_t size, bool hit);
+
+		/**
+		 * Append the pending records to the on-disk index.
+		 * Caller must hold the mutex.
+		 * @param wait If true, wait for the index lock; otherwise, keep the records pending if it's busy.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int flush_locked(bool wait);
+
+		/**
+		 * Rewrite the on-disk index using the current entries.
+		 * This removes records that have been superseded.
+		 * The mutex must NOT be held by the caller.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int compact(void);
+
+		/**
+		 * Check if the cache is over its limits.
+		 * If it is, request eviction on the worker thread.
+		 * Caller must hold the mutex.
+		 */
+		void checkLimits_locked(void);
+
+		/**
+		 * Request work from the worker thread.
+		 * The worker thread is started if it isn't running.
+		 * Caller must hold the mutex.
+		 */
+		void wakeWorker_locked(void);
+
+		/**
+		 * Worker thread function.
+		 * @param param CacheIndexPrivate
+		 */
+		static void workerThread(void *param);
+
+		/**
+		 * Evict the least-recently used files until the
+		 * cache is below 90% of its limits.
+		 * This is run on the worker thread.
+		 * @param max_size Maximum cache size, in bytes. (0 for no limit)
+		 * @param max_entries Maximum number of entries. (0 for no limit)
+		 */
+		void evict(uint64_t max_size, uint32_t max_entries);
+};
+
+/** CacheIndexPrivate **/
+
+CacheIndex *CacheIndexPrivate::instance = nullptr;
+pthread_once_t CacheIndexPrivate::once_control = PTHREAD_ONCE_INIT;
+
+const char CacheIndexPrivate::index_filename[] = "cache.idx";
+const char CacheIndexPrivate::lock_filename[] = "cache.idx.lock";
+const char CacheIndexPrivate::index_header[] = "# rom-properties cache index v2";
+const char CacheIndexPrivate::index_header_v1[] = "# rom-properties cache index v1";
+
+/**
+ * On-disk index format:
+ *
+ * The first line is the header, followed by a tab and the generation
+ * number. The generation number is incremented every time the index
+ * is compacted, which lets other processes detect that the index was
+ * replaced and needs to be reloaded.
+ *
+ * Each subsequent line is a record. Records are appended to the index
+ * while holding the advisory lock, so updating the index only requires
+ * writing the new records.
+ * - stats\thits\tmisses\tbytes_saved: Base statistics.
+ * - atime\tsize\tkey: Index entry.
+ * - H\tatime\tsize\tkey: Cache hit. Sets the entry and updates the statistics.
+ * - M\tatime\tsize\tkey: Cache miss. Sets the entry and updates the statistics.
+ * - D\ttime\tkey: Entry was removed. Ignored if the entry was accessed after the given time.
+ *
+ * Invalid lines are ignored.
+ */
+
+CacheIndexPrivate::CacheIndexPrivate()
+	: total_size(0)
+	, hits(0), misses(0), bytes_saved(0)
+	, pending_hits(0), pending_misses(0), pending_bytes_saved(0)
+	, pending_count(0)
+	, last_save(0)
+	, file_gen(0)
+	, file_offset(0)
+	, file_records(0)
+	, needs_compact(false)
+	, worker_running(false)
+	, worker_stop(false)
+	, evict_requested(false)
+	, compact_requested(false)
+	, evicting(false)
+	, evict_max_size(0)
+	, evict_max_entries(0)
+{
+	// NOTE: May be empty if the cache directory isn't
+	// accessible, e.g. when running under bubblewrap.
+	cache_dir = LibCacheCommon::getCacheDirectory();
+	if (cache_dir.empty()) {
+		return;
+	}
+	if (cache_dir.at(cache_dir.size()-1) != DIR_SEP_CHR) {
+		cache_dir += DIR_SEP_CHR;
+	}
+
+	// Load the index.
+	// NOTE: The mutex doesn't need to be locked here,
+	// since this is called using pthread_once().
+	last_save = time(nullptr);
+	if (refresh_locked() == -ENOENT) {
+		// No index file. Rebuild it.
+		// NOTE: The rebuilt index isn't written until the
+		// index is updated, so read-only users such as
+		// `rpcli -s` don't write to the cache directory.
+		scanDirectory(string());
+		needs_compact = true;
+	}
+}
+
+CacheIndexPrivate::~CacheIndexPrivate()
+{
+	// NOTE: The singleton instance is never deleted.
+	// CacheIndex::shutdown() stops the worker thread
+	// and writes pending records.
+}
+
+/**
+ * Initialize the singleton instance.
+ * Internal function; must be called using pthread_once().
+ */
+void CacheIndexPrivate::initInstance(void)
+{
+	instance = new CacheIndex();
+}
+
+/**
+ * Get the index key for a cache filename.
+ * @param filename	[in] Cache filename.
+ * @param key		[out] Index key.
+ * @return True on success; false if the file isn't in the cache directory.
+ */
+bool CacheIndexPrivate::filenameToKey(const string &filename, string &key) const
+{
+	if (cache_dir.empty() || filename.size() <= cache_dir.size() ||
+	    filename.compare(0, cache_dir.size(), cache_dir) != 0)
+	{
+		// Not in the user's cache directory.
+		// This may be the system-wide cache directory.
+		return false;
+	}
+
+	key.assign(filename, cache_dir.size(), string::npos);
+	return true;
+}
+
+/**
+ * Set an index entry.
+ * Caller must hold the mutex.
+ * @param key Index key.
+ * @param atime Access time.
+ * @param size File size.
+ */
+void CacheIndexPrivate::setEntry_locked(const string &key, time_t atime, off64_t size)
+{
+	auto result = entries.emplace(key, Entry());
+	Entry &entry = result.first->second;
+	if (!result.second) {
+		total_size -= entry.size;
+	}
+	entry.atime = atime;
+	entry.size = size;
+	total_size += size;
+}
+
+/**
+ * Remove an index entry.
+ * Caller must hold the mutex.
+ * @param iter Entry iterator.
+ */
+void CacheIndexPrivate::eraseEntry_locked(EntryMap::iterator iter)
+{
+	total_size -= iter->second.size;
+	entries.erase(iter);
+}
+
+/**
+ * Apply an index record.
+ * Caller must hold the mutex.
+ * @param line Record, without the trailing newline.
+ * @return True if this was a valid record; false if not.
+ */
+bool CacheIndexPrivate::applyRecord_locked(const char *line)
+{
+	const char *p = line;
+	char *endptr;
+
+	if (!strncmp(p, "stats\t", 6)) {
+		// Base statistics.
+		uint64_t stats[3] = {0, 0, 0};
+		p += 6;
+		for (unsigned int i = 0; i < 3; i++) {
+			stats[i] = strtoull(p, &endptr, 10);
+			if (*endptr != '\t' && *endptr != '\0')
+				return false;
+			p = (*endptr == '\t' ? endptr + 1 : endptr);
+		}
+		hits = stats[0];
+		misses = stats[1];
+		bytes_saved = stats[2];
+		return true;
+	}
+
+	char type = '\0';
+	if ((p[0] == 'H' || p[0] == 'M' || p[0] == 'D') && p[1] == '\t') {
+		type = p[0];
+		p += 2;
+	}
+
+	const time_t atime = static_cast<time_t>(strtoll(p, &endptr, 10));
+	if (*endptr != '\t')
+		return false;
+	p = endptr + 1;
+
+	if (type == 'D') {
+		// Entry was removed.
+		// If the entry was accessed after it was removed,
+		// it was downloaded again, so keep it.
+		if (*p == '\0')
+			return false;
+		auto iter = entries.find(p);
+		if (iter != entries.end() && iter->second.atime <= atime) {
+			eraseEntry_locked(iter);
+		}
+		return true;
+	}
+
+	const off64_t size = static_cast<off64_t>(strtoll(p, &endptr, 10));
+	if (*endptr != '\t' || size < 0)
+		return false;
+	p = endptr + 1;
+	if (*p == '\0')
+		return false;
+
+	setEntry_locked(p, atime, size);
+	if (type == 'H') {
+		hits++;
+		bytes_saved += size;
+	} else if (type == 'M') {
+		misses++;
+	}
+	return true;
+}
+
+/**
+ * Apply index records.
+ * Caller must hold the mutex.
+ * @param buf	[in] Buffer containing the records.
+ * @param len	[in] Length of buf.
+ * @param pRecords [out,opt] Number of records.
+ * @return Number of bytes consumed. (Incomplete lines aren't consumed.)
+ */
+size_t CacheIndexPrivate::applyRecords_locked(const char *buf, size_t len, unsigned int *pRecords)
+{
+	unsigned int records = 0;
+	size_t pos = 0;
+	string line;
+	while (pos < len) {
+		const char *const eol = static_cast<const char*>(memchr(&buf[pos], '\n', len - pos));
+		if (!eol) {
+			// Incomplete line.
+			break;
+		}
+		line.assign(&buf[pos], eol - &buf[pos]);
+		pos = (eol - buf) + 1;
+		if (applyRecord_locked(line.c_str())) {
+			records++;
+		}
+	}
+
+	if (pRecords) {
+		*pRecords = records;
+	}
+	return pos;
+}
+
+/**
+ * Append a record to the pending records.
+ * Caller must hold the mutex.
+ * @param type Record type.
+ * @param atime Access time.
+ * @param size File size.
+ * @param key Index key.
+ */
+void CacheIndexPrivate::addPending_locked(char type, time_t atime, off64_t size, const string &key)
+{
+	char buf[64];
+	if (type == 'D') {
+		snprintf(buf, sizeof(buf), "D\t%lld\t", static_cast<long long>(atime));
+	} else {
+		snprintf(buf, sizeof(buf), "%c\t%lld\t%lld\t", type,
+			static_cast<long long>(atime), static_cast<long long>(size));
+	}
+	pending += buf;
+	pending += key;
+	pending += '\n';
+	pending_count++;
+}
+
+/**
+ * Read new records from the on-disk index.
+ * If the index was replaced, it's reloaded, and the
+ * pending records are applied again.
+ * This does not write anything.
+ * Caller must hold the mutex.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheIndexPrivate::refresh_locked(void)
+{
+	if (cache_dir.empty()) {
+		return -ENOENT;
+	}
+
+	RpFile *const file = new RpFile(cache_dir + index_filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		const int err = file->lastError();
+		file->unref();
+		if (file_gen != 0) {
+			// Index file was deleted.
+			// Rewrite it the next time it's updated.
+			file_gen = 0;
+			file_offset = 0;
+			file_records = 0;
+			needs_compact = true;
+		}
+		return (err != 0 ? -err : -EIO);
+	}
+
+	// The index is limited to 64 MB.
+	const off64_t fileSize = file->size();
+	if (fileSize <= 0 || fileSize > 64*1024*1024) {
+		file->unref();
+		return -EIO;
+	}
+
+	// Check the header and generation number.
+	char hdr[64];
+	const size_t hdr_size = file->seekAndRead(0, hdr, sizeof(hdr) - 1);
+	hdr[hdr_size] = '\0';
+	char *const hdr_eol = strchr(hdr, '\n');
+	if (!hdr_eol) {
+		file->unref();
+		return -EIO;
+	}
+	*hdr_eol = '\0';
+	const off64_t hdr_len = (hdr_eol - hdr) + 1;
+	const size_t index_header_len = sizeof(index_header) - 1;
+	uint64_t gen;
+	if (!strncmp(hdr, index_header, index_header_len) && hdr[index_header_len] == '\t') {
+		gen = strtoull(&hdr[index_header_len + 1], nullptr, 10);
+	} else if (!strcmp(hdr, index_header_v1)) {
+		// v1 index. Records are compatible, but there's
+		// no generation number, so it has to be rewritten
+		// before it can be appended to.
+		gen = 0;
+	} else {
+		// Not a valid index file.
+		file->unref();
+		return -EIO;
+	}
+
+	bool reloaded = false;
+	if (gen == 0 || gen != file_gen || fileSize < file_offset) {
+		// Index was replaced. Reload it.
+		entries.clear();
+		total_size = 0;
+		hits = 0;
+		misses = 0;
+		bytes_saved = 0;
+		file_offset = hdr_len;
+		file_records = 0;
+		file_gen = gen;
+		if (gen == 0) {
+			needs_compact = true;
+		}
+		reloaded = true;
+	}
+
+	if (fileSize > file_offset) {
+		string buf;
+		buf.resize(static_cast<size_t>(fileSize - file_offset));
+		const size_t size = file->seekAndRead(file_offset, &buf[0], buf.size());
+		buf.resize(size);
+		unsigned int records = 0;
+		file_offset += applyRecords_locked(buf.data(), buf.size(), &records);
+		file_records += records;
+	}
+	file->unref();
+
+	if (reloaded && !pending.empty()) {
+		// The pending records have to be applied
+		// after the on-disk records.
+		// NOTE: Not counting them in file_records.
+		applyRecords_locked(pending.data(), pending.size());
+	}
+	return 0;
+}
+
+/**
+ * Rebuild the index by scanning the cache directory.
+ * Access times are initialized using the files' modification times.
+ * @param rel_path Path relative to cache_dir, with trailing separator. (empty for the cache directory itself)
+ */
+void CacheIndexPrivate::scanDirectory(const string &rel_path)
+{
+	vector<pair<string, bool> > dir_entries;	// Name, is directory
+	const string path = cache_dir + rel_path;
+
+#ifdef _WIN32
+	WIN32_FIND_DATA ffd;
+	HANDLE hFind = FindFirstFile((U82T_s(path) + _T('*')).c_str(), &ffd);
+	if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if (ffd.cFileName[0] == _T('.') &&
+		    (ffd.cFileName[1] == _T('\0') ||
+		     (ffd.cFileName[1] == _T('.') && ffd.cFileName[2] == _T('\0'))))
+		{
+			// "." or ".."
+			continue;
+		}
+		dir_entries.emplace_back(T2U8(ffd.cFileName),
+			!!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY));
+	} while (FindNextFile(hFind, &ffd));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *const dir = opendir(path.c_str());
+	if (!dir) {
+		return;
+	}
+	struct dirent *dirent;
+	while ((dirent = readdir(dir)) != nullptr) {
+		if (dirent->d_name[0] == '.' &&
+		    (dirent->d_name[1] == '\0' ||
+		     (dirent->d_name[1] == '.' && dirent->d_name[2] == '\0')))
+		{
+			// "." or ".."
+			continue;
+		}
+		bool is_dir;
+# ifdef _DIRENT_HAVE_D_TYPE
+		if (dirent->d_type != DT_UNKNOWN) {
+			is_dir = (dirent->d_type == DT_DIR);
+		} else
+# endif /* _DIRENT_HAVE_D_TYPE */
+		{
+			off64_t size;
+			time_t mtime;
+			is_dir = (FileSystem::get_file_size_and_mtime(path + dirent->d_name, &size, &mtime) == -EISDIR);
+		}
+		dir_entries.emplace_back(dirent->d_name, is_dir);
+	}
+	closedir(dir);
+#endif /* _WIN32 */
+
+	for (const auto &p : dir_entries) {
+		if (p.second) {
+			scanDirectory(rel_path + p.first + DIR_SEP_CHR);
+			continue;
+		}
+		if (rel_path.empty()) {
+			// Files in the root of the cache directory
+			// are not cache files, e.g. the index itself.
+			continue;
+		}
+
+		off64_t size;
+		time_t mtime;
+		if (FileSystem::get_file_size_and_mtime(path + p.first, &size, &mtime) != 0) {
+			continue;
+		}
+		setEntry_locked(rel_path + p.first, mtime, size);
+	}
+}
+
+/**
+ * Update an entry and record a hit or a miss.
+ * Caller must hold the mutex.
+ * @param key Index key.
+ * @param size File size.
+ * @param hit True for a hit; false for a miss.
+ */
+void CacheIndexPrivate::updateEntry_locked(const string &key, off64_t size, bool hit)
+{
+	const time_t now = time(nullptr);
+	setEntry_locked(key, now, size);
+	addPending_locked(hit ? 'H' : 'M', now, size, key);
+
+	if (hit) {
+		hits++;
+		pending_hits++;
+		bytes_saved += size;
+		pending_bytes_saved += size;
+	} else {
+		misses++;
+		pending_misses++;
+	}
+}
+
+/**
+ * Append the pending records to the on-disk index.
+ * Caller must hold the mutex.
+ * @param wait If true, wait for the index lock; otherwise, keep the records pending if it's busy.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheIndexPrivate::flush_locked(bool wait)
+{
+	if (cache_dir.empty()) {
+		return -ENOENT;
+	} else if (pending.empty()) {
+		// Nothing to write.
+		return 0;
+	}
+
+	if (needs_compact) {
+		// The on-disk index needs to be rewritten.
+		// This is done on the worker thread.
+		if (!compact_requested) {
+			compact_requested = true;
+			wakeWorker_locked();
+		}
+		return 0;
+	}
+
+	CacheIndexLock indexLock(cache_dir + lock_filename);
+	int ret = indexLock.lock(wait);
+	if (ret != 0) {
+		// Lock is busy. Try again later.
+		return ret;
+	}
+
+	// Read records from other processes first so file_offset
+	// points to the end of the index.
+	ret = refresh_locked();
+	if (ret != 0 || needs_compact) {
+		// Index is missing or needs to be rewritten.
+		if (!compact_requested) {
+			compact_requested = true;
+			wakeWorker_locked();
+		}
+		return ret;
+	}
+
+	RpFile *const file = new RpFile(cache_dir + index_filename, RpFile::FM_OPEN_WRITE);
+	if (!file->isOpen()) {
+		const int err = file->lastError();
+		file->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+
+	// If the index ends with an incomplete line, e.g. due to a crash,
+	// terminate it so the first pending record isn't corrupted.
+	const off64_t fileSize = file->size();
+	size_t size;
+	if (fileSize > file_offset) {
+		const string buf = '\n' + pending;
+		size = file->seekAndWrite(fileSize, buf.data(), buf.size());
+		size = (size == buf.size() ? pending.size() : 0);
+	} else {
+		size = file->seekAndWrite(fileSize, pending.data(), pending.size());
+	}
+	file->unref();
+	if (size != pending.size()) {
+		// Write error.
+		// NOTE: The records will be read back and applied
+		// again if they were partially written.
+		return -EIO;
+	}
+
+	file_offset = fileSize + static_cast<off64_t>(pending.size()) + (fileSize > file_offset ? 1 : 0);
+	file_records += pending_count;
+	pending.clear();
+	pending_count = 0;
+	pending_hits = 0;
+	pending_misses = 0;
+	pending_bytes_saved = 0;
+	last_save = time(nullptr);
+
+	if (file_records > entries.size() + COMPACT_RECORD_SLACK && !compact_requested) {
+		// Too many superseded records. Rewrite the index.
+		compact_requested = true;
+		wakeWorker_locked();
+	}
+	return 0;
+}
+
+/**
+ * Rewrite the on-disk index using the current entries.
+ * This removes records that have been superseded.
+ * The mutex must NOT be held by the caller.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheIndexPrivate::compact(void)
+{
+	if (cache_dir.empty()) {
+		return -ENOENT;
+	}
+
+	// Hold the index lock until the new index is in place
+	// so other processes don't append to the old one.
+	CacheIndexLock indexLock(cache_dir + lock_filename);
+	int ret = indexLock.lock(true);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Take a snapshot of the index.
+	// The pending records are included in the snapshot,
+	// so they're moved aside while the index is written.
+	string buf;
+	uint64_t new_gen;
+	unsigned int new_records;
+	string old_pending;
+	unsigned int old_pending_count;
+	uint64_t old_pending_stats[3];
+	{
+		MutexLocker locker(mutex);
+		refresh_locked();
+		new_gen = file_gen + 1;
+		new_records = static_cast<unsigned int>(entries.size()) + 1;
+
+		buf.reserve(64 + (entries.size() * 48));
+		char line[96];
+		snprintf(line, sizeof(line), "%s\t%llu\n", index_header,
+			static_cast<unsigned long long>(new_gen));
+		buf += line;
+		snprintf(line, sizeof(line), "stats\t%llu\t%llu\t%llu\n",
+			static_cast<unsigned long long>(hits),
+			static_cast<unsigned long long>(misses),
+			static_cast<unsigned long long>(bytes_saved));
+		buf += line;
+		for (const auto &p : entries) {
+			snprintf(line, sizeof(line), "%lld\t%lld\t",
+				static_cast<long long>(p.second.atime),
+				static_cast<long long>(p.second.size));
+			buf += line;
+			buf += p.first;
+			buf += '\n';
+		}
+
+		old_pending.swap(pending);
+		old_pending_count = pending_count;
+		old_pending_stats[0] = pending_hits;
+		old_pending_stats[1] = pending_misses;
+		old_pending_stats[2] = pending_bytes_saved;
+		pending_count = 0;
+		pending_hits = 0;
+		pending_misses = 0;
+		pending_bytes_saved = 0;
+	}
+
+	// Write the index to a temporary file, then rename it.
+	// NOTE: Not holding the mutex here, since this might take a while.
+	const string filename = cache_dir + index_filename;
+	char tmp_ext[32];
+#ifdef _WIN32
+	snprintf(tmp_ext, sizeof(tmp_ext), ".%lu.tmp", static_cast<unsigned long>(GetCurrentProcessId()));
+#else /* !_WIN32 */
+	snprintf(tmp_ext, sizeof(tmp_ext), ".%ld.tmp", static_cast<long>(getpid()));
+#endif /* _WIN32 */
+	const string tmp_filename = filename + tmp_ext;
+
+	RpFile *const file = new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		ret = file->lastError();
+		ret = (ret != 0 ? -ret : -EIO);
+		file->unref();
+	} else {
+		const size_t size = file->write(buf.data(), buf.size());
+		file->unref();
+		ret = (size == buf.size() ? 0 : -EIO);
+		if (ret == 0) {
+			ret = FileSystem::rename(tmp_filename, filename);
+		}
+		if (ret != 0) {
+			FileSystem::delete_file(tmp_filename);
+		}
+	}
+
+	MutexLocker locker(mutex);
+	if (ret != 0) {
+		// Unable to write the index.
+		// Restore the pending records.
+		pending = old_pending + pending;
+		pending_count += old_pending_count;
+		pending_hits += old_pending_stats[0];
+		pending_misses += old_pending_stats[1];
+		pending_bytes_saved += old_pending_stats[2];
+		return ret;
+	}
+
+	file_gen = new_gen;
+	file_offset = static_cast<off64_t>(buf.size());
+	file_records = new_records;
+	needs_compact = false;
+	last_save = time(nullptr);
+	return 0;
+}
+
+/**
+ * Check if the cache is over its limits.
+ * If it is, request eviction on the worker thread.
+ * Caller must hold the mutex.
+ */
+void CacheIndexPrivate::checkLimits_locked(void)
+{
+	if (evicting) {
+		// Eviction is already in progress.
+		return;
+	}
+
+	const Config *const config = Config::instance();
+	const uint64_t max_size = static_cast<uint64_t>(config->cacheMaxSizeMB()) * 1024U * 1024U;
+	const uint32_t max_entries = config->cacheMaxEntries();
+
+	if ((max_entries == 0 || entries.size() <= max_entries) &&
+	    (max_size == 0 || total_size <= max_size))
+	{
+		// Cache is within its limits.
+		return;
+	}
+
+	evicting = true;
+	evict_requested = true;
+	evict_max_size = max_size;
+	evict_max_entries = max_entries;
+	wakeWorker_locked();
+}
+
+/**
+ * Request work from the worker thread.
+ * The worker thread is started if it isn't running.
+ * Caller must hold the mutex.
+ */
+void CacheIndexPrivate::wakeWorker_locked(void)
+{
+	if (worker_stop) {
+		// Worker thread is shutting down.
+		return;
+	}
+
+	if (worker_running) {
+		// The worker thread checks for new requests
+		// before it exits, so it will handle this one.
+		return;
+	}
+
+	if (worker.isJoinable()) {
+		// The previous worker thread has exited, or is about to.
+		// NOTE: It doesn't lock the mutex after clearing
+		// worker_running, so this won't deadlock.
+		worker.join();
+	}
+	if (worker.create(workerThread, this) != 0) {
+		// Unable to create the thread.
+		// Try again on the next request.
+		evicting = false;
+		evict_requested = false;
+		compact_requested = false;
+		return;
+	}
+	worker_running = true;
+}
+
+/**
+ * Worker thread function.
+ * @param param CacheIndexPrivate
+ */
+void CacheIndexPrivate::workerThread(void *param)
+{
+	CacheIndexPrivate *const d = static_cast<CacheIndexPrivate*>(param);
+
+	while (true) {
+		d->mutex.lock();
+		if (d->worker_stop || (!d->evict_requested && !d->compact_requested)) {
+			// No more work. Exit the thread so it doesn't
+			// have to be stopped when the library is unloaded.
+			d->worker_running = false;
+			d->mutex.unlock();
+			break;
+		}
+		const bool doEvict = d->evict_requested;
+		const bool doCompact = d->compact_requested;
+		const uint64_t max_size = d->evict_max_size;
+		const uint32_t max_entries = d->evict_max_entries;
+		d->evict_requested = false;
+		d->compact_requested = false;
+		d->mutex.unlock();
+
+		if (doEvict) {
+			d->evict(max_size, max_entries);
+		}
+		if (doCompact) {
+			d->compact();
+		}
+	}
+}
+
+/**
+ * Evict the least-recently used files until the
+ * cache is below 90% of its limits.
+ * This is run on the worker thread.
+ * @param max_size Maximum cache size, in bytes. (0 for no limit)
+ * @param max_entries Maximum number of entries. (0 for no limit)
+ */
+void CacheIndexPrivate::evict(uint64_t max_size, uint32_t max_entries)
+{
+	const uint64_t target_size = max_size - (max_size / 10);
+	const size_t target_entries = max_entries - (max_entries / 10);
+
+	// Get a snapshot of the index, sorted by access time.
+	struct LruEntry {
+		time_t atime;
+		off64_t size;
+		string key;
+	};
+	vector<LruEntry> lru;
+	uint64_t snapshot_size;
+	{
+		MutexLocker locker(mutex);
+		snapshot_size = total_size;
+		lru.reserve(entries.size());
+		for (const auto &p : entries) {
+			LruEntry e = {p.second.atime, p.second.size, p.first};
+			lru.emplace_back(std::move(e));
+		}
+	}
+	std::sort(lru.begin(), lru.end(), [](const LruEntry &a, const LruEntry &b) {
+		return (a.atime < b.atime);
+	});
+
+	// Evict files until the cache is below the target size.
+	size_t count = lru.size();
+	for (const LruEntry &e : lru) {
+		if ((max_size == 0 || snapshot_size <= target_size) &&
+		    (max_entries == 0 || count <= target_entries))
+		{
+			break;
+		}
+		snapshot_size -= e.size;
+		count--;
+
+		{
+			MutexLocker locker(mutex);
+			if (worker_stop) {
+				// Shutting down.
+				break;
+			}
+			auto iter = entries.find(e.key);
+			if (iter == entries.end() || iter->second.atime != e.atime) {
+				// File was accessed after the snapshot was taken.
+				continue;
+			}
+			eraseEntry_locked(iter);
+			addPending_locked('D', time(nullptr), 0, e.key);
+		}
+
+		// NOTE: Deleting the file without holding the mutex,
+		// since this might take a while.
+		FileSystem::delete_file(cache_dir + e.key);
+	}
+
+	MutexLocker locker(mutex);
+	flush_locked(false);
+	evicting = false;
+}
+
+/** CacheIndex **/
+
+CacheIndex::CacheIndex()
+	: d_ptr(new CacheIndexPrivate())
+{ }
+
+CacheIndex::~CacheIndex()
+{
+	delete d_ptr;
+}
+
+/**
+ * Get the CacheIndex instance.
+ *
+ * The index is loaded from the cache directory on first use.
+ * If the index file doesn't exist, it will be rebuilt by
+ * scanning the cache directory.
+ *
+ * @return CacheIndex instance.
+ */
+CacheIndex *CacheIndex::instance(void)
+{
+	pthread_once(&CacheIndexPrivate::once_control, CacheIndexPrivate::initInstance);
+	return CacheIndexPrivate::instance;
+}
+
+/**
+ * Shut down the CacheIndex instance.
+ *
+ * This waits for the worker thread to finish and writes
+ * pending updates to the on-disk index. It should be called
+ * by programs before exiting, while no other threads are
+ * using the index. The index must not be updated afterwards.
+ *
+ * Does nothing if the index was never used.
+ */
+void CacheIndex::shutdown(void)
+{
+	// NOTE: Not using instance(), since that would load the index.
+	CacheIndex *const q = CacheIndexPrivate::instance;
+	if (!q)
+		return;
+
+	CacheIndexPrivate *const d = q->d_ptr;
+	d->mutex.lock();
+	d->worker_stop = true;
+	const bool joinWorker = d->worker.isJoinable();
+	d->mutex.unlock();
+	if (joinWorker) {
+		d->worker.join();
+	}
+
+	// Write any pending records.
+	// NOTE: flush_locked() can't request compaction here,
+	// since the worker thread has been stopped.
+	d->mutex.lock();
+	const bool hasPending = !d->pending.empty();
+	d->mutex.unlock();
+	if (hasPending) {
+		q->save();
+	}
+}
+
+/**
+ * Record a cache hit.
+ * The file's access time will be updated.
+ * @param filename Cache filename. (Ignored if not in the user's cache directory.)
+ * @param size File size.
+ */
+void CacheIndex::recordHit(const string &filename, off64_t size)
+{
+	RP_D(CacheIndex);
+	string key;
+	if (!d->filenameToKey(filename, key)) {
+		return;
+	}
+
+	MutexLocker locker(d->mutex);
+	d->updateEntry_locked(key, size, true);
+
+	// Hits are very frequent, so the index is only written periodically.
+	if (d->pending_count >= CacheIndexPrivate::SAVE_UPDATE_COUNT ||
+	    (time(nullptr) - d->last_save) >= CacheIndexPrivate::SAVE_INTERVAL)
+	{
+		d->flush_locked(false);
+	}
+}
+
+/**
+ * Record a cache miss.
+ * This should be called after the file has been downloaded.
+ * If the cache is over its limits, eviction will be
+ * started on a background thread.
+ * @param filename Cache filename. (Ignored if not in the user's cache directory.)
+ * @param size File size. (0 for a negative cache entry)
+ */
+void CacheIndex::recordMiss(const string &filename, off64_t size)
+{
+	RP_D(CacheIndex);
+	string key;
+	if (!d->filenameToKey(filename, key)) {
+		return;
+	}
+
+	MutexLocker locker(d->mutex);
+	d->updateEntry_locked(key, size, false);
+
+	// Downloads are relatively infrequent, so write the index now.
+	d->flush_locked(false);
+	d->checkLimits_locked();
+}
+
+/**
+ * Remove a file from the index.
+ * NOTE: This does not delete the file.
+ * @param filename Cache filename.
+ */
+void CacheIndex::remove(const string &filename)
+{
+	RP_D(CacheIndex);
+	string key;
+	if (!d->filenameToKey(filename, key)) {
+		return;
+	}
+
+	MutexLocker locker(d->mutex);
+	auto iter = d->entries.find(key);
+	if (iter != d->entries.end()) {
+		d->eraseEntry_locked(iter);
+		d->addPending_locked('D', time(nullptr), 0, key);
+	}
+}
+
+/**
+ * Write pending updates to the on-disk index.
+ * If the on-disk index needs to be rewritten,
+ * e.g. if it was rebuilt, it's rewritten here.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheIndex::save(void)
+{
+	RP_D(CacheIndex);
+	d->mutex.lock();
+	if (d->needs_compact) {
+		d->mutex.unlock();
+		return d->compact();
+	}
+	const int ret = d->flush_locked(true);
+	d->mutex.unlock();
+	return ret;
+}
+
+/**
+ * Get the cache statistics.
+ * Statistics are accumulated across all processes
+ * that use the cache directory.
+ * This does not write to the on-disk index.
+ * @param pStats	[out] Statistics.
+ */
+void CacheIndex::getStats(Stats *pStats)
+{
+	assert(pStats != nullptr);
+	if (!pStats)
+		return;
+
+	RP_D(CacheIndex);
+	MutexLocker locker(d->mutex);
+
+	// Read new records from the on-disk index first
+	// in order to pick up updates from other processes.
+	d->refresh_locked();
+
+	pStats->hits = d->hits;
+	pStats->misses = d->misses;
+	pStats->bytes_saved = d->bytes_saved;
+	pStats->entries = static_cast<unsigned int>(d->entries.size());
+	pStats->total_size = d->total_size;
+}
+
+}
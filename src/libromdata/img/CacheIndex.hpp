@@ -0,0 +1,117 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CacheIndex.hpp: Download cache index.                                   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_IMG_CACHEINDEX_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_IMG_CACHEINDEX_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+
+namespace LibRomData {
+
+class CacheIndexPrivate;
+class CacheIndex
+{
+	protected:
+		/**
+		 * CacheIndex is a singleton class.
+		 * Use CacheIndex::instance() to access it.
+		 */
+		CacheIndex();
+		~CacheIndex();
+
+	private:
+		friend class CacheIndexPrivate;
+		CacheIndexPrivate *const d_ptr;
+		RP_DISABLE_COPY(CacheIndex)
+
+	public:
+		/**
+		 * Get the CacheIndex instance.
+		 *
+		 * The index is loaded from the cache directory on first use.
+		 * If the index file doesn't exist, it will be rebuilt by
+		 * scanning the cache directory.
+		 *
+		 * @return CacheIndex instance.
+		 */
+		static CacheIndex *instance(void);
+
+		/**
+		 * Shut down the CacheIndex instance.
+		 *
+		 * This waits for the worker thread to finish and writes
+		 * pending updates to the on-disk index. It should be called
+		 * by programs before exiting, while no other threads are
+		 * using the index. The index must not be updated afterwards.
+		 *
+		 * Does nothing if the index was never used.
+		 */
+		static void shutdown(void);
+
+	public:
+		/**
+		 * Record a cache hit.
+		 * The file's access time will be updated.
+		 * @param filename Cache filename. (Ignored if not in the user's cache directory.)
+		 * @param size File size.
+		 */
+		void recordHit(const std::string &filename, off64_t size);
+
+		/**
+		 * Record a cache miss.
+		 * This should be called after the file has been downloaded.
+		 * If the cache is over its limits, eviction will be
+		 * started on a background thread.
+		 * @param filename Cache filename. (Ignored if not in the user's cache directory.)
+		 * @param size File size. (0 for a negative cache entry)
+		 */
+		void recordMiss(const std::string &filename, off64_t size);
+
+		/**
+		 * Remove a file from the index.
+		 * NOTE: This does not delete the file.
+		 * @param filename Cache filename.
+		 */
+		void remove(const std::string &filename);
+
+		/**
+		 * Write pending updates to the on-disk index.
+		 * If the on-disk index needs to be rewritten,
+		 * e.g. if it was rebuilt, it's rewritten here.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int save(void);
+
+	public:
+		struct Stats {
+			uint64_t hits;		// Number of cache hits
+			uint64_t misses;	// Number of cache misses (downloads)
+			uint64_t bytes_saved;	// Total size of cache hits
+			uint64_t total_size;	// Total size of all files in the cache
+			unsigned int entries;	// Number of files in the cache
+		};
+
+		/**
+		 * Get the cache statistics.
+		 * Statistics are accumulated across all processes
+		 * that use the cache directory.
+		 * This does not write to the on-disk index.
+		 * @param pStats	[out] Statistics.
+		 */
+		void getStats(Stats *pStats);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_IMG_CACHEINDEX_HPP__ */
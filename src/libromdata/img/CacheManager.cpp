@@ -9,15 +9,21 @@
 #include "stdafx.h"
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
+#include "CacheIndex.hpp"
 
 // librpbase, librpfile, librpthreads
 #include "librpbase/TextFuncs.hpp"
 #include "librpfile/RpFile.hpp"
 #include "librpfile/FileSystem.hpp"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
 using LibRpThreads::Semaphore;
 using LibRpThreads::SemaphoreLocker;
+using LibRpThreads::Thread;
 
 // libcachecommon
 #include "libcachecommon/CacheKeys.hpp"
@@ -40,7 +46,9 @@ using LibRpThreads::SemaphoreLocker;
 
 // C++ includes.
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 #ifdef _WIN32
 using std::wstring;
 #endif /* _WIN32 */
@@ -48,9 +56,7 @@ using std::wstring;
 namespace LibRomData {
 
 // Semaphore used to limit the number of simultaneous downloads.
-// TODO: Determine the best number of simultaneous downloads.
-// TODO: Test this on XP with IEIFLAG_ASYNC.
-Semaphore CacheManager::m_dlsem(2);
+Semaphore CacheManager::m_dlsem(CacheManager::MAX_SIMULTANEOUS_DOWNLOADS);
 
 /** Proxy server functions. **/
 // NOTE: This is only useful for downloaders that
@@ -87,6 +93,32 @@ void CacheManager::setProxyUrl(const string &proxyUrl)
 	m_proxyUrl = proxyUrl;
 }
 
+/**
+ * Migrate a file from the original, non-sharded cache layout.
+ * @param cache_key Cache key.
+ * @param cache_filename Sharded cache filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::migrateLegacyFile(const string &cache_key, const string &cache_filename)
+{
+	const string legacy_filename = LibCacheCommon::getLegacyCacheFilename(cache_key);
+	if (legacy_filename.empty() || legacy_filename == cache_filename) {
+		return -ENOENT;
+	}
+
+	// Make sure the shard subdirectory exists.
+	int ret = FileSystem::rmkdir(cache_filename);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = FileSystem::rename(legacy_filename, cache_filename);
+	if (ret == 0) {
+		CacheIndex::instance()->remove(legacy_filename);
+	}
+	return ret;
+}
+
 /**
  * Download a file.
  *
@@ -125,6 +157,12 @@ string CacheManager::download(const string &cache_key)
 	off64_t filesize = 0;
 	time_t filemtime = 0;
 	int ret = FileSystem::get_file_size_and_mtime(cache_filename.c_str(), &filesize, &filemtime);
+	if (ret == -ENOENT && migrateLegacyFile(cache_key, cache_filename) == 0) {
+		// File was migrated from the non-sharded cache layout.
+		ret = FileSystem::get_file_size_and_mtime(cache_filename.c_str(), &filesize, &filemtime);
+	}
+
+	CacheIndex *const cacheIndex = CacheIndex::instance();
 	if (ret == 0) {
 		// Check if the file is 0 bytes.
 		// TODO: How should we handle errors?
@@ -136,6 +174,7 @@ string CacheManager::download(const string &cache_key)
 			const time_t systime = time(nullptr);
 			if ((systime - filemtime) < (86400*7)) {
 				// Less than a week old.
+				cacheIndex->recordHit(cache_filename, 0);
 				return string();
 			}
 
@@ -145,9 +184,11 @@ string CacheManager::download(const string &cache_key)
 				// Unable to delete the cache file.
 				return string();
 			}
+			cacheIndex->remove(cache_filename);
 		} else if (filesize > 0) {
 			// File is larger than 0 bytes, which indicates
 			// it was cached successfully.
+			cacheIndex->recordHit(cache_filename, filesize);
 			return cache_filename;
 		}
 	} else if (ret != -ENOENT) {
@@ -168,6 +209,14 @@ string CacheManager::download(const string &cache_key)
 	// results in slashes being changed to backslashes on Windows.
 	// rp-download will filter the key itself.
 	ret = execRpDownload(cache_key);
+
+	// Add the file to the cache index.
+	// NOTE: If the file wasn't found on the server,
+	// rp-download creates a 0-byte file.
+	if (FileSystem::get_file_size_and_mtime(cache_filename, &filesize, &filemtime) == 0) {
+		cacheIndex->recordMiss(cache_filename, filesize);
+	}
+
 	if (ret != 0) {
 		// rp-download failed for some reason.
 		return string();
@@ -192,11 +241,143 @@ string CacheManager::findInCache(const string &cache_key)
 	}
 
 	// Return the filename if the file exists.
-	if (FileSystem::access(cache_filename, R_OK) != 0) {
+	off64_t filesize = 0;
+	time_t filemtime = 0;
+	int ret = FileSystem::get_file_size_and_mtime(cache_filename, &filesize, &filemtime);
+	if (ret == -ENOENT && migrateLegacyFile(cache_key, cache_filename) == 0) {
+		// File was migrated from the non-sharded cache layout.
+		ret = FileSystem::get_file_size_and_mtime(cache_filename, &filesize, &filemtime);
+	}
+	if (ret != 0 || FileSystem::access(cache_filename, R_OK) != 0) {
 		// Unable to read the cache file.
 		cache_filename.clear();
+	} else {
+		CacheIndex::instance()->recordHit(cache_filename, filesize);
 	}
 	return cache_filename;
 }
 
+/**
+ * downloadFirst() state.
+ * Shared by all worker threads.
+ */
+struct DownloadFirstState {
+	CacheManager *cache;
+	const vector<CacheManager::Candidate> *candidates;
+	vector<string> filenames;	// Cache filenames. (empty if not available)
+
+	Mutex mutex;		// Protects all fields below.
+	size_t next_idx;		// Next candidate to check
+	size_t best_idx;		// Highest-priority available candidate
+};
+
+/**
+ * downloadFirst() worker thread function.
+ * Checks candidates until none are left, or until a
+ * higher-priority candidate is available.
+ * @param param downloadFirst() state.
+ */
+static void downloadFirstWorker(void *param)
+{
+	DownloadFirstState *const state = static_cast<DownloadFirstState*>(param);
+	const vector<CacheManager::Candidate> &candidates = *state->candidates;
+
+	while (true) {
+		size_t idx;
+		{
+			MutexLocker locker(state->mutex);
+			if (state->next_idx >= candidates.size() ||
+			    state->next_idx > state->best_idx)
+			{
+				// No candidates left, or a higher-priority
+				// candidate is already available.
+				break;
+			}
+			idx = state->next_idx++;
+		}
+
+		const CacheManager::Candidate &candidate = candidates[idx];
+		string cache_filename = (candidate.download
+			? state->cache->download(candidate.cache_key)
+			: state->cache->findInCache(candidate.cache_key));
+		if (cache_filename.empty())
+			continue;
+
+		MutexLocker locker(state->mutex);
+		state->filenames[idx] = std::move(cache_filename);
+		if (idx < state->best_idx) {
+			state->best_idx = idx;
+		}
+	}
+}
+
+/**
+ * Get the highest-priority candidate that's available.
+ *
+ * Candidates are resolved concurrently using up to
+ * MAX_SIMULTANEOUS_DOWNLOADS threads, in priority order.
+ * Once a candidate is available, lower-priority candidates
+ * that haven't been started yet are skipped. Downloads that
+ * are already in progress are allowed to finish, since the
+ * files will be stored in the cache.
+ *
+ * The current proxy server is used for all candidates.
+ *
+ * @param candidates	[in] Candidates, in priority order.
+ * @param startIdx	[in] Index of the first candidate to check.
+ * @param cache_filename [out] Absolute path to the cached file.
+ * @return Index of the candidate, or -1 if none are available.
+ */
+int CacheManager::downloadFirst(const vector<Candidate> &candidates, size_t startIdx, string &cache_filename)
+{
+	cache_filename.clear();
+	if (startIdx >= candidates.size()) {
+		return -1;
+	}
+
+	DownloadFirstState state;
+	state.cache = this;
+	state.candidates = &candidates;
+	state.filenames.resize(candidates.size());
+	state.next_idx = startIdx;
+	state.best_idx = candidates.size();
+
+	// The current thread is used as one of the workers.
+	const size_t count = candidates.size() - startIdx;
+	Thread workers[MAX_SIMULTANEOUS_DOWNLOADS - 1];
+	size_t workerCount = 0;
+	if (count > 1) {
+		const size_t max_threads = static_cast<size_t>(MAX_SIMULTANEOUS_DOWNLOADS);
+		const size_t threads = (count < max_threads ? count : max_threads);
+		for (size_t i = 1; i < threads; i++) {
+			if (workers[workerCount].create(downloadFirstWorker, &state) != 0) {
+				// Unable to create a thread.
+				// Use the threads that were already created.
+				break;
+			}
+			workerCount++;
+		}
+	}
+	downloadFirstWorker(&state);
+	for (size_t i = 0; i < workerCount; i++) {
+		workers[i].join();
+	}
+
+	if (state.best_idx >= candidates.size()) {
+		// No candidates are available.
+		return -1;
+	}
+	cache_filename = std::move(state.filenames[state.best_idx]);
+	return static_cast<int>(state.best_idx);
+}
+
+/**
+ * Get the cache statistics.
+ * @param pStats	[out] Statistics.
+ */
+void CacheManager::getStats(CacheIndex::Stats *pStats)
+{
+	CacheIndex::instance()->getStats(pStats);
+}
+
 }
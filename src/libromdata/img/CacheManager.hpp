@@ -10,12 +10,14 @@
 #define __ROMPROPERTIES_LIBROMDATA_IMG_CACHEMANAGER_HPP__
 
 #include "common.h"
+#include "CacheIndex.hpp"
 
 // librpthreads
 #include "librpthreads/Semaphore.hpp"
 
 // C++ includes.
 #include <string>
+#include <vector>
 
 namespace LibRomData {
 
@@ -23,7 +25,7 @@ class CacheManager
 {
 	public:
 		CacheManager() { }
-		~CacheManager() { }
+		virtual ~CacheManager() { }
 
 	private:
 		RP_DISABLE_COPY(CacheManager)
@@ -77,17 +79,65 @@ class CacheManager
 		 */
 		std::string findInCache(const std::string &cache_key);
 
+		/**
+		 * Download candidate.
+		 */
+		struct Candidate {
+			std::string cache_key;	// Cache key
+			bool download;		// If false, only check the cache.
+		};
+
+		/**
+		 * Get the highest-priority candidate that's available.
+		 *
+		 * Candidates are resolved concurrently using up to
+		 * MAX_SIMULTANEOUS_DOWNLOADS threads, in priority order.
+		 * Once a candidate is available, lower-priority candidates
+		 * that haven't been started yet are skipped. Downloads that
+		 * are already in progress are allowed to finish, since the
+		 * files will be stored in the cache.
+		 *
+		 * The current proxy server is used for all candidates.
+		 *
+		 * @param candidates	[in] Candidates, in priority order.
+		 * @param startIdx	[in] Index of the first candidate to check.
+		 * @param cache_filename [out] Absolute path to the cached file.
+		 * @return Index of the candidate, or -1 if none are available.
+		 */
+		int downloadFirst(const std::vector<Candidate> &candidates, size_t startIdx, std::string &cache_filename);
+
+		/**
+		 * Get the cache statistics.
+		 * @param pStats	[out] Statistics.
+		 */
+		static void getStats(CacheIndex::Stats *pStats);
+
 	protected:
+		/**
+		 * Migrate a file from the original, non-sharded cache layout.
+		 * @param cache_key Cache key.
+		 * @param cache_filename Sharded cache filename.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int migrateLegacyFile(const std::string &cache_key, const std::string &cache_filename);
+
 		/**
 		 * Execute rp-download.
 		 * @param filtered_cache_key Filtered cache key.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int execRpDownload(const std::string &filtered_cache_key);
+		virtual int execRpDownload(const std::string &filtered_cache_key);
 
 	protected:
 		std::string m_proxyUrl;
 
+	public:
+		// Maximum number of simultaneous downloads.
+		// TODO: Determine the best number of simultaneous downloads.
+		// TODO: Test this on XP with IEIFLAG_ASYNC.
+		static const int MAX_SIMULTANEOUS_DOWNLOADS = 2;
+
+	protected:
 		// Semaphore used to limit the number of simultaneous downloads.
 		static LibRpThreads::Semaphore m_dlsem;
 };
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (libromdata)                       *
  * ExecRpDownload_posix.cpp: Execute rp-download.exe. (POSIX)              *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -10,8 +10,22 @@
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
 
+// librpbase, librpthreads
+#include "librpbase/config/Config.hpp"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Semaphore.hpp"
+#include "librpthreads/Thread.hpp"
+#include "librpthreads/pthread_once.h"
+using LibRpBase::Config;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Semaphore;
+using LibRpThreads::Thread;
+
 // OS-specific includes.
+#include <poll.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -19,36 +33,44 @@
 # include <spawn.h>
 #endif /* HAVE_POSIX_SPAWN */
 
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
+#ifndef SOCK_CLOEXEC
+# include <fcntl.h>
+# define SOCK_CLOEXEC 0
+# define NO_SOCK_CLOEXEC 1
+#endif /* !SOCK_CLOEXEC */
+
+// C includes. (C++ namespace)
+#include <ctime>
+
 // C++ includes.
 #include <string>
+#include <unordered_map>
+#include <vector>
 using std::string;
+using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
+// TODO: Mac OS X path. (bundle?)
+static const char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
+
 /**
- * Execute rp-download. (POSIX version)
- * @param filteredCacheKey Filtered cache key.
- * @return 0 on success; negative POSIX error code on error.
+ * Build a minimal environment for rp-download.
+ * This will include http_proxy and https_proxy if the proxy URL is set.
+ * @param proxyUrl	[in] Proxy URL. (If empty, the proxy from the environment is used.)
+ * @param s_env		[out] Environment strings, separated by NULLs.
+ * @param envp		[out] Environment pointers into s_env. (NULL-terminated)
  */
-int CacheManager::execRpDownload(const string &filteredCacheKey)
+static void buildRpDownloadEnv(const string &proxyUrl, string &s_env, vector<const char*> &envp)
 {
-	// TODO: Mac OS X path. (bundle?)
- 	static const char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
-
-	// Parameters.
-	const char *const argv[3] = {
-		rp_download_exe,
-		filteredCacheKey.c_str(),
-		nullptr
-	};
-
-	// Define a minimal environment for cURL.
-	// This will include http_proxy and https_proxy if the proxy URL is set.
 	// TODO: Separate proxies for http and https?
-	// TODO: Only build this once?
-	int pos[5] = {-1, -1, -1, -1, -1};
-	int count = 0;
-	std::string s_env;
+	vector<size_t> pos;
+	pos.reserve(4);
+	s_env.clear();
 	s_env.reserve(1024);
 
 	// We want the HOME and USER variables.
@@ -56,49 +78,606 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	// if they're set in the environment.
 	const char *envtmp = getenv("HOME");
 	if (envtmp && envtmp[0] != '\0') {
-		pos[count++] = static_cast<int>(s_env.size());
+		pos.emplace_back(s_env.size());
 		s_env += "HOME=";
 		s_env += envtmp;
 		s_env += '\0';
 	}
 	envtmp = getenv("USER");
 	if (envtmp && envtmp[0] != '\0') {
-		pos[count++] = static_cast<int>(s_env.size());
+		pos.emplace_back(s_env.size());
 		s_env += "USER=";
 		s_env += envtmp;
 		s_env += '\0';
 	}
-	if (m_proxyUrl.empty()) {
+	if (proxyUrl.empty()) {
 		// Proxy URL is empty. Get the URLs from the environment.
 		envtmp = getenv("http_proxy");
 		if (envtmp && envtmp[0] != '\0') {
-			pos[count++] = static_cast<int>(s_env.size());
+			pos.emplace_back(s_env.size());
 			s_env += "http_proxy=";
 			s_env += envtmp;
 			s_env += '\0';
 		}
 		envtmp = getenv("https_proxy");
 		if (envtmp && envtmp[0] != '\0') {
-			pos[count++] = static_cast<int>(s_env.size());
+			pos.emplace_back(s_env.size());
 			s_env += "https_proxy=";
 			s_env += envtmp;
 			s_env += '\0';
 		}
 	} else {
 		// Proxy URL is set. Use it.
-		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "http_proxy=" + m_proxyUrl;
-		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "https_proxy=" + m_proxyUrl;
+		pos.emplace_back(s_env.size());
+		s_env += "http_proxy=" + proxyUrl;
+		s_env += '\0';
+		pos.emplace_back(s_env.size());
+		s_env += "https_proxy=" + proxyUrl;
+		s_env += '\0';
 	}
 
 	// Build envp.
-	const char *envp[5] = {nullptr, nullptr, nullptr, nullptr, nullptr};
-	unsigned int envp_idx = 0;
-	for (unsigned int i = 0; i < 5; i++) {
-		if (pos[i] >= 0) {
-			envp[envp_idx++] = &s_env[pos[i]];
+	envp.clear();
+	envp.reserve(pos.size() + 1);
+	for (size_t p : pos) {
+		envp.emplace_back(&s_env[p]);
+	}
+	envp.emplace_back(nullptr);
+}
+
+/**
+ * Persistent rp-download process.
+ *
+ * rp-download is started in server mode (-s) and connected
+ * using a socket pair. Cache keys are sent one per line, and
+ * rp-download replies with "status\tcache_key" when each
+ * download is finished. This allows rp-download to reuse
+ * connections to the image servers.
+ *
+ * Responses are read by a reader thread, which also handles
+ * request timeouts. If rp-download exits (e.g. due to its idle
+ * timeout), it will be restarted on the next request.
+ */
+class RpDownloadHelper
+{
+	protected:
+		/**
+		 * RpDownloadHelper is a singleton class.
+		 * Use RpDownloadHelper::instance() to access it.
+		 */
+		RpDownloadHelper()
+			: m_fd(-1)
+			, m_startFailures(0)
+			, m_exiting(false)
+		{ }
+
+	private:
+		RP_DISABLE_COPY(RpDownloadHelper)
+
+	public:
+		/**
+		 * Get the RpDownloadHelper instance.
+		 * @return RpDownloadHelper instance.
+		 */
+		static RpDownloadHelper *instance(void)
+		{
+			pthread_once(&once_control, initInstance);
+			return m_instance;
+		}
+
+		/**
+		 * Stop rp-download if it's running.
+		 * Called when the library is unloaded.
+		 */
+		static void exitInstance(void)
+		{
+			// NOTE: Not using instance(), since that would create it.
+			if (m_instance) {
+				m_instance->stopForUnload();
+			}
+		}
+
+	private:
+		// Singleton instance.
+		// NOTE: Never deleted, since the reader thread
+		// might still be using it after stopForUnload().
+		static RpDownloadHelper *m_instance;
+		static pthread_once_t once_control;
+
+		/**
+		 * Initialize the singleton instance.
+		 * Internal function; must be called using pthread_once().
+		 */
+		static void initInstance(void)
+		{
+			m_instance = new RpDownloadHelper();
+		}
+
+	public:
+		/**
+		 * Download a file using the persistent rp-download process.
+		 * @param cache_key	[in] Filtered cache key.
+		 * @param s_env		[in] Environment strings. (from buildRpDownloadEnv())
+		 * @param envp		[in] Environment pointers. (from buildRpDownloadEnv())
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTCONN if rp-download isn't available)
+		 */
+		int download(const string &cache_key, const string &s_env, const char *const *envp);
+
+	private:
+		/**
+		 * Stop rp-download and detach the reader thread.
+		 * rp-download can't be restarted afterwards.
+		 *
+		 * NOTE: This doesn't wait for the reader thread or for
+		 * rp-download to exit, since rp-download might be in the
+		 * middle of a download. Blocking here would hang process
+		 * exit or dlclose().
+		 */
+		void stopForUnload(void);
+
+		/**
+		 * Start rp-download.
+		 * NOTE: m_startMutex and m_mutex must be locked by the caller.
+		 * m_mutex is temporarily unlocked if the previous reader
+		 * thread has to be joined.
+		 * @param s_env	[in] Environment strings. (from buildRpDownloadEnv())
+		 * @param envp	[in] Environment pointers. (from buildRpDownloadEnv())
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int start_locked(const string &s_env, const char *const *envp);
+
+		/**
+		 * Stop rp-download.
+		 * All pending requests will fail with -ENOTCONN.
+		 * NOTE: m_mutex must be locked by the caller.
+		 */
+		void stop_locked(void);
+
+		struct Pending;
+
+		/**
+		 * Mark a request as done and wake up its waiters.
+		 * NOTE: m_mutex must be locked by the caller.
+		 * @param pending Pending request. (must have been removed from m_pending)
+		 * @param status Request status.
+		 */
+		static void finish_locked(Pending *pending, int status);
+
+		/**
+		 * Reader thread function.
+		 * Reads responses from rp-download until the socket is closed.
+		 * @param fd Socket.
+		 * @param pid rp-download process ID.
+		 */
+		void readerThread(int fd, pid_t pid);
+
+	private:
+		// Maximum number of times rp-download can fail to start
+		// before the persistent process is disabled.
+		static const unsigned int MAX_START_FAILURES = 3;
+		// Request timeout. (matches the non-persistent version)
+		static const time_t REQUEST_TIMEOUT_SEC = 10;
+		// Status for requests that timed out.
+		static const int STATUS_TIMEOUT = -ETIMEDOUT;
+
+		// Pending request.
+		// Deleted by the last waiter once the request is done.
+		struct Pending {
+			Pending()
+				: waiters(0)
+				, status(0)
+				, deadline(time(nullptr) + REQUEST_TIMEOUT_SEC)
+				, sem(0)
+			{ }
+
+			unsigned int waiters;	// Number of threads waiting for this request
+			int status;		// rp-download exit status, -ENOTCONN, or STATUS_TIMEOUT
+			time_t deadline;	// Request times out after this time
+			Semaphore sem;		// Released once per waiter when the request is done
+		};
+
+		Mutex m_startMutex;	// Serializes starting rp-download. (locked before m_mutex)
+		Thread m_reader;	// Reader thread (only joined with m_startMutex locked)
+
+		Mutex m_mutex;		// Protects all fields below.
+		int m_fd;		// Socket connected to rp-download's stdin and stdout
+		string m_env;		// rp-download's environment
+		unsigned int m_startFailures;
+		bool m_exiting;		// Library is being unloaded; don't restart rp-download
+		unordered_map<string, Pending*> m_pending;	// Key: cache key
+};
+
+RpDownloadHelper *RpDownloadHelper::m_instance = nullptr;
+pthread_once_t RpDownloadHelper::once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Stops the persistent rp-download process when the library is unloaded.
+ */
+static class RpDownloadHelperCleanup
+{
+	public:
+		~RpDownloadHelperCleanup()
+		{
+			RpDownloadHelper::exitInstance();
+		}
+} rpDownloadHelperCleanup;
+
+/**
+ * Stop rp-download and detach the reader thread.
+ * rp-download can't be restarted afterwards.
+ *
+ * NOTE: This doesn't wait for the reader thread or for
+ * rp-download to exit, since rp-download might be in the
+ * middle of a download. Blocking here would hang process
+ * exit or dlclose().
+ */
+void RpDownloadHelper::stopForUnload(void)
+{
+	MutexLocker startLocker(m_startMutex);
+	MutexLocker locker(m_mutex);
+	m_exiting = true;
+
+	// rp-download will exit once its stdin is closed.
+	// The reader thread won't wait for it.
+	stop_locked();
+	if (m_reader.isJoinable()) {
+		m_reader.detach();
+	}
+}
+
+/**
+ * Start rp-download.
+ * NOTE: m_startMutex and m_mutex must be locked by the caller.
+ * m_mutex is temporarily unlocked if the previous reader
+ * thread has to be joined.
+ * @param s_env	[in] Environment strings. (from buildRpDownloadEnv())
+ * @param envp	[in] Environment pointers. (from buildRpDownloadEnv())
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpDownloadHelper::start_locked(const string &s_env, const char *const *envp)
+{
+	assert(m_fd < 0);
+
+	if (m_reader.isJoinable()) {
+		// The previous reader thread has been stopped,
+		// but it might not have exited yet. Join it.
+		// NOTE: m_mutex has to be unlocked, since the reader thread
+		// locks it. m_startMutex prevents other threads from
+		// starting rp-download in the meantime.
+		m_mutex.unlock();
+		m_reader.join();
+		m_mutex.lock();
+		if (m_fd >= 0) {
+			// Shouldn't happen...
+			return 0;
+		}
+	}
+
+	// Parameters.
+	const char *const argv[3] = {
+		rp_download_exe,
+		"-s",
+		nullptr
+	};
+
+	// sv[0] is used by this process; sv[1] is used by rp-download.
+	// NOTE: SOCK_CLOEXEC prevents other child processes from
+	// inheriting the sockets. dup2() clears FD_CLOEXEC for
+	// rp-download's stdin and stdout.
+	int sv[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+		int err = errno;
+		if (err == 0) {
+			err = EIO;
+		}
+		return -err;
+	}
+#ifdef NO_SOCK_CLOEXEC
+	fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+	fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+#endif /* NO_SOCK_CLOEXEC */
+
+#ifdef HAVE_POSIX_SPAWN
+	// posix_spawn()
+	pid_t pid = -1;
+	posix_spawn_file_actions_t file_actions;
+	int ret = posix_spawn_file_actions_init(&file_actions);
+	if (ret == 0) {
+		posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDOUT_FILENO);
+		ret = posix_spawn(&pid, rp_download_exe,
+			&file_actions,
+			nullptr,	// attrp
+			(char *const *)argv, (char *const *)envp);
+		posix_spawn_file_actions_destroy(&file_actions);
+	}
+	if (ret != 0) {
+		// Error creating the child process.
+		close(sv[0]);
+		close(sv[1]);
+		return -ret;
+	}
+#else /* !HAVE_POSIX_SPAWN */
+	// fork()/execve().
+	errno = 0;
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Child process.
+		if (dup2(sv[1], STDIN_FILENO) < 0 || dup2(sv[1], STDOUT_FILENO) < 0) {
+			_exit(EXIT_FAILURE);
+		}
+		execve(rp_download_exe, (char *const *)argv, (char *const *)envp);
+		// execve() failed.
+		_exit(EXIT_FAILURE);
+	} else if (pid == -1) {
+		// fork() failed.
+		int err = errno;
+		if (err == 0) {
+			err = EIO;
+		}
+		close(sv[0]);
+		close(sv[1]);
+		return -err;
+	}
+#endif /* HAVE_POSIX_SPAWN */
+
+	// Parent process.
+	close(sv[1]);
+
+	// Start the reader thread.
+	const int fd = sv[0];
+	const int tret = m_reader.create([this, fd, pid]() { readerThread(fd, pid); });
+	if (tret != 0) {
+		// Unable to create a thread.
+		// Closing the socket will cause rp-download to exit.
+		close(fd);
+		waitpid(pid, nullptr, 0);
+		return tret;
+	}
+
+	m_fd = fd;
+	m_env = s_env;
+	return 0;
+}
+
+/**
+ * Mark a request as done and wake up its waiters.
+ * NOTE: m_mutex must be locked by the caller.
+ * @param pending Pending request. (must have been removed from m_pending)
+ * @param status Request status.
+ */
+void RpDownloadHelper::finish_locked(Pending *pending, int status)
+{
+	pending->status = status;
+	for (unsigned int i = pending->waiters; i > 0; i--) {
+		pending->sem.release();
+	}
+}
+
+/**
+ * Stop rp-download.
+ * All pending requests will fail with -ENOTCONN.
+ * NOTE: m_mutex must be locked by the caller.
+ */
+void RpDownloadHelper::stop_locked(void)
+{
+	if (m_fd < 0)
+		return;
+
+	// The reader thread will close the socket once
+	// it's shut down, and rp-download will exit once
+	// its stdin is closed.
+	shutdown(m_fd, SHUT_RDWR);
+	m_fd = -1;
+
+	for (const auto &p : m_pending) {
+		finish_locked(p.second, -ENOTCONN);
+	}
+	m_pending.clear();
+}
+
+/**
+ * Reader thread function.
+ * Reads responses from rp-download until the socket is closed.
+ * @param fd Socket.
+ * @param pid rp-download process ID.
+ */
+void RpDownloadHelper::readerThread(int fd, pid_t pid)
+{
+	string line;
+	char buf[1024];
+	while (true) {
+		// Wake up once per second to check for timeouts.
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		const int pret = poll(&pfd, 1, 1000);
+		if (pret < 0 && errno != EINTR)
+			break;
+
+		ssize_t size = 0;
+		if (pret > 0) {
+			size = read(fd, buf, sizeof(buf));
+			if (size < 0 && errno == EINTR)
+				continue;
+			if (size <= 0)
+				break;
+		}
+
+		MutexLocker locker(m_mutex);
+		if (m_fd != fd) {
+			// rp-download was stopped.
+			break;
+		}
+
+		for (const char *p = buf; p < buf + size; p++) {
+			if (*p != '\n') {
+				line += *p;
+				continue;
+			}
+
+			// Response: "status\tcache_key"
+			const size_t tab = line.find('\t');
+			if (tab != string::npos) {
+				auto iter = m_pending.find(line.substr(tab + 1));
+				if (iter != m_pending.end()) {
+					finish_locked(iter->second, atoi(line.c_str()));
+					m_pending.erase(iter);
+				}
+			}
+			line.clear();
+		}
+
+		// Check for requests that timed out.
+		const time_t now = time(nullptr);
+		for (auto iter = m_pending.begin(); iter != m_pending.end(); ) {
+			if (now >= iter->second->deadline) {
+				finish_locked(iter->second, STATUS_TIMEOUT);
+				iter = m_pending.erase(iter);
+			} else {
+				++iter;
+			}
+		}
+	}
+
+	bool exiting;
+	{
+		// rp-download has exited, or it was stopped.
+		MutexLocker locker(m_mutex);
+		if (m_fd == fd) {
+			stop_locked();
+		}
+		exiting = m_exiting;
+	}
+
+	close(fd);
+	// NOTE: If the library is being unloaded, don't wait for
+	// rp-download, since it might still be downloading a file.
+	// It will exit once it notices that its stdin was closed.
+	waitpid(pid, nullptr, (exiting ? WNOHANG : 0));
+}
+
+/**
+ * Download a file using the persistent rp-download process.
+ * @param cache_key	[in] Filtered cache key.
+ * @param s_env		[in] Environment strings. (from buildRpDownloadEnv())
+ * @param envp		[in] Environment pointers. (from buildRpDownloadEnv())
+ * @return 0 on success; negative POSIX error code on error. (-ENOTCONN if rp-download isn't available)
+ */
+int RpDownloadHelper::download(const string &cache_key, const string &s_env, const char *const *envp)
+{
+	if (cache_key.find_first_of("\t\r\n") != string::npos) {
+		// Cache key can't be sent to rp-download.
+		return -ENOTCONN;
+	}
+
+	Pending *pending;
+	{
+		MutexLocker startLocker(m_startMutex);
+		MutexLocker locker(m_mutex);
+		if (m_exiting || m_startFailures >= MAX_START_FAILURES) {
+			// rp-download couldn't be started,
+			// or the library is being unloaded.
+			return -ENOTCONN;
+		}
+
+		if (m_fd >= 0 && m_env != s_env) {
+			// The proxy settings have changed.
+			if (!m_pending.empty()) {
+				// rp-download is still in use.
+				return -ENOTCONN;
+			}
+			stop_locked();
+		}
+
+		auto iter = m_pending.find(cache_key);
+		if (iter == m_pending.end()) {
+			// Send the request. If rp-download exited due to
+			// its idle timeout, restart it and try again.
+			const string line = cache_key + '\n';
+			bool sent = false;
+			for (unsigned int i = 0; i < 2 && !sent; i++) {
+				if (m_fd < 0) {
+					if (start_locked(s_env, envp) != 0) {
+						m_startFailures++;
+						return -ENOTCONN;
+					}
+					m_startFailures = 0;
+				}
+
+				sent = (send(m_fd, line.data(), line.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(line.size()));
+				if (!sent) {
+					stop_locked();
+				}
+			}
+			if (!sent) {
+				return -ENOTCONN;
+			}
+
+			iter = m_pending.emplace(cache_key, new Pending()).first;
+		}
+
+		pending = iter->second;
+		pending->waiters++;
+	}
+
+	// Wait for the reader thread to finish the request.
+	pending->sem.obtain();
+
+	int status;
+	{
+		MutexLocker locker(m_mutex);
+		status = pending->status;
+		if (--pending->waiters == 0) {
+			delete pending;
+		}
+	}
+
+	if (status == STATUS_TIMEOUT) {
+		// Request did not complete.
+		// TODO: Better error code?
+		return -ECHILD;
+	} else if (status == -ENOTCONN) {
+		// rp-download exited before the request completed.
+		return -ENOTCONN;
+	} else if (status != 0) {
+		// rp-download failed for some reason.
+		// TODO: Better error code?
+		return -EIO;
+	}
+
+	// rp-download has successfully downloaded the file.
+	return 0;
+}
+
+/**
+ * Execute rp-download. (POSIX version)
+ * @param filteredCacheKey Filtered cache key.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownload(const string &filteredCacheKey)
+{
+	// Parameters.
+	const char *const argv[3] = {
+		rp_download_exe,
+		filteredCacheKey.c_str(),
+		nullptr
+	};
+
+	// Define a minimal environment for cURL.
+	string s_env;
+	vector<const char*> envp;
+	buildRpDownloadEnv(m_proxyUrl, s_env, envp);
+
+	if (Config::instance()->persistentDownloader()) {
+		// Use the persistent rp-download process.
+		int ret = RpDownloadHelper::instance()->download(filteredCacheKey, s_env, envp.data());
+		if (ret != -ENOTCONN) {
+			return ret;
 		}
+		// The persistent rp-download process isn't available.
+		// Start a separate rp-download process instead.
 	}
 
 	// TODO: Maybe we should close file handles...
@@ -109,7 +688,7 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	int ret = posix_spawn(&pid, rp_download_exe,
 		nullptr,	// file_actions
 		nullptr,	// attrp
-		(char *const *)argv, (char *const *)envp);
+		(char *const *)argv, (char *const *)envp.data());
 	if (ret != 0) {
 		// Error creating the child process.
 		int err = errno;
@@ -124,7 +703,7 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	pid_t pid = fork();
 	if (pid == 0) {
 		// Child process.
-		int ret = execve(rp_download_exe, (char *const *)argv, (char *const *)envp);
+		int ret = execve(rp_download_exe, (char *const *)argv, (char *const *)envp.data());
 		if (ret != 0) {
 			// execve() failed.
 			exit(EXIT_FAILURE);
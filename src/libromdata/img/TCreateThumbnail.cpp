@@ -15,6 +15,7 @@
 #include "CacheManager.hpp"
 
 // librpbase, librpfile
+#include "librpbase/Profiler.hpp"
 #include "librpbase/RomData.hpp"
 #include "librpbase/config/Config.hpp"
 #include "librpbase/img/RpImageLoader.hpp"
@@ -28,6 +29,7 @@ using LibRpTexture::rp_image;
 
 // libromdata
 #include "../RomDataFactory.hpp"
+#include "../Console/Xbox360_XEX.hpp"
 
 // C includes. (C++ namespace)
 #include <cassert>
@@ -41,7 +43,11 @@ namespace LibRomData {
 
 template<typename ImgClass>
 TCreateThumbnail<ImgClass>::TCreateThumbnail()
-{ }
+{
+	// Thumbnailers manage the cache directory, so data
+	// extracted from compressed executables can be cached.
+	Xbox360_XEX::setLzxCacheEnabled(true);
+}
 
 template<typename ImgClass>
 TCreateThumbnail<ImgClass>::~TCreateThumbnail()
@@ -131,7 +137,11 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 	// Synchronously download from the source URLs.
 	// TODO: Image size selection.
 	std::vector<RomData::ExtURL> extURLs;
-	int ret = romData->extURLs(imageType, &extURLs, req_size);
+	int ret;
+	{
+		Profiler::Scope profScope(romData->className(), Profiler::Phase::ExtURLs);
+		ret = romData->extURLs(imageType, &extURLs, req_size);
+	}
 	if (ret != 0 || extURLs.empty()) {
 		// No URLs.
 		if (sBIT) {
@@ -145,33 +155,60 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 	const bool extImgDownloadEnabled = config->extImgDownloadEnabled();
 	const bool downloadHighResScans = config->downloadHighResScans();
 
-	CacheManager cache;
-	const auto extURLs_cend = extURLs.cend();
-	for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
-		const RomData::ExtURL &extURL = *iter;
-		std::string proxy = proxyForUrl(extURL.url);
-		cache.setProxyUrl(!proxy.empty() ? proxy.c_str() : nullptr);
+	// Get the download candidates and their proxy servers.
+	// If all candidates use the same proxy server, they can be
+	// checked concurrently. Otherwise, they're checked in order.
+	const size_t count = extURLs.size();
+	std::vector<CacheManager::Candidate> candidates;
+	std::vector<std::string> proxies;
+	candidates.reserve(count);
+	proxies.reserve(count);
+	bool parallel = (count > 1 && config->parallelDownloads());
+	for (const RomData::ExtURL &extURL : extURLs) {
+		proxies.emplace_back(proxyForUrl(extURL.url));
+		if (proxies.back() != proxies.front()) {
+			parallel = false;
+		}
 
 		// Should we attempt to download the image,
 		// or just use the local cache?
 		// TODO: Verify that this works correctly.
-		bool download = extImgDownloadEnabled;
+		CacheManager::Candidate candidate;
+		candidate.cache_key = extURL.cache_key;
+		candidate.download = extImgDownloadEnabled;
 		if (!downloadHighResScans && extURL.high_res) {
 			// Don't download high-resolution images, but
 			// use them if they've already been downloaded.
-			download = false;
+			candidate.download = false;
 		}
+		candidates.emplace_back(std::move(candidate));
+	}
+
+	CacheManager cache;
+	for (size_t idx = 0; idx < count; idx++) {
+		const std::string &proxy = proxies[idx];
+		cache.setProxyUrl(!proxy.empty() ? proxy.c_str() : nullptr);
 
 		// TODO: Have download() return the actual data and/or load the cached file.
 		std::string cache_filename;
-		if (download) {
+		if (parallel) {
+			// Check the remaining candidates concurrently.
+			// If the image can't be loaded, the loop will
+			// continue with the next candidate.
+			const int ret = cache.downloadFirst(candidates, idx, cache_filename);
+			if (ret < 0) {
+				// None of the remaining candidates are available.
+				break;
+			}
+			idx = static_cast<size_t>(ret);
+		} else if (candidates[idx].download) {
 			// Attempt to download the image if it isn't already
 			// present in the rom-properties cache.
-			cache_filename = cache.download(extURL.cache_key);
+			cache_filename = cache.download(candidates[idx].cache_key);
 		} else {
 			// Don't attempt to download the image.
 			// Only check the rom-properties cache.
-			cache_filename = cache.findInCache(extURL.cache_key);
+			cache_filename = cache.findInCache(candidates[idx].cache_key);
 		}
 		if (cache_filename.empty())
 			continue;
@@ -0,0 +1,252 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * Unice68Test.cpp: unice68 prefix depacker test.                          *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// unice68
+#include "unice68.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <chrono>
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class Unice68Test : public ::testing::TestWithParam<size_t>
+{
+	public:
+		/**
+		 * Generate test data.
+		 * The data is a mix of incompressible runs, repeated
+		 * strings, and runs of zero bytes.
+		 * @param size Data size.
+		 * @return Test data.
+		 */
+		static vector<uint8_t> generateData(size_t size);
+
+		/**
+		 * Set up the packed test data.
+		 */
+		static void SetUpTestCase(void);
+
+		/**
+		 * Free the packed test data.
+		 */
+		static void TearDownTestCase(void);
+
+	public:
+		// Depacked data size. (Must be larger than the sliding window.)
+		static const size_t DATA_SIZE = 1024*1024;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10;
+
+		// Test data.
+		static vector<uint8_t> m_data;
+		static vector<uint8_t> m_packed;
+};
+
+const size_t Unice68Test::DATA_SIZE;
+vector<uint8_t> Unice68Test::m_data;
+vector<uint8_t> Unice68Test::m_packed;
+
+/**
+ * Generate test data.
+ * The data is a mix of incompressible runs, repeated
+ * strings, and runs of zero bytes.
+ * @param size Data size.
+ * @return Test data.
+ */
+vector<uint8_t> Unice68Test::generateData(size_t size)
+{
+	vector<uint8_t> data;
+	data.reserve(size);
+
+	// Simple LCG so the data is the same on all systems.
+	uint32_t seed = 0x534E4448;	// 'SNDH'
+	auto rand16 = [&seed]() -> unsigned int {
+		seed = (seed * 1103515245U) + 12345U;
+		return (seed >> 16) & 0xFFFF;
+	};
+
+	while (data.size() < size) {
+		const unsigned int type = rand16() % 3;
+		size_t len;
+		switch (type) {
+			default:
+			case 0:
+				// Incompressible run. (up to 40 KB, which is
+				// longer than the longest literal run)
+				len = (rand16() % 40960) + 1;
+				for (; len > 0; len--) {
+					data.push_back(static_cast<uint8_t>(rand16()));
+				}
+				break;
+
+			case 1: {
+				// Repeated string.
+				if (data.size() < 16) {
+					data.push_back(0);
+					break;
+				}
+				const size_t max_dist = std::min(data.size(), static_cast<size_t>(8192));
+				const size_t dist = (rand16() % max_dist) + 1;
+				len = (rand16() % 1024) + 2;
+				for (; len > 0; len--) {
+					data.push_back(data[data.size() - dist]);
+				}
+				break;
+			}
+
+			case 2:
+				// Run of zero bytes.
+				len = (rand16() % 4096) + 1;
+				data.resize(data.size() + len);
+				break;
+		}
+	}
+
+	data.resize(size);
+	return data;
+}
+
+/**
+ * Set up the packed test data.
+ */
+void Unice68Test::SetUpTestCase(void)
+{
+	m_data = generateData(DATA_SIZE);
+
+	// ICE can expand incompressible data slightly.
+	m_packed.resize(DATA_SIZE + (DATA_SIZE / 8) + 1024);
+	const int packed_size = unice68_packer(m_packed.data(), static_cast<int>(m_packed.size()),
+		m_data.data(), static_cast<int>(m_data.size()));
+	ASSERT_GT(packed_size, 12);
+	m_packed.resize(packed_size);
+}
+
+/**
+ * Free the packed test data.
+ */
+void Unice68Test::TearDownTestCase(void)
+{
+	m_data.clear();
+	m_data.shrink_to_fit();
+	m_packed.clear();
+	m_packed.shrink_to_fit();
+}
+
+/**
+ * Verify that the full depacker returns the original data.
+ */
+TEST_F(Unice68Test, fullDepack)
+{
+	ASSERT_EQ(static_cast<int>(DATA_SIZE), unice68_depacked_size(m_packed.data(), nullptr));
+
+	vector<uint8_t> depacked(DATA_SIZE);
+	ASSERT_EQ(0, unice68_depacker(depacked.data(), depacked.size(), m_packed.data(), m_packed.size()));
+	EXPECT_TRUE(depacked == m_data);
+}
+
+/**
+ * Compare the prefix depacker against the full depacker.
+ */
+TEST_P(Unice68Test, prefixDepack)
+{
+	const size_t prefix_size = GetParam();
+	const size_t expected_size = std::min(prefix_size, DATA_SIZE);
+
+	vector<uint8_t> full(DATA_SIZE);
+	ASSERT_EQ(0, unice68_depacker(full.data(), full.size(), m_packed.data(), m_packed.size()));
+
+	// Add a guard band to detect buffer overflows.
+	vector<uint8_t> prefix(prefix_size + 16, 0xA5);
+	const int ret = unice68_depacker_prefix(prefix.data(), prefix_size, m_packed.data(), m_packed.size());
+	ASSERT_EQ(static_cast<int>(expected_size), ret);
+	EXPECT_EQ(0, memcmp(full.data(), prefix.data(), expected_size));
+	for (size_t i = expected_size; i < prefix.size(); i++) {
+		ASSERT_EQ(0xA5, prefix[i]) << "Guard band overwritten at offset " << i;
+	}
+}
+
+/**
+ * Truncated packed data must fail without crashing.
+ */
+TEST_F(Unice68Test, truncatedData)
+{
+	uint8_t prefix[4096];
+	EXPECT_EQ(-1, unice68_depacker_prefix(prefix, sizeof(prefix), m_packed.data(), 8));
+	EXPECT_EQ(-1, unice68_depacker_prefix(prefix, sizeof(prefix), m_packed.data(), m_packed.size() / 2));
+}
+
+/**
+ * Benchmark the full depacker.
+ */
+TEST_F(Unice68Test, fullDepack_benchmark)
+{
+	vector<uint8_t> depacked(DATA_SIZE);
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		ASSERT_EQ(0, unice68_depacker(depacked.data(), depacked.size(), m_packed.data(), m_packed.size()));
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double msec = std::chrono::duration<double, std::milli>(end - start).count();
+	printf("Full depack: %.2f ms/file\n", msec / BENCHMARK_ITERATIONS);
+}
+
+/**
+ * Benchmark the prefix depacker.
+ */
+TEST_F(Unice68Test, prefixDepack_benchmark)
+{
+	uint8_t prefix[4096];
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		ASSERT_EQ(static_cast<int>(sizeof(prefix)),
+			unice68_depacker_prefix(prefix, sizeof(prefix), m_packed.data(), m_packed.size()));
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double msec = std::chrono::duration<double, std::milli>(end - start).count();
+	printf("Prefix depack: %.2f ms/file\n", msec / BENCHMARK_ITERATIONS);
+}
+
+// Prefix sizes.
+// NOTE: The sliding window is used for prefixes smaller than
+// the depacked size minus 96 KB.
+INSTANTIATE_TEST_SUITE_P(prefixSizes, Unice68Test,
+	::testing::Values(
+		16, 4096, 4097, 65536,
+		Unice68Test::DATA_SIZE - (128*1024),
+		Unice68Test::DATA_SIZE - 1,
+		Unice68Test::DATA_SIZE,
+		Unice68Test::DATA_SIZE + 100));
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: unice68 tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,1782 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomDataBenchmark.cpp: RomData synthetic-corpus benchmark.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// zlib
+#include <zlib.h>
+
+// gzclose_r() and gzclose_w() were introduced in zlib-1.2.4.
+#if (ZLIB_VER_MAJOR > 1) || \
+    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR > 2) || \
+    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR == 2 && ZLIB_VER_REVISION >= 4)
+// zlib-1.2.4 or later
+#else
+#define gzclose_r(file) gzclose(file)
+#define gzclose_w(file) gzclose(file)
+#endif
+
+// librpbase, librpfile, librptexture
+#include "common.h"
+#include "librpcpu/byteswap_rp.h"
+#include "librpbase/RomData.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using LibRpTexture::rp_image;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+#include "libromdata/disc/WiiPartition.hpp"
+
+// Format structs.
+#include "libromdata/Audio/nsf_structs.h"
+#include "libromdata/Audio/vgm_structs.h"
+#include "libromdata/Console/gcn_banner.h"
+#include "libromdata/Console/gcn_structs.h"
+#include "libromdata/Console/nes_structs.h"
+#include "libromdata/Console/wii_structs.h"
+#include "libromdata/Handheld/n3ds_structs.h"
+#include "libromdata/Handheld/nds_structs.h"
+#include "libromdata/disc/ciso_gcn.h"
+#include "libromdata/disc/gcz_structs.h"
+#include "libromdata/disc/wux_structs.h"
+#include "librptexture/fileformat/dds_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <chrono>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * Synthetic ROM image generator.
+ * @param data Output buffer.
+ */
+typedef void (*SyntheticGenerator)(vector<uint8_t> &data);
+
+struct SyntheticFormat
+{
+	const char *name;		// Format name (test case suffix; must be alphanumeric)
+	const char *ext;		// File extension
+	const char *className;		// Expected RomData class name
+	bool hasImage;			// True if the format has an internal image.
+	bool gzip;			// True to gzip-compress the image.
+	SyntheticGenerator generate;	// Image generator
+
+	SyntheticFormat(const char *name, const char *ext, const char *className,
+			bool hasImage, bool gzip, SyntheticGenerator generate)
+		: name(name)
+		, ext(ext)
+		, className(className)
+		, hasImage(hasImage)
+		, gzip(gzip)
+		, generate(generate)
+	{ }
+};
+
+/**
+ * Formatting function for SyntheticFormat.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, const SyntheticFormat& format) {
+	return os << format.name;
+};
+
+class RomDataBenchmark : public ::testing::TestWithParam<SyntheticFormat>
+{
+	protected:
+		RomDataBenchmark()
+			: m_size(0)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 1000;
+
+		// Filename for machine-readable results. (JSON Lines)
+		// If nullptr, results are only written to stdout.
+		static const TCHAR *json_out_filename;
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<SyntheticFormat> &info);
+
+	protected:
+		/**
+		 * Open the synthetic image and create a RomData object.
+		 * @param attrs RomDataFactory::RomDataAttr bitfield.
+		 * @return RomData object, or nullptr on error.
+		 */
+		RomData *openRomData(unsigned int attrs = 0) const;
+
+		/**
+		 * Decode and rescale all internal images.
+		 * This is the thumbnailing step without the
+		 * external image and download cache overhead.
+		 * @param romData RomData object.
+		 * @return Number of internal images decoded.
+		 */
+		static unsigned int createThumbnails(const RomData *romData);
+
+	protected:
+		string m_filename;	// Synthetic image filename
+		size_t m_size;		// Synthetic image size, in bytes (uncompressed)
+
+	public:
+		/** Helper functions for generators. **/
+
+		/**
+		 * Fill a buffer with a compressible, non-zero test pattern.
+		 * @param p Buffer.
+		 * @param size Size of buffer.
+		 * @param seed Pattern seed.
+		 */
+		static void fillPattern(uint8_t *p, size_t size, uint8_t seed);
+
+		/**
+		 * Write a string into a buffer without a NULL terminator.
+		 * @param p Buffer.
+		 * @param str String.
+		 */
+		static inline void putStr(uint8_t *p, const char *str)
+		{
+			memcpy(p, str, strlen(str));
+		}
+
+		/**
+		 * Write a string into a UTF-16LE buffer.
+		 * The string must be ASCII.
+		 * @param p Buffer.
+		 * @param str String.
+		 */
+		static void putStrU16(char16_t *p, const char *str);
+
+		static inline void putBE16(uint8_t *p, uint16_t val)
+		{
+			val = cpu_to_be16(val);
+			memcpy(p, &val, sizeof(val));
+		}
+		static inline void putBE32(uint8_t *p, uint32_t val)
+		{
+			val = cpu_to_be32(val);
+			memcpy(p, &val, sizeof(val));
+		}
+		static inline void putLE32(uint8_t *p, uint32_t val)
+		{
+			val = cpu_to_le32(val);
+			memcpy(p, &val, sizeof(val));
+		}
+
+	public:
+		/** Generators **/
+
+		static void gen_NES(vector<uint8_t> &data);
+		static void gen_N64(vector<uint8_t> &data);
+		static void gen_MegaDrive(vector<uint8_t> &data);
+		static void gen_DMG(vector<uint8_t> &data);
+		static void gen_GBA(vector<uint8_t> &data);
+		static void gen_NDS(vector<uint8_t> &data);
+		static void gen_GameCube_ISO(vector<uint8_t> &data);
+		static void gen_GameCube_CISO(vector<uint8_t> &data);
+		static void gen_GameCube_GCZ(vector<uint8_t> &data);
+		static void gen_GameCube_WBFS(vector<uint8_t> &data);
+		static void gen_Wii_MultiPartition(vector<uint8_t> &data);
+		static void gen_WiiU_WUX(vector<uint8_t> &data);
+		static void gen_N3DS_SMDH(vector<uint8_t> &data);
+		static void gen_N3DS_CIA(vector<uint8_t> &data);
+		static void gen_DDS(vector<uint8_t> &data);
+		static void gen_NSF(vector<uint8_t> &data);
+		static void gen_VGM(vector<uint8_t> &data);
+
+		// GameCube disc image parameters.
+		// The disc image is split into 32 KB blocks so it can
+		// be reused for the compressed and sparse containers.
+		static const unsigned int GCN_BLOCK_SIZE = 32768;
+		static const unsigned int GCN_BLOCK_COUNT = 8;
+		static const unsigned int GCN_DISC_SIZE = GCN_BLOCK_SIZE * GCN_BLOCK_COUNT;
+
+		// Wii multi-partition disc image parameters.
+		// NOTE: Partitions are unencrypted (NoCrypto), since
+		// encrypted partitions require the Wii common key.
+		static const unsigned int WII_PT_COUNT = 16;
+		static const uint32_t WII_PT_START = 0x50000;
+		static const uint32_t WII_PT_DATA_OFFSET = 0x20000;
+		static const unsigned int WII_PT_SECTOR_COUNT = 8;
+		static const uint32_t WII_PT_SIZE = WII_PT_DATA_OFFSET + (WII_PT_SECTOR_COUNT * 0x8000);
+		static const unsigned int WII_PT_FILE_COUNT = 1024;
+
+		// Nintendo 3DS CIA parameters.
+		// NOTE: Contents are unencrypted (NoCrypto), since
+		// encrypted contents require the 3DS AES keys.
+		static const unsigned int N3DS_CIA_CONTENT_COUNT = 128;
+		static const uint32_t N3DS_CIA_CONTENT_SIZE = 0x400;
+};
+
+const TCHAR *RomDataBenchmark::json_out_filename = nullptr;
+
+/**
+ * Fill a buffer with a compressible, non-zero test pattern.
+ * @param p Buffer.
+ * @param size Size of buffer.
+ * @param seed Pattern seed.
+ */
+void RomDataBenchmark::fillPattern(uint8_t *p, size_t size, uint8_t seed)
+{
+	for (size_t i = 0; i < size; i++) {
+		p[i] = static_cast<uint8_t>(((i >> 4) * 0x1D) ^ (i & 0x0F) ^ seed) | 1;
+	}
+}
+
+/**
+ * Write a string into a UTF-16LE buffer.
+ * The string must be ASCII.
+ * @param p Buffer.
+ * @param str String.
+ */
+void RomDataBenchmark::putStrU16(char16_t *p, const char *str)
+{
+	for (; *str != '\0'; p++, str++) {
+		*p = cpu_to_le16(static_cast<char16_t>(*str));
+	}
+}
+
+/** Generators **/
+
+/**
+ * NES: iNES header, 32 KB PRG ROM, 8 KB CHR ROM.
+ */
+void RomDataBenchmark::gen_NES(vector<uint8_t> &data)
+{
+	data.assign(sizeof(INES_RomHeader) + (32768 + 8192), 0);
+	INES_RomHeader *const inesHeader = reinterpret_cast<INES_RomHeader*>(data.data());
+	inesHeader->magic = cpu_to_be32(INES_MAGIC);
+	inesHeader->prg_banks = 2;
+	inesHeader->chr_banks = 1;
+	inesHeader->mapper_lo = 0x01;	// Vertical mirroring
+	fillPattern(&data[sizeof(INES_RomHeader)], data.size() - sizeof(INES_RomHeader), 0x4E);
+}
+
+/**
+ * Nintendo 64: Z64 (big-endian) ROM header, 1 MB.
+ */
+void RomDataBenchmark::gen_N64(vector<uint8_t> &data)
+{
+	data.assign(1024*1024, 0);
+	fillPattern(&data[0x1000], data.size() - 0x1000, 0x64);
+	uint8_t *const p = data.data();
+	putBE32(&p[0x00], 0x80371240);	// Magic
+	putBE32(&p[0x04], 0x0000000F);	// Clock rate
+	putBE32(&p[0x08], 0x80000400);	// Entry point
+	putBE32(&p[0x0C], 0x00001449);	// Release
+	putBE32(&p[0x10], 0x12345678);	// CRC1
+	putBE32(&p[0x14], 0x9ABCDEF0);	// CRC2
+	memset(&p[0x20], ' ', 20);
+	putStr(&p[0x20], "RP BENCHMARK");	// Title
+	putStr(&p[0x3B], "NRPE");	// ID4
+}
+
+/**
+ * Sega Mega Drive: Plain binary ROM, 128 KB.
+ */
+void RomDataBenchmark::gen_MegaDrive(vector<uint8_t> &data)
+{
+	data.assign(128*1024, 0);
+	fillPattern(&data[0x200], data.size() - 0x200, 0x4D);
+	uint8_t *const p = data.data();
+	putBE32(&p[0x000], 0x00FFFE00);	// Initial SP
+	putBE32(&p[0x004], 0x00000200);	// Entry point
+	putStr(&p[0x100], "SEGA MEGA DRIVE ");
+	putStr(&p[0x110], "(C)SEGA 2021.JUN");
+	memset(&p[0x120], ' ', 48*2);
+	putStr(&p[0x120], "ROM PROPERTIES BENCHMARK");
+	putStr(&p[0x150], "ROM PROPERTIES BENCHMARK");
+	putStr(&p[0x180], "GM 00000000-00");
+	putBE16(&p[0x18E], 0x1234);	// Checksum
+	memset(&p[0x190], ' ', 16);
+	putStr(&p[0x190], "J6");	// I/O support
+	putBE32(&p[0x1A0], 0x00000000);	// ROM start
+	putBE32(&p[0x1A4], static_cast<uint32_t>(data.size() - 1));	// ROM end
+	putBE32(&p[0x1A8], 0x00FF0000);	// RAM start
+	putBE32(&p[0x1AC], 0x00FFFFFF);	// RAM end
+	memset(&p[0x1F0], ' ', 16);
+	putStr(&p[0x1F0], "JUE");	// Region codes
+}
+
+/**
+ * Game Boy: ROM-only cartridge, 32 KB.
+ */
+void RomDataBenchmark::gen_DMG(vector<uint8_t> &data)
+{
+	static const uint8_t dmg_nintendo[0x30] = {
+		0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B,
+		0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D,
+		0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E,
+		0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
+		0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC,
+		0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E,
+	};
+
+	data.assign(32768, 0);
+	fillPattern(&data[0x150], data.size() - 0x150, 0x47);
+	uint8_t *const p = data.data();
+	p[0x100] = 0x00;	// nop
+	p[0x101] = 0xC3;	// jp $0150
+	p[0x102] = 0x50;
+	p[0x103] = 0x01;
+	memcpy(&p[0x104], dmg_nintendo, sizeof(dmg_nintendo));
+	memset(&p[0x134], 0, 0x150 - 0x134);
+	putStr(&p[0x134], "RPBENCHMARK");
+	p[0x14A] = 0x01;	// Region: Non-Japanese
+	p[0x14B] = 0x33;	// Old licensee: Use new licensee code
+	putStr(&p[0x144], "01");	// New licensee code
+
+	// Header checksum.
+	uint8_t checksum = 0;
+	for (unsigned int i = 0x134; i <= 0x14C; i++) {
+		checksum = checksum - p[i] - 1;
+	}
+	p[0x14D] = checksum;
+}
+
+/**
+ * Game Boy Advance: 256 KB ROM.
+ */
+void RomDataBenchmark::gen_GBA(vector<uint8_t> &data)
+{
+	static const uint8_t nintendo_gba_logo[16] = {
+		0x24, 0xFF, 0xAE, 0x51, 0x69, 0x9A, 0xA2, 0x21,
+		0x3D, 0x84, 0x82, 0x0A, 0x84, 0xE4, 0x09, 0xAD
+	};
+
+	data.assign(256*1024, 0);
+	fillPattern(&data[0xC0], data.size() - 0xC0, 0x41);
+	uint8_t *const p = data.data();
+	putLE32(&p[0x00], 0xEA00002E);	// b 0xC0
+	memcpy(&p[0x04], nintendo_gba_logo, sizeof(nintendo_gba_logo));
+	memset(&p[0xA0], 0, 0xC0 - 0xA0);
+	putStr(&p[0xA0], "RPBENCHMARK");	// Title
+	putStr(&p[0xAC], "ARPE");	// ID4
+	putStr(&p[0xB0], "01");		// Company
+	p[0xB2] = 0x96;	// Fixed value
+
+	// Header checksum.
+	uint8_t checksum = 0;
+	for (unsigned int i = 0xA0; i <= 0xBC; i++) {
+		checksum -= p[i];
+	}
+	p[0xBD] = checksum - 0x19;
+}
+
+/**
+ * Nintendo DS: 64 KB ROM with a v1 icon/title.
+ */
+void RomDataBenchmark::gen_NDS(vector<uint8_t> &data)
+{
+	static const uint8_t nintendo_gba_logo[16] = {
+		0x24, 0xFF, 0xAE, 0x51, 0x69, 0x9A, 0xA2, 0x21,
+		0x3D, 0x84, 0x82, 0x0A, 0x84, 0xE4, 0x09, 0xAD
+	};
+	static const uint32_t icon_offset = 0x8400;
+
+	data.assign(64*1024, 0);
+	fillPattern(&data[0x4000], 0x4000, 0x44);
+
+	NDS_RomHeader *const romHeader = reinterpret_cast<NDS_RomHeader*>(data.data());
+	memcpy(romHeader->title, "RPBENCHMARK", 11);
+	memcpy(romHeader->id6, "ARPE01", 6);
+	romHeader->unitcode = 0x00;
+	romHeader->icon_offset = cpu_to_le32(icon_offset);
+	memcpy(romHeader->nintendo_logo, nintendo_gba_logo, sizeof(nintendo_gba_logo));
+	romHeader->nintendo_logo_checksum = cpu_to_le16(0xCF56);
+
+	NDS_IconTitleData *const iconTitle = reinterpret_cast<NDS_IconTitleData*>(&data[icon_offset]);
+	iconTitle->version = cpu_to_le16(0x0001);
+	fillPattern(iconTitle->icon_data, sizeof(iconTitle->icon_data), 0x12);
+	for (unsigned int i = 0; i < ARRAY_SIZE(iconTitle->icon_pal); i++) {
+		// BGR555
+		iconTitle->icon_pal[i] = cpu_to_le16(static_cast<uint16_t>(i * 0x0842));
+	}
+	for (unsigned int i = 0; i < 6; i++) {
+		putStrU16(iconTitle->title[i], "ROM Properties\nBenchmark\nGerbilSoft");
+	}
+}
+
+/**
+ * GameCube: 256 KB disc image with an FST and opening.bnr.
+ *
+ * Block layout: (32 KB blocks)
+ * - 0: Disc header, boot block, bi2, apploader, FST
+ * - 1: opening.bnr
+ * - 2-5: /data/file00.bin - /data/file15.bin
+ * - 6: Unused (zero; sparse in CISO)
+ * - 7: padding.bin
+ */
+void RomDataBenchmark::gen_GameCube_ISO(vector<uint8_t> &data)
+{
+	static const uint32_t fst_offset = 0x4000;
+	static const uint32_t bnr_offset = GCN_BLOCK_SIZE * 1;
+	static const uint32_t data_offset = GCN_BLOCK_SIZE * 2;
+	static const uint32_t data_file_size = 0x2000;
+	static const unsigned int data_file_count = 16;
+	static const uint32_t padding_offset = GCN_BLOCK_SIZE * 7;
+
+	data.assign(GCN_DISC_SIZE, 0);
+	uint8_t *const p = data.data();
+
+	// Disc header.
+	GCN_DiscHeader *const discHeader = reinterpret_cast<GCN_DiscHeader*>(p);
+	memcpy(discHeader->id6, "GRPE01", 6);
+	discHeader->magic_gcn = cpu_to_be32(GCN_MAGIC);
+	strcpy(discHeader->game_title, "ROM Properties Benchmark");
+
+	// bi2.bin
+	putBE32(&p[GCN_Boot_Info_ADDRESS + offsetof(GCN_Boot_Info, region_code)], GCN_REGION_USA);
+
+	// Apploader build date.
+	putStr(&p[0x2440], "2021/06/01");
+
+	// FST: root, opening.bnr, data/, data/file??.bin, padding.bin
+	static const unsigned int fst_count = 1 + 1 + 1 + data_file_count + 1;
+	vector<GCN_FST_Entry> fst(fst_count);
+	string strtbl;
+	unsigned int idx = 0;
+
+	auto addEntry = [&](uint8_t type, const char *name, uint32_t val1, uint32_t val2) {
+		GCN_FST_Entry &entry = fst[idx++];
+		entry.file_type_name_offset = cpu_to_be32((type << 24) | static_cast<uint32_t>(strtbl.size()));
+		entry.file.offset = cpu_to_be32(val1);
+		entry.file.size = cpu_to_be32(val2);
+		strtbl += name;
+		strtbl += '\0';
+	};
+	addEntry(1, "", 0, fst_count);
+	addEntry(0, "opening.bnr", bnr_offset, sizeof(gcn_banner_bnr1_t));
+	addEntry(1, "data", 0, 3 + data_file_count);
+	for (unsigned int i = 0; i < data_file_count; i++) {
+		char name[16];
+		snprintf(name, sizeof(name), "file%02u.bin", i);
+		addEntry(0, name, data_offset + (i * data_file_size), data_file_size);
+	}
+	addEntry(0, "padding.bin", padding_offset, GCN_BLOCK_SIZE);
+
+	const uint32_t fst_size = static_cast<uint32_t>((fst_count * sizeof(GCN_FST_Entry)) + strtbl.size());
+	memcpy(&p[fst_offset], fst.data(), fst_count * sizeof(GCN_FST_Entry));
+	memcpy(&p[fst_offset + (fst_count * sizeof(GCN_FST_Entry))], strtbl.data(), strtbl.size());
+
+	// Boot block.
+	GCN_Boot_Block *const bootBlock = reinterpret_cast<GCN_Boot_Block*>(&p[GCN_Boot_Block_ADDRESS]);
+	bootBlock->dol_offset = cpu_to_be32(0x2800);
+	bootBlock->fst_offset = cpu_to_be32(fst_offset);
+	bootBlock->fst_size = cpu_to_be32(fst_size);
+	bootBlock->fst_max_size = cpu_to_be32(fst_size);
+
+	// opening.bnr
+	gcn_banner_bnr1_t *const bnr1 = reinterpret_cast<gcn_banner_bnr1_t*>(&p[bnr_offset]);
+	bnr1->magic = cpu_to_be32(GCN_BANNER_MAGIC_BNR1);
+	for (unsigned int i = 0; i < ARRAY_SIZE(bnr1->banner); i++) {
+		// RGB5A3 with the opaque bit set.
+		bnr1->banner[i] = cpu_to_be16(static_cast<uint16_t>(0x8000 | ((i * 0x21) & 0x7FFF)));
+	}
+	strcpy(bnr1->comment.gamename, "RP Benchmark");
+	strcpy(bnr1->comment.company, "GerbilSoft");
+	strcpy(bnr1->comment.gamename_full, "ROM Properties Benchmark");
+	strcpy(bnr1->comment.company_full, "GerbilSoft");
+	strcpy(bnr1->comment.gamedesc, "Synthetic disc image for benchmarking.");
+
+	// File data.
+	fillPattern(&p[data_offset], data_file_count * data_file_size, 0x20);
+	fillPattern(&p[padding_offset], GCN_BLOCK_SIZE, 0x70);
+}
+
+/**
+ * GameCube: CISO container. Unused blocks are omitted.
+ */
+void RomDataBenchmark::gen_GameCube_CISO(vector<uint8_t> &data)
+{
+	vector<uint8_t> iso;
+	gen_GameCube_ISO(iso);
+
+	data.assign(CISO_HEADER_SIZE, 0);
+	CISOHeader *cisoHeader = reinterpret_cast<CISOHeader*>(data.data());
+	cisoHeader->magic = cpu_to_be32(CISO_MAGIC);
+	cisoHeader->block_size = cpu_to_le32(GCN_BLOCK_SIZE);
+
+	static const uint8_t zero_block[GCN_BLOCK_SIZE] = {0};
+	for (unsigned int i = 0; i < GCN_BLOCK_COUNT; i++) {
+		const uint8_t *const block = &iso[i * GCN_BLOCK_SIZE];
+		if (!memcmp(block, zero_block, GCN_BLOCK_SIZE)) {
+			// Unused block.
+			continue;
+		}
+
+		// NOTE: insert() may reallocate the buffer.
+		data[offsetof(CISOHeader, map) + i] = 1;
+		data.insert(data.end(), block, block + GCN_BLOCK_SIZE);
+	}
+}
+
+/**
+ * GameCube: GCZ container. All blocks are zlib-compressed.
+ */
+void RomDataBenchmark::gen_GameCube_GCZ(vector<uint8_t> &data)
+{
+	vector<uint8_t> iso;
+	gen_GameCube_ISO(iso);
+
+	// Compress the blocks.
+	vector<uint8_t> z_data;
+	uint64_t blockPointers[GCN_BLOCK_COUNT];
+	uint32_t hashes[GCN_BLOCK_COUNT];
+	vector<uint8_t> z_block(compressBound(GCN_BLOCK_SIZE));
+	for (unsigned int i = 0; i < GCN_BLOCK_COUNT; i++) {
+		uLongf z_block_size = static_cast<uLongf>(z_block.size());
+		int ret = compress2(z_block.data(), &z_block_size,
+			&iso[i * GCN_BLOCK_SIZE], GCN_BLOCK_SIZE, Z_BEST_COMPRESSION);
+		assert(ret == Z_OK);
+		assert(z_block_size < GCN_BLOCK_SIZE);
+		RP_UNUSED(ret);
+
+		blockPointers[i] = cpu_to_le64(z_data.size());
+		hashes[i] = cpu_to_le32(adler32(adler32(0L, Z_NULL, 0), z_block.data(), z_block_size));
+		z_data.insert(z_data.end(), z_block.data(), z_block.data() + z_block_size);
+	}
+
+	GczHeader gczHeader;
+	gczHeader.magic = cpu_to_le32(GCZ_MAGIC);
+	gczHeader.sub_type = cpu_to_le32(GCZ_SubType_GameCube);
+	gczHeader.z_data_size = cpu_to_le64(z_data.size());
+	gczHeader.data_size = cpu_to_le64(GCN_DISC_SIZE);
+	gczHeader.block_size = cpu_to_le32(GCN_BLOCK_SIZE);
+	gczHeader.num_blocks = cpu_to_le32(GCN_BLOCK_COUNT);
+
+	const uint8_t *const pHeader = reinterpret_cast<const uint8_t*>(&gczHeader);
+	const uint8_t *const pBlockPointers = reinterpret_cast<const uint8_t*>(blockPointers);
+	const uint8_t *const pHashes = reinterpret_cast<const uint8_t*>(hashes);
+	data.assign(pHeader, pHeader + sizeof(gczHeader));
+	data.insert(data.end(), pBlockPointers, pBlockPointers + sizeof(blockPointers));
+	data.insert(data.end(), pHashes, pHashes + sizeof(hashes));
+	data.insert(data.end(), z_data.begin(), z_data.end());
+}
+
+/**
+ * GameCube: WBFS container with a single disc.
+ */
+void RomDataBenchmark::gen_GameCube_WBFS(vector<uint8_t> &data)
+{
+	static const uint8_t hd_sec_sz_s = 9;		// 512-byte HDD sectors
+	static const uint8_t wbfs_sec_sz_s = 21;	// 2 MB WBFS sectors
+	static const uint32_t n_hd_sec = (1U << 21);	// 1 GB partition
+
+	vector<uint8_t> iso;
+	gen_GameCube_ISO(iso);
+
+	data.assign((1U << wbfs_sec_sz_s) + GCN_DISC_SIZE, 0);
+	uint8_t *const p = data.data();
+
+	// WBFS header.
+	putStr(&p[0], "WBFS");
+	putBE32(&p[4], n_hd_sec);
+	p[8] = hd_sec_sz_s;
+	p[9] = wbfs_sec_sz_s;
+	p[12] = 1;	// disc_table[0]
+
+	// Disc info: Disc header copy, followed by the WLBA table.
+	// The entire disc fits in WBFS sector 1.
+	uint8_t *const discInfo = &p[1U << hd_sec_sz_s];
+	memcpy(discInfo, iso.data(), 0x100);
+	putBE16(&discInfo[0x100], 1);
+
+	memcpy(&p[1U << wbfs_sec_sz_s], iso.data(), GCN_DISC_SIZE);
+}
+
+/**
+ * Wii: Disc image with one game partition, one update partition,
+ * and multiple channel partitions, each with its own FST.
+ */
+void RomDataBenchmark::gen_Wii_MultiPartition(vector<uint8_t> &data)
+{
+	static const uint32_t sector_size = 0x8000;
+	static const uint32_t sector_data_offset = 0x400;
+	static const uint32_t sector_data_size = 0x7C00;
+	static const uint32_t fst_offset = sector_data_size;	// Partition sector 1
+	static const uint32_t file_data_offset = 0x10000;
+	static const uint32_t file_size = 0x20;
+
+	data.assign(WII_PT_START + (WII_PT_COUNT * WII_PT_SIZE), 0);
+	uint8_t *const p = data.data();
+
+	// Disc header.
+	GCN_DiscHeader *const discHeader = reinterpret_cast<GCN_DiscHeader*>(p);
+	memcpy(discHeader->id6, "RRPE01", 6);
+	discHeader->magic_wii = cpu_to_be32(WII_MAGIC);
+	strcpy(discHeader->game_title, "ROM Properties Benchmark");
+	discHeader->disc_noCrypto = 1;
+
+	// Region setting.
+	putBE32(&p[RVL_RegionSetting_ADDRESS + offsetof(RVL_RegionSetting, region_code)], GCN_REGION_USA);
+
+	// Volume group and partition tables.
+	static const uint32_t pt_addr = RVL_VolumeGroupTable_ADDRESS + sizeof(RVL_VolumeGroupTable);
+	RVL_VolumeGroupTable *const vgtbl = reinterpret_cast<RVL_VolumeGroupTable*>(&p[RVL_VolumeGroupTable_ADDRESS]);
+	vgtbl->vg[0].count = cpu_to_be32(WII_PT_COUNT);
+	vgtbl->vg[0].addr = cpu_to_be32(pt_addr >> 2);
+	RVL_PartitionTableEntry *const pt = reinterpret_cast<RVL_PartitionTableEntry*>(&p[pt_addr]);
+	for (unsigned int i = 0; i < WII_PT_COUNT; i++) {
+		pt[i].addr = cpu_to_be32((WII_PT_START + (i * WII_PT_SIZE)) >> 2);
+		pt[i].type = cpu_to_be32(i == 0 ? RVL_PT_GAME : (i == 1 ? RVL_PT_UPDATE : RVL_PT_CHANNEL));
+	}
+
+	// FST: root, _sys/, _sys/RVL-WiiSystemmenu-v481.wad, files/, files/file????.bin
+	// NOTE: Wii FST offsets are rshifted by 2.
+	static const unsigned int fst_count = 1 + 2 + 1 + WII_PT_FILE_COUNT;
+	vector<GCN_FST_Entry> fst(fst_count);
+	string strtbl;
+	unsigned int idx = 0;
+
+	auto addEntry = [&](uint8_t type, const char *name, uint32_t val1, uint32_t val2) {
+		GCN_FST_Entry &entry = fst[idx++];
+		entry.file_type_name_offset = cpu_to_be32((type << 24) | static_cast<uint32_t>(strtbl.size()));
+		entry.file.offset = cpu_to_be32(val1);
+		entry.file.size = cpu_to_be32(val2);
+		strtbl += name;
+		strtbl += '\0';
+	};
+	addEntry(1, "", 0, fst_count);
+	addEntry(1, "_sys", 0, 3);
+	addEntry(0, "RVL-WiiSystemmenu-v481.wad", file_data_offset >> 2, file_size);
+	addEntry(1, "files", 0, fst_count);
+	for (unsigned int i = 0; i < WII_PT_FILE_COUNT; i++) {
+		char name[16];
+		snprintf(name, sizeof(name), "file%04u.bin", i);
+		addEntry(0, name, (file_data_offset + ((i + 1) * file_size)) >> 2, file_size);
+	}
+
+	vector<uint8_t> fst_data(ALIGN_BYTES(4, (fst_count * sizeof(GCN_FST_Entry)) + strtbl.size()));
+	memcpy(fst_data.data(), fst.data(), fst_count * sizeof(GCN_FST_Entry));
+	memcpy(&fst_data[fst_count * sizeof(GCN_FST_Entry)], strtbl.data(), strtbl.size());
+
+	// Partition data header: disc header and boot block.
+	uint8_t pt_boot[GCN_Boot_Block_ADDRESS + sizeof(GCN_Boot_Block)];
+	memset(pt_boot, 0, sizeof(pt_boot));
+	memcpy(pt_boot, p, sizeof(GCN_DiscHeader));
+	GCN_Boot_Block *const bootBlock = reinterpret_cast<GCN_Boot_Block*>(&pt_boot[GCN_Boot_Block_ADDRESS]);
+	bootBlock->dol_offset = cpu_to_be32(0x2800 >> 2);
+	bootBlock->fst_offset = cpu_to_be32(fst_offset >> 2);
+	bootBlock->fst_size = cpu_to_be32(static_cast<uint32_t>(fst_data.size() >> 2));
+	bootBlock->fst_max_size = bootBlock->fst_size;
+
+	// Write data to a partition's data area, skipping the hashes in each sector.
+	auto putPartData = [](uint8_t *pPart, uint32_t addr, const uint8_t *src, size_t len) {
+		while (len > 0) {
+			const uint32_t sector = addr / sector_data_size;
+			const uint32_t sector_offset = addr % sector_data_size;
+			const size_t chunk = std::min(len, static_cast<size_t>(sector_data_size - sector_offset));
+			memcpy(&pPart[WII_PT_DATA_OFFSET + (sector * sector_size) + sector_data_offset + sector_offset], src, chunk);
+			addr += static_cast<uint32_t>(chunk);
+			src += chunk;
+			len -= chunk;
+		}
+	};
+
+	for (unsigned int i = 0; i < WII_PT_COUNT; i++) {
+		uint8_t *const pPart = &p[WII_PT_START + (i * WII_PT_SIZE)];
+
+		// Partition header.
+		Nintendo_TitleID_BE_t tid;
+		tid.hi = cpu_to_be32(i == 0 ? 0x00010000 : 0x00010008);
+		tid.lo = cpu_to_be32(i == 0 ? 0x52525045 : (0x48410000 | i));	// "RRPE" or "HA??"
+
+		RVL_PartitionHeader *const ptHeader = reinterpret_cast<RVL_PartitionHeader*>(pPart);
+		ptHeader->ticket.signature_type = cpu_to_be32(RVL_SIGNATURE_TYPE_RSA2048);
+		strcpy(ptHeader->ticket.signature_issuer, "Root-CA00000001-XS00000003");
+		ptHeader->ticket.title_id = tid;
+		ptHeader->tmd_size = cpu_to_be32(sizeof(RVL_TMD_Header));
+		ptHeader->tmd_offset = cpu_to_be32(offsetof(RVL_PartitionHeader, tmd) >> 2);
+		ptHeader->data_offset = cpu_to_be32(WII_PT_DATA_OFFSET >> 2);
+		ptHeader->data_size = cpu_to_be32((WII_PT_SECTOR_COUNT * sector_size) >> 2);
+
+		RVL_TMD_Header *const tmdHeader = reinterpret_cast<RVL_TMD_Header*>(ptHeader->tmd);
+		tmdHeader->signature_type = cpu_to_be32(RVL_SIGNATURE_TYPE_RSA2048);
+		strcpy(tmdHeader->signature_issuer, "Root-CA00000001-CP00000004");
+		tmdHeader->sys_version.hi = cpu_to_be32(0x00000001);
+		tmdHeader->sys_version.lo = cpu_to_be32(58);
+		tmdHeader->title_id = tid;
+
+		// Partition data.
+		putPartData(pPart, 0, pt_boot, sizeof(pt_boot));
+		putPartData(pPart, fst_offset, fst_data.data(), fst_data.size());
+	}
+}
+
+/**
+ * Wii U: WUX container. Duplicate sectors are deduplicated.
+ */
+void RomDataBenchmark::gen_WiiU_WUX(vector<uint8_t> &data)
+{
+	static const uint32_t sectorSize = 32768;
+	static const unsigned int sectorCount = 4;
+
+	// Uncompressed disc image.
+	vector<uint8_t> wud(sectorSize * sectorCount, 0);
+	putStr(&wud[0], "WUP-P-ARPE-00-551USA-0");
+	putBE32(&wud[0x10000], 0xCC549EB9);	// Secondary magic
+
+	data.assign(sectorSize, 0);
+	wuxHeader_t *wuxHeader = reinterpret_cast<wuxHeader_t*>(data.data());
+	wuxHeader->magic[0] = cpu_to_le32(WUX_MAGIC_0);
+	wuxHeader->magic[1] = cpu_to_le32(WUX_MAGIC_1);
+	wuxHeader->sectorSize = cpu_to_le32(sectorSize);
+	wuxHeader->uncompressedSize = cpu_to_le64(wud.size());
+
+	// Index table.
+	vector<const uint8_t*> sectors;
+	for (unsigned int i = 0; i < sectorCount; i++) {
+		const uint8_t *const sector = &wud[i * sectorSize];
+		uint32_t physIdx;
+		for (physIdx = 0; physIdx < sectors.size(); physIdx++) {
+			if (!memcmp(sectors[physIdx], sector, sectorSize))
+				break;
+		}
+		if (physIdx == sectors.size()) {
+			sectors.push_back(sector);
+		}
+		putLE32(&data[sizeof(wuxHeader_t) + (i * sizeof(uint32_t))], physIdx);
+	}
+
+	for (const uint8_t *sector : sectors) {
+		data.insert(data.end(), sector, sector + sectorSize);
+	}
+}
+
+/**
+ * Nintendo 3DS: SMDH with titles and icons.
+ */
+void RomDataBenchmark::gen_N3DS_SMDH(vector<uint8_t> &data)
+{
+	data.assign(sizeof(N3DS_SMDH_Header_t) + sizeof(N3DS_SMDH_Icon_t), 0);
+
+	N3DS_SMDH_Header_t *const smdhHeader = reinterpret_cast<N3DS_SMDH_Header_t*>(data.data());
+	smdhHeader->magic = cpu_to_be32(N3DS_SMDH_HEADER_MAGIC);
+	for (unsigned int i = 0; i < ARRAY_SIZE(smdhHeader->titles); i++) {
+		putStrU16(smdhHeader->titles[i].desc_short, "RP Benchmark");
+		putStrU16(smdhHeader->titles[i].desc_long, "ROM Properties Benchmark");
+		putStrU16(smdhHeader->titles[i].publisher, "GerbilSoft");
+	}
+
+	N3DS_SMDH_Icon_t *const smdhIcon = reinterpret_cast<N3DS_SMDH_Icon_t*>(&data[sizeof(N3DS_SMDH_Header_t)]);
+	for (unsigned int i = 0; i < ARRAY_SIZE(smdhIcon->small); i++) {
+		smdhIcon->small[i] = cpu_to_le16(static_cast<uint16_t>(i * 0x0821));
+	}
+	for (unsigned int i = 0; i < ARRAY_SIZE(smdhIcon->large); i++) {
+		smdhIcon->large[i] = cpu_to_le16(static_cast<uint16_t>(i * 0x0821));
+	}
+}
+
+/**
+ * Nintendo 3DS: CIA with many NoCrypto NCCH contents, e.g. DLC.
+ */
+void RomDataBenchmark::gen_N3DS_CIA(vector<uint8_t> &data)
+{
+	// Signature type and length. (RSA-2048 SHA-256)
+	static const uint32_t sig_type = 0x00010004;
+	static const uint32_t sig_len = 4 + 0x100 + 0x3C;
+
+	static const uint32_t ticket_start = 0x2040 + N3DS_CERT_CHAIN_SIZE;
+	static const uint32_t ticket_size = sig_len + sizeof(N3DS_Ticket_t);
+	static const uint32_t tmd_start = ticket_start + ((ticket_size + 63) & ~63U);
+	static const uint32_t tmd_size = sig_len + sizeof(N3DS_TMD_t) +
+		(N3DS_CIA_CONTENT_COUNT * sizeof(N3DS_Content_Chunk_Record_t));
+	static const uint32_t content_start = tmd_start + ((tmd_size + 63) & ~63U);
+	static const uint64_t title_id = 0x0004008C00052D00ULL;
+
+	data.assign(content_start + (N3DS_CIA_CONTENT_COUNT * N3DS_CIA_CONTENT_SIZE), 0);
+	uint8_t *const p = data.data();
+
+	// CIA header.
+	N3DS_CIA_Header_t *const ciaHeader = reinterpret_cast<N3DS_CIA_Header_t*>(p);
+	ciaHeader->header_size = cpu_to_le32(static_cast<uint32_t>(sizeof(N3DS_CIA_Header_t)));
+	ciaHeader->cert_chain_size = cpu_to_le32(N3DS_CERT_CHAIN_SIZE);
+	ciaHeader->ticket_size = cpu_to_le32(ticket_size);
+	ciaHeader->tmd_size = cpu_to_le32(tmd_size);
+	ciaHeader->content_size = cpu_to_le64(static_cast<uint64_t>(N3DS_CIA_CONTENT_COUNT) * N3DS_CIA_CONTENT_SIZE);
+
+	// Ticket.
+	putBE32(&p[ticket_start], sig_type);
+	N3DS_Ticket_t *const ticket = reinterpret_cast<N3DS_Ticket_t*>(&p[ticket_start + sig_len]);
+	strcpy(ticket->issuer, N3DS_TICKET_ISSUER_RETAIL);
+	ticket->version = 1;
+	ticket->title_id.id = cpu_to_be64(title_id);
+
+	// TMD.
+	putBE32(&p[tmd_start], sig_type);
+	N3DS_TMD_t *const tmd = reinterpret_cast<N3DS_TMD_t*>(&p[tmd_start + sig_len]);
+	strcpy(tmd->header.signature_issuer, "Root-CA00000003-CP0000000b");
+	tmd->header.tmd_version = 1;
+	tmd->header.title_id.id = cpu_to_be64(title_id);
+	tmd->header.title_version = cpu_to_be16(0x0410);
+	tmd->header.content_count = cpu_to_be16(N3DS_CIA_CONTENT_COUNT);
+
+	// Content chunk records and contents.
+	N3DS_Content_Chunk_Record_t *const chunks =
+		reinterpret_cast<N3DS_Content_Chunk_Record_t*>(&p[tmd_start + sig_len + sizeof(N3DS_TMD_t)]);
+	for (unsigned int i = 0; i < N3DS_CIA_CONTENT_COUNT; i++) {
+		chunks[i].id = cpu_to_be32(i);
+		chunks[i].index = cpu_to_be16(static_cast<uint16_t>(i));
+		chunks[i].size = cpu_to_be64(N3DS_CIA_CONTENT_SIZE);
+
+		N3DS_NCCH_Header_t *const ncch = reinterpret_cast<N3DS_NCCH_Header_t*>(
+			&p[content_start + (i * N3DS_CIA_CONTENT_SIZE)]);
+		fillPattern(ncch->signature, sizeof(ncch->signature), static_cast<uint8_t>(i));
+		ncch->hdr.magic = cpu_to_be32(N3DS_NCCH_HEADER_MAGIC);
+		ncch->hdr.content_size = cpu_to_le32(N3DS_CIA_CONTENT_SIZE >> 9);
+		ncch->hdr.title_id.id = cpu_to_le64(title_id);
+		ncch->hdr.program_id.id = cpu_to_le64(title_id);
+		memcpy(ncch->hdr.maker_code, "01", 2);
+		ncch->hdr.version = cpu_to_le16(2);
+		putStr(reinterpret_cast<uint8_t*>(ncch->hdr.product_code), "CTR-M-RPBE");
+		ncch->hdr.flags[N3DS_NCCH_FLAG_PLATFORM] = N3DS_NCCH_PLATFORM_CTR;
+		ncch->hdr.flags[N3DS_NCCH_FLAG_CONTENT_TYPE] = N3DS_NCCH_CONTENT_TYPE_Data;
+		ncch->hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] = N3DS_NCCH_BIT_MASK_NoCrypto;
+	}
+}
+
+/**
+ * DirectDraw Surface: 256x256 DXT1.
+ */
+void RomDataBenchmark::gen_DDS(vector<uint8_t> &data)
+{
+	static const uint32_t width = 256, height = 256;
+	static const uint32_t linearSize = (width * height) / 2;
+
+	data.assign(sizeof(uint32_t) + sizeof(DDS_HEADER) + linearSize, 0);
+	putBE32(&data[0], DDS_MAGIC);
+
+	DDS_HEADER *const ddsHeader = reinterpret_cast<DDS_HEADER*>(&data[sizeof(uint32_t)]);
+	ddsHeader->dwSize = cpu_to_le32(sizeof(DDS_HEADER));
+	ddsHeader->dwFlags = cpu_to_le32(DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE);
+	ddsHeader->dwHeight = cpu_to_le32(height);
+	ddsHeader->dwWidth = cpu_to_le32(width);
+	ddsHeader->dwPitchOrLinearSize = cpu_to_le32(linearSize);
+	ddsHeader->ddspf.dwSize = cpu_to_le32(sizeof(DDS_PIXELFORMAT));
+	ddsHeader->ddspf.dwFlags = cpu_to_le32(DDPF_FOURCC);
+	ddsHeader->ddspf.dwFourCC = cpu_to_be32(DDPF_FOURCC_DXT1);
+	ddsHeader->dwCaps = cpu_to_le32(DDSCAPS_TEXTURE);
+
+	fillPattern(&data[sizeof(uint32_t) + sizeof(DDS_HEADER)], linearSize, 0xD5);
+}
+
+/**
+ * NES Sound Format: 4 KB of code.
+ */
+void RomDataBenchmark::gen_NSF(vector<uint8_t> &data)
+{
+	data.assign(sizeof(NSF_Header) + 4096, 0);
+	fillPattern(&data[sizeof(NSF_Header)], 4096, 0x53);
+
+	NSF_Header *const nsfHeader = reinterpret_cast<NSF_Header*>(data.data());
+	memcpy(nsfHeader->magic, NSF_MAGIC, sizeof(nsfHeader->magic));
+	nsfHeader->track_count = 16;
+	nsfHeader->default_track = 1;
+	nsfHeader->load_address = cpu_to_le16(0x8000);
+	nsfHeader->init_address = cpu_to_le16(0x8000);
+	nsfHeader->play_address = cpu_to_le16(0x8003);
+	strcpy(nsfHeader->title, "ROM Properties Benchmark");
+	strcpy(nsfHeader->composer, "GerbilSoft");
+	strcpy(nsfHeader->copyright, "2021 GerbilSoft");
+	nsfHeader->ntsc_framerate = cpu_to_le16(16639);
+	nsfHeader->pal_framerate = cpu_to_le16(19997);
+}
+
+/**
+ * Video Game Music: VGM 1.71 with an SN76489 and YM2612.
+ */
+void RomDataBenchmark::gen_VGM(vector<uint8_t> &data)
+{
+	static const uint32_t data_offset = 0x100;
+	static const uint32_t data_size = 4096;
+
+	data.assign(data_offset + data_size, 0);
+	uint8_t *const p = data.data();
+	putBE32(&p[0x00], VGM_MAGIC);
+	putLE32(&p[0x04], static_cast<uint32_t>(data.size() - 0x04));	// EOF offset
+	putLE32(&p[0x08], 0x00000171);	// Version
+	putLE32(&p[0x0C], 3579545);	// SN76489 clock
+	putLE32(&p[0x18], (data_size - 1) * 735);	// Sample count
+	putLE32(&p[0x24], 60);		// Frame rate
+	putLE32(&p[0x2C], 7670453);	// YM2612 clock
+	putLE32(&p[0x34], data_offset - 0x34);	// Data offset
+
+	// Wait 1/60th of a second, repeatedly.
+	memset(&p[data_offset], 0x62, data_size - 1);
+	p[data.size() - 1] = 0x66;	// End of sound data
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string RomDataBenchmark::test_case_suffix_generator(const ::testing::TestParamInfo<SyntheticFormat> &info)
+{
+	return info.param.name;
+}
+
+/**
+ * Generate the synthetic image and write it to disk.
+ */
+void RomDataBenchmark::SetUp(void)
+{
+	const SyntheticFormat &format = GetParam();
+
+	vector<uint8_t> data;
+	format.generate(data);
+	ASSERT_FALSE(data.empty());
+	m_size = data.size();
+
+	m_filename = "RomDataBenchmark_";
+	m_filename += format.name;
+	m_filename += format.ext;
+
+	if (format.gzip) {
+		gzFile gzf = gzopen(m_filename.c_str(), "wb9");
+		ASSERT_TRUE(gzf != nullptr) << "Unable to create " << m_filename;
+		const int ret = gzwrite(gzf, data.data(), static_cast<unsigned int>(data.size()));
+		gzclose_w(gzf);
+		ASSERT_EQ(static_cast<int>(data.size()), ret);
+	} else {
+		FILE *f = fopen(m_filename.c_str(), "wb");
+		ASSERT_TRUE(f != nullptr) << "Unable to create " << m_filename;
+		const size_t ret = fwrite(data.data(), 1, data.size(), f);
+		fclose(f);
+		ASSERT_EQ(data.size(), ret);
+	}
+}
+
+/**
+ * Delete the synthetic image.
+ */
+void RomDataBenchmark::TearDown(void)
+{
+	if (!m_filename.empty()) {
+		remove(m_filename.c_str());
+	}
+}
+
+/**
+ * Open the synthetic image and create a RomData object.
+ * @param attrs RomDataFactory::RomDataAttr bitfield.
+ * @return RomData object, or nullptr on error.
+ */
+RomData *RomDataBenchmark::openRomData(unsigned int attrs) const
+{
+	// NOTE: Using FM_OPEN_READ_GZ to match rpcli and the thumbnailers.
+	RpFile *const file = new RpFile(m_filename, RpFile::FM_OPEN_READ_GZ);
+	if (!file->isOpen()) {
+		file->unref();
+		return nullptr;
+	}
+
+	RomData *const romData = RomDataFactory::create(file, attrs);
+	file->unref();
+	return romData;
+}
+
+/**
+ * Decode and rescale all internal images.
+ * This is the thumbnailing step without the
+ * external image and download cache overhead.
+ * @param romData RomData object.
+ * @return Number of internal images decoded.
+ */
+unsigned int RomDataBenchmark::createThumbnails(const RomData *romData)
+{
+	static const int THUMBNAIL_SIZE = 256;
+
+	unsigned int count = 0;
+	const uint32_t imgbf = romData->supportedImageTypes();
+	for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+		if (!(imgbf & (1U << i)))
+			continue;
+
+		const rp_image *const img = romData->image(static_cast<RomData::ImageType>(i));
+		if (!img || !img->isValid())
+			continue;
+
+		// Rescale to fit a 256x256 thumbnail, preserving the aspect ratio.
+		int width = img->width();
+		int height = img->height();
+		if (width >= height) {
+			height = std::max(1, (height * THUMBNAIL_SIZE) / width);
+			width = THUMBNAIL_SIZE;
+		} else {
+			width = std::max(1, (width * THUMBNAIL_SIZE) / height);
+			height = THUMBNAIL_SIZE;
+		}
+		rp_image *const thumb = img->scaled(width, height, rp_image::ScalingMethod::Bilinear);
+		if (thumb) {
+			thumb->unref();
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * Verify that the synthetic image is detected and parsed correctly.
+ */
+TEST_P(RomDataBenchmark, detect)
+{
+	const SyntheticFormat &format = GetParam();
+
+	RomData *const romData = openRomData();
+	ASSERT_TRUE(romData != nullptr) << "RomDataFactory::create() failed for " << format.name;
+	EXPECT_TRUE(romData->isValid());
+	EXPECT_STREQ(format.className, romData->className());
+
+	const RomFields *const fields = romData->fields();
+	ASSERT_TRUE(fields != nullptr);
+	EXPECT_GT(fields->count(), 0);
+
+	// metaData() may return nullptr if the format has no metadata.
+	romData->metaData();
+
+	if (format.hasImage) {
+		EXPECT_GT(createThumbnails(romData), 0U);
+	}
+
+	romData->unref();
+}
+
+/**
+ * Benchmark detection, field parsing, metadata parsing,
+ * and thumbnailing for the synthetic image.
+ */
+TEST_P(RomDataBenchmark, parse_benchmark)
+{
+	using namespace std::chrono;
+	const SyntheticFormat &format = GetParam();
+
+	uint64_t detect_us = 0, fields_us = 0, metadata_us = 0, thumbnail_us = 0;
+	const char *className = nullptr;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		auto t0 = steady_clock::now();
+		RomData *const romData = openRomData();
+		auto t1 = steady_clock::now();
+		ASSERT_TRUE(romData != nullptr) << "RomDataFactory::create() failed for " << format.name;
+		className = romData->className();
+
+		romData->fields();
+		auto t2 = steady_clock::now();
+		romData->metaData();
+		auto t3 = steady_clock::now();
+		createThumbnails(romData);
+		auto t4 = steady_clock::now();
+		romData->unref();
+
+		detect_us += duration_cast<microseconds>(t1 - t0).count();
+		fields_us += duration_cast<microseconds>(t2 - t1).count();
+		metadata_us += duration_cast<microseconds>(t3 - t2).count();
+		thumbnail_us += duration_cast<microseconds>(t4 - t3).count();
+	}
+
+	// Machine-readable results. (JSON Lines)
+	char buf[512];
+	snprintf(buf, sizeof(buf),
+		"{\"format\":\"%s\",\"class\":\"%s\",\"size\":%u,\"iterations\":%u,"
+		"\"detect_us\":%llu,\"fields_us\":%llu,\"metadata_us\":%llu,"
+		"\"thumbnail_us\":%llu,\"total_us\":%llu}\n",
+		format.name, className, static_cast<unsigned int>(m_size), BENCHMARK_ITERATIONS,
+		static_cast<unsigned long long>(detect_us),
+		static_cast<unsigned long long>(fields_us),
+		static_cast<unsigned long long>(metadata_us),
+		static_cast<unsigned long long>(thumbnail_us),
+		static_cast<unsigned long long>(detect_us + fields_us + metadata_us + thumbnail_us));
+	fputs(buf, stdout);
+	fflush(stdout);
+
+	if (json_out_filename) {
+		FILE *f = _tfopen(json_out_filename, _T("a"));
+		ASSERT_TRUE(f != nullptr) << "Unable to open the JSON output file.";
+		fputs(buf, f);
+		fclose(f);
+	}
+}
+
+/**
+ * Verify that metadata-only mode returns the same metadata
+ * as the normal mode, without fields or images.
+ */
+TEST_P(RomDataBenchmark, metadata_only)
+{
+	const SyntheticFormat &format = GetParam();
+
+	RomData *const romData = openRomData();
+	ASSERT_TRUE(romData != nullptr) << "RomDataFactory::create() failed for " << format.name;
+	RomData *const romDataMD = openRomData(RomDataFactory::RDA_METADATA_ONLY);
+	ASSERT_TRUE(romDataMD != nullptr) << "RomDataFactory::create() failed for " << format.name;
+	EXPECT_FALSE(romData->isMetaDataOnly());
+	EXPECT_TRUE(romDataMD->isMetaDataOnly());
+
+	const RomMetaData *const metaData = romData->metaData();
+	const RomMetaData *const metaDataMD = romDataMD->metaData();
+	ASSERT_EQ(metaData == nullptr, metaDataMD == nullptr);
+	if (metaData) {
+		ASSERT_EQ(metaData->count(), metaDataMD->count());
+		for (int i = 0; i < metaData->count(); i++) {
+			const RomMetaData::MetaData *const prop = metaData->prop(i);
+			const RomMetaData::MetaData *const propMD = metaDataMD->prop(i);
+			ASSERT_TRUE(prop != nullptr);
+			ASSERT_TRUE(propMD != nullptr);
+			EXPECT_EQ(prop->name, propMD->name);
+			ASSERT_EQ(prop->type, propMD->type);
+			if (prop->type == PropertyType::String) {
+				ASSERT_TRUE(prop->data.str != nullptr);
+				ASSERT_TRUE(propMD->data.str != nullptr);
+				EXPECT_EQ(*prop->data.str, *propMD->data.str);
+			} else {
+				EXPECT_EQ(prop->data.iptrvalue, propMD->data.iptrvalue);
+			}
+		}
+	}
+
+	// Fields and images are not available in metadata-only mode.
+	EXPECT_TRUE(romDataMD->fields() == nullptr);
+	EXPECT_EQ(0U, createThumbnails(romDataMD));
+
+	romDataMD->unref();
+	romData->unref();
+}
+
+/**
+ * Benchmark metadata extraction, e.g. for KDE's Baloo,
+ * with and without metadata-only mode.
+ */
+TEST_P(RomDataBenchmark, metadata_benchmark)
+{
+	using namespace std::chrono;
+	const SyntheticFormat &format = GetParam();
+
+	static const unsigned int attrs_tbl[2] = {
+		RomDataFactory::RDA_NONE,
+		RomDataFactory::RDA_METADATA_ONLY,
+	};
+	uint64_t time_us[2] = {0, 0};
+	const char *className = nullptr;
+	for (unsigned int mode = 0; mode < ARRAY_SIZE(attrs_tbl); mode++) {
+		auto t0 = steady_clock::now();
+		for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+			RomData *const romData = openRomData(attrs_tbl[mode]);
+			ASSERT_TRUE(romData != nullptr) << "RomDataFactory::create() failed for " << format.name;
+			className = romData->className();
+			romData->metaData();
+			romData->unref();
+		}
+		auto t1 = steady_clock::now();
+		time_us[mode] = duration_cast<microseconds>(t1 - t0).count();
+	}
+
+	// Machine-readable results. (JSON Lines)
+	char buf[512];
+	snprintf(buf, sizeof(buf),
+		"{\"format\":\"%s\",\"class\":\"%s\",\"size\":%u,\"iterations\":%u,"
+		"\"metadata_full_us\":%llu,\"metadata_only_us\":%llu}\n",
+		format.name, className, static_cast<unsigned int>(m_size), BENCHMARK_ITERATIONS,
+		static_cast<unsigned long long>(time_us[0]),
+		static_cast<unsigned long long>(time_us[1]));
+	fputs(buf, stdout);
+	fflush(stdout);
+
+	if (json_out_filename) {
+		FILE *f = _tfopen(json_out_filename, _T("a"));
+		ASSERT_TRUE(f != nullptr) << "Unable to open the JSON output file.";
+		fputs(buf, f);
+		fclose(f);
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(RomDataBenchmark, RomDataBenchmark,
+	::testing::Values(
+		SyntheticFormat("NES", ".nes", "NES", false, false, RomDataBenchmark::gen_NES),
+		SyntheticFormat("NES_gz", ".nes.gz", "NES", false, true, RomDataBenchmark::gen_NES),
+		SyntheticFormat("N64", ".z64", "N64", false, false, RomDataBenchmark::gen_N64),
+		SyntheticFormat("MegaDrive", ".bin", "MegaDrive", false, false, RomDataBenchmark::gen_MegaDrive),
+		SyntheticFormat("MegaDrive_gz", ".bin.gz", "MegaDrive", false, true, RomDataBenchmark::gen_MegaDrive),
+		SyntheticFormat("DMG", ".gb", "DMG", false, false, RomDataBenchmark::gen_DMG),
+		SyntheticFormat("GBA", ".gba", "GameBoyAdvance", false, false, RomDataBenchmark::gen_GBA),
+		SyntheticFormat("NDS", ".nds", "NintendoDS", true, false, RomDataBenchmark::gen_NDS),
+		SyntheticFormat("GameCube_ISO", ".iso", "GameCube", true, false, RomDataBenchmark::gen_GameCube_ISO),
+		SyntheticFormat("GameCube_ISO_gz", ".iso.gz", "GameCube", true, true, RomDataBenchmark::gen_GameCube_ISO),
+		SyntheticFormat("GameCube_CISO", ".ciso", "GameCube", true, false, RomDataBenchmark::gen_GameCube_CISO),
+		SyntheticFormat("GameCube_GCZ", ".gcz", "GameCube", true, false, RomDataBenchmark::gen_GameCube_GCZ),
+		SyntheticFormat("GameCube_WBFS", ".wbfs", "GameCube", true, false, RomDataBenchmark::gen_GameCube_WBFS),
+		SyntheticFormat("Wii_MultiPartition", ".iso", "GameCube", false, false, RomDataBenchmark::gen_Wii_MultiPartition),
+		SyntheticFormat("WiiU_WUX", ".wux", "WiiU", false, false, RomDataBenchmark::gen_WiiU_WUX),
+		SyntheticFormat("N3DS_SMDH", ".smdh", "Nintendo3DS", true, false, RomDataBenchmark::gen_N3DS_SMDH),
+		SyntheticFormat("N3DS_CIA", ".cia", "Nintendo3DS", false, false, RomDataBenchmark::gen_N3DS_CIA),
+		SyntheticFormat("DDS", ".dds", "RpTextureWrapper", true, false, RomDataBenchmark::gen_DDS),
+		SyntheticFormat("NSF", ".nsf", "NSF", false, false, RomDataBenchmark::gen_NSF),
+		SyntheticFormat("VGM", ".vgm", "VGM", false, false, RomDataBenchmark::gen_VGM))
+	, RomDataBenchmark::test_case_suffix_generator);
+
+class DangerousPermissionsTest : public ::testing::Test
+{
+	public:
+		// Number of files for the directory listing benchmark.
+		static const unsigned int LISTING_FILE_COUNT = 5000;
+
+		/**
+		 * Check for "dangerous" permissions by constructing a RomData object.
+		 * This is what the overlay icon handlers did before
+		 * RomDataFactory::hasDangerousPermissions() was added.
+		 * @param filename Filename.
+		 * @return True if "dangerous"; false if not.
+		 */
+		static bool checkFullParse(const string &filename);
+
+		/**
+		 * Check for "dangerous" permissions using RomDataFactory::hasDangerousPermissions().
+		 * @param filename Filename.
+		 * @return True if "dangerous"; false if not.
+		 */
+		static bool checkProbe(const string &filename);
+
+		/**
+		 * Write a file.
+		 * @param filename Filename.
+		 * @param data Data.
+		 * @return True on success; false on error.
+		 */
+		static bool writeFile(const string &filename, const vector<uint8_t> &data);
+
+	public:
+		/** Generators **/
+
+		static void gen_NDS_dangerous(vector<uint8_t> &data);
+		static void gen_EXE_MZ(vector<uint8_t> &data);
+		static void gen_EXE_PE(vector<uint8_t> &data);
+		static void gen_Unknown(vector<uint8_t> &data);
+};
+
+/**
+ * Check for "dangerous" permissions by constructing a RomData object.
+ * This is what the overlay icon handlers did before
+ * RomDataFactory::hasDangerousPermissions() was added.
+ * @param filename Filename.
+ * @return True if "dangerous"; false if not.
+ */
+bool DangerousPermissionsTest::checkFullParse(const string &filename)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	if (!file->isOpen()) {
+		file->unref();
+		return false;
+	}
+
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
+	file->unref();
+	if (!romData) {
+		return false;
+	}
+
+	const bool dangerous = romData->hasDangerousPermissions();
+	romData->unref();
+	return dangerous;
+}
+
+/**
+ * Check for "dangerous" permissions using RomDataFactory::hasDangerousPermissions().
+ * @param filename Filename.
+ * @return True if "dangerous"; false if not.
+ */
+bool DangerousPermissionsTest::checkProbe(const string &filename)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	if (!file->isOpen()) {
+		file->unref();
+		return false;
+	}
+
+	const bool dangerous = RomDataFactory::hasDangerousPermissions(file);
+	file->unref();
+	return dangerous;
+}
+
+/**
+ * Write a file.
+ * @param filename Filename.
+ * @param data Data.
+ * @return True on success; false on error.
+ */
+bool DangerousPermissionsTest::writeFile(const string &filename, const vector<uint8_t> &data)
+{
+	FILE *f = fopen(filename.c_str(), "wb");
+	if (!f) {
+		return false;
+	}
+	const size_t ret = fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+	return (ret == data.size());
+}
+
+/**
+ * Nintendo DS: 128 KB ROM with "dangerous" DSi permissions.
+ */
+void DangerousPermissionsTest::gen_NDS_dangerous(vector<uint8_t> &data)
+{
+	RomDataBenchmark::gen_NDS(data);
+	data.resize(128*1024);
+
+	// Game Card Power On + SD Card
+	NDS_RomHeader *const romHeader = reinterpret_cast<NDS_RomHeader*>(data.data());
+	romHeader->dsi.access_control = cpu_to_le32(DSi_ACCESS_GAME_CARD_POWER_ON | DSi_ACCESS_SD_CARD);
+}
+
+/**
+ * MS-DOS executable: 4 KB.
+ */
+void DangerousPermissionsTest::gen_EXE_MZ(vector<uint8_t> &data)
+{
+	data.assign(4096, 0);
+	RomDataBenchmark::fillPattern(&data[0x40], data.size() - 0x40, 0x4D);
+	uint8_t *const p = data.data();
+	RomDataBenchmark::putStr(&p[0x00], "MZ");
+	p[0x18] = 0x1C;	// e_lfarlc
+}
+
+/**
+ * PE executable with no resource section: 4 KB.
+ */
+void DangerousPermissionsTest::gen_EXE_PE(vector<uint8_t> &data)
+{
+	data.assign(4096, 0);
+	uint8_t *const p = data.data();
+	RomDataBenchmark::putStr(&p[0x00], "MZ");
+	p[0x18] = 0x40;	// e_lfarlc
+	RomDataBenchmark::putLE32(&p[0x3C], 0x80);	// e_lfanew
+
+	// PE header.
+	RomDataBenchmark::putStr(&p[0x80], "PE");
+	p[0x84] = 0x4C;	// Machine: i386
+	p[0x85] = 0x01;
+	p[0x94] = 0xE0;	// SizeOfOptionalHeader
+	p[0x96] = 0x02;	// Characteristics: Executable
+	p[0x98] = 0x0B;	// Magic: PE32
+	p[0x99] = 0x01;
+	p[0x98 + 68] = 0x02;	// Subsystem: Windows GUI
+	p[0x98 + 92] = 16;	// NumberOfRvaAndSizes
+}
+
+/**
+ * Unknown file: 4 KB of non-ROM data.
+ */
+void DangerousPermissionsTest::gen_Unknown(vector<uint8_t> &data)
+{
+	data.assign(4096, 0);
+	RomDataBenchmark::fillPattern(data.data(), data.size(), 0x55);
+}
+
+/**
+ * Verify that the light-weight probe matches the full parse.
+ */
+TEST_F(DangerousPermissionsTest, probe_matches_full_parse)
+{
+	static const struct {
+		const char *filename;
+		SyntheticGenerator generate;
+		bool dangerous;
+	} test_cases[] = {
+		{"RomDataBenchmark_dp_NDS.nds", RomDataBenchmark::gen_NDS, false},
+		{"RomDataBenchmark_dp_NDS_dangerous.nds", DangerousPermissionsTest::gen_NDS_dangerous, true},
+		{"RomDataBenchmark_dp_MZ.exe", DangerousPermissionsTest::gen_EXE_MZ, false},
+		{"RomDataBenchmark_dp_PE.exe", DangerousPermissionsTest::gen_EXE_PE, false},
+		{"RomDataBenchmark_dp_SMDH.smdh", RomDataBenchmark::gen_N3DS_SMDH, false},
+		{"RomDataBenchmark_dp_NES.nes", RomDataBenchmark::gen_NES, false},
+		{"RomDataBenchmark_dp_Unknown.bin", DangerousPermissionsTest::gen_Unknown, false},
+	};
+
+	for (const auto &test_case : test_cases) {
+		vector<uint8_t> data;
+		test_case.generate(data);
+		ASSERT_TRUE(writeFile(test_case.filename, data)) << "Unable to create " << test_case.filename;
+
+		EXPECT_EQ(test_case.dangerous, checkFullParse(test_case.filename)) << test_case.filename;
+		EXPECT_EQ(test_case.dangerous, checkProbe(test_case.filename)) << test_case.filename;
+		// Second check uses the cache.
+		EXPECT_EQ(test_case.dangerous, checkProbe(test_case.filename)) << test_case.filename << " (cached)";
+
+		remove(test_case.filename);
+	}
+}
+
+/**
+ * Verify that a cached result is discarded if the file changes.
+ */
+TEST_F(DangerousPermissionsTest, cache_invalidation)
+{
+	static const char filename[] = "RomDataBenchmark_dp_cache.nds";
+	vector<uint8_t> data;
+
+	RomDataBenchmark::gen_NDS(data);
+	ASSERT_TRUE(writeFile(filename, data));
+	EXPECT_FALSE(checkProbe(filename));
+
+	// NOTE: The "dangerous" version has a different file size,
+	// so the cache entry is discarded even if the mtime
+	// didn't change.
+	gen_NDS_dangerous(data);
+	ASSERT_TRUE(writeFile(filename, data));
+	EXPECT_TRUE(checkProbe(filename));
+
+	remove(filename);
+}
+
+/**
+ * Benchmark overlay icon checks for a directory listing.
+ */
+TEST_F(DangerousPermissionsTest, listing_benchmark)
+{
+	using namespace std::chrono;
+
+	// File mix. One out of every 10 files is "dangerous".
+	static const struct {
+		const char *ext;
+		SyntheticGenerator generate;
+	} file_types[10] = {
+		{".nes", RomDataBenchmark::gen_NES},
+		{".nes", RomDataBenchmark::gen_NES},
+		{".gb", RomDataBenchmark::gen_DMG},
+		{".bin", RomDataBenchmark::gen_MegaDrive},
+		{".nds", RomDataBenchmark::gen_NDS},
+		{".nds", RomDataBenchmark::gen_NDS},
+		{".nds", DangerousPermissionsTest::gen_NDS_dangerous},
+		{".exe", DangerousPermissionsTest::gen_EXE_MZ},
+		{".exe", DangerousPermissionsTest::gen_EXE_PE},
+		{".dat", DangerousPermissionsTest::gen_Unknown},
+	};
+
+	vector<vector<uint8_t> > file_data(ARRAY_SIZE(file_types));
+	for (size_t i = 0; i < ARRAY_SIZE(file_types); i++) {
+		file_types[i].generate(file_data[i]);
+	}
+
+	vector<string> filenames;
+	filenames.reserve(LISTING_FILE_COUNT);
+	for (unsigned int i = 0; i < LISTING_FILE_COUNT; i++) {
+		const unsigned int type = i % ARRAY_SIZE(file_types);
+		char filename[64];
+		snprintf(filename, sizeof(filename), "RomDataBenchmark_dp_%04u%s", i, file_types[type].ext);
+		filenames.emplace_back(filename);
+		ASSERT_TRUE(writeFile(filenames.back(), file_data[type])) << "Unable to create " << filename;
+	}
+
+	auto runPass = [&filenames](bool (*check)(const string&), unsigned int *pCount) -> uint64_t {
+		*pCount = 0;
+		auto t0 = steady_clock::now();
+		for (const string &filename : filenames) {
+			if (check(filename)) {
+				(*pCount)++;
+			}
+		}
+		auto t1 = steady_clock::now();
+		return duration_cast<microseconds>(t1 - t0).count();
+	};
+
+	unsigned int count_full, count_cold, count_cached;
+	const uint64_t full_us = runPass(checkFullParse, &count_full);
+	const uint64_t cold_us = runPass(checkProbe, &count_cold);
+	const uint64_t cached_us = runPass(checkProbe, &count_cached);
+
+	for (const string &filename : filenames) {
+		remove(filename.c_str());
+	}
+
+	EXPECT_EQ(LISTING_FILE_COUNT / 10, count_full);
+	EXPECT_EQ(count_full, count_cold);
+	EXPECT_EQ(count_full, count_cached);
+
+	// Machine-readable results. (JSON Lines)
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		"{\"format\":\"dpoverlay_listing\",\"files\":%u,"
+		"\"full_parse_us\":%llu,\"probe_cold_us\":%llu,\"probe_cached_us\":%llu}\n",
+		LISTING_FILE_COUNT,
+		static_cast<unsigned long long>(full_us),
+		static_cast<unsigned long long>(cold_us),
+		static_cast<unsigned long long>(cached_us));
+	fputs(buf, stdout);
+	fflush(stdout);
+
+	if (RomDataBenchmark::json_out_filename) {
+		FILE *f = _tfopen(RomDataBenchmark::json_out_filename, _T("a"));
+		ASSERT_TRUE(f != nullptr) << "Unable to open the JSON output file.";
+		fputs(buf, f);
+		fclose(f);
+	}
+}
+
+/**
+ * Wii partition probing benchmark.
+ *
+ * NOTE: Partitions are probed serially. This is the baseline for
+ * unencrypted partitions only; encrypted partitions can't be
+ * generated without the Wii common keys.
+ */
+class WiiPartitionProbeTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of iterations for the probe benchmark.
+		static const unsigned int PROBE_ITERATIONS = 200;
+
+	protected:
+		/**
+		 * Open all partitions in the synthetic disc image.
+		 * @param partitions [out] Partitions.
+		 * @return True on success; false on error.
+		 */
+		bool openPartitions(vector<WiiPartition*> &partitions) const;
+
+		/**
+		 * Close partitions opened by openPartitions().
+		 * @param partitions [in/out] Partitions.
+		 */
+		static void closePartitions(vector<WiiPartition*> &partitions);
+
+	protected:
+		string m_filename;	// Synthetic disc image filename
+};
+
+/**
+ * Generate the synthetic disc image and write it to disk.
+ */
+void WiiPartitionProbeTest::SetUp(void)
+{
+	vector<uint8_t> data;
+	RomDataBenchmark::gen_Wii_MultiPartition(data);
+	m_filename = "RomDataBenchmark_WiiPartitionProbe.iso";
+
+	FILE *f = fopen(m_filename.c_str(), "wb");
+	ASSERT_TRUE(f != nullptr) << "Unable to create " << m_filename;
+	const size_t ret = fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+	ASSERT_EQ(data.size(), ret);
+}
+
+/**
+ * Delete the synthetic disc image.
+ */
+void WiiPartitionProbeTest::TearDown(void)
+{
+	if (!m_filename.empty()) {
+		remove(m_filename.c_str());
+	}
+}
+
+/**
+ * Open all partitions in the synthetic disc image.
+ * @param partitions [out] Partitions.
+ * @return True on success; false on error.
+ */
+bool WiiPartitionProbeTest::openPartitions(vector<WiiPartition*> &partitions) const
+{
+	RpFile *const file = new RpFile(m_filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		file->unref();
+		return false;
+	}
+	DiscReader *const discReader = new DiscReader(file);
+	file->unref();
+
+	partitions.clear();
+	partitions.reserve(RomDataBenchmark::WII_PT_COUNT);
+	for (unsigned int i = 0; i < RomDataBenchmark::WII_PT_COUNT; i++) {
+		partitions.push_back(new WiiPartition(discReader,
+			RomDataBenchmark::WII_PT_START + (i * RomDataBenchmark::WII_PT_SIZE),
+			RomDataBenchmark::WII_PT_SIZE, WiiPartition::CM_NASOS));
+	}
+	discReader->unref();
+	return true;
+}
+
+/**
+ * Close partitions opened by openPartitions().
+ * @param partitions [in/out] Partitions.
+ */
+void WiiPartitionProbeTest::closePartitions(vector<WiiPartition*> &partitions)
+{
+	for (WiiPartition *partition : partitions) {
+		partition->unref();
+	}
+	partitions.clear();
+}
+
+/**
+ * Verify that probing partitions one at a time gets the
+ * same results regardless of the order, since all of the
+ * partitions share the same IDiscReader.
+ */
+TEST_F(WiiPartitionProbeTest, probe_order)
+{
+	vector<WiiPartition*> forward, reverse;
+	ASSERT_TRUE(openPartitions(forward));
+	ASSERT_TRUE(openPartitions(reverse));
+
+	for (size_t i = reverse.size(); i > 0; i--) {
+		reverse[i-1]->partition_size_used();
+	}
+	for (size_t i = 0; i < forward.size(); i++) {
+		const off64_t used_size = forward[i]->partition_size_used();
+		EXPECT_GT(used_size, 0) << "partition " << i;
+		EXPECT_EQ(used_size, reverse[i]->partition_size_used()) << "partition " << i;
+		EXPECT_EQ(forward[i]->verifyResult(), reverse[i]->verifyResult()) << "partition " << i;
+
+		// Make sure the FST is usable after probing.
+		IRpFile *const f = reverse[i]->open("/files/file0000.bin");
+		EXPECT_TRUE(f != nullptr) << "partition " << i;
+		if (f) {
+			EXPECT_EQ(0x20, f->size());
+			f->unref();
+		}
+	}
+
+	closePartitions(forward);
+	closePartitions(reverse);
+}
+
+/**
+ * Benchmark opening partitions vs. probing them.
+ * Partitions are probed lazily, so opening them should
+ * only cost a fraction of the full probe.
+ */
+TEST_F(WiiPartitionProbeTest, probe_benchmark)
+{
+	using namespace std::chrono;
+
+	vector<WiiPartition*> partitions;
+	uint64_t open_us = 0, probe_us = 0;
+	for (unsigned int i = PROBE_ITERATIONS; i > 0; i--) {
+		auto t0 = steady_clock::now();
+		ASSERT_TRUE(openPartitions(partitions));
+		auto t1 = steady_clock::now();
+		for (WiiPartition *partition : partitions) {
+			partition->partition_size_used();
+		}
+		auto t2 = steady_clock::now();
+		closePartitions(partitions);
+		open_us += duration_cast<microseconds>(t1 - t0).count();
+		probe_us += duration_cast<microseconds>(t2 - t1).count();
+	}
+
+	// Machine-readable results. (JSON Lines)
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		"{\"format\":\"wii_partition_probe\",\"partitions\":%u,\"iterations\":%u,"
+		"\"open_us\":%llu,\"probe_us\":%llu}\n",
+		RomDataBenchmark::WII_PT_COUNT, PROBE_ITERATIONS,
+		static_cast<unsigned long long>(open_us),
+		static_cast<unsigned long long>(probe_us));
+	fputs(buf, stdout);
+	fflush(stdout);
+
+	if (RomDataBenchmark::json_out_filename) {
+		FILE *f = _tfopen(RomDataBenchmark::json_out_filename, _T("a"));
+		ASSERT_TRUE(f != nullptr) << "Unable to open the JSON output file.";
+		fputs(buf, f);
+		fclose(f);
+	}
+}
+
+/**
+ * Verify that all contents in a multi-content CIA
+ * are listed in the "Contents" field.
+ */
+TEST(N3DSContentsTest, contents_list)
+{
+	vector<uint8_t> data;
+	RomDataBenchmark::gen_N3DS_CIA(data);
+	RpMemFile *const file = new RpMemFile(data.data(), data.size());
+	file->setFilename("RomDataBenchmark_N3DSContents.cia");
+
+	RomData *const romData = RomDataFactory::create(file);
+	file->unref();
+	ASSERT_TRUE(romData != nullptr);
+	EXPECT_STREQ("Nintendo3DS", romData->className());
+
+	const RomFields *const fields = romData->fields();
+	ASSERT_TRUE(fields != nullptr);
+	const RomFields::Field *contents = nullptr;
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		if (iter->type == RomFields::RFT_LISTDATA && iter->name == "Contents") {
+			contents = &(*iter);
+			break;
+		}
+	}
+	ASSERT_TRUE(contents != nullptr) << "Contents field not found.";
+
+	const RomFields::ListData_t *const list_data = contents->data.list_data.data.single;
+	ASSERT_TRUE(list_data != nullptr);
+	ASSERT_EQ(static_cast<size_t>(RomDataBenchmark::N3DS_CIA_CONTENT_COUNT), list_data->size());
+	for (unsigned int i = 0; i < RomDataBenchmark::N3DS_CIA_CONTENT_COUNT; i++) {
+		const vector<string> &row = list_data->at(i);
+		ASSERT_EQ(5U, row.size()) << "content " << i;
+		EXPECT_EQ(std::to_string(i), row[0]) << "content " << i;
+		EXPECT_EQ("CFA", row[1]) << "content " << i;
+		EXPECT_EQ("NoCrypto", row[2]) << "content " << i;
+	}
+
+	romData->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: RomData synthetic-corpus benchmark.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRomData::Tests::RomDataBenchmark::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+
+	// Check for "--json-out=filename".
+	// This appends machine-readable benchmark results to the specified file.
+	static const TCHAR json_out_opt[] = _T("--json-out=");
+	for (int i = 1; i < argc; i++) {
+		if (!_tcsncmp(argv[i], json_out_opt, ARRAY_SIZE(json_out_opt)-1)) {
+			LibRomData::Tests::RomDataBenchmark::json_out_filename = &argv[i][ARRAY_SIZE(json_out_opt)-1];
+		}
+	}
+
+	return RUN_ALL_TESTS();
+}
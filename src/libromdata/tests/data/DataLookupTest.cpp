@@ -0,0 +1,406 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * DataLookupTest.cpp: Lookup table tests and benchmarks.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// libromdata
+#include "data/AmiiboData.hpp"
+#include "data/ELFData.hpp"
+#include "data/EXEData.hpp"
+#include "data/MachOData.hpp"
+#include "data/NESMappers.hpp"
+#include "data/Nintendo3DSFirmData.hpp"
+#include "data/Nintendo3DSSysTitles.hpp"
+#include "data/NintendoPublishers.hpp"
+#include "data/SegaPublishers.hpp"
+#include "data/WiiSystemMenuVersion.hpp"
+#include "data/WiiUData.hpp"
+#include "data/WonderSwanPublishers.hpp"
+#include "data/Xbox360_STFS_ContentType.hpp"
+#include "data/XboxPublishers.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+namespace LibRomData { namespace Tests {
+
+class DataLookupTest : public ::testing::Test
+{
+	protected:
+		DataLookupTest() { }
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		/**
+		 * Benchmark result sink.
+		 * Counts non-nullptr lookup results so the
+		 * lookups can't be optimized out.
+		 */
+		static unsigned int found_count;
+};
+
+unsigned int DataLookupTest::found_count = 0;
+
+/** Lookup tests **/
+
+/**
+ * Test NintendoPublishers.
+ */
+TEST_F(DataLookupTest, NintendoPublishers_test)
+{
+	EXPECT_STREQ("Nintendo", NintendoPublishers::lookup("01"));
+	EXPECT_STREQ("Square-Enix", NintendoPublishers::lookup('GD'));
+	EXPECT_STREQ("Nintendo", NintendoPublishers::lookup_old(0x01));
+	EXPECT_STREQ("Athena", NintendoPublishers::lookup_fds(0xE7));
+	EXPECT_EQ(nullptr, NintendoPublishers::lookup(static_cast<uint16_t>(0xFFFF)));
+	EXPECT_EQ(nullptr, NintendoPublishers::lookup_fds(0xFF));
+}
+
+/**
+ * Test SegaPublishers.
+ */
+TEST_F(DataLookupTest, SegaPublishers_test)
+{
+	EXPECT_STREQ("Sega", SegaPublishers::lookup(0));
+	EXPECT_STREQ("Taito", SegaPublishers::lookup(11));
+	EXPECT_STREQ("Capcom", SegaPublishers::lookup(12));
+	EXPECT_EQ(nullptr, SegaPublishers::lookup(1));
+	EXPECT_EQ(nullptr, SegaPublishers::lookup(99999));
+}
+
+/**
+ * Test XboxPublishers.
+ */
+TEST_F(DataLookupTest, XboxPublishers_test)
+{
+	EXPECT_STREQ("Blizzard", XboxPublishers::lookup("BZ"));
+	EXPECT_STREQ("Bethesda Softworks", XboxPublishers::lookup('BS'));
+	EXPECT_EQ(nullptr, XboxPublishers::lookup(static_cast<uint16_t>(0xFFFF)));
+}
+
+/**
+ * Test ELFData and EXEData.
+ */
+TEST_F(DataLookupTest, ExecutableData_test)
+{
+	EXPECT_STREQ("RISC-V", ELFData::lookup_cpu(243));
+	EXPECT_STREQ("Lanai", ELFData::lookup_cpu(244));
+	EXPECT_EQ(nullptr, ELFData::lookup_cpu(0xFFFE));
+
+	EXPECT_STREQ("Intel i386", EXEData::lookup_pe_cpu(0x014C));
+	EXPECT_EQ(nullptr, EXEData::lookup_pe_cpu(0x0001));
+	EXPECT_STREQ("Intel i386", EXEData::lookup_le_cpu(0x02));
+	EXPECT_EQ(nullptr, EXEData::lookup_le_cpu(0xFFFF));
+}
+
+/**
+ * Test NESMappers.
+ */
+TEST_F(DataLookupTest, NESMappers_test)
+{
+	EXPECT_STREQ("SUROM", NESMappers::lookup_nes2_submapper(1, 1));
+	EXPECT_STREQ("SEROM, SHROM, SH1ROM", NESMappers::lookup_nes2_submapper(1, 5));
+	EXPECT_EQ(nullptr, NESMappers::lookup_nes2_submapper(1, 6));
+	EXPECT_EQ(nullptr, NESMappers::lookup_nes2_submapper(0, 1));
+	EXPECT_EQ(nullptr, NESMappers::lookup_nes2_submapper(4095, 1));
+}
+
+/**
+ * Test Nintendo3DSFirmData.
+ */
+TEST_F(DataLookupTest, Nintendo3DSFirmData_test)
+{
+	const Nintendo3DSFirmData::FirmBin_t *firmBin = Nintendo3DSFirmData::lookup_firmBin(0x104F1A22);
+	ASSERT_TRUE(firmBin != nullptr);
+	EXPECT_EQ(0x104F1A22U, firmBin->crc);
+	EXPECT_EQ(2, firmBin->kernel.major);
+	EXPECT_EQ(50, firmBin->kernel.minor);
+	EXPECT_EQ(9, firmBin->kernel.revision);
+	EXPECT_TRUE(firmBin->isNew3DS);
+
+	EXPECT_EQ(nullptr, Nintendo3DSFirmData::lookup_firmBin(0x00000001));
+}
+
+/**
+ * Test Nintendo3DSSysTitles.
+ */
+TEST_F(DataLookupTest, Nintendo3DSSysTitles_test)
+{
+	const char *region = nullptr;
+	EXPECT_STREQ("System Settings", Nintendo3DSSysTitles::lookup_sys_title(0x00040010, 0x00021000, &region));
+	EXPECT_STREQ("USA", region);
+	EXPECT_STREQ("Face Raiders", Nintendo3DSSysTitles::lookup_sys_title(0x00040010, 0x20027D00, &region));
+	EXPECT_STREQ("KOR", region);
+	EXPECT_STREQ("amiibo Settings", Nintendo3DSSysTitles::lookup_sys_title(0x00040030, 0x0000BF02, &region));
+	EXPECT_STREQ("TWN", region);
+
+	region = "";
+	EXPECT_EQ(nullptr, Nintendo3DSSysTitles::lookup_sys_title(0x00040000, 0x00021000, &region));
+	EXPECT_EQ(nullptr, region);
+	EXPECT_EQ(nullptr, Nintendo3DSSysTitles::lookup_sys_title(0x00040010, 0x00021001, nullptr));
+}
+
+/**
+ * Test WiiSystemMenuVersion, WiiUData, and Xbox360_STFS_ContentType.
+ */
+TEST_F(DataLookupTest, MiscData_test)
+{
+	EXPECT_STREQ("4.1U", WiiSystemMenuVersion::lookup(449));
+	EXPECT_EQ(nullptr, WiiSystemMenuVersion::lookup(1));
+
+	EXPECT_EQ(static_cast<uint32_t>('0001'), WiiUData::lookup_disc_publisher("AAFE"));
+	EXPECT_EQ(static_cast<uint32_t>('00AF'), WiiUData::lookup_disc_publisher("ABEP"));
+	EXPECT_EQ(0U, WiiUData::lookup_disc_publisher("ZZZZ"));
+
+	EXPECT_STREQ("Saved Game", Xbox360_STFS_ContentType::lookup(0x1));
+	EXPECT_EQ(nullptr, Xbox360_STFS_ContentType::lookup(0xFFFFFFFF));
+}
+
+/**
+ * Test AmiiboData.
+ * NOTE: Skipped if amiibo-data.bin isn't installed.
+ */
+TEST_F(DataLookupTest, AmiiboData_test)
+{
+	const AmiiboData *const pAmiiboData = AmiiboData::instance();
+	const char *const series = pAmiiboData->lookup_char_series_name(0x00000000);
+	if (!series) {
+		GTEST_SKIP() << "amiibo-data.bin is not installed.";
+	}
+
+	EXPECT_STREQ("Super Mario Bros.", series);
+	EXPECT_STREQ("Mario", pAmiiboData->lookup_char_name(0x00000000));
+	EXPECT_STREQ("Dr. Mario", pAmiiboData->lookup_char_name(0x00000100));
+	EXPECT_EQ(nullptr, pAmiiboData->lookup_char_name(0xFFFF0000));
+}
+
+/** Benchmarks **/
+
+/**
+ * Benchmark NintendoPublishers.
+ */
+TEST_F(DataLookupTest, NintendoPublishers_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int code = 0; code <= 0xFFFF; code += 7) {
+			found_count += !!NintendoPublishers::lookup(static_cast<uint16_t>(code));
+		}
+		for (unsigned int code = 0; code <= 0xFF; code++) {
+			found_count += !!NintendoPublishers::lookup_old(static_cast<uint8_t>(code));
+			found_count += !!NintendoPublishers::lookup_fds(static_cast<uint8_t>(code));
+		}
+	}
+}
+
+/**
+ * Benchmark SegaPublishers.
+ */
+TEST_F(DataLookupTest, SegaPublishers_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int code = 0; code < 1000; code++) {
+			found_count += !!SegaPublishers::lookup(code);
+		}
+	}
+}
+
+/**
+ * Benchmark XboxPublishers.
+ */
+TEST_F(DataLookupTest, XboxPublishers_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int code = 0; code <= 0xFFFF; code += 7) {
+			found_count += !!XboxPublishers::lookup(static_cast<uint16_t>(code));
+		}
+	}
+}
+
+/**
+ * Benchmark WonderSwanPublishers.
+ */
+TEST_F(DataLookupTest, WonderSwanPublishers_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int id = 0; id <= 0xFF; id++) {
+			found_count += !!WonderSwanPublishers::lookup_name(static_cast<uint8_t>(id));
+			found_count += !!WonderSwanPublishers::lookup_code(static_cast<uint8_t>(id));
+		}
+	}
+}
+
+/**
+ * Benchmark ELFData.
+ */
+TEST_F(DataLookupTest, ELFData_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int cpu = 0; cpu <= 0xFFFF; cpu += 7) {
+			found_count += !!ELFData::lookup_cpu(static_cast<uint16_t>(cpu));
+		}
+		for (unsigned int osabi = 0; osabi <= 0xFF; osabi++) {
+			found_count += !!ELFData::lookup_osabi(static_cast<uint8_t>(osabi));
+		}
+	}
+}
+
+/**
+ * Benchmark EXEData.
+ */
+TEST_F(DataLookupTest, EXEData_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int cpu = 0; cpu <= 0xFFFF; cpu += 7) {
+			found_count += !!EXEData::lookup_pe_cpu(static_cast<uint16_t>(cpu));
+			found_count += !!EXEData::lookup_le_cpu(static_cast<uint16_t>(cpu));
+		}
+	}
+}
+
+/**
+ * Benchmark MachOData.
+ */
+TEST_F(DataLookupTest, MachOData_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int abi = 0; abi < 4; abi++) {
+			for (unsigned int cpu = 0; cpu < 32; cpu++) {
+				const uint32_t cputype = (abi << 24) | cpu;
+				found_count += !!MachOData::lookup_cpu_type(cputype);
+				for (unsigned int subtype = 0; subtype < 16; subtype++) {
+					found_count += !!MachOData::lookup_cpu_subtype(cputype, subtype);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Benchmark NESMappers.
+ */
+TEST_F(DataLookupTest, NESMappers_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (int mapper = 0; mapper < 512; mapper++) {
+			found_count += !!NESMappers::lookup_ines(mapper);
+			for (int submapper = 0; submapper < 16; submapper++) {
+				found_count += !!NESMappers::lookup_nes2_submapper(mapper, submapper);
+			}
+		}
+	}
+}
+
+/**
+ * Benchmark Nintendo3DSFirmData.
+ */
+TEST_F(DataLookupTest, Nintendo3DSFirmData_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (uint32_t crc = 0; crc < 0xFFFF0000U; crc += 0x10001) {
+			found_count += !!Nintendo3DSFirmData::lookup_firmBin(crc);
+		}
+	}
+}
+
+/**
+ * Benchmark Nintendo3DSSysTitles.
+ */
+TEST_F(DataLookupTest, Nintendo3DSSysTitles_benchmark)
+{
+	static const uint32_t tid_hi_tbl[] = {0x00040010, 0x00040030};
+	const char *region;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int j = 0; j < ARRAY_SIZE(tid_hi_tbl); j++) {
+			for (uint32_t tid_lo = 0x00008000; tid_lo < 0x00030000; tid_lo += 0x100) {
+				found_count += !!Nintendo3DSSysTitles::lookup_sys_title(tid_hi_tbl[j], tid_lo | 0x02, &region);
+				found_count += !!Nintendo3DSSysTitles::lookup_sys_title(tid_hi_tbl[j], tid_lo, &region);
+			}
+		}
+	}
+}
+
+/**
+ * Benchmark WiiSystemMenuVersion.
+ */
+TEST_F(DataLookupTest, WiiSystemMenuVersion_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (unsigned int version = 0; version <= 0xFFFF; version += 3) {
+			found_count += !!WiiSystemMenuVersion::lookup(version);
+		}
+	}
+}
+
+/**
+ * Benchmark WiiUData.
+ */
+TEST_F(DataLookupTest, WiiUData_benchmark)
+{
+	char id4[4] = {'A', 'A', 'A', 'E'};
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (char c1 = 'A'; c1 <= 'Z'; c1++) {
+			id4[1] = c1;
+			for (char c2 = 'A'; c2 <= 'Z'; c2++) {
+				id4[2] = c2;
+				found_count += !!WiiUData::lookup_disc_publisher(id4);
+			}
+		}
+	}
+}
+
+/**
+ * Benchmark Xbox360_STFS_ContentType.
+ */
+TEST_F(DataLookupTest, Xbox360_STFS_ContentType_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (uint32_t contentType = 0; contentType < 0x00100000; contentType += 0x11) {
+			found_count += !!Xbox360_STFS_ContentType::lookup(contentType);
+		}
+	}
+}
+
+/**
+ * Benchmark AmiiboData.
+ * NOTE: If amiibo-data.bin isn't installed, this only
+ * measures the file check in AmiiboData's loader.
+ */
+TEST_F(DataLookupTest, AmiiboData_benchmark)
+{
+	const AmiiboData *const pAmiiboData = AmiiboData::instance();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (uint32_t char_id = 0; char_id < 0x40000000; char_id += 0x00100100) {
+			found_count += !!pAmiiboData->lookup_char_series_name(char_id);
+			found_count += !!pAmiiboData->lookup_char_name(char_id);
+		}
+		for (uint32_t amiibo_id = 0; amiibo_id < 0x04000000; amiibo_id += 0x00010100) {
+			found_count += !!pAmiiboData->lookup_amiibo_series_name(amiibo_id);
+			found_count += !!pAmiiboData->lookup_amiibo_series_data(amiibo_id, nullptr, nullptr);
+		}
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: DataLookupTest tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -21,10 +21,12 @@
 // librpbase, librpfile
 #include "librpbase/TextFuncs.hpp"
 #include "librpfile/FileSystem.hpp"
+#include "librpcpu/byteswap_rp.h"
 using namespace LibRpBase;
 
 // libromdata
 #include "disc/GcnFst.hpp"
+#include "Console/gcn_structs.h"
 using LibRomData::GcnFst;
 
 // libwin32common
@@ -37,8 +39,11 @@ using LibRomData::GcnFst;
 
 // C includes. (C++ namespace)
 #include "ctypex.h"
+#include <cerrno>
 
 // C++ includes.
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 #include <string>
 #include <unordered_set>
@@ -129,6 +134,14 @@ class GcnFstTest : public ::testing::TestWithParam<GcnFstTest_mode>
 		 */
 		void checkNoDuplicateFilenames(const char *subdir);
 
+		/**
+		 * Recursively check that find_file() finds all files
+		 * in a subdirectory.
+		 * @param subdir Subdirectory path.
+		 * @param ignoreCase If true, paths with different case must be found.
+		 */
+		void checkFindFile(const char *subdir, bool ignoreCase);
+
 	public:
 		/** Test case parameters. **/
 
@@ -376,6 +389,73 @@ void GcnFstTest::checkNoDuplicateFilenames(const char *subdir)
 	m_fst->closedir(dirp);
 }
 
+/**
+ * Recursively check that find_file() finds all files
+ * in a subdirectory.
+ * @param subdir Subdirectory path.
+ * @param ignoreCase If true, paths with different case must be found.
+ */
+void GcnFstTest::checkFindFile(const char *subdir, bool ignoreCase)
+{
+	vector<string> subdirs;
+
+	IFst::Dir *dirp = m_fst->opendir(subdir);
+	ASSERT_TRUE(dirp != nullptr) <<
+		"Failed to open directory '" << subdir << "'.";
+
+	IFst::DirEnt *dirent = m_fst->readdir(dirp);
+	while (dirent != nullptr) {
+		string path = subdir;
+		if (!path.empty() && path[path.size()-1] != '/') {
+			path += '/';
+		}
+		path += dirent->name;
+
+		// Save the directory entry, since find_file()
+		// might invalidate the name.
+		const IFst::DirEnt orig_dirent = *dirent;
+		const string orig_name = dirent->name;
+
+		IFst::DirEnt find_dirent;
+		EXPECT_EQ(0, m_fst->find_file(path.c_str(), &find_dirent)) <<
+			"find_file('" << path << "') failed.";
+		EXPECT_EQ(orig_dirent.type, find_dirent.type);
+		EXPECT_EQ(orig_dirent.offset, find_dirent.offset);
+		EXPECT_EQ(orig_dirent.size, find_dirent.size);
+
+		// Check again using uppercase ASCII letters.
+		string upper_path = path;
+		std::transform(upper_path.begin(), upper_path.end(), upper_path.begin(),
+			[](char c) -> char { return (c >= 'a' && c <= 'z') ? (c & ~0x20) : c; });
+		if (ignoreCase) {
+			EXPECT_EQ(0, m_fst->find_file(upper_path.c_str(), &find_dirent)) <<
+				"find_file('" << upper_path << "') failed.";
+			EXPECT_EQ(orig_dirent.type, find_dirent.type);
+			EXPECT_EQ(orig_dirent.offset, find_dirent.offset);
+			EXPECT_EQ(orig_dirent.size, find_dirent.size);
+		} else if (upper_path != path) {
+			// Case must match exactly.
+			EXPECT_EQ(-ENOENT, m_fst->find_file(upper_path.c_str(), &find_dirent)) <<
+				"find_file('" << upper_path << "') should have failed.";
+		}
+
+		if (orig_dirent.type == DT_DIR) {
+			subdirs.push_back(std::move(path));
+		}
+
+		// Next entry.
+		dirent = m_fst->readdir(dirp);
+	}
+
+	// End of directory.
+	m_fst->closedir(dirp);
+
+	// Check subdirectories.
+	for (const string &path : subdirs) {
+		checkFindFile(path.c_str(), ignoreCase);
+	}
+}
+
 /**
  * Verify that '/' is collapsed correctly.
  */
@@ -400,6 +480,37 @@ TEST_P(GcnFstTest, NoDuplicateFilenames)
 	EXPECT_FALSE(m_fst->hasErrors());
 }
 
+/**
+ * Make sure find_file() finds all files.
+ * Paths are case-sensitive by default.
+ */
+TEST_P(GcnFstTest, FindFile)
+{
+	ASSERT_FALSE(static_cast<GcnFst*>(m_fst)->isCaseInsensitive());
+	ASSERT_NO_FATAL_FAILURE(checkFindFile("/", false));
+	EXPECT_FALSE(m_fst->hasErrors());
+
+	IFst::DirEnt dirent;
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/this/file/does/not/exist.bin", &dirent));
+}
+
+/**
+ * Make sure find_file() finds all files with case-insensitive lookups.
+ */
+TEST_P(GcnFstTest, FindFileIgnoreCase)
+{
+	static_cast<GcnFst*>(m_fst)->setCaseInsensitive(true);
+	ASSERT_NO_FATAL_FAILURE(checkFindFile("/", true));
+	EXPECT_FALSE(m_fst->hasErrors());
+
+	IFst::DirEnt dirent;
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/this/file/does/not/exist.bin", &dirent));
+
+	// Switching back to case-sensitive lookups rebuilds the path index.
+	static_cast<GcnFst*>(m_fst)->setCaseInsensitive(false);
+	ASSERT_NO_FATAL_FAILURE(checkFindFile("/", false));
+}
+
 /**
  * Print the FST directory structure and compare it to a known-good version.
  */
@@ -584,6 +695,122 @@ string GcnFstTest::test_case_suffix_generator(const ::testing::TestParamInfo<Gcn
 	return suffix;
 }
 
+/**
+ * Synthetic FST benchmark for find_file().
+ * Uses a large generated FST instead of the test FSTs,
+ * since the test FSTs are too small to be useful here.
+ */
+class GcnFstBenchmark : public ::testing::Test
+{
+	protected:
+		// Synthetic FST layout.
+		static const unsigned int DIR_COUNT = 64;
+		static const unsigned int FILES_PER_DIR = 256;
+
+		// Number of times to look up every file.
+		static const unsigned int LOOKUP_ITERATIONS = 8;
+
+		/**
+		 * Build the synthetic FST.
+		 * @param fst_data	[out] FST data.
+		 * @param paths		[out] File paths.
+		 */
+		static void buildFst(ao::uvector<uint8_t> &fst_data, vector<string> &paths);
+};
+
+/**
+ * Build the synthetic FST.
+ * @param fst_data	[out] FST data.
+ * @param paths		[out] File paths.
+ */
+void GcnFstBenchmark::buildFst(ao::uvector<uint8_t> &fst_data, vector<string> &paths)
+{
+	const unsigned int entry_count = 1 + (DIR_COUNT * (1 + FILES_PER_DIR));
+	vector<GCN_FST_Entry> entries;
+	entries.reserve(entry_count);
+	string string_table;
+	paths.clear();
+	paths.reserve(DIR_COUNT * FILES_PER_DIR);
+
+	// Root directory.
+	GCN_FST_Entry entry;
+	entry.file_type_name_offset = cpu_to_be32(0x01000000);
+	entry.root_dir.unused = 0;
+	entry.root_dir.file_count = cpu_to_be32(entry_count);
+	entries.push_back(entry);
+
+	char name[32];
+	for (unsigned int d = 0; d < DIR_COUNT; d++) {
+		const uint32_t dir_idx = static_cast<uint32_t>(entries.size());
+		snprintf(name, sizeof(name), "dir%03u", d);
+		const string dir_name = name;
+		entry.file_type_name_offset = cpu_to_be32(0x01000000 | static_cast<uint32_t>(string_table.size()));
+		entry.dir.parent_dir_idx = 0;
+		entry.dir.next_offset = cpu_to_be32(dir_idx + 1 + FILES_PER_DIR);
+		entries.push_back(entry);
+		string_table.append(dir_name.c_str(), dir_name.size() + 1);
+
+		for (unsigned int f = 0; f < FILES_PER_DIR; f++) {
+			snprintf(name, sizeof(name), "file%04u.bin", f);
+			entry.file_type_name_offset = cpu_to_be32(static_cast<uint32_t>(string_table.size()));
+			entry.file.offset = cpu_to_be32((dir_idx + f) * 0x800);
+			entry.file.size = cpu_to_be32(f + 1);
+			entries.push_back(entry);
+			string_table.append(name, strlen(name) + 1);
+
+			paths.push_back('/' + dir_name + '/' + name);
+		}
+	}
+
+	const size_t entries_size = entries.size() * sizeof(GCN_FST_Entry);
+	fst_data.resize(entries_size + string_table.size());
+	memcpy(fst_data.data(), entries.data(), entries_size);
+	memcpy(&fst_data[entries_size], string_table.data(), string_table.size());
+}
+
+/**
+ * Benchmark find_file() using a large synthetic FST.
+ */
+TEST_F(GcnFstBenchmark, find_file_benchmark)
+{
+	using namespace std::chrono;
+
+	ao::uvector<uint8_t> fst_data;
+	vector<string> paths;
+	ASSERT_NO_FATAL_FAILURE(buildFst(fst_data, paths));
+
+	GcnFst fst(fst_data.data(), static_cast<uint32_t>(fst_data.size()), 0);
+	ASSERT_TRUE(fst.isOpen());
+	ASSERT_FALSE(fst.hasErrors());
+
+	// First lookup. (includes any one-time setup)
+	IFst::DirEnt dirent;
+	auto t0 = steady_clock::now();
+	ASSERT_EQ(0, fst.find_file(paths.back().c_str(), &dirent));
+	auto t1 = steady_clock::now();
+	EXPECT_EQ(static_cast<off64_t>(FILES_PER_DIR), dirent.size);
+
+	// Look up every file.
+	for (unsigned int i = LOOKUP_ITERATIONS; i > 0; i--) {
+		for (const string &path : paths) {
+			ASSERT_EQ(0, fst.find_file(path.c_str(), &dirent)) <<
+				"find_file('" << path << "') failed.";
+		}
+	}
+	auto t2 = steady_clock::now();
+
+	const uint64_t first_us = duration_cast<microseconds>(t1 - t0).count();
+	const uint64_t lookup_ns = duration_cast<nanoseconds>(t2 - t1).count() /
+		(static_cast<uint64_t>(paths.size()) * LOOKUP_ITERATIONS);
+
+	// Machine-readable results. (JSON Lines)
+	printf("{\"files\":%u,\"first_lookup_us\":%llu,\"lookup_ns\":%llu}\n",
+		static_cast<unsigned int>(paths.size()),
+		static_cast<unsigned long long>(first_us),
+		static_cast<unsigned long long>(lookup_ns));
+	fflush(stdout);
+}
+
 INSTANTIATE_TEST_SUITE_P(GameCube, GcnFstTest,
 	testing::ValuesIn(GcnFstTest::ReadTestCasesFromDisk(0))
 	, GcnFstTest::test_case_suffix_generator);
@@ -0,0 +1,276 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * NCCHReaderTest.cpp: NCCHReader decryption tests and benchmarks.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+#include "byteswap_rp.h"
+
+// librpbase, librpfile
+#include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/IAesCipher.hpp"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/NCCHReader.hpp"
+#include "crypto/N3DSVerifyKeys.hpp"
+#include "Handheld/n3ds_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * Synthetic NCCH image.
+ *
+ * The NCCH uses FixedCryptoKey with a non-system program ID,
+ * so it's encrypted using the zero key. This allows testing
+ * NCCH decryption without any user-supplied keys.
+ *
+ * Layout: (media unit shift is 9)
+ * - 0x000000: NCCH header
+ * - 0x000200: ExeFS header (encrypted)
+ * - 0x000400: ExeFS ".code" file (encrypted)
+ * - 0x000600: RomFS (encrypted)
+ */
+class NCCHReaderTest : public ::testing::Test
+{
+	protected:
+		NCCHReaderTest()
+			: memFile(nullptr)
+			, ncchReader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		static void SetUpTestCase(void);
+		static void TearDownTestCase(void);
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 20;
+
+		static const uint8_t MEDIA_UNIT_SHIFT = 9;
+		static const uint32_t EXEFS_OFFSET = 0x200;
+		static const uint32_t CODE_OFFSET = 0x400;
+		static const uint32_t CODE_SIZE = 0x200;
+		static const uint32_t ROMFS_OFFSET = 0x600;
+		static const uint32_t ROMFS_SIZE = 16*1024*1024;
+		static const uint32_t NCCH_SIZE = ROMFS_OFFSET + ROMFS_SIZE;
+
+		// Title ID. (Non-system, so the zero key is used.)
+		static const uint64_t TITLE_ID = 0x0004000000123400ULL;
+
+		// NCCH image: plaintext and encrypted
+		static uint8_t *ncch_plain;
+		static uint8_t *ncch_enc;
+
+		// NCCHReader for the encrypted image.
+		RpMemFile *memFile;
+		NCCHReader *ncchReader;
+
+		/**
+		 * Encrypt a section of the NCCH image.
+		 * @param cipher Cipher. (zero key, CTR mode)
+		 * @param section Section ID.
+		 * @param offset Section offset.
+		 * @param ctr_base Counter base address.
+		 * @param size Size of the section.
+		 */
+		static void encryptSection(IAesCipher *cipher, uint8_t section,
+			uint32_t offset, uint32_t ctr_base, uint32_t size);
+};
+
+uint8_t *NCCHReaderTest::ncch_plain = nullptr;
+uint8_t *NCCHReaderTest::ncch_enc = nullptr;
+
+/**
+ * Encrypt a section of the NCCH image.
+ * @param cipher Cipher. (zero key, CTR mode)
+ * @param section Section ID.
+ * @param offset Section offset.
+ * @param ctr_base Counter base address.
+ * @param size Size of the section.
+ */
+void NCCHReaderTest::encryptSection(IAesCipher *cipher, uint8_t section,
+	uint32_t offset, uint32_t ctr_base, uint32_t size)
+{
+	u128_t ctr;
+	ctr.init_ctr(cpu_to_be64(TITLE_ID), section, offset - ctr_base);
+	cipher->setIV(ctr.u8, sizeof(ctr.u8));
+	// NOTE: AES-CTR encryption and decryption are the same operation.
+	cipher->decrypt(&ncch_enc[offset], size);
+}
+
+void NCCHReaderTest::SetUpTestCase(void)
+{
+	ncch_plain = static_cast<uint8_t*>(malloc(NCCH_SIZE));
+	ncch_enc = static_cast<uint8_t*>(malloc(NCCH_SIZE));
+	ASSERT_TRUE(ncch_plain != nullptr);
+	ASSERT_TRUE(ncch_enc != nullptr);
+
+	// Fill the image with a pseudo-random pattern. (xorshift32)
+	uint32_t x = 0x3D5A1C27;
+	for (uint32_t i = 0; i < NCCH_SIZE; i += 4) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		memcpy(&ncch_plain[i], &x, sizeof(x));
+	}
+
+	// NCCH header.
+	N3DS_NCCH_Header_t *const ncch_header = reinterpret_cast<N3DS_NCCH_Header_t*>(ncch_plain);
+	memset(ncch_header, 0, sizeof(*ncch_header));
+	ncch_header->hdr.magic = cpu_to_be32(N3DS_NCCH_HEADER_MAGIC);
+	ncch_header->hdr.content_size = cpu_to_le32(NCCH_SIZE >> MEDIA_UNIT_SHIFT);
+	ncch_header->hdr.title_id.id = cpu_to_le64(TITLE_ID);
+	ncch_header->hdr.program_id.id = cpu_to_le64(TITLE_ID);
+	ncch_header->hdr.flags[N3DS_NCCH_FLAG_CONTENT_UNIT_SIZE] = 0;
+	ncch_header->hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] = N3DS_NCCH_BIT_MASK_FixedCryptoKey;
+	ncch_header->hdr.exefs_offset = cpu_to_le32(EXEFS_OFFSET >> MEDIA_UNIT_SHIFT);
+	ncch_header->hdr.exefs_size = cpu_to_le32((ROMFS_OFFSET - EXEFS_OFFSET) >> MEDIA_UNIT_SHIFT);
+	ncch_header->hdr.romfs_offset = cpu_to_le32(ROMFS_OFFSET >> MEDIA_UNIT_SHIFT);
+	ncch_header->hdr.romfs_size = cpu_to_le32(ROMFS_SIZE >> MEDIA_UNIT_SHIFT);
+
+	// ExeFS header.
+	N3DS_ExeFS_Header_t *const exefs_header = reinterpret_cast<N3DS_ExeFS_Header_t*>(&ncch_plain[EXEFS_OFFSET]);
+	memset(exefs_header, 0, sizeof(*exefs_header));
+	memcpy(exefs_header->files[0].name, ".code", 5);
+	exefs_header->files[0].offset = cpu_to_le32(0);
+	exefs_header->files[0].size = cpu_to_le32(CODE_SIZE);
+
+	// Encrypt the image.
+	memcpy(ncch_enc, ncch_plain, NCCH_SIZE);
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	ASSERT_TRUE(cipher.get() != nullptr);
+	static const uint8_t zero_key[16] = {0};
+	ASSERT_EQ(0, cipher->setChainingMode(IAesCipher::ChainingMode::CTR));
+	ASSERT_EQ(0, cipher->setKey(zero_key, sizeof(zero_key)));
+
+	encryptSection(cipher.get(), N3DS_NCCH_SECTION_EXEFS, EXEFS_OFFSET, EXEFS_OFFSET, sizeof(N3DS_ExeFS_Header_t));
+	encryptSection(cipher.get(), N3DS_NCCH_SECTION_EXEFS, CODE_OFFSET, EXEFS_OFFSET, CODE_SIZE);
+	encryptSection(cipher.get(), N3DS_NCCH_SECTION_ROMFS, ROMFS_OFFSET, ROMFS_OFFSET, ROMFS_SIZE);
+}
+
+void NCCHReaderTest::TearDownTestCase(void)
+{
+	free(ncch_plain);
+	free(ncch_enc);
+	ncch_plain = nullptr;
+	ncch_enc = nullptr;
+}
+
+void NCCHReaderTest::SetUp(void)
+{
+	ASSERT_TRUE(ncch_enc != nullptr);
+	memFile = new RpMemFile(ncch_enc, NCCH_SIZE);
+	ncchReader = new NCCHReader(memFile, MEDIA_UNIT_SHIFT, 0, NCCH_SIZE);
+	ASSERT_TRUE(ncchReader->isOpen());
+	ASSERT_EQ(KeyManager::VerifyResult::OK, ncchReader->verifyResult());
+}
+
+void NCCHReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(ncchReader);
+	UNREF_AND_NULL(memFile);
+}
+
+/** Decryption tests **/
+
+/**
+ * Read the entire RomFS in a single read.
+ * This uses multi-threaded decryption if more than one CPU is available.
+ */
+TEST_F(NCCHReaderTest, readRomFS_full)
+{
+	vector<uint8_t> buf(ROMFS_SIZE);
+	ASSERT_EQ(buf.size(), ncchReader->seekAndRead(ROMFS_OFFSET, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(&ncch_plain[ROMFS_OFFSET], buf.data(), buf.size()));
+}
+
+/**
+ * Read the RomFS using small reads.
+ */
+TEST_F(NCCHReaderTest, readRomFS_small)
+{
+	static const size_t CHUNK_SIZE = 4096;
+	uint8_t buf[CHUNK_SIZE];
+	ASSERT_EQ(0, ncchReader->seek(ROMFS_OFFSET));
+	for (uint32_t pos = ROMFS_OFFSET; pos < NCCH_SIZE; pos += CHUNK_SIZE) {
+		ASSERT_EQ(CHUNK_SIZE, ncchReader->read(buf, sizeof(buf)));
+		ASSERT_EQ(0, memcmp(&ncch_plain[pos], buf, sizeof(buf))) << "position 0x" << std::hex << pos;
+	}
+}
+
+/**
+ * Read from the ExeFS header through the beginning of the RomFS.
+ * This crosses three encrypted sections in one read.
+ */
+TEST_F(NCCHReaderTest, readAcrossSections)
+{
+	static const size_t READ_SIZE = (ROMFS_OFFSET - EXEFS_OFFSET) + 65536;
+	vector<uint8_t> buf(READ_SIZE);
+	ASSERT_EQ(READ_SIZE, ncchReader->seekAndRead(EXEFS_OFFSET, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(&ncch_plain[EXEFS_OFFSET], buf.data(), buf.size()));
+}
+
+/** Benchmarks **/
+
+/**
+ * Benchmark reading the entire RomFS in a single read.
+ */
+TEST_F(NCCHReaderTest, readRomFS_full_benchmark)
+{
+	vector<uint8_t> buf(ROMFS_SIZE);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		ASSERT_EQ(buf.size(), ncchReader->seekAndRead(ROMFS_OFFSET, buf.data(), buf.size()));
+	}
+}
+
+/**
+ * Benchmark reading the RomFS using small reads.
+ */
+TEST_F(NCCHReaderTest, readRomFS_small_benchmark)
+{
+	static const size_t CHUNK_SIZE = 4096;
+	uint8_t buf[CHUNK_SIZE];
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		ASSERT_EQ(0, ncchReader->seek(ROMFS_OFFSET));
+		for (uint32_t pos = ROMFS_OFFSET; pos < NCCH_SIZE; pos += CHUNK_SIZE) {
+			ASSERT_EQ(CHUNK_SIZE, ncchReader->read(buf, sizeof(buf)));
+		}
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: NCCHReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,372 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * CacheIndexTest.cpp: Download cache index tests.                         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpfile
+#include "librpfile/FileSystem.hpp"
+using namespace LibRpFile;
+
+// libcachecommon
+#include "libcachecommon/CacheKeys.hpp"
+
+// libromdata
+#include "img/CacheIndex.hpp"
+#include "img/CacheManager.hpp"
+
+// C includes.
+#include <stdlib.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+namespace LibRomData { namespace Tests {
+
+// Maximum number of cache entries.
+// This is set in the test configuration file.
+#define TEST_CACHE_MAX_ENTRIES 10
+
+// Temporary directory for XDG_CACHE_HOME and XDG_CONFIG_HOME.
+static string tmp_dir;
+
+/**
+ * Separate CacheIndex instance.
+ * Used to simulate another process using the same cache directory.
+ */
+class TestCacheIndex : public CacheIndex
+{
+	public:
+		TestCacheIndex() { }
+		~TestCacheIndex() { }
+};
+
+class CacheIndexTest : public ::testing::Test
+{
+	protected:
+		/**
+		 * Create a file in the cache directory.
+		 * @param cache_key Cache key.
+		 * @param size File size.
+		 * @param legacy If true, use the non-sharded layout.
+		 * @return Cache filename, or empty string on error.
+		 */
+		static string createCacheFile(const char *cache_key, size_t size, bool legacy = false);
+
+		/**
+		 * Get the cache statistics.
+		 * @return Statistics.
+		 */
+		static CacheIndex::Stats getStats(void)
+		{
+			CacheIndex::Stats stats;
+			CacheIndex::instance()->getStats(&stats);
+			return stats;
+		}
+
+		/**
+		 * Get the on-disk index.
+		 * @return On-disk index, or empty string on error.
+		 */
+		static string readIndexFile(void);
+};
+
+/**
+ * Create a file in the cache directory.
+ * @param cache_key Cache key.
+ * @param size File size.
+ * @param legacy If true, use the non-sharded layout.
+ * @return Cache filename, or empty string on error.
+ */
+string CacheIndexTest::createCacheFile(const char *cache_key, size_t size, bool legacy)
+{
+	const string filename = (legacy
+		? LibCacheCommon::getLegacyCacheFilename(cache_key)
+		: LibCacheCommon::getCacheFilename(cache_key));
+	if (filename.empty() || FileSystem::rmkdir(filename) != 0) {
+		return string();
+	}
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	if (!f) {
+		return string();
+	}
+	const string data(size, 'x');
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+	return filename;
+}
+
+/**
+ * Get the on-disk index.
+ * @return On-disk index, or empty string on error.
+ */
+string CacheIndexTest::readIndexFile(void)
+{
+	FILE *f = fopen((tmp_dir + "/cache/rom-properties/cache.idx").c_str(), "rb");
+	if (!f) {
+		return string();
+	}
+	string data;
+	char buf[4096];
+	size_t size;
+	while ((size = fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.append(buf, size);
+	}
+	fclose(f);
+	return data;
+}
+
+/**
+ * Test the sharded cache layout.
+ */
+TEST_F(CacheIndexTest, shardedFilename)
+{
+	const string filename = LibCacheCommon::getCacheFilename("wii/disc/US/RSPE01.png");
+	const string legacy_filename = LibCacheCommon::getLegacyCacheFilename("wii/disc/US/RSPE01.png");
+	ASSERT_FALSE(filename.empty());
+	ASSERT_FALSE(legacy_filename.empty());
+
+	// The sharded filename has a two-digit hexadecimal subdirectory
+	// between the cache key's directory and filename.
+	const string prefix = tmp_dir + "/cache/rom-properties/wii/disc/US/";
+	EXPECT_EQ(prefix + "RSPE01.png", legacy_filename);
+	ASSERT_EQ(prefix.size() + 3 + 10, filename.size());
+	EXPECT_EQ(prefix, filename.substr(0, prefix.size()));
+	EXPECT_TRUE(isxdigit(filename[prefix.size()]));
+	EXPECT_TRUE(isxdigit(filename[prefix.size()+1]));
+	EXPECT_EQ('/', filename[prefix.size()+2]);
+	EXPECT_EQ("RSPE01.png", filename.substr(prefix.size()+3));
+
+	// The shard must be the same every time.
+	EXPECT_EQ(filename, LibCacheCommon::getCacheFilename("wii/disc/US/RSPE01.png"));
+}
+
+/**
+ * Test hit and miss statistics.
+ */
+TEST_F(CacheIndexTest, stats)
+{
+	const CacheIndex::Stats before = getStats();
+	CacheIndex *const cacheIndex = CacheIndex::instance();
+
+	const string filename = createCacheFile("stats/test.png", 1000);
+	ASSERT_FALSE(filename.empty());
+	cacheIndex->recordMiss(filename, 1000);
+	cacheIndex->recordHit(filename, 1000);
+	cacheIndex->recordHit(filename, 1000);
+
+	// Files outside of the cache directory are ignored.
+	cacheIndex->recordHit(tmp_dir + "/not-in-cache.png", 1000);
+
+	const CacheIndex::Stats after = getStats();
+	EXPECT_EQ(before.hits + 2, after.hits);
+	EXPECT_EQ(before.misses + 1, after.misses);
+	EXPECT_EQ(before.bytes_saved + 2000, after.bytes_saved);
+	EXPECT_EQ(before.entries + 1, after.entries);
+	EXPECT_EQ(before.total_size + 1000, after.total_size);
+
+	// The statistics must be saved in the on-disk index,
+	// so another process sees the same statistics.
+	EXPECT_EQ(0, cacheIndex->save());
+	{
+		TestCacheIndex otherIndex;
+		CacheIndex::Stats other;
+		otherIndex.getStats(&other);
+		EXPECT_EQ(after.hits, other.hits);
+		EXPECT_EQ(after.misses, other.misses);
+		EXPECT_EQ(after.bytes_saved, other.bytes_saved);
+		EXPECT_EQ(after.entries, other.entries);
+		EXPECT_EQ(after.total_size, other.total_size);
+	}
+
+	cacheIndex->remove(filename);
+	FileSystem::delete_file(filename);
+	EXPECT_EQ(0, cacheIndex->save());
+}
+
+/**
+ * getStats() must not write to the on-disk index.
+ * Updates are appended to the on-disk index when it's saved.
+ */
+TEST_F(CacheIndexTest, getStatsReadOnly)
+{
+	CacheIndex *const cacheIndex = CacheIndex::instance();
+	const string filename = createCacheFile("readonly/test.png", 500);
+	ASSERT_FALSE(filename.empty());
+	cacheIndex->recordMiss(filename, 500);
+	EXPECT_EQ(0, cacheIndex->save());
+
+	const string index_before = readIndexFile();
+	ASSERT_FALSE(index_before.empty());
+
+	cacheIndex->recordHit(filename, 500);
+	getStats();
+	EXPECT_EQ(index_before, readIndexFile());
+
+	// Saving the index appends the hit record.
+	EXPECT_EQ(0, cacheIndex->save());
+	const string index_after = readIndexFile();
+	ASSERT_GT(index_after.size(), index_before.size());
+	EXPECT_EQ(index_before, index_after.substr(0, index_before.size()));
+
+	cacheIndex->remove(filename);
+	FileSystem::delete_file(filename);
+	EXPECT_EQ(0, cacheIndex->save());
+}
+
+/**
+ * Entries removed by one process must not be
+ * added back by another process that saves the index.
+ */
+TEST_F(CacheIndexTest, removeNotResurrected)
+{
+	CacheIndex *const cacheIndex = CacheIndex::instance();
+	const string filename = createCacheFile("remove/test.png", 200);
+	ASSERT_FALSE(filename.empty());
+	cacheIndex->recordMiss(filename, 200);
+	EXPECT_EQ(0, cacheIndex->save());
+	const unsigned int entries = getStats().entries;
+
+	TestCacheIndex otherIndex;
+	CacheIndex::Stats other;
+	otherIndex.getStats(&other);
+	EXPECT_EQ(entries, other.entries);
+
+	// Remove the entry, then have the other process save the index.
+	cacheIndex->remove(filename);
+	FileSystem::delete_file(filename);
+	EXPECT_EQ(0, cacheIndex->save());
+	const string other_filename = createCacheFile("remove/other.png", 300);
+	ASSERT_FALSE(other_filename.empty());
+	otherIndex.recordMiss(other_filename, 300);
+	EXPECT_EQ(0, otherIndex.save());
+
+	// Removed entry must still be gone in both instances.
+	otherIndex.getStats(&other);
+	EXPECT_EQ(entries, other.entries);
+	EXPECT_EQ(entries, getStats().entries);
+
+	cacheIndex->remove(other_filename);
+	FileSystem::delete_file(other_filename);
+	EXPECT_EQ(0, cacheIndex->save());
+}
+
+/**
+ * Test migration of files from the non-sharded layout.
+ */
+TEST_F(CacheIndexTest, legacyMigration)
+{
+	const string legacy_filename = createCacheFile("legacy/test.png", 100, true);
+	ASSERT_FALSE(legacy_filename.empty());
+
+	CacheManager cache;
+	const string filename = cache.findInCache("legacy/test.png");
+	EXPECT_EQ(LibCacheCommon::getCacheFilename("legacy/test.png"), filename);
+	EXPECT_EQ(0, FileSystem::access(filename, R_OK));
+	EXPECT_NE(0, FileSystem::access(legacy_filename, F_OK));
+
+	CacheIndex::instance()->remove(filename);
+	FileSystem::delete_file(filename);
+}
+
+/**
+ * Test LRU eviction.
+ */
+TEST_F(CacheIndexTest, eviction)
+{
+	CacheIndex *const cacheIndex = CacheIndex::instance();
+	ASSERT_EQ(0U, getStats().entries);
+
+	// Add files until the cache is over its entry limit.
+	string filenames[TEST_CACHE_MAX_ENTRIES + 1];
+	for (unsigned int i = 0; i <= TEST_CACHE_MAX_ENTRIES; i++) {
+		char cache_key[32];
+		snprintf(cache_key, sizeof(cache_key), "evict/%02u.png", i);
+		filenames[i] = createCacheFile(cache_key, 100);
+		ASSERT_FALSE(filenames[i].empty());
+		cacheIndex->recordMiss(filenames[i], 100);
+	}
+
+	// Wait for the eviction thread to finish.
+	// The cache should be reduced to 90% of the limit.
+	const unsigned int target = TEST_CACHE_MAX_ENTRIES - (TEST_CACHE_MAX_ENTRIES / 10);
+	CacheIndex::Stats stats;
+	for (unsigned int i = 0; i < 500; i++) {
+		stats = getStats();
+		if (stats.entries <= target)
+			break;
+		usleep(10000);
+	}
+	EXPECT_EQ(target, stats.entries);
+	EXPECT_EQ(target * 100U, stats.total_size);
+
+	// Files that were evicted must have been deleted.
+	unsigned int remaining = 0;
+	for (const string &filename : filenames) {
+		if (FileSystem::access(filename, F_OK) == 0) {
+			remaining++;
+			cacheIndex->remove(filename);
+			FileSystem::delete_file(filename);
+		}
+	}
+	EXPECT_EQ(target, remaining);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: CacheIndex tests.\n\n");
+	fflush(nullptr);
+
+	// Use a temporary directory for the cache and configuration.
+	// NOTE: This must be done before the cache directory is initialized.
+	char tmpl[] = "/tmp/CacheIndexTest.XXXXXX";
+	if (!mkdtemp(tmpl)) {
+		fprintf(stderr, "*** ERROR: Unable to create a temporary directory.\n");
+		return EXIT_FAILURE;
+	}
+	LibRomData::Tests::tmp_dir = tmpl;
+	const string cache_home = LibRomData::Tests::tmp_dir + "/cache";
+	const string config_home = LibRomData::Tests::tmp_dir + "/config";
+	setenv("XDG_CACHE_HOME", cache_home.c_str(), 1);
+	setenv("XDG_CONFIG_HOME", config_home.c_str(), 1);
+
+	const string config_file = config_home + "/rom-properties/rom-properties.conf";
+	FileSystem::rmkdir(config_file);
+	FILE *f = fopen(config_file.c_str(), "w");
+	if (!f) {
+		fprintf(stderr, "*** ERROR: Unable to create the configuration file.\n");
+		return EXIT_FAILURE;
+	}
+	fprintf(f, "[Downloads]\nCacheMaxEntries=%u\n", TEST_CACHE_MAX_ENTRIES);
+	fclose(f);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	const int ret = RUN_ALL_TESTS();
+
+	// Remove the temporary directory.
+	const string cmd = "rm -rf '" + LibRomData::Tests::tmp_dir + '\'';
+	if (system(cmd.c_str()) != 0) {
+		fprintf(stderr, "*** WARNING: Unable to remove %s\n", LibRomData::Tests::tmp_dir.c_str());
+	}
+	return ret;
+}
@@ -0,0 +1,277 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * CacheManagerTest.cpp: CacheManager concurrent download tests.           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpfile, librpthreads
+#include "librpfile/FileSystem.hpp"
+#include "librpthreads/Mutex.hpp"
+using namespace LibRpFile;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// libcachecommon
+#include "libcachecommon/CacheKeys.hpp"
+
+// libromdata
+#include "img/CacheManager.hpp"
+
+// C includes.
+#include <stdlib.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+
+// C++ includes.
+#include <string>
+#include <unordered_map>
+#include <vector>
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+// Temporary directory for XDG_CACHE_HOME and XDG_CONFIG_HOME.
+static string tmp_dir;
+
+/**
+ * CacheManager with a simulated download server.
+ * This replaces rp-download so no network access is needed.
+ */
+class FakeServerCacheManager : public CacheManager
+{
+	public:
+		FakeServerCacheManager()
+			: active(0), max_active(0)
+		{ }
+
+	public:
+		struct File {
+			unsigned int delay_ms;	// Simulated download time
+			bool exists;		// Does the file exist on the server?
+		};
+
+		// Files on the simulated server. (key: cache key)
+		unordered_map<string, File> files;
+
+		Mutex mutex;			// Protects all fields below.
+		vector<string> requests;	// Cache keys that were requested
+		unsigned int active;		// Number of active downloads
+		unsigned int max_active;	// Maximum number of simultaneous downloads
+
+	protected:
+		/**
+		 * Simulate rp-download.
+		 * @param cache_key Cache key.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int execRpDownload(const string &cache_key) final
+		{
+			{
+				MutexLocker locker(mutex);
+				requests.emplace_back(cache_key);
+				active++;
+				if (active > max_active) {
+					max_active = active;
+				}
+			}
+
+			auto iter = files.find(cache_key);
+			const bool exists = (iter != files.end() && iter->second.exists);
+			if (iter != files.end()) {
+				usleep(iter->second.delay_ms * 1000);
+			}
+
+			// Like rp-download, create a 0-byte file if the
+			// file doesn't exist on the server.
+			const string filename = LibCacheCommon::getCacheFilename(cache_key);
+			int ret = -EIO;
+			if (!filename.empty() && FileSystem::rmkdir(filename) == 0) {
+				FILE *f = fopen(filename.c_str(), "wb");
+				if (f) {
+					if (exists) {
+						fputs(cache_key.c_str(), f);
+					}
+					fclose(f);
+					ret = (exists ? 0 : -ENOENT);
+				}
+			}
+
+			MutexLocker locker(mutex);
+			active--;
+			return ret;
+		}
+};
+
+class CacheManagerTest : public ::testing::Test
+{
+	protected:
+		/**
+		 * Get download candidates for the specified cache keys.
+		 * @param prefix Cache key prefix, e.g. test name.
+		 * @param count Number of candidates.
+		 * @return Candidates.
+		 */
+		static vector<CacheManager::Candidate> getCandidates(const char *prefix, unsigned int count)
+		{
+			vector<CacheManager::Candidate> candidates;
+			for (unsigned int i = 0; i < count; i++) {
+				CacheManager::Candidate candidate;
+				candidate.cache_key = string(prefix) + '/' + static_cast<char>('A' + i) + ".png";
+				candidate.download = true;
+				candidates.emplace_back(std::move(candidate));
+			}
+			return candidates;
+		}
+};
+
+/**
+ * The highest-priority candidate must be used, even if
+ * a lower-priority candidate finishes downloading first.
+ */
+TEST_F(CacheManagerTest, priorityOrder)
+{
+	FakeServerCacheManager cache;
+	const vector<CacheManager::Candidate> candidates = getCandidates("priorityOrder", 2);
+	cache.files[candidates[0].cache_key] = {200, true};
+	cache.files[candidates[1].cache_key] = {0, true};
+
+	string cache_filename;
+	EXPECT_EQ(0, cache.downloadFirst(candidates, 0, cache_filename));
+	EXPECT_EQ(LibCacheCommon::getCacheFilename(candidates[0].cache_key), cache_filename);
+}
+
+/**
+ * Candidates that aren't on the server must be skipped.
+ */
+TEST_F(CacheManagerTest, fallback)
+{
+	FakeServerCacheManager cache;
+	const vector<CacheManager::Candidate> candidates = getCandidates("fallback", 4);
+	cache.files[candidates[0].cache_key] = {20, false};
+	cache.files[candidates[1].cache_key] = {20, false};
+	cache.files[candidates[2].cache_key] = {20, true};
+	cache.files[candidates[3].cache_key] = {20, true};
+
+	string cache_filename;
+	EXPECT_EQ(2, cache.downloadFirst(candidates, 0, cache_filename));
+	EXPECT_EQ(LibCacheCommon::getCacheFilename(candidates[2].cache_key), cache_filename);
+
+	// The negative cache entries must be used next time.
+	cache.requests.clear();
+	EXPECT_EQ(2, cache.downloadFirst(candidates, 0, cache_filename));
+	for (const string &request : cache.requests) {
+		EXPECT_NE(candidates[0].cache_key, request);
+		EXPECT_NE(candidates[1].cache_key, request);
+	}
+
+	// The start index must be honored.
+	EXPECT_EQ(3, cache.downloadFirst(candidates, 3, cache_filename));
+	EXPECT_EQ(LibCacheCommon::getCacheFilename(candidates[3].cache_key), cache_filename);
+
+	// No candidates are available.
+	const vector<CacheManager::Candidate> missing = getCandidates("fallback-missing", 3);
+	EXPECT_EQ(-1, cache.downloadFirst(missing, 0, cache_filename));
+	EXPECT_TRUE(cache_filename.empty());
+}
+
+/**
+ * Candidates must be downloaded concurrently, up to the limit.
+ */
+TEST_F(CacheManagerTest, concurrency)
+{
+	FakeServerCacheManager cache;
+	const vector<CacheManager::Candidate> candidates = getCandidates("concurrency", 6);
+	for (const CacheManager::Candidate &candidate : candidates) {
+		cache.files[candidate.cache_key] = {50, false};
+	}
+
+	string cache_filename;
+	EXPECT_EQ(-1, cache.downloadFirst(candidates, 0, cache_filename));
+	EXPECT_EQ(candidates.size(), cache.requests.size());
+	EXPECT_EQ(static_cast<unsigned int>(CacheManager::MAX_SIMULTANEOUS_DOWNLOADS), cache.max_active);
+}
+
+/**
+ * Lower-priority candidates must not be started once
+ * a higher-priority candidate is available.
+ */
+TEST_F(CacheManagerTest, cancelRemaining)
+{
+	FakeServerCacheManager cache;
+	const vector<CacheManager::Candidate> candidates = getCandidates("cancelRemaining", 6);
+	cache.files[candidates[0].cache_key] = {0, true};
+	for (size_t i = 1; i < candidates.size(); i++) {
+		cache.files[candidates[i].cache_key] = {100, true};
+	}
+
+	string cache_filename;
+	EXPECT_EQ(0, cache.downloadFirst(candidates, 0, cache_filename));
+
+	// Only candidates that were started before candidate 0
+	// finished may have been requested.
+	EXPECT_LE(cache.requests.size(), static_cast<size_t>(CacheManager::MAX_SIMULTANEOUS_DOWNLOADS));
+}
+
+/**
+ * Candidates that aren't allowed to be downloaded
+ * must only be checked in the cache.
+ */
+TEST_F(CacheManagerTest, cacheOnly)
+{
+	FakeServerCacheManager cache;
+	vector<CacheManager::Candidate> candidates = getCandidates("cacheOnly", 2);
+	candidates[0].download = false;
+	cache.files[candidates[0].cache_key] = {0, true};
+	cache.files[candidates[1].cache_key] = {0, true};
+
+	string cache_filename;
+	EXPECT_EQ(1, cache.downloadFirst(candidates, 0, cache_filename));
+	ASSERT_EQ(1U, cache.requests.size());
+	EXPECT_EQ(candidates[1].cache_key, cache.requests[0]);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_main.inc.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: CacheManager tests.\n\n");
+	fflush(nullptr);
+
+	// Use a temporary directory for the cache and configuration.
+	// NOTE: This must be done before the cache directory is initialized.
+	char tmpl[] = "/tmp/CacheManagerTest.XXXXXX";
+	if (!mkdtemp(tmpl)) {
+		fprintf(stderr, "*** ERROR: Unable to create a temporary directory.\n");
+		return EXIT_FAILURE;
+	}
+	LibRomData::Tests::tmp_dir = tmpl;
+	setenv("XDG_CACHE_HOME", (LibRomData::Tests::tmp_dir + "/cache").c_str(), 1);
+	setenv("XDG_CONFIG_HOME", (LibRomData::Tests::tmp_dir + "/config").c_str(), 1);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	const int ret = RUN_ALL_TESTS();
+
+	// Remove the temporary directory.
+	const string cmd = "rm -rf '" + LibRomData::Tests::tmp_dir + '\'';
+	if (system(cmd.c_str()) != 0) {
+		fprintf(stderr, "*** WARNING: Unable to remove %s\n", LibRomData::Tests::tmp_dir.c_str());
+	}
+	return ret;
+}
@@ -42,6 +42,7 @@ using namespace LibRpFile;
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 #include "librptexture/decoder/ImageDecoder.hpp"
+#include "librptexture/fileformat/KhronosKTX2.hpp"
 using namespace LibRpTexture;
 
 // TODO: Separate out the actual DDS texture loader
@@ -65,11 +66,14 @@ using namespace LibRpTexture;
 #include <cstring>
 
 // C++ includes.
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 using std::string;
 using std::unique_ptr;
+using std::vector;
 
 // Uninitialized vector class.
 // Reference: http://andreoffringa.org/?q=uvector
@@ -944,6 +948,104 @@ INSTANTIATE_TEST_SUITE_P(KTX2, ImageDecoderTest,
 		KTX2_IMAGE_TEST("texturearray_etc2_unorm"))
 	, ImageDecoderTest::test_case_suffix_generator);
 
+// KTX2 supercompression tests.
+// These use the same reference images as the uncompressed KTX2 tests.
+#define KTX2_SUPERZ_IMAGE_TEST(file, superz) ImageDecoderTest_mode( \
+			"KTX2/" file "." superz ".ktx2.gz", \
+			"KTX2/" file ".png")
+INSTANTIATE_TEST_SUITE_P(KTX2_ZLIB, ImageDecoderTest,
+	::testing::Values(
+		KTX2_SUPERZ_IMAGE_TEST("rgba-reference-u", "zlib"))
+	, ImageDecoderTest::test_case_suffix_generator);
+#ifdef HAVE_ZSTD
+INSTANTIATE_TEST_SUITE_P(KTX2_ZSTD, ImageDecoderTest,
+	::testing::Values(
+		KTX2_SUPERZ_IMAGE_TEST("rgba-reference-u", "zstd"),
+		KTX2_SUPERZ_IMAGE_TEST("rgb-mipmap-reference-u", "zstd"),
+		KTX2_SUPERZ_IMAGE_TEST("texturearray_etc2_unorm", "zstd"))
+	, ImageDecoderTest::test_case_suffix_generator);
+#endif /* HAVE_ZSTD */
+
+/**
+ * Benchmark decoding each mipmap level of a KTX2 texture.
+ * @param filename KTX2 texture filename. (gzipped)
+ */
+static void KTX2_mipmapBenchmark(const char *filename)
+{
+	string path = "ImageDecoder_data/";
+	path += filename;
+	ImageDecoderTest::replace_slashes(path);
+
+	// Load the texture into memory.
+	gzFile gzKtx2 = gzopen(path.c_str(), "rb");
+	ASSERT_TRUE(gzKtx2 != nullptr) << "gzopen() failed to open the KTX2 file: " << filename;
+	ao::uvector<uint8_t> ktx2_buf;
+	uint8_t buf[4096];
+	while (!gzeof(gzKtx2)) {
+		const int sz_read = gzread(gzKtx2, buf, sizeof(buf));
+		if (sz_read <= 0)
+			break;
+		ktx2_buf.insert(ktx2_buf.end(), buf, buf + sz_read);
+	}
+	gzclose_r(gzKtx2);
+	ASSERT_FALSE(ktx2_buf.empty());
+
+	RpMemFile *const f_ktx2 = new RpMemFile(ktx2_buf.data(), ktx2_buf.size());
+	KhronosKTX2 *ktx2 = new KhronosKTX2(f_ktx2);
+	ASSERT_TRUE(ktx2->isValid());
+	const int mipmapCount = ktx2->mipmapCount();
+	ASSERT_GT(mipmapCount, 0);
+
+	// Determine which mipmap levels can be decoded.
+	// NOTE: Some formats can't be decoded at very small sizes.
+	vector<bool> decodable(mipmapCount);
+	for (int mip = 0; mip < mipmapCount; mip++) {
+		decodable[mip] = (ktx2->mipmap(mip) != nullptr);
+	}
+	ktx2->unref();
+	ASSERT_TRUE(decodable[0]) << "Could not decode mipmap 0";
+
+	// NOTE: Mipmaps are cached, so the texture
+	// has to be reopened for each iteration.
+	for (int mip = 0; mip < mipmapCount; mip++) {
+		if (!decodable[mip]) {
+			printf("%s: mipmap %d: not supported\n", filename, mip);
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (unsigned int i = ImageDecoderTest::BENCHMARK_ITERATIONS; i > 0; i--) {
+			ktx2 = new KhronosKTX2(f_ktx2);
+			const rp_image *const img = ktx2->mipmap(mip);
+			ktx2->unref();
+			ASSERT_TRUE(img != nullptr) << "Could not decode mipmap " << mip;
+		}
+		const auto end = std::chrono::steady_clock::now();
+		const double usec = std::chrono::duration<double, std::micro>(end - start).count();
+		printf("%s: mipmap %d: %.2f usec\n", filename, mip,
+			usec / ImageDecoderTest::BENCHMARK_ITERATIONS);
+	}
+	f_ktx2->unref();
+}
+
+/**
+ * Benchmark decoding each mipmap level of an uncompressed KTX2 texture.
+ */
+TEST(KTX2_MipmapTest, uncompressed_Benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(KTX2_mipmapBenchmark("KTX2/rgb-mipmap-reference-u.ktx2.gz"));
+}
+
+#ifdef HAVE_ZSTD
+/**
+ * Benchmark decoding each mipmap level of a Zstandard-supercompressed KTX2 texture.
+ */
+TEST(KTX2_MipmapTest, zstd_Benchmark)
+{
+	ASSERT_NO_FATAL_FAILURE(KTX2_mipmapBenchmark("KTX2/rgb-mipmap-reference-u.zstd.ktx2.gz"));
+}
+#endif /* HAVE_ZSTD */
+
 // Valve VTF tests. (all formats)
 INSTANTIATE_TEST_SUITE_P(VTF, ImageDecoderTest,
 	::testing::Values(
@@ -300,8 +300,39 @@ TEST_F(SuperMagicDriveTest, decodeBlock_sse2_benchmark)
 }
 #endif /* SMD_HAS_SSE2 */
 
+#ifdef SMD_HAS_AVX2
+/**
+ * Test the AVX2-optimized SMD decoder.
+ */
+TEST_F(SuperMagicDriveTest, decodeBlock_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	SuperMagicDrive::decodeBlock_avx2(align_buf, m_smd_data);
+	EXPECT_EQ(0, memcmp(m_bin_data, align_buf, SuperMagicDrive::SMD_BLOCK_SIZE));
+}
+
+/**
+ * Benchmark the AVX2-optimized SMD decoder.
+ */
+TEST_F(SuperMagicDriveTest, decodeBlock_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		SuperMagicDrive::decodeBlock_avx2(align_buf, m_smd_data);
+	}
+}
+#endif /* SMD_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(SMD_HAS_MMX) || defined(SMD_HAS_SSE2)
+#if defined(SMD_HAS_MMX) || defined(SMD_HAS_SSE2) || defined(SMD_HAS_AVX2)
 /**
  * Test the decodeBlock() dispatch function.
  */
@@ -320,7 +351,7 @@ TEST_F(SuperMagicDriveTest, decodeBlock_dispatch_benchmark)
 		SuperMagicDrive::decodeBlock(align_buf, m_smd_data);
 	}
 }
-#endif /* SMD_HAS_MMX || SMD_HAS_SSE2 */
+#endif /* SMD_HAS_MMX || SMD_HAS_SSE2 || SMD_HAS_AVX2 */
 
 } }
 
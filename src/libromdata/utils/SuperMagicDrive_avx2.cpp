@@ -0,0 +1,65 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * SuperMagicDrive_avx2.cpp: Super Magic Drive deinterleaving function.    *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "SuperMagicDrive.hpp"
+
+// C includes. (C++ namespace)
+#include <cassert>
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+namespace LibRomData {
+
+/**
+ * Decode a Super Magic Drive interleaved block.
+ * AVX2-optimized version.
+ * NOTE: Pointers must be 16-byte aligned.
+ * @param pDest	[out] Destination block. (Must be 16 KB.)
+ * @param pSrc	[in] Source block. (Must be 16 KB.)
+ */
+void SuperMagicDrive::decodeBlock_avx2(uint8_t *RESTRICT pDest, const uint8_t *RESTRICT pSrc)
+{
+	// NOTE: The buffers are only guaranteed to be 16-byte aligned,
+	// so unaligned loads and stores are used.
+	ASSERT_ALIGNMENT(16, pDest);
+	ASSERT_ALIGNMENT(16, pSrc);
+
+	// First 8 KB of the source block is ODD bytes.
+	// Second 8 KB of the source block is EVEN bytes.
+	const __m256i *pSrc_odd = reinterpret_cast<const __m256i*>(pSrc);
+	const __m256i *pSrc_even = reinterpret_cast<const __m256i*>(pSrc + (SMD_BLOCK_SIZE / 2));
+	const __m256i *const pDest_end = reinterpret_cast<const __m256i*>(pDest + SMD_BLOCK_SIZE);
+
+	// Process 128 bytes (1024 bits) at a time.
+	for (__m256i *p = reinterpret_cast<__m256i*>(pDest);
+	     p < pDest_end; p += 4, pSrc_odd += 2, pSrc_even += 2)
+	{
+		const __m256i even0 = _mm256_loadu_si256(&pSrc_even[0]);
+		const __m256i odd0  = _mm256_loadu_si256(&pSrc_odd[0]);
+		const __m256i even1 = _mm256_loadu_si256(&pSrc_even[1]);
+		const __m256i odd1  = _mm256_loadu_si256(&pSrc_odd[1]);
+
+		// Unpack odd/even bytes.
+		// vpunpck{l,h}bw operate within each 128-bit lane,
+		// so the lanes have to be recombined afterwards.
+		const __m256i lo0 = _mm256_unpacklo_epi8(even0, odd0);
+		const __m256i hi0 = _mm256_unpackhi_epi8(even0, odd0);
+		const __m256i lo1 = _mm256_unpacklo_epi8(even1, odd1);
+		const __m256i hi1 = _mm256_unpackhi_epi8(even1, odd1);
+
+		_mm256_storeu_si256(&p[0], _mm256_permute2x128_si256(lo0, hi0, 0x20));
+		_mm256_storeu_si256(&p[1], _mm256_permute2x128_si256(lo0, hi0, 0x31));
+		_mm256_storeu_si256(&p[2], _mm256_permute2x128_si256(lo1, hi1, 0x20));
+		_mm256_storeu_si256(&p[3], _mm256_permute2x128_si256(lo1, hi1, 0x31));
+	}
+}
+
+}
@@ -0,0 +1,387 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Profiler.cpp: Per-phase profiling for RomData subclasses.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Profiler.hpp"
+#include "monotonic_time.h"
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/pthread_once.h"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// C++ includes.
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <map>
+using std::array;
+using std::map;
+using std::ostream;
+using std::string;
+
+// rapidjson
+#include "rapidjson/document.h"
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/writer.h"
+using namespace rapidjson;
+
+namespace LibRpBase {
+
+#ifdef ENABLE_PROFILING
+// Environment variable used to enable profiling.
+static const char env_var_name[] = "RP_PROFILE";
+
+// Is profiling enabled?
+// NOTE: Set using ATOMIC_EXCHANGE().
+static volatile int profiling_enabled = 0;
+static pthread_once_t once_enabled = PTHREAD_ONCE_INIT;
+
+// Is allocation counting enabled?
+// NOTE: Set using ATOMIC_EXCHANGE().
+static volatile int alloc_counting_enabled = 0;
+
+// Allocation counters for the current thread.
+static RP_THREAD_LOCAL uint64_t tls_allocs = 0;
+static RP_THREAD_LOCAL uint64_t tls_allocBytes = 0;
+
+// Recorded statistics. (key == class name)
+typedef array<Profiler::Stats, static_cast<size_t>(Profiler::Phase::Max)> PhaseStats;
+static map<string, PhaseStats> stats_map;
+static Mutex stats_mutex;	// Protects stats_map.
+
+/**
+ * Initialize profiling_enabled from the environment.
+ * Internal function; must be called using pthread_once().
+ */
+static void initEnabledFromEnv(void)
+{
+	const char *const env = getenv(env_var_name);
+	if (env && env[0] != '\0' && strcmp(env, "0") != 0) {
+		ATOMIC_EXCHANGE(&profiling_enabled, 1);
+	}
+}
+
+/**
+ * Create a JSON object for a set of statistics.
+ * @param stats Statistics.
+ * @param allocator JSON allocator.
+ * @return JSON object.
+ */
+template<typename Allocator>
+static Value statsToValue(const Profiler::Stats &stats, Allocator &allocator)
+{
+	Value stats_obj(kObjectType);
+	stats_obj.AddMember("calls", stats.calls, allocator);
+	stats_obj.AddMember("time_us", stats.time_us, allocator);
+	stats_obj.AddMember("bytes_read", stats.bytes_read, allocator);
+	if (alloc_counting_enabled != 0) {
+		stats_obj.AddMember("allocs", stats.allocs, allocator);
+		stats_obj.AddMember("alloc_bytes", stats.alloc_bytes, allocator);
+	}
+	return stats_obj;
+}
+#endif /* ENABLE_PROFILING */
+
+/**
+ * Is profiling enabled?
+ * On first use, this is initialized from the RP_PROFILE
+ * environment variable.
+ * @return True if enabled; false if not.
+ */
+bool Profiler::isEnabled(void)
+{
+#ifdef ENABLE_PROFILING
+	pthread_once(&once_enabled, initEnabledFromEnv);
+	return (profiling_enabled != 0);
+#else /* !ENABLE_PROFILING */
+	return false;
+#endif /* ENABLE_PROFILING */
+}
+
+/**
+ * Enable or disable profiling.
+ * @param enabled True to enable; false to disable.
+ */
+void Profiler::setEnabled(bool enabled)
+{
+#ifdef ENABLE_PROFILING
+	// Make sure the environment doesn't override this later.
+	pthread_once(&once_enabled, initEnabledFromEnv);
+	ATOMIC_EXCHANGE(&profiling_enabled, (enabled ? 1 : 0));
+#else /* !ENABLE_PROFILING */
+	RP_UNUSED(enabled);
+#endif /* ENABLE_PROFILING */
+}
+
+/**
+ * Get the name of a phase.
+ * @param phase Phase.
+ * @return Name, or nullptr if invalid.
+ */
+const char *Profiler::phaseName(Phase phase)
+{
+	static const char *const phase_names[] = {
+		"detection", "fields", "metadata",
+		"image", "ext_urls", "icon_anim",
+	};
+	static_assert(ARRAY_SIZE(phase_names) == static_cast<size_t>(Phase::Max),
+		"phase_names[] is out of sync with Phase.");
+
+	assert(phase >= Phase::Detection && phase < Phase::Max);
+	if (phase < Phase::Detection || phase >= Phase::Max)
+		return nullptr;
+	return phase_names[static_cast<size_t>(phase)];
+}
+
+/**
+ * Clear all recorded statistics.
+ */
+void Profiler::reset(void)
+{
+#ifdef ENABLE_PROFILING
+	MutexLocker locker(stats_mutex);
+	stats_map.clear();
+#endif /* ENABLE_PROFILING */
+}
+
+/** Allocation counting **/
+
+/**
+ * Indicate that the executable counts allocations.
+ * @param enabled True if allocations are counted; false if not.
+ */
+void Profiler::setAllocCountingEnabled(bool enabled)
+{
+#ifdef ENABLE_PROFILING
+	ATOMIC_EXCHANGE(&alloc_counting_enabled, (enabled ? 1 : 0));
+#else /* !ENABLE_PROFILING */
+	RP_UNUSED(enabled);
+#endif /* ENABLE_PROFILING */
+}
+
+/**
+ * Are allocations being counted?
+ * @return True if allocations are counted; false if not.
+ */
+bool Profiler::isAllocCountingEnabled(void)
+{
+#ifdef ENABLE_PROFILING
+	return (alloc_counting_enabled != 0);
+#else /* !ENABLE_PROFILING */
+	return false;
+#endif /* ENABLE_PROFILING */
+}
+
+/**
+ * Count an allocation on the calling thread.
+ * @param size Allocation size.
+ */
+void Profiler::countAlloc(size_t size)
+{
+#ifdef ENABLE_PROFILING
+	// NOTE: This is called from operator new(),
+	// so it must not allocate memory.
+	tls_allocs++;
+	tls_allocBytes += size;
+#else /* !ENABLE_PROFILING */
+	RP_UNUSED(size);
+#endif /* ENABLE_PROFILING */
+}
+
+/** Reports **/
+
+/**
+ * Write a text report of all recorded statistics.
+ * @param os Output stream.
+ */
+void Profiler::writeReport(ostream &os)
+{
+#ifdef ENABLE_PROFILING
+	MutexLocker locker(stats_mutex);
+	const bool counting = (alloc_counting_enabled != 0);
+
+	char buf[160];
+	snprintf(buf, sizeof(buf), "%-24s %-10s %7s %12s %12s %10s %12s\n",
+		"Class", "Phase", "Calls", "Time (ms)", "Read (KiB)", "Allocs", "Alloc (KiB)");
+	os << buf;
+
+	Stats total;
+	memset(&total, 0, sizeof(total));
+	for (const auto &p : stats_map) {
+		for (size_t i = 0; i < p.second.size(); i++) {
+			const Stats &stats = p.second[i];
+			if (stats.calls == 0)
+				continue;
+
+			if (counting) {
+				snprintf(buf, sizeof(buf), "%-24s %-10s %7u %12.3f %12.1f %10llu %12.1f\n",
+					p.first.c_str(), phaseName(static_cast<Phase>(i)), stats.calls,
+					static_cast<double>(stats.time_us) / 1000.0,
+					static_cast<double>(stats.bytes_read) / 1024.0,
+					static_cast<unsigned long long>(stats.allocs), static_cast<double>(stats.alloc_bytes) / 1024.0);
+			} else {
+				snprintf(buf, sizeof(buf), "%-24s %-10s %7u %12.3f %12.1f %10s %12s\n",
+					p.first.c_str(), phaseName(static_cast<Phase>(i)), stats.calls,
+					static_cast<double>(stats.time_us) / 1000.0,
+					static_cast<double>(stats.bytes_read) / 1024.0,
+					"-", "-");
+			}
+			os << buf;
+
+			total.calls += stats.calls;
+			total.time_us += stats.time_us;
+			total.bytes_read += stats.bytes_read;
+			total.allocs += stats.allocs;
+			total.alloc_bytes += stats.alloc_bytes;
+		}
+	}
+
+	if (counting) {
+		snprintf(buf, sizeof(buf), "%-24s %-10s %7u %12.3f %12.1f %10llu %12.1f\n",
+			"Total", "", total.calls,
+			static_cast<double>(total.time_us) / 1000.0,
+			static_cast<double>(total.bytes_read) / 1024.0,
+			static_cast<unsigned long long>(total.allocs), static_cast<double>(total.alloc_bytes) / 1024.0);
+	} else {
+		snprintf(buf, sizeof(buf), "%-24s %-10s %7u %12.3f %12.1f %10s %12s\n",
+			"Total", "", total.calls,
+			static_cast<double>(total.time_us) / 1000.0,
+			static_cast<double>(total.bytes_read) / 1024.0,
+			"-", "-");
+	}
+	os << buf;
+#else /* !ENABLE_PROFILING */
+	os << "Profiling is not available in this build.\n";
+#endif /* ENABLE_PROFILING */
+}
+
+/**
+ * Write all recorded statistics as a single line of JSON.
+ * @param os Output stream.
+ * @param filename Filename to include in the output. (may be nullptr)
+ */
+void Profiler::writeJSON(ostream &os, const char *filename)
+{
+#ifdef ENABLE_PROFILING
+	Document document;
+	document.SetObject();
+	Document::AllocatorType& allocator = document.GetAllocator();
+
+	if (filename) {
+		Value filename_val;
+		filename_val.SetString(filename, allocator);
+		document.AddMember("file", filename_val, allocator);
+	}
+
+	Value classes_obj(kObjectType);
+	{
+		MutexLocker locker(stats_mutex);
+		for (const auto &p : stats_map) {
+			Value phases_obj(kObjectType);
+			for (size_t i = 0; i < p.second.size(); i++) {
+				const Stats &stats = p.second[i];
+				if (stats.calls == 0)
+					continue;
+				phases_obj.AddMember(StringRef(phaseName(static_cast<Phase>(i))),
+					statsToValue(stats, allocator), allocator);
+			}
+
+			Value className_val;
+			className_val.SetString(p.first.data(), static_cast<SizeType>(p.first.size()), allocator);
+			classes_obj.AddMember(className_val, phases_obj, allocator);
+		}
+	}
+	document.AddMember("classes", classes_obj, allocator);
+
+	OStreamWrapper oswr(os);
+	Writer<OStreamWrapper> writer(oswr);
+	document.Accept(writer);
+	os << '\n';
+	os.flush();
+#else /* !ENABLE_PROFILING */
+	RP_UNUSED(os);
+	RP_UNUSED(filename);
+#endif /* ENABLE_PROFILING */
+}
+
+/**
+ * Dump the recorded statistics if requested by the RP_PROFILE
+ * environment variable, then clear them.
+ *
+ * Intended for long-running processes, e.g. thumbnailers.
+ * - RP_PROFILE=1: Write JSON to stderr.
+ * - RP_PROFILE=/path/to/file: Append JSON to the specified file.
+ *
+ * @param filename Filename that was processed. (may be nullptr)
+ */
+void Profiler::dumpFromEnv(const char *filename)
+{
+#ifdef ENABLE_PROFILING
+	if (!isEnabled())
+		return;
+	const char *const env = getenv(env_var_name);
+	if (!env || env[0] == '\0' || !strcmp(env, "0"))
+		return;
+
+	if (!strcmp(env, "1")) {
+		writeJSON(std::cerr, filename);
+	} else {
+		std::ofstream ofs(env, std::ios::out | std::ios::app);
+		if (ofs.is_open()) {
+			writeJSON(ofs, filename);
+		}
+	}
+	reset();
+#else /* !ENABLE_PROFILING */
+	RP_UNUSED(filename);
+#endif /* ENABLE_PROFILING */
+}
+
+#ifdef ENABLE_PROFILING
+/** Profiler::Scope **/
+
+void Profiler::Scope::start(void)
+{
+	m_bytesRead = RpFile::threadBytesRead();
+	m_allocs = tls_allocs;
+	m_allocBytes = tls_allocBytes;
+	m_start = rp_monotonic_time_us();
+}
+
+void Profiler::Scope::finish(void)
+{
+	const uint64_t time_us = rp_monotonic_time_us() - m_start;
+	const uint64_t bytesRead = RpFile::threadBytesRead() - m_bytesRead;
+	const uint64_t allocs = tls_allocs - m_allocs;
+	const uint64_t allocBytes = tls_allocBytes - m_allocBytes;
+
+	MutexLocker locker(stats_mutex);
+	auto iter = stats_map.find(m_className ? m_className : "(unknown)");
+	if (iter == stats_map.end()) {
+		PhaseStats phaseStats;
+		memset(phaseStats.data(), 0, phaseStats.size() * sizeof(Stats));
+		iter = stats_map.emplace(m_className ? m_className : "(unknown)", phaseStats).first;
+	}
+
+	Stats &stats = iter->second[static_cast<size_t>(m_phase)];
+	stats.calls++;
+	stats.time_us += time_us;
+	stats.bytes_read += bytesRead;
+	stats.allocs += allocs;
+	stats.alloc_bytes += allocBytes;
+}
+#endif /* ENABLE_PROFILING */
+
+}
@@ -0,0 +1,223 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Profiler.hpp: Per-phase profiling for RomData subclasses.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_PROFILER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_PROFILER_HPP__
+
+#include "librpbase/config.librpbase.h"
+#include "common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ includes.
+#include <ostream>
+
+namespace LibRpBase {
+
+/**
+ * Per-phase profiler for RomData subclasses.
+ *
+ * Statistics are keyed by RomData class name and phase.
+ * Profiling is disabled at runtime by default. It can be enabled
+ * by calling setEnabled(), or by setting the RP_PROFILE
+ * environment variable.
+ *
+ * If ENABLE_PROFILING isn't defined, all functions are no-ops.
+ */
+class Profiler
+{
+	private:
+		// Profiler is a static class.
+		Profiler();
+		~Profiler();
+		RP_DISABLE_COPY(Profiler)
+
+	public:
+		// Profiled phases.
+		enum class Phase : uint8_t {
+			Detection	= 0,	// RomDataFactory::create()
+			Fields		= 1,	// RomData::fields()
+			MetaData	= 2,	// RomData::metaData()
+			InternalImage	= 3,	// RomData::image()
+			ExtURLs		= 4,	// RomData::extURLs()
+			IconAnimData	= 5,	// RomData::iconAnimData()
+
+			Max
+		};
+
+		// Statistics for a single class and phase.
+		struct Stats {
+			unsigned int calls;	// Number of calls
+			uint64_t time_us;	// Total time, in microseconds
+			uint64_t bytes_read;	// Bytes read from RpFile
+			uint64_t allocs;	// Number of allocations (if counting is enabled)
+			uint64_t alloc_bytes;	// Bytes allocated (if counting is enabled)
+		};
+
+		/**
+		 * Is profiling enabled?
+		 * On first use, this is initialized from the RP_PROFILE
+		 * environment variable.
+		 * @return True if enabled; false if not.
+		 */
+		static bool isEnabled(void);
+
+		/**
+		 * Enable or disable profiling.
+		 * @param enabled True to enable; false to disable.
+		 */
+		static void setEnabled(bool enabled);
+
+		/**
+		 * Get the name of a phase.
+		 * @param phase Phase.
+		 * @return Name, or nullptr if invalid.
+		 */
+		static const char *phaseName(Phase phase);
+
+		/**
+		 * Clear all recorded statistics.
+		 */
+		static void reset(void);
+
+	public:
+		/** Allocation counting **/
+
+		/**
+		 * Allocation counting requires a replacement operator new(),
+		 * which can only be done in executables, e.g. rpcli.
+		 * The replacement must call countAlloc() for each allocation.
+		 */
+
+		/**
+		 * Indicate that the executable counts allocations.
+		 * @param enabled True if allocations are counted; false if not.
+		 */
+		static void setAllocCountingEnabled(bool enabled);
+
+		/**
+		 * Are allocations being counted?
+		 * @return True if allocations are counted; false if not.
+		 */
+		static bool isAllocCountingEnabled(void);
+
+		/**
+		 * Count an allocation on the calling thread.
+		 * @param size Allocation size.
+		 */
+		static void countAlloc(size_t size);
+
+	public:
+		/** Reports **/
+
+		/**
+		 * Write a text report of all recorded statistics.
+		 * @param os Output stream.
+		 */
+		static void writeReport(std::ostream &os);
+
+		/**
+		 * Write all recorded statistics as a single line of JSON.
+		 * @param os Output stream.
+		 * @param filename Filename to include in the output. (may be nullptr)
+		 */
+		static void writeJSON(std::ostream &os, const char *filename);
+
+		/**
+		 * Dump the recorded statistics if requested by the RP_PROFILE
+		 * environment variable, then clear them.
+		 *
+		 * Intended for long-running processes, e.g. thumbnailers.
+		 * - RP_PROFILE=1: Write JSON to stderr.
+		 * - RP_PROFILE=/path/to/file: Append JSON to the specified file.
+		 *
+		 * @param filename Filename that was processed. (may be nullptr)
+		 */
+		static void dumpFromEnv(const char *filename);
+
+	public:
+		/**
+		 * Scoped timer for a class and phase.
+		 * Time, bytes read, and allocations are recorded
+		 * when the Scope is destroyed.
+		 */
+		class Scope
+		{
+			public:
+				/**
+				 * Start a profiling scope.
+				 * @param className RomData class name. (may be nullptr if not known yet)
+				 * @param phase Phase.
+				 */
+				Scope(const char *className, Phase phase)
+#ifdef ENABLE_PROFILING
+					: m_className(className)
+					, m_phase(phase)
+					, m_active(isEnabled())
+				{
+					if (m_active) {
+						start();
+					}
+				}
+#else /* !ENABLE_PROFILING */
+				{
+					RP_UNUSED(className);
+					RP_UNUSED(phase);
+				}
+#endif /* ENABLE_PROFILING */
+
+#ifdef ENABLE_PROFILING
+				~Scope()
+				{
+					if (m_active) {
+						finish();
+					}
+				}
+#endif /* ENABLE_PROFILING */
+
+			private:
+				RP_DISABLE_COPY(Scope)
+
+			public:
+				/**
+				 * Set the class name.
+				 * Used if the class name isn't known when the scope starts,
+				 * e.g. RomDataFactory::create().
+				 * @param className RomData class name.
+				 */
+				inline void setClassName(const char *className)
+				{
+#ifdef ENABLE_PROFILING
+					m_className = className;
+#else /* !ENABLE_PROFILING */
+					RP_UNUSED(className);
+#endif /* ENABLE_PROFILING */
+				}
+
+#ifdef ENABLE_PROFILING
+			private:
+				void start(void);
+				void finish(void);
+
+			private:
+				const char *m_className;
+				uint64_t m_start;	// Start time, in microseconds
+				uint64_t m_bytesRead;
+				uint64_t m_allocs;
+				uint64_t m_allocBytes;
+				Phase m_phase;
+				bool m_active;
+#endif /* ENABLE_PROFILING */
+		};
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_PROFILER_HPP__ */
@@ -9,6 +9,7 @@
 #include "stdafx.h"
 #include "RomData.hpp"
 #include "RomData_p.hpp"
+#include "Profiler.hpp"
 
 #include "libi18n/i18n.h"
 
@@ -39,6 +40,7 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	: q_ptr(q)
 	, isValid(false)
 	, isCompressed(false)
+	, metaDataOnly(false)
 	, file(nullptr)
 	, fields(new RomFields())
 	, metaData(nullptr)
@@ -68,6 +70,50 @@ RomDataPrivate::~RomDataPrivate()
 
 /** Convenience functions. **/
 
+/**
+ * Read data from the file, using the DetectInfo header buffer if possible.
+ *
+ * RomDataFactory already has the first few KB of the file (or the
+ * data at a subclass-specific address) in memory when it creates
+ * a RomData subclass. If the requested range is entirely within
+ * that buffer, it's copied from the buffer; otherwise, it's read
+ * from the file.
+ *
+ * NOTE: The file position is *not* updated if the data was
+ * copied from the buffer. Use absolute reads afterwards.
+ *
+ * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+ * @param addr Address.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RomDataPrivate::seekAndReadHeader(const RomData::DetectInfo *detectInfo, off64_t addr, void *ptr, size_t size)
+{
+	if (detectInfo && detectInfo->header.pData &&
+	    addr >= static_cast<off64_t>(detectInfo->header.addr))
+	{
+		const off64_t hdr_end = static_cast<off64_t>(detectInfo->header.addr) + detectInfo->header.size;
+		if (addr + static_cast<off64_t>(size) <= hdr_end) {
+			// Requested range is within the header buffer.
+			memcpy(ptr, &detectInfo->header.pData[addr - detectInfo->header.addr], size);
+			return size;
+		} else if (addr <= hdr_end && detectInfo->szFile > 0 && hdr_end >= detectInfo->szFile) {
+			// Header buffer contains everything up to EOF,
+			// so reading from the file would result in a short read.
+			const size_t copy_len = static_cast<size_t>(hdr_end - addr);
+			memcpy(ptr, &detectInfo->header.pData[addr - detectInfo->header.addr], copy_len);
+			return copy_len;
+		}
+	}
+
+	// Read the data from the file.
+	assert(file != nullptr);
+	if (!file)
+		return 0;
+	return file->seekAndRead(addr, ptr, size);
+}
+
 /**
  * Get the GameTDB URL for a given game.
  * @param system System name.
@@ -557,6 +603,32 @@ bool RomData::isCompressed(void) const
 	return d->isCompressed;
 }
 
+/**
+ * Enable metadata-only mode.
+ *
+ * This is intended for metadata extractors, e.g. KDE's Baloo,
+ * which only call metaData(). Subclasses may skip loading data
+ * that's only needed for fields and images.
+ *
+ * In metadata-only mode, fields() and image() return nullptr.
+ * Once enabled, metadata-only mode cannot be disabled.
+ */
+void RomData::setMetaDataOnly(void)
+{
+	RP_D(RomData);
+	d->metaDataOnly = true;
+}
+
+/**
+ * Is metadata-only mode enabled?
+ * @return True if enabled; false if not.
+ */
+bool RomData::isMetaDataOnly(void) const
+{
+	RP_D(const RomData);
+	return d->metaDataOnly;
+}
+
 /**
  * Get the class name for the user configuration.
  * @return Class name. (ASCII) (nullptr on error)
@@ -766,8 +838,14 @@ const RomFields *RomData::fields(void) const
 {
 	RP_D(const RomData);
 	if (d->fields->empty()) {
+		if (d->metaDataOnly) {
+			// Fields are not available in metadata-only mode.
+			return nullptr;
+		}
+
 		// Data has not been loaded.
 		// Load it now.
+		Profiler::Scope profScope(className(), Profiler::Phase::Fields);
 		int ret = const_cast<RomData*>(this)->loadFieldData();
 		if (ret < 0)
 			return nullptr;
@@ -785,6 +863,7 @@ const RomMetaData *RomData::metaData(void) const
 	if (!d->metaData || d->metaData->empty()) {
 		// Data has not been loaded.
 		// Load it now.
+		Profiler::Scope profScope(className(), Profiler::Phase::MetaData);
 		int ret = const_cast<RomData*>(this)->loadMetaData();
 		if (ret < 0)
 			return nullptr;
@@ -808,6 +887,11 @@ const rp_image *RomData::image(ImageType imageType) const
 		// ImageType is out of range.
 		return nullptr;
 	}
+	RP_D(const RomData);
+	if (d->metaDataOnly) {
+		// Images are not available in metadata-only mode.
+		return nullptr;
+	}
 	// TODO: Check supportedImageTypes()?
 
 	// Load the internal image.
@@ -819,7 +903,11 @@ const rp_image *RomData::image(ImageType imageType) const
 #else /* !_DEBUG */
 	const rp_image *img;
 #endif
-	int ret = const_cast<RomData*>(this)->loadInternalImage(imageType, &img);
+	int ret;
+	{
+		Profiler::Scope profScope(className(), Profiler::Phase::InternalImage);
+		ret = const_cast<RomData*>(this)->loadInternalImage(imageType, &img);
+	}
 
 	// SANITY CHECK: If loadInternalImage() returns 0,
 	// img *must* be valid. Otherwise, it must be nullptr.
@@ -124,6 +124,24 @@ class RomData : public RefBase
 		 */
 		bool isCompressed(void) const;
 
+		/**
+		 * Enable metadata-only mode.
+		 *
+		 * This is intended for metadata extractors, e.g. KDE's Baloo,
+		 * which only call metaData(). Subclasses may skip loading data
+		 * that's only needed for fields and images.
+		 *
+		 * In metadata-only mode, fields() and image() return nullptr.
+		 * Once enabled, metadata-only mode cannot be disabled.
+		 */
+		void setMetaDataOnly(void);
+
+		/**
+		 * Is metadata-only mode enabled?
+		 * @return True if enabled; false if not.
+		 */
+		bool isMetaDataOnly(void) const;
+
 	public:
 		/** ROM detection functions. **/
 
@@ -256,6 +256,24 @@ class klass final : public LibRpBase::RomData { \
 		 */ \
 		bool hasDangerousPermissions(void) const final;
 
+/**
+ * RomData subclass function declaration for a light-weight
+ * "dangerous" permissions probe.
+ * RomDataFactory::hasDangerousPermissions() uses this instead of
+ * constructing the subclass if it's available.
+ */
+#define ROMDATA_DECL_DANGEROUS_STATIC() \
+	public: \
+		/** \
+		 * Does a ROM image have "dangerous" permissions? \
+		 * This only reads the data needed to make the decision. \
+		 * \
+		 * @param file Open ROM image. \
+		 * @param info DetectInfo that was accepted by isRomSupported_static(). \
+		 * @return 1 if "dangerous"; 0 if not; negative POSIX error code on error. \
+		 */ \
+		static int hasDangerousPermissions_static(LibRpFile::IRpFile *file, const DetectInfo *info);
+
 /**
  * RomData subclass function declaration for indicating ROM operations are possible.
  */
@@ -300,6 +318,22 @@ class klass final : public LibRpBase::RomData { \
 		 */ \
 		void close(void) final;
 
+/**
+ * RomData subclass constructor that takes a DetectInfo.
+ * RomDataFactory uses this constructor if it's available,
+ * which allows the subclass to read its header from the
+ * detection buffer instead of the file.
+ * @param klass Class name.
+ */
+#define ROMDATA_DECL_CTOR_DETECTINFO(klass) \
+	public: \
+		/** \
+		 * Read a ROM image using the RomDataFactory detection buffer. \
+		 * @param file Open ROM image. \
+		 * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr) \
+		 */ \
+		klass(LibRpFile::IRpFile *file, const DetectInfo *detectInfo);
+
 /**
  * End of RomData subclass declaration.
  */
@@ -55,6 +55,7 @@ class RomDataPrivate
 	public:
 		bool isValid;			// Subclass must set this to true if the ROM is valid.
 		bool isCompressed;		// True if the file is compressed. (transparent decompression)
+		bool metaDataOnly;		// True if only metadata is needed. (See RomData::setMetaDataOnly().)
 		LibRpFile::IRpFile *file;	// Open file.
 		std::string filename;		// Copy of the filename.
 		RomFields *const fields;	// ROM fields. (NOTE: allocated by the base class)
@@ -69,6 +70,26 @@ class RomDataPrivate
 	public:
 		/** Convenience functions. **/
 
+		/**
+		 * Read data from the file, using the DetectInfo header buffer if possible.
+		 *
+		 * RomDataFactory already has the first few KB of the file (or the
+		 * data at a subclass-specific address) in memory when it creates
+		 * a RomData subclass. If the requested range is entirely within
+		 * that buffer, it's copied from the buffer; otherwise, it's read
+		 * from the file.
+		 *
+		 * NOTE: The file position is *not* updated if the data was
+		 * copied from the buffer. Use absolute reads afterwards.
+		 *
+		 * @param detectInfo DetectInfo from RomDataFactory. (may be nullptr)
+		 * @param addr Address.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t seekAndReadHeader(const RomData::DetectInfo *detectInfo, off64_t addr, void *ptr, size_t size);
+
 		/**
 		 * Get the GameTDB URL for a given game.
 		 * @param system System name.
@@ -17,6 +17,10 @@
 #include <string>
 #include <ostream>
 
+namespace LibRpFile {
+	class TracingFile;
+}
+
 namespace LibRpBase {
 
 class RomData;
@@ -54,6 +58,19 @@ public:
 	}
 };
 
+/**
+ * I/O trace output.
+ * The trace is written as a single line of JSON,
+ * so multiple traces can be written to the same stream.
+ */
+class JSONIoTraceOutput {
+	const LibRpFile::TracingFile *const trace;
+	const char *const filename;
+public:
+	JSONIoTraceOutput(const LibRpFile::TracingFile *trace, const char *filename);
+	friend std::ostream& operator<<(std::ostream& os, const JSONIoTraceOutput& fo);
+};
+
 }
 
 #endif /* __ROMPROPERTIES_LIBRPBASE_TEXTOUT_HPP__ */
@@ -25,6 +25,10 @@ using std::vector;
 #include "TextFuncs.hpp"
 #include "img/IconAnimData.hpp"
 
+// librpfile
+#include "librpfile/TracingFile.hpp"
+using LibRpFile::TracingFile;
+
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 using LibRpTexture::rp_image;
@@ -33,6 +37,7 @@ using LibRpTexture::rp_image;
 #include "rapidjson/document.h"
 #include "rapidjson/ostreamwrapper.h"
 #include "rapidjson/prettywriter.h"
+#include "rapidjson/writer.h"
 using namespace rapidjson;
 
 namespace LibRpBase {
@@ -471,4 +476,91 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 	return os;
 }
 
+/**
+ * Convert I/O trace statistics to a JSON object.
+ * @param stats Statistics.
+ * @param allocator Allocator.
+ * @return JSON object.
+ */
+template<typename Allocator>
+static Value ioStatsToValue(const TracingFile::Stats &stats, Allocator &allocator)
+{
+	Value stats_obj(kObjectType);
+	stats_obj.AddMember("reads", stats.reads, allocator);
+	stats_obj.AddMember("seeks", stats.seeks, allocator);
+	stats_obj.AddMember("small_reads", stats.small_reads, allocator);
+	stats_obj.AddMember("bytes_read", stats.bytes_read, allocator);
+	stats_obj.AddMember("reread_bytes", stats.reread_bytes, allocator);
+	stats_obj.AddMember("io_time_us", stats.io_time, allocator);
+	return stats_obj;
+}
+
+JSONIoTraceOutput::JSONIoTraceOutput(const TracingFile *trace, const char *filename)
+	: trace(trace), filename(filename) { }
+
+std::ostream& operator<<(std::ostream& os, const JSONIoTraceOutput& fo)
+{
+	static const char *const op_names[] = {"read", "seek", "size"};
+
+	const TracingFile *const trace = fo.trace;
+	assert(trace != nullptr);
+
+	Document document;
+	document.SetObject();
+	Document::AllocatorType& allocator = document.GetAllocator();
+
+	if (fo.filename) {
+		Value filename_val;
+		filename_val.SetString(fo.filename, allocator);
+		document.AddMember("file", filename_val, allocator);
+	}
+	document.AddMember("elapsed_us", trace->elapsed(), allocator);
+	document.AddMember("small_read_size", TracingFile::SMALL_READ_SIZE, allocator);
+
+	// Summary for the entire file.
+	Value summary_obj = ioStatsToValue(trace->totalStats(), allocator);
+	summary_obj.AddMember("unique_bytes", trace->uniqueBytes(), allocator);
+	document.AddMember("summary", summary_obj, allocator);
+
+	// Per-phase statistics.
+	Value phases_obj(kObjectType);
+	for (uint8_t i = 0; i < static_cast<uint8_t>(TracingFile::Phase::Max); i++) {
+		const TracingFile::Phase phase = static_cast<TracingFile::Phase>(i);
+		phases_obj.AddMember(StringRef(TracingFile::phaseName(phase)),
+			ioStatsToValue(trace->stats(phase), allocator), allocator);
+	}
+	document.AddMember("phases", phases_obj, allocator);
+
+	// Individual operations.
+	Value ops_array(kArrayType);
+	for (const TracingFile::Op &op : trace->ops()) {
+		Value op_obj(kObjectType);
+		op_obj.AddMember("t", op.timestamp, allocator);
+		op_obj.AddMember("dur", op.duration, allocator);
+		op_obj.AddMember("phase", StringRef(TracingFile::phaseName(op.phase)), allocator);
+		op_obj.AddMember("op", StringRef(op_names[static_cast<size_t>(op.type)]), allocator);
+		op_obj.AddMember("offset", static_cast<int64_t>(op.offset), allocator);
+		if (op.type == TracingFile::OpType::Read) {
+			op_obj.AddMember("size", op.size, allocator);
+			op_obj.AddMember("result", op.result, allocator);
+			if (op.reread != 0) {
+				op_obj.AddMember("reread", op.reread, allocator);
+			}
+		}
+		ops_array.PushBack(op_obj, allocator);
+	}
+	document.AddMember("ops", ops_array, allocator);
+	if (trace->opsTruncated()) {
+		document.AddMember("ops_truncated", true, allocator);
+	}
+
+	OStreamWrapper oswr(os);
+	Writer<OStreamWrapper> writer(oswr);
+	document.Accept(writer);
+
+	os << '\n';
+	os.flush();
+	return os;
+}
+
 }
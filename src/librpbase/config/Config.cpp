@@ -81,15 +81,23 @@ class ConfigPrivate : public ConfReaderPrivate
 		bool extImgDownloadEnabled;
 		bool useIntIconForSmallSizes;
 		bool downloadHighResScans;
+		bool parallelDownloads;
+		bool persistentDownloader;
 		bool storeFileOriginInfo;
 		uint32_t palLanguageForGameTDB;
 
+		// Download cache limits. (0 == unlimited)
+		uint32_t cacheMaxSizeMB;
+		uint32_t cacheMaxEntries;
+
 		// DMG title screen mode. [index is ROM type]
 		Config::DMG_TitleScreen_Mode dmgTSMode[Config::DMG_TitleScreen_Mode::DMG_TS_MAX];
 
 		// Other options.
 		bool showDangerousPermissionsOverlayIcon;
 		bool enableThumbnailOnNetworkFS;
+		PngProfile thumbnailPngProfile;
+		bool cacheDecompressedExeData;
 };
 
 /** ConfigPrivate **/
@@ -123,12 +131,20 @@ ConfigPrivate::ConfigPrivate()
 	, extImgDownloadEnabled(true)
 	, useIntIconForSmallSizes(true)
 	, downloadHighResScans(true)
+	, parallelDownloads(true)
+	, persistentDownloader(false)
 	, storeFileOriginInfo(true)
 	, palLanguageForGameTDB('en')
+	, cacheMaxSizeMB(Config::DEFAULT_CACHE_MAX_SIZE_MB)
+	, cacheMaxEntries(Config::DEFAULT_CACHE_MAX_ENTRIES)
 	/* Overlay icon */
 	, showDangerousPermissionsOverlayIcon(true)
 	/* Enable thumbnailing and metadata on network FS */
 	, enableThumbnailOnNetworkFS(false)
+	/* PNG compression profile for thumbnails */
+	, thumbnailPngProfile(PngProfile::Fast)
+	/* Cache decompressed executable data */
+	, cacheDecompressedExeData(true)
 {
 	// NOTE: Configuration is also initialized in the reset() function.
 	memset(dmgTSMode, 0, sizeof(dmgTSMode));
@@ -154,7 +170,11 @@ void ConfigPrivate::reset(void)
 	extImgDownloadEnabled = true;
 	useIntIconForSmallSizes = true;
 	downloadHighResScans = true;
+	parallelDownloads = true;
+	persistentDownloader = false;
 	storeFileOriginInfo = true;
+	cacheMaxSizeMB = Config::DEFAULT_CACHE_MAX_SIZE_MB;
+	cacheMaxEntries = Config::DEFAULT_CACHE_MAX_ENTRIES;
 
 	// DMG title screen mode.
 	dmgTSMode[Config::DMG_TitleScreen_Mode::DMG_TS_DMG] = Config::DMG_TitleScreen_Mode::DMG_TS_DMG;
@@ -165,6 +185,10 @@ void ConfigPrivate::reset(void)
 	showDangerousPermissionsOverlayIcon = true;
 	// Enable thumbnail and metadata on network FS
 	enableThumbnailOnNetworkFS = false;
+	// PNG compression profile for thumbnails
+	thumbnailPngProfile = PngProfile::Fast;
+	// Cache decompressed executable data
+	cacheDecompressedExeData = true;
 }
 
 /**
@@ -199,6 +223,10 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			param = &useIntIconForSmallSizes;
 		} else if (!strcasecmp(name, "DownloadHighResScans")) {
 			param = &downloadHighResScans;
+		} else if (!strcasecmp(name, "ParallelDownloads")) {
+			param = &parallelDownloads;
+		} else if (!strcasecmp(name, "PersistentDownloader")) {
+			param = &persistentDownloader;
 		} else if (!strcasecmp(name, "StoreFileOriginInfo")) {
 			param = &storeFileOriginInfo;
 		} else if (!strcasecmp(name, "PalLanguageForGameTDB")) {
@@ -211,6 +239,18 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 				palLanguageForGameTDB |= TOLOWER(*value);
 			}
 			return 1;
+		} else if (!strcasecmp(name, "CacheMaxSize") || !strcasecmp(name, "CacheMaxEntries")) {
+			// Download cache limits. (0 == unlimited)
+			char *endptr = nullptr;
+			const unsigned long ulTmp = strtoul(value, &endptr, 10);
+			if (*endptr == '\0' && ulTmp <= 0xFFFFFFFFUL) {
+				if (!strcasecmp(name, "CacheMaxSize")) {
+					cacheMaxSizeMB = static_cast<uint32_t>(ulTmp);
+				} else {
+					cacheMaxEntries = static_cast<uint32_t>(ulTmp);
+				}
+			}
+			return 1;
 		} else {
 			// Invalid option.
 			return 1;
@@ -257,10 +297,24 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 	} else if (!strcasecmp(section, "Options")) {
 		// Options.
 		bool *param;
-		if (!strcasecmp(name, "ShowDangerousPermissionsOverlayIcon")) {
+		if (!strcasecmp(name, "ThumbnailPngProfile")) {
+			// PNG compression profile for thumbnails.
+			if (!strcasecmp(value, "Normal")) {
+				thumbnailPngProfile = PngProfile::Normal;
+			} else if (!strcasecmp(value, "Fast")) {
+				thumbnailPngProfile = PngProfile::Fast;
+			} else if (!strcasecmp(value, "Small")) {
+				thumbnailPngProfile = PngProfile::Small;
+			} else {
+				// TODO: Show a warning or something?
+			}
+			return 1;
+		} else if (!strcasecmp(name, "ShowDangerousPermissionsOverlayIcon")) {
 			param = &showDangerousPermissionsOverlayIcon;
 		} else if (!strcasecmp(name, "EnableThumbnailOnNetworkFS")) {
 			param = &enableThumbnailOnNetworkFS;
+		} else if (!strcasecmp(name, "CacheDecompressedExeData")) {
+			param = &cacheDecompressedExeData;
 		} else {
 			// Invalid option.
 			return 1;
@@ -559,6 +613,28 @@ bool Config::downloadHighResScans(void) const
 	return d->downloadHighResScans;
 }
 
+/**
+ * Download candidate images concurrently?
+ * NOTE: Call load() before using this function.
+ * @return True if we should; false if not.
+ */
+bool Config::parallelDownloads(void) const
+{
+	RP_D(const Config);
+	return d->parallelDownloads;
+}
+
+/**
+ * Use a persistent rp-download process for downloads?
+ * NOTE: Call load() before using this function.
+ * @return True if we should; false if not.
+ */
+bool Config::persistentDownloader(void) const
+{
+	RP_D(const Config);
+	return d->persistentDownloader;
+}
+
 /**
  * Store file origin information?
  * NOTE: Call load() before using this function.
@@ -580,6 +656,29 @@ uint32_t Config::palLanguageForGameTDB(void) const
 	return d->palLanguageForGameTDB;
 }
 
+/**
+ * Maximum size of the download cache, in MiB.
+ * NOTE: Call load() before using this function.
+ * @return Maximum size of the download cache, in MiB. (0 == unlimited)
+ */
+uint32_t Config::cacheMaxSizeMB(void) const
+{
+	RP_D(const Config);
+	return d->cacheMaxSizeMB;
+}
+
+/**
+ * Maximum number of files in the download cache.
+ * This includes negative cache entries.
+ * NOTE: Call load() before using this function.
+ * @return Maximum number of files in the download cache. (0 == unlimited)
+ */
+uint32_t Config::cacheMaxEntries(void) const
+{
+	RP_D(const Config);
+	return d->cacheMaxEntries;
+}
+
 /** DMG title screen mode **/
 
 /**
@@ -626,4 +725,26 @@ bool Config::enableThumbnailOnNetworkFS(void) const
 	return d->enableThumbnailOnNetworkFS;
 }
 
+/**
+ * Get the PNG compression profile for thumbnails.
+ * NOTE: Call load() before using this function.
+ * @return PNG compression profile.
+ */
+PngProfile Config::thumbnailPngProfile(void) const
+{
+	RP_D(const Config);
+	return d->thumbnailPngProfile;
+}
+
+/**
+ * Cache data extracted from compressed executables?
+ * NOTE: Call load() before using this function.
+ * @return True if we should; false if not.
+ */
+bool Config::cacheDecompressedExeData(void) const
+{
+	RP_D(const Config);
+	return d->cacheDecompressedExeData;
+}
+
 }
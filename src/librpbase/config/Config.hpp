@@ -10,6 +10,7 @@
 #define __ROMPROPERTIES_LIBRPBASE_CONFIG_CONFIG_HPP__
 
 #include "ConfReader.hpp"
+#include "../img/PngProfile.hpp"
 
 // C includes.
 #include <stdint.h>
@@ -108,6 +109,20 @@ class Config : public ConfReader
 		 */
 		bool downloadHighResScans(void) const;
 
+		/**
+		 * Download candidate images concurrently?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should; false if not.
+		 */
+		bool parallelDownloads(void) const;
+
+		/**
+		 * Use a persistent rp-download process for downloads?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should; false if not.
+		 */
+		bool persistentDownloader(void) const;
+
 		/**
 		 * Store file origin information?
 		 * NOTE: Call load() before using this function.
@@ -121,6 +136,25 @@ class Config : public ConfReader
 		 */
 		uint32_t palLanguageForGameTDB(void) const;
 
+		// Default download cache limits.
+		static const uint32_t DEFAULT_CACHE_MAX_SIZE_MB = 512;
+		static const uint32_t DEFAULT_CACHE_MAX_ENTRIES = 32768;
+
+		/**
+		 * Maximum size of the download cache, in MiB.
+		 * NOTE: Call load() before using this function.
+		 * @return Maximum size of the download cache, in MiB. (0 == unlimited)
+		 */
+		uint32_t cacheMaxSizeMB(void) const;
+
+		/**
+		 * Maximum number of files in the download cache.
+		 * This includes negative cache entries.
+		 * NOTE: Call load() before using this function.
+		 * @return Maximum number of files in the download cache. (0 == unlimited)
+		 */
+		uint32_t cacheMaxEntries(void) const;
+
 		/** DMG title screen mode **/
 
 		enum DMG_TitleScreen_Mode : uint8_t {
@@ -153,6 +187,20 @@ class Config : public ConfReader
 		 * @return True if we should enable; false if not.
 		 */
 		bool enableThumbnailOnNetworkFS(void) const;
+
+		/**
+		 * Get the PNG compression profile for thumbnails.
+		 * NOTE: Call load() before using this function.
+		 * @return PNG compression profile.
+		 */
+		PngProfile thumbnailPngProfile(void) const;
+
+		/**
+		 * Cache data extracted from compressed executables?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should; false if not.
+		 */
+		bool cacheDecompressedExeData(void) const;
 };
 
 }
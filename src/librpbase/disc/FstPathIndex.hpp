@@ -0,0 +1,198 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * FstPathIndex.hpp: Hashed path index for file system tables.             *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_DISC_FSTPATHINDEX_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_DISC_FSTPATHINDEX_HPP__
+
+#include "librpbase/config.librpbase.h"
+#include "common.h"
+
+// C includes.
+#include <stddef.h>
+#include <string.h>
+
+// C++ includes.
+#include <string>
+#include <unordered_map>
+
+namespace LibRpBase {
+
+/**
+ * Hashed path index for file system tables.
+ *
+ * Maps normalized paths to a filesystem-specific value,
+ * e.g. an FST entry index or a directory entry pointer.
+ * The index is filled in by the file system class, usually
+ * the first time a path is looked up.
+ *
+ * Path keys are normalized as follows:
+ * - Leading, trailing, and duplicate slashes are removed.
+ * - Backslashes are treated as slashes.
+ * - If case folding is enabled, ASCII letters are converted to
+ *   lowercase. Other bytes are never modified, so keys can be
+ *   in any ASCII-compatible encoding.
+ * - The root directory is an empty string.
+ *
+ * @tparam T Value type.
+ */
+template<typename T>
+class FstPathIndex
+{
+	public:
+		FstPathIndex() { }
+
+	private:
+		RP_DISABLE_COPY(FstPathIndex)
+
+	public:
+		/**
+		 * Convert an ASCII character to lowercase.
+		 * Non-ASCII characters are not modified.
+		 * @param chr Character.
+		 * @return Lowercase character.
+		 */
+		static inline char foldChar(char chr)
+		{
+			return (chr >= 'A' && chr <= 'Z') ? (chr | 0x20) : chr;
+		}
+
+		/**
+		 * Append a single path component to an index key.
+		 * The component must not contain any slashes.
+		 * @param key		[in/out] Index key.
+		 * @param name		[in] Path component.
+		 * @param len		[in] Length of name.
+		 * @param caseFold	[in] If true, convert ASCII letters to lowercase.
+		 */
+		static void appendName(std::string &key, const char *name, size_t len, bool caseFold = true)
+		{
+			if (!key.empty()) {
+				key += '/';
+			}
+			const size_t pos = key.size();
+			key.append(name, len);
+			if (!caseFold)
+				return;
+			for (auto iter = key.begin() + pos; iter != key.end(); ++iter) {
+				*iter = foldChar(*iter);
+			}
+		}
+
+		/**
+		 * Normalize a path for use as an index key.
+		 * @param path Path.
+		 * @param caseFold If true, convert ASCII letters to lowercase.
+		 * @return Index key.
+		 */
+		static std::string normalize(const char *path, bool caseFold = true)
+		{
+			std::string key;
+			if (!path) {
+				return key;
+			}
+
+			key.reserve(strlen(path));
+			for (const char *p = path; *p != '\0'; p++) {
+				char chr = *p;
+				if (chr == '/' || chr == '\\') {
+					// Skip leading and duplicate slashes.
+					if (key.empty() || key[key.size()-1] == '/')
+						continue;
+					chr = '/';
+				}
+				key += (caseFold ? foldChar(chr) : chr);
+			}
+
+			// Remove the trailing slash.
+			if (!key.empty() && key[key.size()-1] == '/') {
+				key.resize(key.size()-1);
+			}
+			return key;
+		}
+
+	public:
+		/**
+		 * Reserve space in the index.
+		 * @param count Number of entries.
+		 */
+		inline void reserve(size_t count)
+		{
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+			m_index.reserve(count);
+#else /* !HAVE_UNORDERED_MAP_RESERVE */
+			RP_UNUSED(count);
+#endif /* HAVE_UNORDERED_MAP_RESERVE */
+		}
+
+		/**
+		 * Add a path to the index.
+		 * If the path is already present, the existing value is kept.
+		 * @param key Index key. (must be normalized)
+		 * @param value Value.
+		 * @return True if added; false if the path is already present.
+		 */
+		inline bool insert(const std::string &key, const T &value)
+		{
+			return m_index.emplace(key, value).second;
+		}
+
+		/**
+		 * Look up a path.
+		 * @param key Index key. (must be normalized)
+		 * @return Pointer to the value, or nullptr if not found.
+		 */
+		inline T *find(const std::string &key)
+		{
+			auto iter = m_index.find(key);
+			return (iter != m_index.end() ? &iter->second : nullptr);
+		}
+
+		/**
+		 * Look up a path.
+		 * @param key Index key. (must be normalized)
+		 * @return Pointer to the value, or nullptr if not found.
+		 */
+		inline const T *find(const std::string &key) const
+		{
+			auto iter = m_index.find(key);
+			return (iter != m_index.end() ? &iter->second : nullptr);
+		}
+
+		/**
+		 * Get the number of paths in the index.
+		 * @return Number of paths.
+		 */
+		inline size_t size(void) const
+		{
+			return m_index.size();
+		}
+
+		/**
+		 * Is the index empty?
+		 * @return True if empty; false if not.
+		 */
+		inline bool empty(void) const
+		{
+			return m_index.empty();
+		}
+
+		/**
+		 * Clear the index.
+		 */
+		inline void clear(void)
+		{
+			m_index.clear();
+		}
+
+	private:
+		std::unordered_map<std::string, T> m_index;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_DISC_FSTPATHINDEX_HPP__ */
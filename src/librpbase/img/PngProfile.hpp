@@ -0,0 +1,28 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * PngProfile.hpp: PNG compression profile.                                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_IMG_PNGPROFILE_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_IMG_PNGPROFILE_HPP__
+
+// C includes.
+#include <stdint.h>
+
+namespace LibRpBase {
+
+/**
+ * PNG compression profile.
+ */
+enum class PngProfile : uint8_t {
+	Normal,	// No filtering; default compression level.
+	Fast,	// Fastest encoding, at the expense of file size.
+	Small,	// Smallest files, at the expense of encoding time.
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_IMG_PNGPROFILE_HPP__ */
@@ -119,18 +119,21 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(IRpFile *file, int width, int height, rp_image::Format format)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(PngProfile::Normal)
 		{
 			init(file, width, height, format);
 		}
 		RpPngWriterPrivate(IRpFile *file, const rp_image *img)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(PngProfile::Normal)
 		{
 			init(file, img);
 		}
 		RpPngWriterPrivate(IRpFile *file, const IconAnimData *iconAnimData)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(PngProfile::Normal)
 		{
 			init(file, iconAnimData);
 		}
@@ -138,6 +141,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, int width, int height, rp_image::Format format)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(PngProfile::Normal)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, width, height, format);
@@ -146,6 +150,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, const rp_image *img)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(PngProfile::Normal)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, img);
@@ -154,6 +159,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, const IconAnimData *iconAnimData)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(PngProfile::Normal)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, iconAnimData);
@@ -277,6 +283,9 @@ class RpPngWriterPrivate
 		// Current state.
 		bool IHDR_written;
 
+		// Compression profile.
+		PngProfile profile;
+
 	public:
 		/**
 		 * Initialize the PNG write structs.
@@ -1087,6 +1096,18 @@ void RpPngWriter::close(void)
 	d->close();
 }
 
+/**
+ * Set the compression profile.
+ * This must be called before write_IHDR().
+ * @param profile Compression profile.
+ */
+void RpPngWriter::setProfile(PngProfile profile)
+{
+	RP_D(RpPngWriter);
+	assert(!d->IHDR_written);
+	d->profile = profile;
+}
+
 /**
  * Write the PNG IHDR.
  * This must be called before writing any other image data.
@@ -1122,9 +1143,32 @@ int RpPngWriter::write_IHDR(void)
 #endif /* PNG_SETJMP_SUPPORTED */
 
 	// Initialize compression parameters.
-	// TODO: Customizable?
-	png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
-	png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+	// NOTE: Filtering doesn't help with paletted images.
+	const bool can_filter = (d->cache.format != rp_image::Format::CI8);
+	switch (d->profile) {
+		default:
+			assert(!"Invalid PNG compression profile.");
+			// fall-through
+		case PngProfile::Normal:
+			// No filtering; default compression level.
+			png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
+			png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+			break;
+		case PngProfile::Fast:
+			// Sub filtering with run-length encoding.
+			// Z_RLE only looks for repeats of the previous byte,
+			// which Sub filtering produces for flat areas and
+			// smooth gradients.
+			png_set_filter(d->png_ptr, 0, (can_filter ? PNG_FILTER_SUB : PNG_FILTER_NONE));
+			png_set_compression_level(d->png_ptr, Z_BEST_SPEED);
+			png_set_compression_strategy(d->png_ptr, Z_RLE);
+			break;
+		case PngProfile::Small:
+			// Adaptive filtering; maximum compression level.
+			png_set_filter(d->png_ptr, 0, (can_filter ? PNG_ALL_FILTERS : PNG_FILTER_NONE));
+			png_set_compression_level(d->png_ptr, Z_BEST_COMPRESSION);
+			break;
+	}
 
 	// Write the PNG header.
 	switch (d->cache.format) {
@@ -11,6 +11,7 @@
 
 #include "common.h"
 #include "librptexture/img/rp_image.hpp"
+#include "PngProfile.hpp"
 
 // C++ includes.
 #include <string>
@@ -172,6 +173,13 @@ class RpPngWriter
 		 */
 		void close(void);
 
+		/**
+		 * Set the compression profile.
+		 * This must be called before write_IHDR().
+		 * @param profile Compression profile.
+		 */
+		void setProfile(PngProfile profile);
+
 		/**
 		 * Write the PNG IHDR.
 		 * This must be called before writing any other image data.
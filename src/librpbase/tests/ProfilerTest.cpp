@@ -0,0 +1,234 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * ProfilerTest.cpp: Profiler tests.                                       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "librpbase/config.librpbase.h"
+#include "librpbase/Profiler.hpp"
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <sstream>
+#include <string>
+using std::ostringstream;
+using std::string;
+
+namespace LibRpBase { namespace Tests {
+
+// Temporary file used for read statistics.
+static const char tmp_filename[] = "ProfilerTest.tmp";
+#define TMP_FILE_SIZE 5000U
+
+class ProfilerTest : public ::testing::Test
+{
+	protected:
+		ProfilerTest() { }
+
+		void SetUp(void) final
+		{
+			Profiler::setEnabled(true);
+			Profiler::setAllocCountingEnabled(false);
+			Profiler::reset();
+		}
+
+		void TearDown(void) final
+		{
+			Profiler::setEnabled(false);
+			Profiler::setAllocCountingEnabled(false);
+			Profiler::reset();
+		}
+
+	public:
+		/**
+		 * Get the recorded statistics as JSON.
+		 * @return JSON.
+		 */
+		static string getJSON(void)
+		{
+			ostringstream oss;
+			Profiler::writeJSON(oss, "test.bin");
+			return oss.str();
+		}
+
+		/**
+		 * Read a file using RpFile.
+		 * @param filename Filename.
+		 * @return Number of bytes read.
+		 */
+		static size_t readFile(const char *filename)
+		{
+			RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+			if (!file->isOpen()) {
+				file->unref();
+				return 0;
+			}
+
+			uint8_t buf[1024];
+			size_t total = 0, size;
+			while ((size = file->read(buf, sizeof(buf))) > 0) {
+				total += size;
+			}
+			file->unref();
+			return total;
+		}
+};
+
+/**
+ * Phase names.
+ */
+TEST_F(ProfilerTest, phaseName)
+{
+	EXPECT_STREQ("detection", Profiler::phaseName(Profiler::Phase::Detection));
+	EXPECT_STREQ("fields", Profiler::phaseName(Profiler::Phase::Fields));
+	EXPECT_STREQ("metadata", Profiler::phaseName(Profiler::Phase::MetaData));
+	EXPECT_STREQ("image", Profiler::phaseName(Profiler::Phase::InternalImage));
+	EXPECT_STREQ("ext_urls", Profiler::phaseName(Profiler::Phase::ExtURLs));
+	EXPECT_STREQ("icon_anim", Profiler::phaseName(Profiler::Phase::IconAnimData));
+}
+
+#ifdef ENABLE_PROFILING
+/**
+ * Calls and bytes read are recorded per class and phase.
+ */
+TEST_F(ProfilerTest, scope)
+{
+	EXPECT_TRUE(Profiler::isEnabled());
+
+	{
+		Profiler::Scope profScope("TestClass", Profiler::Phase::Fields);
+		EXPECT_EQ(TMP_FILE_SIZE, readFile(tmp_filename));
+	}
+	{
+		Profiler::Scope profScope("TestClass", Profiler::Phase::Fields);
+	}
+	{
+		// Class name set after the scope starts.
+		Profiler::Scope profScope(nullptr, Profiler::Phase::Detection);
+		profScope.setClassName("OtherClass");
+	}
+
+	// NOTE: Times aren't checked, since they vary.
+	const string json = getJSON();
+	EXPECT_EQ(0U, json.find("{\"file\":\"test.bin\",\"classes\":{")) << json;
+	EXPECT_NE(string::npos, json.find("\"OtherClass\":{\"detection\":{\"calls\":1,")) << json;
+	EXPECT_NE(string::npos, json.find("\"TestClass\":{\"fields\":{\"calls\":2,")) << json;
+	EXPECT_NE(string::npos, json.find("\"bytes_read\":5000}")) << json;
+	// Allocation counting is disabled.
+	EXPECT_EQ(string::npos, json.find("\"allocs\"")) << json;
+}
+
+/**
+ * Nothing is recorded if profiling is disabled at runtime.
+ */
+TEST_F(ProfilerTest, disabled)
+{
+	Profiler::setEnabled(false);
+	EXPECT_FALSE(Profiler::isEnabled());
+	{
+		Profiler::Scope profScope("TestClass", Profiler::Phase::Fields);
+		EXPECT_EQ(TMP_FILE_SIZE, readFile(tmp_filename));
+	}
+
+	EXPECT_EQ("{\"file\":\"test.bin\",\"classes\":{}}\n", getJSON());
+}
+
+/**
+ * Allocations are recorded if allocation counting is enabled.
+ */
+TEST_F(ProfilerTest, allocCounting)
+{
+	Profiler::setAllocCountingEnabled(true);
+	EXPECT_TRUE(Profiler::isAllocCountingEnabled());
+	{
+		Profiler::Scope profScope("TestClass", Profiler::Phase::InternalImage);
+		// NOTE: The test executable doesn't replace operator new(),
+		// so allocations are counted manually.
+		Profiler::countAlloc(100);
+		Profiler::countAlloc(28);
+	}
+
+	const string json = getJSON();
+	EXPECT_NE(string::npos, json.find("\"TestClass\":{\"image\":{\"calls\":1,")) << json;
+	EXPECT_NE(string::npos, json.find("\"allocs\":2,\"alloc_bytes\":128}")) << json;
+}
+
+/**
+ * reset() clears all recorded statistics.
+ */
+TEST_F(ProfilerTest, reset)
+{
+	{
+		Profiler::Scope profScope("TestClass", Profiler::Phase::MetaData);
+	}
+	Profiler::reset();
+
+	EXPECT_EQ("{\"file\":\"test.bin\",\"classes\":{}}\n", getJSON());
+}
+
+/**
+ * The text report includes each class and phase, plus a total.
+ */
+TEST_F(ProfilerTest, writeReport)
+{
+	{
+		Profiler::Scope profScope("TestClass", Profiler::Phase::ExtURLs);
+	}
+
+	ostringstream oss;
+	Profiler::writeReport(oss);
+	const string report = oss.str();
+	EXPECT_NE(string::npos, report.find("TestClass"));
+	EXPECT_NE(string::npos, report.find("ext_urls"));
+	EXPECT_NE(string::npos, report.find("Total"));
+}
+#else /* !ENABLE_PROFILING */
+/**
+ * Profiling can't be enabled if it's disabled at compile time.
+ */
+TEST_F(ProfilerTest, notAvailable)
+{
+	EXPECT_FALSE(Profiler::isEnabled());
+	EXPECT_FALSE(Profiler::isAllocCountingEnabled());
+	EXPECT_EQ(0U, RpFile::threadBytesRead());
+}
+#endif /* ENABLE_PROFILING */
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: Profiler tests.\n\n");
+	fflush(nullptr);
+
+	// Create a temporary file for read statistics.
+	FILE *f = fopen(LibRpBase::Tests::tmp_filename, "wb");
+	if (!f) {
+		fprintf(stderr, "*** ERROR: Unable to create %s\n", LibRpBase::Tests::tmp_filename);
+		return EXIT_FAILURE;
+	}
+	const string data(TMP_FILE_SIZE, 'x');
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	const int ret = RUN_ALL_TESTS();
+
+	remove(LibRpBase::Tests::tmp_filename);
+	return ret;
+}
@@ -72,6 +72,15 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		SCMP_SYS(close),	// mktime() [mz_zip_dosdate_to_time_t()]
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// mktime() [mz_zip_dosdate_to_time_t()]
 
+		// FileSystem::isOnBadFS()
+		SCMP_SYS(statfs), SCMP_SYS(statfs64),
+		SCMP_SYS(poll), SCMP_SYS(ppoll),
+
+		// DownloadServerTest: Runs rp-download using a socket pair.
+		// NOTE: rp-download enables its own seccomp filter.
+		SCMP_SYS(clone), SCMP_SYS(fork), SCMP_SYS(execve), SCMP_SYS(wait4),
+		SCMP_SYS(socketpair), SCMP_SYS(shutdown), SCMP_SYS(dup2),
+
 		// glibc ncsd
 		// TODO: Restrict connect() to AF_UNIX.
 		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
@@ -0,0 +1,250 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpPngWriterTest.cpp: RpPngWriter compression profile test.              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// librpbase
+#include "common.h"
+#include "img/RpPng.hpp"
+#include "img/RpPngWriter.hpp"
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/RpVectorFile.hpp"
+using namespace LibRpFile;
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <chrono>
+#include <string>
+using std::string;
+
+namespace LibRpBase { namespace Tests {
+
+struct RpPngWriterTest_mode
+{
+	const char *png_filename;	// PNG image to encode.
+	PngProfile profile;		// Compression profile.
+
+	RpPngWriterTest_mode(const char *png_filename, PngProfile profile)
+		: png_filename(png_filename)
+		, profile(profile)
+	{ }
+};
+
+class RpPngWriterTest : public ::testing::TestWithParam<RpPngWriterTest_mode>
+{
+	protected:
+		RpPngWriterTest()
+			: m_img(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		/**
+		 * Encode an image using the specified profile.
+		 * @param img		[in] Image.
+		 * @param profile	[in] Compression profile.
+		 * @param file		[out] Output file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int encode(const rp_image *img, PngProfile profile, RpVectorFile *file);
+
+		/**
+		 * Compare two images.
+		 * @param expected	[in] Expected image.
+		 * @param actual	[in] Actual image.
+		 */
+		static void compareImages(const rp_image *expected, const rp_image *actual);
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<RpPngWriterTest_mode> &info);
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Source image.
+		rp_image *m_img;
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void RpPngWriterTest::SetUp(void)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+
+	const string path = string("png_data/") + mode.png_filename;
+	RpFile *const file = new RpFile(path, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	m_img = RpPng::load(file);
+	file->unref();
+	ASSERT_TRUE(m_img != nullptr);
+	ASSERT_TRUE(m_img->isValid());
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void RpPngWriterTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_img);
+}
+
+/**
+ * Encode an image using the specified profile.
+ * @param img		[in] Image.
+ * @param profile	[in] Compression profile.
+ * @param file		[out] Output file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpPngWriterTest::encode(const rp_image *img, PngProfile profile, RpVectorFile *file)
+{
+	RpPngWriter pngWriter(file, img);
+	if (!pngWriter.isOpen()) {
+		return -pngWriter.lastError();
+	}
+
+	pngWriter.setProfile(profile);
+	int ret = pngWriter.write_IHDR();
+	if (ret != 0) {
+		return ret;
+	}
+	return pngWriter.write_IDAT();
+}
+
+/**
+ * Compare two images.
+ * @param expected	[in] Expected image.
+ * @param actual	[in] Actual image.
+ */
+void RpPngWriterTest::compareImages(const rp_image *expected, const rp_image *actual)
+{
+	ASSERT_EQ(expected->width(), actual->width());
+	ASSERT_EQ(expected->height(), actual->height());
+	ASSERT_EQ(expected->format(), actual->format());
+
+	if (expected->format() == rp_image::Format::CI8) {
+		ASSERT_EQ(expected->palette_len(), actual->palette_len());
+		EXPECT_EQ(0, memcmp(expected->palette(), actual->palette(),
+			expected->palette_len() * sizeof(uint32_t)));
+	}
+
+	const size_t row_bytes = expected->row_bytes();
+	for (int y = 0; y < expected->height(); y++) {
+		ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), row_bytes))
+			<< "Row " << y << " does not match.";
+	}
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string RpPngWriterTest::test_case_suffix_generator(const ::testing::TestParamInfo<RpPngWriterTest_mode> &info)
+{
+	static const char *const profile_names[] = {"Normal", "Fast", "Small"};
+
+	string suffix = info.param.png_filename;
+	suffix += '_';
+	suffix += profile_names[static_cast<int>(info.param.profile)];
+
+	// Replace all non-alphanumeric characters with '_'.
+	// See gtest-param-util.h::IsValidParamName().
+	for (char &c : suffix) {
+		if (!isalnum(static_cast<unsigned char>(c))) {
+			c = '_';
+		}
+	}
+	return suffix;
+}
+
+/**
+ * Encode the image and verify that it decodes to the original image.
+ */
+TEST_P(RpPngWriterTest, roundTrip)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+
+	RpVectorFile *const vecFile = new RpVectorFile();
+	ASSERT_EQ(0, encode(m_img, mode.profile, vecFile));
+	ASSERT_GT(vecFile->size(), 0);
+
+	RpMemFile *const memFile = new RpMemFile(vecFile->vector().data(), vecFile->vector().size());
+	rp_image *const img = RpPng::load(memFile);
+	memFile->unref();
+	vecFile->unref();
+	ASSERT_TRUE(img != nullptr);
+
+	compareImages(m_img, img);
+	img->unref();
+}
+
+/**
+ * Benchmark encoding the image.
+ */
+TEST_P(RpPngWriterTest, encode_benchmark)
+{
+	const RpPngWriterTest_mode &mode = GetParam();
+
+	off64_t size = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RpVectorFile *const vecFile = new RpVectorFile();
+		const int ret = encode(m_img, mode.profile, vecFile);
+		size = vecFile->size();
+		vecFile->unref();
+		ASSERT_EQ(0, ret);
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double usec = std::chrono::duration<double, std::micro>(end - start).count();
+	printf("%s: %u bytes, %.1f usec/image\n", mode.png_filename,
+		static_cast<unsigned int>(size), usec / BENCHMARK_ITERATIONS);
+}
+
+// Test images.
+#define RpPngWriterTest_profiles(png_filename) \
+	RpPngWriterTest_mode(png_filename, PngProfile::Normal), \
+	RpPngWriterTest_mode(png_filename, PngProfile::Fast), \
+	RpPngWriterTest_mode(png_filename, PngProfile::Small)
+
+INSTANTIATE_TEST_SUITE_P(png_data, RpPngWriterTest,
+	::testing::Values(
+		RpPngWriterTest_profiles("gl_triangle.ARGB32.png"),
+		RpPngWriterTest_profiles("gl_triangle.RGB24.png"),
+		RpPngWriterTest_profiles("gl_triangle.gray.png"),
+		RpPngWriterTest_profiles("gl_quad.ARGB32.png"),
+		RpPngWriterTest_profiles("gl_quad.RGB24.tRNS.png"),
+		RpPngWriterTest_profiles("gl_quad.gray.alpha.png"),
+		RpPngWriterTest_profiles("xterm-256color.CI8.png"),
+		RpPngWriterTest_profiles("xterm-256color.CI8.tRNS.png"),
+		RpPngWriterTest_profiles("happy-mac.mono.png"),
+		RpPngWriterTest_profiles("odd-width.16color.CI4.png")
+	), RpPngWriterTest::test_case_suffix_generator);
+
+} }
@@ -0,0 +1,102 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * byteswap_avx2.c: Byteswapping functions.                                *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2008-2020 by David Korth                                  *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "byteswap_rp.h"
+
+// C includes.
+#include <assert.h>
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+/**
+ * 16-bit byteswap function.
+ * AVX2-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 16-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 2; an extra odd byte will be ignored.)
+ */
+void __byte_swap_16_array_avx2(uint16_t *ptr, size_t n)
+{
+	// NOTE: vpshufb shuffles within each 128-bit lane,
+	// so the mask is repeated for both lanes.
+	const __m256i shuf_mask = _mm256_setr_epi8(
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14,
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+
+	// Verify the block is 16-bit aligned
+	// and is a multiple of 2 bytes.
+	assert(((uintptr_t)ptr & 1) == 0);
+	assert((n & 1) == 0);
+	n &= ~1;
+
+	// If vptr isn't 32-byte aligned, swap WORDs
+	// manually until we get to 32-byte alignment.
+	for (; ((uintptr_t)ptr % 32 != 0) && n > 0; n -= 2, ptr++) {
+		*ptr = __swab16(*ptr);
+	}
+
+	// Process 32 WORDs per iteration using AVX2.
+	for (; n >= 64; n -= 64, ptr += 32) {
+		__m256i *ymm_ptr = (__m256i*)ptr;
+
+		__m256i ymm0 = _mm256_load_si256(&ymm_ptr[0]);
+		__m256i ymm1 = _mm256_load_si256(&ymm_ptr[1]);
+
+		_mm256_store_si256(&ymm_ptr[0], _mm256_shuffle_epi8(ymm0, shuf_mask));
+		_mm256_store_si256(&ymm_ptr[1], _mm256_shuffle_epi8(ymm1, shuf_mask));
+	}
+
+	// Process the remaining data, one WORD at a time.
+	for (; n > 0; n -= 2, ptr++) {
+		*ptr = __swab16(*ptr);
+	}
+}
+
+/**
+ * 32-bit byteswap function.
+ * AVX2-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 32-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 4; extra bytes will be ignored.)
+ */
+void __byte_swap_32_array_avx2(uint32_t *ptr, size_t n)
+{
+	// NOTE: vpshufb shuffles within each 128-bit lane,
+	// so the mask is repeated for both lanes.
+	const __m256i shuf_mask = _mm256_setr_epi8(
+		3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12,
+		3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+
+	// Verify the block is 32-bit aligned
+	// and is a multiple of 4 bytes.
+	assert(((uintptr_t)ptr & 3) == 0);
+	assert((n & 3) == 0);
+	n &= ~3;
+
+	// If vptr isn't 32-byte aligned, swap DWORDs
+	// manually until we get to 32-byte alignment.
+	for (; ((uintptr_t)ptr % 32 != 0) && n > 0; n -= 4, ptr++) {
+		*ptr = __swab32(*ptr);
+	}
+
+	// Process 16 DWORDs per iteration using AVX2.
+	for (; n >= 64; n -= 64, ptr += 16) {
+		__m256i *ymm_ptr = (__m256i*)ptr;
+
+		__m256i ymm0 = _mm256_load_si256(&ymm_ptr[0]);
+		__m256i ymm1 = _mm256_load_si256(&ymm_ptr[1]);
+
+		_mm256_store_si256(&ymm_ptr[0], _mm256_shuffle_epi8(ymm0, shuf_mask));
+		_mm256_store_si256(&ymm_ptr[1], _mm256_shuffle_epi8(ymm1, shuf_mask));
+	}
+
+	// Process the remaining data, one DWORD at a time.
+	for (; n > 0; n -= 4, ptr++) {
+		*ptr = __swab32(*ptr);
+	}
+}
@@ -30,6 +30,10 @@
 # endif
 # define BYTESWAP_HAS_SSE2 1
 # define BYTESWAP_HAS_SSSE3 1
+/* AVX2 intrinsics require MSVC 2012 or later. */
+# if !defined(_MSC_VER) || _MSC_VER >= 1700
+#  define BYTESWAP_HAS_AVX2 1
+# endif
 #endif
 #ifdef RP_CPU_AMD64
 # define BYTESWAP_ALWAYS_HAS_SSE2 1
@@ -186,6 +190,24 @@ void __byte_swap_16_array_ssse3(uint16_t *ptr, size_t n);
 void __byte_swap_32_array_ssse3(uint32_t *ptr, size_t n);
 #endif /* BYTESWAP_HAS_SSSE3 */
 
+#ifdef BYTESWAP_HAS_AVX2
+/**
+ * 16-bit byteswap function.
+ * AVX2-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 16-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 2; an extra odd byte will be ignored.)
+ */
+void __byte_swap_16_array_avx2(uint16_t *ptr, size_t n);
+
+/**
+ * 32-bit byteswap function.
+ * AVX2-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 32-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 4; extra bytes will be ignored.)
+ */
+void __byte_swap_32_array_avx2(uint32_t *ptr, size_t n);
+#endif /* BYTESWAP_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /* System has IFUNC. Use it for dispatching. */
 
@@ -213,6 +235,11 @@ void __byte_swap_32_array(uint32_t *ptr, size_t n);
  */
 static inline void __byte_swap_16_array(uint16_t *ptr, size_t n)
 {
+# ifdef BYTESWAP_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		__byte_swap_16_array_avx2(ptr, n);
+	} else
+# endif /* BYTESWAP_HAS_AVX2 */
 # ifdef BYTESWAP_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		__byte_swap_16_array_ssse3(ptr, n);
@@ -247,6 +274,11 @@ static inline void __byte_swap_16_array(uint16_t *ptr, size_t n)
  */
 static inline void __byte_swap_32_array(uint32_t *ptr, size_t n)
 {
+# ifdef BYTESWAP_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		__byte_swap_32_array_avx2(ptr, n);
+	} else
+# endif /* BYTESWAP_HAS_AVX2 */
 # ifdef BYTESWAP_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		__byte_swap_32_array_ssse3(ptr, n);
@@ -55,6 +55,20 @@
 
 // Flags stored in the %ebx register.
 #define CPUFLAG_IA32_FN7_EBX_AVX2	((uint32_t)(1U << 5))
+#define CPUFLAG_IA32_FN7_EBX_BMI2	((uint32_t)(1U << 8))
+#define CPUFLAG_IA32_FN7_EBX_AVX512F	((uint32_t)(1U << 16))
+#define CPUFLAG_IA32_FN7_EBX_AVX512BW	((uint32_t)(1U << 30))
+
+// XCR0: Extended Control Register 0 (XFEATURE_ENABLED_MASK)
+// The OS must enable saving of these register states
+// before AVX and AVX-512 instructions can be used.
+#define XCR0_SSE		((uint32_t)(1U << 1))	// XMM registers
+#define XCR0_AVX		((uint32_t)(1U << 2))	// Upper 128 bits of YMM registers
+#define XCR0_OPMASK		((uint32_t)(1U << 5))	// AVX-512 opmask registers
+#define XCR0_ZMM_HI256		((uint32_t)(1U << 6))	// Upper 256 bits of ZMM0-ZMM15
+#define XCR0_HI16_ZMM		((uint32_t)(1U << 7))	// ZMM16-ZMM31
+#define XCR0_AVX_MASK		(XCR0_SSE | XCR0_AVX)
+#define XCR0_AVX512_MASK	(XCR0_AVX_MASK | XCR0_OPMASK | XCR0_ZMM_HI256 | XCR0_HI16_ZMM)
 
 // CPUID function 0x80000001: Extended Processor Info and Feature Bits
 
@@ -185,6 +199,72 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #endif
 }
 
+/**
+ * Run the `cpuid` instruction with a subleaf.
+ * @param level
+ * @param subleaf Subleaf. (%ecx)
+ * @param regs Registers. (%eax, %ebx, %ecx, %edx)
+ */
+static FORCEINLINE void cpuid_count(unsigned int level, unsigned int subleaf, unsigned int regs[4])
+{
+#if defined(__GNUC__)
+# ifdef ASM_RESERVE_EBX
+	__asm__ (
+		"xchgl	%%ebx, %1\n"
+		"cpuid\n"
+		"xchgl	%%ebx, %1\n"
+		: "=a" (regs[0]), "=r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (level), "2" (subleaf)
+		);
+# else /* !ASM_RESERVE_EBX */
+	__asm__ (
+		"cpuid\n"
+		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (level), "2" (subleaf)
+		);
+# endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1500
+	// CPUID for MSVC 2008+
+	// Uses the __cpuidex() intrinsic.
+	__cpuidex((int*)regs, level, subleaf);
+#else
+	// No subleaf support. Report no extended features.
+	RP_UNUSED(level);
+	RP_UNUSED(subleaf);
+	regs[0] = 0;
+	regs[1] = 0;
+	regs[2] = 0;
+	regs[3] = 0;
+#endif
+}
+
+/**
+ * Run the `xgetbv` instruction to read XCR0.
+ * NOTE: Only call this if CPUID reports OSXSAVE.
+ * @return Low 32 bits of XCR0.
+ */
+static FORCEINLINE uint32_t xgetbv_xcr0(void)
+{
+#if defined(__GNUC__)
+	// NOTE: Using the opcode directly, since older
+	// assemblers don't recognize `xgetbv`.
+	uint32_t __eax, __edx;
+	__asm__ (
+		".byte 0x0f, 0x01, 0xd0\n"	// xgetbv
+		: "=a" (__eax), "=d" (__edx)
+		: "c" (0)
+		);
+	RP_UNUSED(__edx);
+	return __eax;
+#elif defined(_MSC_VER) && (_MSC_FULL_VER >= 160040219)
+	// MSVC 2010 SP1 and later have the _xgetbv() intrinsic.
+	return (uint32_t)_xgetbv(0);
+#else
+	// Cannot check OS support, so assume it isn't available.
+	return 0;
+#endif
+}
+
 // Register indexes.
 #define REG_EAX 0
 #define REG_EBX 1
@@ -202,6 +282,7 @@ static void RP_CPU_InitCPUFlags_int(void)
 {
 	unsigned int regs[4];	// %eax, %ebx, %ecx, %edx
 	unsigned int maxFunc;
+	uint32_t xcr0 = 0;
 #if defined(__i386__) || defined(_M_IX86)
 	uint8_t can_FXSAVE = 0;
 #endif /* defined(__i386__) || defined(_M_IX86) */
@@ -308,6 +389,45 @@ static void RP_CPU_InitCPUFlags_int(void)
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
 #endif /* defined(__i386__) || defined(_M_IX86) */
+
+		// AVX requires OS support for saving the YMM registers.
+		// Check OSXSAVE first, then verify that XCR0 has
+		// the SSE and AVX state bits set.
+		if ((regs[REG_ECX] & CPUFLAG_IA32_ECX_OSXSAVE) &&
+		    (RP_CPU_Flags & RP_CPUFLAG_X86_SSE2))
+		{
+			xcr0 = xgetbv_xcr0();
+			if ((regs[REG_ECX] & CPUFLAG_IA32_ECX_AVX) &&
+			    (xcr0 & XCR0_AVX_MASK) == XCR0_AVX_MASK)
+			{
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX;
+			}
+		}
+	}
+
+	if (maxFunc >= CPUID_EXT_FEATURES) {
+		// Get the extended feature bits. (subleaf 0)
+		cpuid_count(CPUID_EXT_FEATURES, 0, regs);
+
+		// BMI2 uses general-purpose registers,
+		// so it doesn't need OS support.
+		if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_BMI2)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_BMI2;
+
+		if (RP_CPU_Flags & RP_CPUFLAG_X86_AVX) {
+			if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX2)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX2;
+
+			// AVX-512 also requires OS support for
+			// the opmask and ZMM registers.
+			if ((regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX512F) &&
+			    (xcr0 & XCR0_AVX512_MASK) == XCR0_AVX512_MASK)
+			{
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX512F;
+				if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX512BW)
+					RP_CPU_Flags |= RP_CPUFLAG_X86_AVX512BW;
+			}
+		}
 	}
 
 	// CPU flags initialized.
@@ -29,6 +29,11 @@ extern "C" {
 #define RP_CPUFLAG_X86_SSSE3		((uint32_t)(1U << 4))
 #define RP_CPUFLAG_X86_SSE41		((uint32_t)(1U << 5))
 #define RP_CPUFLAG_X86_SSE42		((uint32_t)(1U << 6))
+#define RP_CPUFLAG_X86_AVX		((uint32_t)(1U << 7))
+#define RP_CPUFLAG_X86_AVX2		((uint32_t)(1U << 8))
+#define RP_CPUFLAG_X86_BMI2		((uint32_t)(1U << 9))
+#define RP_CPUFLAG_X86_AVX512F		((uint32_t)(1U << 10))
+#define RP_CPUFLAG_X86_AVX512BW		((uint32_t)(1U << 11))
 
 #endif /* defined(__i386__) || defined(__amd64__) || defined(__x86_64__) */
 
@@ -99,6 +104,54 @@ static FORCEINLINE int RP_CPU_HasSSE41(void)
 	return (RP_CPU_Flags & RP_CPUFLAG_X86_SSE41);
 }
 
+/**
+ * Check if the CPU and OS support AVX.
+ * @return Non-zero if AVX is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX);
+}
+
+/**
+ * Check if the CPU and OS support AVX2.
+ * @return Non-zero if AVX2 is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX2(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX2);
+}
+
+/**
+ * Check if the CPU supports BMI2.
+ * @return Non-zero if BMI2 is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasBMI2(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_BMI2);
+}
+
+/**
+ * Check if the CPU and OS support AVX-512BW.
+ * @return Non-zero if AVX-512BW is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX512BW(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX512BW);
+}
+
 #ifdef __cplusplus
 }
 #endif
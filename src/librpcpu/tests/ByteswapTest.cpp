@@ -71,7 +71,7 @@ void ByteswapTest::SetUp(void)
 	static_assert(ALIGN_BUF_SIZE >= TEST_ARRAY_SIZE, "ALIGN_BUF_SIZE is too small.");
 	static_assert(ALIGN_BUF_SIZE % TEST_ARRAY_SIZE == 0, "ALIGN_BUF_SIZE is not a multiple of TEST_ARRAY_SIZE.");
 
-	align_buf = static_cast<uint8_t*>(aligned_malloc(16, ALIGN_BUF_SIZE));
+	align_buf = static_cast<uint8_t*>(aligned_malloc(32, ALIGN_BUF_SIZE));
 	ASSERT_TRUE(align_buf != nullptr);
 
 	uint8_t *ptr = align_buf;
@@ -150,7 +150,7 @@ TEST_F(ByteswapTest, nonHostEndianMacroTest)
 
 /**
  * Macro for testing a 16-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -171,7 +171,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_##opt##_test) \
 
 /**
  * Macro for benchmarking a 16-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -193,7 +193,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_##opt##_benchmark) \
  * This version has data that is 16-bit aligned, but not 32-bit aligned,
  * and the block has an odd number of WORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -218,7 +218,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_unDWORD_##opt##_test) \
  * This version has data that is 16-bit aligned, but not 32-bit aligned,
  * and the block has an odd number of WORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -236,7 +236,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_unDWORD_##opt##_benchmark) \
 
 /**
  * Macro for testing a 32-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -257,7 +257,7 @@ TEST_F(ByteswapTest, __byte_swap_32_array_##opt##_test) \
 
 /**
  * Macro for benchmarking a 32-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -279,7 +279,7 @@ TEST_F(ByteswapTest, __byte_swap_32_array_##opt##_benchmark) \
  * This version has data that is 32-bit aligned, but not 64-bit aligned,
  * and the block has an odd number of DWORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -304,7 +304,7 @@ TEST_F(ByteswapTest, __byte_swap_32_array_unQWORD_##opt##_test) \
  * This version has data that is 32-bit aligned, but not 64-bit aligned,
  * and the block has an odd number of DWORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -366,8 +366,21 @@ DO_ARRAY_32_unQWORD_TEST	(ssse3, RP_CPU_HasSSSE3(), "*** SSSE3 is not supported
 DO_ARRAY_32_unQWORD_BENCHMARK	(ssse3, RP_CPU_HasSSSE3(), "*** SSSE3 is not supported on this CPU. Skipping test.\n")
 #endif /* BYTESWAP_HAS_SSSE3 */
 
+#ifdef BYTESWAP_HAS_AVX2
+// AVX2-optimized tests.
+DO_ARRAY_16_TEST		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_BENCHMARK		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_TEST	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_BENCHMARK	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_TEST		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_BENCHMARK		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_TEST	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_BENCHMARK	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+#endif /* BYTESWAP_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(BYTESWAP_HAS_MMX) || defined(BYTESWAP_HAS_SSE2) || defined(BYTESWAP_HAS_SSSE3)
+#if defined(BYTESWAP_HAS_MMX) || defined(BYTESWAP_HAS_SSE2) || defined(BYTESWAP_HAS_SSSE3) || \
+    defined(BYTESWAP_HAS_AVX2)
 // Dispatch functions.
 DO_ARRAY_16_TEST		(dispatch, true, "")
 DO_ARRAY_16_BENCHMARK		(dispatch, true, "")
@@ -377,7 +390,7 @@ DO_ARRAY_32_TEST		(dispatch, true, "")
 DO_ARRAY_32_BENCHMARK		(dispatch, true, "")
 DO_ARRAY_32_unQWORD_TEST	(dispatch, true, "")
 DO_ARRAY_32_unQWORD_BENCHMARK	(dispatch, true, "")
-#endif /* BYTESWAP_HAS_MMX || BYTESWAP_HAS_SSE2 || BYTESWAP_HAS_SSSE3 */
+#endif /* BYTESWAP_HAS_MMX || BYTESWAP_HAS_SSE2 || BYTESWAP_HAS_SSSE3 || BYTESWAP_HAS_AVX2 */
 
 } }
 
@@ -388,6 +401,13 @@ extern "C" int gtest_main(int argc, TCHAR *argv[])
 {
 	fprintf(stderr, "LibRpCpu test suite: Byteswap tests.\n\n");
 	fprintf(stderr, "Benchmark iterations: %u\n", LibRpCpu::Tests::ByteswapTest::BENCHMARK_ITERATIONS);
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+	// Show the supported tiers so the benchmarks can be compared.
+	fprintf(stderr, "CPU tiers: SSE2:%s SSSE3:%s AVX2:%s\n",
+		RP_CPU_HasSSE2() ? "yes" : "no",
+		RP_CPU_HasSSSE3() ? "yes" : "no",
+		RP_CPU_HasAVX2() ? "yes" : "no");
+#endif /* RP_CPU_I386 || RP_CPU_AMD64 */
 	fflush(nullptr);
 
 	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
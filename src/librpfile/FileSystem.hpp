@@ -125,6 +125,15 @@ static inline int delete_file(const std::string &filename)
 	return delete_file(filename.c_str());
 }
 
+/**
+ * Rename a file.
+ * If the new filename already exists, it will be replaced.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename(const std::string &oldname, const std::string &newname);
+
 /**
  * Get the file extension from a filename or pathname.
  * @param filename Filename.
@@ -170,6 +179,18 @@ std::string resolve_symlink(const char *filename);
  */
 bool isOnBadFS(const char *filename, bool netFS = false);
 
+/**
+ * Get isOnBadFS() cache statistics.
+ *
+ * On Linux, isOnBadFS() caches the file system type
+ * for each device ID. The cache is cleared if the
+ * mount table changes.
+ *
+ * @param pHits		[out,opt] Number of cache hits.
+ * @param pMisses	[out,opt] Number of cache misses.
+ */
+void getBadFSCacheStats(unsigned int *pHits, unsigned int *pMisses);
+
 /**
  * Get a file's size and time.
  * @param filename	[in] Filename.
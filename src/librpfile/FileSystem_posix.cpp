@@ -17,6 +17,7 @@
 #include <unistd.h>
 
 #ifdef __linux__
+# include <poll.h>	// poll() [isOnBadFS() cache]
 // TODO: Remove once /proc/mounts parsing is implemented.
 # include <sys/vfs.h>
 # include <linux/magic.h>
@@ -41,12 +42,153 @@
 # endif /* OCFS2_SUPER_MAGIC */
 #endif /* __linux__ */
 
+#ifdef __linux__
+// librpthreads
+# include "librpthreads/Mutex.hpp"
+# include "librpthreads/pthread_once.h"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// C++ includes.
+# include <unordered_map>
+using std::unordered_map;
+#endif /* __linux__ */
+
 // C++ STL classes.
 using std::string;
 using std::u16string;
 
 namespace LibRpFile { namespace FileSystem {
 
+#ifdef __linux__
+/** isOnBadFS() cache **/
+
+// Maximum number of cached devices.
+// If this is exceeded, the cache is cleared.
+#define BADFS_CACHE_MAX 256
+
+// isOnBadFS() cache.
+// Key: Device ID (st_dev); value: statfs() f_type.
+// NOTE: The f_type is cached instead of the result so the
+// netFS parameter can differ between calls.
+static unordered_map<uint64_t, uint32_t> badfs_cache;
+static Mutex badfs_mutex;
+static unsigned int badfs_hits = 0;
+static unsigned int badfs_misses = 0;
+
+// /proc/self/mountinfo file descriptor.
+// If a mount or unmount occurs, poll() will return POLLERR|POLLPRI,
+// at which point the cache is cleared.
+// If this is -1, the cache is disabled.
+static int badfs_mountinfo_fd = -1;
+static pthread_once_t badfs_once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Open /proc/self/mountinfo for isOnBadFS() cache invalidation.
+ * Called by pthread_once().
+ */
+static void initBadFSCache(void)
+{
+	badfs_mountinfo_fd = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * Get a file's device ID.
+ * @param filename	[in] Filename.
+ * @param pDev		[out] Device ID.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int get_dev(const char *filename, uint64_t *pDev)
+{
+#ifdef HAVE_STATX
+	// NOTE: stx_dev_major/stx_dev_minor are always returned.
+	struct statx sbx;
+	int ret = statx(AT_FDCWD, filename, 0, STATX_TYPE, &sbx);
+	if (ret != 0) {
+		// statx() failed.
+		ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+	*pDev = (static_cast<uint64_t>(sbx.stx_dev_major) << 32) | sbx.stx_dev_minor;
+#else /* !HAVE_STATX */
+	struct stat sb;
+	int ret = stat(filename, &sb);
+	if (ret != 0) {
+		// stat() failed.
+		ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+	*pDev = static_cast<uint64_t>(sb.st_dev);
+#endif /* HAVE_STATX */
+	return 0;
+}
+
+/**
+ * Get a file's file system type, using the isOnBadFS() cache if possible.
+ * @param filename	[in] Filename.
+ * @param pFsType	[out] File system type. (statfs() f_type)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int get_fs_type(const char *filename, uint32_t *pFsType)
+{
+	pthread_once(&badfs_once_control, initBadFSCache);
+
+	uint64_t dev = 0;
+	bool useCache = false;
+	if (badfs_mountinfo_fd >= 0) {
+		// NOTE: stat() is used instead of statfs() for the cache lookup,
+		// since network file systems usually handle stat() using the
+		// local attribute cache, whereas statfs() requires a round trip
+		// to the server.
+		useCache = (get_dev(filename, &dev) == 0);
+	}
+
+	if (useCache) {
+		MutexLocker locker(badfs_mutex);
+
+		// Check if the mount table has changed.
+		struct pollfd pfd;
+		pfd.fd = badfs_mountinfo_fd;
+		pfd.events = POLLPRI;
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, 0);
+		if (ret != 0) {
+			// Mount table has changed, or poll() failed.
+			// Clear the cache.
+			badfs_cache.clear();
+		} else {
+			auto iter = badfs_cache.find(dev);
+			if (iter != badfs_cache.end()) {
+				// Found a cached file system type.
+				badfs_hits++;
+				*pFsType = iter->second;
+				return 0;
+			}
+		}
+		badfs_misses++;
+	}
+
+	struct statfs sfbuf;
+	int ret = statfs(filename, &sfbuf);
+	if (ret != 0) {
+		// statfs() failed.
+		ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+	*pFsType = static_cast<uint32_t>(sfbuf.f_type);
+
+	if (useCache) {
+		MutexLocker locker(badfs_mutex);
+		if (badfs_cache.size() >= BADFS_CACHE_MAX) {
+			// Too many devices. Clear the cache.
+			badfs_cache.clear();
+		}
+		badfs_cache.emplace(dev, *pFsType);
+	}
+	return 0;
+}
+#endif /* __linux__ */
+
 /**
  * Recursively mkdir() subdirectories.
  *
@@ -216,6 +358,27 @@ int delete_file(const char *filename)
 	return ret;
 }
 
+/**
+ * Rename a file.
+ * If the new filename already exists, it will be replaced.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename(const string &oldname, const string &newname)
+{
+	if (unlikely(oldname.empty() || newname.empty()))
+		return -EINVAL;
+
+	int ret = ::rename(oldname.c_str(), newname.c_str());
+	if (ret != 0) {
+		// Error renaming the file.
+		ret = -errno;
+	}
+
+	return ret;
+}
+
 /**
  * Check if the specified file is a symbolic link.
  * @return True if the file is a symbolic link; false if not.
@@ -288,15 +451,15 @@ bool isOnBadFS(const char *filename, bool netFS)
 #ifdef __linux__
 	// TODO: Get the mount point, then look it up in /proc/mounts.
 
-	struct statfs sfbuf;
-	int ret = statfs(filename, &sfbuf);
+	uint32_t fs_type;
+	int ret = get_fs_type(filename, &fs_type);
 	if (ret != 0) {
 		// statfs() failed.
 		// Assume this isn't a network file system.
 		return false;
 	}
 
-	switch (static_cast<uint32_t>(sfbuf.f_type)) {
+	switch (fs_type) {
 		case DEBUGFS_MAGIC:
 		case DEVPTS_SUPER_MAGIC:
 		case EFIVARFS_MAGIC:
@@ -347,6 +510,31 @@ bool isOnBadFS(const char *filename, bool netFS)
 	return bRet;
 }
 
+/**
+ * Get isOnBadFS() cache statistics.
+ * @param pHits		[out,opt] Number of cache hits.
+ * @param pMisses	[out,opt] Number of cache misses.
+ */
+void getBadFSCacheStats(unsigned int *pHits, unsigned int *pMisses)
+{
+#ifdef __linux__
+	MutexLocker locker(badfs_mutex);
+	if (pHits) {
+		*pHits = badfs_hits;
+	}
+	if (pMisses) {
+		*pMisses = badfs_misses;
+	}
+#else /* !__linux__ */
+	if (pHits) {
+		*pHits = 0;
+	}
+	if (pMisses) {
+		*pMisses = 0;
+	}
+#endif /* __linux__ */
+}
+
 /**
  * Get a file's size and time.
  * @param filename	[in] Filename.
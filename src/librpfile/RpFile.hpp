@@ -254,6 +254,17 @@ class RpFile : public IRpFile
 		 * @return 0 on success, positive for SCSI sense key, negative for POSIX error code.
 		 */
 		int setKreonLockState(KreonLockState lockState);
+
+	public:
+		/** Profiling **/
+
+		/**
+		 * Get the number of bytes read by RpFile objects on the calling thread.
+		 * NOTE: This is only counted if profiling is enabled at compile time.
+		 * Otherwise, this always returns 0.
+		 * @return Number of bytes read on the calling thread.
+		 */
+		static uint64_t threadBytesRead(void);
 };
 
 }
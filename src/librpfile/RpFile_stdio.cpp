@@ -23,6 +23,11 @@
 
 namespace LibRpFile {
 
+#ifdef ENABLE_PROFILING
+// Number of bytes read by RpFile objects on the current thread.
+static RP_THREAD_LOCAL uint64_t tls_bytesRead = 0;
+#endif /* ENABLE_PROFILING */
+
 /** RpFilePrivate **/
 
 RpFilePrivate::~RpFilePrivate()
@@ -353,13 +358,11 @@ size_t RpFile::read(void *ptr, size_t size)
 		return 0;
 	}
 
+	size_t ret;
 	if (d->devInfo) {
 		// Block device. Need to read in multiples of the block size.
-		return d->readUsingBlocks(ptr, size);
-	}
-
-	size_t ret;
-	if (d->gzfd != 0) {
+		ret = d->readUsingBlocks(ptr, size);
+	} else if (d->gzfd != 0) {
 		int iret = gzread(d->gzfd, ptr, size);
 		if (iret >= 0) {
 			ret = (size_t)iret;
@@ -375,6 +378,10 @@ size_t RpFile::read(void *ptr, size_t size)
 			m_lastError = errno;
 		}
 	}
+
+#ifdef ENABLE_PROFILING
+	tls_bytesRead += ret;
+#endif /* ENABLE_PROFILING */
 	return ret;
 }
 
@@ -626,4 +633,22 @@ int RpFile::makeWritable(void)
 	return 0;
 }
 
+
+/** Profiling **/
+
+/**
+ * Get the number of bytes read by RpFile objects on the calling thread.
+ * NOTE: This is only counted if profiling is enabled at compile time.
+ * Otherwise, this always returns 0.
+ * @return Number of bytes read on the calling thread.
+ */
+uint64_t RpFile::threadBytesRead(void)
+{
+#ifdef ENABLE_PROFILING
+	return tls_bytesRead;
+#else /* !ENABLE_PROFILING */
+	return 0;
+#endif /* ENABLE_PROFILING */
+}
+
 }
@@ -107,4 +107,23 @@ int RpVectorFile::seek(off64_t pos)
 	return 0;
 }
 
+/**
+ * Truncate the file.
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int RpVectorFile::truncate(off64_t size)
+{
+	if (size < 0) {
+		m_lastError = EINVAL;
+		return -1;
+	}
+
+	m_vector.resize(static_cast<size_t>(size));
+	if (m_pos > m_vector.size()) {
+		m_pos = m_vector.size();
+	}
+	return 0;
+}
+
 }
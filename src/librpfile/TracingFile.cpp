@@ -0,0 +1,352 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * TracingFile.cpp: IRpFile wrapper that records all I/O operations.       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "TracingFile.hpp"
+#include "monotonic_time.h"
+
+// C++ STL classes.
+using std::string;
+
+namespace LibRpFile {
+
+/**
+ * Wrap an IRpFile and record all I/O operations.
+ *
+ * NOTE: Classes that check for a specific IRpFile subclass,
+ * e.g. RpFile for Kreon drive support, won't see the
+ * underlying file.
+ *
+ * @param file Underlying file.
+ */
+TracingFile::TracingFile(IRpFile *file)
+	: super()
+	, m_file(nullptr)
+	, m_pos(0)
+	, m_phase(Phase::Detection)
+	, m_opsTruncated(false)
+	, m_start(rp_monotonic_time_us())
+	, m_uniqueBytes(0)
+{
+	memset(m_stats, 0, sizeof(m_stats));
+
+	assert(file != nullptr);
+	if (!file) {
+		m_lastError = EBADF;
+		return;
+	}
+
+	m_file = file->ref();
+	m_pos = file->tell();
+	if (m_pos < 0) {
+		m_pos = 0;
+	}
+
+	// Mirror the underlying file's properties.
+	m_isCompressed = file->isCompressed();
+	m_fileType = static_cast<uint8_t>(file->fileType());
+}
+
+TracingFile::~TracingFile()
+{
+	UNREF(m_file);
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool TracingFile::isOpen(void) const
+{
+	return (m_file != nullptr && m_file->isOpen());
+}
+
+/**
+ * Close the file.
+ */
+void TracingFile::close(void)
+{
+	UNREF_AND_NULL(m_file);
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t TracingFile::read(void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	const uint64_t start = rp_monotonic_time_us();
+	const size_t ret = m_file->read(ptr, size);
+	const uint64_t end = rp_monotonic_time_us();
+	m_lastError = m_file->lastError();
+
+	Op op;
+	op.timestamp = start - m_start;
+	op.duration = static_cast<uint32_t>(end - start);
+	op.type = OpType::Read;
+	op.phase = m_phase;
+	op.offset = m_pos;
+	op.size = static_cast<uint32_t>(size);
+	op.result = static_cast<uint32_t>(ret);
+	op.reread = static_cast<uint32_t>(markRead(m_pos, m_pos + ret));
+	record(op);
+
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for TracingFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t TracingFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for TracingFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int TracingFile::seek(off64_t pos)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	const uint64_t start = rp_monotonic_time_us();
+	const int ret = m_file->seek(pos);
+	const uint64_t end = rp_monotonic_time_us();
+	m_lastError = m_file->lastError();
+	if (ret == 0) {
+		m_pos = pos;
+	}
+
+	Op op;
+	op.timestamp = start - m_start;
+	op.duration = static_cast<uint32_t>(end - start);
+	op.type = OpType::Seek;
+	op.phase = m_phase;
+	op.offset = pos;
+	op.size = 0;
+	op.result = 0;
+	op.reread = 0;
+	record(op);
+
+	return ret;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t TracingFile::tell(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	// The position is tracked locally, so this
+	// doesn't need to touch the underlying file.
+	return m_pos;
+}
+
+/** File properties **/
+
+/**
+ * Get the file size.
+ * @return File size, or negative on error.
+ */
+off64_t TracingFile::size(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	const uint64_t start = rp_monotonic_time_us();
+	const off64_t ret = m_file->size();
+	const uint64_t end = rp_monotonic_time_us();
+	m_lastError = m_file->lastError();
+
+	Op op;
+	op.timestamp = start - m_start;
+	op.duration = static_cast<uint32_t>(end - start);
+	op.type = OpType::Size;
+	op.phase = m_phase;
+	op.offset = ret;
+	op.size = 0;
+	op.result = 0;
+	op.reread = 0;
+	record(op);
+
+	return ret;
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string TracingFile::filename(void) const
+{
+	return (m_file ? m_file->filename() : string());
+}
+
+/** Tracing **/
+
+/**
+ * Set the current parsing phase.
+ * @param phase Parsing phase.
+ */
+void TracingFile::setPhase(Phase phase)
+{
+	assert(phase >= Phase::Detection && phase < Phase::Max);
+	if (phase >= Phase::Detection && phase < Phase::Max) {
+		m_phase = phase;
+	}
+}
+
+/**
+ * Get the name of a parsing phase.
+ * @param phase Parsing phase.
+ * @return Name, or nullptr if invalid.
+ */
+const char *TracingFile::phaseName(Phase phase)
+{
+	static const char *const phase_names[] = {
+		"detection", "fields", "metadata", "images",
+	};
+	static_assert(ARRAY_SIZE(phase_names) == static_cast<size_t>(Phase::Max),
+		"phase_names[] is out of sync with Phase.");
+
+	assert(phase >= Phase::Detection && phase < Phase::Max);
+	if (phase < Phase::Detection || phase >= Phase::Max)
+		return nullptr;
+	return phase_names[static_cast<size_t>(phase)];
+}
+
+/**
+ * Get the statistics for all parsing phases combined.
+ * @return Statistics.
+ */
+TracingFile::Stats TracingFile::totalStats(void) const
+{
+	Stats total;
+	memset(&total, 0, sizeof(total));
+	for (const Stats &stats : m_stats) {
+		total.reads += stats.reads;
+		total.seeks += stats.seeks;
+		total.small_reads += stats.small_reads;
+		total.bytes_read += stats.bytes_read;
+		total.reread_bytes += stats.reread_bytes;
+		total.io_time += stats.io_time;
+	}
+	return total;
+}
+
+/**
+ * Get the elapsed time since the trace started.
+ * @return Elapsed time, in microseconds.
+ */
+uint64_t TracingFile::elapsed(void) const
+{
+	return rp_monotonic_time_us() - m_start;
+}
+
+/**
+ * Mark a range as read.
+ * @param start Start offset.
+ * @param end End offset. (exclusive)
+ * @return Number of bytes in the range that were already read.
+ */
+uint64_t TracingFile::markRead(off64_t start, off64_t end)
+{
+	if (start >= end)
+		return 0;
+
+	// Find the first range that overlaps or touches [start, end).
+	auto iter = m_readRanges.upper_bound(start);
+	if (iter != m_readRanges.begin()) {
+		auto prev = iter;
+		--prev;
+		if (prev->second >= start) {
+			iter = prev;
+		}
+	}
+
+	// Merge all overlapping and adjacent ranges.
+	uint64_t overlap = 0;
+	off64_t new_start = start;
+	off64_t new_end = end;
+	while (iter != m_readRanges.end() && iter->first <= end) {
+		const off64_t ov_start = std::max(iter->first, start);
+		const off64_t ov_end = std::min(iter->second, end);
+		if (ov_end > ov_start) {
+			overlap += (ov_end - ov_start);
+		}
+		new_start = std::min(new_start, iter->first);
+		new_end = std::max(new_end, iter->second);
+		m_uniqueBytes -= (iter->second - iter->first);
+		iter = m_readRanges.erase(iter);
+	}
+
+	m_readRanges.emplace(new_start, new_end);
+	m_uniqueBytes += (new_end - new_start);
+	return overlap;
+}
+
+/**
+ * Record an operation.
+ * @param op Operation.
+ */
+void TracingFile::record(const Op &op)
+{
+	Stats &stats = m_stats[static_cast<size_t>(op.phase)];
+	switch (op.type) {
+		case OpType::Read:
+			stats.reads++;
+			if (op.size < SMALL_READ_SIZE) {
+				stats.small_reads++;
+			}
+			stats.bytes_read += op.result;
+			stats.reread_bytes += op.reread;
+			break;
+		case OpType::Seek:
+			stats.seeks++;
+			break;
+		default:
+			break;
+	}
+	stats.io_time += op.duration;
+
+	if (m_ops.size() < MAX_OPS) {
+		m_ops.push_back(op);
+	} else {
+		m_opsTruncated = true;
+	}
+}
+
+}
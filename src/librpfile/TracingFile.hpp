@@ -0,0 +1,253 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * TracingFile.hpp: IRpFile wrapper that records all I/O operations.       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_TRACINGFILE_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_TRACINGFILE_HPP__
+
+#include "IRpFile.hpp"
+
+// C++ includes.
+#include <map>
+#include <vector>
+
+namespace LibRpFile {
+
+class TracingFile final : public IRpFile
+{
+	public:
+		/**
+		 * Wrap an IRpFile and record all I/O operations.
+		 *
+		 * NOTE: Classes that check for a specific IRpFile subclass,
+		 * e.g. RpFile for Kreon drive support, won't see the
+		 * underlying file.
+		 *
+		 * @param file Underlying file.
+		 */
+		explicit TracingFile(IRpFile *file);
+	protected:
+		virtual ~TracingFile();	// call unref() instead
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(TracingFile)
+
+	public:
+		/**
+		 * Is the file open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		bool isOpen(void) const final;
+
+		/**
+		 * Close the file.
+		 */
+		void close(void) final;
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size) final;
+
+		/**
+		 * Write data to the file.
+		 * (NOTE: Not valid for TracingFile; this will always return 0.)
+		 * @param ptr Input data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes written.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		size_t write(const void *ptr, size_t size) final;
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos) final;
+
+		/**
+		 * Get the file position.
+		 * @return File position, or -1 on error.
+		 */
+		off64_t tell(void) final;
+
+	public:
+		/** File properties **/
+
+		/**
+		 * Get the file size.
+		 * @return File size, or negative on error.
+		 */
+		off64_t size(void) final;
+
+		/**
+		 * Get the filename.
+		 * @return Filename. (May be empty if the filename is not available.)
+		 */
+		std::string filename(void) const final;
+
+	public:
+		/** Tracing **/
+
+		// Parsing phase that an operation belongs to.
+		// This must be set by the caller.
+		enum class Phase : uint8_t {
+			Detection	= 0,
+			Fields		= 1,
+			Metadata	= 2,
+			Images		= 3,
+
+			Max
+		};
+
+		// Operation type.
+		enum class OpType : uint8_t {
+			Read	= 0,
+			Seek	= 1,
+			Size	= 2,
+		};
+
+		// Recorded operation.
+		struct Op {
+			uint64_t timestamp;	// Start time, in microseconds since the trace started
+			uint32_t duration;	// Duration, in microseconds
+			OpType type;		// Operation type
+			Phase phase;		// Parsing phase
+			off64_t offset;		// Offset (read: start offset; seek: new position)
+			uint32_t size;		// Requested size (read only)
+			uint32_t result;	// Bytes read (read only)
+			uint32_t reread;	// Bytes that were already read by an earlier operation
+		};
+
+		// Per-phase statistics.
+		struct Stats {
+			unsigned int reads;		// Number of read() calls
+			unsigned int seeks;		// Number of seek() calls
+			unsigned int small_reads;	// Number of reads smaller than SMALL_READ_SIZE
+			uint64_t bytes_read;		// Total number of bytes read
+			uint64_t reread_bytes;		// Bytes that were already read by an earlier operation
+			uint64_t io_time;		// Time spent in read() and seek(), in microseconds
+		};
+
+		// Reads smaller than this are counted as small reads.
+		static const uint32_t SMALL_READ_SIZE = 4096;
+
+		// Maximum number of operations to record individually.
+		// Statistics are still updated once this is reached.
+		static const size_t MAX_OPS = 65536;
+
+		/**
+		 * Set the current parsing phase.
+		 * @param phase Parsing phase.
+		 */
+		void setPhase(Phase phase);
+
+		/**
+		 * Get the current parsing phase.
+		 * @return Parsing phase.
+		 */
+		inline Phase phase(void) const
+		{
+			return m_phase;
+		}
+
+		/**
+		 * Get the name of a parsing phase.
+		 * @param phase Parsing phase.
+		 * @return Name, or nullptr if invalid.
+		 */
+		static const char *phaseName(Phase phase);
+
+		/**
+		 * Get the recorded operations.
+		 * @return Recorded operations.
+		 */
+		inline const std::vector<Op> &ops(void) const
+		{
+			return m_ops;
+		}
+
+		/**
+		 * Were operations dropped because MAX_OPS was reached?
+		 * @return True if operations were dropped; false if not.
+		 */
+		inline bool opsTruncated(void) const
+		{
+			return m_opsTruncated;
+		}
+
+		/**
+		 * Get the statistics for a parsing phase.
+		 * @param phase Parsing phase.
+		 * @return Statistics.
+		 */
+		inline const Stats &stats(Phase phase) const
+		{
+			return m_stats[static_cast<size_t>(phase)];
+		}
+
+		/**
+		 * Get the statistics for all parsing phases combined.
+		 * @return Statistics.
+		 */
+		Stats totalStats(void) const;
+
+		/**
+		 * Get the number of unique bytes read.
+		 * @return Number of unique bytes read.
+		 */
+		inline uint64_t uniqueBytes(void) const
+		{
+			return m_uniqueBytes;
+		}
+
+		/**
+		 * Get the elapsed time since the trace started.
+		 * @return Elapsed time, in microseconds.
+		 */
+		uint64_t elapsed(void) const;
+
+	private:
+		/**
+		 * Mark a range as read.
+		 * @param start Start offset.
+		 * @param end End offset. (exclusive)
+		 * @return Number of bytes in the range that were already read.
+		 */
+		uint64_t markRead(off64_t start, off64_t end);
+
+		/**
+		 * Record an operation.
+		 * @param op Operation.
+		 */
+		void record(const Op &op);
+
+	protected:
+		IRpFile *m_file;
+		off64_t m_pos;		// Current position.
+		Phase m_phase;		// Current parsing phase.
+		bool m_opsTruncated;
+
+		uint64_t m_start;	// Start time, in microseconds
+		std::vector<Op> m_ops;
+		Stats m_stats[static_cast<size_t>(Phase::Max)];
+
+		// Ranges that have been read. (key == start, value == end)
+		std::map<off64_t, off64_t> m_readRanges;
+		uint64_t m_uniqueBytes;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_TRACINGFILE_HPP__ */
@@ -0,0 +1,133 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile/tests)                  *
+ * FileSystemTest.cpp: FileSystem tests.                                   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpfile
+#include "librpfile/FileSystem.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+namespace LibRpFile { namespace Tests {
+
+class FileSystemTest : public ::testing::Test
+{
+	protected:
+		FileSystemTest() { }
+
+	public:
+		/**
+		 * Get the isOnBadFS() cache statistics.
+		 * @param pHits		[out] Number of cache hits.
+		 * @param pMisses	[out] Number of cache misses.
+		 */
+		static void getStats(unsigned int *pHits, unsigned int *pMisses)
+		{
+			*pHits = 0;
+			*pMisses = 0;
+			FileSystem::getBadFSCacheStats(pHits, pMisses);
+		}
+};
+
+#ifdef __linux__
+/**
+ * isOnBadFS() should detect procfs as a "bad" file system,
+ * regardless of the netFS parameter.
+ */
+TEST_F(FileSystemTest, isOnBadFS_procfs)
+{
+	EXPECT_TRUE(FileSystem::isOnBadFS("/proc/self/status", false));
+	EXPECT_TRUE(FileSystem::isOnBadFS("/proc/self/status", true));
+}
+
+/**
+ * The isOnBadFS() cache is keyed by device ID, so looking up
+ * a second file on the same device should be a cache hit.
+ */
+TEST_F(FileSystemTest, isOnBadFS_cacheHit)
+{
+	unsigned int hits_before, misses_before;
+	getStats(&hits_before, &misses_before);
+
+	EXPECT_TRUE(FileSystem::isOnBadFS("/proc/self/status"));
+	EXPECT_TRUE(FileSystem::isOnBadFS("/proc/self/stat"));
+
+	unsigned int hits_after, misses_after;
+	getStats(&hits_after, &misses_after);
+	const unsigned int hits = hits_after - hits_before;
+	const unsigned int misses = misses_after - misses_before;
+	if (hits == 0 && misses == 0) {
+		GTEST_SKIP() << "isOnBadFS() cache is disabled. (/proc/self/mountinfo is not available)";
+	}
+
+	// The first lookup may or may not be a hit, depending on
+	// whether or not procfs was looked up by an earlier test.
+	// The second lookup must be a hit.
+	EXPECT_EQ(2U, hits + misses);
+	EXPECT_GE(hits, 1U);
+}
+
+/**
+ * The cached file system type must not depend on the netFS
+ * parameter that was used when the entry was cached.
+ */
+TEST_F(FileSystemTest, isOnBadFS_cacheNetFS)
+{
+	// Populate the cache with netFS == true.
+	const bool bRet1 = FileSystem::isOnBadFS(".", true);
+
+	unsigned int hits_before, misses_before;
+	getStats(&hits_before, &misses_before);
+
+	// netFS == false may return a different result if the
+	// current directory is on a network file system, but
+	// it must use the cached entry.
+	const bool bRet2 = FileSystem::isOnBadFS(".", false);
+	EXPECT_TRUE(!bRet1 || bRet2);
+
+	unsigned int hits_after, misses_after;
+	getStats(&hits_after, &misses_after);
+	if (hits_after == 0 && misses_after == 0) {
+		GTEST_SKIP() << "isOnBadFS() cache is disabled. (/proc/self/mountinfo is not available)";
+	}
+	EXPECT_EQ(hits_before + 1, hits_after);
+	EXPECT_EQ(misses_before, misses_after);
+}
+#else /* !__linux__ */
+/**
+ * isOnBadFS() doesn't use a cache on this platform,
+ * so the statistics should always be zero.
+ */
+TEST_F(FileSystemTest, isOnBadFS_noCache)
+{
+	FileSystem::isOnBadFS(".");
+
+	unsigned int hits, misses;
+	getStats(&hits, &misses);
+	EXPECT_EQ(0U, hits);
+	EXPECT_EQ(0U, misses);
+}
+#endif /* __linux__ */
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpFile test suite: FileSystem tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
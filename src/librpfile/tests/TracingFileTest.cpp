@@ -0,0 +1,268 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile/tests)                  *
+ * TracingFileTest.cpp: TracingFile tests.                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/TracingFile.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+namespace LibRpFile { namespace Tests {
+
+class TracingFileTest : public ::testing::Test
+{
+	protected:
+		TracingFileTest()
+			: m_memFile(nullptr)
+			, m_file(nullptr)
+		{
+			for (size_t i = 0; i < sizeof(m_data); i++) {
+				m_data[i] = static_cast<uint8_t>(i);
+			}
+		}
+
+		void SetUp(void) final
+		{
+			m_memFile = new RpMemFile(m_data, sizeof(m_data));
+			m_file = new TracingFile(m_memFile);
+		}
+
+		void TearDown(void) final
+		{
+			UNREF_AND_NULL(m_file);
+			UNREF_AND_NULL(m_memFile);
+		}
+
+	public:
+		/**
+		 * Read data from the specified offset.
+		 * @param pos Offset.
+		 * @param size Size.
+		 * @return Number of bytes read.
+		 */
+		size_t readAt(off64_t pos, size_t size)
+		{
+			uint8_t buf[sizeof(m_data)];
+			EXPECT_LE(size, sizeof(buf));
+			EXPECT_EQ(0, m_file->seek(pos));
+			return m_file->read(buf, size);
+		}
+
+		/**
+		 * Get the most recently recorded operation.
+		 * @return Most recently recorded operation.
+		 */
+		const TracingFile::Op &lastOp(void) const
+		{
+			return m_file->ops().back();
+		}
+
+	protected:
+		uint8_t m_data[1024];
+		RpMemFile *m_memFile;
+		TracingFile *m_file;
+};
+
+/**
+ * Reads, seeks, and size() calls are recorded with
+ * the correct offsets and sizes.
+ */
+TEST_F(TracingFileTest, recordOps)
+{
+	uint8_t buf[16];
+	EXPECT_EQ(1024, m_file->size());
+	EXPECT_EQ(0, m_file->seek(100));
+	EXPECT_EQ(sizeof(buf), m_file->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[100], sizeof(buf)));
+	EXPECT_EQ(116, m_file->tell());
+
+	const auto &ops = m_file->ops();
+	ASSERT_EQ(3U, ops.size());
+	EXPECT_EQ(TracingFile::OpType::Size, ops[0].type);
+	EXPECT_EQ(1024, ops[0].offset);
+	EXPECT_EQ(TracingFile::OpType::Seek, ops[1].type);
+	EXPECT_EQ(100, ops[1].offset);
+	EXPECT_EQ(TracingFile::OpType::Read, ops[2].type);
+	EXPECT_EQ(100, ops[2].offset);
+	EXPECT_EQ(sizeof(buf), ops[2].size);
+	EXPECT_EQ(sizeof(buf), ops[2].result);
+	EXPECT_EQ(0U, ops[2].reread);
+	EXPECT_FALSE(m_file->opsTruncated());
+}
+
+/**
+ * Reading the same range twice is detected as a re-read.
+ */
+TEST_F(TracingFileTest, reread)
+{
+	EXPECT_EQ(64U, readAt(0, 64));
+	EXPECT_EQ(0U, lastOp().reread);
+	EXPECT_EQ(64U, readAt(0, 64));
+	EXPECT_EQ(64U, lastOp().reread);
+
+	const TracingFile::Stats &stats = m_file->stats(TracingFile::Phase::Detection);
+	EXPECT_EQ(2U, stats.reads);
+	EXPECT_EQ(128U, stats.bytes_read);
+	EXPECT_EQ(64U, stats.reread_bytes);
+	EXPECT_EQ(64U, m_file->uniqueBytes());
+}
+
+/**
+ * Adjacent ranges are merged and aren't counted as re-reads.
+ */
+TEST_F(TracingFileTest, adjacentRanges)
+{
+	EXPECT_EQ(16U, readAt(32, 16));
+	// Adjacent range before the first one.
+	EXPECT_EQ(16U, readAt(0, 16));
+	EXPECT_EQ(0U, lastOp().reread);
+	// Sequential read, continuing from the current position.
+	// This fills the gap between the two ranges.
+	uint8_t buf[16];
+	EXPECT_EQ(sizeof(buf), m_file->read(buf, sizeof(buf)));
+	EXPECT_EQ(16U, lastOp().offset);
+	EXPECT_EQ(0U, lastOp().reread);
+	EXPECT_EQ(48U, m_file->uniqueBytes());
+
+	// Reading the whole merged range is a full re-read.
+	EXPECT_EQ(48U, readAt(0, 48));
+	EXPECT_EQ(48U, lastOp().reread);
+	EXPECT_EQ(48U, m_file->uniqueBytes());
+}
+
+/**
+ * Partially-overlapping ranges only count the overlap as a re-read.
+ */
+TEST_F(TracingFileTest, overlappingRanges)
+{
+	EXPECT_EQ(100U, readAt(0, 100));
+	EXPECT_EQ(100U, readAt(50, 100));
+	EXPECT_EQ(50U, lastOp().reread);
+	EXPECT_EQ(150U, m_file->uniqueBytes());
+
+	// Overlap at the start of an existing range.
+	EXPECT_EQ(100U, readAt(200, 100));
+	EXPECT_EQ(40U, readAt(180, 40));
+	EXPECT_EQ(20U, lastOp().reread);
+	EXPECT_EQ(270U, m_file->uniqueBytes());
+}
+
+/**
+ * A read that spans multiple ranges merges all of them,
+ * and only counts the bytes that were already read.
+ */
+TEST_F(TracingFileTest, intervalMerge)
+{
+	EXPECT_EQ(10U, readAt(0, 10));
+	EXPECT_EQ(10U, readAt(20, 10));
+	EXPECT_EQ(10U, readAt(40, 10));
+	EXPECT_EQ(30U, m_file->uniqueBytes());
+
+	// [5, 45) overlaps [5, 10), [20, 30), and [40, 45).
+	EXPECT_EQ(40U, readAt(5, 40));
+	EXPECT_EQ(20U, lastOp().reread);
+	EXPECT_EQ(50U, m_file->uniqueBytes());
+
+	// Everything in [0, 50) has now been read.
+	EXPECT_EQ(50U, readAt(0, 50));
+	EXPECT_EQ(50U, lastOp().reread);
+	EXPECT_EQ(50U, m_file->uniqueBytes());
+
+	// A range that contains the merged range.
+	EXPECT_EQ(100U, readAt(0, 100));
+	EXPECT_EQ(50U, lastOp().reread);
+	EXPECT_EQ(100U, m_file->uniqueBytes());
+}
+
+/**
+ * Short reads at EOF only mark the bytes that were actually read.
+ */
+TEST_F(TracingFileTest, shortRead)
+{
+	EXPECT_EQ(24U, readAt(1000, 100));
+	EXPECT_EQ(100U, lastOp().size);
+	EXPECT_EQ(24U, lastOp().result);
+	EXPECT_EQ(24U, m_file->uniqueBytes());
+}
+
+/**
+ * Statistics are tracked separately for each phase.
+ */
+TEST_F(TracingFileTest, phases)
+{
+	EXPECT_EQ(16U, readAt(0, 16));
+	m_file->setPhase(TracingFile::Phase::Images);
+	EXPECT_EQ(TracingFile::Phase::Images, m_file->phase());
+	EXPECT_EQ(16U, readAt(0, 16));
+
+	const TracingFile::Stats &det = m_file->stats(TracingFile::Phase::Detection);
+	EXPECT_EQ(1U, det.reads);
+	EXPECT_EQ(1U, det.seeks);
+	EXPECT_EQ(1U, det.small_reads);
+	EXPECT_EQ(0U, det.reread_bytes);
+
+	const TracingFile::Stats &img = m_file->stats(TracingFile::Phase::Images);
+	EXPECT_EQ(1U, img.reads);
+	EXPECT_EQ(1U, img.seeks);
+	EXPECT_EQ(16U, img.reread_bytes);
+	EXPECT_EQ(TracingFile::Phase::Images, lastOp().phase);
+
+	const TracingFile::Stats total = m_file->totalStats();
+	EXPECT_EQ(2U, total.reads);
+	EXPECT_EQ(2U, total.seeks);
+	EXPECT_EQ(32U, total.bytes_read);
+	EXPECT_EQ(16U, total.reread_bytes);
+
+	EXPECT_STREQ("detection", TracingFile::phaseName(TracingFile::Phase::Detection));
+	EXPECT_STREQ("images", TracingFile::phaseName(TracingFile::Phase::Images));
+}
+
+/**
+ * Only MAX_OPS operations are recorded individually,
+ * but the statistics still include all operations.
+ */
+TEST_F(TracingFileTest, maxOps)
+{
+	// NOTE: Copying MAX_OPS to avoid ODR-using it in EXPECT_EQ().
+	const size_t max_ops = TracingFile::MAX_OPS;
+	const unsigned int count = static_cast<unsigned int>(max_ops) + 10;
+	for (unsigned int i = 0; i < count; i++) {
+		m_file->seek(i % sizeof(m_data));
+	}
+
+	EXPECT_EQ(max_ops, m_file->ops().size());
+	EXPECT_TRUE(m_file->opsTruncated());
+	EXPECT_EQ(count, m_file->stats(TracingFile::Phase::Detection).seeks);
+
+	// Reads are still tracked after truncation.
+	uint8_t buf[8];
+	EXPECT_EQ(sizeof(buf), m_file->read(buf, sizeof(buf)));
+	EXPECT_EQ(max_ops, m_file->ops().size());
+	EXPECT_EQ(1U, m_file->stats(TracingFile::Phase::Detection).reads);
+	EXPECT_EQ(8U, m_file->uniqueBytes());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpFile test suite: TracingFile tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -312,6 +312,30 @@ int delete_file(const char *filename)
 	return ret;
 }
 
+/**
+ * Rename a file.
+ * If the new filename already exists, it will be replaced.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename(const string &oldname, const string &newname)
+{
+	if (unlikely(oldname.empty() || newname.empty())) {
+		return -EINVAL;
+	}
+
+	int ret = 0;
+	const tstring toldname = makeWinPath(oldname);
+	const tstring tnewname = makeWinPath(newname);
+	if (!MoveFileEx(toldname.c_str(), tnewname.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		// Error renaming file.
+		ret = -w32err_to_posix(GetLastError());
+	}
+
+	return ret;
+}
+
 /**
  * Check if the specified file is a symbolic link.
  * @return True if the file is a symbolic link; false if not.
@@ -462,6 +486,22 @@ bool isOnBadFS(const char *filename, bool netFS)
 	return false;
 }
 
+/**
+ * Get isOnBadFS() cache statistics.
+ * @param pHits		[out,opt] Number of cache hits.
+ * @param pMisses	[out,opt] Number of cache misses.
+ */
+void getBadFSCacheStats(unsigned int *pHits, unsigned int *pMisses)
+{
+	// isOnBadFS() doesn't use a cache on Windows.
+	if (pHits) {
+		*pHits = 0;
+	}
+	if (pMisses) {
+		*pMisses = 0;
+	}
+}
+
 /**
  * Get a file's size and mtime.
  * @param filename	[in] Filename.
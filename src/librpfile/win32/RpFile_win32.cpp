@@ -7,6 +7,7 @@
  ***************************************************************************/
 
 #include "stdafx.h"
+#include "config.librpfile.h"
 
 #include "../RpFile.hpp"
 #include "../RpFile_p.hpp"
@@ -30,6 +31,11 @@ using std::wstring;
 
 namespace LibRpFile {
 
+#ifdef ENABLE_PROFILING
+// Number of bytes read by RpFile objects on the current thread.
+static RP_THREAD_LOCAL uint64_t tls_bytesRead = 0;
+#endif /* ENABLE_PROFILING */
+
 #ifdef _MSC_VER
 // DelayLoad test implementation.
 DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
@@ -462,13 +468,11 @@ size_t RpFile::read(void *ptr, size_t size)
 		return 0;
 	}
 
+	DWORD bytesRead;
 	if (d->devInfo) {
 		// Block device. Need to read in multiples of the block size.
-		return d->readUsingBlocks(ptr, size);
-	}
-
-	DWORD bytesRead;
-	if (d->gzfd) {
+		bytesRead = static_cast<DWORD>(d->readUsingBlocks(ptr, size));
+	} else if (d->gzfd) {
 		int iret = gzread(d->gzfd, ptr, (unsigned int)size);
 		if (iret >= 0) {
 			bytesRead = (DWORD)iret;
@@ -486,6 +490,9 @@ size_t RpFile::read(void *ptr, size_t size)
 		}
 	}
 
+#ifdef ENABLE_PROFILING
+	tls_bytesRead += bytesRead;
+#endif /* ENABLE_PROFILING */
 	return bytesRead;
 }
 
@@ -773,4 +780,22 @@ int RpFile::makeWritable(void)
 	return 0;
 }
 
+
+/** Profiling **/
+
+/**
+ * Get the number of bytes read by RpFile objects on the calling thread.
+ * NOTE: This is only counted if profiling is enabled at compile time.
+ * Otherwise, this always returns 0.
+ * @return Number of bytes read on the calling thread.
+ */
+uint64_t RpFile::threadBytesRead(void)
+{
+#ifdef ENABLE_PROFILING
+	return tls_bytesRead;
+#else /* !ENABLE_PROFILING */
+	return 0;
+#endif /* ENABLE_PROFILING */
+}
+
 }
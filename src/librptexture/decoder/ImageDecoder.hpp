@@ -24,6 +24,10 @@
 # include "librpcpu/cpuflags_x86.h"
 # define IMAGEDECODER_HAS_SSE2 1
 # define IMAGEDECODER_HAS_SSSE3 1
+/* AVX2 intrinsics require MSVC 2012 or later. */
+# if !defined(_MSC_VER) || _MSC_VER >= 1700
+#  define IMAGEDECODER_HAS_AVX2 1
+# endif
 #endif
 #ifdef RP_CPU_AMD64
 # define IMAGEDECODER_ALWAYS_HAS_SSE2 1
@@ -236,32 +240,24 @@ rp_image *fromLinear16_sse2(PixelFormat px_format,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSE2 */
 
-#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
-
-#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-// System does support IFUNC, but it's always guaranteed to have SSE2.
-// Eliminate the IFUNC dispatch on this system.
-
+#ifdef IMAGEDECODER_HAS_AVX2
 /**
  * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
  * @param px_format	[in] 16-bit pixel format.
  * @param width		[in] Image width.
  * @param height	[in] Image height.
- * @param img_buf	[in] Image buffer.
- * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-static inline rp_image *fromLinear16(PixelFormat px_format,
+rp_image *fromLinear16_avx2(PixelFormat px_format,
 	int width, int height,
-	const uint16_t *img_buf, int img_siz, int stride = 0)
-{
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
-}
-#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
-// System supports IFUNC and is not guaranteed to always have SSE2.
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
 
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 16-bit RGB image to rp_image.
  * @param px_format	[in] 16-bit pixel format.
@@ -272,11 +268,9 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-IFUNC_SSE2_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
-#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
-
 #else /* !RP_HAS_IFUNC or not i386/amd64 */
 // System does not support IFUNC, or we aren't guaranteed to have
 // optimizations for these CPUs. Use standard inline dispatch.
@@ -295,9 +289,16 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear16_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
+	{
+		// amd64 always has SSE2.
+		return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
+	}
 #  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
 #    ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
@@ -427,6 +428,23 @@ rp_image *fromLinear32_ssse3(PixelFormat px_format,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 32-bit RGB image to rp_image.
@@ -459,6 +477,11 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 	int width, int height,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
+#  ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear32_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#  endif /* IMAGEDECODER_HAS_AVX2 */
 #  ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear32_ssse3(px_format, width, height, img_buf, img_siz, stride);
@@ -472,6 +495,42 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 
 /** GameCube **/
 
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_cpp(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSE2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_sse2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
+
 /**
  * Convert a GameCube 16-bit image to rp_image.
  * @param px_format 16-bit pixel format.
@@ -481,9 +540,63 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+static inline rp_image *fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// amd64 always has SSE2.
+	return fromGcn16_sse2(px_format, width, height, img_buf, img_siz);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+IFUNC_SSE2_STATIC_INLINE rp_image *fromGcn16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromGcn16_sse2(px_format, width, height, img_buf, img_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromGcn16_sse2(px_format, width, height, img_buf, img_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromGcn16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#endif /* RP_HAS_IFUNC */
 
 /**
  * Convert a GameCube CI8 image to rp_image.
@@ -577,6 +690,7 @@ rp_image *fromDXT1_GCN(int width, int height,
 /**
  * Convert a DXT1 image to rp_image.
  * S3TC palette index 3 will be interpreted as black.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -585,12 +699,73 @@ rp_image *fromDXT1_GCN(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1(int width, int height,
+rp_image *fromDXT1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+
 /**
  * Convert a DXT1 image to rp_image.
  * S3TC palette index 3 will be interpreted as fully transparent.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -599,9 +774,69 @@ rp_image *fromDXT1(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_A1(int width, int height,
+rp_image *fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_A1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_A1_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+
 /**
  * Convert a DXT2 image to rp_image.
  * @param width Image width.
@@ -614,6 +849,35 @@ ATTR_ACCESS_SIZE(read_only, 3, 4)
 rp_image *fromDXT2(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+/**
+ * Convert a DXT3 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT3_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT3 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT3_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a DXT3 image to rp_image.
  * @param width Image width.
@@ -623,8 +887,34 @@ rp_image *fromDXT2(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT3(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromDXT3(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT3_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT3_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
 /**
  * Convert a DXT4 image to rp_image.
@@ -638,6 +928,50 @@ ATTR_ACCESS_SIZE(read_only, 3, 4)
 rp_image *fromDXT4(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+/**
+ * Convert a DXT5 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT5_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a DXT5 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
 /**
  * Convert a DXT5 image to rp_image.
  * @param width Image width.
@@ -647,9 +981,53 @@ rp_image *fromDXT4(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT5(int width, int height,
+static inline rp_image *fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT5_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * Standard version using regular C++ code.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC4_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC4_ssse3(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a BC4 (ATI1) image to rp_image.
  * Color component is Red.
@@ -661,12 +1039,41 @@ rp_image *fromDXT5(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC4(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromBC4(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC4_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC4_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
 /**
  * Convert a BC5 (ATI2) image to rp_image.
  * Color components are Red and Green.
+ * Standard version using regular C++ code.
  *
  * @param width Image width.
  * @param height Image height.
@@ -675,9 +1082,69 @@ rp_image *fromBC4(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC5(int width, int height,
+rp_image *fromBC5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC5_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
+
 /**
  * Convert a Red image to Luminance.
  * Use with fromBC4() to decode an LATC1 texture.
@@ -865,6 +1332,35 @@ rp_image *fromPVRTCII(int width, int height,
 
 /* BC7 */
 
+/**
+ * Convert a BC7 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_cpp(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC7 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_ssse3(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a BC7 image to rp_image.
  * @param width Image width.
@@ -874,8 +1370,34 @@ rp_image *fromPVRTCII(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC7(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromBC7(int width, int height,
 	const uint8_t *img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC7 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC7_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC7_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
 } }
 
@@ -10,6 +10,7 @@
 
 #include "ImageDecoder.hpp"
 #include "ImageDecoder_p.hpp"
+#include "ImageDecoder_BC7_p.hpp"
 
 // C++ STL classes.
 using std::array;
@@ -241,15 +242,384 @@ static FORCEINLINE void rshift128(uint64_t &msb, uint64_t &lsb, unsigned int sha
 	msb >>= shamt;
 }
 
+/**
+ * Unpack a BC7 block.
+ * @param data		[out] Unpacked block data.
+ * @param bc7_src	[in] BC7 block. (128-bit little-endian)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int decodeBC7Block(bc7_block_data *RESTRICT data, const uint64_t *RESTRICT bc7_src)
+{
+	/** BEGIN: Temporary values. **/
+
+	// Endpoints.
+	// - [8]: Individual endpoints.
+	// - [4]: RGBx components. (idx3 is unused)
+	// NOTE: Endpoints 6 and 7 are never used.
+	// They're kept here because the subset index is 2-bit.
+	union {
+		uint8_t   u8[8][4];
+		uint32_t u32[8];
+	} endpoints;
+
+	// Alpha components.
+	// If no alpha is present, this will be 255.
+	// For modes with alpha components, there is always
+	// one alpha channel per endpoint.
+	uint8_t alpha[4];
+
+	// Anchor indexes.
+	// Subset 0 is always anchored at 0.
+	// Other subsets depend on subset count and partition number.
+	// NOTE: Index 3 is invalid. It's present here for alignment
+	// and because the subset index is 2-bit.
+	uint8_t anchor_index[4];
+	anchor_index[0] = 0;
+
+	/** END: Temporary values. **/
+
+	// BC7 has eight block modes with varying properties, including
+	// bitfields of different lengths. As such, the only guaranteed
+	// block format we have is 128-bit little-endian, which will be
+	// represented as two uint64_t values, which will be shifted
+	// as each component is processed.
+	// TODO: Optimize by using fewer shifts?
+	// TODO: Make sure this is correct on big-endian.
+	uint64_t lsb = le64_to_cpu(bc7_src[0]);
+	uint64_t msb = le64_to_cpu(bc7_src[1]);
+
+	// Check the block mode.
+	const int mode = get_mode(static_cast<uint32_t>(lsb));
+	if (mode < 0) {
+		// Invalid mode.
+		return -EIO;
+	}
+	rshift128(msb, lsb, mode+1);
+
+	// Rotation mode.
+	// Only present in modes 4 and 5.
+	// For all other modes, this is assumed to be 00.
+	// - 00: ARGB - no swapping
+	// - 01: RAGB - swap A and R
+	// - 10: GRAB - swap A and G
+	// - 11: BRGA - swap A and B
+	if (mode == 4 || mode == 5) {
+		data->rotation_mode = lsb & 3;
+		rshift128(msb, lsb, 2);
+	} else {
+		// No rotation.
+		data->rotation_mode = 0;
+	}
+
+	// Index mode selector. (Mode 4 only)
+	uint8_t idxMode_m4 = 0;
+	if (mode == 4) {
+		// Mode 4 has both 2-bit and 3-bit selectors.
+		// The index selection bit determines which is used for
+		// color data and which is used for alpha data:
+		// - idxMode_m4 == 0: Color == 2-bit, Alpha == 3-bit
+		// - idxMode_m4 == 1: Color == 3-bit, Alpha == 2-bit
+		idxMode_m4 = lsb & 1;
+		rshift128(msb, lsb, 1);
+	}
+
+	// Subset/partition.
+	static const uint8_t SubsetCount[8] = {3, 2, 3, 2, 1, 1, 1, 2};
+	static const uint8_t PartitionBits[8] = {4, 6, 6, 6, 0, 0, 0, 6};
+	uint32_t subset = 0;
+	uint8_t partition = 0;
+	if (PartitionBits[mode] != 0) {
+		partition = lsb & ((1U << PartitionBits[mode]) - 1);
+		rshift128(msb, lsb, PartitionBits[mode]);
+
+		// Determine the subset to use.
+		switch (SubsetCount[mode]) {
+			default:
+			case 1:
+				// One subset.
+				subset = 0;
+				break;
+			case 2:
+				// Two subsets.
+				subset = bc7_2sub[partition];
+				break;
+			case 3:
+				// Three subsets.
+				subset = bc7_3sub[partition];
+				break;
+		}
+	} else {
+		// No subsets/partitions.
+		subset = 0;
+	}
+
+	// Number of endpoints.
+	static const uint8_t EndpointCount[8] = {6, 4, 6, 4, 2, 2, 2, 4};
+	// Bits per endpoint component.
+	static const uint8_t EndpointBits[8] = {4, 6, 5, 7, 5, 7, 7, 5};
+
+	// Extract and extend the components.
+	// NOTE: Components are stored in RRRR/GGGG/BBBB/AAAA order.
+	// Needs to be shuffled for RGBA.
+	uint8_t endpoint_bits = EndpointBits[mode];
+	const uint8_t endpoint_count = EndpointCount[mode];
+	const uint8_t endpoint_mask = (1U << endpoint_bits) - 1;
+	const uint8_t endpoint_shamt = 8U - endpoint_bits;
+	const unsigned int component_count = endpoint_count * 3;
+	uint8_t ep_idx = 0, comp_idx = 0;
+	for (unsigned int i = 0; i < component_count; i++) {
+		endpoints.u8[ep_idx][comp_idx] = (lsb & endpoint_mask) << endpoint_shamt;
+		ep_idx++;
+		if (ep_idx == endpoint_count) {
+			// Next component.
+			comp_idx++;
+			ep_idx = 0;
+		}
+
+		// Shift the data over.
+		rshift128(msb, lsb, endpoint_bits);
+	}
+
+	// Do we have alpha components?
+	static const uint8_t AlphaBits[8] = {0, 0, 0, 0, 6, 8, 7, 5};
+	uint8_t alpha_bits = AlphaBits[mode];
+	if (alpha_bits != 0) {
+		// We have alpha components.
+		// TODO: Might not actually be alpha if rotation is enabled...
+		// TODO: Or, rotation might enable alpha...
+		const uint8_t alpha_mask = (1U << alpha_bits) - 1;
+		const uint8_t alpha_shamt = 8U - alpha_bits;
+		for (unsigned int i = 0; i < endpoint_count; i++) {
+			alpha[i] = (lsb & alpha_mask) << alpha_shamt;
+			rshift128(msb, lsb, alpha_bits);
+		}
+	} else {
+		// No alpha. Use 255.
+		alpha[0] = 255;
+		alpha[1] = 255;
+		alpha[2] = 255;
+		alpha[3] = 255;
+	}
+
+	// P-bits.
+	// NOTE: These are applied per subset.
+	// The P-bit count is needed here in order to determine the
+	// shift amount for the endpoints and alpha values.
+	static const uint8_t PBitCount[8] = {1, 1, 0, 1, 0, 0, 1, 1};
+	if (PBitCount[mode] != 0) {
+		// Optimization to avoid having to shift the
+		// whole 64-bit and/or 128-bit value multiple times.
+		unsigned int lsb8 = (lsb & 0xFF);
+		if (mode == 1) {
+			// Mode 1: Two P-bits for four endpoints.
+
+			// Subset 0
+			if (lsb & 1) {
+				endpoints.u32[0] |= 0x02020202;
+				endpoints.u32[1] |= 0x02020202;
+			}
+
+			// Subset 1
+			if (lsb & 2) {
+				endpoints.u32[2] |= 0x02020202;
+				endpoints.u32[3] |= 0x02020202;
+			}
+
+			rshift128(msb, lsb, 2);
+		} else {
+			// Other modes: Unique P-bit for each endpoint.
+			const uint8_t p_ep_shamt = 7 - endpoint_bits;
+			for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
+				if (lsb8 & 1) {
+					endpoints.u32[i] |= (0x01010101 << p_ep_shamt);
+				}
+			}
+
+			if (alpha_bits > 0) {
+				// Apply P-bits to the alpha components.
+				assert(endpoint_count <= ARRAY_SIZE(alpha));
+				const uint8_t p_a_shamt = 7 - alpha_bits;
+				lsb8 = (lsb & 0xFF);
+				for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
+					alpha[i] |= (lsb8 & 1) << p_a_shamt;
+				}
+
+				// Increment the alpha bits to indicate how many bits
+				// need to be copied when expanding the color value.
+				alpha_bits++;
+			}
+
+			rshift128(msb, lsb, endpoint_count);
+		}
+
+		// Increment the endpoint bits to indicate how many bits
+		// need to be copied when expanding the color value.
+		endpoint_bits++;
+	}
+
+	// Expand the endpoints and alpha components.
+	if (endpoint_bits < 8) {
+		for (unsigned int i = 0; i < endpoint_count; i++) {
+			endpoints.u8[i][0] = endpoints.u8[i][0] | (endpoints.u8[i][0] >> endpoint_bits);
+			endpoints.u8[i][1] = endpoints.u8[i][1] | (endpoints.u8[i][1] >> endpoint_bits);
+			endpoints.u8[i][2] = endpoints.u8[i][2] | (endpoints.u8[i][2] >> endpoint_bits);
+		}
+	}
+	if (alpha_bits != 0 && alpha_bits < 8) {
+		for (unsigned int i = 0; i < endpoint_count; i++) {
+			alpha[i] = alpha[i] | (alpha[i] >> alpha_bits);
+		}
+	}
+
+	// Convert the endpoints to ARGB32, one pair per subset.
+	const uint8_t subset_count = SubsetCount[mode];
+	for (unsigned int i = 0; i < subset_count; i++) {
+		const uint8_t *const e0 = endpoints.u8[i*2];
+		const uint8_t *const e1 = endpoints.u8[i*2+1];
+		const uint8_t a0 = (alpha_bits != 0 ? alpha[i*2] : 255);
+		const uint8_t a1 = (alpha_bits != 0 ? alpha[i*2+1] : 255);
+		data->ep0[i] = (a0 << 24) | (e0[0] << 16) | (e0[1] << 8) | e0[2];
+		data->ep1[i] = (a1 << 24) | (e1[0] << 16) | (e1[1] << 8) | e1[2];
+	}
+	for (unsigned int i = subset_count; i < ARRAY_SIZE(data->ep0); i++) {
+		data->ep0[i] = 0;
+		data->ep1[i] = 0;
+	}
+
+	// Bits per index. (either 2 or 3)
+	// NOTE: Most modes don't have the full 32-bit or 48-bit
+	// index table. Missing bits are assumed to be 0.
+	static const uint8_t IndexBits[8] = {3, 3, 2, 2, 0, 2, 4, 2};
+	unsigned int index_bits = IndexBits[mode];
+
+	// At this point, the only remaining data is indexes,
+	// which fits entirely into LSB. Hence, we can stop
+	// using rshift128().
+
+	// EXCEPTION: Mode 4 has both 2-bit *and* 3-bit indexes.
+	// Depending on idxMode_m4, we have to use one or the other.
+	uint64_t idxData;
+	uint8_t index_mask;
+	if (mode == 4) {
+		// Load the color indexes.
+		if (idxMode_m4) {
+			// idxMode is set: Color data uses the 3-bit indexes.
+			// NOTE: We've already shifted by 50 bits by now, so the
+			// MSB contains the high 14 bits of the index data, and
+			// the LSB contains the low 33 bits of the index data.
+			idxData = (msb << 33) | (lsb >> 31);
+			index_bits = 3;
+			index_mask = (1U << 3) - 1;
+		} else {
+			// idxMode is not set: Color data uses the 2-bit indexes.
+			idxData = lsb & ((1U << 31) - 1);
+			index_bits = 2;
+			index_mask = (1U << 2) - 1;
+		}
+	} else {
+		// Use the LSB indexes as-is.
+		idxData = lsb;
+		index_mask = (1U << index_bits) - 1;
+	}
+	data->color_bits = index_bits;
+
+	// Get the anchor indexes.
+	for (unsigned int i = 1; i < subset_count; i++) {
+		anchor_index[i] = getAnchorIndex(partition, i, subset_count);
+	}
+
+	// Process the index data for the color components.
+	uint32_t subsetData = subset;
+	for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
+		const uint8_t subset_idx = subsetData & 3;
+		assert(subset_idx != 3);
+		data->subset[i] = subset_idx;
+		if (i == anchor_index[subset_idx]) {
+			// This is an anchor index.
+			// Highest bit is 0.
+			data->color_idx[i] = idxData & (index_mask >> 1);
+			idxData >>= (index_bits - 1);
+		} else {
+			// Regular index.
+			data->color_idx[i] = idxData & index_mask;
+			idxData >>= index_bits;
+		}
+	}
+
+	// Alpha handling.
+	if (mode == 4) {
+		// Mode 4: Alpha indexes are present.
+		// Load the appropriate indexes based on idxMode.
+		uint8_t index_bits, index_mask;
+		if (idxMode_m4) {
+			// idxMode is set: Alpha data uses the 2-bit indexes.
+			idxData = lsb & ((1U << 31) - 1);
+			index_bits = 2;
+			index_mask = (1U << 2) - 1;
+		} else {
+			// idxMode is not set: Alpha data uses the 3-bit indexes.
+			// NOTE: We've already shifted by 50 bits by now, so the
+			// MSB contains the high 14 bits of the index data, and
+			// the LSB contains the low 33 bits of the index data.
+			idxData = (msb << 33) | (lsb >> 31);
+			index_bits = 3;
+			index_mask = (1U << 3) - 1;
+		}
+		data->alpha_bits = index_bits;
+
+		// NOTE: Mode 4 only has one subset.
+		for (unsigned int i = 0; i < 16; i++) {
+			if (i == 0) {
+				// This is an anchor index.
+				// Highest bit is 0.
+				data->alpha_idx[i] = idxData & (index_mask >> 1);
+				idxData >>= (index_bits - 1);
+			} else {
+				// Regular index.
+				data->alpha_idx[i] = idxData & index_mask;
+				idxData >>= index_bits;
+			}
+		}
+	} else if (alpha_bits == 0) {
+		// No alpha. Endpoint alpha is 255, so index 0 results in 255.
+		data->alpha_bits = 2;
+		memset(data->alpha_idx, 0, sizeof(data->alpha_idx));
+	} else if (mode == 5) {
+		// Mode 5: Separate alpha indexes, stored after the color indexes.
+		// NOTE: Mode 5 only has one subset.
+		data->alpha_bits = index_bits;
+		idxData = lsb >> 31;
+		for (unsigned int i = 0; i < 16; i++) {
+			if (i == 0) {
+				// This is an anchor index.
+				// Highest bit is 0.
+				data->alpha_idx[i] = idxData & (index_mask >> 1);
+				idxData >>= (index_bits - 1);
+			} else {
+				// Regular index.
+				data->alpha_idx[i] = idxData & index_mask;
+				idxData >>= index_bits;
+			}
+		}
+	} else {
+		// Other modes: Same indexes as color data.
+		data->alpha_bits = index_bits;
+		memcpy(data->alpha_idx, data->color_idx, sizeof(data->alpha_idx));
+	}
+
+	return 0;
+}
+
 /**
  * Convert a BC7 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC7 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromBC7(int width, int height,
+rp_image *fromBC7_cpp(int width, int height,
 	const uint8_t *img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -275,7 +645,7 @@ rp_image *fromBC7(int width, int height,
 	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
 
 	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
 		// Could not allocate the image.
 		img->unref();
@@ -287,375 +657,37 @@ rp_image *fromBC7(int width, int height,
 	// Rotation bits makes this difficult...
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
 
-	// BC7 has eight block modes with varying properties, including
-	// bitfields of different lengths. As such, the only guaranteed
-	// block format we have is 128-bit little-endian, which will be
-	// represented as two uint64_t values, which will be shifted
-	// as each component is processed.
-	// TODO: Optimize by using fewer shifts?
 	const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(img_buf);
 
 	// Temporary tile buffer.
 	array<argb32_t, 4*4> tileBuf;
 
-	// Anchor indexes.
-	// Subset 0 is always anchored at 0.
-	// Other subsets depend on subset count and partition number.
-	// NOTE: Index 3 is invalid. It's present here for alignment
-	// and because the subset index is 2-bit.
-	uint8_t anchor_index[4];
-	anchor_index[0] = 0;
-
 	for (unsigned int y = 0; y < tilesY; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, bc7_src += 2) {
-		/** BEGIN: Temporary values. **/
-
-		// Endpoints.
-		// - [8]: Individual endpoints.
-		// - [4]: RGBx components. (idx3 is unused)
-		// NOTE: Endpoints 6 and 7 are never used.
-		// They're kept here because the subset index is 2-bit.
-		union {
-			uint8_t   u8[8][4];
-			uint32_t u32[8];
-		} endpoints;
-
-		// Alpha components.
-		// If no alpha is present, this will be 255.
-		// For modes with alpha components, there is always
-		// one alpha channel per endpoint.
-		uint8_t alpha[4];
-
-		/** END: Temporary values. **/
-
-		// TODO: Make sure this is correct on big-endian.
-		uint64_t lsb = le64_to_cpu(bc7_src[0]);
-		uint64_t msb = le64_to_cpu(bc7_src[1]);
-
-		// Check the block mode.
-		const int mode = get_mode(static_cast<uint32_t>(lsb));
-		if (mode < 0) {
-			// Invalid mode.
+		// Unpack the block.
+		bc7_block_data data;
+		if (decodeBC7Block(&data, bc7_src) != 0) {
+			// Invalid block.
 			img->unref();
 			return nullptr;
 		}
-		rshift128(msb, lsb, mode+1);
-
-		// Rotation mode.
-		// Only present in modes 4 and 5.
-		// For all other modes, this is assumed to be 00.
-		// - 00: ARGB - no swapping
-		// - 01: RAGB - swap A and R
-		// - 10: GRAB - swap A and G
-		// - 11: BRGA - swap A and B
-		uint8_t rotation_mode;
-		if (mode == 4 || mode == 5) {
-			rotation_mode = lsb & 3;
-			rshift128(msb, lsb, 2);
-		} else {
-			// No rotation.
-			rotation_mode = 0;
-		}
-
-		// Index mode selector. (Mode 4 only)
-		uint8_t idxMode_m4 = 0;
-		if (mode == 4) {
-			// Mode 4 has both 2-bit and 3-bit selectors.
-			// The index selection bit determines which is used for
-			// color data and which is used for alpha data:
-			// - idxMode_m4 == 0: Color == 2-bit, Alpha == 3-bit
-			// - idxMode_m4 == 1: Color == 3-bit, Alpha == 2-bit
-			idxMode_m4 = lsb & 1;
-			rshift128(msb, lsb, 1);
-		}
-
-		// Subset/partition.
-		static const uint8_t SubsetCount[8] = {3, 2, 3, 2, 1, 1, 1, 2};
-		static const uint8_t PartitionBits[8] = {4, 6, 6, 6, 0, 0, 0, 6};
-		uint32_t subset = 0;
-		uint8_t partition = 0;
-		if (PartitionBits[mode] != 0) {
-			partition = lsb & ((1U << PartitionBits[mode]) - 1);
-			rshift128(msb, lsb, PartitionBits[mode]);
-
-			// Determine the subset to use.
-			switch (SubsetCount[mode]) {
-				default:
-				case 1:
-					// One subset.
-					subset = 0;
-					break;
-				case 2:
-					// Two subsets.
-					subset = bc7_2sub[partition];
-					break;
-				case 3:
-					// Three subsets.
-					subset = bc7_3sub[partition];
-					break;
-			}
-		} else {
-			// No subsets/partitions.
-			subset = 0;
-		}
-
-		// Number of endpoints.
-		static const uint8_t EndpointCount[8] = {6, 4, 6, 4, 2, 2, 2, 4};
-		// Bits per endpoint component.
-		static const uint8_t EndpointBits[8] = {4, 6, 5, 7, 5, 7, 7, 5};
-
-		// Extract and extend the components.
-		// NOTE: Components are stored in RRRR/GGGG/BBBB/AAAA order.
-		// Needs to be shuffled for RGBA.
-		uint8_t endpoint_bits = EndpointBits[mode];
-		const uint8_t endpoint_count = EndpointCount[mode];
-		const uint8_t endpoint_mask = (1U << endpoint_bits) - 1;
-		const uint8_t endpoint_shamt = 8U - endpoint_bits;
-		const unsigned int component_count = endpoint_count * 3;
-		uint8_t ep_idx = 0, comp_idx = 0;
-		for (unsigned int i = 0; i < component_count; i++) {
-			endpoints.u8[ep_idx][comp_idx] = (lsb & endpoint_mask) << endpoint_shamt;
-			ep_idx++;
-			if (ep_idx == endpoint_count) {
-				// Next component.
-				comp_idx++;
-				ep_idx = 0;
-			}
-
-			// Shift the data over.
-			rshift128(msb, lsb, endpoint_bits);
-		}
-
-		// Do we have alpha components?
-		static const uint8_t AlphaBits[8] = {0, 0, 0, 0, 6, 8, 7, 5};
-		uint8_t alpha_bits = AlphaBits[mode];
-		if (alpha_bits != 0) {
-			// We have alpha components.
-			// TODO: Might not actually be alpha if rotation is enabled...
-			// TODO: Or, rotation might enable alpha...
-			const uint8_t alpha_mask = (1U << alpha_bits) - 1;
-			const uint8_t alpha_shamt = 8U - alpha_bits;
-			for (unsigned int i = 0; i < endpoint_count; i++) {
-				alpha[i] = (lsb & alpha_mask) << alpha_shamt;
-				rshift128(msb, lsb, alpha_bits);
-			}
-		} else {
-			// No alpha. Use 255.
-			alpha[0] = 255;
-			alpha[1] = 255;
-			alpha[2] = 255;
-			alpha[3] = 255;
-		}
-
-		// P-bits.
-		// NOTE: These are applied per subset.
-		// The P-bit count is needed here in order to determine the
-		// shift amount for the endpoints and alpha values.
-		static const uint8_t PBitCount[8] = {1, 1, 0, 1, 0, 0, 1, 1};
-		if (PBitCount[mode] != 0) {
-			// Optimization to avoid having to shift the
-			// whole 64-bit and/or 128-bit value multiple times.
-			unsigned int lsb8 = (lsb & 0xFF);
-			if (mode == 1) {
-				// Mode 1: Two P-bits for four endpoints.
-
-				// Subset 0
-				if (lsb & 1) {
-					endpoints.u32[0] |= 0x02020202;
-					endpoints.u32[1] |= 0x02020202;
-				}
-
-				// Subset 1
-				if (lsb & 2) {
-					endpoints.u32[2] |= 0x02020202;
-					endpoints.u32[3] |= 0x02020202;
-				}
-
-				rshift128(msb, lsb, 2);
-			} else {
-				// Other modes: Unique P-bit for each endpoint.
-				const uint8_t p_ep_shamt = 7 - endpoint_bits;
-				for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
-					if (lsb8 & 1) {
-						endpoints.u32[i] |= (0x01010101 << p_ep_shamt);
-					}
-				}
-
-				if (alpha_bits > 0) {
-					// Apply P-bits to the alpha components.
-					assert(endpoint_count <= ARRAY_SIZE(alpha));
-					const uint8_t p_a_shamt = 7 - alpha_bits;
-					lsb8 = (lsb & 0xFF);
-					for (unsigned int i = 0; i < endpoint_count; i++, lsb8 >>= 1) {
-						alpha[i] |= (lsb8 & 1) << p_a_shamt;
-					}
-
-					// Increment the alpha bits to indicate how many bits
-					// need to be copied when expanding the color value.
-					alpha_bits++;
-				}
-
-				rshift128(msb, lsb, endpoint_count);
-			}
-
-			// Increment the endpoint bits to indicate how many bits
-			// need to be copied when expanding the color value.
-			endpoint_bits++;
-		}
 
-		// Expand the endpoints and alpha components.
-		if (endpoint_bits < 8) {
-			for (unsigned int i = 0; i < endpoint_count; i++) {
-				endpoints.u8[i][0] = endpoints.u8[i][0] | (endpoints.u8[i][0] >> endpoint_bits);
-				endpoints.u8[i][1] = endpoints.u8[i][1] | (endpoints.u8[i][1] >> endpoint_bits);
-				endpoints.u8[i][2] = endpoints.u8[i][2] | (endpoints.u8[i][2] >> endpoint_bits);
-			}
-		}
-		if (alpha_bits != 0 && alpha_bits < 8) {
-			for (unsigned int i = 0; i < endpoint_count; i++) {
-				alpha[i] = alpha[i] | (alpha[i] >> alpha_bits);
-			}
-		}
-
-		// Bits per index. (either 2 or 3)
-		// NOTE: Most modes don't have the full 32-bit or 48-bit
-		// index table. Missing bits are assumed to be 0.
-		static const uint8_t IndexBits[8] = {3, 3, 2, 2, 0, 2, 4, 2};
-		unsigned int index_bits = IndexBits[mode];
-
-		// At this point, the only remaining data is indexes,
-		// which fits entirely into LSB. Hence, we can stop
-		// using rshift128().
-
-		// EXCEPTION: Mode 4 has both 2-bit *and* 3-bit indexes.
-		// Depending on idxMode_m4, we have to use one or the other.
-		uint64_t idxData;
-		uint8_t index_mask;
-		if (mode == 4) {
-			// Load the color indexes.
-			if (idxMode_m4) {
-				// idxMode is set: Color data uses the 3-bit indexes.
-				// NOTE: We've already shifted by 50 bits by now, so the
-				// MSB contains the high 14 bits of the index data, and
-				// the LSB contains the low 33 bits of the index data.
-				idxData = (msb << 33) | (lsb >> 31);
-				index_bits = 3;
-				index_mask = (1U << 3) - 1;
-			} else {
-				// idxMode is not set: Color data uses the 2-bit indexes.
-				idxData = lsb & ((1U << 31) - 1);
-				index_bits = 2;
-				index_mask = (1U << 2) - 1;
-			}
-		} else {
-			// Use the LSB indexes as-is.
-			idxData = lsb;
-			index_mask = (1U << index_bits) - 1;
-		}
-
-		// Get the anchor indexes.
-		const uint8_t subset_count = SubsetCount[mode];
-		for (unsigned int i = 1; i < subset_count; i++) {
-			anchor_index[i] = getAnchorIndex(partition, i, subset_count);
-		}
-
-		// Process the index data for the color components.
-		uint32_t subsetData = subset;
-		for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
-			const uint8_t subset_idx = subsetData & 3;
-			assert(subset_idx != 3);
-			uint8_t data_idx;
-			if (i == anchor_index[subset_idx]) {
-				// This is an anchor index.
-				// Highest bit is 0.
-				data_idx = idxData & (index_mask >> 1);
-				idxData >>= (index_bits - 1);
-			} else {
-				// Regular index.
-				data_idx = idxData & index_mask;
-				idxData >>= index_bits;
-			}
-
-			const uint8_t ep_idx = subset_idx * 2;
-			tileBuf[i].r = interpolate_component(index_bits, data_idx, endpoints.u8[ep_idx][0], endpoints.u8[ep_idx+1][0]);
-			tileBuf[i].g = interpolate_component(index_bits, data_idx, endpoints.u8[ep_idx][1], endpoints.u8[ep_idx+1][1]);
-			tileBuf[i].b = interpolate_component(index_bits, data_idx, endpoints.u8[ep_idx][2], endpoints.u8[ep_idx+1][2]);
-		}
-
-		// Alpha handling.
-		if (mode == 4) {
-			// Mode 4: Alpha indexes are present.
-			// Load the appropriate indexes based on idxMode.
-			uint8_t index_bits, index_mask;
-			if (idxMode_m4) {
-				// idxMode is set: Alpha data uses the 2-bit indexes.
-				idxData = lsb & ((1U << 31) - 1);
-				index_bits = 2;
-				index_mask = (1U << 2) - 1;
-			} else {
-				// idxMode is not set: Alpha data uses the 3-bit indexes.
-				// NOTE: We've already shifted by 50 bits by now, so the
-				// MSB contains the high 14 bits of the index data, and
-				// the LSB contains the low 33 bits of the index data.
-				idxData = (msb << 33) | (lsb >> 31);
-				index_bits = 3;
-				index_mask = (1U << 3) - 1;
-			}
-
-			subsetData = subset;
-			for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
-				const uint8_t subset_idx = subsetData & 3;
-				uint8_t data_idx;
-				if (i == anchor_index[subset_idx]) {
-					// This is an anchor index.
-					// Highest bit is 0.
-					data_idx = idxData & (index_mask >> 1);
-					idxData >>= (index_bits - 1);
-				}
-				else {
-					// Regular index.
-					data_idx = idxData & index_mask;
-					idxData >>= index_bits;
-				}
-
-				tileBuf[i].a = interpolate_component(index_bits, data_idx, alpha[0], alpha[1]);
-			}
-		} else if (alpha_bits == 0) {
-			// No alpha. Assume 255.
-			for (unsigned int i = 0; i < 16; i++) {
-				tileBuf[i].a = 255;
-			}
-		} else {
-			// Process alpha using the index data.
-			if (mode == 5) {
-				// Mode 5: Separate alpha indexes, stored after the color indexes.
-				idxData = lsb >> 31;
-			} else {
-				// Other modes: Same indexes as color data.
-				idxData = lsb;
-			}
-			subsetData = subset;
-			for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
-				const uint8_t subset_idx = subsetData & 3;
-				uint8_t data_idx;
-				if (i == anchor_index[subset_idx]) {
-					// This is an anchor index.
-					// Highest bit is 0.
-					data_idx = idxData & (index_mask >> 1);
-					idxData >>= (index_bits - 1);
-				} else {
-					// Regular index.
-					data_idx = idxData & index_mask;
-					idxData >>= index_bits;
-				}
-
-				const uint8_t ep_idx = subset_idx * 2;
-				tileBuf[i].a = interpolate_component(index_bits, data_idx, alpha[ep_idx], alpha[ep_idx+1]);
-			}
+		// Interpolate the color and alpha components.
+		for (unsigned int i = 0; i < 16; i++) {
+			const uint8_t subset_idx = data.subset[i];
+			argb32_t e0, e1;
+			e0.u32 = data.ep0[subset_idx];
+			e1.u32 = data.ep1[subset_idx];
+
+			const uint8_t color_idx = data.color_idx[i];
+			tileBuf[i].r = interpolate_component(data.color_bits, color_idx, e0.r, e1.r);
+			tileBuf[i].g = interpolate_component(data.color_bits, color_idx, e0.g, e1.g);
+			tileBuf[i].b = interpolate_component(data.color_bits, color_idx, e0.b, e1.b);
+			tileBuf[i].a = interpolate_component(data.alpha_bits, data.alpha_idx[i], e0.a, e1.a);
 		}
 
 		// Component rotation.
-		switch (rotation_mode & 3) {
+		switch (data.rotation_mode & 3) {
 			case 0:
 				// ARGB: No rotation.
 				break;
@@ -0,0 +1,53 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7_p.hpp: Image decoding functions. (BC7) (PRIVATE)       *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_BC7_P_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_BC7_P_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Unpacked BC7 block.
+ *
+ * BC7 blocks have variable-length bitfields, so they're unpacked
+ * by decodeBC7Block() before interpolation. This is shared by the
+ * standard and the SIMD-optimized BC7 decoders.
+ */
+struct bc7_block_data {
+	// Endpoints for each subset, in ARGB32 format.
+	// If the block mode doesn't have alpha, alpha is 255.
+	// NOTE: Subset 3 is never used; it's present for alignment.
+	uint32_t ep0[4];
+	uint32_t ep1[4];
+
+	// Per-pixel values.
+	uint8_t subset[16];	// Subset index
+	uint8_t color_idx[16];	// Color interpolation index
+	uint8_t alpha_idx[16];	// Alpha interpolation index
+
+	uint8_t color_bits;	// Bits per color index (2, 3, 4)
+	uint8_t alpha_bits;	// Bits per alpha index (2, 3, 4)
+	uint8_t rotation_mode;	// Component rotation (0 == none)
+};
+
+/**
+ * Unpack a BC7 block.
+ * @param data		[out] Unpacked block data.
+ * @param bc7_src	[in] BC7 block. (128-bit little-endian)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int decodeBC7Block(bc7_block_data *RESTRICT data, const uint64_t *RESTRICT bc7_src);
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_BC7_P_HPP__ */
@@ -0,0 +1,203 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7_ssse3.cpp: Image decoding functions. (BC7)             *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+#include "ImageDecoder_BC7_p.hpp"
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Get the interpolation weight table for the specified index precision.
+ * Same values as aWeight2[], aWeight3[], and aWeight4[] in ImageDecoder_BC7.cpp.
+ * @param bits Index precision, in number of bits. (2, 3, 4)
+ * @return Weight table.
+ */
+static FORCEINLINE __m128i get_weight_table(unsigned int bits)
+{
+	switch (bits) {
+		case 2:
+			return _mm_setr_epi8(0, 21, 43, 64, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+		case 3:
+			return _mm_setr_epi8(0, 9, 18, 27, 37, 46, 55, 64, 0, 0, 0, 0, 0, 0, 0, 0);
+		default:
+			assert(bits == 4);
+			return _mm_setr_epi8(0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64);
+	}
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * SSSE3-optimized version.
+ *
+ * Block headers, endpoints, and indexes are unpacked using the
+ * same code as the standard version. Interpolation, rotation,
+ * and storing the pixels are done four pixels at a time.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7_ssse3(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC7 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// sBIT metadata.
+	// TODO: Dynamically determine if we have alpha?
+	// Rotation bits makes this difficult...
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+
+	const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(img_buf);
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	// Shuffle masks.
+	// - px_rep: Replicate a per-pixel byte to all four bytes of a pixel.
+	// - px_ofs: Byte offsets within each pixel.
+	// - wc_rep: Replicate the color weight to B, G, and R.
+	// - wa_rep: Copy the alpha weight to A.
+	// NOTE: Adding the row offset to 0x80 keeps the high bit set,
+	// so those bytes are still zeroed by pshufb.
+	const char z = static_cast<char>(0x80);
+	const __m128i px_rep = _mm_setr_epi8(0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3);
+	const __m128i px_ofs = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	const __m128i wc_rep = _mm_setr_epi8(0,0,0,z, 1,1,1,z, 2,2,2,z, 3,3,3,z);
+	const __m128i wa_rep = _mm_setr_epi8(z,z,z,0, z,z,z,1, z,z,z,2, z,z,z,3);
+	const __m128i w64 = _mm_set1_epi8(64);
+	const __m128i rnd32 = _mm_set1_epi16(32);
+
+	// Component rotation shuffle masks.
+	// Index is the rotation mode.
+	const __m128i rotation[4] = {
+		// ARGB: No rotation.
+		_mm_setr_epi8(0,1,2,3, 4,5,6,7, 8,9,10,11, 12,13,14,15),
+		// RAGB: Swap A and R.
+		_mm_setr_epi8(0,1,3,2, 4,5,7,6, 8,9,11,10, 12,13,15,14),
+		// GRAB: Swap A and G.
+		_mm_setr_epi8(0,3,2,1, 4,7,6,5, 8,11,10,9, 12,15,14,13),
+		// BRGA: Swap A and B.
+		_mm_setr_epi8(3,1,2,0, 7,5,6,4, 11,9,10,8, 15,13,14,12),
+	};
+
+	for (unsigned int y = tilesY; y > 0; y--, px_dest += (stride_px * 4) - (tilesX * 4)) {
+	for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, bc7_src += 2) {
+		// Unpack the block.
+		bc7_block_data data;
+		if (decodeBC7Block(&data, bc7_src) != 0) {
+			// Invalid block.
+			img->unref();
+			return nullptr;
+		}
+
+		// Endpoint tables, indexed by subset * 4.
+		const __m128i ep0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.ep0));
+		const __m128i ep1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.ep1));
+		const __m128i subset4 = _mm_slli_epi16(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(data.subset)), 2);
+
+		// Per-pixel interpolation weights.
+		const __m128i wc = _mm_shuffle_epi8(get_weight_table(data.color_bits),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(data.color_idx)));
+		const __m128i wa = _mm_shuffle_epi8(get_weight_table(data.alpha_bits),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(data.alpha_idx)));
+
+		const __m128i rot = rotation[data.rotation_mode & 3];
+		uint32_t *px_row = px_dest;
+		for (unsigned int row = 0; row < 4; row++, px_row += stride_px) {
+			const __m128i row_ofs = _mm_set1_epi8(static_cast<char>(row * 4));
+
+			// Look up the endpoints for each pixel.
+			const __m128i ctrl = _mm_or_si128(
+				_mm_shuffle_epi8(subset4, _mm_add_epi8(px_rep, row_ofs)), px_ofs);
+			const __m128i e0 = _mm_shuffle_epi8(ep0, ctrl);
+			const __m128i e1 = _mm_shuffle_epi8(ep1, ctrl);
+
+			// Weights for each component.
+			const __m128i w = _mm_or_si128(
+				_mm_shuffle_epi8(wc, _mm_add_epi8(wc_rep, row_ofs)),
+				_mm_shuffle_epi8(wa, _mm_add_epi8(wa_rep, row_ofs)));
+			const __m128i wi = _mm_sub_epi8(w64, w);
+
+			// ((64 - w) * e0 + w * e1 + 32) >> 6
+			// NOTE: pmaddubsw treats the weights as signed,
+			// but they're always <= 64, so this is fine.
+			__m128i lo = _mm_maddubs_epi16(_mm_unpacklo_epi8(e0, e1), _mm_unpacklo_epi8(wi, w));
+			__m128i hi = _mm_maddubs_epi16(_mm_unpackhi_epi8(e0, e1), _mm_unpackhi_epi8(wi, w));
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, rnd32), 6);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, rnd32), 6);
+
+			// Component rotation.
+			const __m128i px = _mm_shuffle_epi8(_mm_packus_epi16(lo, hi), rot);
+
+			// NOTE: rp_image rows might not be 16-byte aligned
+			// if a custom backend is in use.
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(px_row), px);
+		}
+	} }
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -0,0 +1,256 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_GCN_sse2.cpp: Image decoding functions. (GameCube)         *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Byteswap eight big-endian 16-bit pixels to host-endian.
+ * @param px	[in] Big-endian pixels.
+ * @return Host-endian pixels.
+ */
+static FORCEINLINE __m128i be16_to_cpu_sse2(__m128i px)
+{
+	return _mm_or_si128(_mm_slli_epi16(px, 8), _mm_srli_epi16(px, 8));
+}
+
+/**
+ * Convert eight RGB565 pixels to ARGB32. (SSE2 version)
+ * @param px	[in] Big-endian RGB565 pixels.
+ * @param sGB	[out] GB words. (G in the high byte, B in the low byte)
+ * @param sAR	[out] AR words. (A in the high byte, R in the low byte)
+ */
+static FORCEINLINE void RGB565_to_ARGB32_sse2(__m128i px, __m128i &sGB, __m128i &sAR)
+{
+	const __m128i Mask565_Hi5  = _mm_set1_epi16(0xF800);
+	const __m128i Mask565_Mid6 = _mm_set1_epi16(0x07E0);
+	const __m128i Mask565_Lo5  = _mm_set1_epi16(0x001F);
+	const __m128i Mask_Hi8     = _mm_set1_epi16(0xFF00);
+
+	px = be16_to_cpu_sse2(px);
+
+	// RGB565: RRRRRGGG GGGBBBBB
+	__m128i sR = _mm_srli_epi16(_mm_and_si128(px, Mask565_Hi5), 8);
+	__m128i sG = _mm_slli_epi16(_mm_and_si128(px, Mask565_Mid6), 5);
+	__m128i sB = _mm_slli_epi16(_mm_and_si128(px, Mask565_Lo5), 3);
+
+	// Expand from 5/6-bit to 8-bit.
+	sR = _mm_or_si128(sR, _mm_srli_epi16(sR, 5));
+	sG = _mm_and_si128(_mm_or_si128(sG, _mm_srli_epi16(sG, 6)), Mask_Hi8);
+	sB = _mm_or_si128(sB, _mm_srli_epi16(sB, 5));
+
+	sGB = _mm_or_si128(sG, sB);
+	sAR = _mm_or_si128(sR, Mask_Hi8);
+}
+
+/**
+ * Convert eight RGB5A3 pixels to ARGB32. (SSE2 version)
+ * @param px	[in] Big-endian RGB5A3 pixels.
+ * @param sGB	[out] GB words. (G in the high byte, B in the low byte)
+ * @param sAR	[out] AR words. (A in the high byte, R in the low byte)
+ */
+static FORCEINLINE void RGB5A3_to_ARGB32_sse2(__m128i px, __m128i &sGB, __m128i &sAR)
+{
+	const __m128i Mask555_Hi5  = _mm_set1_epi16(0x7C00);
+	const __m128i Mask555_Mid5 = _mm_set1_epi16(0x03E0);
+	const __m128i Mask555_Lo5  = _mm_set1_epi16(0x001F);
+	const __m128i Mask4A3_A3   = _mm_set1_epi16(0x7000);
+	const __m128i Mask4A3_Nyb2 = _mm_set1_epi16(0x0F00);
+	const __m128i Mask4A3_Nyb1 = _mm_set1_epi16(0x00F0);
+	const __m128i Mask4A3_Nyb0 = _mm_set1_epi16(0x000F);
+	const __m128i Mask_Hi8     = _mm_set1_epi16(0xFF00);
+
+	px = be16_to_cpu_sse2(px);
+
+	// If the high bit is set, the pixel is RGB555.
+	// Otherwise, the pixel is RGB4A3.
+	const __m128i is555 = _mm_srai_epi16(px, 15);
+
+	/** RGB555: xRRRRRGG GGGBBBBB **/
+	__m128i sR555 = _mm_srli_epi16(_mm_and_si128(px, Mask555_Hi5), 7);
+	__m128i sG555 = _mm_slli_epi16(_mm_and_si128(px, Mask555_Mid5), 6);
+	__m128i sB555 = _mm_slli_epi16(_mm_and_si128(px, Mask555_Lo5), 3);
+	// Expand from 5-bit to 8-bit.
+	sR555 = _mm_or_si128(sR555, _mm_srli_epi16(sR555, 5));
+	sG555 = _mm_and_si128(_mm_or_si128(sG555, _mm_srli_epi16(sG555, 5)), Mask_Hi8);
+	sB555 = _mm_or_si128(sB555, _mm_srli_epi16(sB555, 5));
+	const __m128i sGB555 = _mm_or_si128(sG555, sB555);
+	const __m128i sAR555 = _mm_or_si128(sR555, Mask_Hi8);
+
+	/** RGB4A3: xAAARRRR GGGGBBBB **/
+	// Copy each nybble to the high nybble.
+	__m128i sGB4A3 = _mm_or_si128(
+		_mm_slli_epi16(_mm_and_si128(px, Mask4A3_Nyb1), 4),
+		_mm_and_si128(px, Mask4A3_Nyb0));
+	sGB4A3 = _mm_or_si128(sGB4A3, _mm_slli_epi16(sGB4A3, 4));
+	__m128i sR4A3 = _mm_srli_epi16(_mm_and_si128(px, Mask4A3_Nyb2), 8);
+	sR4A3 = _mm_or_si128(sR4A3, _mm_slli_epi16(sR4A3, 4));
+	// Expand the 3-bit alpha channel to 8-bit.
+	// Equivalent to a3_lookup[]: (a3 << 5) | (a3 << 2) | (a3 >> 1)
+	const __m128i sA3 = _mm_and_si128(px, Mask4A3_A3);
+	__m128i sA4A3 = _mm_or_si128(_mm_slli_epi16(sA3, 1), _mm_srli_epi16(sA3, 2));
+	sA4A3 = _mm_and_si128(_mm_or_si128(sA4A3, _mm_srli_epi16(sA3, 5)), Mask_Hi8);
+	const __m128i sAR4A3 = _mm_or_si128(sA4A3, sR4A3);
+
+	// Select RGB555 or RGB4A3 for each pixel.
+	sGB = _mm_or_si128(_mm_and_si128(is555, sGB555), _mm_andnot_si128(is555, sGB4A3));
+	sAR = _mm_or_si128(_mm_and_si128(is555, sAR555), _mm_andnot_si128(is555, sAR4A3));
+}
+
+/**
+ * Convert eight IA8 pixels to ARGB32. (SSE2 version)
+ * @param px	[in] Big-endian IA8 pixels.
+ * @param sGB	[out] GB words. (G in the high byte, B in the low byte)
+ * @param sAR	[out] AR words. (A in the high byte, R in the low byte)
+ */
+static FORCEINLINE void IA8_to_ARGB32_sse2(__m128i px, __m128i &sGB, __m128i &sAR)
+{
+	const __m128i Mask_Lo8 = _mm_set1_epi16(0x00FF);
+
+	// IA8: IIIIIIII AAAAAAAA (big-endian)
+	// Without byteswapping, each word is already [AA II],
+	// which is the AR word. GB is [II II].
+	const __m128i sI = _mm_and_si128(px, Mask_Lo8);
+	sGB = _mm_or_si128(sI, _mm_slli_epi16(sI, 8));
+	sAR = px;
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSE2-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_sse2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube RGB5A3 uses 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+
+	// Each 4x4 tile is 32 bytes, which is two SSE2 registers.
+	// Each register contains two rows of the tile, so the
+	// converted pixels can be written directly to the image
+	// instead of using a temporary tile buffer.
+	// NOTE: The source buffer might not be 16-byte aligned,
+	// and custom rp_image backends might not have 16-byte
+	// aligned rows, so unaligned loads and stores are used.
+	const int dest_stride = img->stride() / sizeof(uint32_t);
+	uint32_t *const px_dest_base = static_cast<uint32_t*>(img->bits());
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+
+	// Macro for the tile loop.
+#define fromGcn16_convert(fmt) \
+	do { \
+		for (unsigned int y = 0; y < tilesY; y++) { \
+			uint32_t *px_dest = px_dest_base + (y * 4 * dest_stride); \
+			for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, xmm_src += 2) { \
+				__m128i sGB, sAR; \
+				\
+				/* Rows 0 and 1 */ \
+				fmt##_to_ARGB32_sse2(_mm_loadu_si128(&xmm_src[0]), sGB, sAR); \
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest), _mm_unpacklo_epi16(sGB, sAR)); \
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest + dest_stride), _mm_unpackhi_epi16(sGB, sAR)); \
+				\
+				/* Rows 2 and 3 */ \
+				fmt##_to_ARGB32_sse2(_mm_loadu_si128(&xmm_src[1]), sGB, sAR); \
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest + dest_stride*2), _mm_unpacklo_epi16(sGB, sAR)); \
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest + dest_stride*3), _mm_unpackhi_epi16(sGB, sAR)); \
+			} \
+		} \
+	} while (0)
+
+	switch (px_format) {
+		case PixelFormat::RGB5A3: {
+			fromGcn16_convert(RGB5A3);
+			// Set the sBIT metadata.
+			// NOTE: Pixels may be RGB555 or ARGB4444.
+			// We'll use 555 for RGB, and 4 for alpha.
+			// TODO: Set alpha to 0 if no translucent pixels were found.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PixelFormat::RGB565: {
+			fromGcn16_convert(RGB565);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PixelFormat::IA8: {
+			fromGcn16_convert(IA8);
+			// Set the sBIT metadata.
+			// NOTE: Setting the grayscale value, though we're
+			// not saving grayscale PNGs at the moment.
+			static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
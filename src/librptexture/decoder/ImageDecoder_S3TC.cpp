@@ -10,6 +10,7 @@
 
 #include "ImageDecoder.hpp"
 #include "ImageDecoder_p.hpp"
+#include "ImageDecoder_S3TC_p.hpp"
 
 #include "PixelConversion.hpp"
 using namespace LibRpTexture::PixelConversion;
@@ -31,23 +32,6 @@ using std::array;
 
 namespace LibRpTexture { namespace ImageDecoder {
 
-// DXT1 block format.
-struct dxt1_block {
-	uint16_t color[2];	// Colors 0 and 1, in RGB565 format.
-	uint32_t indexes;	// Two-bit color indexes.
-};
-ASSERT_STRUCT(dxt1_block, 8);
-
-// DXT5 alpha+codes struct.
-// Also used by BC4/BC5 for color channels.
-union dxt5_alpha {
-	struct {
-		uint8_t values[2];	// Alpha values.
-		uint8_t codes[6];	// Alpha operation codes. (48-bit unsigned; 3-bit per pixel)
-	};
-	uint64_t u64;	// Access the 48-bit code value directly. (Requires shifting.)
-};
-
 /**
  * Extract the 48-bit code value from dxt5_alpha.
  * @param data dxt5_alpha.
@@ -61,13 +45,6 @@ static FORCEINLINE uint64_t extract48(const dxt5_alpha *RESTRICT data)
 	return le64_to_cpu(data->u64) >> 16;
 }
 
-// decode_DXTn_tile_color_palette flags.
-enum DXTn_Palette_Flags {
-	DXTn_PALETTE_BIG_ENDIAN		= (1U << 0),
-	DXTn_PALETTE_COLOR3_ALPHA	= (1U << 1),	// GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
-	DXTn_PALETTE_COLOR0_LE_COLOR1	= (1U << 2),	// Assume color0 <= color1. (DXT2/DXT3)
-};
-
 /**
  * Decode a DXTn tile color palette. (S3TC version)
  * @tparam flags Flags. (See DXTn_Palette_Flags)
@@ -348,6 +325,7 @@ static rp_image *T_fromDXT1(int width, int height,
 
 /**
  * Convert a DXT1 image to rp_image.
+ * Standard version using regular C++ code.
  * S3TC palette index 3 will be interpreted as black.
  *
  * @param width Image width.
@@ -356,7 +334,7 @@ static rp_image *T_fromDXT1(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT1(int width, int height,
+rp_image *fromDXT1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	return T_fromDXT1<0>(width, height, img_buf, img_siz);
@@ -364,6 +342,7 @@ rp_image *fromDXT1(int width, int height,
 
 /**
  * Convert a DXT1 image to rp_image.
+ * Standard version using regular C++ code.
  * S3TC palette index 3 will be interpreted as fully transparent.
  *
  * @param width Image width.
@@ -372,7 +351,7 @@ rp_image *fromDXT1(int width, int height,
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT1_A1(int width, int height,
+rp_image *fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	return T_fromDXT1<DXTn_PALETTE_COLOR3_ALPHA>(width, height, img_buf, img_siz);
@@ -409,13 +388,14 @@ rp_image *fromDXT2(int width, int height,
 
 /**
  * Convert a DXT3 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT3 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT3(int width, int height,
+rp_image *fromDXT3_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -444,12 +424,6 @@ rp_image *fromDXT3(int width, int height,
 		return nullptr;
 	}
 
-	// DXT3 block format.
-	struct dxt3_block {
-		uint64_t alpha;		// Alpha values. (4-bit per pixel)
-		dxt1_block colors;	// DXT1-style color block.
-	};
-	ASSERT_STRUCT(dxt3_block, 16);
 	const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(img_buf);
 
 	// Calculate the total number of tiles.
@@ -526,13 +500,14 @@ rp_image *fromDXT4(int width, int height,
 
 /**
  * Convert a DXT5 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf DXT5 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDXT5(int width, int height,
+rp_image *fromDXT5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -561,12 +536,6 @@ rp_image *fromDXT5(int width, int height,
 		return nullptr;
 	}
 
-	// DXT5 block format.
-	struct dxt5_block {
-		dxt5_alpha alpha;
-		dxt1_block colors;	// DXT1-style color block.
-	};
-	ASSERT_STRUCT(dxt5_block, 16);
 	const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(img_buf);
 
 	// Calculate the total number of tiles.
@@ -613,13 +582,14 @@ rp_image *fromDXT5(int width, int height,
 
 /**
  * Convert a BC4 (ATI1) image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC4 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromBC4(int width, int height,
+rp_image *fromBC4_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -648,11 +618,6 @@ rp_image *fromBC4(int width, int height,
 		return nullptr;
 	}
 
-	// BC4 block format.
-	struct bc4_block {
-		dxt5_alpha red;
-	};
-	ASSERT_STRUCT(bc4_block, 8);
 	const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(img_buf);
 
 	// Calculate the total number of tiles.
@@ -701,13 +666,14 @@ rp_image *fromBC4(int width, int height,
 
 /**
  * Convert a BC5 (ATI2) image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf BC5 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromBC5(int width, int height,
+rp_image *fromBC5_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -736,17 +702,11 @@ rp_image *fromBC5(int width, int height,
 		return nullptr;
 	}
 
-	// BC5 block format.
-	struct bc5_block {
-		dxt5_alpha red;
-		dxt5_alpha green;
-	};
-	ASSERT_STRUCT(bc5_block, 16);
 	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf);
 
 	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
 
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
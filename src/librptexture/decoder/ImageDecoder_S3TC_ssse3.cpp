@@ -0,0 +1,572 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC_ssse3.cpp: Image decoding functions. (S3TC)           *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+#include "ImageDecoder_S3TC_p.hpp"
+
+#include "PixelConversion.hpp"
+using namespace LibRpTexture::PixelConversion;
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+// Each 4x4 block is decoded entirely in SSE registers:
+// - Indexes are expanded to one byte per pixel.
+// - Palettes are stored in a single register and looked up using pshufb.
+// - Each row of the block is written directly to the rp_image,
+//   so no temporary tile buffer is needed.
+// Output is bit-identical to the standard version.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Expand 16 2-bit indexes to one byte per pixel.
+ * @param indexes 2-bit indexes. (pixel 0 is in the LSBs)
+ * @return Indexes, one per byte.
+ */
+static FORCEINLINE __m128i expand_2bit_indexes(uint32_t indexes)
+{
+	const __m128i mask_nybble = _mm_set1_epi8(0x0F);
+	const __m128i mask_2bit = _mm_set1_epi8(0x03);
+
+	// Split into nybbles. Each nybble contains two pixels.
+	const __m128i v = _mm_cvtsi32_si128(static_cast<int>(indexes));
+	const __m128i nybbles = _mm_unpacklo_epi8(
+		_mm_and_si128(v, mask_nybble),
+		_mm_and_si128(_mm_srli_epi16(v, 4), mask_nybble));
+
+	// Split the nybbles into 2-bit indexes.
+	return _mm_unpacklo_epi8(
+		_mm_and_si128(nybbles, mask_2bit),
+		_mm_and_si128(_mm_srli_epi16(nybbles, 2), mask_2bit));
+}
+
+/**
+ * Expand 16 3-bit indexes from a dxt5_alpha block to one byte per pixel.
+ * @param block dxt5_alpha block, loaded into the low 64 bits.
+ * @return Indexes, one per byte.
+ */
+static FORCEINLINE __m128i expand_3bit_indexes(__m128i block)
+{
+	// The 48-bit code value starts at byte 2.
+	// Each group of 8 indexes is 24 bits, so copy the two bytes
+	// containing each index into a 16-bit lane, then use a
+	// multiply to emulate a per-lane variable left shift that
+	// moves each index to bits 8-10.
+	// NOTE: Byte 8 is past the block, but it's zero in the register.
+	const __m128i shuf_lo = _mm_setr_epi8(2,3, 2,3, 2,3, 3,4, 3,4, 3,4, 4,5, 4,5);
+	const __m128i shuf_hi = _mm_setr_epi8(5,6, 5,6, 5,6, 6,7, 6,7, 6,7, 7,8, 7,8);
+	const __m128i mult = _mm_setr_epi16(1<<8, 1<<5, 1<<2, 1<<7, 1<<4, 1<<1, 1<<6, 1<<3);
+	const __m128i mask_3bit = _mm_set1_epi16(0x0007);
+
+	__m128i lo = _mm_mullo_epi16(_mm_shuffle_epi8(block, shuf_lo), mult);
+	__m128i hi = _mm_mullo_epi16(_mm_shuffle_epi8(block, shuf_hi), mult);
+	lo = _mm_and_si128(_mm_srli_epi16(lo, 8), mask_3bit);
+	hi = _mm_and_si128(_mm_srli_epi16(hi, 8), mask_3bit);
+	return _mm_packus_epi16(lo, hi);
+}
+
+/**
+ * Expand 16 4-bit DXT3 alpha values to 8-bit, one byte per pixel.
+ * @param alpha 4-bit alpha values. (pixel 0 is in the low nybble)
+ * @return Alpha values, one per byte.
+ */
+static FORCEINLINE __m128i expand_DXT3_alpha(uint64_t alpha)
+{
+	const __m128i mask_nybble = _mm_set1_epi8(0x0F);
+
+	const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&alpha));
+	const __m128i nybbles = _mm_unpacklo_epi8(
+		_mm_and_si128(v, mask_nybble),
+		_mm_and_si128(_mm_srli_epi16(v, 4), mask_nybble));
+
+	// Copy the low nybble to the high nybble.
+	return _mm_or_si128(nybbles, _mm_slli_epi16(nybbles, 4));
+}
+
+/**
+ * Decode a DXTn tile color palette. (S3TC version)
+ * @tparam flags Flags. (See DXTn_Palette_Flags; big-endian is not supported.)
+ * @param dxt1_src	[in] DXT1 block.
+ * @return Four ARGB32 colors.
+ */
+template<unsigned int flags>
+static FORCEINLINE __m128i decode_DXTn_tile_color_palette_S3TC(const dxt1_block *RESTRICT dxt1_src)
+{
+	static_assert(!(flags & DXTn_PALETTE_BIG_ENDIAN), "Big-endian palettes are not supported here.");
+
+	// Convert the first two colors from RGB565.
+	const uint16_t c0 = le16_to_cpu(dxt1_src->color[0]);
+	const uint16_t c1 = le16_to_cpu(dxt1_src->color[1]);
+	const __m128i pal01 = _mm_set_epi32(0, 0, RGB565_to_ARGB32(c1), RGB565_to_ARGB32(c0));
+
+	// Unpack to 16-bit components:
+	// - p01: [c0.b c0.g c0.r c0.a c1.b c1.g c1.r c1.a]
+	// - p10: [c1.b c1.g c1.r c1.a c0.b c0.g c0.r c0.a]
+	const __m128i p01 = _mm_unpacklo_epi8(pal01, _mm_setzero_si128());
+	const __m128i p10 = _mm_shuffle_epi32(p01, _MM_SHUFFLE(1,0,3,2));
+
+	// Calculate the second two colors.
+	// NOTE: Alpha is 255 for both colors, so it's still 255 here.
+	__m128i pal23;
+	if (!(flags & DXTn_PALETTE_COLOR0_LE_COLOR1) && (c0 > c1)) {
+		// color0 > color1
+		// pal2 = ((2 * c0) + c1) / 3
+		// pal3 = ((2 * c1) + c0) / 3
+		// NOTE: x * 0x5556 >> 16 == x / 3 for x <= 765.
+		pal23 = _mm_add_epi16(_mm_add_epi16(p01, p01), p10);
+		pal23 = _mm_mulhi_epu16(pal23, _mm_set1_epi16(0x5556));
+		pal23 = _mm_packus_epi16(pal23, pal23);
+	} else {
+		// color0 <= color1
+		// pal2 = (c0 + c1) / 2
+		// pal3 = black and/or transparent
+		pal23 = _mm_srli_epi16(_mm_add_epi16(p01, p10), 1);
+		pal23 = _mm_packus_epi16(pal23, pal23);
+		pal23 = _mm_unpacklo_epi32(pal23, _mm_cvtsi32_si128(
+			(flags & DXTn_PALETTE_COLOR3_ALPHA) ? 0x00000000 : 0xFF000000));
+	}
+
+	return _mm_unpacklo_epi64(pal01, pal23);
+}
+
+/**
+ * Decode a DXT5 alpha "palette".
+ * Also used for BC4/BC5 color channels.
+ * @param values Two-element alpha array from dxt5_alpha.
+ * @return Eight alpha values in the low 64 bits.
+ */
+static FORCEINLINE __m128i decode_DXT5_alpha_palette_S3TC(const uint8_t *RESTRICT values)
+{
+	const __m128i a0 = _mm_set1_epi16(values[0]);
+	const __m128i a1 = _mm_set1_epi16(values[1]);
+
+	// Weights for alpha[0] and alpha[1], then divide.
+	// NOTE: x * 9363 >> 16 == x / 7 for x <= 1785.
+	// NOTE: x * 13108 >> 16 == x / 5 for x <= 1275.
+	__m128i pal;
+	if (values[0] > values[1]) {
+		pal = _mm_add_epi16(
+			_mm_mullo_epi16(a0, _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1)),
+			_mm_mullo_epi16(a1, _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6)));
+		pal = _mm_mulhi_epu16(pal, _mm_set1_epi16(9363));
+	} else {
+		pal = _mm_add_epi16(
+			_mm_mullo_epi16(a0, _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0)),
+			_mm_mullo_epi16(a1, _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0)));
+		pal = _mm_mulhi_epu16(pal, _mm_set1_epi16(13108));
+		// Index 6 is 0; index 7 is 255.
+		pal = _mm_or_si128(pal, _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255));
+	}
+
+	return _mm_packus_epi16(pal, pal);
+}
+
+/**
+ * Look up four pixels in a four-color palette.
+ * @param pal Four ARGB32 colors.
+ * @param idx4 Color indexes for all 16 pixels, multiplied by 4.
+ * @param row Row number. (0-3)
+ * @return Four ARGB32 pixels.
+ */
+static FORCEINLINE __m128i lookup_row(__m128i pal, __m128i idx4, unsigned int row)
+{
+	const __m128i row_ofs = _mm_set1_epi8(static_cast<char>(row * 4));
+	const __m128i rep = _mm_add_epi8(_mm_setr_epi8(0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3), row_ofs);
+	const __m128i ctrl = _mm_or_si128(_mm_shuffle_epi8(idx4, rep),
+		_mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3));
+	return _mm_shuffle_epi8(pal, ctrl);
+}
+
+/**
+ * Move four per-pixel bytes into one byte of each ARGB32 pixel.
+ * Other bytes are set to 0.
+ * @tparam byte Destination byte within each pixel. (0 == B, 3 == A)
+ * @param v Per-pixel bytes for all 16 pixels.
+ * @param row Row number. (0-3)
+ * @return Four ARGB32 pixels with only the specified byte set.
+ */
+template<unsigned int byte>
+static FORCEINLINE __m128i spread_row(__m128i v, unsigned int row)
+{
+	// NOTE: Adding the row offset to 0x80 keeps the high bit set,
+	// so those bytes are still zeroed by pshufb.
+	static_assert(byte < 4, "byte must be 0-3");
+	const char z = static_cast<char>(0x80);
+	const __m128i base = _mm_setr_epi8(
+		(byte == 0 ? 0 : z), (byte == 1 ? 0 : z), (byte == 2 ? 0 : z), (byte == 3 ? 0 : z),
+		(byte == 0 ? 1 : z), (byte == 1 ? 1 : z), (byte == 2 ? 1 : z), (byte == 3 ? 1 : z),
+		(byte == 0 ? 2 : z), (byte == 1 ? 2 : z), (byte == 2 ? 2 : z), (byte == 3 ? 2 : z),
+		(byte == 0 ? 3 : z), (byte == 1 ? 3 : z), (byte == 2 ? 3 : z), (byte == 3 ? 3 : z));
+	const __m128i ctrl = _mm_add_epi8(base, _mm_set1_epi8(static_cast<char>(row * 4)));
+	return _mm_shuffle_epi8(v, ctrl);
+}
+
+/**
+ * Store four rows of a decoded tile.
+ * @param px_dest	[out] First pixel of the tile in the rp_image.
+ * @param stride_px	[in] rp_image stride, in pixels.
+ * @param row0..row3	[in] Rows.
+ */
+static FORCEINLINE void store_tile(uint32_t *px_dest, int stride_px,
+	__m128i row0, __m128i row1, __m128i row2, __m128i row3)
+{
+	// NOTE: rp_image rows might not be 16-byte aligned
+	// if a custom backend is in use.
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest), row0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest + stride_px), row1);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest + stride_px*2), row2);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(px_dest + stride_px*3), row3);
+}
+
+/**
+ * Validate parameters and create an rp_image for S3TC decoding.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer.
+ * @param img_siz	[in] Size of image data.
+ * @param bytes_per_block [in] Bytes per 4x4 block. (8 or 16)
+ * @return rp_image using the physical (4x4-aligned) size, or nullptr on error.
+ */
+static rp_image *createS3TCImage(int width, int height,
+	const uint8_t *img_buf, int img_siz, int bytes_per_block)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// S3TC uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	const int req_siz = (physWidth * physHeight) / (16 / bytes_per_block);
+	if (!img_buf || width <= 0 || height <= 0 || img_siz < req_siz) {
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+	return img;
+}
+
+/**
+ * Finish an S3TC image.
+ * @param img rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param sBIT sBIT metadata.
+ * @return img
+ */
+static rp_image *finishS3TCImage(rp_image *img, int width, int height, const rp_image::sBIT_t *sBIT)
+{
+	if (width < img->width() || height < img->height()) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * SSSE3-optimized version.
+ * @param palflags decode_DXTn_tile_color_palette_S3TC<>() flags.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+template<unsigned int palflags>
+static rp_image *T_fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	rp_image *const img = createS3TCImage(width, height, img_buf, img_siz, 8);
+	if (!img)
+		return nullptr;
+
+	const dxt1_block *dxt1_src = reinterpret_cast<const dxt1_block*>(img_buf);
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	for (unsigned int y = tilesY; y > 0; y--, px_dest += (stride_px * 4) - (tilesX * 4)) {
+	for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, dxt1_src++) {
+		// Decode the DXT1 tile palette.
+		const __m128i pal = decode_DXTn_tile_color_palette_S3TC<palflags>(dxt1_src);
+
+		// Process the 16 color indexes.
+		const __m128i idx4 = _mm_slli_epi16(expand_2bit_indexes(le32_to_cpu(dxt1_src->indexes)), 2);
+		store_tile(px_dest, stride_px,
+			lookup_row(pal, idx4, 0), lookup_row(pal, idx4, 1),
+			lookup_row(pal, idx4, 2), lookup_row(pal, idx4, 3));
+	} }
+
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return finishS3TCImage(img, width, height, &sBIT);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return T_fromDXT1_ssse3<0>(width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ * SSSE3-optimized version.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return T_fromDXT1_ssse3<DXTn_PALETTE_COLOR3_ALPHA>(width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT3 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT3_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	rp_image *const img = createS3TCImage(width, height, img_buf, img_siz, 16);
+	if (!img)
+		return nullptr;
+
+	const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(img_buf);
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+
+	for (unsigned int y = tilesY; y > 0; y--, px_dest += (stride_px * 4) - (tilesX * 4)) {
+	for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, dxt3_src++) {
+		// Decode the DXT3 tile palette.
+		// FIXME: DXTn_PALETTE_COLOR0_LE_COLOR1 seems to result in garbage pixels.
+		// (See the standard version for more information.)
+		const __m128i pal = _mm_and_si128(
+			decode_DXTn_tile_color_palette_S3TC<0>(&dxt3_src->colors), rgb_mask);
+
+		// Process the 16 color indexes and apply alpha.
+		const __m128i idx4 = _mm_slli_epi16(expand_2bit_indexes(le32_to_cpu(dxt3_src->colors.indexes)), 2);
+		const __m128i alpha = expand_DXT3_alpha(le64_to_cpu(dxt3_src->alpha));
+		store_tile(px_dest, stride_px,
+			_mm_or_si128(lookup_row(pal, idx4, 0), spread_row<3>(alpha, 0)),
+			_mm_or_si128(lookup_row(pal, idx4, 1), spread_row<3>(alpha, 1)),
+			_mm_or_si128(lookup_row(pal, idx4, 2), spread_row<3>(alpha, 2)),
+			_mm_or_si128(lookup_row(pal, idx4, 3), spread_row<3>(alpha, 3)));
+	} }
+
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,4};
+	return finishS3TCImage(img, width, height, &sBIT);
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	rp_image *const img = createS3TCImage(width, height, img_buf, img_siz, 16);
+	if (!img)
+		return nullptr;
+
+	const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(img_buf);
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+
+	for (unsigned int y = tilesY; y > 0; y--, px_dest += (stride_px * 4) - (tilesX * 4)) {
+	for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, dxt5_src++) {
+		// Decode the DXT5 tile palette.
+		const __m128i pal = _mm_and_si128(
+			decode_DXTn_tile_color_palette_S3TC<0>(&dxt5_src->colors), rgb_mask);
+
+		// Decode the DXT5 alpha values.
+		const __m128i alpha_block = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&dxt5_src->alpha));
+		const __m128i alpha = _mm_shuffle_epi8(
+			decode_DXT5_alpha_palette_S3TC(dxt5_src->alpha.values),
+			expand_3bit_indexes(alpha_block));
+
+		// Process the 16 color indexes and apply alpha.
+		const __m128i idx4 = _mm_slli_epi16(expand_2bit_indexes(le32_to_cpu(dxt5_src->colors.indexes)), 2);
+		store_tile(px_dest, stride_px,
+			_mm_or_si128(lookup_row(pal, idx4, 0), spread_row<3>(alpha, 0)),
+			_mm_or_si128(lookup_row(pal, idx4, 1), spread_row<3>(alpha, 1)),
+			_mm_or_si128(lookup_row(pal, idx4, 2), spread_row<3>(alpha, 2)),
+			_mm_or_si128(lookup_row(pal, idx4, 3), spread_row<3>(alpha, 3)));
+	} }
+
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	return finishS3TCImage(img, width, height, &sBIT);
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	rp_image *const img = createS3TCImage(width, height, img_buf, img_siz, 8);
+	if (!img)
+		return nullptr;
+
+	const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(img_buf);
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+	const __m128i opaque_black = _mm_set1_epi32(0xFF000000);
+
+	for (unsigned int y = tilesY; y > 0; y--, px_dest += (stride_px * 4) - (tilesX * 4)) {
+	for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, bc4_src++) {
+		// BC4 colors are determined using DXT5-style alpha interpolation.
+		// NOTE: Using red instead of grayscale here.
+		const __m128i red_block = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bc4_src->red));
+		const __m128i red = _mm_shuffle_epi8(
+			decode_DXT5_alpha_palette_S3TC(bc4_src->red.values),
+			expand_3bit_indexes(red_block));
+
+		store_tile(px_dest, stride_px,
+			_mm_or_si128(opaque_black, spread_row<2>(red, 0)),
+			_mm_or_si128(opaque_black, spread_row<2>(red, 1)),
+			_mm_or_si128(opaque_black, spread_row<2>(red, 2)),
+			_mm_or_si128(opaque_black, spread_row<2>(red, 3)));
+	} }
+
+	// NOTE: We have to set '1' for the empty Green and Blue channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
+	return finishS3TCImage(img, width, height, &sBIT);
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	rp_image *const img = createS3TCImage(width, height, img_buf, img_siz, 16);
+	if (!img)
+		return nullptr;
+
+	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf);
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+	const int stride_px = img->stride() / sizeof(uint32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+	const __m128i opaque_black = _mm_set1_epi32(0xFF000000);
+
+	for (unsigned int y = tilesY; y > 0; y--, px_dest += (stride_px * 4) - (tilesX * 4)) {
+	for (unsigned int x = tilesX; x > 0; x--, px_dest += 4, bc5_src++) {
+		// BC5 colors are determined using DXT5-style alpha interpolation.
+		const __m128i red_block = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bc5_src->red));
+		const __m128i red = _mm_shuffle_epi8(
+			decode_DXT5_alpha_palette_S3TC(bc5_src->red.values),
+			expand_3bit_indexes(red_block));
+		const __m128i green_block = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bc5_src->green));
+		const __m128i green = _mm_shuffle_epi8(
+			decode_DXT5_alpha_palette_S3TC(bc5_src->green.values),
+			expand_3bit_indexes(green_block));
+
+		store_tile(px_dest, stride_px,
+			_mm_or_si128(_mm_or_si128(opaque_black, spread_row<2>(red, 0)), spread_row<1>(green, 0)),
+			_mm_or_si128(_mm_or_si128(opaque_black, spread_row<2>(red, 1)), spread_row<1>(green, 1)),
+			_mm_or_si128(_mm_or_si128(opaque_black, spread_row<2>(red, 2)), spread_row<1>(green, 2)),
+			_mm_or_si128(_mm_or_si128(opaque_black, spread_row<2>(red, 3)), spread_row<1>(green, 3)));
+	} }
+
+	// NOTE: We have to set '1' for the empty Blue channel,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,8,1,0,0};
+	return finishS3TCImage(img, width, height, &sBIT);
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
@@ -17,21 +17,49 @@ using namespace LibRpTexture;
 // IFUNC attribute doesn't support C++ name mangling.
 extern "C" {
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
 /**
  * IFUNC resolver function for fromLinear16().
  * @return Function pointer.
  */
 static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
 {
-#ifdef IMAGEDECODER_HAS_SSE2
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear16_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	{
+		// amd64 always has SSE2.
+		return &ImageDecoder::fromLinear16_sse2;
+	}
+#else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#  ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
 		return &ImageDecoder::fromLinear16_sse2;
 	} else
-#endif /* IMAGEDECODER_HAS_SSE2 */
+#  endif /* IMAGEDECODER_HAS_SSE2 */
 	{
 		return &ImageDecoder::fromLinear16_cpp;
 	}
+#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+/**
+ * IFUNC resolver function for fromGcn16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromGcn16_cpp) fromGcn16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromGcn16_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromGcn16_cpp;
+	}
 }
 #endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
@@ -57,6 +85,11 @@ static __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
  */
 static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear32_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear32_ssse3;
@@ -67,13 +100,130 @@ static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 	}
 }
 
+/**
+ * IFUNC resolver function for fromDXT1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_cpp) fromDXT1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT1_A1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_A1_cpp) fromDXT1_A1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_A1_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_A1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT3().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT3_cpp) fromDXT3_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT3_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT3_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT5().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT5_cpp) fromDXT5_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT5_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT5_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC4().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC4_cpp) fromBC4_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC4_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC4_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC5().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC5_cpp) fromBC5_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC5_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC5_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC7().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC7_cpp) fromBC7_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC7_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC7_cpp;
+	}
+}
+
 }
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
 rp_image *ImageDecoder::fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear16_resolve);
+
+#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+rp_image *ImageDecoder::fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromGcn16_resolve);
 #endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 rp_image *ImageDecoder::fromLinear24(PixelFormat px_format,
@@ -86,4 +236,32 @@ rp_image *ImageDecoder::fromLinear32(PixelFormat px_format,
 	const uint32_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear32_resolve);
 
+rp_image *ImageDecoder::fromDXT1(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_resolve);
+
+rp_image *ImageDecoder::fromDXT1_A1(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_A1_resolve);
+
+rp_image *ImageDecoder::fromDXT3(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT3_resolve);
+
+rp_image *ImageDecoder::fromDXT5(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT5_resolve);
+
+rp_image *ImageDecoder::fromBC4(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromBC4_resolve);
+
+rp_image *ImageDecoder::fromBC5(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromBC5_resolve);
+
+rp_image *ImageDecoder::fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromBC7_resolve);
+
 #endif /* RP_HAS_IFUNC */
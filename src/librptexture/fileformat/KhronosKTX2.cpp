@@ -32,6 +32,16 @@ using LibRpFile::IRpFile;
 #include "img/rp_image.hpp"
 #include "decoder/ImageDecoder.hpp"
 
+// Supercompression
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#endif /* HAVE_ZSTD */
+#ifdef _MSC_VER
+// MSVC: Exception handling for /DELAYLOAD.
+#  include "libwin32common/DelayLoadHelper.h"
+#endif /* _MSC_VER */
+
 // C++ STL classes.
 using std::string;
 using std::unique_ptr;
@@ -46,6 +56,14 @@ namespace LibRpTexture {
 
 FILEFORMAT_IMPL(KhronosKTX2)
 
+#ifdef _MSC_VER
+// DelayLoad test implementation.
+DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
+#  ifdef HAVE_ZSTD
+DELAYLOAD_TEST_FUNCTION_IMPL0(ZSTD_versionNumber);
+#  endif /* HAVE_ZSTD */
+#endif /* _MSC_VER */
+
 class KhronosKTX2Private final : public FileFormatPrivate
 {
 	public:
@@ -73,6 +91,17 @@ class KhronosKTX2Private final : public FileFormatPrivate
 		// Mipmap 0 is the full image.
 		vector<rp_image*> mipmaps;
 
+		// Supercompressed data is read in chunks
+		// using this buffer, which is reused for
+		// all mipmap levels.
+		ao::uvector<uint8_t> zbuf;
+
+#ifdef HAVE_ZSTD
+		// Zstandard decompression context.
+		// Reused for all mipmap levels.
+		ZSTD_DCtx *zstd_dctx;
+#endif /* HAVE_ZSTD */
+
 		// Invalid pixel format message.
 		char invalid_pixel_format[24];
 
@@ -89,6 +118,23 @@ class KhronosKTX2Private final : public FileFormatPrivate
 		 */
 		const rp_image *loadImage(int mip);
 
+		/**
+		 * Is the supercompression scheme supported?
+		 * @return True if supported; false if not.
+		 */
+		bool isSupercompressionSupported(void) const;
+
+		/**
+		 * Read and decompress a supercompressed mipmap level.
+		 * Decompression stops once the output buffer is full,
+		 * so only the first face/layer/slice is decompressed.
+		 * @param mipinfo	[in] Mipmap level index.
+		 * @param buf		[out] Output buffer.
+		 * @param size		[in] Number of bytes to decompress.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readSupercompressedLevel(const KTX2_Mipmap_Index &mipinfo, uint8_t *buf, size_t size);
+
 		/**
 		 * Load key/value data.
 		 */
@@ -100,6 +146,9 @@ class KhronosKTX2Private final : public FileFormatPrivate
 KhronosKTX2Private::KhronosKTX2Private(KhronosKTX2 *q, IRpFile *file)
 	: super(q, file)
 	, flipOp(rp_image::FLIP_V)
+#ifdef HAVE_ZSTD
+	, zstd_dctx(nullptr)
+#endif /* HAVE_ZSTD */
 {
 	// Clear the KTX2 header struct.
 	memset(&ktx2Header, 0, sizeof(ktx2Header));
@@ -109,6 +158,152 @@ KhronosKTX2Private::KhronosKTX2Private(KhronosKTX2 *q, IRpFile *file)
 KhronosKTX2Private::~KhronosKTX2Private()
 {
 	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
+#ifdef HAVE_ZSTD
+	if (zstd_dctx) {
+		ZSTD_freeDCtx(zstd_dctx);
+	}
+#endif /* HAVE_ZSTD */
+}
+
+/**
+ * Is the supercompression scheme supported?
+ * @return True if supported; false if not.
+ */
+bool KhronosKTX2Private::isSupercompressionSupported(void) const
+{
+	switch (ktx2Header.supercompressionScheme) {
+		case KTX2_SUPERZ_NONE:
+			return true;
+
+		case KTX2_SUPERZ_ZLIB:
+#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
+			// Delay load verification.
+			// TODO: Only if linked with /DELAYLOAD?
+			return (DelayLoad_test_get_crc_table() == 0);
+#else /* !defined(_MSC_VER) || !defined(ZLIB_IS_DLL) */
+			return true;
+#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
+
+#ifdef HAVE_ZSTD
+		case KTX2_SUPERZ_ZSTD:
+#  if defined(_MSC_VER) && defined(ZSTD_IS_DLL)
+			// Delay load verification.
+			// TODO: Only if linked with /DELAYLOAD?
+			return (DelayLoad_test_ZSTD_versionNumber() == 0);
+#  else /* !defined(_MSC_VER) || !defined(ZSTD_IS_DLL) */
+			return true;
+#  endif /* defined(_MSC_VER) && defined(ZSTD_IS_DLL) */
+#endif /* HAVE_ZSTD */
+
+		default:
+			// TODO: BasisLZ requires a Basis Universal transcoder.
+			break;
+	}
+
+	return false;
+}
+
+/**
+ * Read and decompress a supercompressed mipmap level.
+ * Decompression stops once the output buffer is full,
+ * so only the first face/layer/slice is decompressed.
+ * @param mipinfo	[in] Mipmap level index.
+ * @param buf		[out] Output buffer.
+ * @param size		[in] Number of bytes to decompress.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int KhronosKTX2Private::readSupercompressedLevel(const KTX2_Mipmap_Index &mipinfo, uint8_t *buf, size_t size)
+{
+	int ret = file->seek(mipinfo.byteOffset);
+	if (ret != 0) {
+		// Seek error.
+		return -EIO;
+	}
+
+	if (zbuf.empty()) {
+		zbuf.resize(64*1024);
+	}
+	uint64_t z_remain = mipinfo.byteLength;
+
+	// Read the next chunk of compressed data.
+	// Returns the number of bytes read, or 0 on error or EOF.
+	auto readChunk = [this, &z_remain]() -> size_t {
+		const size_t to_read = (z_remain > zbuf.size() ? zbuf.size() : static_cast<size_t>(z_remain));
+		if (to_read == 0)
+			return 0;
+		if (file->read(zbuf.data(), to_read) != to_read)
+			return 0;
+		z_remain -= to_read;
+		return to_read;
+	};
+
+	switch (ktx2Header.supercompressionScheme) {
+		default:
+			assert(!"Unsupported supercompression scheme.");
+			return -ENOTSUP;
+
+		case KTX2_SUPERZ_ZLIB: {
+			// Initialize zlib.
+			z_stream strm;
+			memset(&strm, 0, sizeof(strm));
+			ret = inflateInit(&strm);
+			if (ret != Z_OK) {
+				// Error initializing inflate.
+				return -ENOMEM;
+			}
+
+			strm.avail_out = static_cast<uInt>(size);
+			strm.next_out = buf;
+			do {
+				if (strm.avail_in == 0) {
+					strm.avail_in = static_cast<uInt>(readChunk());
+					strm.next_in = zbuf.data();
+					if (strm.avail_in == 0) {
+						// Read error, or not enough compressed data.
+						break;
+					}
+				}
+				ret = inflate(&strm, Z_NO_FLUSH);
+			} while (ret == Z_OK && strm.avail_out > 0);
+			inflateEnd(&strm);
+
+			// Z_STREAM_END is acceptable here if the
+			// decompressed data filled the buffer.
+			return (strm.avail_out == 0 ? 0 : -EIO);
+		}
+
+#ifdef HAVE_ZSTD
+		case KTX2_SUPERZ_ZSTD: {
+			if (!zstd_dctx) {
+				zstd_dctx = ZSTD_createDCtx();
+				if (!zstd_dctx) {
+					return -ENOMEM;
+				}
+			} else {
+				ZSTD_DCtx_reset(zstd_dctx, ZSTD_reset_session_only);
+			}
+
+			ZSTD_outBuffer out = {buf, size, 0};
+			ZSTD_inBuffer in = {zbuf.data(), 0, 0};
+			while (out.pos < out.size) {
+				if (in.pos == in.size) {
+					in.size = readChunk();
+					in.pos = 0;
+					if (in.size == 0) {
+						// Read error, or not enough compressed data.
+						break;
+					}
+				}
+				const size_t zret = ZSTD_decompressStream(zstd_dctx, &out, &in);
+				if (ZSTD_isError(zret)) {
+					// Error decompressing...
+					break;
+				}
+			}
+			return (out.pos == out.size ? 0 : -EIO);
+		}
+#endif /* HAVE_ZSTD */
+	}
 }
 
 /**
@@ -151,8 +346,8 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 		return nullptr;
 	}
 
-	// TODO: Support supercompression.
-	if (ktx2Header.supercompressionScheme != 0) {
+	// Check if the supercompression scheme is supported.
+	if (!isSupercompressionSupported()) {
 		return nullptr;
 	}
 
@@ -316,25 +511,47 @@ const rp_image *KhronosKTX2Private::loadImage(int mip)
 			return nullptr;
 	}
 
-	// Verify mipmap size.
-	if (mipinfo.byteLength < expected_size) {
-		// Mipmap level is too small.
-		// TODO: Should we require the exact size?
-		return nullptr;
-	}
+	auto buf = aligned_uptr<uint8_t>(16, expected_size);
+	if (ktx2Header.supercompressionScheme == KTX2_SUPERZ_NONE) {
+		// Verify mipmap size.
+		if (mipinfo.byteLength < expected_size) {
+			// Mipmap level is too small.
+			// TODO: Should we require the exact size?
+			return nullptr;
+		}
 
-	// Verify file size.
-	if (mipinfo.byteOffset + expected_size > file_sz) {
-		// File is too small.
-		return nullptr;
-	}
+		// Verify file size.
+		if (mipinfo.byteOffset + expected_size > file_sz) {
+			// File is too small.
+			return nullptr;
+		}
 
-	// Read the texture data.
-	auto buf = aligned_uptr<uint8_t>(16, expected_size);
-	size_t size = file->read(buf.get(), expected_size);
-	if (size != expected_size) {
-		// Read error.
-		return nullptr;
+		// Read the texture data.
+		size_t size = file->read(buf.get(), expected_size);
+		if (size != expected_size) {
+			// Read error.
+			return nullptr;
+		}
+	} else {
+		// Verify mipmap size.
+		if (mipinfo.uncompressedByteLength < expected_size) {
+			// Mipmap level is too small.
+			return nullptr;
+		}
+
+		// Verify file size.
+		if (mipinfo.byteLength > file_sz ||
+		    mipinfo.byteOffset + mipinfo.byteLength > file_sz)
+		{
+			// File is too small.
+			return nullptr;
+		}
+
+		// Decompress the texture data.
+		if (readSupercompressedLevel(mipinfo, buf.get(), expected_size) != 0) {
+			// Decompression error.
+			return nullptr;
+		}
 	}
 
 	// TODO: Handle sRGB post-processing? (for e.g. GL_SRGB8)
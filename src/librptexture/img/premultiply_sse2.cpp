@@ -0,0 +1,137 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * premultiply_sse2.cpp: Premultiply function.                             *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Premultiply an argb32_t pixel. (Standard version)
+ * From qt-5.11.0's qrgb.h.
+ * qPremultiply()
+ *
+ * Used for the last pixels in each row.
+ *
+ * @param px	[in] ARGB32 pixel to premultiply.
+ * @return Premultiplied pixel.
+ */
+static FORCEINLINE uint32_t premultiply_pixel_inl(uint32_t px)
+{
+	const unsigned int a = (px >> 24);
+	if (likely(a == 255 || a == 0))
+		return px;
+
+	// Based on Qt 5.9.1's qPremultiply().
+	unsigned int t = (px & 0xff00ff) * a;
+	t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+	t &= 0xff00ff;
+
+	px = ((px >> 8) & 0xff) * a;
+	px = (px + ((px >> 8) & 0xff) + 0x80);
+	px &= 0xff00;
+	return (px | t | (a << 24));
+}
+
+/**
+ * Premultiply four argb32_t pixels. (SSE2 version)
+ *
+ * This uses the same rounding as qPremultiply(), so the
+ * results are identical to the standard version.
+ *
+ * @param px	[in] Four ARGB32 pixels.
+ * @return Premultiplied pixels.
+ */
+static FORCEINLINE __m128i premultiply_4px_sse2(__m128i px)
+{
+	const __m128i amask = _mm_set1_epi32(0xFF000000);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i v80 = _mm_set1_epi16(0x0080);
+
+	// Pixels with alpha == 255 or alpha == 0 are left as-is.
+	const __m128i a_only = _mm_and_si128(px, amask);
+	const __m128i keep = _mm_or_si128(
+		_mm_cmpeq_epi32(a_only, amask),
+		_mm_cmpeq_epi32(a_only, zero));
+	if (_mm_movemask_epi8(keep) == 0xFFFF) {
+		// All four pixels are either opaque or fully transparent.
+		return px;
+	}
+
+	// Unpack to 16-bit channels and broadcast alpha.
+	__m128i lo = _mm_unpacklo_epi8(px, zero);
+	__m128i hi = _mm_unpackhi_epi8(px, zero);
+	const __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+	const __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+
+	// t = c * a; t = (t + (t >> 8) + 0x80) >> 8
+	// NOTE: c * a <= 0xFE01, so this can't overflow 16 bits.
+	lo = _mm_mullo_epi16(lo, alo);
+	hi = _mm_mullo_epi16(hi, ahi);
+	lo = _mm_add_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), v80);
+	hi = _mm_add_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), v80);
+	lo = _mm_srli_epi16(lo, 8);
+	hi = _mm_srli_epi16(hi, 8);
+
+	// Repack and restore the original alpha channel.
+	__m128i res = _mm_packus_epi16(lo, hi);
+	res = _mm_or_si128(_mm_andnot_si128(amask, res), a_only);
+
+	// Keep the original pixels that didn't need premultiplication.
+	return _mm_or_si128(_mm_and_si128(keep, px), _mm_andnot_si128(keep, res));
+}
+
+/**
+ * Premultiply an ARGB32 rp_image.
+ * SSE2-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::premultiply_sse2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	const int width = backend->width;
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 4 pixels per iteration using SSE2.
+		// NOTE: Rows might not be 16-byte aligned if a custom
+		// backend is in use, so unaligned loads are used.
+		int x = width;
+		for (; x > 3; x -= 4, px_dest += 4) {
+			__m128i *const xmm_px = reinterpret_cast<__m128i*>(px_dest);
+			_mm_storeu_si128(xmm_px, premultiply_4px_sse2(_mm_loadu_si128(xmm_px)));
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--, px_dest++) {
+			*px_dest = premultiply_pixel_inl(*px_dest);
+		}
+	}
+	return 0;
+}
+
+}
@@ -23,6 +23,10 @@
 # include "librpcpu/cpuflags_x86.h"
 # define RP_IMAGE_HAS_SSE2 1
 # define RP_IMAGE_HAS_SSE41 1
+/* AVX2 intrinsics require MSVC 2012 or later. */
+# if !defined(_MSC_VER) || _MSC_VER >= 1700
+#  define RP_IMAGE_HAS_AVX2 1
+# endif
 #endif
 #ifdef RP_CPU_AMD64
 # define RP_IMAGE_ALWAYS_HAS_SSE2 1
@@ -386,6 +390,31 @@ class rp_image : public RefBase
 			Alignment alignment = AlignDefault,
 			uint32_t bgColor = 0x00000000) const;
 
+		/**
+		 * Scaling method for scaled().
+		 */
+		enum class ScalingMethod : uint8_t {
+			Nearest	= 0,	// Nearest-neighbor
+			Bilinear = 1,	// Bilinear filtering
+		};
+
+		/**
+		 * Rescale the rp_image.
+		 *
+		 * This function returns a *new* image and leaves the
+		 * original image unmodified.
+		 *
+		 * Nearest-neighbor scaling retains the original format.
+		 * Bilinear scaling always returns an ARGB32 image.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param method Scaling method
+		 * @return New rp_image with a rescaled version of the original, or nullptr on error.
+		 */
+		rp_image *scaled(int width, int height,
+			ScalingMethod method = ScalingMethod::Nearest) const;
+
 		/**
 		 * Un-premultiply this image.
 		 * Standard version using regular C++ code.
@@ -408,6 +437,18 @@ class rp_image : public RefBase
 		int un_premultiply_sse41(void);
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Un-premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int un_premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Un-premultiply this image.
 		 *
@@ -424,6 +465,28 @@ class rp_image : public RefBase
 		 */
 		static uint32_t premultiply_pixel(uint32_t px);
 
+		/**
+		 * Premultiply this image.
+		 * Standard version using regular C++ code.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_cpp(void);
+
+#ifdef RP_IMAGE_HAS_SSE2
+		/**
+		 * Premultiply this image.
+		 * SSE2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_sse2(void);
+#endif /* RP_IMAGE_HAS_SSE2 */
+
 		/**
 		 * Premultiply this image.
 		 *
@@ -431,7 +494,7 @@ class rp_image : public RefBase
 		 *
 		 * @return 0 on success; non-zero on error.
 		 */
-		int premultiply(void);
+		inline int premultiply(void);
 
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
@@ -463,6 +526,22 @@ class rp_image : public RefBase
 		int apply_chroma_key_sse2(uint32_t key);
 #endif /* RP_IMAGE_HAS_SSE2 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Convert a chroma-keyed image to standard ARGB32.
+		 * AVX2-optimized version.
+		 *
+		 * This operates on the image itself, and does not return
+		 * a duplicated image with the adjusted image.
+		 *
+		 * NOTE: The image *must* be ARGB32.
+		 *
+		 * @param key Chroma key color.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int apply_chroma_key_avx2(uint32_t key);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
 		 *
@@ -513,6 +592,11 @@ class rp_image : public RefBase
 inline int rp_image::un_premultiply(void)
 {
 	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return un_premultiply_avx2();
+	} else
+#endif /* RP_IMAGE_HAS_AVX2 */
 #ifdef RP_IMAGE_HAS_SSE41
 	if (RP_CPU_HasSSE41()) {
 		return un_premultiply_sse41();
@@ -523,6 +607,31 @@ inline int rp_image::un_premultiply(void)
 	}
 }
 
+/**
+ * Premultiply this image.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+inline int rp_image::premultiply(void)
+{
+	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
+	// amd64 always has SSE2.
+	return premultiply_sse2();
+#else
+# if defined(RP_IMAGE_HAS_SSE2)
+	if (RP_CPU_HasSSE2()) {
+		return premultiply_sse2();
+	} else
+# endif /* RP_IMAGE_HAS_SSE2 */
+	{
+		return premultiply_cpp();
+	}
+#endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+}
+
 /**
  * Convert a chroma-keyed image to standard ARGB32.
  *
@@ -537,6 +646,11 @@ inline int rp_image::un_premultiply(void)
 inline int rp_image::apply_chroma_key(uint32_t key)
 {
 	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return apply_chroma_key_avx2(key);
+	}
+#endif /* RP_IMAGE_HAS_AVX2 */
 #if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
 	// amd64 always has SSE2.
 	return apply_chroma_key_sse2(key);
@@ -14,6 +14,9 @@
 // Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
 #define rp_imagePrivate rp_image_private
 
+// C++ STL classes.
+using std::unique_ptr;
+
 namespace LibRpTexture {
 
 /** Image operations. **/
@@ -557,6 +560,168 @@ int rp_image::apply_chroma_key_cpp(uint32_t key)
 	return 0;
 }
 
+/**
+ * Rescale the rp_image.
+ *
+ * This function returns a *new* image and leaves the
+ * original image unmodified.
+ *
+ * Nearest-neighbor scaling retains the original format.
+ * Bilinear scaling always returns an ARGB32 image.
+ *
+ * @param width New width
+ * @param height New height
+ * @param method Scaling method
+ * @return New rp_image with a rescaled version of the original, or nullptr on error.
+ */
+rp_image *rp_image::scaled(int width, int height, ScalingMethod method) const
+{
+	assert(width > 0);
+	assert(height > 0);
+	if (width <= 0 || height <= 0)
+		return nullptr;
+
+	RP_D(const rp_image);
+	const rp_image_backend *const backend = d->backend;
+	const int srcWidth = backend->width;
+	const int srcHeight = backend->height;
+	assert(srcWidth > 0 && srcHeight > 0);
+	if (srcWidth <= 0 || srcHeight <= 0)
+		return nullptr;
+
+	if (width == srcWidth && height == srcHeight) {
+		// No rescaling is needed.
+		return dup();
+	}
+
+	rp_image *img = nullptr;
+	if (method == ScalingMethod::Nearest) {
+		// Nearest-neighbor scaling.
+		// Source coordinates are calculated using 16.16 fixed-point.
+		const uint32_t x_step = (static_cast<uint32_t>(srcWidth) << 16) / width;
+		const uint32_t y_step = (static_cast<uint32_t>(srcHeight) << 16) / height;
+
+		// Precalculate the source X coordinates.
+		unique_ptr<int[]> src_x(new int[width]);
+		uint32_t sx = x_step / 2;
+		for (int x = 0; x < width; x++, sx += x_step) {
+			src_x[x] = std::min(static_cast<int>(sx >> 16), srcWidth - 1);
+		}
+
+		img = new rp_image(width, height, backend->format);
+		if (!img->isValid()) {
+			// Could not allocate the image.
+			img->unref();
+			return nullptr;
+		}
+
+		uint32_t sy = y_step / 2;
+		switch (backend->format) {
+			default:
+				assert(!"rp_image format not supported for scaling.");
+				img->unref();
+				return nullptr;
+
+			case rp_image::Format::CI8:
+				for (int y = 0; y < height; y++, sy += y_step) {
+					const uint8_t *const src = static_cast<const uint8_t*>(
+						scanLine(std::min(static_cast<int>(sy >> 16), srcHeight - 1)));
+					uint8_t *const dest = static_cast<uint8_t*>(img->scanLine(y));
+					for (int x = 0; x < width; x++) {
+						dest[x] = src[src_x[x]];
+					}
+				}
+
+				// Copy the palette.
+				memcpy(img->palette(), backend->palette(),
+					std::min(img->palette_len(), backend->palette_len()) * sizeof(uint32_t));
+				img->set_tr_idx(backend->tr_idx);
+				break;
+
+			case rp_image::Format::ARGB32:
+				for (int y = 0; y < height; y++, sy += y_step) {
+					const uint32_t *const src = static_cast<const uint32_t*>(
+						scanLine(std::min(static_cast<int>(sy >> 16), srcHeight - 1)));
+					uint32_t *const dest = static_cast<uint32_t*>(img->scanLine(y));
+					for (int x = 0; x < width; x++) {
+						dest[x] = src[src_x[x]];
+					}
+				}
+				break;
+		}
+	} else {
+		// Bilinear scaling.
+		// Convert the source image to ARGB32 if necessary.
+		const rp_image *const srcImg = (backend->format == rp_image::Format::ARGB32)
+			? this->ref() : this->dup_ARGB32();
+		if (!srcImg) {
+			return nullptr;
+		}
+
+		img = new rp_image(width, height, rp_image::Format::ARGB32);
+		if (!img->isValid()) {
+			// Could not allocate the image.
+			img->unref();
+			srcImg->unref();
+			return nullptr;
+		}
+
+		// Source coordinates are calculated using 16.16 fixed-point,
+		// with pixel centers at +0.5. Weights are 8-bit.
+		const int32_t x_step = static_cast<int32_t>((static_cast<int64_t>(srcWidth) << 16) / width);
+		const int32_t y_step = static_cast<int32_t>((static_cast<int64_t>(srcHeight) << 16) / height);
+
+		// Precalculate the source X coordinates and weights.
+		struct x_coord_t {
+			int x0, x1;
+			uint32_t w;
+		};
+		unique_ptr<x_coord_t[]> src_x(new x_coord_t[width]);
+		int32_t sx = (x_step / 2) - 0x8000;
+		for (int x = 0; x < width; x++, sx += x_step) {
+			const int32_t csx = std::max(sx, 0);
+			src_x[x].x0 = std::min(csx >> 16, srcWidth - 1);
+			src_x[x].x1 = std::min(src_x[x].x0 + 1, srcWidth - 1);
+			src_x[x].w = (csx >> 8) & 0xFF;
+		}
+
+		// Interpolate two pixels, two channels at a time.
+		// w is the weight of p1, in the range [0, 255].
+		const auto lerp = [](uint32_t p0, uint32_t p1, uint32_t w) -> uint32_t {
+			const uint32_t iw = 256 - w;
+			const uint32_t rb = (((p0 & 0x00FF00FF) * iw + (p1 & 0x00FF00FF) * w) >> 8) & 0x00FF00FF;
+			const uint32_t ag = ((((p0 >> 8) & 0x00FF00FF) * iw + ((p1 >> 8) & 0x00FF00FF) * w)) & 0xFF00FF00;
+			return (ag | rb);
+		};
+
+		int32_t sy = (y_step / 2) - 0x8000;
+		for (int y = 0; y < height; y++, sy += y_step) {
+			const int32_t csy = std::max(sy, 0);
+			const int y0 = std::min(csy >> 16, srcHeight - 1);
+			const int y1 = std::min(y0 + 1, srcHeight - 1);
+			const uint32_t wy = (csy >> 8) & 0xFF;
+
+			const uint32_t *const src0 = static_cast<const uint32_t*>(srcImg->scanLine(y0));
+			const uint32_t *const src1 = static_cast<const uint32_t*>(srcImg->scanLine(y1));
+			uint32_t *const dest = static_cast<uint32_t*>(img->scanLine(y));
+			for (int x = 0; x < width; x++) {
+				const x_coord_t &xc = src_x[x];
+				dest[x] = lerp(lerp(src0[xc.x0], src0[xc.x1], xc.w),
+				               lerp(src1[xc.x0], src1[xc.x1], xc.w), wy);
+			}
+		}
+
+		srcImg->unref();
+	}
+
+	// Copy sBIT if it's set.
+	if (d->has_sBIT) {
+		img->set_sBIT(&d->sBIT);
+	}
+
+	return img;
+}
+
 /**
  * Flip the image.
  *
@@ -0,0 +1,97 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_ops.cpp: Image class. (operations)                             *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2019 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/** Image operations. **/
+
+/**
+ * Convert a chroma-keyed image to standard ARGB32.
+ * AVX2-optimized version.
+ *
+ * This operates on the image itself, and does not return
+ * a duplicated image with the adjusted image.
+ *
+ * NOTE: The image *must* be ARGB32.
+ *
+ * @param key Chroma key color.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rp_image::apply_chroma_key_avx2(uint32_t key)
+{
+	RP_D(rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == Format::ARGB32);
+	if (backend->format != Format::ARGB32) {
+		// ARGB32 only.
+		return -EINVAL;
+	}
+
+	const unsigned int diff = (backend->stride - this->row_bytes()) / sizeof(uint32_t);
+	uint32_t *img_buf = static_cast<uint32_t*>(backend->data());
+
+	// AVX2 constants.
+	const __m256i ymm_key = _mm256_set1_epi32(static_cast<int>(key));
+
+	for (unsigned int y = static_cast<unsigned int>(backend->height); y > 0; y--) {
+		// Process 16 pixels per iteration with AVX2.
+		// NOTE: rp_image scanlines are only guaranteed to be
+		// 16-byte aligned, so unaligned loads and stores are used.
+		unsigned int x = static_cast<unsigned int>(backend->width);
+		for (; x > 15; x -= 16, img_buf += 16) {
+			__m256i *ymm_data = reinterpret_cast<__m256i*>(img_buf);
+
+			__m256i ymm0 = _mm256_loadu_si256(&ymm_data[0]);
+			__m256i ymm1 = _mm256_loadu_si256(&ymm_data[1]);
+
+			// Compare the pixels to the chroma key.
+			// Equal values will be 0xFFFFFFFF.
+			// Non-equal values will be 0x00000000.
+			__m256i res0 = _mm256_cmpeq_epi32(ymm0, ymm_key);
+			__m256i res1 = _mm256_cmpeq_epi32(ymm1, ymm_key);
+
+			// Mask the original data with the inverted results.
+			// Original data will now have 00s for chroma-keyed pixels.
+			_mm256_storeu_si256(&ymm_data[0], _mm256_andnot_si256(res0, ymm0));
+			_mm256_storeu_si256(&ymm_data[1], _mm256_andnot_si256(res1, ymm1));
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--, img_buf++) {
+			if (*img_buf == key) {
+				*img_buf = 0;
+			}
+		}
+
+		// Next row.
+		img_buf += diff;
+	}
+
+	// Adjust sBIT.
+	// TODO: Only if transparent pixels were found.
+	if (d->has_sBIT && d->sBIT.alpha == 0) {
+		d->sBIT.alpha = 1;
+	}
+
+	// Chroma key applied.
+	return 0;
+}
+
+}
@@ -159,15 +159,14 @@ uint32_t rp_image::premultiply_pixel(uint32_t px)
 
 /**
  * Premultiply an ARGB32 rp_image.
+ * Standard version using regular C++ code.
  *
  * Image must be ARGB32.
  *
  * @return 0 on success; non-zero on error.
  */
-int rp_image::premultiply(void)
+int rp_image::premultiply_cpp(void)
 {
-	// TODO: Qt doesn't have SSE-optimized builds.
-
 	RP_D(const rp_image);
 	rp_image_backend *const backend = d->backend;
 	assert(backend->format == rp_image::Format::ARGB32);
@@ -0,0 +1,143 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * un-premultiply_avx2.cpp: Un-premultiply function.                       *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2019 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 headers.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Get the inverse premultiply factor for an alpha value.
+ * Alpha values of 0 and 255 are left as-is, so
+ * the factor for those is 1.0 in 16.16 fixed-point.
+ * @param alpha Alpha value.
+ * @return Inverse premultiply factor.
+ */
+static FORCEINLINE int inv_premul_factor(unsigned int alpha)
+{
+	if (alpha == 255 || alpha == 0)
+		return 0x10000;
+	return static_cast<int>(rp_image::qt_inv_premul_factor[alpha]);
+}
+
+/**
+ * Un-premultiply an ARGB32 pixel. (AVX2 version)
+ * Same as the SSE4.1 version, but using VEX-encoded instructions
+ * to avoid SSE/AVX transition penalties.
+ *
+ * @param px	[in/out] ARGB32 pixel to un-premultiply, in place.
+ */
+static FORCEINLINE void un_premultiply_pixel_avx2(uint32_t &px)
+{
+	const unsigned int alpha = (px >> 24);
+	if (alpha == 255 || alpha == 0)
+		return;
+
+	const unsigned int invAlpha = rp_image::qt_inv_premul_factor[alpha];
+	const __m128i via = _mm_set1_epi32(invAlpha);
+	const __m128i vr = _mm_set1_epi32(0x8000);
+	__m128i vl = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(px));
+	vl = _mm_mullo_epi32(vl, via);
+	vl = _mm_add_epi32(vl, vr);
+	vl = _mm_srai_epi32(vl, 16);
+	vl = _mm_insert_epi32(vl, alpha, 3);
+	vl = _mm_packus_epi32(vl, vl);
+	vl = _mm_packus_epi16(vl, vl);
+	px = _mm_cvtsi128_si32(vl);
+}
+
+/**
+ * Un-premultiply two argb32_t pixels. (AVX2 version)
+ * Based on the SSE4.1 version, which is based on
+ * qt-5.11.0's qUnpremultiply_sse4().
+ *
+ * This is needed in order to convert DXT2/3 to DXT4/5.
+ *
+ * @param vl	[in] Two pixels, with each channel expanded to 32 bits.
+ * @return Un-premultiplied channels, with each channel expanded to 32 bits.
+ */
+static FORCEINLINE __m256i un_premultiply_2px_avx2(__m256i vl)
+{
+	// Get the inverse factors for each pixel.
+	const int inv0 = inv_premul_factor(_mm256_extract_epi32(vl, 3));
+	const int inv1 = inv_premul_factor(_mm256_extract_epi32(vl, 7));
+	const __m256i via = _mm256_setr_epi32(inv0, inv0, inv0, inv0, inv1, inv1, inv1, inv1);
+	const __m256i vr = _mm256_set1_epi32(0x8000);
+
+	__m256i vm = _mm256_mullo_epi32(vl, via);
+	vm = _mm256_add_epi32(vm, vr);
+	vm = _mm256_srai_epi32(vm, 16);
+	// Keep the original alpha channels.
+	return _mm256_blend_epi32(vm, vl, 0x88);
+}
+
+/**
+ * Un-premultiply an ARGB32 rp_image.
+ * Image must be ARGB32.
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::un_premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	// Restore pixel order after packing:
+	// packus works within 128-bit lanes, so the packed
+	// DWORDs are in the order p0, p2, p0, p2, p1, p3, p1, p3.
+	const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 0, 4, 1, 5);
+
+	const int width = backend->width;
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 4 pixels per iteration using AVX2.
+		int x = width;
+		for (; x > 3; x -= 4, px_dest += 4) {
+			__m128i *xmm_ptr = reinterpret_cast<__m128i*>(px_dest);
+			const __m128i px = _mm_loadu_si128(xmm_ptr);
+
+			// Skip the block if all pixels are fully opaque,
+			// which is the most common case.
+			const __m128i opaque = _mm_cmpeq_epi8(px, _mm_set1_epi8(-1));
+			if ((_mm_movemask_epi8(opaque) & 0x8888) == 0x8888)
+				continue;
+
+			__m256i va = _mm256_cvtepu8_epi32(px);
+			__m256i vb = _mm256_cvtepu8_epi32(_mm_srli_si128(px, 8));
+			va = un_premultiply_2px_avx2(va);
+			vb = un_premultiply_2px_avx2(vb);
+
+			__m256i vp = _mm256_packus_epi32(va, vb);
+			vp = _mm256_packus_epi16(vp, vp);
+			vp = _mm256_permutevar8x32_epi32(vp, perm);
+			_mm_storeu_si128(xmm_ptr, _mm256_castsi256_si128(vp));
+		}
+
+		// Remaining pixels.
+		for (; x > 0; x--, px_dest++) {
+			un_premultiply_pixel_avx2(*px_dest);
+		}
+	}
+	return 0;
+}
+
+}
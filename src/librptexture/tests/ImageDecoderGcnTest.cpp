@@ -0,0 +1,316 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderGcnTest.cpp: ImageDecoder::fromGcn*() tests.                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librptexture, librpcpu
+#include "librpbase/aligned_malloc.h"
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+#include "librpcpu/byteswap_rp.h"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+namespace LibRpTexture { namespace Tests {
+
+struct ImageDecoderGcnTest_mode
+{
+	ImageDecoder::PixelFormat px_format;
+
+	ImageDecoderGcnTest_mode(ImageDecoder::PixelFormat px_format)
+		: px_format(px_format)
+	{ }
+};
+
+class ImageDecoderGcnTest : public ::testing::TestWithParam<ImageDecoderGcnTest_mode>
+{
+	protected:
+		ImageDecoderGcnTest()
+			: m_img_buf(nullptr)
+			, m_img_siz(WIDTH * HEIGHT * 2)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Image dimensions.
+		static const int WIDTH = 128;
+		static const int HEIGHT = 128;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10000;
+
+		// Image buffer. (big-endian)
+		uint16_t *m_img_buf;
+		int m_img_siz;
+
+		/**
+		 * Compare two ARGB32 rp_images.
+		 * @param img_expected Expected image.
+		 * @param img_actual Actual image.
+		 */
+		static void compareImages(const rp_image *img_expected, const rp_image *img_actual);
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderGcnTest_mode> &info);
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderGcnTest::SetUp(void)
+{
+	m_img_buf = static_cast<uint16_t*>(aligned_malloc(16, m_img_siz));
+	ASSERT_TRUE(m_img_buf != nullptr);
+
+	// Fill the image buffer with varied data.
+	// This ensures that both RGB5A3 modes are exercised,
+	// and that every tile is different.
+	uint16_t *p = m_img_buf;
+	for (unsigned int i = 0; i < static_cast<unsigned int>(WIDTH * HEIGHT); i++, p++) {
+		const uint16_t px = static_cast<uint16_t>((i * 0x9E37U) ^ (i >> 3));
+		*p = cpu_to_be16(px);
+	}
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void ImageDecoderGcnTest::TearDown(void)
+{
+	aligned_free(m_img_buf);
+	m_img_buf = nullptr;
+}
+
+/**
+ * Compare two ARGB32 rp_images.
+ * @param img_expected Expected image.
+ * @param img_actual Actual image.
+ */
+void ImageDecoderGcnTest::compareImages(const rp_image *img_expected, const rp_image *img_actual)
+{
+	ASSERT_EQ(img_expected->width(), img_actual->width());
+	ASSERT_EQ(img_expected->height(), img_actual->height());
+	ASSERT_EQ(img_expected->format(), img_actual->format());
+
+	for (int y = 0; y < img_expected->height(); y++) {
+		const uint32_t *px_expected = static_cast<const uint32_t*>(img_expected->scanLine(y));
+		const uint32_t *px_actual = static_cast<const uint32_t*>(img_actual->scanLine(y));
+		for (int x = 0; x < img_expected->width(); x++) {
+			ASSERT_EQ(px_expected[x], px_actual[x]) << "pixel (" << x << "," << y << ")";
+		}
+	}
+
+	// sBIT metadata must match.
+	rp_image::sBIT_t sBIT_expected, sBIT_actual;
+	ASSERT_EQ(0, img_expected->get_sBIT(&sBIT_expected));
+	ASSERT_EQ(0, img_actual->get_sBIT(&sBIT_actual));
+	EXPECT_EQ(0, memcmp(&sBIT_expected, &sBIT_actual, sizeof(sBIT_expected)));
+}
+
+/**
+ * Test the ImageDecoder::fromGcn16() dispatch function.
+ */
+TEST_P(ImageDecoderGcnTest, fromGcn16_dispatch_test)
+{
+	const ImageDecoderGcnTest_mode &mode = GetParam();
+
+	rp_image *const img_cpp = ImageDecoder::fromGcn16_cpp(mode.px_format,
+		WIDTH, HEIGHT, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img_cpp != nullptr);
+	rp_image *const img = ImageDecoder::fromGcn16(mode.px_format,
+		WIDTH, HEIGHT, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img != nullptr);
+
+	compareImages(img_cpp, img);
+
+	img->unref();
+	img_cpp->unref();
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcn16() function. (Standard version)
+ */
+TEST_P(ImageDecoderGcnTest, fromGcn16_cpp_benchmark)
+{
+	const ImageDecoderGcnTest_mode &mode = GetParam();
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16_cpp(mode.px_format,
+			WIDTH, HEIGHT, m_img_buf, m_img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Verify that ImageDecoder::fromGcn16_sse2() matches the standard version.
+ */
+TEST_P(ImageDecoderGcnTest, fromGcn16_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoderGcnTest_mode &mode = GetParam();
+
+	rp_image *const img_cpp = ImageDecoder::fromGcn16_cpp(mode.px_format,
+		WIDTH, HEIGHT, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img_cpp != nullptr);
+	rp_image *const img_sse2 = ImageDecoder::fromGcn16_sse2(mode.px_format,
+		WIDTH, HEIGHT, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img_sse2 != nullptr);
+
+	compareImages(img_cpp, img_sse2);
+
+	img_sse2->unref();
+	img_cpp->unref();
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcn16() function. (SSE2-optimized version)
+ */
+TEST_P(ImageDecoderGcnTest, fromGcn16_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoderGcnTest_mode &mode = GetParam();
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16_sse2(mode.px_format,
+			WIDTH, HEIGHT, m_img_buf, m_img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcn16() dispatch function.
+ */
+TEST_P(ImageDecoderGcnTest, fromGcn16_dispatch_benchmark)
+{
+	const ImageDecoderGcnTest_mode &mode = GetParam();
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcn16(mode.px_format,
+			WIDTH, HEIGHT, m_img_buf, m_img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+/**
+ * Benchmark the ImageDecoder::fromGcnCI8() function.
+ */
+TEST_P(ImageDecoderGcnTest, fromGcnCI8_benchmark)
+{
+	// Only run this once; the pixel format parameter is ignored.
+	if (GetParam().px_format != ImageDecoder::PixelFormat::RGB5A3)
+		return;
+
+	// Use the image buffer as both CI8 data and the RGB5A3 palette.
+	const uint8_t *const img_buf = reinterpret_cast<const uint8_t*>(m_img_buf);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcnCI8(WIDTH, HEIGHT,
+			img_buf, WIDTH * HEIGHT, m_img_buf, 256*2);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::fromGcnI8() function.
+ */
+TEST_P(ImageDecoderGcnTest, fromGcnI8_benchmark)
+{
+	// Only run this once; the pixel format parameter is ignored.
+	if (GetParam().px_format != ImageDecoder::PixelFormat::RGB5A3)
+		return;
+
+	const uint8_t *const img_buf = reinterpret_cast<const uint8_t*>(m_img_buf);
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = ImageDecoder::fromGcnI8(WIDTH, HEIGHT,
+			img_buf, WIDTH * HEIGHT);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderGcnTest::test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderGcnTest_mode> &info)
+{
+	switch (info.param.px_format) {
+		case ImageDecoder::PixelFormat::RGB5A3:
+			return "RGB5A3";
+		case ImageDecoder::PixelFormat::RGB565:
+			return "RGB565";
+		case ImageDecoder::PixelFormat::IA8:
+			return "IA8";
+		default:
+			assert(!"Unhandled pixel format.");
+			return "unknown";
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(fromGcn16, ImageDecoderGcnTest,
+	::testing::Values(
+		ImageDecoderGcnTest_mode(ImageDecoder::PixelFormat::RGB5A3),
+		ImageDecoderGcnTest_mode(ImageDecoder::PixelFormat::RGB565),
+		ImageDecoderGcnTest_mode(ImageDecoder::PixelFormat::IA8))
+	, ImageDecoderGcnTest::test_case_suffix_generator);
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder::fromGcn*() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageDecoderGcnTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,362 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderS3TCTest.cpp: S3TC/BCn and BC7 decoder tests.               *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librptexture, librpcpu
+#include "librpbase/aligned_malloc.h"
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+namespace LibRpTexture { namespace Tests {
+
+// Block-compressed formats.
+enum class BlockFormat {
+	DXT1,
+	DXT1_A1,
+	DXT3,
+	DXT5,
+	BC4,
+	BC5,
+	BC7,
+
+	Max
+};
+
+typedef rp_image* (*pfnDecode_t)(int width, int height, const uint8_t *img_buf, int img_siz);
+
+struct BlockFormatInfo {
+	const char *name;
+	unsigned int bytes_per_block;
+	pfnDecode_t pfn_cpp;
+#ifdef IMAGEDECODER_HAS_SSSE3
+	pfnDecode_t pfn_ssse3;
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	pfnDecode_t pfn_dispatch;
+};
+
+// Wrappers for the dispatch functions.
+// NOTE: The dispatch functions may be IFUNCs, and taking the address
+// of an IFUNC in a static initializer runs the resolver before
+// librpcpu is usable, so call them from regular functions instead.
+#define DISPATCH_WRAPPER(name) \
+	static rp_image *dispatch_##name(int width, int height, const uint8_t *img_buf, int img_siz) \
+	{ \
+		return ImageDecoder::from##name(width, height, img_buf, img_siz); \
+	}
+DISPATCH_WRAPPER(DXT1)
+DISPATCH_WRAPPER(DXT1_A1)
+DISPATCH_WRAPPER(DXT3)
+DISPATCH_WRAPPER(DXT5)
+DISPATCH_WRAPPER(BC4)
+DISPATCH_WRAPPER(BC5)
+DISPATCH_WRAPPER(BC7)
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+# define FMT(name, bpb) {#name, bpb, ImageDecoder::from##name##_cpp, ImageDecoder::from##name##_ssse3, dispatch_##name}
+#else /* !IMAGEDECODER_HAS_SSSE3 */
+# define FMT(name, bpb) {#name, bpb, ImageDecoder::from##name##_cpp, dispatch_##name}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+static const BlockFormatInfo formats[] = {
+	FMT(DXT1, 8),
+	FMT(DXT1_A1, 8),
+	FMT(DXT3, 16),
+	FMT(DXT5, 16),
+	FMT(BC4, 8),
+	FMT(BC5, 16),
+	FMT(BC7, 16),
+};
+static_assert(ARRAY_SIZE(formats) == static_cast<size_t>(BlockFormat::Max), "formats[] is out of sync");
+
+struct ImageDecoderS3TCTest_mode
+{
+	BlockFormat format;
+	int width;
+	int height;
+
+	ImageDecoderS3TCTest_mode(BlockFormat format, int width, int height)
+		: format(format)
+		, width(width)
+		, height(height)
+	{ }
+};
+
+class ImageDecoderS3TCTest : public ::testing::TestWithParam<ImageDecoderS3TCTest_mode>
+{
+	protected:
+		ImageDecoderS3TCTest()
+			: m_img_buf(nullptr)
+			, m_img_siz(0)
+			, m_info(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Image buffer.
+		uint8_t *m_img_buf;
+		int m_img_siz;
+
+		// Format information.
+		const BlockFormatInfo *m_info;
+
+		/**
+		 * Compare two ARGB32 rp_images.
+		 * @param img_expected Expected image.
+		 * @param img_actual Actual image.
+		 */
+		static void compareImages(const rp_image *img_expected, const rp_image *img_actual);
+
+	public:
+		/** Test case parameters. **/
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderS3TCTest_mode> &info);
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void ImageDecoderS3TCTest::SetUp(void)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+	m_info = &formats[static_cast<int>(mode.format)];
+
+	const int tilesX = (mode.width + 3) / 4;
+	const int tilesY = (mode.height + 3) / 4;
+	const unsigned int blocks = static_cast<unsigned int>(tilesX * tilesY);
+	m_img_siz = static_cast<int>(blocks * m_info->bytes_per_block);
+	m_img_buf = static_cast<uint8_t*>(aligned_malloc(16, m_img_siz));
+	ASSERT_TRUE(m_img_buf != nullptr);
+
+	// Fill the image buffer with pseudo-random data.
+	// This exercises all palette modes and index values.
+	uint32_t seed = 0x12345678;
+	for (int i = 0; i < m_img_siz; i++) {
+		// xorshift32
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		m_img_buf[i] = static_cast<uint8_t>(seed >> 24);
+	}
+
+	if (mode.format == BlockFormat::BC7) {
+		// Make sure every block has a valid mode.
+		// Mode N is indicated by N zero bits followed by a one bit.
+		for (unsigned int i = 0; i < blocks; i++) {
+			uint8_t *const p = &m_img_buf[i * 16];
+			const unsigned int bc7_mode = (p[1] ^ p[15]) & 7;
+			p[0] &= ~((2U << bc7_mode) - 1);
+			p[0] |= (1U << bc7_mode);
+		}
+	}
+}
+
+/**
+ * TearDown() function.
+ * Run after each test.
+ */
+void ImageDecoderS3TCTest::TearDown(void)
+{
+	aligned_free(m_img_buf);
+	m_img_buf = nullptr;
+}
+
+/**
+ * Compare two ARGB32 rp_images.
+ * @param img_expected Expected image.
+ * @param img_actual Actual image.
+ */
+void ImageDecoderS3TCTest::compareImages(const rp_image *img_expected, const rp_image *img_actual)
+{
+	ASSERT_EQ(img_expected->width(), img_actual->width());
+	ASSERT_EQ(img_expected->height(), img_actual->height());
+	ASSERT_EQ(img_expected->format(), img_actual->format());
+
+	for (int y = 0; y < img_expected->height(); y++) {
+		const uint32_t *px_expected = static_cast<const uint32_t*>(img_expected->scanLine(y));
+		const uint32_t *px_actual = static_cast<const uint32_t*>(img_actual->scanLine(y));
+		for (int x = 0; x < img_expected->width(); x++) {
+			ASSERT_EQ(px_expected[x], px_actual[x]) << "pixel (" << x << "," << y << ")";
+		}
+	}
+
+	// sBIT metadata must match.
+	rp_image::sBIT_t sBIT_expected, sBIT_actual;
+	ASSERT_EQ(0, img_expected->get_sBIT(&sBIT_expected));
+	ASSERT_EQ(0, img_actual->get_sBIT(&sBIT_actual));
+	EXPECT_EQ(0, memcmp(&sBIT_expected, &sBIT_actual, sizeof(sBIT_expected)));
+}
+
+/**
+ * Test the dispatch function.
+ */
+TEST_P(ImageDecoderS3TCTest, dispatch_test)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+
+	rp_image *const img_cpp = m_info->pfn_cpp(mode.width, mode.height, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img_cpp != nullptr);
+	EXPECT_EQ(mode.width, img_cpp->width());
+	EXPECT_EQ(mode.height, img_cpp->height());
+	rp_image *const img = m_info->pfn_dispatch(mode.width, mode.height, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img != nullptr);
+
+	compareImages(img_cpp, img);
+
+	img->unref();
+	img_cpp->unref();
+}
+
+/**
+ * Benchmark the standard version.
+ */
+TEST_P(ImageDecoderS3TCTest, cpp_benchmark)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = m_info->pfn_cpp(mode.width, mode.height, m_img_buf, m_img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Verify that the SSSE3-optimized version matches the standard version.
+ */
+TEST_P(ImageDecoderS3TCTest, ssse3_test)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+
+	rp_image *const img_cpp = m_info->pfn_cpp(mode.width, mode.height, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img_cpp != nullptr);
+	rp_image *const img_ssse3 = m_info->pfn_ssse3(mode.width, mode.height, m_img_buf, m_img_siz);
+	ASSERT_TRUE(img_ssse3 != nullptr);
+
+	compareImages(img_cpp, img_ssse3);
+
+	img_ssse3->unref();
+	img_cpp->unref();
+}
+
+/**
+ * Benchmark the SSSE3-optimized version.
+ */
+TEST_P(ImageDecoderS3TCTest, ssse3_benchmark)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = m_info->pfn_ssse3(mode.width, mode.height, m_img_buf, m_img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+
+/**
+ * Benchmark the dispatch function.
+ */
+TEST_P(ImageDecoderS3TCTest, dispatch_benchmark)
+{
+	const ImageDecoderS3TCTest_mode &mode = GetParam();
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const img = m_info->pfn_dispatch(mode.width, mode.height, m_img_buf, m_img_siz);
+		ASSERT_TRUE(img != nullptr);
+		img->unref();
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string ImageDecoderS3TCTest::test_case_suffix_generator(const ::testing::TestParamInfo<ImageDecoderS3TCTest_mode> &info)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%s_%dx%d",
+		formats[static_cast<int>(info.param.format)].name,
+		info.param.width, info.param.height);
+	return buf;
+}
+
+#define S3TC_TEST_SIZES(fmt) \
+	ImageDecoderS3TCTest_mode(BlockFormat::fmt, 66, 30), \
+	ImageDecoderS3TCTest_mode(BlockFormat::fmt, 256, 256), \
+	ImageDecoderS3TCTest_mode(BlockFormat::fmt, 1024, 1024)
+
+INSTANTIATE_TEST_SUITE_P(S3TC, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_TEST_SIZES(DXT1),
+		S3TC_TEST_SIZES(DXT1_A1),
+		S3TC_TEST_SIZES(DXT3),
+		S3TC_TEST_SIZES(DXT5),
+		S3TC_TEST_SIZES(BC4),
+		S3TC_TEST_SIZES(BC5))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+INSTANTIATE_TEST_SUITE_P(BC7, ImageDecoderS3TCTest,
+	::testing::Values(
+		S3TC_TEST_SIZES(BC7))
+	, ImageDecoderS3TCTest::test_case_suffix_generator);
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder S3TC/BCn and BC7 tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageDecoderS3TCTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
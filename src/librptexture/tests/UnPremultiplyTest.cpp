@@ -84,8 +84,67 @@ TEST_F(UnPremultiplyTest, un_premultiply_sse41_benchmark)
 }
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Verify that un_premultiply_avx2() matches un_premultiply_cpp().
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Use an odd width to test the non-SIMD tail.
+	rp_image *const img_cpp = new rp_image(257, 256, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img_cpp->isValid());
+
+	// Fill the image with every alpha value and a range of color values,
+	// then premultiply it so the color values are valid.
+	for (int y = 0; y < img_cpp->height(); y++) {
+		uint32_t *px = static_cast<uint32_t*>(img_cpp->scanLine(y));
+		for (int x = 0; x < img_cpp->width(); x++) {
+			const uint32_t a = (x + y) & 0xFF;
+			px[x] = (a << 24) | ((x * 7) & 0xFF) << 16 | ((y * 13) & 0xFF) << 8 | ((x ^ y) & 0xFF);
+		}
+	}
+	ASSERT_EQ(0, img_cpp->premultiply_cpp());
+
+	rp_image *const img_avx2 = img_cpp->dup();
+	ASSERT_NE(nullptr, img_avx2);
+	ASSERT_EQ(0, img_cpp->un_premultiply_cpp());
+	ASSERT_EQ(0, img_avx2->un_premultiply_avx2());
+
+	for (int y = 0; y < img_cpp->height(); y++) {
+		const uint32_t *px_cpp = static_cast<const uint32_t*>(img_cpp->scanLine(y));
+		const uint32_t *px_avx2 = static_cast<const uint32_t*>(img_avx2->scanLine(y));
+		for (int x = 0; x < img_cpp->width(); x++) {
+			ASSERT_EQ(px_cpp[x], px_avx2[x]) << "pixel (" << x << "," << y << ")";
+		}
+	}
+
+	img_avx2->unref();
+	img_cpp->unref();
+}
+
+/**
+ * Benchmark the ImageDecoder::un_premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->un_premultiply_avx2();
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(RP_IMAGE_HAS_SSE41)
+#if defined(RP_IMAGE_HAS_SSE41) || defined(RP_IMAGE_HAS_AVX2)
 /**
  * Benchmark the ImageDecoder::un_premultiply() dispatch function.
  */
@@ -95,17 +154,84 @@ TEST_F(UnPremultiplyTest, un_premultiply_dispatch_benchmark)
 		m_img->un_premultiply();
 	}
 }
-#endif /* RP_IMAGE_HAS_SSE41 */
+#endif /* RP_IMAGE_HAS_SSE41 || RP_IMAGE_HAS_AVX2 */
 
 /**
  * Benchmark the ImageDecoder::premultiply() function. (Standard version)
  */
 TEST_F(UnPremultiplyTest, premultiply_cpp)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_cpp();
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Verify that premultiply_sse2() matches premultiply_cpp().
+ */
+TEST_F(UnPremultiplyTest, premultiply_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Use an odd width to test the non-SIMD tail.
+	rp_image *const img_cpp = new rp_image(257, 256, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img_cpp->isValid());
+
+	// Fill the image with every alpha value and a range of color values.
+	for (int y = 0; y < img_cpp->height(); y++) {
+		uint32_t *px = static_cast<uint32_t*>(img_cpp->scanLine(y));
+		for (int x = 0; x < img_cpp->width(); x++) {
+			const uint32_t a = (x + y) & 0xFF;
+			px[x] = (a << 24) | ((x * 7) & 0xFF) << 16 | ((y * 13) & 0xFF) << 8 | ((x ^ y) & 0xFF);
+		}
+	}
+
+	rp_image *const img_sse2 = img_cpp->dup();
+	ASSERT_NE(nullptr, img_sse2);
+	ASSERT_EQ(0, img_cpp->premultiply_cpp());
+	ASSERT_EQ(0, img_sse2->premultiply_sse2());
+
+	for (int y = 0; y < img_cpp->height(); y++) {
+		const uint32_t *px_cpp = static_cast<const uint32_t*>(img_cpp->scanLine(y));
+		const uint32_t *px_sse2 = static_cast<const uint32_t*>(img_sse2->scanLine(y));
+		for (int x = 0; x < img_cpp->width(); x++) {
+			ASSERT_EQ(px_cpp[x], px_sse2[x]) << "pixel (" << x << "," << y << ")";
+		}
+	}
+
+	img_sse2->unref();
+	img_cpp->unref();
+}
+
+/**
+ * Benchmark the ImageDecoder::premultiply() function. (SSE2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, premultiply_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_sse2();
+	}
+}
+
+/**
+ * Benchmark the ImageDecoder::premultiply() dispatch function.
+ */
+TEST_F(UnPremultiplyTest, premultiply_dispatch_benchmark)
 {
 	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
 		m_img->premultiply();
 	}
 }
+#endif /* RP_IMAGE_HAS_SSE2 */
 
 } }
 
@@ -115,7 +241,7 @@ TEST_F(UnPremultiplyTest, premultiply_cpp)
  */
 extern "C" int gtest_main(int argc, TCHAR *argv[])
 {
-	fprintf(stderr, "LibRpTexture test suite: rp_image::un_premultiply() tests.\n\n");
+	fprintf(stderr, "LibRpTexture test suite: rp_image::un_premultiply() and premultiply() tests.\n\n");
 	fprintf(stderr, "Benchmark iterations: %u\n",
 		LibRpTexture::Tests::UnPremultiplyTest::BENCHMARK_ITERATIONS);
 	fflush(nullptr);
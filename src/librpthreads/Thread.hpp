@@ -0,0 +1,57 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * Thread.hpp: System-specific thread implementation.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTHREADS_THREAD_HPP__
+#define __ROMPROPERTIES_LIBRPTHREADS_THREAD_HPP__
+
+// NOTE: The .cpp files are #included here in order to inline the functions.
+// Do NOT compile them separately!
+
+// Each .cpp file defines the Thread class itself, with required fields.
+
+#ifdef _WIN32
+# include "ThreadWin32.cpp"
+#else /* !_WIN32 */
+# include "ThreadPosix.cpp"
+#endif
+
+namespace LibRpThreads {
+
+/**
+ * Start the thread using a function object, e.g. a lambda.
+ * The function object is copied.
+ * @param func Function object.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+template<typename F>
+inline int Thread::create(const F &func)
+{
+	F *const pFunc = new F(func);
+	int ret = create(functorProc<F>, pFunc);
+	if (ret != 0) {
+		// Thread wasn't started.
+		delete pFunc;
+	}
+	return ret;
+}
+
+/**
+ * Function object thread function.
+ * @param param Heap-allocated copy of the function object.
+ */
+template<typename F>
+inline void Thread::functorProc(void *param)
+{
+	F *const pFunc = static_cast<F*>(param);
+	(*pFunc)();
+	delete pFunc;
+}
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPTHREADS_THREAD_HPP__ */
@@ -0,0 +1,222 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPosix.cpp: POSIX thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpThreads {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param param User-specified parameter.
+		 */
+		typedef void (*ThreadProc)(void *param);
+
+		/**
+		 * Create a thread object.
+		 * The thread isn't started until create() is called.
+		 */
+		inline explicit Thread();
+
+		/**
+		 * Delete the thread object.
+		 * If the thread is still running, it will be joined.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete; \
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &); \
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Start the thread.
+		 * @param proc Thread function.
+		 * @param param Parameter for the thread function.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int create(ThreadProc proc, void *param);
+
+		/**
+		 * Start the thread using a function object, e.g. a lambda.
+		 * The function object is copied.
+		 * @param func Function object.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		template<typename F>
+		inline int create(const F &func);
+
+		/**
+		 * Wait for the thread to exit.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Detach the thread.
+		 * The thread will continue running, but it can't be joined.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int detach(void);
+
+		/**
+		 * Has the thread been started and not joined yet?
+		 * @return True if the thread is joinable; false if not.
+		 */
+		inline bool isJoinable(void) const
+		{
+			return m_isJoinable;
+		}
+
+		/**
+		 * Get the number of CPUs available to run threads.
+		 * @return Number of CPUs. (Always at least 1.)
+		 */
+		static inline unsigned int hardwareConcurrency(void);
+
+	private:
+		/**
+		 * Thread entry point.
+		 * @param param Thread object.
+		 * @return nullptr
+		 */
+		static inline void *threadEntry(void *param);
+
+		/**
+		 * Function object thread function.
+		 * @param param Heap-allocated copy of the function object.
+		 */
+		template<typename F>
+		static inline void functorProc(void *param);
+
+	private:
+		pthread_t m_thread;
+		ThreadProc m_proc;
+		void *m_param;
+		bool m_isJoinable;
+};
+
+/**
+ * Create a thread object.
+ * The thread isn't started until create() is called.
+ */
+inline Thread::Thread()
+	: m_proc(nullptr)
+	, m_param(nullptr)
+	, m_isJoinable(false)
+{ }
+
+/**
+ * Delete the thread object.
+ * If the thread is still running, it will be joined.
+ */
+inline Thread::~Thread()
+{
+	if (m_isJoinable) {
+		join();
+	}
+}
+
+/**
+ * Start the thread.
+ * @param proc Thread function.
+ * @param param Parameter for the thread function.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::create(ThreadProc proc, void *param)
+{
+	assert(proc != nullptr);
+	assert(!m_isJoinable);
+	if (!proc) {
+		return -EINVAL;
+	} else if (m_isJoinable) {
+		return -EBUSY;
+	}
+
+	m_proc = proc;
+	m_param = param;
+	int ret = pthread_create(&m_thread, nullptr, threadEntry, this);
+	if (ret != 0) {
+		// pthread_create() returns a positive error code.
+		return -ret;
+	}
+	m_isJoinable = true;
+	return 0;
+}
+
+/**
+ * Wait for the thread to exit.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_isJoinable)
+		return -EBADF;
+
+	int ret = pthread_join(m_thread, nullptr);
+	assert(ret == 0);
+	m_isJoinable = false;
+	return -ret;
+}
+
+/**
+ * Detach the thread.
+ * The thread will continue running, but it can't be joined.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::detach(void)
+{
+	if (!m_isJoinable)
+		return -EBADF;
+
+	int ret = pthread_detach(m_thread);
+	assert(ret == 0);
+	m_isJoinable = false;
+	return -ret;
+}
+
+/**
+ * Get the number of CPUs available to run threads.
+ * @return Number of CPUs. (Always at least 1.)
+ */
+inline unsigned int Thread::hardwareConcurrency(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	if (ncpu > 0) {
+		return static_cast<unsigned int>(ncpu);
+	}
+#endif /* _SC_NPROCESSORS_ONLN */
+	return 1;
+}
+
+/**
+ * Thread entry point.
+ * @param param Thread object.
+ * @return nullptr
+ */
+inline void *Thread::threadEntry(void *param)
+{
+	Thread *const pThread = static_cast<Thread*>(param);
+	pThread->m_proc(pThread->m_param);
+	return nullptr;
+}
+
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadWin32.cpp: Win32 thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#include <process.h>	// _beginthreadex()
+
+namespace LibRpThreads {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param param User-specified parameter.
+		 */
+		typedef void (*ThreadProc)(void *param);
+
+		/**
+		 * Create a thread object.
+		 * The thread isn't started until create() is called.
+		 */
+		inline explicit Thread();
+
+		/**
+		 * Delete the thread object.
+		 * If the thread is still running, it will be joined.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete; \
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &); \
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Start the thread.
+		 * @param proc Thread function.
+		 * @param param Parameter for the thread function.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int create(ThreadProc proc, void *param);
+
+		/**
+		 * Start the thread using a function object, e.g. a lambda.
+		 * The function object is copied.
+		 * @param func Function object.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		template<typename F>
+		inline int create(const F &func);
+
+		/**
+		 * Wait for the thread to exit.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Detach the thread.
+		 * The thread will continue running, but it can't be joined.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int detach(void);
+
+		/**
+		 * Has the thread been started and not joined yet?
+		 * @return True if the thread is joinable; false if not.
+		 */
+		inline bool isJoinable(void) const
+		{
+			return (m_hThread != nullptr);
+		}
+
+		/**
+		 * Get the number of CPUs available to run threads.
+		 * @return Number of CPUs. (Always at least 1.)
+		 */
+		static inline unsigned int hardwareConcurrency(void);
+
+	private:
+		/**
+		 * Thread entry point.
+		 * @param param Thread object.
+		 * @return 0
+		 */
+		static inline unsigned int __stdcall threadEntry(void *param);
+
+		/**
+		 * Function object thread function.
+		 * @param param Heap-allocated copy of the function object.
+		 */
+		template<typename F>
+		static inline void functorProc(void *param);
+
+	private:
+		HANDLE m_hThread;
+		ThreadProc m_proc;
+		void *m_param;
+};
+
+/**
+ * Create a thread object.
+ * The thread isn't started until create() is called.
+ */
+inline Thread::Thread()
+	: m_hThread(nullptr)
+	, m_proc(nullptr)
+	, m_param(nullptr)
+{ }
+
+/**
+ * Delete the thread object.
+ * If the thread is still running, it will be joined.
+ */
+inline Thread::~Thread()
+{
+	if (m_hThread) {
+		join();
+	}
+}
+
+/**
+ * Start the thread.
+ * @param proc Thread function.
+ * @param param Parameter for the thread function.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::create(ThreadProc proc, void *param)
+{
+	assert(proc != nullptr);
+	assert(m_hThread == nullptr);
+	if (!proc) {
+		return -EINVAL;
+	} else if (m_hThread) {
+		return -EBUSY;
+	}
+
+	m_proc = proc;
+	m_param = param;
+
+	// NOTE: _beginthreadex() is used instead of CreateThread()
+	// in order to initialize the CRT's per-thread data.
+	const uintptr_t hThread = _beginthreadex(nullptr, 0, threadEntry, this, 0, nullptr);
+	if (hThread == 0) {
+		// _beginthreadex() sets errno on error.
+		const int err = errno;
+		return (err != 0 ? -err : -EAGAIN);
+	}
+	m_hThread = reinterpret_cast<HANDLE>(hThread);
+	return 0;
+}
+
+/**
+ * Wait for the thread to exit.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_hThread)
+		return -EBADF;
+
+	const DWORD dwRet = WaitForSingleObject(m_hThread, INFINITE);
+	assert(dwRet == WAIT_OBJECT_0);
+	CloseHandle(m_hThread);
+	m_hThread = nullptr;
+	return (dwRet == WAIT_OBJECT_0 ? 0 : -EINVAL);
+}
+
+/**
+ * Detach the thread.
+ * The thread will continue running, but it can't be joined.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::detach(void)
+{
+	if (!m_hThread)
+		return -EBADF;
+
+	CloseHandle(m_hThread);
+	m_hThread = nullptr;
+	return 0;
+}
+
+/**
+ * Get the number of CPUs available to run threads.
+ * @return Number of CPUs. (Always at least 1.)
+ */
+inline unsigned int Thread::hardwareConcurrency(void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (si.dwNumberOfProcessors > 0 ? si.dwNumberOfProcessors : 1);
+}
+
+/**
+ * Thread entry point.
+ * @param param Thread object.
+ * @return 0
+ */
+inline unsigned int __stdcall Thread::threadEntry(void *param)
+{
+	Thread *const pThread = static_cast<Thread*>(param);
+	pThread->m_proc(pThread->m_param);
+	return 0;
+}
+
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ * ROM Properties Page shell extension.                                    *
+ * monotonic_time.h: Monotonic clock for timing measurements.              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_MONOTONIC_TIME_H__
+#define __ROMPROPERTIES_MONOTONIC_TIME_H__
+
+// NOTE: Not using std::chrono, since <chrono>
+// isn't available on older compilers, e.g. MSVC 2010.
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#  include "libwin32common/RpWin32_sdk.h"
+#else /* !_WIN32 */
+#  include <time.h>
+#  ifndef CLOCK_MONOTONIC
+#    include <sys/time.h>
+#  endif /* !CLOCK_MONOTONIC */
+#endif /* _WIN32 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the current time from a monotonic clock.
+ * This is only useful for measuring intervals.
+ * @return Time, in microseconds.
+ */
+static inline uint64_t rp_monotonic_time_us(void)
+{
+#if defined(_WIN32)
+	// NOTE: QueryPerformanceFrequency() is constant
+	// after the system boots, so it only needs to be
+	// retrieved once.
+	static LARGE_INTEGER freq = {{0, 0}};
+	LARGE_INTEGER count;
+	if (freq.QuadPart == 0) {
+		QueryPerformanceFrequency(&freq);
+	}
+	QueryPerformanceCounter(&count);
+
+	// Split the division to prevent overflow.
+	return (uint64_t)((count.QuadPart / freq.QuadPart) * 1000000) +
+	       (uint64_t)((count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U);
+#else
+	// No monotonic clock. Use the wall clock instead.
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((uint64_t)tv.tv_sec * 1000000U) + (uint64_t)tv.tv_usec;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_MONOTONIC_TIME_H__ */
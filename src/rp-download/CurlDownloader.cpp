@@ -12,23 +12,33 @@
 // C++ STL classes.
 using std::string;
 
-// cURL for network access.
-#include <curl/curl.h>
-
 namespace RpDownload {
 
 CurlDownloader::CurlDownloader()
 	: super()
+	, m_curl(nullptr)
+	, m_share(nullptr)
 { }
 
 CurlDownloader::CurlDownloader(const TCHAR *url)
 	: super(url)
+	, m_curl(nullptr)
+	, m_share(nullptr)
 { }
 
 CurlDownloader::CurlDownloader(const tstring &url)
 	: super(url)
+	, m_curl(nullptr)
+	, m_share(nullptr)
 { }
 
+CurlDownloader::~CurlDownloader()
+{
+	if (m_curl) {
+		curl_easy_cleanup(m_curl);
+	}
+}
+
 /**
  * Internal cURL data write function.
  * @param ptr Data to write.
@@ -151,10 +161,24 @@ size_t CurlDownloader::parse_header(char *ptr, size_t size, size_t nitems, void
 }
 
 /**
- * Download the file.
- * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ * Set a cURL share handle.
+ * This allows DNS and TLS session data to be shared
+ * between multiple CurlDownloader objects.
+ * @param share cURL share handle. (nullptr to disable sharing)
  */
-int CurlDownloader::download(void)
+void CurlDownloader::setShare(CURLSH *share)
+{
+	assert(!m_inProgress);
+	m_share = share;
+}
+
+/**
+ * Prepare the cURL easy handle for downloading the file.
+ * The handle is reused for subsequent downloads, which
+ * allows connections to be reused.
+ * @return cURL easy handle, or nullptr on error. (owned by this object)
+ */
+CURL *CurlDownloader::beginDownload(void)
 {
 	// References:
 	// - http://stackoverflow.com/questions/1636333/download-file-using-libcurl-in-c-c
@@ -166,11 +190,14 @@ int CurlDownloader::download(void)
 	m_mtime = -1;
 
 	// Initialize cURL.
-	CURL *curl = curl_easy_init();
-	if (!curl) {
-		// Could not initialize cURL.
-		return -ENOMEM;	// TODO: Better error?
+	if (!m_curl) {
+		m_curl = curl_easy_init();
+		if (!m_curl) {
+			// Could not initialize cURL.
+			return nullptr;
+		}
 	}
+	CURL *const curl = m_curl;
 
 	// Proxy settings should be set by the calling application
 	// in the http_proxy and https_proxy variables.
@@ -186,6 +213,20 @@ int CurlDownloader::download(void)
 	// TODO: Limit the number of redirects?
 	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, true);
 
+#if LIBCURL_VERSION_NUM >= 0x072F00
+	// Use HTTP/2 for https:// if the server supports it.
+	// This allows multiple downloads to be multiplexed
+	// over a single connection when using a multi handle.
+	// NOTE: Default as of cURL 7.62.0.
+	curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+	// Wait for an existing connection to be available for
+	// multiplexing instead of opening a new connection.
+	curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+#endif /* LIBCURL_VERSION_NUM >= 0x072F00 */
+
+	// Shared DNS and TLS session cache.
+	curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+
 	// Header and data functions.
 	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, parse_header);
 	curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
@@ -206,15 +247,26 @@ int CurlDownloader::download(void)
 	// Set the User-Agent.
 	curl_easy_setopt(curl, CURLOPT_USERAGENT, m_userAgent.c_str());
 
-	// TODO: Set the User-Agent?
-	CURLcode res = curl_easy_perform(curl);
-	curl_easy_cleanup(curl);
+	m_inProgress = true;
+	return curl;
+}
+
+/**
+ * Finish a download started with beginDownload().
+ * @param res cURL result code.
+ * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::endDownload(CURLcode res)
+{
+	assert(m_curl != nullptr);
+	m_inProgress = false;
+
 	if (res != CURLE_OK) {
 		// Error downloading the file.
 		// Check if we have an HTTP response code.
 		// NOTE: GameTDB sometimes returns nothing instead of 404...
 		long response_code = 0;
-		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+		curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &response_code);
 		if (response_code <= 0) {
 			// No HTTP response code.
 			// TODO: Return a cURL error code and/or message...
@@ -233,4 +285,19 @@ int CurlDownloader::download(void)
 	return 0;
 }
 
+/**
+ * Download the file.
+ * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::download(void)
+{
+	CURL *const curl = beginDownload();
+	if (!curl) {
+		// Could not initialize cURL.
+		return -ENOMEM;	// TODO: Better error?
+	}
+
+	return endDownload(curl_easy_perform(curl));
+}
+
 }
@@ -11,6 +11,9 @@
 
 #include "IDownloader.hpp"
 
+// cURL for network access.
+#include <curl/curl.h>
+
 namespace RpDownload {
 
 class CurlDownloader final : public IDownloader
@@ -19,6 +22,7 @@ class CurlDownloader final : public IDownloader
 		CurlDownloader();
 		explicit CurlDownloader(const TCHAR *url);
 		explicit CurlDownloader(const std::tstring &url);
+		~CurlDownloader() final;
 
 	private:
 		typedef IDownloader super;
@@ -51,6 +55,36 @@ class CurlDownloader final : public IDownloader
 		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
 		 */
 		int download(void) final;
+
+	public:
+		/** Asynchronous downloads. (used with a cURL multi handle) **/
+
+		/**
+		 * Set a cURL share handle.
+		 * This allows DNS and TLS session data to be shared
+		 * between multiple CurlDownloader objects.
+		 * @param share cURL share handle. (nullptr to disable sharing)
+		 */
+		void setShare(CURLSH *share);
+
+		/**
+		 * Prepare the cURL easy handle for downloading the file.
+		 * The handle is reused for subsequent downloads, which
+		 * allows connections to be reused.
+		 * @return cURL easy handle, or nullptr on error. (owned by this object)
+		 */
+		CURL *beginDownload(void);
+
+		/**
+		 * Finish a download started with beginDownload().
+		 * @param res cURL result code.
+		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+		 */
+		int endDownload(CURLcode res);
+
+	private:
+		CURL *m_curl;		// cURL easy handle
+		CURLSH *m_share;	// cURL share handle (not owned by this object)
 };
 
 }
@@ -0,0 +1,454 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * DownloadServer.cpp: Persistent download server. (cURL)                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "DownloadServer.hpp"
+#include "CurlDownloader.hpp"
+#include "rp-download.hpp"
+
+// C includes.
+#include <poll.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <ctime>
+
+// C++ includes.
+#include <deque>
+#include <memory>
+#include <vector>
+using std::deque;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace RpDownload {
+
+class DownloadServer
+{
+	public:
+		explicit DownloadServer(bool force);
+		~DownloadServer();
+
+	private:
+		RP_DISABLE_COPY(DownloadServer)
+
+	public:
+		/**
+		 * Run the server.
+		 * @return Exit status.
+		 */
+		int run(void);
+
+	private:
+		/**
+		 * Read requests from stdin.
+		 * Only data that's already available is read.
+		 * Complete lines are added to the request queue.
+		 */
+		void readRequests(void);
+
+		/**
+		 * Start a request.
+		 * If the file doesn't need to be downloaded,
+		 * the result will be sent immediately.
+		 * @param cache_key Cache key.
+		 */
+		void startRequest(const string &cache_key);
+
+		/**
+		 * Finish a transfer.
+		 * @param curl cURL easy handle.
+		 * @param res cURL result code.
+		 */
+		void finishTransfer(CURL *curl, CURLcode res);
+
+		/**
+		 * Send a result to the client.
+		 * @param status Exit status.
+		 * @param cache_key Cache key.
+		 */
+		void sendResult(int status, const string &cache_key);
+
+	private:
+		// Maximum number of simultaneous transfers.
+		// Additional requests are queued.
+		static const unsigned int MAX_TRANSFERS = 8;
+		// Maximum number of connections per host.
+		static const long MAX_HOST_CONNECTIONS = 4;
+		// Maximum length of a request line.
+		static const size_t MAX_LINE_LENGTH = 1024;
+		// Exit if no requests have been received for this long. (seconds)
+		static const time_t IDLE_TIMEOUT = 5*60;
+
+		struct Transfer {
+			DownloadRequest req;
+			unique_ptr<CurlDownloader> downloader;
+			CURL *curl;	// owned by downloader
+		};
+
+		bool m_force;		// Redownload files even if they're already cached.
+		bool m_eof;		// stdin has been closed.
+		bool m_lineTooLong;	// Current request line is too long; discard it.
+		time_t m_lastActivity;	// Time of the last request or transfer.
+
+		CURLM *m_multi;		// cURL multi handle
+		CURLSH *m_share;	// cURL share handle (DNS and TLS sessions)
+
+		string m_inbuf;		// Partial request line
+		deque<string> m_queue;	// Queued requests
+
+		// Active transfers.
+		// NOTE: Transfer objects are referenced by CURLOPT_PRIVATE.
+		vector<Transfer*> m_transfers;
+
+		// Idle downloaders. These are reused so the
+		// cURL easy handles don't have to be reinitialized.
+		vector<unique_ptr<CurlDownloader> > m_idle;
+};
+
+DownloadServer::DownloadServer(bool force)
+	: m_force(force)
+	, m_eof(false)
+	, m_lineTooLong(false)
+	, m_lastActivity(time(nullptr))
+	, m_multi(nullptr)
+	, m_share(nullptr)
+{
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+
+	// Share DNS and TLS session data between transfers.
+	// NOTE: Connections are shared by the multi handle.
+	m_share = curl_share_init();
+	if (m_share) {
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
+
+	m_multi = curl_multi_init();
+	if (m_multi) {
+#if LIBCURL_VERSION_NUM >= 0x072B00
+		// Multiplex transfers over a single HTTP/2 connection if possible.
+		curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif /* LIBCURL_VERSION_NUM >= 0x072B00 */
+		curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, MAX_HOST_CONNECTIONS);
+	}
+}
+
+DownloadServer::~DownloadServer()
+{
+	for (Transfer *transfer : m_transfers) {
+		curl_multi_remove_handle(m_multi, transfer->curl);
+		if (transfer->req.f_out) {
+			fclose(transfer->req.f_out);
+		}
+		delete transfer;
+	}
+
+	// NOTE: Easy handles must be cleaned up before the share handle.
+	m_idle.clear();
+	if (m_multi) {
+		curl_multi_cleanup(m_multi);
+	}
+	if (m_share) {
+		curl_share_cleanup(m_share);
+	}
+	curl_global_cleanup();
+}
+
+/**
+ * Read requests from stdin.
+ * Only data that's already available is read.
+ * Complete lines are added to the request queue.
+ */
+void DownloadServer::readRequests(void)
+{
+	// NOTE: stdin is not set to non-blocking mode, since the client
+	// may use the same socket for stdin and stdout, and O_NONBLOCK
+	// would affect both. Instead, poll() is used to check if data is
+	// available, in which case read() won't block.
+	// POLLHUP and POLLERR are handled by read() returning 0 or -1.
+	char buf[4096];
+	ssize_t size = -1;
+	while (true) {
+		struct pollfd pfd;
+		pfd.fd = STDIN_FILENO;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		const int ret = poll(&pfd, 1, 0);
+		if (ret == 0) {
+			// No data available.
+			return;
+		} else if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			// poll() failed.
+			m_eof = true;
+			return;
+		}
+
+		size = read(STDIN_FILENO, buf, sizeof(buf));
+		if (size <= 0)
+			break;
+		m_lastActivity = time(nullptr);
+
+		const char *p = buf;
+		const char *const p_end = buf + size;
+		while (p < p_end) {
+			const char *const nl = static_cast<const char*>(memchr(p, '\n', p_end - p));
+			const char *const p_line_end = (nl ? nl : p_end);
+
+			if (!m_lineTooLong) {
+				m_inbuf.append(p, p_line_end - p);
+				if (m_inbuf.size() > MAX_LINE_LENGTH) {
+					// Line is too long. Discard it.
+					m_inbuf.clear();
+					m_lineTooLong = true;
+				}
+			}
+
+			if (!nl) {
+				// Partial line.
+				break;
+			}
+
+			// End of line.
+			if (!m_inbuf.empty() && m_inbuf[m_inbuf.size()-1] == '\r') {
+				m_inbuf.resize(m_inbuf.size()-1);
+			}
+			if (m_lineTooLong) {
+				sendResult(EXIT_FAILURE, string());
+			} else if (!m_inbuf.empty()) {
+				m_queue.emplace_back(std::move(m_inbuf));
+			}
+			m_inbuf.clear();
+			m_lineTooLong = false;
+			p = nl + 1;
+		}
+	}
+
+	if (size == 0) {
+		// End of file.
+		m_eof = true;
+	} else if (errno != EINTR) {
+		// Read error.
+		m_eof = true;
+	}
+}
+
+/**
+ * Start a request.
+ * If the file doesn't need to be downloaded,
+ * the result will be sent immediately.
+ * @param cache_key Cache key.
+ */
+void DownloadServer::startRequest(const string &cache_key)
+{
+	unique_ptr<Transfer> transfer(new Transfer);
+	transfer->req.cache_key = cache_key;
+	int status = EXIT_FAILURE;
+	if (!prepareDownload(transfer->req, m_force, &status)) {
+		// File does not need to be downloaded.
+		sendResult(status, cache_key);
+		return;
+	}
+
+	// Reuse an idle downloader if one is available.
+	if (!m_idle.empty()) {
+		transfer->downloader = std::move(m_idle.back());
+		m_idle.pop_back();
+	} else {
+		transfer->downloader.reset(new CurlDownloader());
+		transfer->downloader->setMaxSize(MAX_DOWNLOAD_SIZE);
+		transfer->downloader->setShare(m_share);
+	}
+
+	transfer->downloader->setUrl(transfer->req.full_url);
+	CURL *const curl = transfer->downloader->beginDownload();
+	if (curl) {
+		transfer->curl = curl;
+		curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+	}
+	if (!curl || curl_multi_add_handle(m_multi, curl) != CURLM_OK) {
+		// Could not start the transfer.
+		status = finishDownload(transfer->req, transfer->downloader.get(), -ENOMEM);
+		sendResult(status, cache_key);
+		return;
+	}
+
+	m_transfers.emplace_back(transfer.release());
+}
+
+/**
+ * Finish a transfer.
+ * @param curl cURL easy handle.
+ * @param res cURL result code.
+ */
+void DownloadServer::finishTransfer(CURL *curl, CURLcode res)
+{
+	char *priv = nullptr;
+	curl_easy_getinfo(curl, CURLINFO_PRIVATE, &priv);
+	Transfer *const transfer = reinterpret_cast<Transfer*>(priv);
+	assert(transfer != nullptr);
+	if (!transfer)
+		return;
+
+	curl_multi_remove_handle(m_multi, curl);
+	for (auto iter = m_transfers.begin(); iter != m_transfers.end(); ++iter) {
+		if (*iter == transfer) {
+			m_transfers.erase(iter);
+			break;
+		}
+	}
+
+	CurlDownloader *const downloader = transfer->downloader.get();
+	const int status = finishDownload(transfer->req, downloader, downloader->endDownload(res));
+	sendResult(status, transfer->req.cache_key);
+
+	// Keep the downloader for the next request.
+	m_idle.emplace_back(std::move(transfer->downloader));
+	delete transfer;
+}
+
+/**
+ * Send a result to the client.
+ * @param status Exit status.
+ * @param cache_key Cache key.
+ */
+void DownloadServer::sendResult(int status, const string &cache_key)
+{
+	string line;
+	line.reserve(cache_key.size() + 8);
+	line += std::to_string(status);
+	line += '\t';
+	line += cache_key;
+	line += '\n';
+
+	const char *p = line.data();
+	size_t size = line.size();
+	while (size > 0) {
+		const ssize_t written = write(STDOUT_FILENO, p, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				// stdout was set to non-blocking mode by the client,
+				// and the client isn't reading responses fast enough.
+				// Wait until stdout is writable.
+				struct pollfd pfd;
+				pfd.fd = STDOUT_FILENO;
+				pfd.events = POLLOUT;
+				pfd.revents = 0;
+				if (poll(&pfd, 1, -1) >= 0 || errno == EINTR)
+					continue;
+			}
+			// Client is gone. No more requests will be received.
+			m_eof = true;
+			break;
+		}
+		p += written;
+		size -= written;
+	}
+}
+
+/**
+ * Run the server.
+ * @return Exit status.
+ */
+int DownloadServer::run(void)
+{
+	if (!m_multi) {
+		// Could not initialize cURL.
+		if (verbose) {
+			fputs("rp-download: Unable to initialize cURL.\n", stderr);
+		}
+		return EXIT_FAILURE;
+	}
+
+	while (true) {
+		// Start queued requests.
+		while (!m_queue.empty() && m_transfers.size() < MAX_TRANSFERS) {
+			const string cache_key = std::move(m_queue.front());
+			m_queue.pop_front();
+			startRequest(cache_key);
+		}
+
+		if (m_transfers.empty() && m_queue.empty()) {
+			if (m_eof) {
+				// No more requests.
+				break;
+			}
+			if (time(nullptr) - m_lastActivity >= IDLE_TIMEOUT) {
+				// Idle for too long.
+				if (verbose) {
+					fputs("rp-download: Idle timeout; exiting.\n", stderr);
+				}
+				break;
+			}
+		}
+
+		// Process transfers.
+		int running = 0;
+		curl_multi_perform(m_multi, &running);
+
+		CURLMsg *msg;
+		int msgs_left;
+		while ((msg = curl_multi_info_read(m_multi, &msgs_left)) != nullptr) {
+			if (msg->msg == CURLMSG_DONE) {
+				finishTransfer(msg->easy_handle, msg->data.result);
+				m_lastActivity = time(nullptr);
+			}
+		}
+		if (!m_queue.empty() && m_transfers.size() < MAX_TRANSFERS) {
+			// More requests can be started now.
+			continue;
+		}
+
+		// Wait for network activity or a new request.
+		struct curl_waitfd waitfd;
+		waitfd.fd = STDIN_FILENO;
+		waitfd.events = CURL_WAIT_POLLIN;
+		waitfd.revents = 0;
+		curl_multi_wait(m_multi, (m_eof ? nullptr : &waitfd), (m_eof ? 0 : 1), 1000, nullptr);
+
+		// NOTE: revents isn't checked, since pipes report
+		// POLLHUP without POLLIN when the client exits.
+		// readRequests() only reads data that's available.
+		if (!m_eof) {
+			readRequests();
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Run the persistent download server.
+ *
+ * Cache keys are read from stdin, one per line.
+ * When a request is finished, "status\tcache_key\n" is written
+ * to stdout, where status is the exit status that rp-download
+ * would have returned for the cache key.
+ *
+ * Downloads are multiplexed using a cURL multi handle, so
+ * connections and TLS sessions are reused between requests.
+ *
+ * The server exits once stdin is closed and all requests
+ * have been completed, or if it has been idle for a while.
+ *
+ * @param force If true, redownload files even if they're already cached.
+ * @return Exit status.
+ */
+int runDownloadServer(bool force)
+{
+	DownloadServer server(force);
+	return server.run();
+}
+
+}
@@ -0,0 +1,35 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * DownloadServer.hpp: Persistent download server. (cURL)                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RP_DOWNLOAD_DOWNLOADSERVER_HPP__
+#define __ROMPROPERTIES_RP_DOWNLOAD_DOWNLOADSERVER_HPP__
+
+namespace RpDownload {
+
+/**
+ * Run the persistent download server.
+ *
+ * Cache keys are read from stdin, one per line.
+ * When a request is finished, "status\tcache_key\n" is written
+ * to stdout, where status is the exit status that rp-download
+ * would have returned for the cache key.
+ *
+ * Downloads are multiplexed using a cURL multi handle, so
+ * connections and TLS sessions are reused between requests.
+ *
+ * The server exits once stdin is closed and all requests
+ * have been completed, or if it has been idle for a while.
+ *
+ * @param force If true, redownload files even if they're already cached.
+ * @return Exit status.
+ */
+int runDownloadServer(bool force);
+
+}
+
+#endif /* __ROMPROPERTIES_RP_DOWNLOAD_DOWNLOADSERVER_HPP__ */
@@ -69,13 +69,17 @@ using std::unique_ptr;
 # include "CurlDownloader.hpp"
 #endif
 #include "SetFileOriginInfo.hpp"
+#include "rp-download.hpp"
+#ifndef _WIN32
+# include "DownloadServer.hpp"
+#endif /* !_WIN32 */
 using namespace RpDownload;
 
 // HTTP status codes.
 #include "http-status.h"
 
 static const TCHAR *argv0 = nullptr;
-static bool verbose = false;
+bool verbose = false;
 
 /**
  * Show command usage.
@@ -83,6 +87,11 @@ static bool verbose = false;
 static void show_usage(void)
 {
 	_ftprintf(stderr, _T("Syntax: %s [-v] [-f] cache_key\n"), argv0);
+#ifndef _WIN32
+	_ftprintf(stderr, _T("Server mode: %s [-v] [-f] -s\n"), argv0);
+	_ftprintf(stderr, _T("  Cache keys are read from stdin, one per line.\n"));
+	_ftprintf(stderr, _T("  Results are written to stdout as \"status\\tcache_key\".\n"));
+#endif /* !_WIN32 */
 }
 
 /**
@@ -288,181 +297,22 @@ int rmkdir(const tstring &path)
 }
 
 /**
- * rp-download: Download an image from a supported online database.
- * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
- * @return 0 on success; non-zero on error.
+ * Prepare a download request.
  *
- * TODO:
- * - More error codes based on the error.
+ * This validates the cache key, determines the full URL,
+ * checks the cache file, and opens the cache file for writing.
+ *
+ * @param req		[in/out] Download request. (cache_key must be set)
+ * @param force		If true, redownload the file even if it's already cached.
+ * @param pExitStatus	[out] Exit status if the file does not need to be downloaded.
+ * @return True if the file needs to be downloaded; false if not.
  */
-int RP_C_API _tmain(int argc, TCHAR *argv[])
+bool prepareDownload(DownloadRequest &req, bool force, int *pExitStatus)
 {
-	// Create a downloader based on OS:
-	// - Linux: CurlDownloader
-	// - Windows: WinInetDownloader
-
-	// Syntax: rp-download cache_key
-	// Example: rp-download ds/coverM/US/ADAE.png
-
-	// If http_proxy or https_proxy are set, they will be used
-	// by the downloader code if supported.
-
-	// Reduce process integrity, if available.
-	rp_secure_reduce_integrity();
-
-	// Set OS-specific security options.
-	rp_secure_param_t param;
-#if defined(_WIN32)
-	param.bHighSec = FALSE;
-#elif defined(HAVE_SECCOMP)
-	static const int syscall_wl[] = {
-		// Syscalls used by rp-download.
-		// TODO: Add more syscalls.
-		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
-		// defined in earlier versions, including Ubuntu 14.04.
-
-		// NOTE: Special case for clone(). If it's the first syscall
-		// in the list, it has a parameter restriction added that
-		// ensures it can only be used to create threads.
-		SCMP_SYS(clone),
-		// Other multi-threading syscalls
-		SCMP_SYS(set_robust_list),
-
-		SCMP_SYS(access), SCMP_SYS(clock_gettime),
-#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
-		SCMP_SYS(clock_gettime64),
-#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
-		SCMP_SYS(close),
-		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
-		SCMP_SYS(fsetxattr),
-		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
-		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
-		SCMP_SYS(futex),
-		SCMP_SYS(getdents), SCMP_SYS(getdents64),
-		SCMP_SYS(getppid),	// for bubblewrap verification
-		SCMP_SYS(getrusage),
-		SCMP_SYS(gettimeofday),	// 32-bit only?
-		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
-		SCMP_SYS(lseek), SCMP_SYS(_llseek),
-		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
-		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
-		SCMP_SYS(munmap),
-		SCMP_SYS(open),		// Ubuntu 16.04
-		SCMP_SYS(openat),	// glibc-2.31
-#if defined(__SNR_openat2)
-		SCMP_SYS(openat2),	// Linux 5.6
-#elif defined(__NR_openat2)
-		__NR_openat2,		// Linux 5.6
-#endif /* __SNR_openat2 || __NR_openat2 */
-		SCMP_SYS(poll), SCMP_SYS(select),
-		SCMP_SYS(stat), SCMP_SYS(stat64),
-		SCMP_SYS(unlink),	// to delete expired cache files
-		SCMP_SYS(utimensat),
-
-#if defined(__SNR_statx) || defined(__NR_statx)
-		SCMP_SYS(getcwd),	// called by glibc's statx()
-		SCMP_SYS(statx),
-#endif /* __SNR_statx || __NR_statx */
-
-#ifndef NDEBUG
-		// Needed for assert() on some systems.
-		SCMP_SYS(uname),
-#endif /* NDEBUG */
-
-		// glibc ncsd
-		// TODO: Restrict connect() to AF_UNIX.
-		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
-		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
-		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
-		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
-
-		// Needed for network access on Kubuntu 20.04 for some reason.
-		SCMP_SYS(getpid), SCMP_SYS(uname),
-
-		// cURL and OpenSSL
-		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
-#ifdef __SNR_getrandom
-		SCMP_SYS(getrandom),
-#endif /* __SNR_getrandom */
-		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
-		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
-		SCMP_SYS(setsockopt), SCMP_SYS(socket),
-		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
-		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
-
-		// libnss_resolve.so (systemd-resolved)
-		SCMP_SYS(geteuid),
-		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
-
-		// FIXME: Manjaro is using these syscalls for some reason...
-		SCMP_SYS(prctl), SCMP_SYS(mremap), SCMP_SYS(ppoll),
-
-		-1	// End of whitelist
-	};
-	param.syscall_wl = syscall_wl;
-#elif defined(HAVE_PLEDGE)
-	// Promises:
-	// - stdio: General stdio functionality.
-	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
-	// - wpath: Write to ~/.cache/rom-properties/
-	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
-	// - inet: Internet access.
-	// - fattr: Modify file attributes, e.g. mtime.
-	// - dns: Resolve hostnames.
-	// - getpw: Get user's home directory if HOME is empty.
-	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
-#elif defined(HAVE_TAME)
-	// NOTE: stdio includes fattr, e.g. utimes().
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
-	                   TAME_INET | TAME_DNS | TAME_GETPW;
-#else
-	param.dummy = 0;
-#endif
-	rp_secure_enable(param);
-
-	// Store argv[0] globally.
-	argv0 = argv[0];
-
-	if (argc < 2) {
-		show_usage();
-		return EXIT_FAILURE;
-	}
-
-	// Check for arguments. (simple non-getopt version)
-	bool force = false;
-	int optind = 1;
-	for (; optind < argc; optind++) {
-		if (!argv[optind] || argv[optind][0] != '-') {
-			// End of options.
-			break;
-		}
-
-		// Allow multiple options in one argument, e.g. '-vf'.
-		for (int i = 1; argv[optind][i] != '\0'; i++) {
-			switch (argv[optind][i]) {
-				case 'v':
-					// Verbose mode is enabled.
-					verbose = true;
-					break;
-				case 'f':
-					// Force download is enabled.
-					force = true;
-					break;
-				default:
-					// Invalid parameter.
-					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
-					show_usage();
-					return EXIT_FAILURE;
-			}
-		}
-	}
-
-	if (optind >= argc) {
-		show_error(_T("No cache key specified."));
-		show_usage();
-		return EXIT_FAILURE;
-	}
-	const TCHAR *const cache_key = argv[optind];
+#define RETURN_EXIT(status) do { *pExitStatus = (status); return false; } while (0)
+	assert(pExitStatus != nullptr);
+	req.f_out = nullptr;
+	const TCHAR *const cache_key = req.cache_key.c_str();
 
 	// Check the cache key prefix. The prefix indicates the system
 	// and identifies the online database used.
@@ -486,14 +336,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// - Does not contain any slashes.
 		// - First slash is either the first or the last character.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
 	const ptrdiff_t prefix_len = (slash_pos - cache_key);
 	if (prefix_len <= 0) {
 		// Empty prefix.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
 	// Cache key must include a lowercase file extension.
@@ -501,14 +351,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	if (!lastdot) {
 		// No dot...
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 	if (_tcscmp(lastdot, _T(".png")) != 0 &&
 	    _tcscmp(lastdot, _T(".jpg")) != 0)
 	{
 		// Not a supported file extension.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
 	// urlencode the cache key.
@@ -518,14 +368,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Determine the full URL based on the cache key.
 	bool ok = false;
-	TCHAR full_url[256];
+	TCHAR *const full_url = req.full_url;
 	if ((prefix_len == 3 && (!_tcsncmp(cache_key, _T("wii"), 3) || !_tcsncmp(cache_key, _T("3ds"), 3))) ||
 	    (prefix_len == 4 && !_tcsncmp(cache_key, _T("wiiu"), 4)) ||
 	    (prefix_len == 2 && !_tcsncmp(cache_key, _T("ds"), 2)))
 	{
 		// GameTDB: Wii, Wii U, Nintendo 3DS, Nintendo DS
 		ok = true;
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, _countof(req.full_url),
 			_T("https://art.gametdb.com/%s"), cache_key_urlencode.c_str());
 	} else if (prefix_len == 6 && !_tcsncmp(cache_key, _T("amiibo"), 6)) {
 		// amiibo.life: amiibo images
@@ -534,12 +384,12 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		if (filename_len <= 4) {
 			// Can't remove the extension...
 			SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-			return EXIT_FAILURE;
+			RETURN_EXIT(EXIT_FAILURE);
 		}
 		filename_len -= 4;
 
 		ok = true;
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, _countof(req.full_url),
 			_T("https://amiibo.life/nfc/%.*s/image"),
 			static_cast<int>(filename_len), slash_pos+1);
 	} else {
@@ -581,7 +431,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		}
 
 		if (ok) {
-			_sntprintf(full_url, _countof(full_url),
+			_sntprintf(full_url, _countof(req.full_url),
 				_T("https://rpdb.gerbilsoft.com/%s"), cache_key_urlencode.c_str());
 		}
 	}
@@ -589,7 +439,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	if (!ok) {
 		// Prefix is not supported.
 		SHOW_ERROR(_T("Cache key '%s' has an unsupported prefix."), cache_key);
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
 	if (verbose) {
@@ -602,15 +452,16 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// Cache directory is invalid...
 		// This may happen if bubblewrap is in use.
 		SHOW_ERROR(_T("Unable to access cache directory. Check the sandbox environment!"));
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
 	// Get the cache filename.
-	tstring cache_filename = LibCacheCommon::getCacheFilename(cache_key);
+	tstring &cache_filename = req.cache_filename;
+	cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
 		// Invalid cache filename.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 	if (verbose) {
 		_ftprintf(stderr, _T("Cache Filename: %s\n"), cache_filename.c_str());
@@ -641,7 +492,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				// Less than a week old.
 				if (likely(!force)) {
 					SHOW_INFO(_T("Negative cache file for '%s' has not expired; not redownloading."), cache_key);
-					return EXIT_FAILURE;
+					RETURN_EXIT(EXIT_FAILURE);
 				} else {
 					SHOW_INFO(_T("Negative cache file for '%s' has not expired, but -f was specified. Redownloading anyway."), cache_key);
 				}
@@ -651,58 +502,66 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 			// Delete the cache file and try to download it again.
 			if (_tremove(cache_filename.c_str()) != 0) {
 				SHOW_ERROR(_T("Error deleting negative cache file for '%s': %s"), cache_key, _tcserror(errno));
-				return EXIT_FAILURE;
+				RETURN_EXIT(EXIT_FAILURE);
 			}
 		} else if (filesize > 0) {
 			// File is larger than 0 bytes, which indicates
 			// it was previously cached successfully
 			if (likely(!force)) {
 				SHOW_INFO(_T("Cache file for '%s' is already downloaded."), cache_key);
-				return EXIT_SUCCESS;
+				RETURN_EXIT(EXIT_SUCCESS);
 			} else {
 				SHOW_INFO(_T("Cache file for '%s' is already downloaded, but -f was specified. Redownloading anyway."), cache_key);
 				if (_tremove(cache_filename.c_str()) != 0) {
 					SHOW_ERROR(_T("Error deleting cache file for '%s': %s"), cache_key, _tcserror(errno));
-					return EXIT_FAILURE;
+					RETURN_EXIT(EXIT_FAILURE);
 				}
 			}
 		}
 	} else if (ret == -ENOENT) {
 		// File not found. We'll need to download it.
 		// Make sure the path structure exists.
-		int ret = rmkdir(cache_filename.c_str());
+		ret = rmkdir(cache_filename.c_str());
 		if (ret != 0) {
 			SHOW_ERROR(_T("Error creating directory structure: %s"), _tcserror(-ret));
-			return EXIT_FAILURE;
+			RETURN_EXIT(EXIT_FAILURE);
 		}
 	} else {
 		// Other error.
 		SHOW_ERROR(_T("Error checking cache file for '%s': %s"), cache_key, _tcserror(-ret));
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
-	// Attempt to download the file.
-	// TODO: IDownloaderFactory?
-#ifdef _WIN32
-	unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
-#else /* !_WIN32 */
-	unique_ptr<IDownloader> m_downloader(new CurlDownloader());
-#endif /* _WIN32 */
-
 	// Open the cache file now so we can use it as a negative hit
 	// if the download fails.
-	FILE *f_out = _tfopen(cache_filename.c_str(), _T("wb"));
-	if (!f_out) {
+	req.f_out = _tfopen(cache_filename.c_str(), _T("wb"));
+	if (!req.f_out) {
 		// Error opening the cache file.
 		SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
-		return EXIT_FAILURE;
+		RETURN_EXIT(EXIT_FAILURE);
 	}
 
-	// TODO: Configure this somewhere?
-	m_downloader->setMaxSize(4*1024*1024);
+	// The file needs to be downloaded.
+	return true;
+#undef RETURN_EXIT
+}
+
+/**
+ * Finish a download request.
+ * The downloaded data will be written to the cache file,
+ * and the cache file will be closed.
+ * @param req		[in/out] Download request.
+ * @param downloader	[in] Downloader.
+ * @param ret		Return value from the downloader.
+ * @return Exit status.
+ */
+int finishDownload(DownloadRequest &req, const IDownloader *downloader, int ret)
+{
+	assert(req.f_out != nullptr);
+	const TCHAR *const cache_key = req.cache_key.c_str();
+	FILE *const f_out = req.f_out;
+	req.f_out = nullptr;
 
-	m_downloader->setUrl(full_url);
-	ret = m_downloader->download();
 	if (ret != 0) {
 		// Error downloading the file.
 		if (verbose) {
@@ -723,7 +582,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		return EXIT_FAILURE;
 	}
 
-	if (m_downloader->dataSize() <= 0) {
+	if (downloader->dataSize() <= 0) {
 		// No data downloaded...
 		SHOW_ERROR(_T("Error downloading file: 0 bytes received"));
 		fclose(f_out);
@@ -732,16 +591,16 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Write the file to the cache.
 	// TODO: Verify the size.
-	const size_t dataSize = m_downloader->dataSize();
-	size_t size = fwrite(m_downloader->data(), 1, dataSize, f_out);
+	const size_t dataSize = downloader->dataSize();
+	size_t size = fwrite(downloader->data(), 1, dataSize, f_out);
 	fflush(f_out);
 
 	// Save the file origin information.
 #ifdef _WIN32
 	// TODO: Figure out how to setFileOriginInfo() on Windows using an open file handle.
-	setFileOriginInfo(f_out, cache_filename.c_str(), full_url, m_downloader->mtime());
+	setFileOriginInfo(f_out, req.cache_filename.c_str(), req.full_url, downloader->mtime());
 #else /* !_WIN32 */
-	setFileOriginInfo(f_out, full_url, m_downloader->mtime());
+	setFileOriginInfo(f_out, req.full_url, downloader->mtime());
 #endif /* _WIN32 */
 	fclose(f_out);
 
@@ -751,3 +610,226 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		unlikely(dataSize == 1) ? "" : "s");
 	return EXIT_SUCCESS;
 }
+
+/**
+ * rp-download: Download an image from a supported online database.
+ * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @return 0 on success; non-zero on error.
+ *
+ * TODO:
+ * - More error codes based on the error.
+ */
+int RP_C_API _tmain(int argc, TCHAR *argv[])
+{
+	// Create a downloader based on OS:
+	// - Linux: CurlDownloader
+	// - Windows: WinInetDownloader
+
+	// Syntax: rp-download cache_key
+	// Example: rp-download ds/coverM/US/ADAE.png
+
+	// If http_proxy or https_proxy are set, they will be used
+	// by the downloader code if supported.
+
+	// Reduce process integrity, if available.
+	rp_secure_reduce_integrity();
+
+	// Set OS-specific security options.
+	rp_secure_param_t param;
+#if defined(_WIN32)
+	param.bHighSec = FALSE;
+#elif defined(HAVE_SECCOMP)
+	static const int syscall_wl[] = {
+		// Syscalls used by rp-download.
+		// TODO: Add more syscalls.
+		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
+		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),
+		// Other multi-threading syscalls
+		SCMP_SYS(set_robust_list),
+
+		SCMP_SYS(access), SCMP_SYS(clock_gettime),
+#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
+		SCMP_SYS(clock_gettime64),
+#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
+		SCMP_SYS(close),
+		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
+		SCMP_SYS(fsetxattr),
+		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
+		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
+		SCMP_SYS(futex),
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),
+		SCMP_SYS(getppid),	// for bubblewrap verification
+		SCMP_SYS(getrusage),
+		SCMP_SYS(gettimeofday),	// 32-bit only?
+		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
+		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
+		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
+		SCMP_SYS(munmap),
+		SCMP_SYS(open),		// Ubuntu 16.04
+		SCMP_SYS(openat),	// glibc-2.31
+#if defined(__SNR_openat2)
+		SCMP_SYS(openat2),	// Linux 5.6
+#elif defined(__NR_openat2)
+		__NR_openat2,		// Linux 5.6
+#endif /* __SNR_openat2 || __NR_openat2 */
+		SCMP_SYS(poll), SCMP_SYS(select),
+		SCMP_SYS(stat), SCMP_SYS(stat64),
+		SCMP_SYS(unlink),	// to delete expired cache files
+		SCMP_SYS(utimensat),
+
+#if defined(__SNR_statx) || defined(__NR_statx)
+		SCMP_SYS(getcwd),	// called by glibc's statx()
+		SCMP_SYS(statx),
+#endif /* __SNR_statx || __NR_statx */
+
+#ifndef NDEBUG
+		// Needed for assert() on some systems.
+		SCMP_SYS(uname),
+#endif /* NDEBUG */
+
+		// glibc ncsd
+		// TODO: Restrict connect() to AF_UNIX.
+		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
+		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
+		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
+		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
+
+		// Needed for network access on Kubuntu 20.04 for some reason.
+		SCMP_SYS(getpid), SCMP_SYS(uname),
+
+		// cURL and OpenSSL
+		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),
+#endif /* __SNR_getrandom */
+		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
+		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
+		SCMP_SYS(setsockopt), SCMP_SYS(socket),
+		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
+		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
+
+		// libnss_resolve.so (systemd-resolved)
+		SCMP_SYS(geteuid),
+		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
+
+		// cURL multi handle (server mode)
+		SCMP_SYS(eventfd2), SCMP_SYS(pipe), SCMP_SYS(pipe2),
+
+		// FIXME: Manjaro is using these syscalls for some reason...
+		SCMP_SYS(prctl), SCMP_SYS(mremap), SCMP_SYS(ppoll),
+
+		-1	// End of whitelist
+	};
+	param.syscall_wl = syscall_wl;
+#elif defined(HAVE_PLEDGE)
+	// Promises:
+	// - stdio: General stdio functionality.
+	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
+	// - wpath: Write to ~/.cache/rom-properties/
+	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
+	// - inet: Internet access.
+	// - fattr: Modify file attributes, e.g. mtime.
+	// - dns: Resolve hostnames.
+	// - getpw: Get user's home directory if HOME is empty.
+	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
+#elif defined(HAVE_TAME)
+	// NOTE: stdio includes fattr, e.g. utimes().
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
+	                   TAME_INET | TAME_DNS | TAME_GETPW;
+#else
+	param.dummy = 0;
+#endif
+	rp_secure_enable(param);
+
+	// Store argv[0] globally.
+	argv0 = argv[0];
+
+	if (argc < 2) {
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Check for arguments. (simple non-getopt version)
+	bool force = false;
+#ifndef _WIN32
+	bool server = false;
+#endif /* !_WIN32 */
+	int optind = 1;
+	for (; optind < argc; optind++) {
+		if (!argv[optind] || argv[optind][0] != '-') {
+			// End of options.
+			break;
+		}
+
+		// Allow multiple options in one argument, e.g. '-vf'.
+		for (int i = 1; argv[optind][i] != '\0'; i++) {
+			switch (argv[optind][i]) {
+				case 'v':
+					// Verbose mode is enabled.
+					verbose = true;
+					break;
+				case 'f':
+					// Force download is enabled.
+					force = true;
+					break;
+#ifndef _WIN32
+				case 's':
+					// Server mode is enabled.
+					server = true;
+					break;
+#endif /* !_WIN32 */
+				default:
+					// Invalid parameter.
+					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
+					show_usage();
+					return EXIT_FAILURE;
+			}
+		}
+	}
+
+#ifndef _WIN32
+	if (server) {
+		// Server mode: Read cache keys from stdin.
+		if (optind < argc) {
+			show_error(_T("Cache keys cannot be specified on the command line in server mode."));
+			show_usage();
+			return EXIT_FAILURE;
+		}
+		return runDownloadServer(force);
+	}
+#endif /* !_WIN32 */
+
+	if (optind >= argc) {
+		show_error(_T("No cache key specified."));
+		show_usage();
+		return EXIT_FAILURE;
+	}
+	DownloadRequest req;
+	req.cache_key = argv[optind];
+	int ret = EXIT_FAILURE;
+	if (!prepareDownload(req, force, &ret)) {
+		// File does not need to be downloaded.
+		return ret;
+	}
+
+	// Attempt to download the file.
+	// TODO: IDownloaderFactory?
+#ifdef _WIN32
+	unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
+#else /* !_WIN32 */
+	unique_ptr<IDownloader> m_downloader(new CurlDownloader());
+#endif /* _WIN32 */
+
+	// TODO: Configure this somewhere?
+	m_downloader->setMaxSize(MAX_DOWNLOAD_SIZE);
+
+	m_downloader->setUrl(req.full_url);
+	ret = m_downloader->download();
+	return finishDownload(req, m_downloader.get(), ret);
+}
@@ -0,0 +1,66 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * rp-download.hpp: Standalone cache downloader.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RP_DOWNLOAD_RP_DOWNLOAD_HPP__
+#define __ROMPROPERTIES_RP_DOWNLOAD_RP_DOWNLOAD_HPP__
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <string>
+
+// tcharx
+#include "tcharx.h"
+
+namespace RpDownload {
+	class IDownloader;
+}
+
+// Maximum download size.
+// TODO: Configure this somewhere?
+#define MAX_DOWNLOAD_SIZE (4*1024*1024)
+
+// Verbose mode.
+extern bool verbose;
+
+/**
+ * Download request.
+ */
+struct DownloadRequest {
+	std::tstring cache_key;		// Cache key
+	std::tstring cache_filename;	// Cache filename
+	TCHAR full_url[256];		// Full URL
+	FILE *f_out;			// Cache file (open for writing)
+};
+
+/**
+ * Prepare a download request.
+ *
+ * This validates the cache key, determines the full URL,
+ * checks the cache file, and opens the cache file for writing.
+ *
+ * @param req		[in/out] Download request. (cache_key must be set)
+ * @param force		If true, redownload the file even if it's already cached.
+ * @param pExitStatus	[out] Exit status if the file does not need to be downloaded.
+ * @return True if the file needs to be downloaded; false if not.
+ */
+bool prepareDownload(DownloadRequest &req, bool force, int *pExitStatus);
+
+/**
+ * Finish a download request.
+ * The downloaded data will be written to the cache file,
+ * and the cache file will be closed.
+ * @param req		[in/out] Download request.
+ * @param downloader	[in] Downloader.
+ * @param ret		Return value from the downloader.
+ * @return Exit status.
+ */
+int finishDownload(DownloadRequest &req, const RpDownload::IDownloader *downloader, int ret);
+
+#endif /* __ROMPROPERTIES_RP_DOWNLOAD_RP_DOWNLOAD_HPP__ */
@@ -0,0 +1,347 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download/tests)                *
+ * DownloadServerTest.cpp: Persistent download server protocol tests.      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// libcachecommon
+#include "libcachecommon/CacheKeys.hpp"
+
+// C includes.
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+namespace RpDownload { namespace Tests {
+
+// Temporary directory for XDG_CACHE_HOME.
+static string tmp_dir;
+
+class DownloadServerTest : public ::testing::Test
+{
+	protected:
+		DownloadServerTest()
+			: m_fd(-1)
+			, m_pid(-1)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		/**
+		 * Send data to rp-download.
+		 * @param data Data.
+		 * @return True on success; false on error.
+		 */
+		bool sendData(const string &data);
+
+		/**
+		 * Read a response from rp-download.
+		 * @param line [out] Response, without the trailing newline.
+		 * @return True on success; false on error or timeout.
+		 */
+		bool readResponse(string &line);
+
+		/**
+		 * Close the request side of the socket and wait for rp-download to exit.
+		 * @return rp-download's exit status, or -1 on error.
+		 */
+		int closeAndWait(void);
+
+		/**
+		 * Create a file in the cache directory.
+		 * @param cache_key Cache key.
+		 * @param size File size.
+		 * @return True on success; false on error.
+		 */
+		static bool createCacheFile(const char *cache_key, size_t size);
+
+	protected:
+		int m_fd;	// Socket connected to rp-download's stdin and stdout
+		pid_t m_pid;	// rp-download process ID
+		string m_buf;	// Partial response data
+};
+
+/**
+ * Start rp-download in server mode.
+ */
+void DownloadServerTest::SetUp(void)
+{
+	int sv[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+	m_pid = fork();
+	ASSERT_NE(-1, m_pid);
+	if (m_pid == 0) {
+		// Child process.
+		close(sv[0]);
+		if (dup2(sv[1], STDIN_FILENO) < 0 || dup2(sv[1], STDOUT_FILENO) < 0) {
+			_exit(127);
+		}
+		execl(RP_DOWNLOAD_PATH, RP_DOWNLOAD_PATH, "-s", nullptr);
+		_exit(127);
+	}
+
+	close(sv[1]);
+	m_fd = sv[0];
+}
+
+/**
+ * Stop rp-download.
+ */
+void DownloadServerTest::TearDown(void)
+{
+	if (m_fd >= 0) {
+		close(m_fd);
+		m_fd = -1;
+	}
+	if (m_pid > 0) {
+		waitpid(m_pid, nullptr, 0);
+		m_pid = -1;
+	}
+}
+
+/**
+ * Send data to rp-download.
+ * @param data Data.
+ * @return True on success; false on error.
+ */
+bool DownloadServerTest::sendData(const string &data)
+{
+	return (send(m_fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size()));
+}
+
+/**
+ * Read a response from rp-download.
+ * @param line [out] Response, without the trailing newline.
+ * @return True on success; false on error or timeout.
+ */
+bool DownloadServerTest::readResponse(string &line)
+{
+	while (true) {
+		const size_t nl = m_buf.find('\n');
+		if (nl != string::npos) {
+			line.assign(m_buf, 0, nl);
+			m_buf.erase(0, nl + 1);
+			return true;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = m_fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		const int ret = poll(&pfd, 1, 10000);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return false;
+
+		char buf[1024];
+		const ssize_t size = read(m_fd, buf, sizeof(buf));
+		if (size <= 0)
+			return false;
+		m_buf.append(buf, size);
+	}
+}
+
+/**
+ * Close the request side of the socket and wait for rp-download to exit.
+ * @return rp-download's exit status, or -1 on error.
+ */
+int DownloadServerTest::closeAndWait(void)
+{
+	shutdown(m_fd, SHUT_WR);
+
+	int status = 0;
+	const pid_t pid = waitpid(m_pid, &status, 0);
+	m_pid = -1;
+	if (pid <= 0 || !WIFEXITED(status))
+		return -1;
+	return WEXITSTATUS(status);
+}
+
+/**
+ * Create a file in the cache directory.
+ * @param cache_key Cache key.
+ * @param size File size.
+ * @return True on success; false on error.
+ */
+bool DownloadServerTest::createCacheFile(const char *cache_key, size_t size)
+{
+	const string filename = LibCacheCommon::getCacheFilename(cache_key);
+	if (filename.empty()) {
+		return false;
+	}
+
+	// Create the parent directories.
+	for (size_t slash = filename.find('/', tmp_dir.size() + 1);
+	     slash != string::npos; slash = filename.find('/', slash + 1))
+	{
+		const string dir = filename.substr(0, slash);
+		if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+			return false;
+		}
+	}
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	if (!f) {
+		return false;
+	}
+	const string data(size, 'x');
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+	return true;
+}
+
+/**
+ * Invalid cache keys fail without downloading anything.
+ */
+TEST_F(DownloadServerTest, invalidKey)
+{
+	ASSERT_TRUE(sendData("invalid\n"));
+	string line;
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\tinvalid", line);
+
+	// Unsupported prefix.
+	ASSERT_TRUE(sendData("unknown/test.png\n"));
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\tunknown/test.png", line);
+
+	EXPECT_EQ(EXIT_SUCCESS, closeAndWait());
+}
+
+/**
+ * Files that are already cached succeed without downloading anything.
+ * Negative cache files that haven't expired fail.
+ */
+TEST_F(DownloadServerTest, cachedFile)
+{
+	ASSERT_TRUE(createCacheFile("wii/cover/US/RSPE01.png", 100));
+	ASSERT_TRUE(createCacheFile("wii/cover/US/RSPE02.png", 0));
+
+	ASSERT_TRUE(sendData("wii/cover/US/RSPE01.png\n"));
+	string line;
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("0\twii/cover/US/RSPE01.png", line);
+
+	ASSERT_TRUE(sendData("wii/cover/US/RSPE02.png\n"));
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\twii/cover/US/RSPE02.png", line);
+
+	EXPECT_EQ(EXIT_SUCCESS, closeAndWait());
+}
+
+/**
+ * Multiple requests can be sent at once, and requests
+ * can be split across writes. CRLF line endings are accepted.
+ */
+TEST_F(DownloadServerTest, multipleRequests)
+{
+	ASSERT_TRUE(createCacheFile("wii/cover/US/RSPE03.png", 100));
+
+	ASSERT_TRUE(sendData("invalid1\ninvalid2\r\nwii/cover/"));
+	string line;
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\tinvalid1", line);
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\tinvalid2", line);
+
+	// Finish the partial request.
+	ASSERT_TRUE(sendData("US/RSPE03.png\n"));
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("0\twii/cover/US/RSPE03.png", line);
+
+	EXPECT_EQ(EXIT_SUCCESS, closeAndWait());
+}
+
+/**
+ * Lines that are too long are rejected with an empty cache key.
+ * The server must continue to accept requests afterwards.
+ */
+TEST_F(DownloadServerTest, lineTooLong)
+{
+	ASSERT_TRUE(sendData(string(4000, 'a') + '\n'));
+	string line;
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\t", line);
+
+	ASSERT_TRUE(sendData("invalid\n"));
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\tinvalid", line);
+
+	EXPECT_EQ(EXIT_SUCCESS, closeAndWait());
+}
+
+/**
+ * The server exits once stdin is closed.
+ * Requests that were received before EOF must still be answered.
+ */
+TEST_F(DownloadServerTest, eof)
+{
+	ASSERT_TRUE(sendData("invalid\n"));
+	shutdown(m_fd, SHUT_WR);
+
+	string line;
+	ASSERT_TRUE(readResponse(line));
+	EXPECT_EQ("1\tinvalid", line);
+	EXPECT_FALSE(readResponse(line));
+
+	EXPECT_EQ(EXIT_SUCCESS, closeAndWait());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "rp-download test suite: DownloadServer tests.\n\n");
+	fflush(nullptr);
+
+	// Use a temporary directory for the cache.
+	// NOTE: This must be done before the cache directory is initialized.
+	char tmpl[] = "/tmp/DownloadServerTest.XXXXXX";
+	if (!mkdtemp(tmpl)) {
+		fprintf(stderr, "*** ERROR: Unable to create a temporary directory.\n");
+		return EXIT_FAILURE;
+	}
+	RpDownload::Tests::tmp_dir = tmpl;
+	setenv("XDG_CACHE_HOME", tmpl, 1);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	const int ret = RUN_ALL_TESTS();
+
+	// Remove the temporary directory.
+	const string cmd = "rm -rf '" + RpDownload::Tests::tmp_dir + '\'';
+	if (system(cmd.c_str()) != 0) {
+		fprintf(stderr, "*** WARNING: Unable to remove %s\n", RpDownload::Tests::tmp_dir.c_str());
+	}
+	return ret;
+}
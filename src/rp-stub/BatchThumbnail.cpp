@@ -0,0 +1,304 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-stub)                          *
+ * BatchThumbnail.cpp: Batch thumbnail creator.                            *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "BatchThumbnail.h"
+#include "CreateThumbnail.h"
+#include "monotonic_time.h"
+#include "libi18n/i18n.h"
+
+// libromdata
+#include "libromdata/img/TCreateThumbnail.hpp"
+
+// librpfile
+#include "librpfile/FileSystem.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Thread;
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+/**
+ * Manifest entry.
+ */
+struct ManifestEntry {
+	string source_file;
+	string output_file;
+	int maximum_size;
+	unsigned int line;	// Line number in the manifest
+};
+
+/**
+ * Batch thumbnailing state.
+ * Shared by all worker threads.
+ */
+struct BatchState {
+	const vector<ManifestEntry> *entries;
+
+	Mutex mutex;		// Protects all fields below.
+	size_t next_idx;	// Next entry to process
+	unsigned int done;	// Number of entries processed
+	unsigned int failed;	// Number of entries that failed
+	double total_ms;	// Total per-file time, in milliseconds
+};
+
+/**
+ * Get a description for an RPCT error code.
+ * @param ret RPCT error code
+ * @return Description
+ */
+static const char *rpct_error_string(int ret)
+{
+	static const char *const errStrs[] = {
+		NOP_C_("rp-stub", "Success"),
+		NOP_C_("rp-stub", "Cannot load the shared library"),
+		NOP_C_("rp-stub", "Cannot open the source file"),
+		NOP_C_("rp-stub", "Source file isn't supported"),
+		NOP_C_("rp-stub", "Source file has no image"),
+		NOP_C_("rp-stub", "Failed to save the output file"),
+		NOP_C_("rp-stub", "Thumbnails are disabled for this class"),
+		NOP_C_("rp-stub", "Source file is on a \"bad\" file system"),
+		NOP_C_("rp-stub", "Running as root is not supported"),
+		NOP_C_("rp-stub", "Invalid image size"),
+	};
+	static_assert(ARRAY_SIZE(errStrs) == RPCT_INVALID_IMAGE_SIZE+1, "errStrs[] is out of sync with RpCreateThumbnailError");
+
+	if (ret < 0 || ret >= static_cast<int>(ARRAY_SIZE(errStrs))) {
+		return C_("rp-stub", "Unknown error");
+	}
+	return dpgettext_expr(RP_I18N_DOMAIN, "rp-stub", errStrs[ret]);
+}
+
+/**
+ * Parse the manifest.
+ * Invalid lines are reported on stderr and skipped.
+ * @param manifest	[in] Manifest file.
+ * @param default_size	[in] Default maximum size.
+ * @param entries	[out] Manifest entries.
+ * @return Number of invalid lines.
+ */
+static unsigned int parseManifest(FILE *manifest, int default_size, vector<ManifestEntry> &entries)
+{
+	unsigned int invalid = 0;
+	unsigned int line_num = 0;
+	string line;
+	char buf[4096];
+
+	while (fgets(buf, sizeof(buf), manifest)) {
+		line += buf;
+		if (line.empty() || (line[line.size()-1] != '\n' && !feof(manifest))) {
+			// Line is incomplete.
+			continue;
+		}
+		line_num++;
+
+		// Remove the trailing newline.
+		while (!line.empty() && (line[line.size()-1] == '\n' || line[line.size()-1] == '\r')) {
+			line.resize(line.size()-1);
+		}
+		if (line.empty() || line[0] == '#') {
+			// Empty line or comment.
+			line.clear();
+			continue;
+		}
+
+		// Split the line into tab-separated fields.
+		vector<string> fields;
+		size_t pos = 0;
+		while (true) {
+			const size_t tab = line.find('\t', pos);
+			fields.emplace_back(line, pos, (tab != string::npos ? tab - pos : string::npos));
+			if (tab == string::npos)
+				break;
+			pos = tab + 1;
+		}
+		line.clear();
+
+		ManifestEntry entry;
+		entry.line = line_num;
+		entry.maximum_size = default_size;
+		bool ok = (fields.size() == 2 || fields.size() == 3) &&
+			!fields[0].empty() && !fields[1].empty();
+		if (ok && fields.size() == 3) {
+			char *endptr = nullptr;
+			errno = 0;
+			const long lTmp = strtol(fields[2].c_str(), &endptr, 10);
+			ok = (errno != ERANGE && *endptr == '\0' && lTmp > 0 && lTmp <= 32768);
+			entry.maximum_size = static_cast<int>(lTmp);
+		}
+		if (!ok) {
+			// tr: %u == line number in the manifest
+			fprintf(stderr, C_("rp-stub", "*** Manifest line %u is invalid."), line_num);
+			putc('\n', stderr);
+			invalid++;
+			continue;
+		}
+
+		entry.source_file = std::move(fields[0]);
+		entry.output_file = std::move(fields[1]);
+		entries.emplace_back(std::move(entry));
+	}
+
+	return invalid;
+}
+
+/**
+ * Worker thread function.
+ * Processes manifest entries until none are left.
+ * @param param Batch state. (BatchState)
+ */
+static void batchWorker(void *param)
+{
+	BatchState *const state = static_cast<BatchState*>(param);
+	const vector<ManifestEntry> &entries = *state->entries;
+	const unsigned int total = static_cast<unsigned int>(entries.size());
+
+	while (true) {
+		size_t idx;
+		{
+			MutexLocker locker(state->mutex);
+			if (state->next_idx >= entries.size())
+				break;
+			idx = state->next_idx++;
+		}
+
+		const ManifestEntry &entry = entries[idx];
+		const uint64_t start = rp_monotonic_time_us();
+		const int ret = rp_create_thumbnail_native(
+			entry.source_file.c_str(), entry.output_file.c_str(), entry.maximum_size);
+		const double ms = static_cast<double>(rp_monotonic_time_us() - start) / 1000.0;
+
+		MutexLocker locker(state->mutex);
+		state->done++;
+		state->total_ms += ms;
+		if (ret == 0) {
+			// tr: %1$u == entry number, %2$u == total entries, %3$s == source file, %4$.3f == time in milliseconds
+			printf_p(C_("rp-stub", "[%1$u/%2$u] %3$s: %4$.3f ms"),
+				state->done, total, entry.source_file.c_str(), ms);
+		} else {
+			state->failed++;
+			// tr: %1$u == entry number, %2$u == total entries, %3$s == source file, %4$.3f == time in milliseconds,
+			// %5$d == error code, %6$s == error description
+			printf_p(C_("rp-stub", "[%1$u/%2$u] %3$s: %4$.3f ms: *** ERROR %5$d: %6$s"),
+				state->done, total, entry.source_file.c_str(), ms,
+				ret, rpct_error_string(ret));
+		}
+		putchar('\n');
+		fflush(stdout);
+	}
+}
+
+/**
+ * Create thumbnails for all files listed in a manifest.
+ *
+ * Each line in the manifest has the following tab-separated fields:
+ * - Source file or file:// URI.
+ * - Output file.
+ * - Maximum size. (optional; default_size is used if not specified)
+ *
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * Thumbnails are created using rp_create_thumbnail_native() on
+ * a pool of worker threads. Per-file timing is printed to stdout
+ * as each thumbnail is completed, followed by the totals and the
+ * isOnBadFS() cache statistics.
+ *
+ * NOTE: This function does not check if it's running as root.
+ * The caller must handle that.
+ *
+ * @param manifest	[in] Manifest file, e.g. stdin.
+ * @param default_size	[in] Default maximum size.
+ * @param threads	[in] Number of worker threads. (0 for one per CPU)
+ * @return 0 if all thumbnails were created; non-zero if any failed.
+ */
+int RP_C_API rp_create_thumbnail_batch(FILE *manifest, int default_size, unsigned int threads)
+{
+	assert(manifest != nullptr);
+	assert(default_size > 0);
+	if (!manifest || default_size <= 0) {
+		return RPCT_INVALID_IMAGE_SIZE;
+	}
+
+	const uint64_t start = rp_monotonic_time_us();
+
+	vector<ManifestEntry> entries;
+	const unsigned int invalid = parseManifest(manifest, default_size, entries);
+
+	BatchState state;
+	state.entries = &entries;
+	state.next_idx = 0;
+	state.done = 0;
+	state.failed = 0;
+	state.total_ms = 0;
+
+	// Determine the number of worker threads.
+	if (threads == 0) {
+		threads = Thread::hardwareConcurrency();
+	}
+	if (threads > entries.size()) {
+		threads = static_cast<unsigned int>(entries.size());
+	}
+
+	// The current thread is used as one of the workers.
+	unique_ptr<Thread[]> workers;
+	unsigned int workerCount = 0;
+	if (threads > 1) {
+		workers.reset(new Thread[threads - 1]);
+		for (; workerCount < threads - 1; workerCount++) {
+			if (workers[workerCount].create(batchWorker, &state) != 0) {
+				// Unable to create a thread.
+				// Use the threads that were already created.
+				break;
+			}
+		}
+	}
+	batchWorker(&state);
+	for (unsigned int i = 0; i < workerCount; i++) {
+		workers[i].join();
+	}
+	threads = workerCount + 1;
+
+	const double wall_ms = static_cast<double>(rp_monotonic_time_us() - start) / 1000.0;
+
+	// Print the totals.
+	// tr: %1$u == number of files, %2$u == number succeeded, %3$u == number failed, %4$u == number of invalid manifest lines
+	printf_p(C_("rp-stub", "Processed %1$u file(s): %2$u succeeded, %3$u failed, %4$u invalid manifest line(s)."),
+		state.done, state.done - state.failed, state.failed, invalid);
+	putchar('\n');
+	// tr: %1$.3f == total time, %2$.3f == average time per file, %3$.3f == wall-clock time, %4$u == number of threads
+	printf_p(C_("rp-stub", "Total: %1$.3f ms (%2$.3f ms per file); wall time: %3$.3f ms using %4$u thread(s)."),
+		state.total_ms, (state.done > 0 ? state.total_ms / state.done : 0.0), wall_ms, threads);
+	putchar('\n');
+
+	// isOnBadFS() cache statistics.
+	unsigned int badfs_hits = 0, badfs_misses = 0;
+	LibRpFile::FileSystem::getBadFSCacheStats(&badfs_hits, &badfs_misses);
+	// tr: %1$u == number of cache hits, %2$u == number of cache misses
+	printf_p(C_("rp-stub", "File system type cache: %1$u hit(s), %2$u miss(es)."),
+		badfs_hits, badfs_misses);
+	putchar('\n');
+	fflush(stdout);
+
+	return (state.failed == 0 && invalid == 0) ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-stub)                          *
+ * BatchThumbnail.h: Batch thumbnail creator.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RP_STUB_BATCHTHUMBNAIL_H__
+#define __ROMPROPERTIES_RP_STUB_BATCHTHUMBNAIL_H__
+
+#include "common.h"
+
+// C includes.
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create thumbnails for all files listed in a manifest.
+ *
+ * Each line in the manifest has the following tab-separated fields:
+ * - Source file or file:// URI.
+ * - Output file.
+ * - Maximum size. (optional; default_size is used if not specified)
+ *
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * Thumbnails are created using rp_create_thumbnail_native() on
+ * a pool of worker threads. Per-file timing is printed to stdout
+ * as each thumbnail is completed, followed by the totals and the
+ * isOnBadFS() cache statistics.
+ *
+ * NOTE: This function does not check if it's running as root.
+ * The caller must handle that.
+ *
+ * @param manifest	[in] Manifest file, e.g. stdin.
+ * @param default_size	[in] Default maximum size.
+ * @param threads	[in] Number of worker threads. (0 for one per CPU)
+ * @return 0 if all thumbnails were created; non-zero if any failed.
+ */
+int RP_C_API rp_create_thumbnail_batch(FILE *manifest, int default_size, unsigned int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_RP_STUB_BATCHTHUMBNAIL_H__ */
@@ -0,0 +1,525 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-stub)                          *
+ * CreateThumbnail.cpp: Toolkit-independent thumbnail creator.             *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "CreateThumbnail.h"
+#include "ctypex.h"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/config/Config.hpp"
+#include "librpbase/img/RpPngWriter.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using LibRpTexture::rp_image;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/CacheIndex.hpp"
+using LibRomData::RomDataFactory;
+using LibRomData::CacheIndex;
+
+// TCreateThumbnail is a templated class,
+// so we have to #include the .cpp file here.
+#include "libromdata/img/TCreateThumbnail.cpp"
+using LibRomData::TCreateThumbnail;
+
+// C includes.
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+// C++ STL classes.
+using std::string;
+using std::unique_ptr;
+
+/** CreateThumbnailPrivate **/
+
+class CreateThumbnailPrivate : public TCreateThumbnail<const rp_image*>
+{
+	public:
+		CreateThumbnailPrivate() { }
+
+	private:
+		typedef TCreateThumbnail<const rp_image*> super;
+		RP_DISABLE_COPY(CreateThumbnailPrivate)
+
+	public:
+		/** TCreateThumbnail functions. **/
+
+		/**
+		 * Wrapper function to convert rp_image* to ImgClass.
+		 * @param img rp_image
+		 * @return ImgClass
+		 */
+		inline const rp_image *rpImageToImgClass(const rp_image *img) const final
+		{
+			// rp_image is used directly, so just take another reference.
+			return img->ref();
+		}
+
+		/**
+		 * Wrapper function to check if an ImgClass is valid.
+		 * @param imgClass ImgClass
+		 * @return True if valid; false if not.
+		 */
+		inline bool isImgClassValid(const rp_image *const &imgClass) const final
+		{
+			return (imgClass != nullptr && imgClass->isValid());
+		}
+
+		/**
+		 * Wrapper function to get a "null" ImgClass.
+		 * @return "Null" ImgClass.
+		 */
+		inline const rp_image *getNullImgClass(void) const final
+		{
+			return nullptr;
+		}
+
+		/**
+		 * Free an ImgClass object.
+		 * @param imgClass ImgClass object.
+		 */
+		inline void freeImgClass(const rp_image *&imgClass) const final
+		{
+			UNREF_AND_NULL(imgClass);
+		}
+
+		/**
+		 * Rescale an ImgClass using the specified scaling method.
+		 * @param imgClass ImgClass object.
+		 * @param sz New size.
+		 * @param method Scaling method.
+		 * @return Rescaled ImgClass.
+		 */
+		inline const rp_image *rescaleImgClass(const rp_image *const &imgClass, const ImgSize &sz, ScalingMethod method = ScalingMethod::Nearest) const final
+		{
+			return imgClass->scaled(sz.width, sz.height,
+				(method == ScalingMethod::Bilinear
+					? rp_image::ScalingMethod::Bilinear
+					: rp_image::ScalingMethod::Nearest));
+		}
+
+		/**
+		 * Get the size of the specified ImgClass.
+		 * @param imgClass	[in] ImgClass object.
+		 * @param pOutSize	[out] Pointer to ImgSize to store the image size.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int getImgClassSize(const rp_image *const &imgClass, ImgSize *pOutSize) const final
+		{
+			pOutSize->width = imgClass->width();
+			pOutSize->height = imgClass->height();
+			return 0;
+		}
+
+		/**
+		 * Get the proxy for the specified URL.
+		 * @return Proxy, or empty string if no proxy is needed.
+		 */
+		inline string proxyForUrl(const string &url) const final
+		{
+			// No desktop proxy settings are available here.
+			// rp-download will use the standard proxy environment
+			// variables, e.g. http_proxy, if they're set.
+			RP_UNUSED(url);
+			return string();
+		}
+
+	public:
+		/**
+		 * Shrink the thumbnail if it's larger than the maximum size.
+		 * @param pOutParams	[in,out] Output parameters from getThumbnail().
+		 * @param maximum_size	[in] Maximum size.
+		 */
+		void shrinkThumbnail(GetThumbnailOutParams_t *pOutParams, int maximum_size) const;
+};
+
+/**
+ * Shrink the thumbnail if it's larger than the maximum size.
+ * @param pOutParams	[in,out] Output parameters from getThumbnail().
+ * @param maximum_size	[in] Maximum size.
+ */
+void CreateThumbnailPrivate::shrinkThumbnail(GetThumbnailOutParams_t *pOutParams, int maximum_size) const
+{
+	if (pOutParams->thumbSize.width <= maximum_size &&
+	    pOutParams->thumbSize.height <= maximum_size)
+	{
+		// Thumbnail is already small enough.
+		return;
+	}
+
+	// Calculate the closest size while maintaining the aspect ratio.
+	ImgSize rescale_sz = pOutParams->thumbSize;
+	const ImgSize max_sz = {maximum_size, maximum_size};
+	rescale_aspect(rescale_sz, max_sz);
+	if (rescale_sz.width <= 0 || rescale_sz.height <= 0) {
+		// Unable to rescale. Keep the original thumbnail.
+		return;
+	}
+
+	const rp_image *const scaled_img = rescaleImgClass(pOutParams->retImg, rescale_sz, ScalingMethod::Bilinear);
+	if (!scaled_img) {
+		// Unable to rescale. Keep the original thumbnail.
+		return;
+	}
+
+	freeImgClass(pOutParams->retImg);
+	pOutParams->retImg = scaled_img;
+	pOutParams->thumbSize = rescale_sz;
+}
+
+/** CreateThumbnail **/
+
+/**
+ * Decode a file:// URI to a local filename.
+ * @param uri URI (must start with "file://")
+ * @return Local filename, or empty string on error.
+ */
+static string filenameFromFileURI(const char *uri)
+{
+	assert(!strncmp(uri, "file://", 7));
+	uri += 7;
+
+	// The host part must be empty or "localhost".
+	if (!strncmp(uri, "localhost/", 10)) {
+		uri += 9;
+	} else if (*uri != '/') {
+		// Remote hosts aren't supported.
+		return string();
+	}
+
+	string filename;
+	filename.reserve(strlen(uri));
+	for (; *uri != '\0'; uri++) {
+		if (*uri != '%') {
+			filename += *uri;
+			continue;
+		}
+
+		// Percent-encoded character.
+		char hex[3] = {uri[1], (uri[1] != '\0' ? uri[2] : '\0'), '\0'};
+		char *endptr = nullptr;
+		const long chr = strtol(hex, &endptr, 16);
+		if (!ISXDIGIT(hex[0]) || !ISXDIGIT(hex[1]) || endptr != &hex[2] || chr == 0) {
+			// Invalid escape sequence.
+			return string();
+		}
+		filename += static_cast<char>(chr);
+		uri += 2;
+	}
+
+	return filename;
+}
+
+/**
+ * Convert a local filename to a file:// URI.
+ *
+ * Relative paths are converted to absolute paths,
+ * and "." and ".." path components are removed.
+ * Symbolic links are *not* resolved.
+ *
+ * @param filename Local filename
+ * @return file:// URI, or empty string on error.
+ */
+static string fileURIFromFilename(const char *filename)
+{
+	// Get the absolute path.
+	string abspath;
+	if (filename[0] != '/') {
+		char cwd[4096];
+		if (!getcwd(cwd, sizeof(cwd))) {
+			// Unable to get the current directory.
+			return string();
+		}
+		abspath = cwd;
+		abspath += '/';
+	}
+	abspath += filename;
+
+	// Normalize the path components.
+	string normpath;
+	normpath.reserve(abspath.size());
+	size_t pos = 0;
+	while (pos < abspath.size()) {
+		size_t slash = abspath.find('/', pos);
+		if (slash == string::npos) {
+			slash = abspath.size();
+		}
+		const size_t len = slash - pos;
+		if (len == 0 || (len == 1 && abspath[pos] == '.')) {
+			// Empty or "." path component.
+		} else if (len == 2 && abspath[pos] == '.' && abspath[pos+1] == '.') {
+			// ".." path component. Remove the last component.
+			const size_t last_slash = normpath.rfind('/');
+			normpath.resize(last_slash != string::npos ? last_slash : 0);
+		} else {
+			normpath += '/';
+			normpath.append(abspath, pos, len);
+		}
+		pos = slash + 1;
+	}
+	if (normpath.empty()) {
+		normpath = "/";
+	}
+
+	// Percent-encode the path.
+	// NOTE: The Thumbnail Management Standard specification says spaces
+	// must be urlencoded: ' ' -> "%20"
+	// The set of unescaped characters matches glib's g_filename_to_uri().
+	// References:
+	// - https://specifications.freedesktop.org/thumbnail-spec/thumbnail-spec-latest.html
+	static const char hex_lookup[] = "0123456789ABCDEF";
+	string uri = "file://";
+	uri.reserve(uri.size() + (normpath.size() * 3));
+	for (const char c : normpath) {
+		const uint8_t chr = static_cast<uint8_t>(c);
+		const bool is_unreserved =
+			(chr >= 'A' && chr <= 'Z') || (chr >= 'a' && chr <= 'z') ||
+			(chr >= '0' && chr <= '9') ||
+			(chr != '\0' && strchr("-._~!$&'()*+,;=:@/", chr) != nullptr);
+		if (is_unreserved) {
+			uri += c;
+		} else {
+			uri += '%';
+			uri += hex_lookup[chr >> 4];
+			uri += hex_lookup[chr & 0x0F];
+		}
+	}
+
+	return uri;
+}
+
+/**
+ * Open a file from a filename or file:// URI.
+ * @param source_file	[in] Source filename or file:// URI.
+ * @param pp_file	[out] Opened file.
+ * @param s_filename	[out] Local filename.
+ * @param s_uri		[out] Normalized URI.
+ * @return 0 on success; RPCT error code on error.
+ */
+static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, string &s_filename, string &s_uri)
+{
+	// NOTE: Not checking these in Release builds.
+	assert(source_file != nullptr);
+	assert(pp_file != nullptr);
+
+	*pp_file = nullptr;
+	if (!strncmp(source_file, "file://", 7)) {
+		// This is a file:// URI.
+		s_filename = filenameFromFileURI(source_file);
+		if (s_filename.empty()) {
+			return RPCT_SOURCE_FILE_ERROR;
+		}
+		s_uri = source_file;
+	} else {
+		// This is a filename.
+		s_filename = source_file;
+		s_uri = fileURIFromFilename(source_file);
+	}
+
+	// Check if it's on a "bad" filesystem.
+	if (FileSystem::isOnBadFS(s_filename.c_str(), Config::instance()->enableThumbnailOnNetworkFS())) {
+		// It's on a "bad" filesystem.
+		return RPCT_SOURCE_FILE_BAD_FS;
+	}
+
+	// Open the file using RpFile.
+	RpFile *const file = new RpFile(s_filename, RpFile::FM_OPEN_READ_GZ);
+	if (!file->isOpen()) {
+		// File was not opened.
+		// TODO: Actual error code?
+		file->unref();
+		return RPCT_SOURCE_FILE_ERROR;
+	}
+
+	// File has been opened successfully.
+	*pp_file = file;
+	return 0;
+}
+
+/**
+ * Toolkit-independent thumbnail creator.
+ *
+ * This uses libromdata and RpPngWriter directly, so it doesn't
+ * need to load the GTK+ or KDE plugins. Images are rescaled
+ * using rp_image::scaled().
+ *
+ * Only local filenames and file:// URIs are supported.
+ * Other URIs must be handled by the UI frontend plugins.
+ *
+ * NOTE: This function does not check if it's running as root.
+ * The caller must handle that.
+ *
+ * @param source_file Source file or file:// URI. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @return 0 on success; non-zero on error. (RPCT error code)
+ */
+int RP_C_API rp_create_thumbnail_native(const char *source_file, const char *output_file, int maximum_size)
+{
+	assert(maximum_size > 0);
+	if (maximum_size <= 0) {
+		// Invalid thumbnail size.
+		return RPCT_INVALID_IMAGE_SIZE;
+	}
+
+	// NOTE: TCreateThumbnail() has wrappers for opening the
+	// ROM file and getting RomData*, but we're doing it here
+	// in order to return better error codes.
+
+	// Attempt to open the ROM file.
+	IRpFile *file = nullptr;
+	string s_filename, s_uri;
+	int ret = openFromFilenameOrURI(source_file, &file, s_filename, s_uri);
+	if (ret != 0) {
+		// Error opening the file.
+		return ret;
+	}
+	assert(file != nullptr);
+
+	// Get the appropriate RomData class for this ROM.
+	// RomData class *must* support at least one image type.
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	file->unref();	// file is ref()'d by RomData.
+	if (!romData) {
+		// ROM is not supported.
+		return RPCT_SOURCE_FILE_NOT_SUPPORTED;
+	}
+
+	// Create the thumbnail.
+	unique_ptr<CreateThumbnailPrivate> d(new CreateThumbnailPrivate());
+	CreateThumbnailPrivate::GetThumbnailOutParams_t outParams;
+	ret = d->getThumbnail(romData, maximum_size, &outParams);
+	if (ret != 0 || !d->isImgClassValid(outParams.retImg)) {
+		// No image.
+		d->freeImgClass(outParams.retImg);
+		romData->unref();
+		return RPCT_SOURCE_FILE_NO_IMAGE;
+	}
+
+	// If the image is larger than maximum_size, resize down.
+	d->shrinkThumbnail(&outParams, maximum_size);
+
+	// tEXt chunks.
+	RpPngWriter::kv_vector kv;
+	char mtime_str[32];
+	char szFile_str[32];
+	const char *mimeType;
+	int pwRet;
+
+	// Get the modification time and file size.
+	struct stat sb;
+	mtime_str[0] = '\0';
+	szFile_str[0] = '\0';
+	if (!stat(s_filename.c_str(), &sb)) {
+		if (sb.st_mtime > 0) {
+			snprintf(mtime_str, sizeof(mtime_str), "%" PRId64, static_cast<int64_t>(sb.st_mtime));
+		}
+		if (sb.st_size > 0) {
+			snprintf(szFile_str, sizeof(szFile_str), "%" PRId64, static_cast<int64_t>(sb.st_size));
+		}
+	}
+
+	// Save the image using RpPngWriter.
+	// NOTE: The rp_image is written as-is, so CI8 images
+	// are saved as paletted PNG images.
+	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(output_file, outParams.retImg));
+	if (!pngWriter->isOpen()) {
+		// Could not open the PNG writer.
+		ret = RPCT_OUTPUT_FILE_FAILED;
+		goto cleanup;
+	}
+	pngWriter->setProfile(Config::instance()->thumbnailPngProfile());
+
+	/** tEXt chunks. **/
+	// NOTE: These are written before IHDR in order to put the
+	// tEXt chunks before the IDAT chunk.
+
+	// Get values for the XDG thumbnail cache text chunks.
+	// KDE uses this order: Software, MTime, Mimetype, Size, URI
+	kv.reserve(7);
+
+	// Software.
+	kv.emplace_back("Software", "ROM Properties Page shell extension (rp-stub)");
+
+	// Modification time.
+	if (mtime_str[0] != '\0') {
+		kv.emplace_back("Thumb::MTime", mtime_str);
+	}
+
+	// MIME type.
+	mimeType = romData->mimeType();
+	if (mimeType) {
+		kv.emplace_back("Thumb::Mimetype", mimeType);
+	}
+
+	// File size.
+	if (szFile_str[0] != '\0') {
+		kv.emplace_back("Thumb::Size", szFile_str);
+	}
+
+	// Original image dimensions.
+	if (outParams.fullSize.width > 0 && outParams.fullSize.height > 0) {
+		char imgdim_str[16];
+		snprintf(imgdim_str, sizeof(imgdim_str), "%d", outParams.fullSize.width);
+		kv.emplace_back("Thumb::Image::Width", imgdim_str);
+		snprintf(imgdim_str, sizeof(imgdim_str), "%d", outParams.fullSize.height);
+		kv.emplace_back("Thumb::Image::Height", imgdim_str);
+	}
+
+	// URI.
+	if (!s_uri.empty()) {
+		kv.emplace_back("Thumb::URI", s_uri);
+	}
+
+	// Write the tEXt chunks.
+	pngWriter->write_tEXt(kv);
+
+	/** IHDR **/
+	pwRet = pngWriter->write_IHDR();
+	if (pwRet != 0) {
+		// Error writing IHDR.
+		// TODO: Unlink the PNG image.
+		ret = RPCT_OUTPUT_FILE_FAILED;
+		goto cleanup;
+	}
+
+	/** IDAT chunk. **/
+	pwRet = pngWriter->write_IDAT();
+	if (pwRet != 0) {
+		// Error writing IDAT.
+		// TODO: Unlink the PNG image.
+		ret = RPCT_OUTPUT_FILE_FAILED;
+		goto cleanup;
+	}
+
+cleanup:
+	d->freeImgClass(outParams.retImg);
+	romData->unref();
+	return ret;
+}
+
+/**
+ * Shut down the toolkit-independent thumbnail creator.
+ *
+ * This writes pending cache index updates. It should be
+ * called once before exiting if rp_create_thumbnail_native()
+ * or rp_create_thumbnail_batch() was used.
+ */
+void RP_C_API rp_thumbnail_shutdown(void)
+{
+	CacheIndex::shutdown();
+}
@@ -0,0 +1,51 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-stub)                          *
+ * CreateThumbnail.h: Toolkit-independent thumbnail creator.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RP_STUB_CREATETHUMBNAIL_H__
+#define __ROMPROPERTIES_RP_STUB_CREATETHUMBNAIL_H__
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Toolkit-independent thumbnail creator.
+ *
+ * This uses libromdata and RpPngWriter directly, so it doesn't
+ * need to load the GTK+ or KDE plugins. Images are rescaled
+ * using rp_image::scaled().
+ *
+ * Only local filenames and file:// URIs are supported.
+ * Other URIs must be handled by the UI frontend plugins.
+ *
+ * NOTE: This function does not check if it's running as root.
+ * The caller must handle that.
+ *
+ * @param source_file Source file or file:// URI. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @return 0 on success; non-zero on error. (RPCT error code)
+ */
+int RP_C_API rp_create_thumbnail_native(const char *source_file, const char *output_file, int maximum_size);
+
+/**
+ * Shut down the toolkit-independent thumbnail creator.
+ *
+ * This writes pending cache index updates. It should be
+ * called once before exiting if rp_create_thumbnail_native()
+ * or rp_create_thumbnail_batch() was used.
+ */
+void RP_C_API rp_thumbnail_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_RP_STUB_CREATETHUMBNAIL_H__ */
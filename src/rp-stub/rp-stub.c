@@ -11,12 +11,18 @@
  * It parses the command line and then searches for installed
  * rom-properties libraries. If found, it runs the requested
  * function from the library.
+ *
+ * Thumbnailing local files is handled by the built-in,
+ * toolkit-independent thumbnailer, which doesn't need to
+ * load any of the plugins.
  */
 #include "config.version.h"
 #include "git.h"
 
 #include "libunixcommon/dll-search.h"
 #include "libi18n/i18n.h"
+#include "CreateThumbnail.h"
+#include "BatchThumbnail.h"
 
 // OS-specific security options.
 #include "rp-stub_secure.h"
@@ -84,13 +90,21 @@ static void show_help(const char *argv0)
 	if (!is_rp_config) {
 		printf(C_("rp-stub", "Usage: %s [-s size] source_file output_file"), argv0);
 		putchar('\n');
+		printf(C_("rp-stub", "       %s -b [-s size] [-j jobs] [manifest_file]"), argv0);
+		putchar('\n');
 		putchar('\n');
 		puts(C_("rp-stub",
 			"If source_file is a supported ROM image, a thumbnail is\n"
 			"extracted and saved as output_file.\n"
 			"\n"
+			"In batch mode, each line of manifest_file (or stdin if not\n"
+			"specified) has a source file, an output file, and an optional\n"
+			"maximum size, separated by tabs.\n"
+			"\n"
 			"Options:\n"
 			"  -s, --size\t\tMaximum thumbnail size. (default is 256px)\n"
+			"  -b, --batch\t\tCreate thumbnails for all files in a manifest.\n"
+			"  -j, --jobs\t\tNumber of batch mode worker threads. (default is one per CPU)\n"
 			"  -c, --config\t\tShow the configuration dialog instead of thumbnailing.\n"
 			"  -d, --debug\t\tShow debug output when searching for rom-properties.\n"
 			"  -h, --help\t\tDisplay this help and exit.\n"
@@ -127,17 +141,65 @@ static int ATTR_PRINTF(2, 3) fnDebug(int level, const char *format, ...)
 	return ret;
 }
 
+/**
+ * Is the specified source file a URI that isn't file://?
+ * Non-file URIs must be handled by the UI frontend plugins.
+ * @param source_file Source file or URI.
+ * @return True if this is a non-file URI; false if not.
+ */
+static bool is_non_file_uri(const char *source_file)
+{
+	// URI scheme: ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ) ":"
+	// Reference: RFC 3986, section 3.1
+	const char *p = source_file;
+	if (!((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')))
+		return false;
+	for (p++; *p != '\0' && *p != ':'; p++) {
+		const bool valid = (*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z') ||
+		                   (*p >= '0' && *p <= '9') || *p == '+' || *p == '-' || *p == '.';
+		if (!valid)
+			return false;
+	}
+	if (*p != ':' || p[1] != '/' || p[2] != '/') {
+		// Not a URI.
+		return false;
+	}
+	return (strncmp(source_file, "file://", 7) != 0);
+}
+
+/**
+ * Print a function's return value.
+ * @param symname Function name.
+ * @param ret Return value.
+ */
+static void print_ret(const char *symname, int ret)
+{
+	if (ret == 0) {
+		if (is_debug) {
+			// tr: %1$s == function name, %2$d == return value
+			fprintf_p(stderr, C_("rp-stub", "%1$s() returned %2$d."), symname, ret);
+			putc('\n', stderr);
+		}
+	} else {
+		// tr: %1$s == function name, %2$d == return value
+		fprintf_p(stderr, C_("rp-stub", "*** ERROR: %1$s() returned %2$d."), symname, ret);
+		putc('\n', stderr);
+	}
+}
+
 int main(int argc, char *argv[])
 {
 	/**
 	 * Command line syntax:
 	 * - Thumbnail: rp-stub [-s size] path output
+	 * - Batch:     rp-stub -b [-s size] [-j jobs] [manifest]
 	 * - Config:    rp-stub -c
 	 *
 	 * If invoked as 'rp-config', the configuration dialog
 	 * will be shown instead of thumbnailing.
 	 *
-	 * TODO: Support URIs in addition to paths?
+	 * Local paths and file:// URIs are thumbnailed directly.
+	 * Other URIs are passed to the UI frontend plugins.
 	 */
 
 	if (getuid() == 0 || geteuid() == 0) {
@@ -166,6 +228,8 @@ int main(int argc, char *argv[])
 
 	static const struct option long_options[] = {
 		{"size",	required_argument,	NULL, 's'},
+		{"batch",	no_argument,		NULL, 'b'},
+		{"jobs",	required_argument,	NULL, 'j'},
 		{"config",	no_argument,		NULL, 'c'},
 		{"debug",	no_argument,		NULL, 'd'},
 		{"help",	no_argument,		NULL, 'h'},
@@ -180,9 +244,11 @@ int main(int argc, char *argv[])
 
 	// Default to 256x256.
 	uint8_t config = is_rp_config;
+	bool batch = false;
+	unsigned int jobs = 0;
 	int maximum_size = 256;
 	int c, option_index;
-	while ((c = getopt_long(argc, argv, "s:cdhV", long_options, &option_index)) != -1) {
+	while ((c = getopt_long(argc, argv, "s:bj:cdhV", long_options, &option_index)) != -1) {
 		switch (c) {
 			case 's': {
 				char *endptr = NULL;
@@ -209,6 +275,28 @@ int main(int argc, char *argv[])
 				break;
 			}
 
+			case 'b':
+				// Batch mode.
+				batch = true;
+				break;
+
+			case 'j': {
+				char *endptr = NULL;
+				errno = 0;
+				long lTmp = strtol(optarg, &endptr, 10);
+				if (errno == ERANGE || *endptr != 0 || lTmp <= 0 || lTmp > 1024) {
+					// tr: %1$s == program name, %2%s == invalid number of jobs
+					fprintf_p(stderr, C_("rp-stub", "%1$s: invalid number of jobs '%2$s'"), argv[0], optarg);
+					putc('\n', stderr);
+					// tr: %s == program name
+					fprintf(stderr, str_help_more_info, argv[0]);
+					putc('\n', stderr);
+					return EXIT_FAILURE;
+				}
+				jobs = (unsigned int)lTmp;
+				break;
+			}
+
 			case 'c':
 				// Show the configuration dialog.
 				config = true;
@@ -241,6 +329,39 @@ int main(int argc, char *argv[])
 	// and reparse?
 	rp_stub_do_security_options(config);
 
+	if (!config && batch) {
+		// Batch mode.
+		// The manifest file is optional. If not specified, stdin is used.
+		if (optind+1 < argc) {
+			// tr: %s == program name
+			fprintf(stderr, C_("rp-stub", "%s: too many parameters specified"), argv[0]);
+			putc('\n', stderr);
+			// tr: %s == program name
+			fprintf(stderr, str_help_more_info, argv[0]);
+			putc('\n', stderr);
+			return EXIT_FAILURE;
+		}
+
+		FILE *manifest = stdin;
+		if (optind < argc && strcmp(argv[optind], "-") != 0) {
+			manifest = fopen(argv[optind], "r");
+			if (!manifest) {
+				// tr: %1$s == program name, %2$s == manifest filename, %3$s == error message
+				fprintf_p(stderr, C_("rp-stub", "%1$s: unable to open manifest '%2$s': %3$s"),
+					argv[0], argv[optind], strerror(errno));
+				putc('\n', stderr);
+				return EXIT_FAILURE;
+			}
+		}
+
+		int ret = rp_create_thumbnail_batch(manifest, maximum_size, jobs);
+		if (manifest != stdin) {
+			fclose(manifest);
+		}
+		rp_thumbnail_shutdown();
+		return ret;
+	}
+
 	if (!config) {
 		// Thumbnailing mode.
 		// We must have 2 filenames specified.
@@ -271,6 +392,28 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (!config) {
+		const char *const source_file = argv[optind];
+		const char *const output_file = argv[optind+1];
+		if (!is_non_file_uri(source_file)) {
+			// Local file. Use the built-in thumbnailer.
+			// This doesn't need to load the UI frontend plugins,
+			// so it doesn't initialize GTK+ or Qt.
+			const char *const symname = "rp_create_thumbnail_native";
+			if (is_debug) {
+				// tr: NOTE: Not positional. Don't change argument positions!
+				// tr: Only localize "Calling function:".
+				fprintf(stderr, C_("rp-stub", "Calling function: %s(\"%s\", \"%s\", %d);"),
+					symname, source_file, output_file, maximum_size);
+				putc('\n', stderr);
+			}
+			int ret = rp_create_thumbnail_native(source_file, output_file, maximum_size);
+			rp_thumbnail_shutdown();
+			print_ret(symname, ret);
+			return ret;
+		}
+	}
+
 	// Search for a usable rom-properties library.
 	// TODO: Desktop override option?
 	const char *const symname = (config ? "rp_show_config_dialog" : "rp_create_thumbnail");
@@ -282,6 +425,7 @@ int main(int argc, char *argv[])
 
 	if (!config) {
 		// Create the thumbnail.
+		// Non-file URIs are handled by the UI frontend plugins.
 		const char *const source_file = argv[optind];
 		const char *const output_file = argv[optind+1];
 		if (is_debug) {
@@ -303,16 +447,6 @@ int main(int argc, char *argv[])
 	}
 
 	dlclose(pDll);
-	if (ret == 0) {
-		if (is_debug) {
-			// tr: %1$s == function name, %2$d == return value
-			fprintf_p(stderr, C_("rp-stub", "%1$s() returned %2$d."), symname, ret);
-			putc('\n', stderr);
-		}
-	} else {
-		// tr: %1$s == function name, %2$d == return value
-		fprintf_p(stderr, C_("rp-stub", "*** ERROR: %1$s() returned %2$d."), symname, ret);
-		putc('\n', stderr);
-	}
+	print_ret(symname, ret);
 	return ret;
 }
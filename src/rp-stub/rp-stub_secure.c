@@ -100,6 +100,18 @@ int rp_stub_do_security_options(bool config)
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
+		SCMP_SYS(poll),		// LibRpFile::FileSystem::isOnBadFS() [mountinfo cache check]
+#if defined(__SNR_ppoll) || defined(__NR_ppoll)
+		SCMP_SYS(ppoll),	// poll() on some architectures
+#endif /* __SNR_ppoll || __NR_ppoll */
+
+		// LibRomData::CacheIndex
+		SCMP_SYS(flock),	// CacheIndexLock
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// CacheIndexPrivate::compact()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// CacheIndexPrivate::evict()
 
 		// ExecRpDownload_posix.cpp
 		// FIXME: Need to fix the clone() check in librpsecure/os-secure_linux.c.
@@ -0,0 +1,448 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-stub/tests)                    *
+ * CreateThumbnailTest.cpp: Toolkit-independent thumbnailer tests.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+#include "byteswap_rp.h"
+
+// Toolkit-independent thumbnailer
+#include "CreateThumbnail.h"
+#include "BatchThumbnail.h"
+#include "libromdata/img/TCreateThumbnail.hpp"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/img/RpPng.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/fileformat/dds_structs.h"
+using LibRpBase::RpPng;
+using LibRpFile::RpFile;
+using LibRpTexture::rp_image;
+
+// C includes.
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace RpStub { namespace Tests {
+
+class CreateThumbnailTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Temporary directory.
+		string tmpdir;
+
+		/**
+		 * Write an uncompressed ARGB32 DDS texture.
+		 * @param filename Filename.
+		 * @param width Width.
+		 * @param height Height.
+		 * @param color ARGB32 color.
+		 * @return 0 on success; non-zero on error.
+		 */
+		static int writeDDS(const string &filename, int width, int height, uint32_t color);
+
+		/**
+		 * Load a PNG image.
+		 * @param filename Filename.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *loadPNG(const string &filename);
+
+		/**
+		 * Load a file into memory.
+		 * @param filename Filename.
+		 * @return File contents.
+		 */
+		static string loadFile(const string &filename);
+
+		/**
+		 * Write a batch manifest.
+		 * @param filename Filename.
+		 * @param lines Manifest lines.
+		 * @return 0 on success; non-zero on error.
+		 */
+		static int writeManifest(const string &filename, const vector<string> &lines);
+};
+
+void CreateThumbnailTest::SetUp(void)
+{
+	const char *const tmp = getenv("TMPDIR");
+	char tmpl[4096];
+	snprintf(tmpl, sizeof(tmpl), "%s/rp-stub-test.XXXXXX", (tmp && tmp[0] != '\0') ? tmp : "/tmp");
+	ASSERT_TRUE(mkdtemp(tmpl) != nullptr);
+	tmpdir = tmpl;
+}
+
+void CreateThumbnailTest::TearDown(void)
+{
+	if (tmpdir.empty())
+		return;
+
+	// Remove the temporary directory.
+	const string cmd = "rm -rf '" + tmpdir + '\'';
+	EXPECT_EQ(0, system(cmd.c_str()));
+}
+
+/**
+ * Write an uncompressed ARGB32 DDS texture.
+ * @param filename Filename.
+ * @param width Width.
+ * @param height Height.
+ * @param color ARGB32 color.
+ * @return 0 on success; non-zero on error.
+ */
+int CreateThumbnailTest::writeDDS(const string &filename, int width, int height, uint32_t color)
+{
+	DDS_HEADER ddsHeader;
+	memset(&ddsHeader, 0, sizeof(ddsHeader));
+	ddsHeader.dwSize = cpu_to_le32(sizeof(ddsHeader));
+	ddsHeader.dwFlags = cpu_to_le32(DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT);
+	ddsHeader.dwHeight = cpu_to_le32(height);
+	ddsHeader.dwWidth = cpu_to_le32(width);
+	ddsHeader.dwPitchOrLinearSize = cpu_to_le32(width * 4);
+	ddsHeader.ddspf.dwSize = cpu_to_le32(sizeof(ddsHeader.ddspf));
+	ddsHeader.ddspf.dwFlags = cpu_to_le32(DDPF_RGB | DDPF_ALPHAPIXELS);
+	ddsHeader.ddspf.dwRGBBitCount = cpu_to_le32(32);
+	ddsHeader.ddspf.dwRBitMask = cpu_to_le32(0x00FF0000);
+	ddsHeader.ddspf.dwGBitMask = cpu_to_le32(0x0000FF00);
+	ddsHeader.ddspf.dwBBitMask = cpu_to_le32(0x000000FF);
+	ddsHeader.ddspf.dwABitMask = cpu_to_le32(0xFF000000);
+	ddsHeader.dwCaps = cpu_to_le32(0x1000);	// DDSCAPS_TEXTURE
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	if (!f)
+		return -1;
+
+	const uint32_t magic = cpu_to_be32(DDS_MAGIC);
+	fwrite(&magic, 1, sizeof(magic), f);
+	fwrite(&ddsHeader, 1, sizeof(ddsHeader), f);
+	const vector<uint32_t> pixels(width * height, cpu_to_le32(color));
+	fwrite(pixels.data(), sizeof(uint32_t), pixels.size(), f);
+	fclose(f);
+	return 0;
+}
+
+/**
+ * Load a PNG image.
+ * @param filename Filename.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *CreateThumbnailTest::loadPNG(const string &filename)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	rp_image *const img = (file->isOpen() ? RpPng::load(file) : nullptr);
+	file->unref();
+	return img;
+}
+
+/**
+ * Load a file into memory.
+ * @param filename Filename.
+ * @return File contents.
+ */
+string CreateThumbnailTest::loadFile(const string &filename)
+{
+	string data;
+	FILE *f = fopen(filename.c_str(), "rb");
+	if (!f)
+		return data;
+
+	char buf[4096];
+	size_t size;
+	while ((size = fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.append(buf, size);
+	}
+	fclose(f);
+	return data;
+}
+
+/**
+ * Write a batch manifest.
+ * @param filename Filename.
+ * @param lines Manifest lines.
+ * @return 0 on success; non-zero on error.
+ */
+int CreateThumbnailTest::writeManifest(const string &filename, const vector<string> &lines)
+{
+	FILE *f = fopen(filename.c_str(), "w");
+	if (!f)
+		return -1;
+
+	for (const string &line : lines) {
+		fputs(line.c_str(), f);
+		fputc('\n', f);
+	}
+	fclose(f);
+	return 0;
+}
+
+/** Thumbnailing tests **/
+
+/**
+ * Create a thumbnail that's smaller than the maximum size.
+ * The thumbnail should be written with the XDG thumbnail tEXt chunks.
+ */
+TEST_F(CreateThumbnailTest, smallImage)
+{
+	const string src = tmpdir + "/small.dds";
+	const string dest = tmpdir + "/small.png";
+	ASSERT_EQ(0, writeDDS(src, 200, 100, 0xFF336699));
+
+	ASSERT_EQ(0, rp_create_thumbnail_native(src.c_str(), dest.c_str(), 256));
+	unique_ptr<rp_image, void(*)(const rp_image*)> img(loadPNG(dest),
+		[](const rp_image *p) { if (p) p->unref(); });
+	ASSERT_TRUE(img.get() != nullptr);
+	EXPECT_EQ(200, img->width());
+	EXPECT_EQ(100, img->height());
+
+	// Check for the XDG thumbnail keys.
+	const string png = loadFile(dest);
+	EXPECT_NE(string::npos, png.find("Thumb::URI"));
+	EXPECT_NE(string::npos, png.find("Thumb::MTime"));
+	EXPECT_NE(string::npos, png.find("Thumb::Size"));
+	EXPECT_NE(string::npos, png.find("Thumb::Image::Width"));
+}
+
+/**
+ * Create a thumbnail that's larger than the maximum size.
+ * The thumbnail should be shrunk while maintaining the aspect ratio.
+ */
+TEST_F(CreateThumbnailTest, largeImage)
+{
+	const string src = tmpdir + "/large.dds";
+	const string dest = tmpdir + "/large.png";
+	ASSERT_EQ(0, writeDDS(src, 1024, 512, 0xFF336699));
+
+	ASSERT_EQ(0, rp_create_thumbnail_native(src.c_str(), dest.c_str(), 256));
+	unique_ptr<rp_image, void(*)(const rp_image*)> img(loadPNG(dest),
+		[](const rp_image *p) { if (p) p->unref(); });
+	ASSERT_TRUE(img.get() != nullptr);
+	ASSERT_EQ(256, img->width());
+	ASSERT_EQ(128, img->height());
+
+	// Solid colors must not be changed by bilinear filtering.
+	const uint32_t *const px = static_cast<const uint32_t*>(img->scanLine(64));
+	EXPECT_EQ(0xFF336699U, px[0]);
+	EXPECT_EQ(0xFF336699U, px[128]);
+	EXPECT_EQ(0xFF336699U, px[255]);
+}
+
+/**
+ * Create a thumbnail using a file:// URI.
+ */
+TEST_F(CreateThumbnailTest, fileURI)
+{
+	const string src = tmpdir + "/with space.dds";
+	const string dest = tmpdir + "/uri.png";
+	ASSERT_EQ(0, writeDDS(src, 64, 64, 0xFF336699));
+
+	const string uri = "file://" + tmpdir + "/with%20space.dds";
+	ASSERT_EQ(0, rp_create_thumbnail_native(uri.c_str(), dest.c_str(), 256));
+	unique_ptr<rp_image, void(*)(const rp_image*)> img(loadPNG(dest),
+		[](const rp_image *p) { if (p) p->unref(); });
+	ASSERT_TRUE(img.get() != nullptr);
+
+	// Invalid escape sequences must be rejected.
+	const string bad_uri = "file://" + tmpdir + "/with%2Xspace.dds";
+	EXPECT_EQ(RPCT_SOURCE_FILE_ERROR, rp_create_thumbnail_native(bad_uri.c_str(), dest.c_str(), 256));
+}
+
+/**
+ * Attempt to create a thumbnail for an unsupported file.
+ */
+TEST_F(CreateThumbnailTest, notSupported)
+{
+	const string src = tmpdir + "/unsupported.bin";
+	const string dest = tmpdir + "/unsupported.png";
+	FILE *f = fopen(src.c_str(), "wb");
+	ASSERT_TRUE(f != nullptr);
+	static const char data[] = "This is not a ROM image.";
+	fwrite(data, 1, sizeof(data), f);
+	fclose(f);
+
+	EXPECT_EQ(RPCT_SOURCE_FILE_NOT_SUPPORTED, rp_create_thumbnail_native(src.c_str(), dest.c_str(), 256));
+	EXPECT_EQ(RPCT_SOURCE_FILE_ERROR, rp_create_thumbnail_native((src + ".missing").c_str(), dest.c_str(), 256));
+}
+
+/**
+ * Create thumbnails using batch mode.
+ */
+TEST_F(CreateThumbnailTest, batch)
+{
+	const string src = tmpdir + "/batch.dds";
+	ASSERT_EQ(0, writeDDS(src, 512, 512, 0xFF336699));
+
+	const string manifest = tmpdir + "/manifest.txt";
+	ASSERT_EQ(0, writeManifest(manifest, {
+		"# Comment line",
+		src + '\t' + tmpdir + "/batch1.png",
+		"",
+		src + '\t' + tmpdir + "/batch2.png\t128",
+		src + '\t' + tmpdir + "/batch3.png\t64",
+	}));
+
+	FILE *f = fopen(manifest.c_str(), "r");
+	ASSERT_TRUE(f != nullptr);
+	EXPECT_EQ(0, rp_create_thumbnail_batch(f, 256, 2));
+	fclose(f);
+
+	static const int sizes[] = {256, 128, 64};
+	for (int i = 0; i < 3; i++) {
+		char filename[32];
+		snprintf(filename, sizeof(filename), "/batch%d.png", i+1);
+		unique_ptr<rp_image, void(*)(const rp_image*)> img(loadPNG(tmpdir + filename),
+			[](const rp_image *p) { if (p) p->unref(); });
+		ASSERT_TRUE(img.get() != nullptr) << filename;
+		EXPECT_EQ(sizes[i], img->width()) << filename;
+		EXPECT_EQ(sizes[i], img->height()) << filename;
+	}
+}
+
+/**
+ * Batch mode with invalid manifest lines and unsupported files.
+ * Valid entries must still be processed.
+ */
+TEST_F(CreateThumbnailTest, batchErrors)
+{
+	const string src = tmpdir + "/batch.dds";
+	ASSERT_EQ(0, writeDDS(src, 64, 64, 0xFF336699));
+
+	const string manifest = tmpdir + "/manifest.txt";
+	ASSERT_EQ(0, writeManifest(manifest, {
+		src,						// missing output file
+		src + '\t' + tmpdir + "/bad.png\t0",		// invalid size
+		manifest + '\t' + tmpdir + "/unsupported.png",	// not supported
+		src + '\t' + tmpdir + "/good.png",
+	}));
+
+	FILE *f = fopen(manifest.c_str(), "r");
+	ASSERT_TRUE(f != nullptr);
+	EXPECT_NE(0, rp_create_thumbnail_batch(f, 256, 0));
+	fclose(f);
+
+	unique_ptr<rp_image, void(*)(const rp_image*)> img(loadPNG(tmpdir + "/good.png"),
+		[](const rp_image *p) { if (p) p->unref(); });
+	EXPECT_TRUE(img.get() != nullptr);
+}
+
+/** Benchmarks **/
+
+/**
+ * Benchmark creating thumbnails in-process.
+ */
+TEST_F(CreateThumbnailTest, createThumbnail_benchmark)
+{
+	const string src = tmpdir + "/bench.dds";
+	const string dest = tmpdir + "/bench.png";
+	ASSERT_EQ(0, writeDDS(src, 256, 256, 0xFF336699));
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		ASSERT_EQ(0, rp_create_thumbnail_native(src.c_str(), dest.c_str(), 256));
+	}
+}
+
+/**
+ * Benchmark rp-stub startup time.
+ * Each iteration runs rp-thumbnail in a new process,
+ * which is how XDG thumbnailers invoke it.
+ */
+TEST_F(CreateThumbnailTest, startup_benchmark)
+{
+	if (getuid() == 0 || geteuid() == 0) {
+		// rp-stub refuses to run as root.
+		GTEST_SKIP() << "rp-stub does not support running as root.";
+	}
+
+	const string src = tmpdir + "/bench.dds";
+	const string dest = tmpdir + "/bench.png";
+	ASSERT_EQ(0, writeDDS(src, 256, 256, 0xFF336699));
+
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		const pid_t pid = fork();
+		ASSERT_NE(-1, pid);
+		if (pid == 0) {
+			// Child process.
+			execl(RP_STUB_PATH, RP_STUB_PATH, "-s", "256", src.c_str(), dest.c_str(), nullptr);
+			_exit(127);
+		}
+
+		int status = 0;
+		ASSERT_EQ(pid, waitpid(pid, &status, 0));
+		ASSERT_TRUE(WIFEXITED(status));
+		ASSERT_EQ(0, WEXITSTATUS(status));
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+	printf("rp-stub: %.3f ms per thumbnail process\n", ms / BENCHMARK_ITERATIONS);
+}
+
+/**
+ * Benchmark batch mode.
+ * Compare with startup_benchmark, which runs one process per thumbnail.
+ */
+TEST_F(CreateThumbnailTest, batch_benchmark)
+{
+	const string src = tmpdir + "/bench.dds";
+	ASSERT_EQ(0, writeDDS(src, 256, 256, 0xFF336699));
+
+	vector<string> lines;
+	lines.reserve(BENCHMARK_ITERATIONS);
+	for (unsigned int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		char filename[32];
+		snprintf(filename, sizeof(filename), "/bench%u.png", i);
+		lines.emplace_back(src + '\t' + tmpdir + filename);
+	}
+	const string manifest = tmpdir + "/manifest.txt";
+	ASSERT_EQ(0, writeManifest(manifest, lines));
+
+	FILE *f = fopen(manifest.c_str(), "r");
+	ASSERT_TRUE(f != nullptr);
+	EXPECT_EQ(0, rp_create_thumbnail_batch(f, 256, 0));
+	fclose(f);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "rp-stub test suite: CreateThumbnail tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
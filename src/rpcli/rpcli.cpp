@@ -16,6 +16,7 @@
 // librpbase, librpcpu
 #include "librpcpu/byteswap_rp.h"
 #include "librpbase/config.librpbase.h"
+#include "librpbase/Profiler.hpp"
 #include "librpbase/RomData.hpp"
 #include "librpbase/SystemRegion.hpp"
 #include "librpbase/TextFuncs.hpp"
@@ -29,10 +30,14 @@ using namespace LibRpBase;
 #include "librpfile/config.librpfile.h"
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
+#include "librpfile/TracingFile.hpp"
 using namespace LibRpFile;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/CacheManager.hpp"
+using LibRomData::CacheIndex;
+using LibRomData::CacheManager;
 using LibRomData::RomDataFactory;
 
 // librptexture
@@ -70,6 +75,7 @@ using LibRpTexture::rp_image;
 #include <fstream>
 #include <iostream>
 #include <locale>
+#include <new>
 #include <string>
 #include <vector>
 using std::cout;
@@ -77,6 +83,7 @@ using std::cerr;
 using std::endl;
 using std::locale;
 using std::ofstream;
+using std::ostream;
 using std::string;
 using std::vector;
 
@@ -164,20 +171,136 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 	}
 }
 
+#ifdef ENABLE_PROFILING
+/**
+ * Replacement allocation functions for Profiler's allocation counting.
+ * NOTE: The array and nothrow variants use these by default.
+ * The sized and aligned deallocation functions must also be replaced,
+ * since the default versions might not use free().
+ */
+void *operator new(size_t size)
+{
+	Profiler::countAlloc(size);
+	void *const ptr = malloc(size != 0 ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+	RP_UNUSED(size);
+	free(ptr);
+}
+
+#ifdef __cpp_aligned_new
+void *operator new(size_t size, std::align_val_t al)
+{
+	Profiler::countAlloc(size);
+	if (size == 0) {
+		size = 1;
+	}
+#ifdef _WIN32
+	void *const ptr = _aligned_malloc(size, static_cast<size_t>(al));
+#else /* !_WIN32 */
+	void *ptr;
+	if (posix_memalign(&ptr, static_cast<size_t>(al), size) != 0) {
+		ptr = nullptr;
+	}
+#endif /* _WIN32 */
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr, std::align_val_t al) noexcept
+{
+	RP_UNUSED(al);
+#ifdef _WIN32
+	_aligned_free(ptr);
+#else /* !_WIN32 */
+	free(ptr);
+#endif /* _WIN32 */
+}
+
+void operator delete(void *ptr, size_t size, std::align_val_t al) noexcept
+{
+	RP_UNUSED(size);
+	operator delete(ptr, al);
+}
+#endif /* __cpp_aligned_new */
+#endif /* ENABLE_PROFILING */
+
+/**
+ * Load all data from a RomData object.
+ * This is used for I/O tracing and profiling, so all
+ * lazily-loaded parts are loaded before output.
+ * @param romData RomData object
+ * @param trace TracingFile (nullptr if I/O tracing is disabled)
+ */
+static void LoadAllRomData(const RomData *romData, TracingFile *trace)
+{
+	if (trace) trace->setPhase(TracingFile::Phase::Fields);
+	romData->fields();
+
+	if (trace) trace->setPhase(TracingFile::Phase::Metadata);
+	romData->metaData();
+
+	if (trace) trace->setPhase(TracingFile::Phase::Images);
+	const uint32_t imgbf = romData->supportedImageTypes();
+	for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+		if (imgbf & (1U << i)) {
+			romData->image(static_cast<RomData::ImageType>(i));
+		}
+	}
+
+	// extURLs() and iconAnimData() are virtual,
+	// so they have to be profiled here.
+	const char *const className = romData->className();
+	for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+		if (imgbf & (1U << i)) {
+			Profiler::Scope profScope(className, Profiler::Phase::ExtURLs);
+			vector<RomData::ExtURL> extURLs;
+			romData->extURLs(static_cast<RomData::ImageType>(i), &extURLs);
+		}
+	}
+
+	Profiler::Scope profScope(className, Profiler::Phase::IconAnimData);
+	romData->iconAnimData();
+}
+
 /**
  * Shows info about file
  * @param filename ROM filename
  * @param json Is program running in json mode?
  * @param extract Vector of image extraction parameters
  * @param languageCode Language code. (0 for default)
+ * @param ioTrace Output stream for the I/O trace. (nullptr to disable tracing)
+ * @param profile If true, print a per-phase profile report to stderr.
  */
-static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract, uint32_t languageCode = 0)
+static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract,
+	uint32_t languageCode = 0, ostream *ioTrace = nullptr, bool profile = false)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
 	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
 	if (file->isOpen()) {
-		RomData *romData = RomDataFactory::create(file);
+		// If I/O tracing is enabled, wrap the file in a TracingFile.
+		TracingFile *const trace = (ioTrace ? new TracingFile(file) : nullptr);
+		IRpFile *const romFile = (trace ? static_cast<IRpFile*>(trace) : file);
+
+		RomData *romData = RomDataFactory::create(romFile);
 		if (romData && romData->isValid()) {
+			if (trace || profile) {
+				LoadAllRomData(romData, trace);
+			}
+
 			if (json) {
 				cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
 				cout << JSONROMOutput(romData, languageCode) << endl;
@@ -192,6 +315,15 @@ static void DoFile(const char *filename, bool json, vector<ExtractParam>& extrac
 		}
 
 		UNREF(romData);
+		if (trace) {
+			*ioTrace << JSONIoTraceOutput(trace, filename);
+			trace->unref();
+		}
+		if (profile) {
+			cerr << "-- " << C_("rpcli", "Profile:") << endl;
+			Profiler::writeReport(cerr);
+			Profiler::reset();
+		}
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
 		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
@@ -252,6 +384,28 @@ static void PrintPathnames(void)
 	cout << endl;
 }
 
+/**
+ * Print the download cache statistics.
+ */
+static void PrintCacheStats(void)
+{
+	CacheIndex::Stats stats;
+	CacheManager::getStats(&stats);
+
+	const uint64_t requests = stats.hits + stats.misses;
+	const double hit_rate = (requests > 0 ? (static_cast<double>(stats.hits) * 100.0 / requests) : 0.0);
+
+	cout << rp_sprintf(C_("rpcli", "Cache entries:           %u"), stats.entries) << endl;
+	cout << rp_sprintf(C_("rpcli", "Cache size:              %s"), formatFileSize(static_cast<off64_t>(stats.total_size)).c_str()) << endl;
+	cout << rp_sprintf(C_("rpcli", "Cache hits:              %s"), rp_sprintf("%llu", static_cast<unsigned long long>(stats.hits)).c_str()) << endl;
+	cout << rp_sprintf(C_("rpcli", "Cache misses:            %s"), rp_sprintf("%llu", static_cast<unsigned long long>(stats.misses)).c_str()) << endl;
+	cout << rp_sprintf(C_("rpcli", "Hit rate:                %.1f%%"), hit_rate) << endl;
+	cout << rp_sprintf(C_("rpcli", "Bytes saved:             %s"), formatFileSize(static_cast<off64_t>(stats.bytes_saved)).c_str()) << endl;
+
+	// Extra line. (TODO: Only if multiple commands are specified.)
+	cout << endl;
+}
+
 #ifdef RP_OS_SCSI_SUPPORTED
 /**
  * Run a SCSI INQUIRY command on a device.
@@ -344,17 +498,22 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-s] [-j] [-l lang] [--trace-io[=file]] [--profile] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-s] [-j] [-l lang] [--trace-io[=file]] [--profile] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
 		cerr << "  -p:   " << C_("rpcli", "Print system path information.") << endl;
+		cerr << "  -s:   " << C_("rpcli", "Print download cache statistics.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
 		cerr << "  -l:   " << C_("rpcli", "Retrieve the specified language from the ROM image.") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
+		cerr << "  --trace-io: " << C_("rpcli", "Write an I/O trace for each file as JSON to stderr, or to the specified file.") << endl;
+#ifdef ENABLE_PROFILING
+		cerr << "  --profile: " << C_("rpcli", "Print per-phase timing, bytes read, and allocations for each file.") << endl;
+#endif /* ENABLE_PROFILING */
 		cerr << endl;
 #ifdef RP_OS_SCSI_SUPPORTED
 		cerr << C_("rpcli", "Special options for devices:") << endl;
@@ -398,6 +557,9 @@ int RP_C_API main(int argc, char *argv[])
 	bool inq_ata_packet = false;
 #endif /* RP_OS_SCSI_SUPPORTED */
 	uint32_t languageCode = 0;
+	ostream *ioTrace = nullptr;
+	ofstream ioTraceFile;
+	bool profile = false;
 	bool first = true;
 	int ret = 0;
 	for (int i = 1; i < argc; i++){
@@ -422,6 +584,10 @@ int RP_C_API main(int argc, char *argv[])
 				// Print pathnames.
 				PrintPathnames();
 				break;
+			case 's':
+				// Print the download cache statistics.
+				PrintCacheStats();
+				break;
 			case 'l': {
 				// Language code.
 				// NOTE: Actual language may be immediately after 'l',
@@ -469,6 +635,42 @@ int RP_C_API main(int argc, char *argv[])
 				break;
 			case 'j': // do nothing
 				break;
+			case '-':
+				// Long options.
+				if (!strncmp(&argv[i][2], "trace-io", 8) &&
+				    (argv[i][10] == '\0' || argv[i][10] == '='))
+				{
+					// I/O tracing.
+					// Affects files specified *after* this option.
+					if (argv[i][10] == '=' && argv[i][11] != '\0') {
+						if (ioTraceFile.is_open()) {
+							ioTraceFile.close();
+						}
+						ioTraceFile.open(&argv[i][11], ofstream::out | ofstream::app);
+						if (!ioTraceFile.is_open()) {
+							cerr << rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
+								&argv[i][11], strerror(errno)) << endl;
+							ioTrace = nullptr;
+							break;
+						}
+						ioTrace = &ioTraceFile;
+					} else {
+						ioTrace = &cerr;
+					}
+				} else if (!strcmp(&argv[i][2], "profile")) {
+					// Per-phase profiling.
+					// Affects files specified *after* this option.
+#ifdef ENABLE_PROFILING
+					profile = true;
+					Profiler::setEnabled(true);
+					Profiler::setAllocCountingEnabled(true);
+#else /* !ENABLE_PROFILING */
+					cerr << C_("rpcli", "Warning: profiling is not available in this build.") << endl;
+#endif /* ENABLE_PROFILING */
+				} else {
+					cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown option '%s'"), argv[i]) << endl;
+				}
+				break;
 #ifdef RP_OS_SCSI_SUPPORTED
 			case 'i':
 				// These commands take precedence over the usual rpcli functionality.
@@ -518,7 +720,7 @@ int RP_C_API main(int argc, char *argv[])
 #endif /* RP_OS_SCSI_SUPPORTED */
 			{
 				// Regular file.
-				DoFile(argv[i], json, extract, languageCode);
+				DoFile(argv[i], json, extract, languageCode, ioTrace, profile);
 			}
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -531,6 +733,9 @@ int RP_C_API main(int argc, char *argv[])
 	}
 	if (json) cout << "]\n";
 
+	// Write pending cache index updates.
+	CacheIndex::shutdown();
+
 #ifdef _WIN32
 	// Shut down GDI+.
 	GdiplusHelper::ShutdownGDIPlus(gdipToken);
@@ -26,6 +26,19 @@ int rpcli_do_security_options(void)
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
+
+		// Threads: Nintendo3DS::loadNCCHs(), NCCHReader::decryptSection()
+		// NOTE: clone() must be first so rp_secure_enable() only allows
+		// CLONE_THREAD. clone3() returns ENOSYS, so glibc-2.34+ falls
+		// back to clone().
+		SCMP_SYS(clone),
+		SCMP_SYS(madvise),		// pthread stack cache
+		SCMP_SYS(rt_sigprocmask),	// pthread_create()
+		SCMP_SYS(set_robust_list),	// new threads
+#if defined(__SNR_rseq) || defined(__NR_rseq)
+		SCMP_SYS(rseq),			// new threads (glibc-2.35)
+#endif /* __SNR_rseq || __NR_rseq */
+
 		SCMP_SYS(close),
 		SCMP_SYS(dup),		// gzdopen()
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
@@ -125,17 +125,12 @@ IFACEMETHODIMP RP_ShellIconOverlayIdentifier::IsMemberOf(_In_ PCWSTR pwszPath, D
 		return E_FAIL;
 	}
 
-	// Attempt to create a RomData object.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
+	// Check for "dangerous" permissions.
+	// NOTE: This uses a light-weight probe and a per-file cache
+	// instead of constructing a full RomData object.
+	const bool dangerous = RomDataFactory::hasDangerousPermissions(file);
 	file->unref();
-	if (!romData) {
-		// ROM is not supported.
-		return S_FALSE;
-	}
-
-	HRESULT hr = (romData->hasDangerousPermissions() ? S_OK : S_FALSE);
-	romData->unref();
-	return hr;
+	return (dangerous ? S_OK : S_FALSE);
 }
 
 IFACEMETHODIMP RP_ShellIconOverlayIdentifier::GetOverlayInfo(_Out_writes_(cchMax) PWSTR pwszIconFile, int cchMax, _Out_ int *pIndex, _Out_ DWORD *pdwFlags)